@@ -0,0 +1,175 @@
+// Capture throughput and CPU cost per frame of the V4L2 camera, through the bus.
+//
+// Frames go from the camera's capture thread to a publisher and on to an
+// intra-process subscriber, at 1080p and 4K YUYV. The subscriber either
+// reads one byte of each frame (the zero-copy path) or copies the whole
+// image, as a path without buffer loaning would, to show what the copy costs.
+//
+// Without --device the frames come from the simulated file-backed device,
+// which captures as fast as buffers come back; its fill of each buffer (the
+// stand-in for the sensor's DMA) is part of the CPU figure, so the difference
+// between the two runs is what matters there. With --device the figures are
+// the real capture path at whatever rate the camera delivers.
+//
+// Usage: camera_bench [--device /dev/videoN] [--seconds N] [--buffers N] [--dir PATH]
+
+#include <ignlink/hal/camera.h>
+#include <ignlink/msg/node.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+using namespace ignlink;
+
+namespace {
+
+struct Settings {
+    std::string device; // Empty for the simulated device
+    double seconds = 3;
+    uint32_t buffers = 4;
+    std::string dir = "/tmp/ignlink_camera_bench";
+};
+
+struct Resolution {
+    const char* name;
+    uint32_t width;
+    uint32_t height;
+};
+
+double process_cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// A few frames of a moving gradient, enough that playback is not one repeated buffer.
+std::string write_frames(const std::string& dir, const Resolution& resolution) {
+    const std::string path = dir + "/" + resolution.name + ".yuyv";
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::vector<uint8_t> frame(size_t(resolution.width) * resolution.height * 2);
+    for (size_t k = 0; k < 4; ++k) {
+        for (size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = static_cast<uint8_t>(i / 7 + k * 16);
+        }
+        out.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+    }
+    return path;
+}
+
+struct Run {
+    uint64_t frames = 0;
+    uint64_t dropped = 0;
+    double seconds = 0;
+    double cpu_seconds = 0;
+};
+
+Run capture(const Settings& settings, const std::string& device, const Resolution& resolution, bool copy) {
+    Run run;
+    auto camera = hal::create_v4l2_camera();
+    hal::CameraConfig config;
+    config.device = device;
+    config.width = resolution.width;
+    config.height = resolution.height;
+    config.format = hal::PixelFormat::YUYV;
+    config.fps = settings.device.empty() ? 0 : 60; // 0: the simulated device's default, flat out
+    config.buffer_count = settings.buffers;
+    const auto status = camera->open(config);
+    if (!status.ok()) {
+        std::fprintf(stderr, "%s\n", status.message().c_str());
+        return run;
+    }
+
+    msg::Node node("camera_bench");
+    auto publisher = node.create_publisher<hal::CameraFrame>("/camera_bench/image");
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> checksum{0};
+    std::vector<uint8_t> scratch(size_t(camera->config().width) * camera->config().height * 2);
+    auto subscriber = node.create_subscriber<hal::CameraFrame>("/camera_bench/image", [&](const hal::CameraFrame& frame) {
+        const auto* data = static_cast<const uint8_t*>(frame.image.data());
+        if (copy) {
+            std::memcpy(scratch.data(), data, std::min(scratch.size(), size_t(frame.stride) * frame.height));
+            checksum.fetch_add(scratch[scratch.size() / 3], std::memory_order_relaxed);
+        } else {
+            checksum.fetch_add(data[0], std::memory_order_relaxed);
+        }
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    const double cpu_start = process_cpu_seconds();
+    const auto start = std::chrono::steady_clock::now();
+    camera->start([&](std::shared_ptr<const hal::CameraFrame> frame) { publisher->publish(std::move(frame)); });
+    std::this_thread::sleep_for(std::chrono::duration<double>(settings.seconds));
+    camera->stop();
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.cpu_seconds = process_cpu_seconds() - cpu_start;
+    run.frames = received.load();
+    run.dropped = camera->stats().dropped;
+    return run;
+}
+
+void report(const Resolution& resolution, const char* path, const Run& run) {
+    const double fps = run.seconds > 0 ? static_cast<double>(run.frames) / run.seconds : 0.0;
+    const double cpu_ms = run.frames ? run.cpu_seconds * 1e3 / static_cast<double>(run.frames) : 0.0;
+    const double mb_per_frame = resolution.width * resolution.height * 2 / 1e6;
+    std::printf("%-6s %-10s %10.1f %10.3f %10.1f %9llu %9llu\n", resolution.name, path, fps, cpu_ms,
+                fps * mb_per_frame, static_cast<unsigned long long>(run.frames),
+                static_cast<unsigned long long>(run.dropped));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--device") {
+            settings.device = argv[i + 1];
+        } else if (arg == "--seconds") {
+            settings.seconds = std::atof(argv[i + 1]);
+        } else if (arg == "--buffers") {
+            settings.buffers = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (arg == "--dir") {
+            settings.dir = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (settings.device.empty()) {
+        ::mkdir(settings.dir.c_str(), 0755);
+    }
+
+    const Resolution resolutions[] = {{"1080p", 1920, 1080}, {"4k", 3840, 2160}};
+    std::printf("device: %s, YUYV, %u buffers, %.1f s per run\n",
+                settings.device.empty() ? "simulated (file playback)" : settings.device.c_str(), settings.buffers,
+                settings.seconds);
+    std::printf("%-6s %-10s %10s %10s %10s %9s %9s\n", "size", "path", "frames/s", "cpu ms/fr", "MB/s", "frames",
+                "dropped");
+    int failures = 0;
+    for (const auto& resolution : resolutions) {
+        const std::string device =
+            settings.device.empty() ? "file:" + write_frames(settings.dir, resolution) : settings.device;
+        for (const bool copy : {false, true}) {
+            const Run run = capture(settings, device, resolution, copy);
+            failures += run.frames == 0;
+            report(resolution, copy ? "copy" : "zero-copy", run);
+        }
+        if (settings.device.empty()) {
+            std::remove(device.c_str() + 5);
+        }
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+// Receive cost of the SocketCAN bus at full classic CAN and CAN FD frame rates.
+//
+// A sender thread offers frames at the rate a saturated bus carries them
+// (1 Mbit/s classic CAN with 8-byte frames is about 8000 frames/s; CAN FD
+// with 64-byte frames at 1/5 and 1/8 Mbit/s about 7000 and 10000), then as
+// fast as it can. The receiver's batches go through the bus to a
+// subscriber. Reported per run: frames received per second, receive-thread
+// wakeups (batches) per second, CPU per frame on the receive side (process
+// CPU minus the sender's), and frames the kernel dropped. Runs with
+// batch size 1 show what reading one frame per system call costs, and on a
+// real interface a filtered run shows the wakeups that kernel filters save.
+//
+// Needs a (v)can interface for the real thing:
+//   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+// Without one, it runs on a UDP loopback socket pair carrying one SocketCAN
+// frame per datagram: the same receive path, minus the CAN stack and filters.
+//
+// Usage: can_bench [--interface vcan0] [--seconds N]
+
+#include <ignlink/hal/can_bus.h>
+#include <ignlink/msg/node.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Settings {
+    std::string interface = "vcan0";
+    double seconds = 3;
+};
+
+struct Scenario {
+    const char* name;
+    double rate;       // Frames per second offered; 0 for as fast as possible
+    bool fd;           // 64-byte CAN FD frames, else 8-byte classic frames
+    size_t batch_size;
+    bool filtered;     // Subscribe to 1 ID in 16 only
+};
+
+struct Run {
+    uint64_t offered = 0;
+    uint64_t received = 0;
+    uint64_t batches = 0;
+    uint64_t dropped = 0;
+    double seconds = 0;
+    double rx_cpu_seconds = 0;
+};
+
+double process_cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+// A connected UDP loopback pair standing in for a CAN interface.
+bool udp_pair(int fds[2]) {
+    for (int i = 0; i < 2; ++i) {
+        fds[i] = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fds[i] < 0 || ::bind(fds[i], reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 2; ++i) {
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+        ::getsockname(fds[1 - i], reinterpret_cast<sockaddr*>(&peer), &length);
+        if (::connect(fds[i], reinterpret_cast<sockaddr*>(&peer), length) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Run run_scenario(const Settings& settings, bool have_interface, const Scenario& scenario) {
+    Run run;
+    hal::CanBusConfig rx_config;
+    hal::CanBusConfig tx_config;
+    rx_config.interface = tx_config.interface = settings.interface;
+    rx_config.fd_frames = tx_config.fd_frames = scenario.fd;
+    rx_config.batch_size = scenario.batch_size;
+    rx_config.receive_buffer_bytes = 4 * 1024 * 1024;
+    if (scenario.filtered) {
+        rx_config.filters = {{0x100, 0x70f | hal::CanFrame::kExtended}}; // 0x100, 0x110, ... 0x1f0
+    }
+    if (!have_interface) {
+        int fds[2];
+        if (!udp_pair(fds)) {
+            std::fprintf(stderr, "Could not create a UDP socket pair\n");
+            return run;
+        }
+        rx_config.socket_fd = fds[0];
+        tx_config.socket_fd = fds[1];
+    }
+    auto receiver = hal::create_socket_can_bus();
+    auto sender = hal::create_socket_can_bus();
+    auto status = receiver->open(rx_config);
+    if (status.ok()) {
+        status = sender->open(tx_config);
+    }
+    if (!status.ok()) {
+        std::fprintf(stderr, "%s\n", status.message().c_str());
+        return run;
+    }
+
+    msg::Node node("can_bench");
+    // KeepAll, so that a receiver falling behind shows up as kernel drops, not bus drops.
+    auto publisher = node.create_publisher<hal::CanFrameBatch>("/can_bench/frames", msg::QoS::keep_all(64));
+    std::atomic<uint64_t> received{0};
+    auto subscriber = node.create_subscriber<hal::CanFrameBatch>(
+        "/can_bench/frames", [&](const hal::CanFrameBatch& batch) {
+            received.fetch_add(batch.frames.size(), std::memory_order_relaxed);
+        },
+        nullptr, msg::QoS::keep_all(1024));
+    receiver->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { publisher->publish(std::move(batch)); });
+
+    // 256 distinct IDs, round robin, so that a 1-in-16 filter passes 1 frame in 16.
+    std::vector<hal::CanFrame> frames(256);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        frames[i].id = 0x100 + static_cast<uint32_t>(i);
+        frames[i].len = scenario.fd ? 64 : 8;
+        frames[i].flags = scenario.fd ? hal::CanFrame::kFd | hal::CanFrame::kBitRateSwitch : 0;
+        std::memset(frames[i].data, static_cast<int>(i), frames[i].len);
+    }
+
+    double sender_cpu = 0;
+    const double cpu_start = process_cpu_seconds();
+    const auto start = Clock::now();
+    std::thread sender_thread([&] {
+        const double cpu = thread_cpu_seconds();
+        const auto end = start + std::chrono::duration<double>(settings.seconds);
+        uint64_t sent = 0;
+        for (auto now = Clock::now(); now < end; now = Clock::now()) {
+            // Send whatever is due by now, so the offered rate holds whatever the sleep granularity.
+            const double elapsed = std::chrono::duration<double>(now - start).count();
+            uint64_t due = scenario.rate > 0 ? static_cast<uint64_t>(elapsed * scenario.rate) : sent + 16;
+            while (sent < due) {
+                const size_t first = sent % frames.size();
+                const size_t n = std::min<uint64_t>(due - sent, frames.size() - first);
+                size_t done = 0;
+                sender->send(&frames[first], n, &done);
+                sent += done;
+                if (done < n) {
+                    std::this_thread::yield(); // Transmit queue full
+                    due = sent;
+                }
+            }
+            if (scenario.rate > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+        run.offered = sent;
+        sender_cpu = thread_cpu_seconds() - cpu;
+    });
+    sender_thread.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let the receiver drain
+    receiver->stop();
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count() - 0.1;
+    run.rx_cpu_seconds = process_cpu_seconds() - cpu_start - sender_cpu;
+    const auto stats = receiver->stats();
+    run.received = received.load();
+    run.batches = stats.batches;
+    run.dropped = stats.dropped;
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--interface") {
+            settings.interface = argv[i + 1];
+        } else if (arg == "--seconds") {
+            settings.seconds = std::atof(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    const bool have_interface = ::if_nametoindex(settings.interface.c_str()) != 0;
+    std::printf("interface: %s, %.1f s per run\n",
+                have_interface ? settings.interface.c_str() : "none found; UDP loopback stand-in", settings.seconds);
+
+    const Scenario scenarios[] = {
+        {"classic 1M", 8000, false, 64, false},   {"classic 1M b1", 8000, false, 1, false},
+        {"fd 1/5M", 7000, true, 64, false},       {"fd 1/8M", 10000, true, 64, false},
+        {"flat out", 0, false, 64, false},        {"flat out b1", 0, false, 1, false},
+        {"classic 1/16", 8000, false, 64, true},
+    };
+    std::printf("%-14s %10s %10s %10s %9s %12s %9s\n", "run", "offered/s", "frames/s", "wakeups/s", "fr/wakeup",
+                "rx cpu us/fr", "dropped");
+    int failures = 0;
+    for (const auto& scenario : scenarios) {
+        if (scenario.filtered && !have_interface) {
+            continue; // Kernel filters need a CAN socket
+        }
+        const Run run = run_scenario(settings, have_interface, scenario);
+        failures += run.received == 0;
+        const double seconds = run.seconds > 0 ? run.seconds : 1;
+        std::printf("%-14s %10.0f %10.0f %10.0f %9.1f %12.2f %9llu\n", scenario.name, run.offered / seconds,
+                    run.received / seconds, run.batches / seconds,
+                    run.batches ? static_cast<double>(run.received) / static_cast<double>(run.batches) : 0.0,
+                    run.received ? run.rx_cpu_seconds * 1e6 / static_cast<double>(run.received) : 0.0,
+                    static_cast<unsigned long long>(run.dropped));
+    }
+    return failures ? 1 : 0;
+}
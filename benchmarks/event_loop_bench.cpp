@@ -0,0 +1,358 @@
+// Threads, wakeups and CPU for a small robot's I/O: each driver on a thread
+// of its own, against all of them on one or two event loops.
+//
+// The load is four CAN buses (UDP loopback stand-ins, 4000 frames/s each),
+// two serial IMUs (pseudo-terminals, 1 kHz each), and four 1 kHz control
+// loops. The drivers publish to the bus and one subscriber per topic counts
+// what arrives. With threads, every driver has its receive thread, every
+// control loop a thread sleeping until its next period, and the bus its
+// spin thread and executor. On event loops, the drivers, the control loops
+// (`call_every()`) and the bus (`run_bus_on()`) share the loops' threads.
+//
+// Each mode runs in a child process of its own, since the bus is set up
+// once per process. A generator thread plays the devices, writing what is
+// due every millisecond; its CPU and context switches are subtracted.
+// Reported per mode: threads, voluntary context switches per second (a
+// thread blocking and being woken), involuntary ones, CPU, and the messages
+// and control ticks delivered.
+//
+// Usage: event_loop_bench [--seconds N]
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/hal/can_bus.h>
+#include <ignlink/hal/imu.h>
+#include <ignlink/msg/node.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/can.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Settings {
+    double seconds = 3;
+};
+
+constexpr int kBuses = 4;
+constexpr int kFramesPerMs = 4; // Per bus
+constexpr int kImus = 2;
+constexpr int kControlLoops = 4;
+
+// Written by the child to a pipe, so plain data only.
+struct Run {
+    bool ok = false;
+    int threads = 0;
+    double seconds = 0;
+    double cpu_seconds = 0;
+    double voluntary = 0;   // Context switches
+    double involuntary = 0;
+    uint64_t loop_wakeups = 0;
+    uint64_t messages = 0;
+    uint64_t ticks = 0;
+};
+
+double to_seconds(const timeval& tv) {
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+struct Usage {
+    double cpu = 0;
+    double voluntary = 0;
+    double involuntary = 0;
+};
+
+Usage usage(int who) {
+    rusage ru;
+    getrusage(who, &ru);
+    return {to_seconds(ru.ru_utime) + to_seconds(ru.ru_stime), static_cast<double>(ru.ru_nvcsw),
+            static_cast<double>(ru.ru_nivcsw)};
+}
+
+int thread_count() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) {
+            return std::atoi(line.c_str() + 8);
+        }
+    }
+    return 0;
+}
+
+// A connected pair of UDP sockets on loopback; the bus reads the first.
+bool udp_pair(int fds[2]) {
+    for (int i = 0; i < 2; ++i) {
+        fds[i] = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fds[i] < 0 || ::bind(fds[i], reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 2; ++i) {
+        sockaddr_in peer{};
+        socklen_t length = sizeof(peer);
+        ::getsockname(fds[1 - i], reinterpret_cast<sockaddr*>(&peer), &length);
+        if (::connect(fds[i], reinterpret_cast<sockaddr*>(&peer), length) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs one mode; `loop_count` 0 means a thread per driver.
+Run run_mode(const Settings& settings, int loop_count) {
+    Run run;
+    std::vector<std::shared_ptr<core::EventLoop>> loops;
+    for (int i = 0; i < loop_count; ++i) {
+        loops.push_back(std::make_shared<core::EventLoop>("bench" + std::to_string(i)));
+    }
+    if (!loops.empty() && !msg::run_bus_on(loops).ok()) {
+        return run;
+    }
+    auto loop_for = [&](int i) -> core::EventLoop& { return *loops[static_cast<size_t>(i) % loops.size()]; };
+
+    msg::Node node("event_loop_bench");
+    std::atomic<uint64_t> messages{0};
+    std::vector<std::shared_ptr<msg::Subscriber<hal::CanFrameBatch>>> can_subscribers;
+    std::vector<std::shared_ptr<msg::Subscriber<hal::ImuBatch>>> imu_subscribers;
+
+    // CAN buses.
+    std::vector<std::unique_ptr<hal::CanBus>> buses;
+    std::vector<int> can_peers;
+    for (int i = 0; i < kBuses; ++i) {
+        int fds[2];
+        if (!udp_pair(fds)) {
+            std::fprintf(stderr, "Could not create a UDP socket pair\n");
+            return run;
+        }
+        const std::string topic = "/bench/can" + std::to_string(i);
+        auto publisher = node.create_publisher<hal::CanFrameBatch>(topic);
+        can_subscribers.push_back(node.create_subscriber<hal::CanFrameBatch>(
+            topic, [&](const hal::CanFrameBatch& batch) { messages.fetch_add(batch.frames.size()); }));
+        hal::CanBusConfig config;
+        config.interface = "udp-loopback";
+        config.socket_fd = fds[0];
+        auto bus = hal::create_socket_can_bus();
+        if (!bus->open(config).ok()) {
+            return run;
+        }
+        auto callback = [publisher](std::shared_ptr<const hal::CanFrameBatch> batch) {
+            publisher->publish(std::move(batch));
+        };
+        const auto status = loops.empty() ? bus->start(callback) : bus->start(callback, loop_for(i));
+        if (!status.ok()) {
+            std::fprintf(stderr, "%s\n", status.message().c_str());
+            return run;
+        }
+        buses.push_back(std::move(bus));
+        can_peers.push_back(fds[1]);
+    }
+
+    // IMUs.
+    std::vector<std::unique_ptr<hal::Imu>> imus;
+    std::vector<int> imu_masters;
+    for (int i = 0; i < kImus; ++i) {
+        const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+        if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0) {
+            std::fprintf(stderr, "Could not create a pseudo-terminal\n");
+            return run;
+        }
+        const std::string topic = "/bench/imu" + std::to_string(i);
+        auto publisher = node.create_publisher<hal::ImuBatch>(topic);
+        imu_subscribers.push_back(node.create_subscriber<hal::ImuBatch>(
+            topic, [&](const hal::ImuBatch& batch) { messages.fetch_add(batch.count); }));
+        hal::ImuConfig config;
+        config.device = ::ptsname(master);
+        config.baud_rate = 0;
+        auto imu = hal::create_serial_imu();
+        if (!imu->open(config).ok()) {
+            return run;
+        }
+        auto callback = [publisher](std::shared_ptr<const hal::ImuBatch> batch) {
+            publisher->publish(std::move(batch));
+        };
+        const auto status = loops.empty() ? imu->start(callback) : imu->start(callback, loop_for(kBuses + i));
+        if (!status.ok()) {
+            std::fprintf(stderr, "%s\n", status.message().c_str());
+            return run;
+        }
+        imus.push_back(std::move(imu));
+        imu_masters.push_back(master);
+    }
+
+    // Control loops.
+    std::atomic<uint64_t> ticks{0};
+    std::atomic<bool> running{true};
+    std::vector<std::thread> control_threads;
+    for (int i = 0; i < kControlLoops; ++i) {
+        if (loops.empty()) {
+            control_threads.emplace_back([&] {
+                auto next = Clock::now();
+                while (running.load()) {
+                    next += std::chrono::milliseconds(1);
+                    std::this_thread::sleep_until(next);
+                    ticks.fetch_add(1);
+                }
+            });
+        } else {
+            loop_for(i).call_every(std::chrono::milliseconds(1), [&] { ticks.fetch_add(1); });
+        }
+    }
+    for (auto& loop : loops) {
+        loop->start();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Settle
+
+    const Usage before = usage(RUSAGE_SELF);
+    const uint64_t messages_before = messages.load();
+    const uint64_t ticks_before = ticks.load();
+    uint64_t wakeups_before = 0;
+    for (auto& loop : loops) {
+        wakeups_before += loop->stats().wakeups;
+    }
+    Usage generator;
+    const auto start = Clock::now();
+    std::thread generator_thread([&] {
+        const Usage own = usage(RUSAGE_THREAD);
+        const auto end = start + std::chrono::duration<double>(settings.seconds);
+        hal::CanFrame frame;
+        frame.len = 8;
+        hal::ImuSample sample;
+        sample.accel[2] = 9.81f;
+        uint8_t packet[hal::kImuPacketSize];
+        uint32_t sequence = 0;
+        auto next = start;
+        while (next < end) {
+            for (int fd : can_peers) {
+                for (int k = 0; k < kFramesPerMs; ++k) {
+                    frame.id = 0x100 + static_cast<uint32_t>(k);
+                    (void)!::send(fd, &frame, CAN_MTU, MSG_DONTWAIT);
+                }
+            }
+            sample.sequence = sequence;
+            sample.device_time_ns = int64_t(sequence) * 1000000;
+            ++sequence;
+            hal::encode_imu_packet(sample, packet);
+            for (int master : imu_masters) {
+                (void)!::write(master, packet, sizeof(packet));
+            }
+            next += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(next);
+        }
+        const Usage done = usage(RUSAGE_THREAD);
+        generator = {done.cpu - own.cpu, done.voluntary - own.voluntary, done.involuntary - own.involuntary};
+    });
+    std::this_thread::sleep_for(std::chrono::duration<double>(settings.seconds / 2));
+    run.threads = thread_count() - 1; // Not the generator
+    generator_thread.join();
+    const Usage after = usage(RUSAGE_SELF);
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    run.cpu_seconds = after.cpu - before.cpu - generator.cpu;
+    run.voluntary = after.voluntary - before.voluntary - generator.voluntary;
+    run.involuntary = after.involuntary - before.involuntary - generator.involuntary;
+    run.messages = messages.load() - messages_before;
+    run.ticks = ticks.load() - ticks_before;
+    for (auto& loop : loops) {
+        run.loop_wakeups += loop->stats().wakeups;
+    }
+    run.loop_wakeups -= wakeups_before;
+    run.ok = run.messages > 0 && run.ticks > 0;
+
+    running = false;
+    for (auto& thread : control_threads) {
+        thread.join();
+    }
+    for (auto& bus : buses) {
+        bus->close();
+    }
+    for (auto& imu : imus) {
+        imu->close();
+    }
+    for (auto& loop : loops) {
+        loop->stop();
+    }
+    return run;
+}
+
+// Runs a mode in a child process and collects its result.
+Run run_in_child(const Settings& settings, int loop_count) {
+    Run run;
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        return run;
+    }
+    std::fflush(stdout); // Or the child would print the parent's buffer again
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(fds[0]);
+        const Run result = run_mode(settings, loop_count);
+        (void)!::write(fds[1], &result, sizeof(result));
+        std::_Exit(0); // The bus lives until exit; skip tearing it down
+    }
+    ::close(fds[1]);
+    if (pid > 0 && ::read(fds[0], &run, sizeof(run)) != static_cast<ssize_t>(sizeof(run))) {
+        run = Run();
+    }
+    ::close(fds[0]);
+    if (pid > 0) {
+        ::waitpid(pid, nullptr, 0);
+    }
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--seconds") {
+            settings.seconds = std::atof(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    std::printf("%d CAN buses at %d frames/s, %d IMUs at 1 kHz, %d control loops at 1 kHz, %.1f s per run\n", kBuses,
+                kFramesPerMs * 1000, kImus, kControlLoops, settings.seconds);
+
+    struct Mode {
+        const char* name;
+        int loops;
+    };
+    const Mode modes[] = {{"threads", 0}, {"1 loop", 1}, {"2 loops", 2}};
+    std::printf("%-8s %8s %12s %12s %12s %8s %11s %9s\n", "mode", "threads", "vol csw/s", "invol csw/s",
+                "loop wake/s", "cpu %", "messages/s", "ticks/s");
+    int failures = 0;
+    for (const auto& mode : modes) {
+        const Run run = run_in_child(settings, mode.loops);
+        failures += !run.ok;
+        const double seconds = run.seconds > 0 ? run.seconds : 1;
+        std::printf("%-8s %8d %12.0f %12.0f %12.0f %8.1f %11.0f %9.0f\n", mode.name, run.threads,
+                    run.voluntary / seconds, run.involuntary / seconds, run.loop_wakeups / seconds,
+                    run.cpu_seconds * 100 / seconds, run.messages / seconds, run.ticks / seconds);
+    }
+    return failures;
+}
@@ -0,0 +1,528 @@
+// Publish-to-callback latency and throughput across transports, message sizes and fan-out.
+//
+// For every combination of transport (intra-process bus, IPC, UDP loopback),
+// message size and number of subscribers, two phases are run:
+//
+//   latency     One message in flight at a time: publish, wait until every
+//               subscriber has seen it, repeat. Each subscriber records the
+//               time from just before the publish to its callback.
+//   throughput  Messages are published back to back; the rate is measured
+//               up to the last delivery. Transports that drop messages
+//               rather than block (IPC, UDP) report what they lost.
+//
+// Messages are uint8 core::Tensors carrying their publish time, sent the way
+// an application would: loaned from the publisher's pool on the bus, loaned
+// from shared memory on IPC, serialized on UDP. Subscribers take the shared
+// (zero-copy) delivery.
+//
+// Results are written as JSON, one result per line, so that a run can be
+// stored and used as the baseline of a later one:
+//
+//   ignlink_bench --output baseline.json
+//   ignlink_bench --baseline baseline.json --threshold 15
+//
+// With --baseline, every configuration whose p50 or p99 latency grew, or
+// whose throughput fell, by more than the threshold (percent) is reported,
+// and the exit code is 1.
+//
+// Usage: ignlink_bench [--transports intra,ipc,udp] [--sizes 64,4K,1M,8M]
+//                      [--fanouts 1,4,32] [--iterations N] [--quick]
+//                      [--output FILE] [--baseline FILE] [--threshold PCT]
+
+#include <ignlink/core/logger.h>
+#include <ignlink/core/tensor.h>
+#include <ignlink/msg/node.h>
+#include <ignlink/msg/transport/ipc.h>
+#include <ignlink/msg/transport/typed.h>
+#include <ignlink/msg/transport/udp.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ignlink;
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kHistogramBuckets = 40; // Bucket i counts latencies in [2^i, 2^(i+1)) ns
+constexpr auto kDeliveryTimeout = std::chrono::milliseconds(500);
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+struct Options {
+    std::vector<std::string> transports = {"intra", "ipc", "udp"};
+    std::vector<size_t> sizes = {64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+    std::vector<size_t> fanouts = {1, 4, 32};
+    size_t iterations = 2000; // Latency samples per configuration, for small messages
+    std::string output;
+    std::string baseline;
+    double threshold = 10.0;
+};
+
+struct Result {
+    std::string transport;
+    size_t size = 0;
+    size_t fanout = 0;
+
+    // Latency phase
+    size_t samples = 0;
+    int64_t p50_ns = 0, p99_ns = 0, p999_ns = 0, max_ns = 0;
+    double mean_ns = 0.0;
+    uint64_t histogram[kHistogramBuckets] = {};
+
+    // Throughput phase
+    size_t sent = 0;
+    uint64_t delivered = 0;
+    double messages_per_s = 0.0;
+    double megabytes_per_s = 0.0;
+
+    std::string name() const {
+        return transport + "/" + std::to_string(size) + "B/x" + std::to_string(fanout);
+    }
+};
+
+/**
+ * @brief What the subscribers of one configuration share with the driver.
+ */
+struct Sink {
+    explicit Sink(size_t fanout) : latencies(fanout) {}
+
+    void on_message(size_t subscriber, const core::Tensor& msg, bool record) {
+        const int64_t now = now_ns();
+        if (record) {
+            latencies[subscriber].push_back(now - msg.timestamp); // Reserved up front
+        }
+        last_delivery_ns.store(now, std::memory_order_relaxed);
+        received.fetch_add(1, std::memory_order_release);
+    }
+
+    // Waits until `target` deliveries have arrived, or until none has for a while.
+    bool wait_for(uint64_t target) const {
+        uint64_t seen = received.load(std::memory_order_acquire);
+        auto progress = Clock::now();
+        while (seen < target) {
+            std::this_thread::yield();
+            const uint64_t current = received.load(std::memory_order_acquire);
+            if (current != seen) {
+                seen = current;
+                progress = Clock::now();
+            } else if (Clock::now() - progress > kDeliveryTimeout) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::vector<int64_t>> latencies; // One per subscriber, each written by one thread at a time
+    std::atomic<uint64_t> received{0};
+    std::atomic<int64_t> last_delivery_ns{0};
+    std::atomic<bool> recording{true};
+};
+
+/**
+ * @brief One transport's way of creating subscribers and publishing a message.
+ */
+class Harness {
+public:
+    virtual ~Harness() = default;
+    virtual bool ok() const = 0;
+    virtual void publish(size_t size) = 0;
+};
+
+class IntraHarness : public Harness {
+public:
+    IntraHarness(const std::string& topic, size_t fanout, Sink& sink) : node_("ignlink_bench") {
+        // Reliable on both ends, so the throughput phase measures delivery
+        // under backpressure rather than how fast messages can be dropped.
+        const auto qos = msg::QoS::keep_all(64, std::chrono::seconds(1));
+        publisher_ = node_.create_publisher<core::Tensor>(topic, qos);
+        for (size_t i = 0; i < fanout; ++i) {
+            subscribers_.push_back(node_.create_subscriber<core::Tensor>(
+                topic, [&sink, i](std::shared_ptr<const core::Tensor> msg) {
+                    sink.on_message(i, *msg, sink.recording.load(std::memory_order_relaxed));
+                }, nullptr, qos));
+        }
+    }
+
+    bool ok() const override {
+        return publisher_ && std::all_of(subscribers_.begin(), subscribers_.end(), [](const auto& s) { return s; });
+    }
+
+    void publish(size_t size) override {
+        auto msg = publisher_->loan();
+        msg->resize(core::DType::UInt8, {static_cast<int64_t>(size)}); // Reuses the pooled storage
+        msg->timestamp = now_ns();
+        publisher_->publish(std::move(msg));
+    }
+
+private:
+    msg::Node node_;
+    std::shared_ptr<msg::Publisher<core::Tensor>> publisher_;
+    std::vector<std::shared_ptr<msg::Subscriber<core::Tensor>>> subscribers_;
+};
+
+/**
+ * @brief IPC and UDP: a typed writer, and one reader thread per subscriber.
+ */
+class TransportHarness : public Harness {
+public:
+    TransportHarness(std::unique_ptr<msg::transport::BaseTransport> transport, const std::string& topic,
+                     size_t size, size_t fanout, Sink& sink)
+        : transport_(std::move(transport)) {
+        msg::transport::TopicOptions options;
+        options.topic_name = topic;
+        options.max_message_size = msg::detail::tensor_header_size(1) + size;
+        options.depth = size >= 1024 * 1024 ? 4 : 64; // Bounds the shared memory used by large topics
+        status_ = msg::transport::TypedWriter<core::Tensor>::create(*transport_, options, &writer_);
+        for (size_t i = 0; status_.ok() && i < fanout; ++i) {
+            std::unique_ptr<msg::transport::TypedReader<core::Tensor>> reader;
+            status_ = msg::transport::TypedReader<core::Tensor>::create(*transport_, options, &reader);
+            if (status_.ok()) {
+                readers_.push_back(std::move(reader));
+            }
+        }
+        for (size_t i = 0; i < readers_.size(); ++i) {
+            threads_.emplace_back([this, &sink, i] {
+                auto& reader = *readers_[i];
+                while (!stop_.load(std::memory_order_relaxed)) {
+                    if (reader.wait(std::chrono::milliseconds(10))) {
+                        reader.poll_shared([&sink, i](std::shared_ptr<const core::Tensor> msg) {
+                            sink.on_message(i, *msg, sink.recording.load(std::memory_order_relaxed));
+                        });
+                    }
+                }
+            });
+        }
+        if (transport_ && std::strcmp(transport_->name(), "udp") == 0) {
+            // Give the readers' multicast group joins time to take effect.
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+
+    ~TransportHarness() override {
+        stop_.store(true);
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    bool ok() const override { return status_.ok(); }
+    const core::Status& status() const { return status_; }
+
+    void publish(size_t size) override {
+        const int64_t shape[1] = {static_cast<int64_t>(size)};
+        if (writer_->raw().supports_loans()) {
+            core::Tensor msg;
+            if (writer_->loan(core::DType::UInt8, shape, 1, &msg).ok()) {
+                msg.timestamp = now_ns();
+                writer_->commit(msg);
+                return;
+            }
+        }
+        if (scratch_.numel() != size) {
+            scratch_ = core::Tensor(core::DType::UInt8, shape, 1);
+            std::memset(scratch_.data(), 0, size);
+        }
+        scratch_.timestamp = now_ns();
+        writer_->write(scratch_);
+    }
+
+private:
+    std::unique_ptr<msg::transport::BaseTransport> transport_;
+    core::Status status_;
+    std::unique_ptr<msg::transport::TypedWriter<core::Tensor>> writer_;
+    std::vector<std::unique_ptr<msg::transport::TypedReader<core::Tensor>>> readers_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stop_{false};
+    core::Tensor scratch_; // Message for transports without loans
+};
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+bool run(const Options& options, const std::string& transport, size_t size, size_t fanout, Result* result) {
+    result->transport = transport;
+    result->size = size;
+    result->fanout = fanout;
+
+    // Scale the work with the message size so that 8 MB runs stay short.
+    const size_t iterations = std::clamp<size_t>((64u << 20) / size, 50, options.iterations);
+    const size_t burst = std::clamp<size_t>((256u << 20) / size, 20, 20000);
+
+    Sink sink(fanout);
+    for (auto& latencies : sink.latencies) {
+        latencies.reserve(iterations);
+    }
+
+    const std::string topic = "/ignlink_bench/" + std::to_string(size) + "_" + std::to_string(fanout);
+    std::unique_ptr<Harness> harness;
+    std::unique_ptr<msg::transport::IpcTransport> ipc_cleanup;
+    if (transport == "intra") {
+        harness = std::make_unique<IntraHarness>(topic, fanout, sink);
+    } else if (transport == "ipc") {
+        const std::string domain = "ignlink_bench_" + std::to_string(::getpid());
+        ipc_cleanup = std::make_unique<msg::transport::IpcTransport>(domain);
+        harness = std::make_unique<TransportHarness>(std::make_unique<msg::transport::IpcTransport>(domain),
+                                                     topic, size, fanout, sink);
+    } else if (transport == "udp") {
+        harness = std::make_unique<TransportHarness>(std::make_unique<msg::transport::UdpTransport>(),
+                                                     topic, size, fanout, sink);
+    } else {
+        std::fprintf(stderr, "Unknown transport '%s'.\n", transport.c_str());
+        return false;
+    }
+    if (!harness->ok()) {
+        const auto* failed = dynamic_cast<const TransportHarness*>(harness.get());
+        std::fprintf(stderr, "Skipping %s: %s\n", result->name().c_str(),
+                     failed ? failed->status().message().c_str() : "could not create the topic");
+        return false;
+    }
+
+    // Latency: one message in flight at a time.
+    uint64_t expected = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        harness->publish(size);
+        expected += fanout;
+        if (!sink.wait_for(expected)) {
+            expected = sink.received.load(); // Lost on a lossy transport; carry on
+        }
+    }
+
+    std::vector<int64_t> all;
+    for (const auto& latencies : sink.latencies) {
+        all.insert(all.end(), latencies.begin(), latencies.end());
+    }
+    std::sort(all.begin(), all.end());
+    result->samples = all.size();
+    result->p50_ns = percentile(all, 0.50);
+    result->p99_ns = percentile(all, 0.99);
+    result->p999_ns = percentile(all, 0.999);
+    result->max_ns = all.empty() ? 0 : all.back();
+    double sum = 0.0;
+    for (int64_t latency : all) {
+        sum += static_cast<double>(latency);
+        size_t bucket = 0;
+        while (bucket + 1 < kHistogramBuckets && (int64_t(1) << (bucket + 1)) <= latency) {
+            ++bucket;
+        }
+        ++result->histogram[bucket];
+    }
+    result->mean_ns = all.empty() ? 0.0 : sum / static_cast<double>(all.size());
+
+    // Throughput: back to back, measured up to the last delivery.
+    sink.recording.store(false);
+    const uint64_t before = sink.received.load();
+    const int64_t start = now_ns();
+    for (size_t i = 0; i < burst; ++i) {
+        harness->publish(size);
+    }
+    sink.wait_for(before + burst * fanout);
+    const uint64_t delivered = sink.received.load() - before;
+    const double seconds = static_cast<double>(std::max<int64_t>(1, sink.last_delivery_ns.load() - start)) * 1e-9;
+    result->sent = burst;
+    result->delivered = delivered;
+    result->messages_per_s = static_cast<double>(delivered) / seconds;
+    result->megabytes_per_s = result->messages_per_s * static_cast<double>(size) / 1e6;
+
+    harness.reset();
+    if (ipc_cleanup) {
+        ipc_cleanup->unlink(topic);
+    }
+    return true;
+}
+
+std::string to_json(const Result& r) {
+    std::ostringstream out;
+    out << "{\"name\":\"" << r.name() << "\",\"transport\":\"" << r.transport << "\",\"size\":" << r.size
+        << ",\"fanout\":" << r.fanout << ",\"samples\":" << r.samples << ",\"p50_ns\":" << r.p50_ns
+        << ",\"p99_ns\":" << r.p99_ns << ",\"p999_ns\":" << r.p999_ns << ",\"max_ns\":" << r.max_ns
+        << ",\"mean_ns\":" << static_cast<int64_t>(r.mean_ns) << ",\"sent\":" << r.sent
+        << ",\"delivered\":" << r.delivered << ",\"messages_per_s\":" << static_cast<int64_t>(r.messages_per_s)
+        << ",\"megabytes_per_s\":" << r.megabytes_per_s << ",\"histogram_log2_ns\":[";
+    for (size_t i = 0; i < kHistogramBuckets; ++i) {
+        out << (i ? "," : "") << r.histogram[i];
+    }
+    out << "]}";
+    return out.str();
+}
+
+/**
+ * @brief Reads back the files this tool writes: one result object per line.
+ */
+std::map<std::string, std::map<std::string, double>> load_baseline(const std::string& path) {
+    std::map<std::string, std::map<std::string, double>> baseline;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t name_at = line.find("\"name\":\"");
+        if (name_at == std::string::npos) {
+            continue;
+        }
+        const size_t begin = name_at + 8;
+        const std::string name = line.substr(begin, line.find('"', begin) - begin);
+        for (const char* key : {"p50_ns", "p99_ns", "messages_per_s"}) {
+            const size_t at = line.find(std::string("\"") + key + "\":");
+            if (at != std::string::npos) {
+                baseline[name][key] = std::strtod(line.c_str() + at + std::strlen(key) + 3, nullptr);
+            }
+        }
+    }
+    return baseline;
+}
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Accepts plain byte counts and K/M suffixes, e.g. "64", "4K", "8M".
+size_t parse_size(const std::string& text) {
+    char* end = nullptr;
+    size_t value = std::strtoul(text.c_str(), &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        value *= 1024;
+    } else if (*end == 'M' || *end == 'm') {
+        value *= 1024 * 1024;
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--transports") {
+            options.transports = split(value), ++i;
+        } else if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const auto& size : split(value)) {
+                options.sizes.push_back(parse_size(size));
+            }
+            ++i;
+        } else if (arg == "--fanouts") {
+            options.fanouts.clear();
+            for (const auto& fanout : split(value)) {
+                options.fanouts.push_back(std::strtoul(fanout.c_str(), nullptr, 10));
+            }
+            ++i;
+        } else if (arg == "--iterations") {
+            options.iterations = std::strtoul(value, nullptr, 10), ++i;
+        } else if (arg == "--quick") {
+            options.sizes = {64, 64 * 1024, 1024 * 1024};
+            options.fanouts = {1, 8};
+            options.iterations = 500;
+        } else if (arg == "--output") {
+            options.output = value, ++i;
+        } else if (arg == "--baseline") {
+            options.baseline = value, ++i;
+        } else if (arg == "--threshold") {
+            options.threshold = std::strtod(value, nullptr), ++i;
+        } else {
+            std::fprintf(stderr, "Unknown option '%s'; see the top of ignlink_bench.cpp for usage.\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    // Keep the bus's own info logging out of the measurements.
+    core::Logger::init("ignlink_bench", core::Logger::Level::Warn);
+
+    std::vector<Result> results;
+    std::fprintf(stderr, "%-22s %10s %10s %10s %10s %12s %10s %8s\n", "config", "p50_us", "p99_us", "p99.9_us",
+                 "max_us", "msgs/s", "MB/s", "lost%");
+    for (const auto& transport : options.transports) {
+        for (size_t size : options.sizes) {
+            for (size_t fanout : options.fanouts) {
+                Result result;
+                if (!run(options, transport, size, fanout, &result)) {
+                    continue;
+                }
+                const double expected = static_cast<double>(result.sent * result.fanout);
+                std::fprintf(stderr, "%-22s %10.1f %10.1f %10.1f %10.1f %12.0f %10.1f %8.2f\n",
+                             result.name().c_str(), result.p50_ns / 1e3, result.p99_ns / 1e3, result.p999_ns / 1e3,
+                             result.max_ns / 1e3, result.messages_per_s, result.megabytes_per_s,
+                             100.0 * (1.0 - static_cast<double>(result.delivered) / expected));
+                results.push_back(result);
+            }
+        }
+    }
+
+    std::ostringstream json;
+    json << "{\"suite\":\"ignlink_bench\",\"hardware_threads\":" << std::thread::hardware_concurrency()
+         << ",\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        json << to_json(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "]}\n";
+    if (options.output.empty()) {
+        std::fputs(json.str().c_str(), stdout);
+    } else {
+        std::ofstream(options.output) << json.str();
+    }
+
+    if (options.baseline.empty()) {
+        return 0;
+    }
+    const auto baseline = load_baseline(options.baseline);
+    if (baseline.empty()) {
+        std::fprintf(stderr, "Could not read any results from baseline '%s'.\n", options.baseline.c_str());
+        return 2;
+    }
+    const double limit = options.threshold / 100.0;
+    size_t regressions = 0;
+    for (const auto& result : results) {
+        const auto it = baseline.find(result.name());
+        if (it == baseline.end()) {
+            continue;
+        }
+        const auto& before = it->second;
+        const auto report = [&](const char* metric, double old_value, double new_value, bool higher_is_worse) {
+            if (old_value <= 0.0) {
+                return;
+            }
+            const double change = (new_value - old_value) / old_value;
+            if (higher_is_worse ? change > limit : -change > limit) {
+                std::fprintf(stderr, "REGRESSION %s %s: %.0f -> %.0f (%+.1f%%)\n", result.name().c_str(), metric,
+                             old_value, new_value, change * 100.0);
+                ++regressions;
+            }
+        };
+        report("p50_ns", before.count("p50_ns") ? before.at("p50_ns") : 0.0, static_cast<double>(result.p50_ns), true);
+        report("p99_ns", before.count("p99_ns") ? before.at("p99_ns") : 0.0, static_cast<double>(result.p99_ns), true);
+        report("messages_per_s", before.count("messages_per_s") ? before.at("messages_per_s") : 0.0,
+               result.messages_per_s, false);
+    }
+    std::fprintf(stderr, "%zu regression(s) beyond %.1f%% against %s.\n", regressions, options.threshold,
+                 options.baseline.c_str());
+    return regressions ? 1 : 0;
+}
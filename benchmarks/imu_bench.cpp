@@ -0,0 +1,178 @@
+// Receive cost of the serial IMU at 1, 2 and 4 kHz, through the bus.
+//
+// A generator thread plays the sensor on the master side of a pseudo-
+// terminal, writing the packets that are due every 250 us, the way a UART
+// FIFO hands them over a few at a time. The IMU reads the slave side and its
+// batches go to a publisher and on to an intra-process subscriber. Reported
+// per run: samples delivered per second, read system calls and batches per
+// second, and CPU per sample on the receive side (process CPU minus the
+// generator's). Runs with batch size 1 show what reading and publishing
+// every sample on its own costs.
+//
+// A pseudo-terminal has no baud rate, so the runs are limited by the
+// generator, not the line; at 921600 baud a UART carries about 2500 of these
+// 36-byte packets a second, and 4 kHz needs 2 Mbaud or a USB link.
+//
+// Usage: imu_bench [--seconds N]
+
+#include <ignlink/hal/imu.h>
+#include <ignlink/msg/node.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Settings {
+    double seconds = 3;
+};
+
+struct Scenario {
+    const char* name;
+    double rate; // Samples per second
+    size_t batch_size;
+};
+
+struct Run {
+    uint64_t offered = 0;
+    uint64_t received = 0;
+    uint64_t reads = 0;
+    uint64_t batches = 0;
+    double seconds = 0;
+    double rx_cpu_seconds = 0;
+};
+
+double process_cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+Run run_scenario(const Settings& settings, const Scenario& scenario) {
+    Run run;
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || ::grantpt(master) != 0 || ::unlockpt(master) != 0) {
+        std::fprintf(stderr, "Could not create a pseudo-terminal\n");
+        return run;
+    }
+    hal::ImuConfig config;
+    config.device = ::ptsname(master);
+    config.baud_rate = 0;
+    config.batch_size = scenario.batch_size;
+    auto imu = hal::create_serial_imu();
+    const auto status = imu->open(config);
+    if (!status.ok()) {
+        std::fprintf(stderr, "%s\n", status.message().c_str());
+        ::close(master);
+        return run;
+    }
+
+    msg::Node node("imu_bench");
+    auto publisher = node.create_publisher<hal::ImuBatch>("/imu_bench/imu", msg::QoS::keep_all(64));
+    std::atomic<uint64_t> received{0};
+    auto subscriber = node.create_subscriber<hal::ImuBatch>(
+        "/imu_bench/imu", [&](const hal::ImuBatch& batch) { received.fetch_add(batch.count, std::memory_order_relaxed); },
+        nullptr, msg::QoS::keep_all(1024));
+    imu->start([&](std::shared_ptr<const hal::ImuBatch> batch) { publisher->publish(std::move(batch)); });
+
+    double generator_cpu = 0;
+    const double cpu_start = process_cpu_seconds();
+    const auto start = Clock::now();
+    std::thread generator([&] {
+        const double cpu = thread_cpu_seconds();
+        const auto end = start + std::chrono::duration<double>(settings.seconds);
+        std::vector<uint8_t> chunk;
+        hal::ImuSample sample;
+        sample.accel[2] = 9.81f;
+        sample.temperature = 35.0f;
+        uint64_t sent = 0;
+        for (auto now = Clock::now(); now < end; now = Clock::now()) {
+            const double elapsed = std::chrono::duration<double>(now - start).count();
+            const uint64_t due = static_cast<uint64_t>(elapsed * scenario.rate);
+            chunk.resize((due - sent) * hal::kImuPacketSize);
+            for (size_t i = 0; sent < due; ++sent, ++i) {
+                sample.sequence = static_cast<uint32_t>(sent);
+                sample.device_time_ns = static_cast<int64_t>(static_cast<double>(sent) * 1e9 / scenario.rate);
+                sample.gyro[0] = 0.001f * static_cast<float>(sent % 1000);
+                hal::encode_imu_packet(sample, &chunk[i * hal::kImuPacketSize]);
+            }
+            for (size_t done = 0; done < chunk.size();) {
+                const ssize_t n = ::write(master, chunk.data() + done, chunk.size() - done);
+                if (n <= 0) {
+                    break;
+                }
+                done += static_cast<size_t>(n);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+        run.offered = sent;
+        generator_cpu = thread_cpu_seconds() - cpu;
+    });
+    generator.join();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100)); // Let the last partial batch out
+    imu->stop();
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count() - 0.1;
+    run.rx_cpu_seconds = process_cpu_seconds() - cpu_start - generator_cpu;
+    const auto stats = imu->stats();
+    run.received = received.load();
+    run.reads = stats.reads;
+    run.batches = stats.batches;
+    imu->close();
+    ::close(master);
+    return run;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--seconds") {
+            settings.seconds = std::atof(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    std::printf("pseudo-terminal, %.1f s per run\n", settings.seconds);
+
+    const Scenario scenarios[] = {
+        {"1 kHz b32", 1000, 32}, {"1 kHz b1", 1000, 1}, {"2 kHz b32", 2000, 32},
+        {"4 kHz b64", 4000, 64}, {"4 kHz b32", 4000, 32}, {"4 kHz b8", 4000, 8}, {"4 kHz b1", 4000, 1},
+    };
+    std::printf("%-10s %10s %10s %8s %10s %13s %12s\n", "run", "offered/s", "samples/s", "reads/s", "batches/s",
+                "rx cpu us/smp", "rx cpu %");
+    int failures = 0;
+    for (const auto& scenario : scenarios) {
+        const Run run = run_scenario(settings, scenario);
+        failures += run.received == 0;
+        const double seconds = run.seconds > 0 ? run.seconds : 1;
+        std::printf("%-10s %10.0f %10.0f %8.0f %10.0f %13.2f %12.2f\n", scenario.name, run.offered / seconds,
+                    run.received / seconds, run.reads / seconds, run.batches / seconds,
+                    run.received ? run.rx_cpu_seconds * 1e6 / static_cast<double>(run.received) : 0.0,
+                    run.rx_cpu_seconds * 100 / seconds);
+    }
+    return failures ? 1 : 0;
+}
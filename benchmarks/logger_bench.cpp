@@ -0,0 +1,78 @@
+// Cost of a log call on the calling thread.
+//
+// Measures, in nanoseconds per call:
+//   - an enabled call in Async mode (record queued in the thread's ring),
+//   - the same call in Sync mode (formatted and written in place), for reference,
+//   - a call filtered out by the runtime level,
+//   - a call below IGNLINK_LOG_ACTIVE_LEVEL, which is compiled out.
+// Async calls are timed in batches that fit the ring; the writer drains
+// between batches, outside the timed region, so nothing is dropped.
+//
+// The log lines go to stdout; run it as `logger_bench > /dev/null`, the
+// results are printed to stderr.
+//
+// Usage: logger_bench [calls]
+
+// Compile trace logging out of this file, whatever the build type.
+#define IGNLINK_LOG_ACTIVE_LEVEL 1
+#include <ignlink/core/logger.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ignlink::core::Logger;
+
+constexpr size_t kBatch = 1000;
+
+template <typename F>
+double ns_per_call(size_t calls, F&& body, bool flush_between_batches) {
+    std::chrono::nanoseconds total{0};
+    size_t done = 0;
+    for (; done < calls; done += kBatch) {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < kBatch; ++i) {
+            body(done + i);
+        }
+        total += Clock::now() - start;
+        if (flush_between_batches) {
+            Logger::flush();
+        }
+    }
+    return static_cast<double>(total.count()) / static_cast<double>(done);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const std::string topic = "/camera/front/image_raw";
+
+    Logger::init("logger_bench", Logger::Level::Info, Logger::Mode::Async);
+    const double async_ns = ns_per_call(calls, [&](size_t i) {
+        Logger::info("Published message {} on '{}' ({} bytes, {:.3f} ms)", i, topic, 4096, 0.25);
+    }, true);
+    const double filtered_ns = ns_per_call(calls, [&](size_t i) {
+        Logger::debug("Published message {} on '{}'", i, topic);
+    }, false);
+    const double compiled_out_ns = ns_per_call(calls, [&](size_t i) {
+        Logger::trace("Published message {} on '{}'", i, topic);
+    }, false);
+
+    Logger::init("logger_bench", Logger::Level::Info, Logger::Mode::Sync);
+    const double sync_ns = ns_per_call(calls / 10, [&](size_t i) {
+        Logger::info("Published message {} on '{}' ({} bytes, {:.3f} ms)", i, topic, 4096, 0.25);
+    }, false);
+
+    std::fprintf(stderr, "%-22s %10s\n", "call", "ns/call");
+    std::fprintf(stderr, "%-22s %10.1f\n", "async, enabled", async_ns);
+    std::fprintf(stderr, "%-22s %10.1f\n", "sync, enabled", sync_ns);
+    std::fprintf(stderr, "%-22s %10.1f\n", "filtered at runtime", filtered_ns);
+    std::fprintf(stderr, "%-22s %10.1f\n", "compiled out", compiled_out_ns);
+    std::fprintf(stderr, "dropped records: %llu\n", static_cast<unsigned long long>(Logger::dropped_records()));
+    return 0;
+}
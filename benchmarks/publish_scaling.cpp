@@ -0,0 +1,103 @@
+// Publish throughput across many topics as the number of publishing threads grows.
+//
+// Every one of kTopics topics has one subscriber. Each publisher thread owns a
+// disjoint slice of the topics and publishes a shared, preallocated message
+// round-robin over it, so the numbers measure the publish path itself
+// (topic lookup, subscriber snapshot, delivery queueing), not allocation.
+//
+// Usage: publish_scaling [max_threads] [messages_per_thread]
+
+#include <ignlink/msg/node.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kTopics = 1000;
+
+using Clock = std::chrono::steady_clock;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::max<size_t>(8, hardware);
+    const size_t per_thread = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+
+    ignlink::msg::Node node("publish_scaling");
+
+    std::atomic<uint64_t> delivered{0};
+    std::vector<std::shared_ptr<ignlink::msg::Publisher<uint64_t>>> publishers;
+    std::vector<std::shared_ptr<ignlink::msg::Subscriber<uint64_t>>> subscribers;
+    for (size_t i = 0; i < kTopics; ++i) {
+        const std::string topic = "/bench/topic_" + std::to_string(i);
+        publishers.push_back(node.create_publisher<uint64_t>(topic));
+        subscribers.push_back(node.create_subscriber<uint64_t>(
+            topic, [&delivered](const uint64_t&) { delivered.fetch_add(1, std::memory_order_relaxed); }));
+    }
+    const auto msg = std::make_shared<const uint64_t>(42);
+
+    std::printf("topics=%zu messages_per_thread=%zu hardware_threads=%zu\n", kTopics, per_thread, hardware);
+    std::printf("%8s %16s %16s %10s\n", "threads", "publishes/s", "per_thread/s", "speedup");
+
+    double single = 0.0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        const auto settled = [&] {
+            uint64_t total = delivered.load();
+            for (const auto& subscriber : subscribers) {
+                total += subscriber->dropped_messages(); // Default KeepLast queues drop when full
+            }
+            return total;
+        };
+        const uint64_t expected = settled() + threads * per_thread;
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                const size_t begin = t * kTopics / threads;
+                const size_t end = (t + 1) * kTopics / threads;
+                ready.fetch_add(1);
+                while (!go.load()) {
+                    std::this_thread::yield();
+                }
+                size_t topic = begin;
+                for (size_t i = 0; i < per_thread; ++i) {
+                    publishers[topic]->publish(msg);
+                    if (++topic == end) {
+                        topic = begin;
+                    }
+                }
+            });
+        }
+        while (ready.load() < threads) {
+            std::this_thread::yield();
+        }
+        const auto start = Clock::now();
+        go.store(true);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Let the bus drain so the next round starts from an empty queue.
+        while (settled() < expected) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const double rate = threads * per_thread / seconds;
+        if (threads == 1) {
+            single = rate;
+        }
+        std::printf("%8zu %16.0f %16.0f %9.2fx\n", threads, rate, rate / threads, rate / single);
+    }
+    return 0;
+}
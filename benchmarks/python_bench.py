@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# Frames per second delivered to Python, against what the C++ subscriber
+# underneath receives in the same run.
+#
+# Frames come from the simulated file-backed camera (as in camera_bench),
+# captured flat out and published from its capture thread. Each Python
+# subscriber queues them on the C++ side, where they are counted as received,
+# and hands them to Python one batch per GIL acquisition: through a callback
+# taking one frame per batch (a GIL round trip per frame), through one taking
+# up to 64, or pulled with take(). Python reads one byte of each frame through
+# a NumPy view, the zero-copy path; frames Python cannot keep up with are
+# dropped from the queue rather than slowing the camera down.
+#
+# Usage: python_bench.py [--seconds N] [--dir PATH]   (with the module built, see bindings/python/setup.py)
+
+import argparse
+import os
+import resource
+import threading
+import time
+
+import numpy as np
+
+import ignlink
+
+RESOLUTIONS = [("vga", 640, 480), ("1080p", 1920, 1080)]
+BUFFERS = 16
+DEPTH = 8  # Below BUFFERS, so that frames queued for Python never starve the camera
+
+
+def write_frames(directory, name, width, height):
+    path = os.path.join(directory, name + ".yuyv")
+    frame = (np.arange(width * height * 2, dtype=np.uint32) // 7).astype(np.uint8)
+    with open(path, "wb") as out:
+        for k in range(4):
+            out.write((frame + np.uint8(k * 16)).tobytes())
+    return path
+
+
+def cpu_seconds():
+    usage = resource.getrusage(resource.RUSAGE_SELF)
+    return usage.ru_utime + usage.ru_stime
+
+
+def run(path, width, height, mode, seconds):
+    config = ignlink.CameraConfig()
+    config.device = "file:" + path
+    config.width = width
+    config.height = height
+    config.format = ignlink.PixelFormat.YUYV
+    config.fps = 0  # The simulated device's default: flat out
+    config.buffer_count = BUFFERS
+    camera = ignlink.Camera(config)
+    node = ignlink.Node("python_bench")
+    topic = "/python_bench/image"
+
+    checksum = 0
+
+    def consume(frames):
+        nonlocal checksum
+        for frame in frames:
+            checksum += int(np.asarray(frame.image)[0, 0, 0])
+
+    stop = threading.Event()
+    puller = None
+    if mode == "take()":
+        sub = node.create_subscriber(topic, ignlink.CameraFrame, depth=DEPTH)
+
+        def pull():
+            while not stop.is_set():
+                consume(sub.take(timeout=0.05))
+
+        puller = threading.Thread(target=pull)
+        puller.start()
+    else:
+        sub = node.create_subscriber(topic, ignlink.CameraFrame, consume, depth=DEPTH,
+                                     max_batch=1 if mode == "batch 1" else 64)
+
+    cpu_start = cpu_seconds()
+    start = time.monotonic()
+    camera.start(node, topic)
+    time.sleep(seconds)
+    camera.stop()
+    elapsed = time.monotonic() - start
+    cpu = cpu_seconds() - cpu_start
+    stop.set()
+    if puller:
+        puller.join()
+    stats = sub.stats()
+    sub.close()
+    return stats, elapsed, cpu
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--seconds", type=float, default=3)
+    parser.add_argument("--dir", default="/tmp/ignlink_python_bench")
+    args = parser.parse_args()
+    os.makedirs(args.dir, exist_ok=True)
+
+    print(f"simulated camera, YUYV, {BUFFERS} buffers, queue depth {DEPTH}, {args.seconds:.1f} s per run")
+    print(f"{'size':<6} {'python path':<12} {'C++ fr/s':>10} {'Python fr/s':>12} {'ratio':>7} "
+          f"{'batch':>7} {'cpu ms/fr':>10} {'dropped':>9}")
+    for name, width, height in RESOLUTIONS:
+        path = write_frames(args.dir, name, width, height)
+        for mode in ("batch 1", "batch 64", "take()"):
+            stats, elapsed, cpu = run(path, width, height, mode, args.seconds)
+            received = stats["received"] / elapsed
+            delivered = stats["delivered"] / elapsed
+            batch = stats["delivered"] / stats["batches"] if stats["batches"] else 0
+            cpu_ms = cpu * 1e3 / stats["received"] if stats["received"] else 0
+            print(f"{name:<6} {mode:<12} {received:>10.1f} {delivered:>12.1f} "
+                  f"{delivered / received if received else 0:>7.2f} {batch:>7.1f} {cpu_ms:>10.3f} "
+                  f"{stats['dropped']:>9}")
+        os.remove(path)
+
+
+if __name__ == "__main__":
+    main()
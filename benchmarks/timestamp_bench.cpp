@@ -0,0 +1,48 @@
+// Cost of reading core::MonotonicClock, against clock_gettime and std::chrono.
+//
+// Usage: timestamp_bench [reads]
+
+#include <ignlink/core/timestamp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using ignlink::core::MonotonicClock;
+
+template <typename F>
+double ns_per_read(size_t reads, F&& read) {
+    int64_t sink = 0;
+    const int64_t start = ignlink::core::detail::clock_monotonic_ns();
+    for (size_t i = 0; i < reads; ++i) {
+        sink += read();
+    }
+    const int64_t elapsed = ignlink::core::detail::clock_monotonic_ns() - start;
+    // Keep the reads from being optimized away.
+    if (sink == 42) {
+        std::printf(" ");
+    }
+    return static_cast<double>(elapsed) / static_cast<double>(reads);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t reads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000000;
+
+    MonotonicClock::calibrate();
+    const double clock_ns = ns_per_read(reads, [] { return MonotonicClock::now_ns(); });
+    const double gettime_ns = ns_per_read(reads, [] { return ignlink::core::detail::clock_monotonic_ns(); });
+    const double chrono_ns = ns_per_read(reads, [] {
+        return static_cast<int64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    });
+
+    std::printf("source: %s\n", MonotonicClock::source_name());
+    std::printf("%-34s %8s\n", "clock", "ns/read");
+    std::printf("%-34s %8.1f\n", "MonotonicClock::now_ns", clock_ns);
+    std::printf("%-34s %8.1f\n", "clock_gettime(CLOCK_MONOTONIC)", gettime_ns);
+    std::printf("%-34s %8.1f\n", "std::chrono::steady_clock::now", chrono_ns);
+    return 0;
+}
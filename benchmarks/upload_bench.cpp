@@ -0,0 +1,200 @@
+// End-to-end throughput and CPU cost of data::Uploader, into a local FileSink.
+//
+// Writes a synthetic log (sensor-like data: slowly varying floats plus
+// noise, roughly as compressible as real recordings), uploads it with the
+// given settings, and checks that the reassembled copy matches. Then repeats
+// the upload with a bandwidth limit and with an interruption halfway, to
+// check the pacing and the resume.
+//
+// Usage: upload_bench [--size-mb N] [--threads N] [--chunk-kb N] [--level N]
+//                     [--limit-mbps N] [--dir PATH]
+
+#include <ignlink/data/uploader.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ignlink::data;
+
+namespace {
+
+struct Settings {
+    size_t size_mb = 256;
+    size_t threads = 2;
+    size_t chunk_kb = 4096;
+    int level = 3;
+    double limit_mbps = 20; // MB/s for the paced run
+    std::string dir = "/tmp/ignlink_upload_bench";
+};
+
+double process_cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void write_source(const std::string& path, size_t size) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    std::vector<float> block(64 * 1024);
+    double phase = 0;
+    for (size_t written = 0; written < size; written += block.size() * sizeof(float)) {
+        for (auto& v : block) {
+            phase += 0.001;
+            // Quantized like a real sensor, which is what makes logs compressible.
+            v = std::round((std::sin(phase) + noise(rng)) * 1024.0f) / 1024.0f;
+        }
+        out.write(reinterpret_cast<const char*>(block.data()),
+                  static_cast<std::streamsize>(std::min(size - written, block.size() * sizeof(float))));
+    }
+}
+
+bool same_content(const std::string& a, const std::string& b) {
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    std::vector<char> ba(1 << 20), bb(1 << 20);
+    while (fa && fb) {
+        fa.read(ba.data(), static_cast<std::streamsize>(ba.size()));
+        fb.read(bb.data(), static_cast<std::streamsize>(bb.size()));
+        if (fa.gcount() != fb.gcount() || std::memcmp(ba.data(), bb.data(), static_cast<size_t>(fa.gcount())) != 0) {
+            return false;
+        }
+    }
+    return fa.eof() && fb.eof();
+}
+
+struct Run {
+    double seconds = 0;
+    double cpu_seconds = 0;
+    Uploader::Stats stats;
+};
+
+Run upload(const Settings& settings, const std::string& source, const std::string& sink_dir, double limit_mbps,
+           double stop_after_fraction = 0) {
+    UploaderOptions options;
+    options.chunk_size = settings.chunk_kb * 1024;
+    options.worker_threads = settings.threads;
+    options.compression_level = settings.level;
+    options.bandwidth_limit = static_cast<uint64_t>(limit_mbps * 1e6);
+    Uploader uploader(std::make_shared<FileSink>(sink_dir), options);
+
+    const double cpu_start = process_cpu_seconds();
+    const auto start = std::chrono::steady_clock::now();
+    uploader.start();
+    uploader.enqueue(source);
+    if (stop_after_fraction > 0) {
+        const uint64_t target = static_cast<uint64_t>(settings.size_mb * 1024 * 1024 * stop_after_fraction);
+        while (uploader.stats().raw_bytes < target) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        uploader.stop();
+    } else {
+        uploader.wait_idle(std::chrono::hours(1));
+    }
+    Run run;
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.cpu_seconds = process_cpu_seconds() - cpu_start;
+    run.stats = uploader.stats();
+    return run;
+}
+
+void report(const char* name, const Settings& settings, const Run& run) {
+    const double raw_mb = static_cast<double>(run.stats.raw_bytes) / 1e6;
+    const double sent_mb = static_cast<double>(run.stats.sent_bytes) / 1e6;
+    std::printf("%-12s %9.1f %9.1f %7.2f %10.1f %10.1f %10.1f\n", name, raw_mb / run.seconds, sent_mb / run.seconds,
+                sent_mb > 0 ? raw_mb / sent_mb : 0.0, raw_mb > 0 ? run.cpu_seconds * 1e3 / raw_mb : 0.0,
+                raw_mb > 0 ? static_cast<double>(run.stats.compress_cpu_ns) / 1e6 / raw_mb : 0.0,
+                100.0 * run.cpu_seconds / run.seconds / static_cast<double>(settings.threads + 1));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--size-mb") {
+            settings.size_mb = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (arg == "--threads") {
+            settings.threads = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (arg == "--chunk-kb") {
+            settings.chunk_kb = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (arg == "--level") {
+            settings.level = std::atoi(argv[i + 1]);
+        } else if (arg == "--limit-mbps") {
+            settings.limit_mbps = std::atof(argv[i + 1]);
+        } else if (arg == "--dir") {
+            settings.dir = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    const std::string src_dir = settings.dir + "/src";
+    const std::string dst_dir = settings.dir + "/dst";
+    ::mkdir(settings.dir.c_str(), 0755);
+    ::mkdir(src_dir.c_str(), 0755);
+    ::mkdir(dst_dir.c_str(), 0755);
+    const std::string source = src_dir + "/log_000000.iglog";
+    const std::string copy = dst_dir + "/log_000000.iglog";
+    write_source(source, settings.size_mb * 1024 * 1024);
+
+    std::printf("compression: %s, %zu MB, %zu workers, %zu KiB chunks\n",
+                Uploader::compression_available(Compression::Zstd) ? "zstd" : "none (built without zstd)",
+                settings.size_mb, settings.threads, settings.chunk_kb);
+    std::printf("%-12s %9s %9s %7s %10s %10s %10s\n", "run", "raw MB/s", "sent MB/s", "ratio", "cpu ms/MB",
+                "zstd ms/MB", "cpu util%");
+
+    int failures = 0;
+    const Run full = upload(settings, source, dst_dir, 0);
+    report("unlimited", settings, full);
+    if (!same_content(source, copy)) {
+        std::printf("  ERROR: uploaded copy differs\n");
+        ++failures;
+    }
+    std::remove(copy.c_str());
+
+    // Paced: measure the rate on the link against the limit.
+    const Run paced = upload(settings, source, dst_dir, settings.limit_mbps);
+    report("limited", settings, paced);
+    const double sent_rate = static_cast<double>(paced.stats.sent_bytes) / 1e6 / paced.seconds;
+    if (sent_rate > settings.limit_mbps * 1.05) {
+        std::printf("  ERROR: %.1f MB/s sent over a %.1f MB/s limit\n", sent_rate, settings.limit_mbps);
+        ++failures;
+    }
+    std::remove(copy.c_str());
+
+    // Interrupted halfway, then resumed by a new uploader.
+    const Run first_half = upload(settings, source, dst_dir, 0, 0.5);
+    const Run second_half = upload(settings, source, dst_dir, 0);
+    report("resumed", settings, second_half);
+    std::printf("  %llu chunks before the interruption, %llu skipped on resume, %llu sent after\n",
+                static_cast<unsigned long long>(first_half.stats.chunks_uploaded),
+                static_cast<unsigned long long>(second_half.stats.chunks_resumed),
+                static_cast<unsigned long long>(second_half.stats.chunks_uploaded));
+    if (second_half.stats.chunks_resumed != first_half.stats.chunks_uploaded || !same_content(source, copy)) {
+        std::printf("  ERROR: resume did not continue where the first upload stopped\n");
+        ++failures;
+    }
+
+    std::remove(copy.c_str());
+    std::remove(source.c_str());
+    ::rmdir(src_dir.c_str());
+    ::rmdir(dst_dir.c_str());
+    ::rmdir(settings.dir.c_str());
+    return failures == 0 ? 0 : 1;
+}
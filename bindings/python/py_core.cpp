@@ -0,0 +1,178 @@
+#include "py_ignlink.h"
+
+#include <ignlink/core/tensor.h>
+#include <ignlink/core/timestamp.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace python {
+
+namespace {
+
+// PEP 3118 item formats, as NumPy reads them.
+const char* buffer_format(core::DType dtype) {
+    switch (dtype) {
+    case core::DType::UInt8: return "B";
+    case core::DType::Int8: return "b";
+    case core::DType::UInt16: return "H";
+    case core::DType::Int16: return "h";
+    case core::DType::Int32: return "i";
+    case core::DType::Int64: return "q";
+    case core::DType::Float16: return "e";
+    case core::DType::Float32: return "f";
+    case core::DType::Float64: return "d";
+    case core::DType::Bool: return "?";
+    }
+    return "B";
+}
+
+core::DType dtype_of(const py::buffer_info& info) {
+    std::string format = info.format;
+    // Native and explicit little-endian layouts are the same thing on our targets.
+    if (!format.empty() && (format[0] == '@' || format[0] == '=' || format[0] == '<')) {
+        format.erase(0, 1);
+    }
+    if (format.size() == 1) {
+        const char kind = format[0];
+        const bool is_signed = kind == 'b' || kind == 'h' || kind == 'i' || kind == 'l' || kind == 'q';
+        const bool is_unsigned = kind == 'B' || kind == 'H' || kind == 'I' || kind == 'L' || kind == 'Q';
+        switch (info.itemsize) {
+        case 1:
+            if (kind == '?') return core::DType::Bool;
+            if (is_signed) return core::DType::Int8;
+            if (is_unsigned) return core::DType::UInt8;
+            break;
+        case 2:
+            if (kind == 'e') return core::DType::Float16;
+            if (is_signed) return core::DType::Int16;
+            if (is_unsigned) return core::DType::UInt16;
+            break;
+        case 4:
+            if (kind == 'f') return core::DType::Float32;
+            if (is_signed) return core::DType::Int32;
+            break;
+        case 8:
+            if (kind == 'd') return core::DType::Float64;
+            if (is_signed) return core::DType::Int64;
+            break;
+        }
+    }
+    throw py::type_error("Unsupported buffer format '" + info.format + "' for a Tensor");
+}
+
+// Releases `held` under the GIL, from whichever thread drops the last reference.
+template <typename T>
+std::shared_ptr<const void> release_under_gil(T* held, const void* pointer) {
+    return std::shared_ptr<const void>(pointer, [held](const void*) {
+        if (!Py_IsInitialized()) {
+            return; // The interpreter is gone; so is what `held` refers to
+        }
+        py::gil_scoped_acquire gil;
+        delete held;
+    });
+}
+
+py::buffer_info tensor_buffer(core::Tensor& tensor) {
+    const size_t itemsize = core::dtype_size(tensor.dtype());
+    std::vector<py::ssize_t> shape(tensor.rank());
+    std::vector<py::ssize_t> strides(tensor.rank());
+    for (size_t i = 0; i < tensor.rank(); ++i) {
+        shape[i] = static_cast<py::ssize_t>(tensor.dim(i));
+        strides[i] = static_cast<py::ssize_t>(tensor.strides()[i] * static_cast<int64_t>(itemsize));
+    }
+    // Received tensors are shared with every other subscriber, so views are read-only.
+    return py::buffer_info(const_cast<void*>(tensor.data()), static_cast<py::ssize_t>(itemsize),
+                           buffer_format(tensor.dtype()), static_cast<py::ssize_t>(tensor.rank()), std::move(shape),
+                           std::move(strides), /*readonly=*/true);
+}
+
+py::tuple to_tuple(const int64_t* values, size_t count) {
+    py::tuple tuple(count);
+    for (size_t i = 0; i < count; ++i) {
+        tuple[i] = py::int_(values[i]);
+    }
+    return tuple;
+}
+
+} // namespace
+
+core::Tensor tensor_from_buffer(const py::buffer& buffer, int64_t timestamp) {
+    // Holding the export (not just the object) also stops e.g. a bytearray from being resized under us.
+    auto* info = new py::buffer_info(buffer.request());
+    std::shared_ptr<const void> owner = release_under_gil(info, info->ptr);
+    if (static_cast<size_t>(info->ndim) > core::Tensor::kMaxRank) {
+        throw py::value_error("A Tensor has at most " + std::to_string(core::Tensor::kMaxRank) + " dimensions");
+    }
+    const core::DType dtype = dtype_of(*info);
+    int64_t shape[core::Tensor::kMaxRank];
+    int64_t strides[core::Tensor::kMaxRank];
+    for (py::ssize_t i = 0; i < info->ndim; ++i) {
+        if (info->strides[i] < 0 || info->strides[i] % info->itemsize != 0) {
+            throw py::value_error("Buffer strides must be positive multiples of the item size; pass a copy");
+        }
+        shape[i] = info->shape[i];
+        strides[i] = info->strides[i] / info->itemsize;
+    }
+    core::Tensor tensor =
+        core::Tensor::wrap(info->ptr, dtype, shape, static_cast<size_t>(info->ndim), std::move(owner), strides);
+    tensor.timestamp = timestamp;
+    return tensor;
+}
+
+void init_core(py::module_& m) {
+    py::enum_<core::DType>(m, "DType")
+        .value("UInt8", core::DType::UInt8)
+        .value("Int8", core::DType::Int8)
+        .value("UInt16", core::DType::UInt16)
+        .value("Int16", core::DType::Int16)
+        .value("Int32", core::DType::Int32)
+        .value("Int64", core::DType::Int64)
+        .value("Float16", core::DType::Float16)
+        .value("Float32", core::DType::Float32)
+        .value("Float64", core::DType::Float64)
+        .value("Bool", core::DType::Bool);
+
+    // Held by shared_ptr so that received messages, which the bus shares
+    // between subscribers, reach Python without a copy.
+    py::class_<core::Tensor, std::shared_ptr<core::Tensor>>(m, "Tensor", py::buffer_protocol(), R"doc(
+An n-dimensional array, as published on the bus.
+
+Tensor implements the buffer protocol: numpy.asarray(tensor) and
+memoryview(tensor) are read-only views of the tensor's memory, which stays
+valid for as long as the view does. Built from a buffer, a Tensor views that
+buffer's memory rather than copying it.
+)doc")
+        .def(py::init([](const py::buffer& buffer, int64_t timestamp) {
+                 return std::make_shared<core::Tensor>(tensor_from_buffer(buffer, timestamp));
+             }),
+             py::arg("buffer"), py::arg("timestamp") = 0,
+             "Wraps a buffer (e.g. a NumPy array) without copying it. Do not write to the buffer while the "
+             "tensor, or a message carrying it, may still be read.")
+        .def_buffer(&tensor_buffer)
+        .def_property_readonly("dtype", &core::Tensor::dtype)
+        .def_property_readonly("shape", [](const core::Tensor& t) { return to_tuple(t.shape(), t.rank()); })
+        .def_property_readonly("strides", [](const core::Tensor& t) { return to_tuple(t.strides(), t.rank()); },
+                               "In elements, not bytes")
+        .def_property_readonly("ndim", &core::Tensor::rank)
+        .def_property_readonly("nbytes", &core::Tensor::nbytes)
+        .def_property_readonly("timestamp", [](const core::Tensor& t) { return t.timestamp; })
+        .def("is_contiguous", &core::Tensor::is_contiguous)
+        .def("clone", &core::Tensor::clone, "A contiguous copy in memory of its own")
+        .def("__len__", [](const core::Tensor& t) { return t.rank() ? t.dim(0) : 0; })
+        .def("__repr__", [](const core::Tensor& t) {
+            std::string shape;
+            for (size_t i = 0; i < t.rank(); ++i) {
+                shape += (i ? ", " : "") + std::to_string(t.dim(i));
+            }
+            return std::string("Tensor(") + core::dtype_name(t.dtype()) + ", [" + shape + "])";
+        });
+
+    m.def("now_ns", &core::MonotonicClock::now_ns,
+          "Nanoseconds on the monotonic time line the bus timestamps messages with");
+}
+
+} // namespace python
+} // namespace ignlink
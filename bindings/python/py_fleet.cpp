@@ -0,0 +1,37 @@
+#include "py_ignlink.h"
+
+#include <ignlink/fleet/telemetry.h>
+
+#include <string>
+
+namespace ignlink {
+namespace python {
+
+void init_fleet(py::module_& m) {
+    py::module_ fleet = m.def_submodule("fleet", "Fleet telemetry");
+
+    // Metrics recorded from Python go into the same process-wide registry as
+    // the C++ ones, and are uploaded with them.
+    py::class_<fleet::Counter>(fleet, "Counter")
+        .def("increment", &fleet::Counter::increment, py::arg("n") = 1);
+
+    py::class_<fleet::Gauge>(fleet, "Gauge")
+        .def("set", &fleet::Gauge::set, py::arg("value"))
+        .def("add", &fleet::Gauge::add, py::arg("delta"));
+
+    py::class_<fleet::Histogram>(fleet, "Histogram")
+        .def("record", &fleet::Histogram::record, py::arg("value"));
+
+    fleet.def(
+        "counter", [](const std::string& name) { return fleet::MetricsRegistry::global().counter(name); },
+        py::arg("name"));
+    fleet.def(
+        "gauge", [](const std::string& name) { return fleet::MetricsRegistry::global().gauge(name); },
+        py::arg("name"));
+    fleet.def(
+        "histogram", [](const std::string& name) { return fleet::MetricsRegistry::global().histogram(name); },
+        py::arg("name"));
+}
+
+} // namespace python
+} // namespace ignlink
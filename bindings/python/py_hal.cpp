@@ -0,0 +1,123 @@
+#include "py_ignlink.h"
+
+#include <ignlink/hal/camera.h>
+#include <ignlink/msg/node.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace ignlink {
+namespace python {
+
+namespace {
+
+void check(const core::Status& status) {
+    if (!status.ok()) {
+        throw std::runtime_error(status.message());
+    }
+}
+
+/**
+ * @class PyCamera
+ * @brief A camera publishing straight to a topic from its capture thread.
+ *
+ * Python only opens, starts and stops it; frames never pass through the
+ * interpreter on their way to the bus.
+ */
+class PyCamera {
+public:
+    explicit PyCamera(const hal::CameraConfig& config) : camera_(hal::create_v4l2_camera()) {
+        check(camera_->open(config));
+    }
+
+    ~PyCamera() {
+        camera_->stop();
+        camera_->close();
+    }
+
+    // Prevent copying
+    PyCamera(const PyCamera&) = delete;
+    PyCamera& operator=(const PyCamera&) = delete;
+
+    void start(std::shared_ptr<msg::Node> node, const std::string& topic) {
+        auto publisher = node->create_publisher<hal::CameraFrame>(topic);
+        if (!publisher) {
+            throw std::runtime_error("Could not create a publisher on " + topic);
+        }
+        node_ = std::move(node);
+        publisher_ = std::move(publisher);
+        check(camera_->start([publisher = publisher_.get()](std::shared_ptr<const hal::CameraFrame> frame) {
+            publisher->publish(std::move(frame));
+        }));
+    }
+
+    void stop() {
+        py::gil_scoped_release release;
+        camera_->stop();
+    }
+
+    const hal::CameraConfig& config() const { return camera_->config(); }
+    hal::Camera::Stats stats() const { return camera_->stats(); }
+
+private:
+    std::unique_ptr<hal::Camera> camera_;
+    std::shared_ptr<msg::Node> node_;
+    std::shared_ptr<msg::Publisher<hal::CameraFrame>> publisher_;
+};
+
+} // namespace
+
+void init_hal(py::module_& m) {
+    py::enum_<hal::PixelFormat>(m, "PixelFormat")
+        .value("YUYV", hal::PixelFormat::YUYV)
+        .value("UYVY", hal::PixelFormat::UYVY)
+        .value("NV12", hal::PixelFormat::NV12)
+        .value("MJPEG", hal::PixelFormat::MJPEG)
+        .value("RGB24", hal::PixelFormat::RGB24)
+        .value("BGR24", hal::PixelFormat::BGR24)
+        .value("GREY", hal::PixelFormat::GREY);
+
+    py::class_<hal::CameraConfig>(m, "CameraConfig")
+        .def(py::init<>())
+        .def_readwrite("device", &hal::CameraConfig::device)
+        .def_readwrite("width", &hal::CameraConfig::width)
+        .def_readwrite("height", &hal::CameraConfig::height)
+        .def_readwrite("format", &hal::CameraConfig::format)
+        .def_readwrite("fps", &hal::CameraConfig::fps)
+        .def_readwrite("buffer_count", &hal::CameraConfig::buffer_count)
+        .def_readwrite("export_dmabuf", &hal::CameraConfig::export_dmabuf);
+
+    // Read-only: a received frame is shared with every other subscriber.
+    py::class_<hal::CameraFrame, std::shared_ptr<hal::CameraFrame>>(m, "CameraFrame", R"doc(
+One captured frame. `image` is a Tensor viewing the driver's buffer, so
+numpy.asarray(frame.image) copies nothing; the buffer goes back to the
+driver once the frame and every view of its image are released.
+)doc")
+        .def_property_readonly("image", [](const hal::CameraFrame& f) { return std::make_shared<core::Tensor>(f.image); })
+        .def_property_readonly("format", [](const hal::CameraFrame& f) { return f.format; })
+        .def_property_readonly("width", [](const hal::CameraFrame& f) { return f.width; })
+        .def_property_readonly("height", [](const hal::CameraFrame& f) { return f.height; })
+        .def_property_readonly("stride", [](const hal::CameraFrame& f) { return f.stride; })
+        .def_property_readonly("sequence", [](const hal::CameraFrame& f) { return f.sequence; })
+        .def_property_readonly("timestamp_ns", [](const hal::CameraFrame& f) { return f.timestamp_ns; });
+
+    py::class_<hal::Camera::Stats>(m, "CameraStats")
+        .def_readonly("frames", &hal::Camera::Stats::frames)
+        .def_readonly("dropped", &hal::Camera::Stats::dropped)
+        .def_readonly("starved", &hal::Camera::Stats::starved)
+        .def_readonly("buffers_held", &hal::Camera::Stats::buffers_held);
+
+    py::class_<PyCamera>(m, "Camera", R"doc(
+A V4L2 camera ("file:PATH" plays back raw frames instead). Once started,
+frames go from the capture thread to the topic without entering Python.
+)doc")
+        .def(py::init<const hal::CameraConfig&>(), py::arg("config"))
+        .def("start", &PyCamera::start, py::arg("node"), py::arg("topic"))
+        .def("stop", &PyCamera::stop)
+        .def_property_readonly("config", &PyCamera::config)
+        .def("stats", &PyCamera::stats);
+}
+
+} // namespace python
+} // namespace ignlink
@@ -0,0 +1,11 @@
+#include "py_ignlink.h"
+
+PYBIND11_MODULE(ignlink, m) {
+    m.doc() = "Ignition Link: zero-copy messaging for Python";
+
+    // Order matters: later modules use the types bound by earlier ones.
+    ignlink::python::init_core(m);
+    ignlink::python::init_hal(m);
+    ignlink::python::init_msg(m);
+    ignlink::python::init_fleet(m);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <ignlink/core/tensor.h>
+
+#include <pybind11/pybind11.h>
+
+namespace ignlink {
+namespace python {
+
+namespace py = pybind11;
+
+void init_core(py::module_& m);
+void init_msg(py::module_& m);
+void init_hal(py::module_& m);
+void init_fleet(py::module_& m);
+
+/**
+ * @brief A tensor viewing the memory of any object with the buffer protocol (e.g. a NumPy array).
+ *
+ * Nothing is copied: the tensor holds the object's buffer export, and with it
+ * the object, until the tensor and every view of it are gone.
+ */
+core::Tensor tensor_from_buffer(const py::buffer& buffer, int64_t timestamp);
+
+} // namespace python
+} // namespace ignlink
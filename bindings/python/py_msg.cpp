@@ -0,0 +1,413 @@
+#include "py_ignlink.h"
+
+#include <ignlink/core/tensor.h>
+#include <ignlink/hal/camera.h>
+#include <ignlink/msg/node.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ignlink {
+namespace python {
+
+namespace {
+
+using Message = std::shared_ptr<const void>;
+using ToPython = py::object (*)(const Message&);
+
+template <typename T>
+py::object to_python(const Message& message) {
+    // Python has no const; the bindings only expose read-only views of T.
+    return py::cast(std::const_pointer_cast<T>(std::static_pointer_cast<const T>(message)));
+}
+
+py::list to_list(const std::vector<Message>& batch, ToPython convert) {
+    py::list list(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        list[i] = convert(batch[i]);
+    }
+    return list;
+}
+
+/**
+ * @class BatchQueue
+ * @brief Messages handed from the bus's callback threads to Python.
+ *
+ * Pushing never touches the GIL, so the bus runs at C++ speed whatever
+ * Python is doing. Popping takes everything that piled up (up to a batch)
+ * at once: while Python is busy with one batch, the next one fills, so the
+ * batches grow with the load and the GIL is taken once per batch rather than
+ * once per message. When the queue is full the oldest message is dropped.
+ */
+class BatchQueue {
+public:
+    struct Stats {
+        uint64_t received = 0; // Pushed by the bus
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t batches = 0;
+    };
+
+    explicit BatchQueue(size_t depth) : depth_(depth ? depth : 1) {}
+
+    void push(Message message) {
+        // Released outside the lock: dropping a NumPy-backed message takes the
+        // GIL, and stats() takes the lock with the GIL held.
+        Message evicted;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return;
+            }
+            if (messages_.size() == depth_) {
+                evicted = std::move(messages_.front());
+                messages_.pop_front();
+                ++stats_.dropped;
+            }
+            messages_.push_back(std::move(message));
+            ++stats_.received;
+        }
+        ready_.notify_one();
+    }
+
+    // Waits up to `timeout` (forever if negative) for a message. Empty on timeout or once closed.
+    std::vector<Message> pop(size_t max_batch, std::chrono::nanoseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto ready = [this] { return closed_ || !messages_.empty(); };
+        if (timeout.count() < 0) {
+            ready_.wait(lock, ready);
+        } else {
+            ready_.wait_for(lock, timeout, ready);
+        }
+        std::vector<Message> batch;
+        if (closed_) {
+            return batch;
+        }
+        const size_t count = std::min(messages_.size(), max_batch ? max_batch : messages_.size());
+        batch.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            batch.push_back(std::move(messages_.front()));
+            messages_.pop_front();
+        }
+        if (count) {
+            stats_.delivered += count;
+            ++stats_.batches;
+        }
+        return batch;
+    }
+
+    void close() {
+        std::deque<Message> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            dropped.swap(messages_); // Released outside the lock
+        }
+        ready_.notify_all();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    const size_t depth_;
+    mutable std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<Message> messages_;
+    bool closed_ = false;
+    Stats stats_;
+};
+
+/**
+ * @class PySubscriber
+ * @brief A subscription whose messages Python takes in batches, either by
+ *        pulling them with `take()` or from a callback run on a dispatch thread.
+ */
+class PySubscriber {
+public:
+    PySubscriber(std::shared_ptr<msg::Node> node, std::string topic, ToPython convert, py::object callback,
+                 size_t depth, size_t max_batch)
+        : node_(std::move(node)), topic_(std::move(topic)), convert_(convert), callback_(std::move(callback)),
+          max_batch_(max_batch), queue_(std::make_shared<BatchQueue>(depth)) {}
+
+    ~PySubscriber() { close(); }
+
+    // Prevent copying
+    PySubscriber(const PySubscriber&) = delete;
+    PySubscriber& operator=(const PySubscriber&) = delete;
+
+    template <typename T>
+    void subscribe() {
+        std::shared_ptr<BatchQueue> queue = queue_;
+        subscription_ = node_->create_subscriber<T>(
+            topic_, [queue](std::shared_ptr<const T> message) { queue->push(std::move(message)); });
+        if (!subscription_) {
+            throw std::runtime_error("Could not subscribe to " + topic_);
+        }
+        dropped_by_bus_ = [weak = std::weak_ptr<msg::Subscriber<T>>(
+                               std::static_pointer_cast<msg::Subscriber<T>>(subscription_))]() -> uint64_t {
+            auto subscription = weak.lock();
+            return subscription ? subscription->dropped_messages() : 0;
+        };
+        if (!callback_.is_none()) {
+            // The thread owns what it uses, so that a callback may close (or drop) its own subscriber.
+            dispatcher_ = std::thread(&PySubscriber::dispatch, queue_, new py::object(callback_), convert_,
+                                      max_batch_, topic_);
+        }
+    }
+
+    /**
+     * @brief Up to `max_messages` queued messages (all of them if 0), waiting up
+     *        to `timeout` seconds (forever if None) for the first, without the GIL.
+     */
+    py::list take(size_t max_messages, py::object timeout) {
+        if (!callback_.is_none()) {
+            throw std::runtime_error("take() is for subscribers created without a callback");
+        }
+        const auto wait = timeout.is_none() ? std::chrono::nanoseconds(-1)
+                                            : std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                  std::chrono::duration<double>(timeout.cast<double>()));
+        std::vector<Message> batch;
+        {
+            py::gil_scoped_release release;
+            batch = queue_->pop(max_messages, wait);
+        }
+        return to_list(batch, convert_);
+    }
+
+    /**
+     * @brief Unsubscribes and stops the dispatch thread. Queued messages are dropped.
+     */
+    void close() {
+        if (subscription_) {
+            // Unsubscribing waits for publishers to leave the subscriber list,
+            // and one of them may need the GIL to release a message.
+            std::shared_ptr<void> subscription = std::move(subscription_);
+            py::gil_scoped_release release;
+            subscription.reset();
+        }
+        queue_->close();
+        if (!dispatcher_.joinable()) {
+            return;
+        }
+        if (dispatcher_.get_id() == std::this_thread::get_id()) {
+            dispatcher_.detach(); // Closed from its own callback; it returns when the callback does
+            return;
+        }
+        py::gil_scoped_release release; // The dispatcher needs the GIL to finish its batch
+        dispatcher_.join();
+    }
+
+    py::dict stats() const {
+        const BatchQueue::Stats stats = queue_->stats();
+        py::dict result;
+        result["received"] = stats.received;
+        result["delivered"] = stats.delivered;
+        result["dropped"] = stats.dropped + (dropped_by_bus_ ? dropped_by_bus_() : 0);
+        result["batches"] = stats.batches;
+        return result;
+    }
+
+    const std::string& topic() const { return topic_; }
+
+private:
+    // Waits without the GIL and takes it once per batch.
+    static void dispatch(std::shared_ptr<BatchQueue> queue, py::object* callback, ToPython convert,
+                         size_t max_batch, std::string topic) {
+        while (true) {
+            std::vector<Message> batch = queue->pop(max_batch, std::chrono::nanoseconds(-1));
+            py::gil_scoped_acquire gil;
+            if (batch.empty()) {
+                delete callback; // Closed
+                return;
+            }
+            try {
+                (*callback)(to_list(batch, convert));
+            } catch (py::error_already_set& e) {
+                e.discard_as_unraisable(py::str("ignlink subscriber callback on " + topic));
+            }
+        }
+    }
+
+    std::shared_ptr<msg::Node> node_;
+    std::string topic_;
+    ToPython convert_;
+    py::object callback_;
+    size_t max_batch_;
+    std::shared_ptr<BatchQueue> queue_;
+    std::shared_ptr<void> subscription_; // msg::Subscriber<T>
+    std::function<uint64_t()> dropped_by_bus_;
+    std::thread dispatcher_;
+};
+
+/**
+ * @class PyPublisher
+ * @brief Publishes Python objects, converted without copying the data they carry.
+ */
+class PyPublisher {
+public:
+    virtual ~PyPublisher() = default;
+    virtual void publish(py::handle message) = 0;
+    virtual const std::string& topic() const = 0;
+};
+
+template <typename T>
+std::shared_ptr<const T> to_message(py::handle message) {
+    return py::cast<std::shared_ptr<T>>(message);
+}
+
+template <>
+std::shared_ptr<const core::Tensor> to_message<core::Tensor>(py::handle message) {
+    if (py::isinstance<core::Tensor>(message)) {
+        return py::cast<std::shared_ptr<core::Tensor>>(message);
+    }
+    if (PyObject_CheckBuffer(message.ptr())) {
+        return std::make_shared<core::Tensor>(tensor_from_buffer(py::reinterpret_borrow<py::buffer>(message), 0));
+    }
+    throw py::type_error("Expected a Tensor or an object with the buffer protocol");
+}
+
+template <typename T>
+class TypedPublisher : public PyPublisher {
+public:
+    TypedPublisher(std::shared_ptr<msg::Node> node, std::shared_ptr<msg::Publisher<T>> publisher)
+        : node_(std::move(node)), publisher_(std::move(publisher)) {}
+
+    void publish(py::handle message) override {
+        std::shared_ptr<const T> converted = to_message<T>(message);
+        core::Status status;
+        {
+            // Subscribers run on other threads and may need the GIL themselves (KeepAll publishers can wait).
+            py::gil_scoped_release release;
+            status = publisher_->publish(std::move(converted));
+        }
+        if (!status.ok()) {
+            throw std::runtime_error(status.message());
+        }
+    }
+
+    const std::string& topic() const override { return publisher_->get_topic_name(); }
+
+private:
+    std::shared_ptr<msg::Node> node_;
+    std::shared_ptr<msg::Publisher<T>> publisher_;
+};
+
+// Subscribers whose dispatch threads must stop before the interpreter does.
+std::mutex g_live_mutex;
+std::vector<std::weak_ptr<PySubscriber>> g_live;
+
+void close_live_subscribers() {
+    std::vector<std::weak_ptr<PySubscriber>> live;
+    {
+        std::lock_guard<std::mutex> lock(g_live_mutex);
+        live.swap(g_live);
+    }
+    for (const auto& weak : live) {
+        if (auto subscriber = weak.lock()) {
+            subscriber->close();
+        }
+    }
+}
+
+template <typename T>
+std::shared_ptr<PySubscriber> make_subscriber(std::shared_ptr<msg::Node> node, const std::string& topic,
+                                              py::object callback, size_t depth, size_t max_batch) {
+    auto subscriber =
+        std::make_shared<PySubscriber>(std::move(node), topic, &to_python<T>, std::move(callback), depth, max_batch);
+    subscriber->subscribe<T>();
+    std::lock_guard<std::mutex> lock(g_live_mutex);
+    g_live.erase(std::remove_if(g_live.begin(), g_live.end(), [](const auto& weak) { return weak.expired(); }),
+                 g_live.end());
+    g_live.push_back(subscriber);
+    return subscriber;
+}
+
+} // namespace
+
+void init_msg(py::module_& m) {
+    py::class_<PyPublisher, std::shared_ptr<PyPublisher>>(m, "Publisher")
+        .def("publish", &PyPublisher::publish, py::arg("message"), R"doc(
+Publishes a message; the GIL is released while the bus delivers it.
+
+On a Tensor topic, any object with the buffer protocol (e.g. a NumPy array)
+is published as a Tensor viewing its memory, without a copy. Do not write to
+it afterwards while subscribers may still be reading it.
+)doc")
+        .def_property_readonly("topic", &PyPublisher::topic);
+
+    py::class_<PySubscriber, std::shared_ptr<PySubscriber>>(m, "Subscriber")
+        .def("take", &PySubscriber::take, py::arg("max_messages") = 0, py::arg("timeout") = py::none(),
+             "Queued messages, waiting up to `timeout` seconds (forever if None) for the first. The GIL is "
+             "released while waiting.")
+        .def("close", &PySubscriber::close, "Unsubscribes; queued messages are dropped")
+        .def("stats", &PySubscriber::stats,
+             "Counters: received (by the bus-side subscriber), delivered (to Python), dropped and batches")
+        .def_property_readonly("topic", &PySubscriber::topic);
+
+    py::class_<msg::Node, std::shared_ptr<msg::Node>>(m, "Node")
+        .def(py::init<const std::string&>(), py::arg("name"))
+        .def_property_readonly("name", &msg::Node::get_name)
+        .def(
+            "create_publisher",
+            [](std::shared_ptr<msg::Node> node, const std::string& topic,
+               py::object type) -> std::shared_ptr<PyPublisher> {
+                if (type.is(py::type::of<core::Tensor>())) {
+                    auto publisher = node->create_publisher<core::Tensor>(topic);
+                    if (publisher) {
+                        return std::make_shared<TypedPublisher<core::Tensor>>(node, publisher);
+                    }
+                } else if (type.is(py::type::of<hal::CameraFrame>())) {
+                    auto publisher = node->create_publisher<hal::CameraFrame>(topic);
+                    if (publisher) {
+                        return std::make_shared<TypedPublisher<hal::CameraFrame>>(node, publisher);
+                    }
+                } else {
+                    throw py::type_error("Unsupported message type; expected Tensor or CameraFrame");
+                }
+                throw std::runtime_error("Could not create a publisher on " + topic);
+            },
+            py::arg("topic"), py::arg("type"))
+        .def(
+            "create_subscriber",
+            [](std::shared_ptr<msg::Node> node, const std::string& topic, py::object type, py::object callback,
+               size_t depth, size_t max_batch) {
+                if (type.is(py::type::of<core::Tensor>())) {
+                    return make_subscriber<core::Tensor>(node, topic, std::move(callback), depth, max_batch);
+                }
+                if (type.is(py::type::of<hal::CameraFrame>())) {
+                    return make_subscriber<hal::CameraFrame>(node, topic, std::move(callback), depth, max_batch);
+                }
+                throw py::type_error("Unsupported message type; expected Tensor or CameraFrame");
+            },
+            py::arg("topic"), py::arg("type"), py::arg("callback") = py::none(), py::arg("depth") = 64,
+            py::arg("max_batch") = 64, R"doc(
+Subscribes to a topic of Tensor or CameraFrame messages.
+
+Messages are queued on the C++ side (up to `depth`, dropping the oldest) and
+reach Python as lists, one GIL acquisition per list: `callback(messages)` is
+called on a dispatch thread with up to `max_batch` at a time, or, without a
+callback, they are pulled with Subscriber.take(). Either way the messages
+are the very objects the publisher sent, with no copy of their data.
+
+Camera frames hold driver buffers until Python lets go of them: keep `depth`
+below the camera's buffer count, and clone() what must be kept.
+)doc");
+
+    // Before the interpreter tears down what the dispatch threads use.
+    py::module_::import("atexit").attr("register")(py::cpp_function(&close_live_subscribers));
+}
+
+} // namespace python
+} // namespace ignlink
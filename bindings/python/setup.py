@@ -0,0 +1,81 @@
+# Builds the `ignlink` Python module: the bindings in this directory compiled
+# together with the library sources, so nothing has to be installed first.
+#
+#   pip install ./bindings/python
+#
+# Needs pybind11 (pip install pybind11) and the library's own dependencies:
+# spdlog, fmt and yaml-cpp, plus zstd and OpenSSL where they are installed. CMakeLists.txt here builds the same
+# module with CMake, fetching pybind11 if it is not installed, and runs the
+# smoke test in tests/python.
+
+import glob
+import os
+import tempfile
+
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+from setuptools import setup
+from distutils.ccompiler import new_compiler
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+
+
+def ignlink_include_dir():
+    # The headers are included as <ignlink/...>; point that prefix at include/.
+    staging = os.path.join(tempfile.gettempdir(), "ignlink_python_include")
+    os.makedirs(staging, exist_ok=True)
+    link = os.path.join(staging, "ignlink")
+    if not os.path.islink(link):
+        os.symlink(os.path.join(ROOT, "include"), link)
+    return staging
+
+
+def have_library(header, library, function):
+    cwd = os.getcwd()
+    with tempfile.TemporaryDirectory() as scratch:
+        os.chdir(scratch)  # has_function leaves its objects in the working directory
+        try:
+            return new_compiler().has_function(function, includes=[header], libraries=[library])
+        finally:
+            os.chdir(cwd)
+
+
+# Optional, as in the library: without them, uploads are not compressed and
+# OTA updates cannot be signature-checked. The library is told what was found,
+# since a header on the include path does not mean the library can be linked.
+optional_libraries = []
+optional_macros = []
+for macro, header, library, function in [("IGNLINK_HAS_ZSTD", "zstd.h", "zstd", "ZSTD_versionNumber"),
+                                         ("IGNLINK_HAS_OPENSSL", "openssl/evp.h", "crypto", "EVP_MD_CTX_new")]:
+    found = have_library(header, library, function)
+    if found:
+        optional_libraries.append(library)
+    optional_macros.append((macro, "1" if found else "0"))
+
+sources = sorted(glob.glob(os.path.join(HERE, "py_*.cpp")))
+sources += sorted(glob.glob(os.path.join(ROOT, "src", "**", "*.cpp"), recursive=True))
+
+extension = Pybind11Extension(
+    "ignlink",
+    [os.path.relpath(source, HERE) for source in sources],
+    include_dirs=[
+        HERE,
+        ignlink_include_dir(),
+        os.path.join(ROOT, "include", "msg"),
+        os.path.join(ROOT, "include", "msg", "transport"),
+    ],
+    define_macros=[("SPDLOG_FMT_EXTERNAL", None)] + optional_macros,  # spdlog as packaged by the distributions
+    libraries=["spdlog", "fmt", "yaml-cpp", "rt"] + optional_libraries,
+    cxx_std=17,
+    extra_compile_args=["-O2"],
+)
+
+setup(
+    name="ignlink",
+    version="0.1.0",
+    description="Python bindings for Ignition Link",
+    ext_modules=[extension],
+    cmdclass={"build_ext": build_ext},
+    zip_safe=False,
+    python_requires=">=3.7",
+)
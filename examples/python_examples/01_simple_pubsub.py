@@ -0,0 +1,27 @@
+import time
+
+import numpy as np
+
+import ignlink
+
+# 1. Create a node
+node = ignlink.Node("py_pubsub")
+
+# 2. Subscribe: the callback gets a list of every message that arrived since
+#    its last call, so the GIL is taken once per batch rather than per message.
+def on_tensors(tensors):
+    for tensor in tensors:
+        array = np.asarray(tensor)  # A read-only view of the published memory, not a copy
+        print(f"got {array.shape} {array.dtype}, mean {array.mean():.3f}, published at {tensor.timestamp}")
+
+sub = node.create_subscriber("/py/tensors", ignlink.Tensor, on_tensors)
+
+# 3. Publish NumPy arrays; each is wrapped as a Tensor without a copy, so it
+#    must not be written to afterwards.
+pub = node.create_publisher("/py/tensors", ignlink.Tensor)
+for i in range(5):
+    pub.publish(ignlink.Tensor(np.full((4, 3), i, dtype=np.float32), timestamp=ignlink.now_ns()))
+
+time.sleep(0.1)
+print(sub.stats())
+sub.close()
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <ignlink/core/rcu.h>
+#include <ignlink/core/status.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace core {
+
+namespace detail {
+
+/**
+ * @struct ConfigValue
+ * @brief (Internal) One parameter in a snapshot, converted to every type it can be read as.
+ */
+struct ConfigValue {
+    static constexpr uint8_t kBool = 1;
+    static constexpr uint8_t kInt = 2;
+    static constexpr uint8_t kDouble = 4;
+    static constexpr uint8_t kString = 8;
+
+    uint8_t types = 0; // Which of the fields below hold the value; 0 if the key is not set
+    bool as_bool = false;
+    int64_t as_int = 0;
+    double as_double = 0;
+    std::string as_string; // The scalar as written
+};
+
+/**
+ * @struct ConfigSnapshot
+ * @brief (Internal) An immutable set of values, indexed by the slot each key was given.
+ */
+struct ConfigSnapshot {
+    uint64_t version = 0;
+    std::vector<ConfigValue> values;
+};
+
+/**
+ * @struct ConfigState
+ * @brief (Internal) What parameter handles share with their Config.
+ */
+struct ConfigState {
+    RcuDomain rcu; // Protects readers of `current`
+    std::atomic<const ConfigSnapshot*> current{nullptr};
+
+    ~ConfigState() { delete current.load(); }
+};
+
+template <typename T>
+struct ConfigRead;
+
+template <>
+struct ConfigRead<bool> {
+    static constexpr uint8_t kType = ConfigValue::kBool;
+    static bool get(const ConfigValue& value) { return value.as_bool; }
+};
+
+template <>
+struct ConfigRead<int64_t> {
+    static constexpr uint8_t kType = ConfigValue::kInt;
+    static int64_t get(const ConfigValue& value) { return value.as_int; }
+};
+
+template <>
+struct ConfigRead<int> {
+    static constexpr uint8_t kType = ConfigValue::kInt;
+    static int get(const ConfigValue& value) { return static_cast<int>(value.as_int); }
+};
+
+template <>
+struct ConfigRead<double> {
+    static constexpr uint8_t kType = ConfigValue::kDouble;
+    static double get(const ConfigValue& value) { return value.as_double; }
+};
+
+template <>
+struct ConfigRead<float> {
+    static constexpr uint8_t kType = ConfigValue::kDouble;
+    static float get(const ConfigValue& value) { return static_cast<float>(value.as_double); }
+};
+
+template <>
+struct ConfigRead<std::string> {
+    static constexpr uint8_t kType = ConfigValue::kString;
+    static std::string get(const ConfigValue& value) { return value.as_string; }
+};
+
+} // namespace detail
+
+/**
+ * @class ConfigParam
+ * @brief A handle to one parameter of a Config, bound to its key once.
+ *
+ * Creating the handle resolves the key to a slot, the parameter's index in
+ * every snapshot. `get()` then reads that slot in whichever snapshot is
+ * current: inside an RCU read section, with no lock, no lookup and no
+ * allocation (except for the copy `ConfigParam<std::string>` returns). If
+ * the key is not set, or its value cannot be read as `T`, it returns the
+ * handle's default.
+ *
+ * @tparam T bool, int, int64_t, float, double or std::string. Integers read as
+ *           floating point too; only true/false (and the other YAML spellings) read as bool.
+ */
+template <typename T>
+class ConfigParam {
+public:
+    ConfigParam() = default;
+
+    T get() const {
+        if (!state_) {
+            return default_;
+        }
+        auto guard = state_->rcu.read();
+        const detail::ConfigSnapshot* snapshot = state_->current.load(std::memory_order_acquire);
+        if (snapshot && slot_ < snapshot->values.size()) {
+            const detail::ConfigValue& value = snapshot->values[slot_];
+            if (value.types & detail::ConfigRead<T>::kType) {
+                return detail::ConfigRead<T>::get(value);
+            }
+        }
+        return default_;
+    }
+
+    const std::string& key() const { return key_; }
+    const T& default_value() const { return default_; }
+
+private:
+    friend class Config;
+
+    ConfigParam(std::shared_ptr<detail::ConfigState> state, uint32_t slot, std::string key, T default_value)
+        : state_(std::move(state)), slot_(slot), key_(std::move(key)), default_(std::move(default_value)) {}
+
+    std::shared_ptr<detail::ConfigState> state_;
+    uint32_t slot_ = 0;
+    std::string key_;
+    T default_{};
+};
+
+/**
+ * @class Config
+ * @brief Parameters from YAML files, read lock-free and reloaded when the files change.
+ *
+ * The files are parsed into an immutable snapshot of typed values, with
+ * nested maps flattened to dotted keys ("controller.pid.kp") and sequence
+ * elements numbered ("wheels.0.radius"). Files added later override keys set
+ * by earlier ones. A reload parses every file again into a new snapshot and
+ * publishes it with one atomic pointer swap; a read returns either the old
+ * value or the new one, and the old snapshot is freed once no reader can
+ * still hold it. A file that fails to parse leaves the current snapshot in
+ * place.
+ *
+ * `watch()` starts a thread that follows the files' directories with
+ * inotify, so that editors which save by renaming a new file over the old
+ * one are picked up too, and reloads shortly after the last change.
+ *
+ * Parameters are read through ConfigParam handles, meant to be created once
+ * (e.g. when a node starts) and read on the hot path.
+ *
+ * @example
+ *   ignlink::core::Config config;
+ *   config.add_file("/etc/robot/controller.yaml");
+ *   config.watch();
+ *   auto kp = config.param<double>("controller.pid.kp", 1.0);
+ *   loop->call_every(std::chrono::milliseconds(1), [&] { controller.set_kp(kp.get()); });
+ */
+class Config {
+public:
+    using ReloadCallback = std::function<void(uint64_t version)>;
+
+    /**
+     * @struct Stats
+     * @brief Counters since construction.
+     */
+    struct Stats {
+        uint64_t version = 0; // Of the current snapshot; each successful load or reload adds one
+        uint64_t reloads = 0; // Successful reloads
+        uint64_t errors = 0;  // Loads and reloads that kept the previous snapshot
+    };
+
+    Config();
+
+    /**
+     * @brief Stops watching.
+     */
+    ~Config();
+
+    // Prevent copying
+    Config(const Config&) = delete;
+    Config& operator=(const Config&) = delete;
+
+    /**
+     * @brief Adds a file on top of those already added and publishes the result.
+     * @return NotFound if it cannot be read, InvalidArgument if it is not valid YAML;
+     *         the file is not added then.
+     */
+    Status add_file(const std::string& path);
+
+    /**
+     * @brief Parses every file again and publishes the result, if all of them parse.
+     */
+    Status reload();
+
+    /**
+     * @brief Reloads in the background whenever one of the files changes.
+     */
+    Status watch();
+
+    void stop_watching();
+
+    /**
+     * @brief Called after each reload, on the thread that did it.
+     */
+    void on_reload(ReloadCallback callback);
+
+    /**
+     * @brief A handle to the parameter at `key`, reading `default_value` while it is not set.
+     */
+    template <typename T>
+    ConfigParam<T> param(const std::string& key, T default_value = T()) {
+        return ConfigParam<T>(state_, slot(key), key, std::move(default_value));
+    }
+
+    /**
+     * @brief True if `key` is set in the current snapshot.
+     */
+    bool has(const std::string& key) const;
+
+    Stats stats() const;
+
+private:
+    struct Impl;
+
+    uint32_t slot(const std::string& key); // Assigns one on first use
+
+    std::shared_ptr<detail::ConfigState> state_;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace core
+} // namespace ignlink
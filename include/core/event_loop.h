@@ -0,0 +1,150 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace core {
+
+/**
+ * @class EventLoop
+ * @brief A single-threaded reactor on epoll: file descriptors, timers and posted tasks.
+ *
+ * Drivers and transports that would otherwise each block in a thread of
+ * their own register their file descriptors here instead, so one thread (or
+ * a few loops, one per core) serves them all. Every wakeup collects
+ * everything that is ready, up to 64 descriptors plus the due timers and the
+ * posted tasks, and dispatches the lot before sleeping again, so a busy
+ * loop takes one epoll_wait() per batch rather than per event.
+ *
+ * Timers sit on a hashed timer wheel (1 ms slots, one second around) and a
+ * single timerfd is armed for the earliest of them, at its exact deadline.
+ * Periodic timers keep a fixed rate: each deadline is the last plus the
+ * period, so a control loop does not drift by its own run time, and periods
+ * missed while the loop was busy are skipped, not run back to back.
+ *
+ * Everything runs on the loop's thread, so handlers must not block. All the
+ * methods are safe to call from any thread, including from handlers. When
+ * `remove_fd()` or `cancel_timer()` returns, the callback is not running and
+ * will not run again, unless the call came from the loop thread itself.
+ *
+ * @example
+ *   auto loop = std::make_shared<ignlink::core::EventLoop>("io");
+ *   loop->add_fd(socket_fd, ignlink::core::EventLoop::kReadable, [&](uint32_t) { drain(socket_fd); });
+ *   loop->call_every(std::chrono::milliseconds(1), [&] { controller.step(); }); // 1 kHz
+ *   loop->start();
+ */
+class EventLoop {
+public:
+    // Event flags for `add_fd()` and the handlers; the epoll values.
+    static constexpr uint32_t kReadable = 0x001; // EPOLLIN
+    static constexpr uint32_t kWritable = 0x004; // EPOLLOUT
+    static constexpr uint32_t kError = 0x008;    // EPOLLERR, always reported
+    static constexpr uint32_t kHangup = 0x010;   // EPOLLHUP, always reported
+
+    using FdCallback = std::function<void(uint32_t events)>;
+    using TimerId = uint64_t;
+
+    /**
+     * @struct Stats
+     * @brief Counters since construction.
+     */
+    struct Stats {
+        uint64_t wakeups = 0;        // Returns from epoll_wait()
+        uint64_t fd_events = 0;      // Descriptor handlers run
+        uint64_t timer_runs = 0;     // Timer callbacks run
+        uint64_t timer_overruns = 0; // Periods skipped because the loop was late
+        uint64_t tasks = 0;          // Posted tasks run
+    };
+
+    /**
+     * @param name Used in log messages.
+     */
+    explicit EventLoop(std::string name = "event_loop");
+
+    /**
+     * @brief Stops the loop and joins its thread, if it has one.
+     */
+    ~EventLoop();
+
+    // Prevent copying
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Calls `callback` on the loop thread whenever `fd` is ready.
+     *
+     * The descriptor is level-triggered: a handler that leaves data unread is
+     * called again on the next pass. It should be non-blocking.
+     *
+     * @param events kReadable and/or kWritable; 0 to register it paused.
+     * @return AlreadyExists if `fd` is registered.
+     */
+    Status add_fd(int fd, uint32_t events, FdCallback callback);
+
+    /**
+     * @brief Changes the events `fd` is watched for; 0 pauses it.
+     */
+    Status modify_fd(int fd, uint32_t events);
+
+    /**
+     * @brief Stops watching `fd`. Close it only after this returns.
+     */
+    void remove_fd(int fd);
+
+    /**
+     * @brief Runs `callback` once, `delay` from now.
+     * @return An ID for `cancel_timer()`; never 0.
+     */
+    TimerId call_after(std::chrono::nanoseconds delay, std::function<void()> callback);
+
+    /**
+     * @brief Runs `callback` every `period`, the first time one period from now.
+     */
+    TimerId call_every(std::chrono::nanoseconds period, std::function<void()> callback);
+
+    /**
+     * @brief Cancels a timer. Returns false if it had already run (one-shot) or was cancelled.
+     */
+    bool cancel_timer(TimerId id);
+
+    /**
+     * @brief Runs `task` on the loop thread, in the next batch.
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Runs the loop on the calling thread until `stop()`.
+     */
+    void run();
+
+    /**
+     * @brief Runs the loop on a thread of its own.
+     */
+    Status start();
+
+    /**
+     * @brief Makes `run()` return after the current batch, and joins the loop's thread if `start()` made one.
+     */
+    void stop();
+
+    /**
+     * @brief True when called from the thread running the loop.
+     */
+    bool in_loop_thread() const;
+
+    const std::string& name() const;
+    Stats stats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace core
+} // namespace ignlink
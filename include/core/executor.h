@@ -0,0 +1,145 @@
+#pragma once
+
+#include <ignlink/core/threadpool.h>
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace ignlink {
+namespace core {
+
+/**
+ * @class CallbackGroup
+ * @brief Controls which callbacks may run concurrently on an Executor.
+ *
+ * - A MutuallyExclusive group runs at most one of its callbacks at a time, in
+ *   the order they were posted. This is what keeps a single subscriber's
+ *   callbacks serialized while other subscribers run on other cores.
+ * - A Reentrant group places no restriction: its callbacks may run in parallel,
+ *   even several invocations of the same callback.
+ *
+ * Groups are shared between callbacks by sharing the pointer.
+ */
+class CallbackGroup {
+public:
+    enum class Type {
+        MutuallyExclusive,
+        Reentrant
+    };
+
+    explicit CallbackGroup(Type type) : type_(type) {}
+
+    // Prevent copying
+    CallbackGroup(const CallbackGroup&) = delete;
+    CallbackGroup& operator=(const CallbackGroup&) = delete;
+
+    /**
+     * @brief Gets the concurrency policy of this group.
+     */
+    Type type() const { return type_; }
+
+private:
+    friend class Executor;
+
+    const Type type_;
+
+    // Only used by MutuallyExclusive groups.
+    std::mutex mutex_;
+    std::deque<std::function<void()>> queue_; // Callbacks waiting for their turn
+    bool scheduled_ = false;                  // True while a drain task is queued or running
+};
+
+/**
+ * @class Executor
+ * @brief Runs callbacks on a work-stealing ThreadPool while honouring callback groups.
+ *
+ * Reentrant callbacks are submitted straight to the pool. MutuallyExclusive
+ * callbacks are queued on their group, and the group itself is scheduled on the
+ * pool as a single task that drains the queue; a group is never scheduled
+ * twice, which is what serializes it. To stay fair to other groups, a drain
+ * task runs a bounded batch and then re-queues itself.
+ */
+class Executor {
+public:
+    /**
+     * @brief Creates the executor and its thread pool.
+     * @param num_threads The number of worker threads. Zero means one per hardware thread.
+     */
+    explicit Executor(size_t num_threads = 0) : pool_(num_threads) {}
+
+    // Prevent copying
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Schedules a callback for execution.
+     * @param callback The work to run.
+     * @param group The group the callback belongs to. A null group behaves
+     *              like a Reentrant one.
+     */
+    void post(std::function<void()> callback, const std::shared_ptr<CallbackGroup>& group);
+
+    /**
+     * @brief Gets the number of worker threads.
+     */
+    size_t num_threads() const { return pool_.size(); }
+
+private:
+    // How many callbacks a MutuallyExclusive group may run before yielding its worker.
+    static constexpr size_t kMaxBatch = 32;
+
+    void drain(std::shared_ptr<CallbackGroup> group);
+
+    ThreadPool pool_;
+};
+
+inline void Executor::post(std::function<void()> callback, const std::shared_ptr<CallbackGroup>& group) {
+    if (!group || group->type() == CallbackGroup::Type::Reentrant) {
+        pool_.submit(std::move(callback));
+        return;
+    }
+
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(group->mutex_);
+        group->queue_.push_back(std::move(callback));
+        if (!group->scheduled_) {
+            group->scheduled_ = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        pool_.submit([this, group] { drain(group); });
+    }
+}
+
+inline void Executor::drain(std::shared_ptr<CallbackGroup> group) {
+    for (size_t i = 0; i < kMaxBatch; ++i) {
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(group->mutex_);
+            if (group->queue_.empty()) {
+                group->scheduled_ = false;
+                return;
+            }
+            callback = std::move(group->queue_.front());
+            group->queue_.pop_front();
+        }
+        try {
+            callback();
+        } catch (...) {
+            // Keep draining; one failing callback must not wedge the group.
+        }
+    }
+
+    // Batch used up but work remains: hand the group back to the pool behind
+    // the tasks already queued on this worker, so that they run first. The
+    // group stays marked as scheduled, so nobody else can start a second drain.
+    pool_.defer([this, group] { drain(std::move(group)); });
+}
+
+} // namespace core
+} // namespace ignlink
@@ -1,17 +1,118 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
-#include <memory>
+#include <string_view>
+#include <type_traits>
 
-// We forward-declare the spdlog::logger to avoid including the heavy spdlog
-// header in our public API. This is a good practice (PIMPL idiom).
-namespace spdlog {
-class logger;
-}
+/**
+ * @brief The lowest log level compiled in (0 = Trace ... 5 = Critical).
+ *
+ * Calls below it compile to nothing, not even a level check. Release builds
+ * drop trace and debug logging by default; define it to override.
+ */
+#ifndef IGNLINK_LOG_ACTIVE_LEVEL
+#ifdef NDEBUG
+#define IGNLINK_LOG_ACTIVE_LEVEL 2
+#else
+#define IGNLINK_LOG_ACTIVE_LEVEL 0
+#endif
+#endif
 
 namespace ignlink {
 namespace core {
 
+namespace detail {
+
+/**
+ * @brief Tags for the arguments of a log call, as stored in a log record.
+ */
+enum class LogArgKind : uint8_t { Int, UInt, Double, Bool, Char, String, Pointer };
+
+/**
+ * @brief The fixed part of a log record. The encoded arguments follow it.
+ */
+struct LogRecordHeader {
+    uint32_t size;        // Total record size in bytes, header included, 8-byte aligned
+    uint8_t level;
+    uint8_t num_args;
+    uint16_t reserved;
+    int64_t timestamp_ns; // Wall-clock time of the call, for the log line
+    const char* format;   // Must have static storage duration (a string literal)
+};
+
+template <typename T>
+constexpr bool is_log_string_v = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                                 std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+/**
+ * @brief Size of one encoded argument: a tag byte, then the value.
+ */
+template <typename T>
+size_t log_arg_size(const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (is_log_string_v<U>) {
+        return 1 + sizeof(uint32_t) + std::string_view(value).size();
+    } else if constexpr (std::is_same_v<U, bool> || std::is_same_v<U, char>) {
+        return 2;
+    } else if constexpr (std::is_arithmetic_v<U> || std::is_enum_v<U> || std::is_pointer_v<U>) {
+        return 1 + 8;
+    } else {
+        static_assert(std::is_arithmetic_v<U>,
+                      "Logger arguments must be numbers, enums, pointers or strings; convert other types first.");
+        return 0;
+    }
+}
+
+template <typename T>
+uint8_t* encode_log_arg(uint8_t* out, const T& value) {
+    using U = std::decay_t<T>;
+    if constexpr (is_log_string_v<U>) {
+        const std::string_view text(value);
+        const uint32_t length = static_cast<uint32_t>(text.size());
+        *out++ = static_cast<uint8_t>(LogArgKind::String);
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), text.data(), length);
+        return out + sizeof(length) + length;
+    } else if constexpr (std::is_same_v<U, bool>) {
+        *out++ = static_cast<uint8_t>(LogArgKind::Bool);
+        *out++ = value ? 1 : 0;
+        return out;
+    } else if constexpr (std::is_same_v<U, char>) {
+        *out++ = static_cast<uint8_t>(LogArgKind::Char);
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    } else if constexpr (std::is_pointer_v<U>) {
+        const uint64_t bits = reinterpret_cast<uintptr_t>(value);
+        *out++ = static_cast<uint8_t>(LogArgKind::Pointer);
+        std::memcpy(out, &bits, 8);
+        return out + 8;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        const double number = static_cast<double>(value);
+        *out++ = static_cast<uint8_t>(LogArgKind::Double);
+        std::memcpy(out, &number, 8);
+        return out + 8;
+    } else if constexpr (std::is_enum_v<U>) {
+        return encode_log_arg(out, static_cast<std::underlying_type_t<U>>(value));
+    } else if constexpr (std::is_signed_v<U>) {
+        const int64_t number = value;
+        *out++ = static_cast<uint8_t>(LogArgKind::Int);
+        std::memcpy(out, &number, 8);
+        return out + 8;
+    } else {
+        const uint64_t number = value;
+        *out++ = static_cast<uint8_t>(LogArgKind::UInt);
+        std::memcpy(out, &number, 8);
+        return out + 8;
+    }
+}
+
+} // namespace detail
+
 /**
  * @class Logger
  * @brief A simple, professional logging interface for the Ignition Link ecosystem.
@@ -19,6 +120,28 @@ namespace core {
  * This class provides a set of static methods for system-wide logging. It allows
  * for setting a log level and directing output. Under the hood, it is a wrapper
  * around a powerful logging library like spdlog.
+ *
+ * Logging is asynchronous by default. A log call does not format anything: it
+ * copies the format string pointer and its arguments (strings by value) into
+ * a lock-free ring buffer owned by the calling thread and returns, typically
+ * within a few tens of nanoseconds. A background thread drains every
+ * thread's ring, formats the records and writes them out in batches, flushing
+ * once per batch. If a thread logs faster than the writer keeps up, its ring
+ * fills and further records are dropped (and counted) rather than blocking
+ * the caller.
+ *
+ * Error and Critical records are the exception: the calling thread drains
+ * the rings and flushes the sinks itself before returning, so an error is on
+ * disk (or the console) even if the process dies right after logging it,
+ * along with everything that thread logged before it. They are never dropped
+ * for a full ring either.
+ *
+ * Format strings must be string literals (or otherwise outlive the program's
+ * logging), since they are formatted later on another thread. Arguments may
+ * be numbers, enums, pointers and strings.
+ *
+ * Levels below IGNLINK_LOG_ACTIVE_LEVEL are compiled out entirely; the others
+ * are filtered at runtime with a single relaxed load.
  */
 class Logger {
 public:
@@ -31,45 +154,126 @@ public:
         Critical
     };
 
+    /**
+     * @brief How log records reach the sinks.
+     */
+    enum class Mode {
+        Async, // Queued per thread and written by a background thread (default)
+        Sync   // Formatted and written on the calling thread, e.g. for crash-prone debugging
+    };
+
     /**
      * @brief Initializes the global logger with a specific name and level.
-     * This should be called once at the start of an application.
+     * This should be called once at the start of an application; calling it
+     * again reconfigures the logger. If it is never called, the first log
+     * call initializes a default "IGNLINK" logger at Info level.
      * @param logger_name The name for the logger (e.g., the node name).
      * @param level The minimum level of messages to log.
+     * @param mode Whether records are written asynchronously.
+     */
+    static void init(const std::string& logger_name, Level level = Level::Info, Mode mode = Mode::Async);
+
+    /**
+     * @brief Changes the minimum runtime level.
+     */
+    static void set_level(Level level);
+
+    /**
+     * @brief Blocks until every record logged so far has been written and flushed.
      */
-    static void init(const std::string& logger_name, Level level = Level::Info);
+    static void flush();
+
+    /**
+     * @brief Gets the number of records dropped because a thread's ring buffer was full.
+     */
+    static uint64_t dropped_records();
 
     /**
      * @brief Logs a trace-level message.
      * @tparam... Args Variadic arguments for the format string.
-     * @param fmt The format string (fmt::format style).
+     * @param fmt The format string (fmt::format style). Must be a string literal.
      * @param... args The arguments for the format string.
      */
     template <typename... Args>
-    static void trace(const std::string& fmt, Args&&... args);
+    static void trace(const char* fmt, const Args&... args) { log<Level::Trace>(fmt, args...); }
+
+    /**
+     * @brief Logs a debug-level message.
+     */
+    template <typename... Args>
+    static void debug(const char* fmt, const Args&... args) { log<Level::Debug>(fmt, args...); }
 
     /**
      * @brief Logs an info-level message.
      */
     template <typename... Args>
-    static void info(const std::string& fmt, Args&&... args);
-    
+    static void info(const char* fmt, const Args&... args) { log<Level::Info>(fmt, args...); }
+
     /**
      * @brief Logs a warning-level message.
      */
     template <typename... Args>
-    static void warn(const std::string& fmt, Args&&... args);
+    static void warn(const char* fmt, const Args&... args) { log<Level::Warn>(fmt, args...); }
 
     /**
      * @brief Logs an error-level message.
      */
     template <typename... Args>
-    static void error(const std::string& fmt, Args&&... args);
+    static void error(const char* fmt, const Args&... args) { log<Level::Error>(fmt, args...); }
+
+    /**
+     * @brief Logs a critical-level message.
+     */
+    template <typename... Args>
+    static void critical(const char* fmt, const Args&... args) { log<Level::Critical>(fmt, args...); }
 
 private:
-    // The static pointer to the actual logger implementation.
-    static std::shared_ptr<spdlog::logger> s_logger_;
+    template <Level L, typename... Args>
+    static void log(const char* fmt, const Args&... args) {
+        if constexpr (static_cast<int>(L) >= IGNLINK_LOG_ACTIVE_LEVEL) {
+            if (static_cast<int>(L) < s_level_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const size_t args_size = (size_t(0) + ... + detail::log_arg_size(args));
+            const size_t size = (sizeof(detail::LogRecordHeader) + args_size + 7) & ~size_t(7);
+            uint8_t* record = begin_record(size, L >= Level::Error);
+            if (!record) {
+                return; // Ring full: dropped and counted.
+            }
+            auto* header = reinterpret_cast<detail::LogRecordHeader*>(record);
+            header->size = static_cast<uint32_t>(size);
+            header->level = static_cast<uint8_t>(L);
+            header->num_args = static_cast<uint8_t>(sizeof...(Args));
+            header->reserved = 0;
+            header->timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::system_clock::now().time_since_epoch()).count();
+            header->format = fmt;
+            uint8_t* out = record + sizeof(detail::LogRecordHeader);
+            ((out = detail::encode_log_arg(out, args)), ...);
+            (void)out;
+            end_record(record);
+        }
+    }
+
+    /**
+     * @brief Reserves `size` bytes for a record in the calling thread's ring
+     *        (or a scratch buffer in Sync mode, or once the thread's ring has
+     *        been destroyed during exit). Returns null if it is full.
+     * @param urgent Make room by draining the rings on this thread rather than drop.
+     */
+    static uint8_t* begin_record(size_t size, bool urgent);
+
+    /**
+     * @brief Publishes the record filled in after `begin_record`. Records of
+     *        Error level and above are written out before it returns.
+     */
+    static void end_record(uint8_t* record);
+
+    // The runtime level; starts at Info like the default logger. The spdlog
+    // logger and the background writer live in logger.cpp, which keeps
+    // spdlog out of this header (PIMPL idiom).
+    static std::atomic<int> s_level_;
 };
 
 } // namespace core
-} // namespace ignlink
\ No newline at end of file
+} // namespace ignlink
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace ignlink {
+namespace core {
+
+/**
+ * @class RcuDomain
+ * @brief Read-copy-update grace periods for data that is read far more often than it changes.
+ *
+ * Readers wrap their access to a shared, immutable snapshot in a ReadGuard.
+ * A writer builds a new snapshot, swaps the shared pointer to it, and calls
+ * `synchronize()` before freeing the old one: `synchronize()` returns once
+ * every read section that could still see the old snapshot has finished.
+ *
+ * Entering and leaving a read section is one atomic increment and decrement
+ * on a counter shared by only a few threads (each thread is assigned one of
+ * `kShards` cache-line-sized counters), so readers never take a lock and
+ * rarely contend. Writers are expected to be rare; `synchronize()` spins
+ * with yields while it waits.
+ *
+ * Read sections must be short and must not call `synchronize()` on the same
+ * domain, which would wait for itself.
+ *
+ * @example
+ *   // Reader (hot path)
+ *   {
+ *       auto guard = domain.read();
+ *       const Table* table = current.load(std::memory_order_acquire);
+ *       use(*table);
+ *   }
+ *   // Writer (slow path, serialized by the caller)
+ *   const Table* old = current.exchange(new Table(*old_copy_with_changes));
+ *   domain.synchronize();
+ *   delete old;
+ */
+class RcuDomain {
+public:
+    /**
+     * @class ReadGuard
+     * @brief Marks a read section for as long as it is alive.
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(RcuDomain& domain) : counter_(&domain.enter()) {}
+        ~ReadGuard() { counter_->fetch_sub(1); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        std::atomic<int64_t>* counter_;
+    };
+
+    RcuDomain() = default;
+
+    // Prevent copying
+    RcuDomain(const RcuDomain&) = delete;
+    RcuDomain& operator=(const RcuDomain&) = delete;
+
+    /**
+     * @brief Starts a read section.
+     */
+    ReadGuard read() { return ReadGuard(*this); }
+
+    /**
+     * @brief Waits until every read section that started before this call has ended.
+     */
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        // Flip the phase twice, draining the counters of the phase being left
+        // each time. A reader that sampled the old phase just before a flip
+        // but incremented after the wait may still be reading; the second
+        // flip waits for it too.
+        for (int pass = 0; pass < 2; ++pass) {
+            const uint32_t old_phase = phase_.fetch_add(1) & 1;
+            for (auto& shard : shards_) {
+                while (shard.readers[old_phase].load() != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct alignas(64) Shard {
+        std::atomic<int64_t> readers[2] = {{0}, {0}}; // Active readers per phase
+    };
+
+    std::atomic<int64_t>& enter() {
+        // The increment is seq_cst, ordering it before the reader's loads of
+        // the protected pointer and after a writer's check of this counter.
+        std::atomic<int64_t>& counter = shards_[shard_index()].readers[phase_.load() & 1];
+        counter.fetch_add(1);
+        return counter;
+    }
+
+    static size_t shard_index() {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return index;
+    }
+
+    Shard shards_[kShards];
+    std::atomic<uint32_t> phase_{0};
+    std::mutex sync_mutex_; // Serializes writers
+};
+
+} // namespace core
+} // namespace ignlink
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace ignlink {
+namespace core {
+
+/**
+ * @brief Element types a Tensor can hold.
+ */
+enum class DType : uint8_t {
+    UInt8,
+    Int8,
+    UInt16,
+    Int16,
+    Int32,
+    Int64,
+    Float16,
+    Float32,
+    Float64,
+    Bool
+};
+
+/**
+ * @brief Gets the size of one element of the given type, in bytes.
+ */
+size_t dtype_size(DType dtype);
+
+/**
+ * @brief Gets a short name for the type (e.g. "float32"), for logging.
+ */
+const char* dtype_name(DType dtype);
+
+class BufferPool;
+
+namespace detail {
+
+/**
+ * @brief Bookkeeping stored in the first cache line of every pooled buffer.
+ */
+struct BufferHeader {
+    std::atomic<uint32_t> refs;
+    uint32_t size_class;
+    size_t capacity; // Usable bytes after the header
+};
+
+/**
+ * @class PooledBuffer
+ * @brief (Internal) An intrusively reference-counted handle to a pooled, 64-byte-aligned buffer.
+ *
+ * The reference count lives in the buffer itself, so sharing a buffer between
+ * tensors never allocates. The last handle to go returns the buffer to its pool.
+ */
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(const PooledBuffer& other) : header_(other.header_) { retain(); }
+    PooledBuffer(PooledBuffer&& other) noexcept : header_(other.header_) { other.header_ = nullptr; }
+    PooledBuffer& operator=(PooledBuffer other) noexcept {
+        std::swap(header_, other.header_);
+        return *this;
+    }
+    ~PooledBuffer() { release(); }
+
+    uint8_t* data() const { return header_ ? reinterpret_cast<uint8_t*>(header_) + kHeaderSize : nullptr; }
+    size_t capacity() const { return header_ ? header_->capacity : 0; }
+    bool unique() const { return header_ && header_->refs.load(std::memory_order_acquire) == 1; }
+    explicit operator bool() const { return header_ != nullptr; }
+
+    // One full cache line, so the data that follows stays 64-byte aligned.
+    static constexpr size_t kHeaderSize = 64;
+
+private:
+    friend class core::BufferPool;
+
+    explicit PooledBuffer(BufferHeader* header) : header_(header) {}
+
+    void retain() {
+        if (header_) {
+            header_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void release();
+
+    BufferHeader* header_ = nullptr;
+};
+
+} // namespace detail
+
+/**
+ * @class BufferPool
+ * @brief A process-wide cache of 64-byte-aligned buffers, binned by power-of-two size class.
+ *
+ * Released buffers are kept for reuse instead of being freed, so a pipeline
+ * that keeps producing tensors of the same shape stops calling malloc once it
+ * has warmed up. Each size class keeps a bounded number of buffers; surplus
+ * ones are freed.
+ */
+class BufferPool {
+public:
+    /**
+     * @brief Gets a buffer of at least `bytes` usable bytes.
+     */
+    static detail::PooledBuffer acquire(size_t bytes);
+
+    /**
+     * @brief Frees every cached buffer (e.g. after a change of resolution).
+     */
+    static void trim();
+
+    /**
+     * @brief Gets the number of bytes currently cached and not in use.
+     */
+    static size_t cached_bytes();
+
+private:
+    friend class detail::PooledBuffer;
+    static void recycle(detail::BufferHeader* header);
+};
+
+inline void detail::PooledBuffer::release() {
+    if (header_ && header_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        BufferPool::recycle(header_);
+    }
+    header_ = nullptr;
+}
+
+/**
+ * @class Tensor
+ * @brief An n-dimensional array with a dtype, shape and strides, for inference inputs and outputs.
+ *
+ * Storage is 64-byte aligned, so SIMD kernels and inference runtimes can use
+ * `data()` directly. A Tensor is a view: copying one, slicing it or reshaping
+ * it never copies elements, it only shares the storage. Only `clone()` copies.
+ *
+ * Storage comes from one of two places:
+ * - the BufferPool, for tensors created by the constructor or `resize()`;
+ * - someone else's memory, for tensors created by `wrap()`, e.g. a shared-memory
+ *   slot or a loaned transport buffer. The owner handle keeps that memory alive
+ *   for as long as any view of it exists.
+ *
+ * Because copies share storage, a tensor must not be modified once it has been
+ * published; publish a fresh (or loaned) one instead.
+ *
+ * @example
+ *   ignlink::core::Tensor image(ignlink::core::DType::UInt8, {1080, 1920, 3});
+ *   camera.read_into(image.data());
+ *   auto roi = image.slice(0, 200, 600).slice(1, 300, 900); // A view, no copy
+ */
+class Tensor {
+public:
+    static constexpr size_t kMaxRank = 8;
+    static constexpr size_t kAlignment = 64;
+
+    /**
+     * @brief Creates an empty tensor with no storage.
+     */
+    Tensor() = default;
+
+    /**
+     * @brief Creates a contiguous tensor with pooled storage. Elements are uninitialized.
+     */
+    Tensor(DType dtype, std::initializer_list<int64_t> shape);
+    Tensor(DType dtype, const int64_t* shape, size_t rank);
+
+    /**
+     * @brief Creates a view over memory owned by someone else.
+     * @param data The first element. Must stay valid while `owner` is alive.
+     * @param dtype The element type.
+     * @param shape The dimensions.
+     * @param rank The number of dimensions.
+     * @param owner Keeps `data` alive (e.g. a pinned IPC view). May be null for
+     *              memory that outlives the tensor by construction.
+     * @param strides Element strides per dimension, or null for contiguous.
+     */
+    static Tensor wrap(const void* data, DType dtype, const int64_t* shape, size_t rank,
+                       std::shared_ptr<const void> owner, const int64_t* strides = nullptr);
+
+    /**
+     * @brief Reshapes this tensor in place, reusing its storage when it is large enough
+     *        and not shared with any other tensor.
+     *
+     * This is how a producer refills a recycled (e.g. loaned) tensor each cycle
+     * without allocating. Elements are unspecified afterwards.
+     * @throws std::invalid_argument if the shape is invalid or its size overflows;
+     *         the tensor is then left unchanged.
+     */
+    void resize(DType dtype, std::initializer_list<int64_t> shape);
+    void resize(DType dtype, const int64_t* shape, size_t rank);
+
+    DType dtype() const { return dtype_; }
+    size_t rank() const { return rank_; }
+    int64_t dim(size_t i) const { return shape_[i]; }
+    const int64_t* shape() const { return shape_; }
+    const int64_t* strides() const { return strides_; } // In elements, not bytes
+    size_t numel() const;
+    size_t nbytes() const { return numel() * dtype_size(dtype_); }
+    bool empty() const { return numel() == 0; }
+    bool is_contiguous() const;
+
+    void* data() { return data_; }
+    const void* data() const { return data_; }
+
+    template <typename T>
+    T* data_as() { return reinterpret_cast<T*>(data_); }
+    template <typename T>
+    const T* data_as() const { return reinterpret_cast<const T*>(data_); }
+
+    /**
+     * @brief Gets a view of the elements [start, stop) along one dimension, every `step`-th.
+     * @throws std::out_of_range on an invalid dimension or range.
+     */
+    Tensor slice(size_t dim, int64_t start, int64_t stop, int64_t step = 1) const;
+
+    /**
+     * @brief Gets a view with one dimension fixed at `index` (the rank drops by one).
+     * @throws std::out_of_range on an invalid dimension or index.
+     */
+    Tensor select(size_t dim, int64_t index) const;
+
+    /**
+     * @brief Gets a view with a different shape. One dimension may be -1 to infer it.
+     * @throws std::invalid_argument if the element count differs or the tensor is not contiguous.
+     */
+    Tensor reshape(std::initializer_list<int64_t> shape) const;
+    Tensor reshape(const int64_t* shape, size_t rank) const;
+
+    /**
+     * @brief Copies the elements into a new, contiguous tensor with pooled storage.
+     */
+    Tensor clone() const;
+
+    /**
+     * @brief Returns this tensor if it is contiguous, otherwise a contiguous clone.
+     */
+    Tensor contiguous() const { return is_contiguous() ? *this : clone(); }
+
+    /**
+     * @brief Producer timestamp in nanoseconds (e.g. the camera exposure time).
+     */
+    int64_t timestamp = 0;
+
+private:
+    void set_shape(const int64_t* shape, size_t rank);
+
+    DType dtype_ = DType::UInt8;
+    uint8_t rank_ = 0;
+    int64_t shape_[kMaxRank] = {};
+    int64_t strides_[kMaxRank] = {};
+    uint8_t* data_ = nullptr;
+
+    detail::PooledBuffer buffer_;         // Set for pooled storage
+    std::shared_ptr<const void> owner_;   // Set for wrapped storage
+};
+
+} // namespace core
+} // namespace ignlink
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ignlink {
+namespace core {
+
+/**
+ * @class ThreadPool
+ * @brief A fixed-size, work-stealing pool of worker threads.
+ *
+ * Every worker owns a deque of tasks. A worker pushes and pops its own tasks at
+ * the back (LIFO, which keeps freshly produced work hot in cache) and, when its
+ * deque runs dry, steals from the front of another worker's deque (FIFO, which
+ * takes the oldest and usually largest chunk of work). Tasks submitted from
+ * outside the pool are spread round-robin across the workers.
+ *
+ * Idle workers block on a condition variable and cost no CPU. A submitter only
+ * touches the shared sleep lock when at least one worker is actually asleep, so
+ * a saturated pool never serializes on it.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads.
+     * @param num_threads The number of workers. Zero means one per hardware thread.
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+
+    /**
+     * @brief Runs every task that is still queued, then joins the workers.
+     */
+    ~ThreadPool();
+
+    // Prevent copying
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task for execution on one of the workers.
+     *
+     * Safe to call from any thread, including from inside a running task (the
+     * new task then lands on the calling worker's own deque).
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Queues a task behind everything already waiting on this worker.
+     *
+     * From inside a task, the new task goes to the front of the calling
+     * worker's deque: its owner runs it only after all of its other work, while
+     * idle workers steal it first. Used to yield, so that a task which
+     * re-queues itself does not starve the tasks queued behind it. From any
+     * other thread this is the same as submit().
+     */
+    void defer(Task task);
+
+    /**
+     * @brief Gets the number of worker threads.
+     */
+    size_t size() const { return threads_.size(); }
+
+private:
+    struct alignas(64) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void push(Task task, bool front);
+    void worker_loop(size_t index);
+    bool pop_local(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+
+    // Identifies the pool and worker the current thread belongs to, if any.
+    static thread_local const ThreadPool* tls_pool_;
+    static thread_local size_t tls_index_;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::atomic<size_t> pending_{0};     // Tasks queued but not yet taken
+    std::atomic<size_t> next_worker_{0}; // Round-robin cursor for external submits
+    std::atomic<size_t> sleepers_{0};    // Workers blocked (or about to block) on sleep_cv_
+    std::atomic<bool> stopping_{false};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+};
+
+inline thread_local const ThreadPool* ThreadPool::tls_pool_ = nullptr;
+inline thread_local size_t ThreadPool::tls_index_ = 0;
+
+inline ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_.store(true);
+    }
+    sleep_cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+inline void ThreadPool::submit(Task task) {
+    push(std::move(task), false);
+}
+
+inline void ThreadPool::defer(Task task) {
+    push(std::move(task), tls_pool_ == this);
+}
+
+inline void ThreadPool::push(Task task, bool front) {
+    // Workers feed their own deque; everybody else spreads work round-robin.
+    size_t index = (tls_pool_ == this)
+                       ? tls_index_
+                       : next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        if (front) {
+            workers_[index]->tasks.push_front(std::move(task));
+        } else {
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+    }
+    pending_.fetch_add(1);
+
+    // Pairs with the sleepers_ increment in worker_loop: either the worker sees
+    // our pending_ increment before blocking, or we see it asleep and wake it.
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+inline bool ThreadPool::pop_local(size_t index, Task& task) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+inline bool ThreadPool::steal(size_t thief, Task& task) {
+    const size_t count = workers_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *workers_[(thief + offset) % count];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue; // Busy or empty; try the next victim rather than wait.
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+inline void ThreadPool::worker_loop(size_t index) {
+    tls_pool_ = this;
+    tls_index_ = index;
+
+    Task task;
+    while (true) {
+        if (pop_local(index, task) || steal(index, task)) {
+            pending_.fetch_sub(1);
+            try {
+                task();
+            } catch (...) {
+                // A throwing task must not take a worker down with it; the
+                // task owner is responsible for reporting its own failures.
+            }
+            task = nullptr;
+            continue;
+        }
+
+        // Nothing to run anywhere. A steal attempt may have skipped a locked
+        // deque, so only sleep when the pool is truly empty.
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        sleep_cv_.wait(lock, [this] { return pending_.load() > 0 || stopping_.load(); });
+        sleepers_.fetch_sub(1);
+        if (stopping_.load() && pending_.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace core
+} // namespace ignlink
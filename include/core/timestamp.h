@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define IGNLINK_HAS_TSC 1
+#else
+#define IGNLINK_HAS_TSC 0
+#endif
+
+namespace ignlink {
+namespace core {
+
+namespace detail {
+
+/**
+ * @brief The TSC-to-nanoseconds conversion, filled in once by calibration.
+ *
+ * Constant-initialized (all zeros, state NotCalibrated), so it is usable
+ * from static initializers of other translation units.
+ */
+struct ClockCalibration {
+    enum State : int { NotCalibrated = 0, Tsc = 1, Fallback = 2 };
+
+    std::atomic<int> state{NotCalibrated};
+    uint64_t tsc_base = 0;  // TSC reading at calibration
+    int64_t ns_base = 0;    // CLOCK_MONOTONIC at the same instant
+    uint64_t ns_per_tick = 0; // 32.32 fixed point
+};
+
+extern ClockCalibration g_clock_calibration;
+
+#if IGNLINK_HAS_TSC
+// The 128-bit products of the TSC conversion. A GCC/Clang extension, marked
+// as one so that -Wpedantic builds stay quiet.
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+inline int64_t clock_monotonic_ns() {
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace detail
+
+/**
+ * @class MonotonicClock
+ * @brief A cheap monotonic nanosecond clock for timestamping messages.
+ *
+ * On x86 machines whose TSC is invariant and trusted by the kernel (the
+ * "tsc" clocksource), a reading is one `rdtsc` and a fixed-point multiply,
+ * a few nanoseconds. Elsewhere it falls back to `clock_gettime(CLOCK_MONOTONIC)`,
+ * which is a vDSO call of a few tens of nanoseconds. Setting the environment
+ * variable IGNLINK_CLOCK=monotonic forces the fallback.
+ *
+ * Either way the readings are nanoseconds on the CLOCK_MONOTONIC time line:
+ * the TSC is calibrated against it (over about 10 ms, the first time the
+ * clock is used or when `calibrate()` is called). Readings from different
+ * processes on the same machine are therefore comparable, up to the
+ * calibration error (typically a few microseconds; more if NTP slews
+ * CLOCK_MONOTONIC after calibration).
+ */
+class MonotonicClock {
+public:
+    /**
+     * @brief Gets the current time in nanoseconds.
+     */
+    static int64_t now_ns() {
+        const int state = detail::g_clock_calibration.state.load(std::memory_order_acquire);
+#if IGNLINK_HAS_TSC
+        if (state == detail::ClockCalibration::Tsc) {
+            const auto& c = detail::g_clock_calibration;
+            const uint64_t ticks = __rdtsc() - c.tsc_base;
+            return c.ns_base + static_cast<int64_t>((static_cast<detail::uint128_t>(ticks) * c.ns_per_tick) >> 32);
+        }
+#endif
+        if (state == detail::ClockCalibration::NotCalibrated) {
+            calibrate();
+            return now_ns();
+        }
+        return detail::clock_monotonic_ns();
+    }
+
+    /**
+     * @brief Picks the time source and calibrates it. Idempotent and thread-safe.
+     *
+     * Called automatically on first use; call it at startup to keep the
+     * calibration delay off the first timestamp.
+     */
+    static void calibrate();
+
+    /**
+     * @brief Tells whether readings come from the TSC.
+     */
+    static bool uses_tsc();
+
+    /**
+     * @brief Gets the name of the time source in use: "tsc" or "clock_monotonic".
+     */
+    static const char* source_name();
+};
+
+} // namespace core
+} // namespace ignlink
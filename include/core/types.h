@@ -0,0 +1,5 @@
+#pragma once
+
+// Umbrella header for the core value types that travel over the bus.
+#include <ignlink/core/status.h>
+#include <ignlink/core/tensor.h>
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @brief The on-disk layout of LogRecorder segments.
+ *
+ * A recording is a directory of segment files, `<prefix>_<NNNNNN>.iglog`,
+ * each self-contained:
+ *
+ *   [SegmentHeader, padded to kLogAlignment]
+ *   [Block] [Block] ...
+ *
+ * A block is a BlockHeader followed by records, padded with zeros to the
+ * next multiple of kLogAlignment, so that every block starts page-aligned
+ * and can be written with one aligned write (or read through mmap without
+ * copying). A record is a RecordHeader followed by its payload, padded to a
+ * multiple of 8 bytes; records never span blocks. Every segment begins with
+ * a Channel record for each channel known at that point, and a new channel
+ * gets its Channel record before its first message.
+ *
+ * When the segment is closed, a seek index follows the last block (at
+ * `index_offset`, also page-aligned): an IndexHeader, one BlockIndexEntry
+ * per block, then one ChannelIndexEntry per channel followed by its topic
+ * and type names, padded to 8 bytes. It lets a reader find the block for a
+ * timestamp by binary search and skip blocks without the topics it wants,
+ * without touching the data.
+ *
+ * All integers are little-endian. The header's end time, counters and index
+ * are written when the segment is closed; a segment whose `end_time_ns` is 0
+ * was not closed cleanly (e.g. power loss) and is read up to its last
+ * complete block by walking the block headers.
+ */
+namespace log_format {
+
+constexpr size_t kLogAlignment = 4096;
+constexpr char kSegmentMagic[8] = {'I', 'G', 'N', 'L', 'O', 'G', '\0', '\1'};
+constexpr uint32_t kBlockMagic = 0x4b4c4249; // "IBLK"
+constexpr uint32_t kIndexMagic = 0x58444949; // "IIDX"
+constexpr uint32_t kVersion = 1;
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t segment_index;   // Position in the recording, from 0
+    int64_t start_time_ns;    // core::MonotonicClock at creation
+    int64_t start_wall_ns;    // Unix time at creation, to place the recording in calendar time
+    int64_t end_time_ns;      // core::MonotonicClock at close; 0 if not closed cleanly
+    uint64_t message_count;   // Written at close
+    uint64_t data_bytes;      // End of the last block, from the start of the file; written at close
+    uint64_t index_offset;    // Where the seek index starts; 0 = none (not closed cleanly)
+    uint64_t index_size;      // Its size, without padding
+};
+
+struct BlockHeader {
+    uint32_t magic;           // kBlockMagic
+    uint32_t payload_bytes;   // Bytes of records after this header (padding excluded)
+    uint32_t record_count;
+    uint32_t reserved;
+    int64_t first_time_ns;    // Log time of the first and last message in the block
+    int64_t last_time_ns;
+};
+
+enum class RecordKind : uint8_t {
+    Message = 1,
+    Channel = 2
+};
+
+struct RecordHeader {
+    uint32_t size;            // Header plus payload, without padding
+    uint8_t kind;             // RecordKind
+    uint8_t reserved;
+    uint16_t channel;
+    uint64_t sequence;        // MessageInfo::sequence (Message records)
+    int64_t log_time_ns;      // When the recorder received the message (core::MonotonicClock)
+    int64_t publish_time_ns;  // MessageInfo::publish_time_ns
+};
+
+/**
+ * @brief The payload of a Channel record: the header below, then the topic
+ *        name and the type name (not NUL-terminated).
+ */
+struct ChannelPayload {
+    uint64_t type_hash;
+    uint16_t topic_length;
+    uint16_t type_name_length;
+    uint32_t reserved;
+};
+
+struct IndexHeader {
+    uint32_t magic;           // kIndexMagic
+    uint32_t block_count;
+    uint32_t channel_count;
+    uint32_t reserved;
+};
+
+struct BlockIndexEntry {
+    uint64_t offset;          // Of the BlockHeader, from the start of the file
+    int64_t min_time_ns;      // Earliest and latest log time in the block
+    int64_t max_time_ns;
+    uint32_t message_count;
+    uint32_t record_count;
+    uint64_t channel_mask;    // Bit (channel % 64) is set if the block holds messages of that channel
+};
+
+struct ChannelIndexEntry {
+    uint16_t channel;
+    uint16_t reserved[3];
+    ChannelPayload payload;   // Followed by the names, as in a Channel record
+};
+
+static_assert(sizeof(SegmentHeader) == 72, "SegmentHeader layout changed");
+static_assert(sizeof(BlockHeader) == 32, "BlockHeader layout changed");
+static_assert(sizeof(RecordHeader) == 32, "RecordHeader layout changed");
+static_assert(sizeof(ChannelPayload) == 16, "ChannelPayload layout changed");
+static_assert(sizeof(IndexHeader) == 16, "IndexHeader layout changed");
+static_assert(sizeof(BlockIndexEntry) == 40, "BlockIndexEntry layout changed");
+static_assert(sizeof(ChannelIndexEntry) == 24, "ChannelIndexEntry layout changed");
+
+inline constexpr size_t pad8(size_t n) { return (n + 7) & ~size_t(7); }
+inline constexpr size_t align_up(size_t n) { return (n + kLogAlignment - 1) & ~(kLogAlignment - 1); }
+inline constexpr uint64_t channel_bit(uint16_t channel) { return uint64_t(1) << (channel % 64); }
+
+} // namespace log_format
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/data/log_reader.h>
+#include <ignlink/msg/node.h>
+#include <ignlink/msg/qos.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @struct LogPlayerOptions
+ * @brief How a LogPlayer paces a replay.
+ */
+struct LogPlayerOptions {
+    double rate = 1.0;         // 1 = original timing, 2 = twice as fast, ...; 0 = as fast as possible
+    int64_t start_time_ns = 0; // Log time to start from; 0 = the beginning
+    int64_t end_time_ns = 0;   // Log time to stop at; 0 = the end
+};
+
+/**
+ * @class LogPlayer
+ * @brief Republishes a recording on the bus, e.g. to run regression tests against real data.
+ *
+ * The player reads with a LogReader (memory-mapped, only the topics added
+ * with `add_topic()`) and publishes every message through a publisher of
+ * its node, from a thread of its own. With a `rate` of 0 it publishes as
+ * fast as it can; the only per-message work is decoding, and tensors are
+ * decoded as views into the mapped log, so large payloads are not copied.
+ *
+ * Replayed messages carry new MessageInfo: their publish time is the time
+ * of the replay, not of the recording.
+ *
+ * @example
+ *   ignlink::data::LogPlayerOptions options;
+ *   options.rate = 0; // As fast as possible
+ *   ignlink::data::LogPlayer player(node, options);
+ *   player.open("/data/logs/drive_0412");
+ *   player.add_topic<ignlink::core::Tensor>("/camera/front", ignlink::msg::QoS::keep_all(64));
+ *   player.add_topic<Imu>("/imu", ignlink::msg::QoS::keep_all(1024));
+ *   player.start();
+ *   player.wait();
+ */
+class LogPlayer {
+public:
+    /**
+     * @struct Stats
+     * @brief Counters for monitoring a replay.
+     */
+    struct Stats {
+        uint64_t messages_published = 0;
+        uint64_t bytes_published = 0;  // Serialized bytes read from the log
+        uint64_t decode_errors = 0;    // Messages that did not decode as their topic's type
+    };
+
+    LogPlayer(msg::Node& node, const LogPlayerOptions& options = LogPlayerOptions());
+
+    /**
+     * @brief Stops the replay (see `stop()`).
+     */
+    ~LogPlayer();
+
+    // Prevent copying
+    LogPlayer(const LogPlayer&) = delete;
+    LogPlayer& operator=(const LogPlayer&) = delete;
+
+    /**
+     * @brief Opens a recording (see LogReader::open()).
+     */
+    core::Status open(const std::string& path);
+
+    /**
+     * @brief Replays a recorded topic. Call after `open()` and before `start()`.
+     * @tparam T The topic's message type; must match the recorded type.
+     * @param qos The replay publisher's QoS. KeepAll makes a fast replay wait
+     *            for the subscribers instead of dropping.
+     * @return Status indicating success or failure (e.g. the topic was not recorded as T).
+     */
+    template <typename T>
+    core::Status add_topic(const std::string& topic_name, const msg::QoS& qos = msg::QoS());
+
+    /**
+     * @brief Starts replaying on a background thread.
+     * @return Status indicating success or failure (e.g. no topics were added).
+     */
+    core::Status start();
+
+    /**
+     * @brief Stops the replay early and waits for the thread to finish.
+     */
+    void stop();
+
+    /**
+     * @brief Waits until the replay has finished.
+     */
+    void wait();
+
+    /**
+     * @brief Tells whether the replay is still running.
+     */
+    bool playing() const;
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    Stats stats() const;
+
+private:
+    using PublishFn = std::function<bool(const LogMessage&)>;
+
+    core::Status add_topic(const std::string& topic_name, const msg::MessageType& type, PublishFn publish);
+
+    msg::Node& node_;
+
+    // PIMPL: the reader and the replay thread live in log_player.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+template <typename T>
+core::Status LogPlayer::add_topic(const std::string& topic_name, const msg::QoS& qos) {
+    auto publisher = node_.create_publisher<T>(topic_name, qos);
+    if (!publisher) {
+        return core::Status(core::Status::Code::Error, "Could not create a publisher for '" + topic_name + "'.");
+    }
+    return add_topic(topic_name, msg::message_type<T>(), [publisher](const LogMessage& message) {
+        auto msg = std::make_shared<T>();
+        if (!message.decode(msg.get())) {
+            return false;
+        }
+        publisher->publish(std::shared_ptr<const T>(std::move(msg)));
+        return true;
+    });
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/msg/message_traits.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @struct LogChannel
+ * @brief A recorded topic, as found in a log.
+ */
+struct LogChannel {
+    uint16_t id = 0;        // The reader's ID, an index into LogReader::channels()
+    std::string topic;
+    msg::MessageType type;
+};
+
+/**
+ * @struct LogMessage
+ * @brief One recorded message, pointing straight into the memory-mapped segment.
+ *
+ * `data` stays valid until the reader is closed or destroyed. Use `share()`
+ * or `decode()` to keep the bytes (or tensors decoded from them) alive past
+ * that.
+ */
+struct LogMessage {
+    const LogChannel* channel = nullptr;
+    uint64_t sequence = 0;
+    int64_t log_time_ns = 0;      // When it was recorded (core::MonotonicClock of the recording)
+    int64_t publish_time_ns = 0;
+    const uint8_t* data = nullptr; // Serialized with MessageTraits
+    size_t size = 0;
+
+    /**
+     * @brief Gets the payload as a shared pointer that keeps its segment mapped.
+     */
+    std::shared_ptr<const void> share() const {
+        return std::shared_ptr<const void>(*segment_, data);
+    }
+
+    /**
+     * @brief Deserializes the payload. Tensors become views into the mapped
+     *        segment instead of copies.
+     * @return False if the payload does not decode as T.
+     */
+    template <typename T>
+    bool decode(T* out) const {
+        return msg::MessageTraits<T>::deserialize_shared(share(), size, out);
+    }
+
+    const std::shared_ptr<const void>* segment_ = nullptr; // (Internal) The mapping's owner
+};
+
+/**
+ * @class LogReader
+ * @brief Reads a recording made by LogRecorder, with seeking and topic filtering.
+ *
+ * Segments are memory-mapped and read in place: a message costs a header
+ * parse, not a copy. Each cleanly closed segment carries an index of its
+ * blocks (see log_format.h), which the reader uses to
+ *
+ * - seek to a timestamp with a binary search over segments and then over
+ *   the blocks of one segment, and
+ * - skip whole blocks that hold none of the selected topics, without
+ *   touching their pages.
+ *
+ * Segments that were not closed cleanly are indexed on open by walking
+ * their block headers.
+ *
+ * @example
+ *   ignlink::data::LogReader reader;
+ *   reader.open("/data/logs");
+ *   reader.set_topics({"/imu"});
+ *   reader.seek(reader.start_time_ns() + 30'000'000'000); // 30 s in
+ *   ignlink::data::LogMessage message;
+ *   while (reader.next(&message)) {
+ *       Imu imu;
+ *       if (message.decode(&imu)) { ... }
+ *   }
+ */
+class LogReader {
+public:
+    LogReader();
+    ~LogReader();
+
+    // Prevent copying
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+
+    /**
+     * @brief Opens a recording: one segment file, or every segment in a directory.
+     *
+     * Segments are ordered by their start time. The read position is the start.
+     * @param path A `.iglog` file or a directory of them.
+     * @return Status indicating success or failure.
+     */
+    core::Status open(const std::string& path);
+
+    /**
+     * @brief Unmaps every segment.
+     */
+    void close();
+
+    /**
+     * @brief Gets every topic in the recording.
+     */
+    const std::vector<LogChannel>& channels() const;
+
+    /**
+     * @brief Finds a topic's channel.
+     * @return The channel, or nullptr if the topic was not recorded.
+     */
+    const LogChannel* find_channel(const std::string& topic) const;
+
+    /**
+     * @brief Gets the log time of the first and last recorded message.
+     */
+    int64_t start_time_ns() const;
+    int64_t end_time_ns() const;
+
+    /**
+     * @brief Gets the number of recorded messages, from the indexes.
+     */
+    uint64_t message_count() const;
+
+    /**
+     * @brief Restricts `next()` to some topics.
+     * @param topics The topics to read. Empty reads all of them.
+     */
+    void set_topics(const std::vector<std::string>& topics);
+
+    /**
+     * @brief Moves the read position to the first message logged at or after a time.
+     *
+     * Messages logged before `time_ns` are skipped from then on.
+     * @param time_ns A log time (see LogMessage::log_time_ns).
+     */
+    void seek(int64_t time_ns);
+
+    /**
+     * @brief Reads the next message of the selected topics.
+     * @param out Receives the message.
+     * @return False at the end of the recording.
+     */
+    bool next(LogMessage* out);
+
+private:
+    // PIMPL: the mappings and indexes live in log_reader.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace data
+} // namespace ignlink
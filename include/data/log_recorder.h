@@ -0,0 +1,196 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/msg/message_info.h>
+#include <ignlink/msg/message_traits.h>
+#include <ignlink/msg/node.h>
+#include <ignlink/msg/qos.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @struct LogRecorderOptions
+ * @brief Where and how a LogRecorder writes.
+ */
+struct LogRecorderOptions {
+    std::string directory = ".";           // Must exist
+    std::string prefix = "log";            // Segments are <prefix>_<NNNNNN>.iglog
+
+    size_t block_size = 1024 * 1024;       // Bytes collected before a write; rounded up to 4 KiB
+    std::chrono::milliseconds flush_interval{500}; // A partial block is written at least this often
+
+    size_t max_segment_bytes = 512ull * 1024 * 1024; // Rotate once a segment reaches this size (0 = never)
+    std::chrono::seconds max_segment_duration{300};  // ... or this age (0 = never)
+
+    size_t max_queued_bytes = 256ull * 1024 * 1024; // Backlog held for the writer before messages are dropped
+    bool direct_io = false;                // Bypass the page cache (O_DIRECT), where supported
+    bool sync_on_rotate = true;            // fsync a segment when it is closed
+};
+
+namespace detail {
+
+/**
+ * @brief Type-erased serialization for one channel, generated from MessageTraits<T>.
+ */
+struct ChannelCodec {
+    size_t (*serialized_size)(const void* msg);
+    size_t (*serialize)(const void* msg, void* out);
+};
+
+template <typename T>
+ChannelCodec channel_codec() {
+    return ChannelCodec{
+        [](const void* msg) { return msg::MessageTraits<T>::serialized_size(*static_cast<const T*>(msg)); },
+        [](const void* msg, void* out) { return msg::MessageTraits<T>::serialize(*static_cast<const T*>(msg), out); }};
+}
+
+} // namespace detail
+
+/**
+ * @class LogRecorder
+ * @brief The flight recorder: writes bus topics to disk in a segmented binary format.
+ *
+ * Recording is built for full-rate sensor data on slow embedded storage:
+ *
+ * - Subscriber callbacks (and `write()`) only queue a reference to the
+ *   message; they never serialize, touch the disk or wait. If the backlog
+ *   exceeds `max_queued_bytes` because the disk cannot keep up, further
+ *   messages are dropped and counted (see Stats) rather than slowing anyone
+ *   down. Recording subscribers use a KeepLast QoS, so the publishers are
+ *   never held back either.
+ * - A dedicated I/O thread serializes the queued messages straight into a
+ *   page-aligned block buffer (the only copy) and writes it with a single
+ *   `pwrite` once it holds `block_size` bytes, or after `flush_interval`.
+ * - Segments rotate by size or age. Each one is self-contained, so a crash
+ *   loses at most the unwritten tail, and old segments can be uploaded or
+ *   deleted independently. The format is described in log_format.h.
+ *
+ * @example
+ *   ignlink::data::LogRecorderOptions options;
+ *   options.directory = "/data/logs";
+ *   ignlink::data::LogRecorder recorder(options);
+ *   recorder.start();
+ *   recorder.record<ignlink::core::Tensor>(node, "/camera/front");
+ *   recorder.record<Imu>(node, "/imu");
+ *   ...
+ *   recorder.stop(); // Writes out everything queued and closes the segment
+ */
+class LogRecorder {
+public:
+    /**
+     * @struct Stats
+     * @brief Counters for monitoring the recorder.
+     */
+    struct Stats {
+        uint64_t messages_written = 0;
+        uint64_t bytes_written = 0;      // Bytes written to disk, including headers and padding
+        uint64_t messages_dropped = 0;   // Backlog full, or a write failed
+        uint64_t bytes_dropped = 0;
+        uint64_t write_errors = 0;
+        uint64_t segments = 0;           // Segments opened so far
+        uint64_t queued_bytes = 0;       // Current backlog
+    };
+
+    explicit LogRecorder(const LogRecorderOptions& options);
+
+    /**
+     * @brief Stops recording (see `stop()`).
+     */
+    ~LogRecorder();
+
+    // Prevent copying
+    LogRecorder(const LogRecorder&) = delete;
+    LogRecorder& operator=(const LogRecorder&) = delete;
+
+    /**
+     * @brief Opens the first segment and starts the I/O thread.
+     * @return Status indicating success or failure (e.g. the directory is not writable).
+     */
+    core::Status start();
+
+    /**
+     * @brief Unsubscribes, writes out everything queued and closes the segment.
+     */
+    void stop();
+
+    /**
+     * @brief Subscribes to a topic and records every message it receives.
+     * @tparam T The topic's message type; recorded with MessageTraits<T>.
+     * @param node The node to subscribe through.
+     * @param topic_name The topic to record.
+     * @param qos The recording subscriber's QoS; KeepLast, so publishers never wait on the recorder.
+     * @return Status indicating success or failure.
+     */
+    template <typename T>
+    core::Status record(msg::Node& node, const std::string& topic_name,
+                        const msg::QoS& qos = msg::QoS::keep_last(256));
+
+    /**
+     * @brief Declares a channel to be written with `write()`.
+     * @tparam T The message type; recorded with MessageTraits<T>.
+     * @return The channel ID.
+     */
+    template <typename T>
+    uint16_t add_channel(const std::string& topic_name) {
+        return add_channel(topic_name, msg::message_type<T>(), detail::channel_codec<T>());
+    }
+
+    /**
+     * @brief Queues one message for writing. Never blocks.
+     * @param channel A channel ID from `add_channel()`.
+     * @param msg The message, of the channel's type. Only a reference is kept.
+     * @param info Its metadata; the sequence and publish time are recorded.
+     * @param log_time_ns The time to record it under (core::MonotonicClock),
+     *                    or 0 for now.
+     * @return False if the message was dropped (backlog full, or not running).
+     */
+    bool write(uint16_t channel, std::shared_ptr<const void> msg, const msg::MessageInfo& info,
+               int64_t log_time_ns = 0);
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Gets the path of the segment currently being written, if any.
+     */
+    std::string current_segment_path() const;
+
+private:
+    uint16_t add_channel(const std::string& topic_name, const msg::MessageType& type,
+                         const detail::ChannelCodec& codec);
+    void keep_subscription(std::shared_ptr<void> subscription);
+
+    // PIMPL: the I/O thread, the queue and the file handling live in log_recorder.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+template <typename T>
+core::Status LogRecorder::record(msg::Node& node, const std::string& topic_name, const msg::QoS& qos) {
+    const uint16_t channel = add_channel<T>(topic_name);
+    auto subscriber = node.create_subscriber<T>(
+        topic_name,
+        std::function<void(std::shared_ptr<const T>, const msg::MessageInfo&)>(
+            [this, channel](std::shared_ptr<const T> msg, const msg::MessageInfo& info) {
+                write(channel, std::move(msg), info, info.receive_time_ns);
+            }),
+        nullptr, qos);
+    if (!subscriber) {
+        return core::Status(core::Status::Code::Error, "Could not subscribe to '" + topic_name + "' for recording.");
+    }
+    keep_subscription(std::move(subscriber));
+    return core::Status::OK();
+}
+
+} // namespace data
+} // namespace ignlink
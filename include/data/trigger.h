@@ -0,0 +1,184 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/data/log_recorder.h>
+#include <ignlink/msg/message_info.h>
+#include <ignlink/msg/node.h>
+#include <ignlink/msg/qos.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @struct TriggerCaptureOptions
+ * @brief How much of the bus a TriggerCapture keeps around an event.
+ */
+struct TriggerCaptureOptions {
+    std::chrono::milliseconds pre_trigger{10000};  // Recorded from before the event
+    std::chrono::milliseconds post_trigger{5000};  // Recorded after it; a new event extends the window
+
+    // Memory bounds per buffered topic. Whichever is hit first evicts the
+    // oldest messages, even if they are still inside the pre-trigger window.
+    size_t max_messages_per_topic = 4096;
+    size_t max_bytes_per_topic = 64 * 1024 * 1024; // Serialized size of the messages referenced
+};
+
+namespace detail {
+struct TriggerRing;
+}
+
+/**
+ * @class TriggerCapture
+ * @brief Records only what happened around interesting events.
+ *
+ * Recording everything at full rate is rarely affordable. A TriggerCapture
+ * keeps the last `pre_trigger` of each buffered topic in memory and, when a
+ * trigger fires (a hard brake, a disengagement, a perception anomaly), hands
+ * that window plus the following `post_trigger` to a LogRecorder.
+ *
+ * - Each buffered topic has a preallocated ring of references to the bus's
+ *   own immutable messages, bounded by age, count and bytes. Nothing is
+ *   copied until the LogRecorder serializes a captured message.
+ * - Triggers are predicates on a topic's messages. They run in their own
+ *   KeepLast subscribers on the executor, never on the publishing thread, so
+ *   a slow predicate only drops its own input. `fire()` triggers by hand.
+ * - When a trigger fires, every ring is snapshotted at the same instant:
+ *   messages of the last `pre_trigger` go to the recorder, and messages
+ *   arriving during the next `post_trigger` follow them directly. A trigger
+ *   firing inside an open window extends it; no message is recorded twice.
+ *
+ * @example
+ *   ignlink::data::LogRecorder recorder(options);
+ *   recorder.start();
+ *   ignlink::data::TriggerCapture capture(recorder);
+ *   capture.buffer<ignlink::core::Tensor>(node, "/camera/front");
+ *   capture.buffer<Imu>(node, "/imu");
+ *   capture.add_trigger<VehicleState>(node, "/vehicle/state", "hard_brake",
+ *       [](const VehicleState& s, const ignlink::msg::MessageInfo&) { return s.decel > 6.0; });
+ */
+class TriggerCapture {
+public:
+    /**
+     * @struct Stats
+     * @brief Counters for monitoring the capture.
+     */
+    struct Stats {
+        uint64_t triggers_fired = 0;    // Every firing, including ones that extend a window
+        uint64_t captures = 0;          // Windows opened
+        uint64_t messages_captured = 0; // Handed to the recorder
+        uint64_t messages_rejected = 0; // Refused by the recorder (see LogRecorder::Stats)
+        uint64_t messages_buffered = 0; // Currently held in the rings
+        uint64_t bytes_buffered = 0;
+    };
+
+    /**
+     * @param recorder Where captured windows are written; must outlive this object.
+     */
+    explicit TriggerCapture(LogRecorder& recorder, const TriggerCaptureOptions& options = TriggerCaptureOptions());
+
+    /**
+     * @brief Unsubscribes from every buffered and trigger topic.
+     */
+    ~TriggerCapture();
+
+    // Prevent copying
+    TriggerCapture(const TriggerCapture&) = delete;
+    TriggerCapture& operator=(const TriggerCapture&) = delete;
+
+    /**
+     * @brief Keeps a topic's recent messages in a ring, to be recorded when a trigger fires.
+     * @tparam T The topic's message type.
+     * @param qos The buffering subscriber's QoS.
+     * @return Status indicating success or failure.
+     */
+    template <typename T>
+    core::Status buffer(msg::Node& node, const std::string& topic_name,
+                        const msg::QoS& qos = msg::QoS::keep_last(256));
+
+    /**
+     * @brief Fires a capture whenever a message on a topic satisfies a predicate.
+     * @tparam T The topic's message type.
+     * @param name Names the trigger in the log.
+     * @param predicate Evaluated for every message received; returns true to fire.
+     * @param qos The trigger subscriber's QoS. KeepLast, so a slow predicate
+     *            drops messages rather than holding anyone back.
+     * @return Status indicating success or failure.
+     */
+    template <typename T>
+    core::Status add_trigger(msg::Node& node, const std::string& topic_name, const std::string& name,
+                             std::function<bool(const T&, const msg::MessageInfo&)> predicate,
+                             const msg::QoS& qos = msg::QoS::keep_last(16));
+
+    /**
+     * @brief Fires a capture now.
+     * @param name Names the event in the log.
+     */
+    void fire(const std::string& name);
+
+    /**
+     * @brief Tells whether a capture window is currently open.
+     */
+    bool capturing() const;
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    Stats stats() const;
+
+private:
+    detail::TriggerRing* add_ring(const std::string& topic_name, uint16_t channel, const detail::ChannelCodec& codec);
+    static void push(detail::TriggerRing& ring, std::shared_ptr<const void> msg, const msg::MessageInfo& info);
+    void keep_subscription(std::shared_ptr<void> subscription);
+
+    LogRecorder& recorder_;
+
+    // PIMPL: the rings and the capture state live in trigger.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+template <typename T>
+core::Status TriggerCapture::buffer(msg::Node& node, const std::string& topic_name, const msg::QoS& qos) {
+    detail::TriggerRing* ring = add_ring(topic_name, recorder_.add_channel<T>(topic_name), detail::channel_codec<T>());
+    auto subscriber = node.create_subscriber<T>(
+        topic_name,
+        std::function<void(std::shared_ptr<const T>, const msg::MessageInfo&)>(
+            [ring](std::shared_ptr<const T> msg, const msg::MessageInfo& info) { push(*ring, std::move(msg), info); }),
+        nullptr, qos);
+    if (!subscriber) {
+        return core::Status(core::Status::Code::Error, "Could not subscribe to '" + topic_name + "' for buffering.");
+    }
+    keep_subscription(std::move(subscriber));
+    return core::Status::OK();
+}
+
+template <typename T>
+core::Status TriggerCapture::add_trigger(msg::Node& node, const std::string& topic_name, const std::string& name,
+                                         std::function<bool(const T&, const msg::MessageInfo&)> predicate,
+                                         const msg::QoS& qos) {
+    auto subscriber = node.create_subscriber<T>(
+        topic_name,
+        std::function<void(const T&, const msg::MessageInfo&)>(
+            [this, name, predicate = std::move(predicate)](const T& msg, const msg::MessageInfo& info) {
+                if (predicate(msg, info)) {
+                    fire(name);
+                }
+            }),
+        nullptr, qos);
+    if (!subscriber) {
+        return core::Status(core::Status::Code::Error, "Could not subscribe to '" + topic_name + "' for trigger '" +
+                                                           name + "'.");
+    }
+    keep_subscription(std::move(subscriber));
+    return core::Status::OK();
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace data {
+
+/**
+ * @brief How an upload chunk's bytes are encoded.
+ */
+enum class Compression : uint8_t {
+    None = 0,
+    Zstd = 1 // Available when the library is built with zstd (see Uploader::compression_available)
+};
+
+/**
+ * @struct UploadChunk
+ * @brief One piece of a file on its way to an UploadSink.
+ */
+struct UploadChunk {
+    std::string object;        // The file's name at the endpoint
+    uint64_t index = 0;        // Position in the file, from 0
+    uint64_t chunk_count = 0;  // Chunks in the whole file
+    uint64_t offset = 0;       // Of the raw bytes in the file
+    uint32_t raw_size = 0;     // Before compression
+    Compression compression = Compression::None;
+    std::vector<uint8_t> data; // As sent
+};
+
+/**
+ * @class UploadSink
+ * @brief The endpoint an Uploader sends to; implement it for a new backend.
+ *
+ * Calls for one object arrive in order from a single thread: `begin()`, then
+ * `put()` for each chunk not yet acknowledged (from the first one after an
+ * interruption, which may repeat a chunk the endpoint already has), then
+ * `finish()`. A call returns once the endpoint has acknowledged it; an error
+ * Status makes the uploader retry later.
+ */
+class UploadSink {
+public:
+    virtual ~UploadSink() = default;
+
+    /**
+     * @brief Starts or resumes an object.
+     * @param size The raw size of the whole file.
+     */
+    virtual core::Status begin(const std::string& object, uint64_t size, uint64_t chunk_count) = 0;
+
+    /**
+     * @brief Sends one chunk and waits for its acknowledgement.
+     */
+    virtual core::Status put(const UploadChunk& chunk) = 0;
+
+    /**
+     * @brief Completes an object once every chunk is acknowledged.
+     */
+    virtual core::Status finish(const std::string& object) = 0;
+};
+
+/**
+ * @class FileSink
+ * @brief An UploadSink that reassembles objects in a local directory.
+ *
+ * The stand-in for a real endpoint in tests and benchmarks: it decompresses
+ * every chunk, writes it at its offset in `<directory>/<object>.part`, and
+ * renames the file to `<object>` in `finish()`, so an upload can be checked
+ * byte for byte against its source.
+ */
+class FileSink : public UploadSink {
+public:
+    explicit FileSink(std::string directory);
+
+    core::Status begin(const std::string& object, uint64_t size, uint64_t chunk_count) override;
+    core::Status put(const UploadChunk& chunk) override;
+    core::Status finish(const std::string& object) override;
+
+private:
+    std::string directory_;
+    std::string object_;
+    int fd_ = -1;
+};
+
+/**
+ * @class TokenBucket
+ * @brief A token-bucket rate limiter.
+ *
+ * Tokens (bytes) accumulate at `rate` per second up to `burst`. Taking more
+ * tokens than are available is allowed and puts the bucket in debt; the
+ * caller then waits out the debt before sending, so the long-run rate never
+ * exceeds `rate`, whatever the chunk size.
+ */
+class TokenBucket {
+public:
+    /**
+     * @param rate Bytes per second; 0 means unlimited.
+     * @param burst Bytes that may be sent at once after an idle period.
+     */
+    TokenBucket(uint64_t rate, uint64_t burst);
+
+    /**
+     * @brief Takes `bytes` tokens.
+     * @return How long the caller must wait before sending them.
+     */
+    std::chrono::nanoseconds take(uint64_t bytes);
+
+    /**
+     * @brief Changes the rate; 0 means unlimited.
+     */
+    void set_rate(uint64_t rate);
+
+    uint64_t rate() const;
+
+private:
+    void refill_locked(std::chrono::steady_clock::time_point now);
+
+    mutable std::mutex mutex_;
+    uint64_t rate_;
+    double burst_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+/**
+ * @struct UploaderOptions
+ * @brief How an Uploader chunks, compresses and paces its uploads.
+ */
+struct UploaderOptions {
+    size_t chunk_size = 4 * 1024 * 1024;     // Raw bytes per chunk (4 KiB to 4 GiB - 1); the unit of resumption
+    Compression compression = Compression::Zstd; // Falls back to None without zstd
+    int compression_level = 3;
+    size_t worker_threads = 2;               // Compression workers
+    size_t max_chunks_ahead = 8;             // Chunks read and compressed ahead of the link
+
+    uint64_t bandwidth_limit = 0;            // Bytes per second on the link; 0 = unlimited
+    uint64_t burst_bytes = 256 * 1024;
+
+    std::chrono::milliseconds retry_delay{1000}; // Doubled after each failure of the same call
+    std::chrono::milliseconds max_retry_delay{60000};
+    bool delete_after_upload = false;        // Remove the file once the endpoint has all of it
+};
+
+/**
+ * @class Uploader
+ * @brief Streams files (typically LogRecorder segments) to an UploadSink,
+ *        compressed, resumable and rate-limited.
+ *
+ * - Each file is split into `chunk_size` chunks. A pool of worker threads
+ *   reads and compresses up to `max_chunks_ahead` chunks ahead of the one
+ *   being sent, so compression overlaps the network and uses several cores.
+ * - Chunks are sent in order, one at a time. After each acknowledgement the
+ *   progress is saved next to the file (`<file>.upload`, replaced
+ *   atomically), so an upload interrupted by a crash, a reboot or `stop()`
+ *   resumes from the first unacknowledged chunk.
+ * - A token bucket caps the bytes sent per second, leaving the rest of a
+ *   shared link (e.g. LTE) to telemetry and commands. The limit can be
+ *   changed at any time, e.g. when the vehicle reaches a depot's Wi-Fi.
+ * - A failed call is retried with exponential backoff; the uploader never
+ *   gives up on a file.
+ *
+ * @example
+ *   auto sink = std::make_shared<MyHttpsSink>("https://logs.example.com");
+ *   ignlink::data::UploaderOptions options;
+ *   options.bandwidth_limit = 2 * 1024 * 1024; // 2 MB/s
+ *   ignlink::data::Uploader uploader(sink, options);
+ *   uploader.start();
+ *   uploader.enqueue("/data/logs/log_000012.iglog");
+ */
+class Uploader {
+public:
+    /**
+     * @struct Stats
+     * @brief Counters for monitoring uploads.
+     */
+    struct Stats {
+        uint64_t files_uploaded = 0;
+        uint64_t chunks_uploaded = 0;
+        uint64_t chunks_resumed = 0;   // Skipped because an earlier run had them acknowledged
+        uint64_t raw_bytes = 0;        // Read from files and acknowledged
+        uint64_t sent_bytes = 0;       // After compression
+        uint64_t retries = 0;
+        uint64_t compress_cpu_ns = 0;  // CPU time spent reading and compressing
+        uint64_t files_pending = 0;
+    };
+
+    Uploader(std::shared_ptr<UploadSink> sink, const UploaderOptions& options = UploaderOptions());
+
+    /**
+     * @brief Stops (see `stop()`).
+     */
+    ~Uploader();
+
+    // Prevent copying
+    Uploader(const Uploader&) = delete;
+    Uploader& operator=(const Uploader&) = delete;
+
+    /**
+     * @brief Starts the upload and compression threads.
+     */
+    core::Status start();
+
+    /**
+     * @brief Stops after the chunk being sent; the progress made is kept.
+     */
+    void stop();
+
+    /**
+     * @brief Queues a file for upload. Files are uploaded one at a time, in order.
+     */
+    void enqueue(const std::string& path);
+
+    /**
+     * @brief Waits until every queued file is uploaded, or the timeout passes.
+     * @return True if the queue is empty.
+     */
+    bool wait_idle(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Changes the bandwidth limit; 0 = unlimited.
+     */
+    void set_bandwidth_limit(uint64_t bytes_per_second);
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Tells whether this build supports a compression.
+     */
+    static bool compression_available(Compression compression);
+
+private:
+    // PIMPL: the pipeline lives in uploader.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace fleet {
+
+/**
+ * @class ClientTransport
+ * @brief The link to the fleet backend (MQTT, HTTPS, ...); implement it for a new backend.
+ *
+ * `send()` is called from the client's sender thread only, one payload at a
+ * time, and returns once the backend has accepted the payload. An error
+ * Status makes the client retry the same payload later.
+ */
+class ClientTransport {
+public:
+    virtual ~ClientTransport() = default;
+
+    /**
+     * @param channel What the payload is, e.g. "telemetry".
+     */
+    virtual core::Status send(const std::string& device_id, const std::string& channel,
+                              const std::vector<uint8_t>& payload) = 0;
+};
+
+/**
+ * @struct ClientOptions
+ * @brief Identity and queueing settings of a Client.
+ */
+struct ClientOptions {
+    std::string device_id;
+    size_t max_queued_bytes = 1024 * 1024; // The oldest payloads are dropped beyond this
+    std::chrono::milliseconds retry_delay{1000}; // Doubled after each failure in a row
+    std::chrono::milliseconds max_retry_delay{60000};
+};
+
+/**
+ * @class Client
+ * @brief The device's connection to the fleet backend.
+ *
+ * Payloads are queued and sent in order by a background thread, so callers
+ * never wait on the network. While the link is down the queue keeps the
+ * newest `max_queued_bytes` and drops the oldest payloads.
+ *
+ * @example
+ *   ignlink::fleet::ClientOptions options;
+ *   options.device_id = "robot-042";
+ *   ignlink::fleet::Client client(std::make_shared<MyMqttTransport>(broker), options);
+ *   client.start();
+ *   client.send("events", encode(event));
+ */
+class Client {
+public:
+    /**
+     * @struct Stats
+     * @brief Counters for monitoring the link.
+     */
+    struct Stats {
+        uint64_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t messages_dropped = 0; // Pushed out of a full queue
+        uint64_t send_errors = 0;
+        uint64_t queued_bytes = 0;
+    };
+
+    Client(std::shared_ptr<ClientTransport> transport, const ClientOptions& options);
+
+    /**
+     * @brief Stops (see `stop()`).
+     */
+    ~Client();
+
+    // Prevent copying
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    /**
+     * @brief Starts the sender thread.
+     */
+    core::Status start();
+
+    /**
+     * @brief Stops the sender thread after the payload being sent; the queue is kept.
+     */
+    void stop();
+
+    /**
+     * @brief Queues a payload. Never blocks.
+     * @return False if the payload alone exceeds the queue's capacity.
+     */
+    bool send(const std::string& channel, std::vector<uint8_t> payload);
+
+    /**
+     * @brief Queues a telemetry batch (see TelemetryCollector).
+     */
+    bool send_telemetry(std::vector<uint8_t> batch) { return send("telemetry", std::move(batch)); }
+
+    /**
+     * @brief Waits until the queue is empty, or the timeout passes.
+     * @return True if everything queued has been sent.
+     */
+    bool flush(std::chrono::milliseconds timeout);
+
+    const std::string& device_id() const;
+
+    /**
+     * @brief Gets a snapshot of the counters.
+     */
+    Stats stats() const;
+
+private:
+    // PIMPL: the queue and the sender thread live in client.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace fleet
+} // namespace ignlink
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ignlink {
+namespace fleet {
+
+/**
+ * @brief The layout of OTA update packages.
+ *
+ * A package turns a source image (the version installed in the active slot)
+ * into a target image, and is read strictly front to back so it can be
+ * applied while it downloads:
+ *
+ *   [PackageHeader]
+ *   [target chunk hashes: chunk_count(target_size, chunk_size) x kHashSize]
+ *   [Op] [Op] ... [End op]
+ *
+ * The target is described as a sequence of ops, each producing the next
+ * `length` bytes of it: Copy takes them from the source at `source_offset`,
+ * Insert carries them inline, right after its OpHeader. A full image is a
+ * package with `source_size` 0 and Insert ops only.
+ *
+ * Images are hashed per `chunk_size` chunk (SHA-256), so that chunks can be
+ * hashed in parallel and checked as soon as they are written. An image's
+ * root is SHA-256(le64 size, le64 chunk_size, its chunk hashes); the
+ * package header carries the roots of both images, and the target root is
+ * what the update command names, which authenticates the hash table and,
+ * through it, every byte written.
+ *
+ * All integers are little-endian.
+ */
+namespace ota_format {
+
+constexpr char kPackageMagic[8] = {'I', 'G', 'N', 'O', 'T', 'A', '\0', '\1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHashSize = 32; // SHA-256
+
+struct PackageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t chunk_size;          // Bytes per hashed chunk
+    uint64_t source_size;         // 0 for a full image
+    uint64_t target_size;
+    uint8_t source_root[kHashSize]; // Zero for a full image
+    uint8_t target_root[kHashSize];
+};
+
+enum class OpKind : uint32_t {
+    Copy = 1,
+    Insert = 2,
+    End = 3
+};
+
+struct OpHeader {
+    uint32_t kind;            // OpKind
+    uint32_t reserved;
+    uint64_t source_offset;   // Copy only
+    uint64_t length;          // Target bytes produced
+};
+
+static_assert(sizeof(PackageHeader) == 96, "PackageHeader layout");
+static_assert(sizeof(OpHeader) == 24, "OpHeader layout");
+
+inline uint64_t chunk_count(uint64_t size, uint64_t chunk_size) {
+    return (size + chunk_size - 1) / chunk_size;
+}
+
+} // namespace ota_format
+
+} // namespace fleet
+} // namespace ignlink
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace fleet {
+
+/**
+ * @class OtaSource
+ * @brief Where update packages are downloaded from; implement it for a new backend.
+ *
+ * Reads are ranged (like HTTP Range requests), so an interrupted download
+ * resumes where it stopped. An error Status is treated as transient and
+ * retried with backoff.
+ */
+class OtaSource {
+public:
+    virtual ~OtaSource() = default;
+
+    /**
+     * @brief Gets the size of a package.
+     */
+    virtual core::Status size(const std::string& package, uint64_t* size) = 0;
+
+    /**
+     * @brief Reads up to `capacity` bytes at `offset`; fewer is not an error.
+     */
+    virtual core::Status read(const std::string& package, uint64_t offset, uint8_t* buffer, size_t capacity,
+                              size_t* bytes) = 0;
+};
+
+/**
+ * @class FileOtaSource
+ * @brief An OtaSource serving packages from a local directory.
+ *
+ * The stand-in for the update server in tests and benchmarks, and usable as
+ * is for updates from a USB stick or a mounted share.
+ */
+class FileOtaSource : public OtaSource {
+public:
+    explicit FileOtaSource(std::string directory);
+
+    core::Status size(const std::string& package, uint64_t* size) override;
+    core::Status read(const std::string& package, uint64_t offset, uint8_t* buffer, size_t capacity,
+                      size_t* bytes) override;
+
+private:
+    std::string directory_;
+};
+
+/**
+ * @struct OtaUpdate
+ * @brief One update, as named by an authenticated update command.
+ */
+struct OtaUpdate {
+    std::string package;     // Name at the OtaSource
+    std::string version;     // Recorded for the slot once staged
+    std::string target_root; // Hex SHA-256 root of the target image (see ota_format)
+};
+
+/**
+ * @struct OtaHandlerOptions
+ * @brief The A/B slots and the pipeline's limits.
+ *
+ * Peak memory is about `(download_buffers * read_size) + (max_chunks_in_flight
+ * + 1) * chunk_size` plus the package's hash table (32 bytes per chunk), a few
+ * MiB with the defaults, whatever the image size.
+ */
+struct OtaHandlerOptions {
+    std::string slot_a;              // Image file or block device
+    std::string slot_b;
+    std::string state_path;          // Which slot is active; replaced atomically
+
+    size_t read_size = 256 * 1024;   // Bytes per download request
+    size_t download_buffers = 4;     // Requests downloaded ahead of the patcher
+    size_t max_chunks_in_flight = 4; // Chunks being hashed and written
+    size_t hash_threads = 2;
+    uint64_t checkpoint_bytes = 16 * 1024 * 1024; // Target bytes between saved progress
+
+    std::chrono::milliseconds retry_delay{1000}; // Doubled after each failure in a row
+    std::chrono::milliseconds max_retry_delay{60000};
+    size_t max_retries = 10;         // In a row, before `apply()` gives up (its progress is kept)
+};
+
+/**
+ * @class OtaHandler
+ * @brief Downloads and applies updates into the inactive slot of an A/B pair.
+ *
+ * `apply()` streams the package through a pipeline: a download thread reads
+ * ahead into a few buffers, the patcher turns ops into target bytes (Copy
+ * ops read the installed image, Insert ops come from the download) and fills
+ * chunk buffers, and a thread pool hashes each full chunk against the
+ * package's hash table and writes it to the staging slot. Nothing is held
+ * whole in memory, and a delta package only downloads what changed.
+ *
+ * Progress is saved every `checkpoint_bytes` (after the staged data is
+ * synced), so an update interrupted by `cancel()`, a lost link or a reboot
+ * resumes from the last checkpoint. Once every chunk has been verified, the
+ * slot is staged; `switch_slot()` then makes it the active one by atomically
+ * replacing the state file, which the bootloader integration reads. The new
+ * slot stays on probation until `confirm()`; `rollback()` reverts to the
+ * previous one.
+ *
+ * @example
+ *   ignlink::fleet::OtaHandlerOptions options;
+ *   options.slot_a = "/dev/mmcblk0p2";
+ *   options.slot_b = "/dev/mmcblk0p3";
+ *   options.state_path = "/data/ota/slots";
+ *   ignlink::fleet::OtaHandler ota(std::make_shared<MyHttpsSource>(server), options);
+ *   ota.load();
+ *   if (ota.apply(update).ok() && ota.switch_slot().ok()) {
+ *       reboot();
+ *   }
+ */
+class OtaHandler {
+public:
+    enum class Slot : uint8_t {
+        A = 0,
+        B = 1
+    };
+
+    /**
+     * @struct Progress
+     * @brief Where `apply()` is; safe to read from any thread.
+     */
+    struct Progress {
+        uint64_t package_bytes = 0;     // Downloaded so far, including earlier runs
+        uint64_t package_size = 0;
+        uint64_t target_bytes = 0;      // Verified and written to the staging slot
+        uint64_t target_size = 0;
+    };
+
+    /**
+     * @struct Stats
+     * @brief What the last `apply()` did.
+     */
+    struct Stats {
+        uint64_t downloaded_bytes = 0;  // In this run
+        uint64_t resumed_bytes = 0;     // Of the package, skipped thanks to an earlier run
+        uint64_t copied_bytes = 0;      // Target bytes taken from the installed image
+        uint64_t inserted_bytes = 0;    // Target bytes taken from the package
+        uint64_t chunks_verified = 0;
+        uint64_t retries = 0;
+        uint64_t peak_buffer_bytes = 0; // Pipeline buffers, at most
+    };
+
+    OtaHandler(std::shared_ptr<OtaSource> source, const OtaHandlerOptions& options);
+    ~OtaHandler();
+
+    // Prevent copying
+    OtaHandler(const OtaHandler&) = delete;
+    OtaHandler& operator=(const OtaHandler&) = delete;
+
+    /**
+     * @brief Reads the slot state, creating it (slot A active) if missing.
+     */
+    core::Status load();
+
+    /**
+     * @brief Downloads, verifies and stages an update. Blocks until done.
+     *
+     * Resumes an earlier, interrupted `apply()` of the same update. Fails
+     * without touching the active slot if the installed image is not the
+     * package's source, or if any byte does not match its hash.
+     */
+    core::Status apply(const OtaUpdate& update);
+
+    /**
+     * @brief Makes `apply()` return early, from another thread. Its progress is kept.
+     */
+    void cancel();
+
+    /**
+     * @brief Atomically makes the staged slot the active one, on probation.
+     */
+    core::Status switch_slot();
+
+    /**
+     * @brief Ends the probation of the active slot (call once the new version is known good).
+     */
+    core::Status confirm();
+
+    /**
+     * @brief Reverts to the previous slot after an unconfirmed switch.
+     */
+    core::Status rollback();
+
+    Slot active_slot() const;
+    const std::string& slot_path(Slot slot) const;
+    std::string slot_version(Slot slot) const;
+    bool staged() const;   // The inactive slot holds a verified update
+    bool pending() const;  // The active slot is on probation
+
+    Progress progress() const;
+    Stats stats() const;
+
+private:
+    // PIMPL: the pipeline and the slot state live in ota_handler.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+/**
+ * @struct OtaPackageOptions
+ * @brief How create_ota_package() builds a package.
+ */
+struct OtaPackageOptions {
+    uint32_t chunk_size = 1024 * 1024; // Hashing granularity, and the unit of resumption
+    uint32_t block_size = 4096;        // Smallest run of source bytes worth a Copy op
+};
+
+/**
+ * @brief Builds an update package (the backend side of OtaHandler).
+ *
+ * Finds runs of the target that exist anywhere in the source with a
+ * rolling hash over `block_size` blocks, and emits them as Copy ops; the
+ * rest goes inline. With an empty `source_path` the package is a full image.
+ *
+ * @param target_root Set to the hex target root, for the OtaUpdate.
+ */
+core::Status create_ota_package(const std::string& source_path, const std::string& target_path,
+                                const std::string& package_path, const OtaPackageOptions& options,
+                                std::string* target_root);
+
+} // namespace fleet
+} // namespace ignlink
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/core/timestamp.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ignlink {
+namespace fleet {
+
+class Client;
+class MetricsRegistry;
+
+namespace detail {
+
+constexpr uint32_t kMaxCounters = 1024;
+constexpr uint32_t kMaxGauges = 1024;
+constexpr uint32_t kMaxHistograms = 128;
+
+// Log-linear buckets: exact below 16, then 8 per power of two (at most 12.5%
+// relative error), up to 2^64.
+constexpr size_t kHistogramBuckets = 16 + 60 * 8;
+
+inline size_t histogram_bucket(uint64_t value) {
+    if (value < 16) {
+        return static_cast<size_t>(value);
+    }
+    const int exponent = 63 - __builtin_clzll(value);
+    return 16 + static_cast<size_t>(exponent - 4) * 8 + ((value >> (exponent - 3)) & 7);
+}
+
+inline uint64_t histogram_bucket_lower_bound(size_t bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    const size_t exponent = (bucket - 16) / 8 + 4;
+    return (8 + (bucket - 16) % 8) << (exponent - 3);
+}
+
+// One thread's part of one histogram. Allocated the first time that thread
+// records into it.
+struct alignas(64) HistogramSlots {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> buckets[kHistogramBuckets] = {};
+};
+
+// Everything one thread records into one registry. Only that thread writes
+// it; the collector only reads. Aligned to, and allocated as, whole cache
+// lines, so threads never share a line.
+struct alignas(64) ThreadSlots {
+    std::atomic<uint64_t> counters[kMaxCounters] = {};
+    std::atomic<HistogramSlots*> histograms[kMaxHistograms] = {};
+    std::atomic<bool> alive{true}; // Cleared when the thread exits
+
+    ThreadSlots() = default;
+    ~ThreadSlots() {
+        for (auto& histogram : histograms) {
+            delete histogram.load();
+        }
+    }
+    ThreadSlots(const ThreadSlots&) = delete;
+    ThreadSlots& operator=(const ThreadSlots&) = delete;
+};
+
+struct alignas(64) GaugeSlot {
+    std::atomic<int64_t> value{0};
+};
+
+// Single-writer increment: a plain load and store, no read-modify-write.
+inline void bump(std::atomic<uint64_t>& slot, uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+/**
+ * @class Counter
+ * @brief A monotonically increasing count (messages sent, frames dropped, ...).
+ *
+ * A handle from MetricsRegistry::counter(); cheap to copy. A default-constructed
+ * handle ignores every call.
+ */
+class Counter {
+public:
+    Counter() = default;
+
+    /**
+     * @brief Adds `n`. A few nanoseconds: no lock, no atomic read-modify-write, no allocation.
+     */
+    void increment(uint64_t n = 1) const;
+
+private:
+    friend class MetricsRegistry;
+    Counter(MetricsRegistry* registry, uint32_t id) : registry_(registry), id_(id) {}
+
+    MetricsRegistry* registry_ = nullptr;
+    uint32_t id_ = 0;
+};
+
+/**
+ * @class Gauge
+ * @brief A value that goes up and down (queue depth, temperature, ...).
+ *
+ * Gauges are not per thread: the last value set wins.
+ */
+class Gauge {
+public:
+    Gauge() = default;
+
+    void set(int64_t value) const {
+        if (slot_) {
+            slot_->value.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void add(int64_t delta) const {
+        if (slot_) {
+            slot_->value.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    friend class MetricsRegistry;
+    explicit Gauge(detail::GaugeSlot* slot) : slot_(slot) {}
+
+    detail::GaugeSlot* slot_ = nullptr;
+};
+
+/**
+ * @class Histogram
+ * @brief A distribution of values, typically latencies in nanoseconds.
+ */
+class Histogram {
+public:
+    Histogram() = default;
+
+    /**
+     * @brief Records one value. A few nanoseconds: no lock and, after a
+     *        thread's first sample, no allocation.
+     */
+    void record(uint64_t value) const;
+
+    /**
+     * @class Timer
+     * @brief Records the time from its construction to its destruction, in nanoseconds.
+     */
+    class Timer {
+    public:
+        explicit Timer(const Histogram& histogram)
+            : histogram_(histogram), start_ns_(core::MonotonicClock::now_ns()) {}
+        ~Timer() { histogram_.record(static_cast<uint64_t>(core::MonotonicClock::now_ns() - start_ns_)); }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        const Histogram& histogram_;
+        int64_t start_ns_;
+    };
+
+    /**
+     * @brief Times a scope.
+     * @example
+     *   { auto timer = callback_latency.time(); handle(msg); }
+     */
+    Timer time() const { return Timer(*this); }
+
+private:
+    friend class MetricsRegistry;
+    Histogram(MetricsRegistry* registry, uint32_t id) : registry_(registry), id_(id) {}
+
+    MetricsRegistry* registry_ = nullptr;
+    uint32_t id_ = 0;
+};
+
+/**
+ * @class MetricsRegistry
+ * @brief Names metrics and merges what every thread recorded into them.
+ *
+ * Recording is built for hot paths (the publish path, callbacks, HAL
+ * drivers): each thread writes to its own cache-line-aligned block of slots,
+ * found through a thread-local pointer, with plain relaxed loads and stores.
+ * Threads never contend, and nothing is locked or allocated after a thread's
+ * first use of the registry (and of each histogram). `collect()` sums the
+ * blocks of all threads, including threads that have since exited.
+ *
+ * Registering a metric takes a lock; do it once, at setup, and keep the handle.
+ *
+ * @example
+ *   auto& metrics = ignlink::fleet::MetricsRegistry::global();
+ *   static const auto frames = metrics.counter("camera.frames");
+ *   static const auto latency = metrics.histogram("camera.latency_ns");
+ *   frames.increment();
+ *   latency.record(now - frame.timestamp);
+ */
+class MetricsRegistry {
+public:
+    enum class Kind : uint8_t {
+        Counter = 1,
+        Gauge = 2,
+        Histogram = 3
+    };
+
+    struct MetricInfo {
+        uint32_t id;     // Index among the metrics of its kind
+        Kind kind;
+        std::string name;
+    };
+
+    struct HistogramSnapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        std::vector<uint64_t> buckets; // kHistogramBuckets, or empty if nothing was recorded
+
+        /**
+         * @brief Estimates a percentile (0-100) from the buckets.
+         */
+        uint64_t percentile(double p) const;
+    };
+
+    /**
+     * @struct Snapshot
+     * @brief Totals since the registry was created, indexed by metric ID.
+     */
+    struct Snapshot {
+        int64_t time_ns = 0; // core::MonotonicClock
+        std::vector<uint64_t> counters;
+        std::vector<int64_t> gauges;
+        std::vector<HistogramSnapshot> histograms;
+    };
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    // Prevent copying
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * @brief The process-wide registry.
+     */
+    static MetricsRegistry& global();
+
+    /**
+     * @brief Gets the metric with this name, registering it on first use.
+     *
+     * Returns a handle that ignores every call if the name is taken by a
+     * metric of another kind, or if the registry is full (both are logged).
+     */
+    Counter counter(const std::string& name);
+    Gauge gauge(const std::string& name);
+    Histogram histogram(const std::string& name);
+
+    /**
+     * @brief Gets every registered metric, in registration order.
+     */
+    std::vector<MetricInfo> metrics() const;
+
+    /**
+     * @brief Sums every thread's slots into totals.
+     */
+    Snapshot collect();
+
+private:
+    friend class Counter;
+    friend class Histogram;
+
+    detail::ThreadSlots& slots() {
+        struct Cache {
+            uint64_t registry = 0;
+            detail::ThreadSlots* slots = nullptr;
+        };
+        thread_local Cache cache;
+        if (__builtin_expect(cache.registry == uid_, 1)) {
+            return *cache.slots;
+        }
+        detail::ThreadSlots& thread_slots = register_thread();
+        cache.registry = uid_;
+        cache.slots = &thread_slots;
+        return thread_slots;
+    }
+
+    detail::ThreadSlots& register_thread();
+    detail::HistogramSlots& add_histogram_slots(detail::ThreadSlots& slots, uint32_t id);
+    int register_metric(const std::string& name, Kind kind, uint32_t limit);
+
+    const uint64_t uid_; // Unique for the process's lifetime, unlike the address
+
+    mutable std::mutex mutex_;
+    std::vector<MetricInfo> metrics_;
+    std::unordered_map<std::string, size_t> by_name_; // Index into metrics_
+    uint32_t counts_[4] = {0, 0, 0, 0};                 // Registered per Kind
+
+    std::vector<std::shared_ptr<detail::ThreadSlots>> threads_;
+    std::vector<uint64_t> retired_counters_; // Totals of threads that have exited
+    std::vector<HistogramSnapshot> retired_histograms_;
+    std::unique_ptr<detail::GaugeSlot[]> gauges_;
+};
+
+inline void Counter::increment(uint64_t n) const {
+    if (registry_) {
+        detail::bump(registry_->slots().counters[id_], n);
+    }
+}
+
+inline void Histogram::record(uint64_t value) const {
+    if (!registry_) {
+        return;
+    }
+    detail::ThreadSlots& slots = registry_->slots();
+    detail::HistogramSlots* histogram = slots.histograms[id_].load(std::memory_order_relaxed);
+    if (__builtin_expect(histogram == nullptr, 0)) {
+        histogram = &registry_->add_histogram_slots(slots, id_);
+    }
+    detail::bump(histogram->buckets[detail::histogram_bucket(value)], 1);
+    detail::bump(histogram->count, 1);
+    detail::bump(histogram->sum, value);
+}
+
+/**
+ * @class TelemetryDecoder
+ * @brief Rebuilds metric totals from telemetry batches, as a backend would.
+ */
+class TelemetryDecoder {
+public:
+    /**
+     * @brief Applies one batch produced by a TelemetryCollector.
+     * @return False if the batch is malformed (nothing is applied then).
+     */
+    bool apply(const uint8_t* data, size_t size);
+    bool apply(const std::vector<uint8_t>& batch) { return apply(batch.data(), batch.size()); }
+
+    uint64_t counter(const std::string& name) const;
+    int64_t gauge(const std::string& name) const;
+    MetricsRegistry::HistogramSnapshot histogram(const std::string& name) const;
+
+    /**
+     * @brief Gets the number of collection intervals applied.
+     */
+    uint64_t records() const { return state_.records; }
+
+private:
+    struct State {
+        std::unordered_map<std::string, uint32_t> ids[4]; // By Kind, then name
+        std::vector<uint64_t> counters;                   // By ID; names may arrive after values
+        std::vector<int64_t> gauges;
+        std::vector<MetricsRegistry::HistogramSnapshot> histograms;
+        uint64_t records = 0;
+    };
+
+    static bool apply_record(State& state, const uint8_t*& data, const uint8_t* end);
+    const uint32_t* find(MetricsRegistry::Kind kind, const std::string& name) const;
+
+    State state_;
+};
+
+/**
+ * @struct TelemetryOptions
+ * @brief How often a TelemetryCollector samples, and how it batches.
+ */
+struct TelemetryOptions {
+    std::chrono::milliseconds collect_interval{1000}; // One record per interval
+    std::chrono::milliseconds batch_interval{10000};  // A batch is sent at least this often...
+    size_t max_batch_bytes = 16 * 1024;               // ... or once it is this big
+    size_t definitions_every = 60;                    // Batches between full re-sends of the metric names
+};
+
+/**
+ * @class TelemetryCollector
+ * @brief Periodically collects a MetricsRegistry and ships compact deltas.
+ *
+ * Every `collect_interval` the collector takes a snapshot and appends a
+ * record of what changed since the previous one: only metrics whose value
+ * moved, as varint-encoded ID gaps and value deltas (gauges as their new
+ * value, histograms as their changed buckets only), so an idle interval
+ * costs a few bytes. Records accumulate into a
+ * batch that goes to the sink (normally `fleet::Client`) every
+ * `batch_interval` or when it reaches `max_batch_bytes`. Metric names are
+ * sent when first seen and, in case a batch was lost, every
+ * `definitions_every` batches. TelemetryDecoder reads the batches.
+ */
+class TelemetryCollector {
+public:
+    using BatchSink = std::function<void(std::vector<uint8_t> batch)>;
+
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t batches = 0;
+        uint64_t bytes = 0;
+    };
+
+    TelemetryCollector(MetricsRegistry& registry, BatchSink sink,
+                       const TelemetryOptions& options = TelemetryOptions());
+
+    /**
+     * @brief Ships batches with `client.send_telemetry()`.
+     */
+    TelemetryCollector(MetricsRegistry& registry, Client& client,
+                       const TelemetryOptions& options = TelemetryOptions());
+
+    /**
+     * @brief Stops (see `stop()`).
+     */
+    ~TelemetryCollector();
+
+    // Prevent copying
+    TelemetryCollector(const TelemetryCollector&) = delete;
+    TelemetryCollector& operator=(const TelemetryCollector&) = delete;
+
+    /**
+     * @brief Starts the collector thread.
+     */
+    core::Status start();
+
+    /**
+     * @brief Collects one last time, sends the pending batch and stops the thread.
+     */
+    void stop();
+
+    /**
+     * @brief Collects now, outside the schedule.
+     */
+    void collect();
+
+    /**
+     * @brief Sends the pending batch now, if it holds any record.
+     */
+    void flush();
+
+    Stats stats() const;
+
+private:
+    // PIMPL: the encoder and the thread live in telemetry.cpp.
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_;
+};
+
+} // namespace fleet
+} // namespace ignlink
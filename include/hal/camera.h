@@ -0,0 +1,159 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/core/tensor.h>
+#include <ignlink/msg/message_traits.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace core {
+class EventLoop;
+} // namespace core
+
+namespace hal {
+
+enum class PixelFormat : uint32_t {
+    YUYV = 1,  // Packed 4:2:2, the usual USB webcam format
+    UYVY = 2,
+    NV12 = 3,  // Y plane, then interleaved UV at half resolution
+    MJPEG = 4, // Compressed; the image is a 1-D byte tensor
+    RGB24 = 5,
+    BGR24 = 6,
+    GREY = 7
+};
+
+/**
+ * @struct CameraConfig
+ * @brief What to capture. Drivers may adjust the size and rate; `Camera::config()` has the result.
+ */
+struct CameraConfig {
+    std::string device = "/dev/video0";
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    PixelFormat format = PixelFormat::YUYV;
+    uint32_t fps = 30;          // 0 leaves the driver's rate
+    uint32_t buffer_count = 4;  // Driver buffers; frames held by subscribers count against them
+    bool export_dmabuf = true;  // Export each buffer as a DMABUF fd, for GPUs and encoders
+};
+
+/**
+ * @struct CameraFrame
+ * @brief One captured frame, as published on the bus.
+ *
+ * In-process, `image` is a view straight into the driver's buffer: nothing is
+ * copied between the sensor and the subscribers. The buffer goes back to the
+ * driver once the last copy of the frame, and of any tensor viewing it, is
+ * released, so subscribers should let go of a frame when they are done with
+ * it. Published to another process, the frame is serialized like any other
+ * message (and `dmabuf_fd` is not carried).
+ */
+struct CameraFrame {
+    core::Tensor image;        // UInt8, {height, width, channels} (2 for YUYV/UYVY, 3 for RGB/BGR),
+                               // {height * 3 / 2, width} for NV12, {height, width} for GREY,
+                               // {bytes} for MJPEG. Rows may be padded (see `stride`).
+    PixelFormat format = PixelFormat::YUYV;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;       // Bytes per row, as laid out by the driver
+    uint64_t sequence = 0;     // Driver frame counter; gaps are dropped frames
+    int64_t timestamp_ns = 0;  // Start of exposure on the CLOCK_MONOTONIC time line (also in image.timestamp)
+
+    int dmabuf_fd = -1;        // The buffer as a DMABUF, owned by the camera; -1 if not exported
+    uint32_t buffer_index = 0; // Which driver buffer holds the frame
+
+    IGNLINK_MESSAGE_FIELDS(image, format, width, height, stride, sequence, timestamp_ns)
+};
+
+/**
+ * @class Camera
+ * @brief A frame source; V4L2 devices are the Linux implementation (create_v4l2_camera()).
+ *
+ * Frames are delivered to the callback on the camera's capture thread, as
+ * shared pointers that can be published as they are. A slow subscriber that
+ * holds on to frames takes buffers away from the driver; with none left, the
+ * driver drops frames (counted in `Stats::dropped`) until one comes back.
+ *
+ * @example
+ *   auto camera = ignlink::hal::create_v4l2_camera();
+ *   ignlink::hal::CameraConfig config;
+ *   config.width = 1280;
+ *   config.height = 720;
+ *   camera->open(config);
+ *   auto publisher = node.create_publisher<ignlink::hal::CameraFrame>("/camera/image_raw");
+ *   camera->start([&](std::shared_ptr<const ignlink::hal::CameraFrame> frame) {
+ *       publisher->publish(std::move(frame));
+ *   });
+ */
+class Camera {
+public:
+    using FrameCallback = std::function<void(std::shared_ptr<const CameraFrame>)>;
+
+    /**
+     * @struct Stats
+     * @brief Capture counters since `open()`.
+     */
+    struct Stats {
+        uint64_t frames = 0;       // Delivered to the callback
+        uint64_t dropped = 0;      // Skipped by the driver (sequence gaps)
+        uint64_t starved = 0;      // Times every buffer was held by subscribers
+        uint32_t buffers_held = 0; // Right now, outside the driver
+    };
+
+    virtual ~Camera() = default;
+
+    /**
+     * @brief Opens the device and negotiates the format, size and rate.
+     */
+    virtual core::Status open(const CameraConfig& config) = 0;
+
+    /**
+     * @brief Starts streaming; `callback` is called for each frame on the capture thread.
+     */
+    virtual core::Status start(FrameCallback callback) = 0;
+
+    /**
+     * @brief Starts streaming on `loop` instead of a thread of its own; `callback` is called on the loop.
+     * @return Unavailable if the implementation cannot run on an event loop.
+     */
+    virtual core::Status start(FrameCallback callback, core::EventLoop& loop) {
+        (void)callback;
+        (void)loop;
+        return core::Status(core::Status::Code::Unavailable, "This camera cannot run on an event loop");
+    }
+
+    /**
+     * @brief Stops streaming. Frames still held stay valid.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Stops and closes the device. Frames still held stay valid.
+     */
+    virtual void close() = 0;
+
+    /**
+     * @brief The configuration in effect, after the driver's adjustments.
+     */
+    virtual const CameraConfig& config() const = 0;
+
+    virtual Stats stats() const = 0;
+};
+
+/**
+ * @brief Creates a camera backed by a V4L2 capture device.
+ *
+ * `CameraConfig::device` is a device node ("/dev/video0"), or "file:<path>"
+ * for a simulated device that plays back raw frames from a file in a loop at
+ * the configured rate (for tests, benchmarks and replays).
+ */
+std::unique_ptr<Camera> create_v4l2_camera();
+
+} // namespace hal
+} // namespace ignlink
+
+IGNLINK_MESSAGE_NAME(ignlink::hal::CameraFrame, "hal/CameraFrame")
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/msg/message_traits.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace core {
+class EventLoop;
+} // namespace core
+
+namespace hal {
+
+/**
+ * @struct CanFrame
+ * @brief One CAN or CAN FD frame.
+ *
+ * The first 72 bytes are laid out as SocketCAN's `struct canfd_frame` (and,
+ * for the first 16, `struct can_frame`), so frames are received from the
+ * kernel straight into a batch, and sent from one, without conversion.
+ */
+struct CanFrame {
+    static constexpr uint32_t kExtended = 0x80000000u;   // `id` is a 29-bit identifier (CAN_EFF_FLAG)
+    static constexpr uint32_t kRemote = 0x40000000u;     // Remote transmission request (CAN_RTR_FLAG)
+    static constexpr uint32_t kErrorFrame = 0x20000000u; // Controller error report (CAN_ERR_FLAG)
+    static constexpr uint8_t kBitRateSwitch = 0x01;      // CANFD_BRS
+    static constexpr uint8_t kErrorState = 0x02;         // CANFD_ESI
+    static constexpr uint8_t kFd = 0x04;                 // A CAN FD frame (CANFD_FDF)
+
+    uint32_t id = 0;             // The identifier with the k* flags above, as SocketCAN's can_id
+    uint8_t len = 0;             // Payload bytes: up to 8, or 64 for CAN FD
+    uint8_t flags = 0;           // kBitRateSwitch, kErrorState, kFd
+    uint8_t reserved[2] = {};
+    uint8_t data[64] = {};
+    int64_t timestamp_ns = 0;    // Received, on the CLOCK_MONOTONIC time line (kernel stamp)
+    int64_t hw_timestamp_ns = 0; // Received, by the controller's clock; 0 if it does not stamp
+
+    uint32_t identifier() const { return id & ((id & kExtended) ? 0x1fffffffu : 0x7ffu); }
+};
+
+static_assert(sizeof(CanFrame) == 88, "CanFrame layout");
+
+/**
+ * @struct CanFrameBatch
+ * @brief The frames one wakeup received, as published on the bus.
+ *
+ * A loaded bus delivers thousands of frames a second; one message per batch
+ * keeps the per-message cost of the bus off every 8-byte frame.
+ */
+struct CanFrameBatch {
+    std::vector<CanFrame> frames; // In reception order
+    uint64_t dropped = 0;         // Frames the kernel dropped so far (receive queue full)
+
+    IGNLINK_MESSAGE_FIELDS(frames, dropped)
+};
+
+/**
+ * @struct CanFilter
+ * @brief Accepts frames whose `id` matches `(frame.id & mask) == (id & mask)`.
+ *
+ * Include CanFrame::kExtended in `mask` to tell 11- and 29-bit identifiers
+ * apart, e.g. `{0x100, 0x7ff | CanFrame::kExtended}` for standard ID 0x100 only.
+ */
+struct CanFilter {
+    uint32_t id = 0;
+    uint32_t mask = 0;
+};
+
+/**
+ * @struct CanBusConfig
+ * @brief Which interface to use, and how.
+ */
+struct CanBusConfig {
+    std::string interface = "can0";
+    int socket_fd = -1;              // Use this open socket (e.g. passed by a supervisor) instead; the bus owns it
+    bool fd_frames = false;          // Receive and send CAN FD frames too
+    std::vector<CanFilter> filters;  // Empty for every frame
+    size_t batch_size = 64;          // Most frames taken from the kernel per system call
+    int receive_buffer_bytes = 0;    // SO_RCVBUF; 0 keeps the system default
+    bool hardware_timestamps = true; // Ask the controller for its own receive stamps, where it has them
+};
+
+/**
+ * @class CanBus
+ * @brief A CAN interface; SocketCAN is the Linux implementation (create_socket_can_bus()).
+ *
+ * Frames arrive in batches on the bus's receive thread: every wakeup takes
+ * all the frames waiting, up to `batch_size`, in one system call and
+ * delivers them as one CanFrameBatch. A quiet bus therefore gets batches of
+ * one frame with no added latency, and a saturated one gets full batches.
+ * Filters are applied by the kernel, so frames nobody asked for never wake
+ * the process up.
+ *
+ * @example
+ *   auto can = ignlink::hal::create_socket_can_bus();
+ *   ignlink::hal::CanBusConfig config;
+ *   config.interface = "can0";
+ *   config.filters = {{0x100, 0x700}}; // IDs 0x100-0x1ff
+ *   can->open(config);
+ *   auto publisher = node.create_publisher<ignlink::hal::CanFrameBatch>("/vehicle/can0");
+ *   can->start([&](std::shared_ptr<const ignlink::hal::CanFrameBatch> batch) {
+ *       publisher->publish(std::move(batch));
+ *   });
+ */
+class CanBus {
+public:
+    using BatchCallback = std::function<void(std::shared_ptr<const CanFrameBatch>)>;
+
+    /**
+     * @struct Stats
+     * @brief Counters since `open()`.
+     */
+    struct Stats {
+        uint64_t frames = 0;   // Received
+        uint64_t batches = 0;  // Delivered (one per receive system call)
+        uint64_t dropped = 0;  // By the kernel, receive queue full (known once a later frame arrives)
+        uint64_t sent = 0;
+        uint64_t send_errors = 0;
+    };
+
+    virtual ~CanBus() = default;
+
+    /**
+     * @brief Opens the interface and installs the filters.
+     */
+    virtual core::Status open(const CanBusConfig& config) = 0;
+
+    /**
+     * @brief Starts receiving; `callback` is called for each batch on the receive thread.
+     */
+    virtual core::Status start(BatchCallback callback) = 0;
+
+    /**
+     * @brief Starts receiving on `loop` instead of a thread of its own; `callback` is called on the loop.
+     * @return Unavailable if the implementation cannot run on an event loop.
+     */
+    virtual core::Status start(BatchCallback callback, core::EventLoop& loop) {
+        (void)callback;
+        (void)loop;
+        return core::Status(core::Status::Code::Unavailable, "This CAN bus cannot run on an event loop");
+    }
+
+    virtual void stop() = 0;
+    virtual void close() = 0;
+
+    /**
+     * @brief Replaces the filters while open, e.g. as subscriptions come and go. Empty for every frame.
+     */
+    virtual core::Status set_filters(const std::vector<CanFilter>& filters) = 0;
+
+    /**
+     * @brief Sends frames, in one system call where possible. Frames with kFd set go out as CAN FD.
+     * @param sent Set to the number of frames sent; fewer than `count` when the transmit queue is full.
+     */
+    virtual core::Status send(const CanFrame* frames, size_t count, size_t* sent = nullptr) = 0;
+    core::Status send(const CanFrame& frame) { return send(&frame, 1); }
+
+    virtual const CanBusConfig& config() const = 0;
+    virtual Stats stats() const = 0;
+};
+
+/**
+ * @brief Creates a CAN bus backed by a SocketCAN raw socket.
+ */
+std::unique_ptr<CanBus> create_socket_can_bus();
+
+} // namespace hal
+} // namespace ignlink
+
+IGNLINK_MESSAGE_NAME(ignlink::hal::CanFrameBatch, "hal/CanFrameBatch")
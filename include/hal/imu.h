@@ -0,0 +1,160 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+#include <ignlink/msg/message_traits.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace core {
+class EventLoop;
+} // namespace core
+
+namespace hal {
+
+/**
+ * @struct ImuSample
+ * @brief One inertial measurement.
+ */
+struct ImuSample {
+    int64_t timestamp_ns = 0;   // Measured, on the CLOCK_MONOTONIC time line (mapped from `device_time_ns`)
+    int64_t device_time_ns = 0; // Measured, by the IMU's own clock
+    float accel[3] = {};        // m/s^2
+    float gyro[3] = {};         // rad/s
+    float temperature = 0;      // Degrees Celsius
+    uint32_t sequence = 0;      // The IMU's sample counter; gaps are lost samples
+};
+
+/**
+ * @struct ImuBatch
+ * @brief Consecutive samples, as published on the bus.
+ *
+ * At 1-4 kHz, one message per sample would spend more on the bus than on the
+ * data. A batch has a fixed capacity and is trivially copyable, so it goes
+ * to other processes as a single memcpy.
+ */
+struct ImuBatch {
+    static constexpr size_t kCapacity = 64;
+
+    uint32_t count = 0;           // Samples in use
+    uint32_t reserved = 0;
+    uint64_t lost = 0;            // Samples lost so far (gaps in the sequence)
+    uint64_t checksum_errors = 0; // Packets rejected so far
+    ImuSample samples[kCapacity];
+
+    const ImuSample* begin() const { return samples; }
+    const ImuSample* end() const { return samples + count; }
+};
+
+static_assert(sizeof(ImuSample) == 48, "ImuSample layout");
+
+/**
+ * @struct ImuConfig
+ * @brief Which serial port to read, and how to batch.
+ */
+struct ImuConfig {
+    std::string device = "/dev/ttyUSB0";
+    uint32_t baud_rate = 921600;     // 0 leaves the port's speed (e.g. USB CDC or a pseudo-terminal)
+    size_t batch_size = 32;          // Samples per batch, at most ImuBatch::kCapacity
+    uint32_t max_latency_us = 20000; // A partial batch is delivered once its first sample is this old
+};
+
+/**
+ * @class Imu
+ * @brief An inertial measurement unit; create_serial_imu() reads one streaming over a UART.
+ *
+ * Samples arrive in batches of `batch_size` on the IMU's read thread. Rather
+ * than waking for every sample, the driver sleeps until a batch's worth of
+ * data should be waiting, reads it in one system call and parses it in one
+ * pass, so the cost per sample stays small on slow cores. A stream that
+ * slows down or stops still gets its samples out within `max_latency_us`.
+ *
+ * @example
+ *   auto imu = ignlink::hal::create_serial_imu();
+ *   ignlink::hal::ImuConfig config;
+ *   config.device = "/dev/ttyTHS1";
+ *   config.baud_rate = 2000000;
+ *   imu->open(config);
+ *   auto publisher = node.create_publisher<ignlink::hal::ImuBatch>("/imu/raw");
+ *   imu->start([&](std::shared_ptr<const ignlink::hal::ImuBatch> batch) {
+ *       publisher->publish(std::move(batch));
+ *   });
+ */
+class Imu {
+public:
+    using BatchCallback = std::function<void(std::shared_ptr<const ImuBatch>)>;
+
+    /**
+     * @struct Stats
+     * @brief Counters since `open()`.
+     */
+    struct Stats {
+        uint64_t samples = 0;         // Delivered
+        uint64_t batches = 0;         // Delivered
+        uint64_t reads = 0;           // Read system calls that returned data
+        uint64_t lost = 0;            // Gaps in the IMU's sample counter
+        uint64_t checksum_errors = 0; // Packets with a header but a bad checksum
+        uint64_t skipped_bytes = 0;   // Discarded while looking for a packet header
+    };
+
+    virtual ~Imu() = default;
+
+    /**
+     * @brief Opens the port and puts it in raw mode at `baud_rate`.
+     */
+    virtual core::Status open(const ImuConfig& config) = 0;
+
+    /**
+     * @brief Starts reading; `callback` is called for each batch on the read thread.
+     */
+    virtual core::Status start(BatchCallback callback) = 0;
+
+    /**
+     * @brief Starts reading on `loop` instead of a thread of its own; `callback` is called on the loop.
+     * @return Unavailable if the implementation cannot run on an event loop.
+     */
+    virtual core::Status start(BatchCallback callback, core::EventLoop& loop) {
+        (void)callback;
+        (void)loop;
+        return core::Status(core::Status::Code::Unavailable, "This IMU cannot run on an event loop");
+    }
+
+    virtual void stop() = 0;
+    virtual void close() = 0;
+    virtual const ImuConfig& config() const = 0;
+    virtual Stats stats() const = 0;
+};
+
+/**
+ * @brief Creates an IMU that reads the serial packet format below from a UART.
+ *
+ * Each sample is a 36-byte little-endian packet:
+ *
+ *   offset  size  field
+ *        0     2  header, 0xa5 0x5a
+ *        2     2  uint16 sample counter
+ *        4     4  uint32 device time, microseconds
+ *        8    12  float accel x, y, z, m/s^2
+ *       20    12  float gyro x, y, z, rad/s
+ *       32     2  int16 temperature, hundredths of a degree Celsius
+ *       34     2  uint16 checksum: the sum of bytes 2-33
+ */
+std::unique_ptr<Imu> create_serial_imu();
+
+constexpr size_t kImuPacketSize = 36;
+
+/**
+ * @brief Encodes a sample as the packet create_serial_imu() reads, for simulators and tests.
+ * @param out At least kImuPacketSize bytes.
+ * @return kImuPacketSize.
+ */
+size_t encode_imu_packet(const ImuSample& sample, uint8_t* out);
+
+} // namespace hal
+} // namespace ignlink
+
+IGNLINK_MESSAGE_NAME(ignlink::hal::ImuBatch, "hal/ImuBatch")
@@ -2,6 +2,7 @@
 
 #include "node_context.h"
 #include <memory>
+#include <vector>
 
 namespace ignlink {
 namespace msg {
@@ -17,6 +18,12 @@ public:
      * @return A shared_ptr to the global NodeContext.
      */
     static std::shared_ptr<NodeContext> get_instance();
+
+    /**
+     * @brief Makes the global NodeContext, when it is created, run on event loops.
+     * @return AlreadyExists if the context has been created already.
+     */
+    static core::Status use_event_loops(std::vector<std::shared_ptr<core::EventLoop>> loops);
 };
 
 } // namespace msg
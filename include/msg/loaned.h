@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ignlink {
+namespace msg {
+
+template <typename T>
+class Loaned;
+
+/**
+ * @class LoanPool
+ * @brief A pool of preallocated messages that publishers lend out and subscribers give back.
+ *
+ * Messages handed out by `loan()` are filled in place by the publisher and then
+ * published as a `std::shared_ptr<const T>`. When the last subscriber drops
+ * its pointer, the message returns to the pool instead of being destroyed, so
+ * a steady-state publisher neither allocates nor copies. Recycled messages
+ * keep their previous contents (and, importantly, the capacity of any
+ * containers inside them), so a publisher that overwrites a frame buffer of
+ * the same size each cycle never reallocates it.
+ *
+ * Each pooled slot also holds the storage for the shared pointer's control
+ * block, so publishing a loan allocates nothing either.
+ *
+ * A loan never fails: when every message is in flight, an extra one is
+ * allocated. The pool keeps at most `capacity` idle messages, though, so an
+ * extra message is freed when it comes back; a burst does not grow the pool
+ * for good.
+ *
+ * @tparam T The message type. It must be default-constructible.
+ */
+template <typename T>
+class LoanPool {
+public:
+    /**
+     * @param capacity The number of messages to preallocate, and to keep once they come back.
+     */
+    explicit LoanPool(size_t capacity) : state_(std::make_shared<State>()) {
+        state_->capacity = capacity;
+        state_->free.reserve(capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            state_->free.push_back(std::make_unique<Slot>());
+        }
+    }
+
+    /**
+     * @brief Lends out a message to fill in.
+     */
+    Loaned<T> loan() {
+        std::unique_ptr<Slot> slot;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!state_->free.empty()) {
+                slot = std::move(state_->free.back());
+                state_->free.pop_back();
+            }
+        }
+        if (!slot) {
+            slot = std::make_unique<Slot>(); // Every message is in flight; lend an extra one.
+        }
+        return Loaned<T>(std::move(slot), state_);
+    }
+
+private:
+    friend class Loaned<T>;
+
+    struct State;
+
+    // Room for the control block of a shared_ptr with an empty deleter and a
+    // one-pointer allocator: two counts, a vtable and the pointer itself.
+    static constexpr size_t kControlBlockSize = 64;
+
+    struct Slot {
+        T msg{};
+        std::shared_ptr<State> home; // Set while the message is shared, to find its way back
+        alignas(std::max_align_t) unsigned char control_block[kControlBlockSize];
+    };
+
+    // Shared with every outstanding message, so messages still held by
+    // subscribers can find their way home even after the pool is gone.
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Slot>> free;
+        size_t capacity = 0;
+    };
+
+    /**
+     * @brief Places a shared message's control block in its slot.
+     *
+     * The control block is released last, after the message itself and after
+     * any weak pointers, so that is when the slot goes back to the pool; its
+     * storage cannot be reused while the old control block is still alive.
+     */
+    template <typename U>
+    struct SlotAllocator {
+        using value_type = U;
+
+        explicit SlotAllocator(Slot* s) : slot(s) {}
+        template <typename V>
+        SlotAllocator(const SlotAllocator<V>& other) : slot(other.slot) {}
+
+        U* allocate(size_t n) {
+            static_assert(sizeof(U) <= kControlBlockSize && alignof(U) <= alignof(std::max_align_t),
+                          "The shared_ptr control block does not fit in a pooled slot");
+            (void)n; // Always 1: shared_ptr allocates exactly one control block
+            return reinterpret_cast<U*>(slot->control_block);
+        }
+
+        void deallocate(U*, size_t) { give_back(std::unique_ptr<Slot>(slot)); }
+
+        template <typename V>
+        bool operator==(const SlotAllocator<V>& other) const { return slot == other.slot; }
+        template <typename V>
+        bool operator!=(const SlotAllocator<V>& other) const { return slot != other.slot; }
+
+        Slot* slot;
+    };
+
+    // Returns a slot whose `home` is set to the pool it came from.
+    static void give_back(std::unique_ptr<Slot> slot) {
+        const std::shared_ptr<State> state = std::move(slot->home);
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->free.size() < state->capacity) {
+            state->free.push_back(std::move(slot));
+        }
+        // Otherwise it was an extra loan; it is freed as `slot` goes out of scope.
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @class Loaned
+ * @brief A writable message borrowed from a publisher's pool.
+ *
+ * Obtain one with `Publisher<T>::loan()`, fill it in place, and hand it back
+ * with `Publisher<T>::publish(std::move(loaned))`. If it is destroyed without
+ * being published, it simply returns to the pool.
+ *
+ * @example
+ *   auto frame = image_pub->loan();
+ *   camera.read_into(frame->data());   // The only write the pixels ever see.
+ *   image_pub->publish(std::move(frame));
+ */
+template <typename T>
+class Loaned {
+public:
+    Loaned() = default;
+    Loaned(Loaned&&) noexcept = default;
+    Loaned& operator=(Loaned&& other) noexcept {
+        if (this != &other) {
+            release();
+            slot_ = std::move(other.slot_);
+            pool_ = std::move(other.pool_);
+        }
+        return *this;
+    }
+    Loaned(const Loaned&) = delete;
+    Loaned& operator=(const Loaned&) = delete;
+
+    ~Loaned() { release(); }
+
+    T* get() const { return slot_ ? &slot_->msg : nullptr; }
+    T& operator*() const { return slot_->msg; }
+    T* operator->() const { return &slot_->msg; }
+    explicit operator bool() const { return static_cast<bool>(slot_); }
+
+    /**
+     * @brief Converts the loan into the immutable, shared form subscribers receive.
+     *
+     * The returned pointer returns the message to its pool when the last copy
+     * of it is dropped. This object is left empty.
+     */
+    std::shared_ptr<const T> share() && {
+        if (!slot_) {
+            return nullptr;
+        }
+        Slot* slot = slot_.release();
+        slot->home = std::move(pool_);
+        // The message is recycled, not destroyed, so the deleter has nothing to
+        // do; the allocator hands the slot back once the control block is gone.
+        using Allocator = typename LoanPool<T>::template SlotAllocator<T>;
+        return std::shared_ptr<const T>(&slot->msg, [](const T*) {}, Allocator(slot));
+    }
+
+private:
+    friend class LoanPool<T>;
+
+    using Slot = typename LoanPool<T>::Slot;
+
+    Loaned(std::unique_ptr<Slot> slot, std::shared_ptr<typename LoanPool<T>::State> pool)
+        : slot_(std::move(slot)), pool_(std::move(pool)) {}
+
+    void release() {
+        if (slot_ && pool_) {
+            slot_->home = std::move(pool_);
+            LoanPool<T>::give_back(std::move(slot_));
+        }
+        slot_.reset();
+        pool_.reset();
+    }
+
+    std::unique_ptr<Slot> slot_;
+    std::shared_ptr<typename LoanPool<T>::State> pool_;
+};
+
+} // namespace msg
+} // namespace ignlink
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ignlink {
+namespace msg {
+
+/**
+ * @struct MessageInfo
+ * @brief Metadata delivered alongside every message.
+ *
+ * Timestamps come from core::MonotonicClock, so `receive_time_ns -
+ * publish_time_ns` is the time the message spent in the bus: queueing,
+ * dispatch and waiting for a free executor thread.
+ */
+struct MessageInfo {
+    uint64_t publisher_id = 0;   // Identifies the publishing Publisher within this process (never 0)
+    uint64_t sequence = 0;       // Per publisher, starting at 1; a gap means the subscriber missed messages
+    int64_t publish_time_ns = 0; // When `publish()` was called
+    int64_t receive_time_ns = 0; // When the subscriber's callback was invoked
+
+    /**
+     * @brief Gets the time the message spent between publish and callback, in nanoseconds.
+     */
+    int64_t latency_ns() const { return receive_time_ns - publish_time_ns; }
+};
+
+} // namespace msg
+} // namespace ignlink
@@ -0,0 +1,504 @@
+#pragma once
+
+#include <ignlink/core/tensor.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ignlink {
+namespace msg {
+
+/**
+ * @struct MessageType
+ * @brief The runtime identity of a message type, as exchanged between endpoints.
+ */
+struct MessageType {
+    uint64_t hash = 0; // Stable across processes and builds; compared at registration
+    std::string name;  // Human-readable, for diagnostics only
+};
+
+/**
+ * @brief Names a message type for the bus.
+ *
+ * The name is what the type hash is derived from, so giving every message type
+ * a fixed name (e.g. "sensors/Imu") keeps the hash stable across compilers,
+ * namespaces and refactors. Unnamed types fall back to their compiler-spelled
+ * name, which is only guaranteed to match between binaries built by the same
+ * toolchain. Specialize it with IGNLINK_MESSAGE_NAME, at global scope.
+ */
+template <typename T>
+struct MessageName {
+    static constexpr const char* value = nullptr;
+};
+
+/**
+ * @brief Gives a message type a fixed bus name. Use at global scope.
+ *
+ * @example
+ *   IGNLINK_MESSAGE_NAME(perception::Detection, "perception/Detection")
+ */
+#define IGNLINK_MESSAGE_NAME(Type, Name)                      \
+    namespace ignlink {                                       \
+    namespace msg {                                           \
+    template <>                                               \
+    struct MessageName<Type> {                                \
+        static constexpr const char* value = Name;            \
+    };                                                        \
+    }                                                         \
+    }
+
+/**
+ * @brief Lists the members of a message struct that make up its wire format.
+ *
+ * Use inside the struct body. Types that are not trivially copyable (because
+ * they hold strings, vectors or tensors) are serialized member by member in
+ * the order given. Trivially copyable types do not need it.
+ *
+ * @example
+ *   struct Detection {
+ *       std::string label;
+ *       float score;
+ *       std::vector<float> box;
+ *       IGNLINK_MESSAGE_FIELDS(label, score, box)
+ *   };
+ */
+#define IGNLINK_MESSAGE_FIELDS(...)                                          \
+    auto ignlink_fields() { return std::tie(__VA_ARGS__); }                  \
+    auto ignlink_fields() const { return std::tie(__VA_ARGS__); }
+
+namespace detail {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+constexpr uint64_t fnv1a(std::string_view text, uint64_t hash = kFnvOffset) {
+    for (char c : text) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * kFnvPrime;
+    }
+    return hash;
+}
+
+constexpr uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        seed = (seed ^ ((value >> (8 * i)) & 0xff)) * kFnvPrime;
+    }
+    return seed;
+}
+
+/**
+ * @brief The compiler's spelling of T, extracted at compile time.
+ */
+template <typename T>
+constexpr std::string_view compiler_type_name() {
+#if defined(__clang__) || defined(__GNUC__)
+    constexpr std::string_view signature = __PRETTY_FUNCTION__;
+    constexpr size_t begin = signature.find("T = ") + 4;
+    constexpr size_t end = signature.find_first_of(";]", begin);
+    return signature.substr(begin, end - begin);
+#elif defined(_MSC_VER)
+    constexpr std::string_view signature = __FUNCSIG__;
+    constexpr size_t begin = signature.find("compiler_type_name<") + 19;
+    constexpr size_t end = signature.rfind(">(void)");
+    return signature.substr(begin, end - begin);
+#else
+    static_assert(MessageName<T>::value != nullptr, "Name this type with IGNLINK_MESSAGE_NAME.");
+    return {};
+#endif
+}
+
+template <typename T>
+struct dependent_false : std::false_type {};
+
+template <typename T>
+struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_fields : std::false_type {};
+template <typename T>
+struct has_fields<T, std::void_t<decltype(std::declval<const T&>().ignlink_fields())>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_memcpy_safe_v = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> &&
+                                  !std::is_member_pointer_v<T>;
+
+template <typename T>
+constexpr const char* builtin_name() {
+    if constexpr (std::is_same_v<T, bool>) return "bool";
+    else if constexpr (std::is_same_v<T, char>) return "char";
+    else if constexpr (std::is_same_v<T, int8_t>) return "int8";
+    else if constexpr (std::is_same_v<T, uint8_t>) return "uint8";
+    else if constexpr (std::is_same_v<T, int16_t>) return "int16";
+    else if constexpr (std::is_same_v<T, uint16_t>) return "uint16";
+    else if constexpr (std::is_same_v<T, int32_t>) return "int32";
+    else if constexpr (std::is_same_v<T, uint32_t>) return "uint32";
+    else if constexpr (std::is_same_v<T, int64_t>) return "int64";
+    else if constexpr (std::is_same_v<T, uint64_t>) return "uint64";
+    else if constexpr (std::is_same_v<T, float>) return "float32";
+    else if constexpr (std::is_same_v<T, double>) return "float64";
+    else if constexpr (std::is_same_v<T, std::string>) return "string";
+    else if constexpr (std::is_same_v<T, core::Tensor>) return "ignlink/Tensor";
+    else return MessageName<T>::value;
+}
+
+template <typename T>
+constexpr uint64_t type_hash();
+
+template <typename Tuple, size_t... I>
+constexpr uint64_t fields_hash(uint64_t seed, std::index_sequence<I...>) {
+    ((seed = hash_combine(seed, type_hash<std::decay_t<std::tuple_element_t<I, Tuple>>>())), ...);
+    return seed;
+}
+
+/**
+ * @brief The stable hash of T: its name, plus whatever determines its wire layout.
+ *
+ * Element types of vectors and the members listed by IGNLINK_MESSAGE_FIELDS
+ * are folded in, and so is the size of memcpy-serialized types, so a layout
+ * change that keeps the name still gets a new hash.
+ */
+template <typename T>
+constexpr uint64_t type_hash() {
+    if constexpr (is_vector<T>::value) {
+        static_assert(!std::is_same_v<T, std::vector<bool>>, "std::vector<bool> cannot be serialized; use uint8_t.");
+        return hash_combine(fnv1a("vector"), type_hash<typename T::value_type>());
+    } else {
+        uint64_t hash = 0;
+        if constexpr (builtin_name<T>() != nullptr) {
+            hash = fnv1a(builtin_name<T>());
+        } else {
+            hash = fnv1a(compiler_type_name<T>());
+        }
+        if constexpr (is_memcpy_safe_v<T>) {
+            hash = hash_combine(hash, sizeof(T));
+        } else if constexpr (has_fields<T>::value) {
+            using Tuple = decltype(std::declval<const T&>().ignlink_fields());
+            hash = fields_hash<Tuple>(hash, std::make_index_sequence<std::tuple_size_v<Tuple>>());
+        }
+        return hash;
+    }
+}
+
+template <typename T>
+std::string type_name() {
+    if constexpr (is_vector<T>::value) {
+        return "vector<" + type_name<typename T::value_type>() + ">";
+    } else {
+        if constexpr (builtin_name<T>() != nullptr) {
+            return builtin_name<T>();
+        } else {
+            return std::string(compiler_type_name<T>());
+        }
+    }
+}
+
+// --- Wire format ---
+// Everything is written in host byte order with no alignment padding, except
+// before tensor data (see below). Strings and vectors carry a uint32_t length.
+
+// Tensor header: dtype, rank, 6 reserved bytes, timestamp, then the shape.
+// It is padded to a multiple of 64 bytes so that a tensor sent as a whole
+// message keeps its data 64-byte aligned in transport buffers.
+constexpr size_t kTensorAlignment = 64;
+
+inline size_t tensor_header_size(size_t rank) {
+    const size_t size = 16 + 8 * rank;
+    return (size + kTensorAlignment - 1) / kTensorAlignment * kTensorAlignment;
+}
+
+template <typename T>
+constexpr size_t min_encoded_size();
+
+template <typename Tuple, size_t... I>
+constexpr size_t min_fields_size(std::index_sequence<I...>) {
+    return (size_t(0) + ... + min_encoded_size<std::decay_t<std::tuple_element_t<I, Tuple>>>());
+}
+
+/**
+ * @brief The fewest bytes any value of T encodes to, to bound lengths read from untrusted input.
+ */
+template <typename T>
+constexpr size_t min_encoded_size() {
+    if constexpr (is_memcpy_safe_v<T>) {
+        return sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string> || is_vector<T>::value) {
+        return sizeof(uint32_t);
+    } else if constexpr (std::is_same_v<T, core::Tensor>) {
+        return kTensorAlignment; // tensor_header_size(0)
+    } else if constexpr (has_fields<T>::value) {
+        using Tuple = decltype(std::declval<const T&>().ignlink_fields());
+        return min_fields_size<Tuple>(std::make_index_sequence<std::tuple_size_v<Tuple>>());
+    } else {
+        return 0;
+    }
+}
+
+template <typename T>
+size_t encoded_size(const T& value);
+template <typename T>
+uint8_t* encode(const T& value, uint8_t* out);
+template <typename T>
+const uint8_t* decode(const uint8_t* in, const uint8_t* end, T* value, const std::shared_ptr<const void>* owner);
+
+template <typename T>
+size_t encoded_size(const T& value) {
+    if constexpr (is_memcpy_safe_v<T>) {
+        (void)value;
+        return sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return sizeof(uint32_t) + value.size();
+    } else if constexpr (is_vector<T>::value) {
+        using Element = typename T::value_type;
+        if constexpr (is_memcpy_safe_v<Element>) {
+            return sizeof(uint32_t) + value.size() * sizeof(Element);
+        } else {
+            size_t size = sizeof(uint32_t);
+            for (const auto& element : value) {
+                size += encoded_size(element);
+            }
+            return size;
+        }
+    } else if constexpr (std::is_same_v<T, core::Tensor>) {
+        return tensor_header_size(value.rank()) + value.nbytes();
+    } else if constexpr (has_fields<T>::value) {
+        return std::apply([](const auto&... field) { return (size_t(0) + ... + encoded_size(field)); },
+                          value.ignlink_fields());
+    } else {
+        static_assert(dependent_false<T>::value,
+                      "This type cannot be serialized: make it trivially copyable, list its members with "
+                      "IGNLINK_MESSAGE_FIELDS, or specialize ignlink::msg::MessageTraits for it.");
+        return 0;
+    }
+}
+
+template <typename T>
+uint8_t* encode(const T& value, uint8_t* out) {
+    if constexpr (is_memcpy_safe_v<T>) {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        const uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), value.data(), length);
+        return out + sizeof(length) + length;
+    } else if constexpr (is_vector<T>::value) {
+        using Element = typename T::value_type;
+        const uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(out, &length, sizeof(length));
+        out += sizeof(length);
+        if constexpr (is_memcpy_safe_v<Element>) {
+            if (length) {
+                std::memcpy(out, value.data(), length * sizeof(Element));
+            }
+            return out + length * sizeof(Element);
+        } else {
+            for (const auto& element : value) {
+                out = encode(element, out);
+            }
+            return out;
+        }
+    } else if constexpr (std::is_same_v<T, core::Tensor>) {
+        const size_t header_size = tensor_header_size(value.rank());
+        std::memset(out, 0, header_size);
+        out[0] = static_cast<uint8_t>(value.dtype());
+        out[1] = static_cast<uint8_t>(value.rank());
+        std::memcpy(out + 8, &value.timestamp, sizeof(int64_t));
+        std::memcpy(out + 16, value.shape(), value.rank() * sizeof(int64_t));
+        out += header_size;
+        const core::Tensor contiguous = value.contiguous();
+        if (contiguous.nbytes()) {
+            std::memcpy(out, contiguous.data(), contiguous.nbytes());
+        }
+        return out + contiguous.nbytes();
+    } else {
+        std::apply([&out](const auto&... field) { ((out = encode(field, out)), ...); }, value.ignlink_fields());
+        return out;
+    }
+}
+
+template <typename T>
+const uint8_t* decode(const uint8_t* in, const uint8_t* end, T* value, const std::shared_ptr<const void>* owner) {
+    if (!in) {
+        return nullptr;
+    }
+    if constexpr (is_memcpy_safe_v<T>) {
+        if (static_cast<size_t>(end - in) < sizeof(T)) {
+            return nullptr;
+        }
+        std::memcpy(value, in, sizeof(T));
+        return in + sizeof(T);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        uint32_t length;
+        if (static_cast<size_t>(end - in) < sizeof(length)) {
+            return nullptr;
+        }
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if (static_cast<size_t>(end - in) < length) {
+            return nullptr;
+        }
+        value->assign(reinterpret_cast<const char*>(in), length);
+        return in + length;
+    } else if constexpr (is_vector<T>::value) {
+        using Element = typename T::value_type;
+        uint32_t length;
+        if (static_cast<size_t>(end - in) < sizeof(length)) {
+            return nullptr;
+        }
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if constexpr (is_memcpy_safe_v<Element>) {
+            if (static_cast<size_t>(end - in) / sizeof(Element) < length) {
+                return nullptr;
+            }
+            value->resize(length);
+            if (length) {
+                std::memcpy(value->data(), in, length * sizeof(Element));
+            }
+            return in + length * sizeof(Element);
+        } else {
+            // Check the length against what is left before allocating for it.
+            constexpr size_t kMinElementSize = min_encoded_size<Element>();
+            if (kMinElementSize && static_cast<size_t>(end - in) / kMinElementSize < length) {
+                return nullptr;
+            }
+            // Decoding into existing elements keeps their capacity for reuse.
+            value->resize(length);
+            for (auto& element : *value) {
+                in = decode(in, end, &element, owner);
+            }
+            return in;
+        }
+    } else if constexpr (std::is_same_v<T, core::Tensor>) {
+        if (end - in < 16) {
+            return nullptr;
+        }
+        const auto dtype = static_cast<core::DType>(in[0]);
+        const size_t rank = in[1];
+        if (rank > core::Tensor::kMaxRank || static_cast<size_t>(end - in) < tensor_header_size(rank)) {
+            return nullptr;
+        }
+        int64_t timestamp;
+        int64_t shape[core::Tensor::kMaxRank];
+        std::memcpy(&timestamp, in + 8, sizeof(timestamp));
+        std::memcpy(shape, in + 16, rank * sizeof(int64_t));
+        size_t bytes = core::dtype_size(dtype);
+        for (size_t i = 0; i < rank; ++i) {
+            if (shape[i] < 0) {
+                return nullptr;
+            }
+            const size_t dim = static_cast<size_t>(shape[i]);
+            if (dim != 0 && bytes > SIZE_MAX / dim) {
+                return nullptr; // The size would wrap around
+            }
+            bytes *= dim;
+        }
+        in += tensor_header_size(rank);
+        if (static_cast<size_t>(end - in) < bytes) {
+            return nullptr;
+        }
+        if (owner && *owner) {
+            // Zero-copy: the tensor is a view into the received buffer.
+            *value = core::Tensor::wrap(in, dtype, shape, rank, *owner);
+        } else {
+            value->resize(dtype, shape, rank);
+            std::memcpy(value->data(), in, bytes);
+        }
+        value->timestamp = timestamp;
+        return in + bytes;
+    } else {
+        std::apply([&](auto&... field) { ((in = decode(in, end, &field, owner)), ...); }, value->ignlink_fields());
+        return in;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @class MessageTraits
+ * @brief The customization point that tells the bus how to identify and serialize T.
+ *
+ * The default implementation picks a serializer at compile time:
+ * - trivially copyable types are copied with a single memcpy;
+ * - std::string, std::vector and core::Tensor use a length-prefixed format;
+ * - structs that list their members with IGNLINK_MESSAGE_FIELDS are
+ *   serialized member by member, recursively.
+ * Any other type fails to compile when it is first published or subscribed to
+ * across processes. Intra-process messaging never serializes, so it accepts any type.
+ *
+ * For a hand-written wire format, specialize MessageTraits for the type and
+ * provide the same static members.
+ *
+ * The wire format is in host byte order: all supported targets are little-endian.
+ */
+template <typename T, typename Enable = void>
+struct MessageTraits {
+    /**
+     * @brief The compile-time type hash. Endpoints with different hashes never connect.
+     */
+    static constexpr uint64_t type_hash = detail::type_hash<T>();
+
+    /**
+     * @brief A readable name for diagnostics (e.g. "vector<float32>").
+     */
+    static std::string type_name() { return detail::type_name<T>(); }
+
+    /**
+     * @brief True when the serialized form is just the object's bytes.
+     */
+    static constexpr bool is_trivial = detail::is_memcpy_safe_v<T>;
+
+    /**
+     * @brief Gets the exact number of bytes `serialize()` will write.
+     */
+    static size_t serialized_size(const T& msg) { return detail::encoded_size(msg); }
+
+    /**
+     * @brief Writes the message into `out`, which must hold `serialized_size(msg)` bytes.
+     * @return The number of bytes written.
+     */
+    static size_t serialize(const T& msg, void* out) {
+        auto* begin = static_cast<uint8_t*>(out);
+        return static_cast<size_t>(detail::encode(msg, begin) - begin);
+    }
+
+    /**
+     * @brief Reads a message, copying everything out of `data`.
+     * @return False if the bytes are truncated or malformed.
+     */
+    static bool deserialize(const void* data, size_t size, T* msg) {
+        auto* begin = static_cast<const uint8_t*>(data);
+        return detail::decode(begin, begin + size, msg, nullptr) != nullptr;
+    }
+
+    /**
+     * @brief Reads a message that may keep referring to `data`.
+     *
+     * Tensors inside the message become views into `data` (which `data` keeps
+     * alive) instead of copies. Everything else is copied as in `deserialize()`.
+     */
+    static bool deserialize_shared(const std::shared_ptr<const void>& data, size_t size, T* msg) {
+        auto* begin = static_cast<const uint8_t*>(data.get());
+        return detail::decode(begin, begin + size, msg, &data) != nullptr;
+    }
+};
+
+/**
+ * @brief Gets the runtime identity of T, as recorded by publishers and subscribers.
+ */
+template <typename T>
+MessageType message_type() {
+    return MessageType{MessageTraits<T>::type_hash, MessageTraits<T>::type_name()};
+}
+
+} // namespace msg
+} // namespace ignlink
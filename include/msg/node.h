@@ -1,18 +1,46 @@
 #pragma once
 
 #include <ignlink/core/types.h>    // For Status, Tensor, etc.
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/executor.h> // For CallbackGroup
+#include <ignlink/msg/message_info.h>
+#include <ignlink/msg/message_traits.h>
+#include <ignlink/msg/qos.h>
 #include <ignlink/msg/publisher.h>
 #include <ignlink/msg/subscriber.h>
 
 #include <memory>
 #include <string>
 #include <functional>
+#include <vector>
 
 namespace ignlink {
 namespace msg {
 
 // Forward declaration to break circular dependency if NodeContext is complex.
 class NodeContext;
+class PublisherImpl;
+class SubscriberImpl;
+
+/**
+ * @brief Runs this process's message dispatch on the given event loops instead of threads of its own.
+ *
+ * By default the bus starts a scheduling thread and a pool of callback
+ * threads. On a small target that already runs its drivers on one or a few
+ * event loops, the bus can share them: subscriber callbacks then run on the
+ * loops, each callback group always on the same one, and must not block.
+ * Call this before creating the first Node; the loops must outlive the bus.
+ *
+ * @return AlreadyExists if a Node has already started the bus.
+ *
+ * @example
+ *   auto loop = std::make_shared<ignlink::core::EventLoop>("main");
+ *   ignlink::msg::run_bus_on({loop});
+ *   ignlink::msg::Node node("controller");
+ *   ...
+ *   loop->run();
+ */
+core::Status run_bus_on(std::vector<std::shared_ptr<core::EventLoop>> loops);
 
 /**
  * @class Node
@@ -41,10 +69,13 @@ public:
      * @brief Creates a Publisher to broadcast messages on a specific topic.
      *
      * A Publisher allows this node to send messages of a given type to any
-     * Subscribers listening on the same topic.
+     * Subscribers listening on the same topic. Any type can be published; its
+     * identity on the bus comes from MessageTraits<T>, and creating an endpoint
+     * whose type hash differs from the topic's existing endpoints fails.
      *
      * @tparam T The C++ type of the message to be published (e.g., ignlink::core::Tensor).
      * @param topic_name The name of the topic to publish on (e.g., "/camera/image_raw").
+     * @param qos Whether publishing may wait for full KeepAll subscribers (see QoS).
      * @return A std::shared_ptr to the created Publisher. Returns nullptr on failure.
      *
      * @example
@@ -54,12 +85,7 @@ public:
      *   }
      */
     template <typename T>
-    std::shared_ptr<Publisher<T>> create_publisher(const std::string& topic_name) {
-        // In the beginning, the implementation is just a placeholder.
-        // The real logic will be in the NodeContext.
-        // For now, this demonstrates the API.
-        return std::make_shared<Publisher<T>>(topic_name /*, context_ptr */);
-    }
+    std::shared_ptr<Publisher<T>> create_publisher(const std::string& topic_name, const QoS& qos = QoS());
 
     /**
      * @brief Creates a Subscriber to receive messages from a specific topic.
@@ -71,6 +97,10 @@ public:
      * @param topic_name The name of the topic to subscribe to.
      * @param callback The function to execute when a message is received. The
      *                 function should take a `const T&` as its argument.
+     * @param callback_group The group controlling which callbacks may run in
+     *                 parallel with this one. By default the subscriber gets a
+     *                 mutually exclusive group of its own.
+     * @param qos The depth and drop behaviour of this subscriber's queue (see QoS).
      * @return A std::shared_ptr to the created Subscriber. Returns nullptr on failure.
      *
      * @example
@@ -84,10 +114,86 @@ public:
     template <typename T>
     std::shared_ptr<Subscriber<T>> create_subscriber(
         const std::string& topic_name,
-        std::function<void(const T&)> callback) {
-        // Placeholder implementation for the API demonstration.
-        return std::make_shared<Subscriber<T>>(topic_name, callback /*, context_ptr */);
-    }
+        std::function<void(const T&)> callback,
+        std::shared_ptr<core::CallbackGroup> callback_group = nullptr,
+        const QoS& qos = QoS());
+
+    /**
+     * @brief Creates a Subscriber that receives each message as a shared, immutable pointer.
+     *
+     * Messages published in this process are delivered without any copy: every
+     * subscriber receives the very same `std::shared_ptr<const T>` the publisher
+     * handed to the bus. Keeping the pointer alive past the callback is allowed
+     * and costs nothing but a reference count.
+     *
+     * @tparam T The C++ type of the message to be received.
+     * @param topic_name The name of the topic to subscribe to.
+     * @param callback The function to execute when a message is received.
+     * @param callback_group The group controlling which callbacks may run in
+     *                 parallel with this one (see above).
+     * @return A std::shared_ptr to the created Subscriber. Returns nullptr on failure.
+     *
+     * @example
+     *   auto cloud_sub = my_node.create_subscriber<PointCloud>(
+     *       "/lidar/points",
+     *       [](std::shared_ptr<const PointCloud> cloud) { tracker.push(std::move(cloud)); }
+     *   );
+     */
+    template <typename T>
+    std::shared_ptr<Subscriber<T>> create_subscriber(
+        const std::string& topic_name,
+        std::function<void(std::shared_ptr<const T>)> callback,
+        std::shared_ptr<core::CallbackGroup> callback_group = nullptr,
+        const QoS& qos = QoS());
+
+    /**
+     * @brief Creates a Subscriber whose callback also receives the message's MessageInfo.
+     *
+     * The info says which publisher sent the message, its sequence number, and
+     * when it was published and delivered, e.g. to measure how long it waited
+     * in the bus. Both message forms (`const T&` and `std::shared_ptr<const T>`)
+     * are available.
+     *
+     * @example
+     *   auto imu_sub = my_node.create_subscriber<Imu>(
+     *       "/imu",
+     *       [](const Imu& imu, const ignlink::msg::MessageInfo& info) {
+     *           if (info.latency_ns() > 1000000) { ... } // Over 1 ms in the bus
+     *       }
+     *   );
+     */
+    template <typename T>
+    std::shared_ptr<Subscriber<T>> create_subscriber(
+        const std::string& topic_name,
+        std::function<void(const T&, const MessageInfo&)> callback,
+        std::shared_ptr<core::CallbackGroup> callback_group = nullptr,
+        const QoS& qos = QoS());
+
+    template <typename T>
+    std::shared_ptr<Subscriber<T>> create_subscriber(
+        const std::string& topic_name,
+        std::function<void(std::shared_ptr<const T>, const MessageInfo&)> callback,
+        std::shared_ptr<core::CallbackGroup> callback_group = nullptr,
+        const QoS& qos = QoS());
+
+    /**
+     * @brief Creates a callback group that several subscribers can share.
+     *
+     * Subscriber callbacks run on a pool of threads. Putting subscribers in the
+     * same MutuallyExclusive group guarantees their callbacks never overlap
+     * (useful when they touch the same state without a lock); a Reentrant group
+     * lets even a single subscriber process several messages at once.
+     *
+     * @param type The concurrency policy of the group.
+     * @return The new group, to be passed to create_subscriber.
+     *
+     * @example
+     *   auto control_group = my_node.create_callback_group(
+     *       ignlink::core::CallbackGroup::Type::MutuallyExclusive);
+     *   auto imu_sub = my_node.create_subscriber<Imu>("/imu", on_imu, control_group);
+     *   auto odom_sub = my_node.create_subscriber<Odom>("/odom", on_odom, control_group);
+     */
+    std::shared_ptr<core::CallbackGroup> create_callback_group(core::CallbackGroup::Type type);
 
     /**
      * @brief Gets the name of the node.
@@ -102,7 +208,95 @@ private:
     // public API clean and reduces compile times.
     struct Impl;
     std::unique_ptr<Impl> pimpl_;
+
+    // The type-independent halves of create_publisher/create_subscriber. They
+    // live in node.cpp so that the templates below need no internal headers.
+    std::shared_ptr<PublisherImpl> create_publisher_impl(const std::string& topic_name, const MessageType& type,
+                                                         const QoS& qos);
+    std::shared_ptr<SubscriberImpl> create_subscriber_impl(
+        const std::string& topic_name,
+        const MessageType& type,
+        std::function<void(const std::shared_ptr<const void>&, const MessageInfo&)> callback,
+        std::shared_ptr<core::CallbackGroup> callback_group,
+        const QoS& qos);
 };
 
+// =============================================================================
+// == TEMPLATE DEFINITIONS =====================================================
+// =============================================================================
+// Defined in the header so that any message type works without an explicit
+// instantiation; everything type-independent is delegated to node.cpp.
+
+template <typename T>
+std::shared_ptr<Publisher<T>> Node::create_publisher(const std::string& topic_name, const QoS& qos) {
+    auto pub_impl = create_publisher_impl(topic_name, message_type<T>(), qos);
+    if (!pub_impl) {
+        return nullptr; // Already logged.
+    }
+    // `std::make_shared` cannot access the private constructor, so we use `new`.
+    return std::shared_ptr<Publisher<T>>(new Publisher<T>(topic_name, std::move(pub_impl)));
+}
+
+template <typename T>
+std::shared_ptr<Subscriber<T>> Node::create_subscriber(
+    const std::string& topic_name,
+    std::function<void(std::shared_ptr<const T>, const MessageInfo&)> callback,
+    std::shared_ptr<core::CallbackGroup> callback_group,
+    const QoS& qos) {
+    // The underlying system only passes around `std::shared_ptr<const void>`.
+    // Registration has already verified that every endpoint on this topic uses
+    // type T, so the cast back is a plain pointer conversion: no copy, no
+    // runtime type check.
+    auto type_erased_callback = [callback = std::move(callback)](const std::shared_ptr<const void>& msg,
+                                                                 const MessageInfo& info) {
+        callback(std::static_pointer_cast<const T>(msg), info);
+    };
+    auto sub_impl = create_subscriber_impl(topic_name, message_type<T>(), std::move(type_erased_callback),
+                                           std::move(callback_group), qos);
+    if (!sub_impl) {
+        return nullptr; // Already logged.
+    }
+    return std::shared_ptr<Subscriber<T>>(new Subscriber<T>(topic_name, std::move(sub_impl)));
+}
+
+template <typename T>
+std::shared_ptr<Subscriber<T>> Node::create_subscriber(
+    const std::string& topic_name,
+    std::function<void(const T&, const MessageInfo&)> callback,
+    std::shared_ptr<core::CallbackGroup> callback_group,
+    const QoS& qos) {
+    // The reference-taking forms are thin adapters over the shared-pointer
+    // form; the reference the user sees points straight into the shared message.
+    return create_subscriber<T>(topic_name, std::function<void(std::shared_ptr<const T>, const MessageInfo&)>(
+        [callback = std::move(callback)](std::shared_ptr<const T> msg, const MessageInfo& info) {
+            callback(*msg, info);
+        }),
+        std::move(callback_group), qos);
+}
+
+template <typename T>
+std::shared_ptr<Subscriber<T>> Node::create_subscriber(
+    const std::string& topic_name,
+    std::function<void(std::shared_ptr<const T>)> callback,
+    std::shared_ptr<core::CallbackGroup> callback_group,
+    const QoS& qos) {
+    return create_subscriber<T>(topic_name, std::function<void(std::shared_ptr<const T>, const MessageInfo&)>(
+        [callback = std::move(callback)](std::shared_ptr<const T> msg, const MessageInfo&) {
+            callback(std::move(msg));
+        }),
+        std::move(callback_group), qos);
+}
+
+template <typename T>
+std::shared_ptr<Subscriber<T>> Node::create_subscriber(
+    const std::string& topic_name,
+    std::function<void(const T&)> callback,
+    std::shared_ptr<core::CallbackGroup> callback_group,
+    const QoS& qos) {
+    return create_subscriber<T>(topic_name, std::function<void(std::shared_ptr<const T>, const MessageInfo&)>(
+        [callback = std::move(callback)](std::shared_ptr<const T> msg, const MessageInfo&) { callback(*msg); }),
+        std::move(callback_group), qos);
+}
+
 } // namespace msg
 } // namespace ignlink
\ No newline at end of file
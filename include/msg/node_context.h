@@ -1,13 +1,19 @@
 #pragma once
 
 #include <ignlink/core/status.h>
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/executor.h>
+#include <ignlink/core/rcu.h>
+#include <ignlink/msg/message_info.h>
 #include <ignlink/msg/publisher.h>   // For declaration
 #include <ignlink/msg/subscriber.h>  // For declaration
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <atomic>
@@ -19,6 +25,42 @@ namespace msg {
 class PublisherImpl;
 class SubscriberImpl;
 
+/**
+ * @brief A dense integer identifying an interned topic within one NodeContext.
+ */
+using TopicId = uint32_t;
+
+/**
+ * @struct SubscriberList
+ * @brief (Internal) An immutable snapshot of a topic's subscribers.
+ *
+ * Publishers read it without locking; registration replaces it wholesale.
+ */
+struct SubscriberList {
+    std::vector<std::shared_ptr<SubscriberImpl>> subscribers;
+};
+
+/**
+ * @struct Topic
+ * @brief (Internal) An interned topic.
+ *
+ * Topics are created on first use and live as long as the context, so the
+ * publishers can keep a plain pointer to theirs and never look a name up again.
+ */
+struct Topic {
+    TopicId id = 0;
+    std::string name;
+
+    // The one field publishers read. Points to an immutable snapshot that is
+    // only freed after an RCU grace period.
+    std::atomic<const SubscriberList*> subscribers{nullptr};
+
+    // Registration state, guarded by NodeContext::registry_mutex_.
+    uint64_t type_hash = 0;  // Agreed message type; 0 while the topic has no endpoints
+    std::string type_name;
+    size_t publisher_count = 0;
+};
+
 /**
  * @class NodeContext
  * @brief (Internal) The central engine for the messaging system within a process.
@@ -27,10 +69,44 @@ class SubscriberImpl;
  * message dispatching, maintains registries of all publishers and subscribers,
  * and interfaces with the underlying transport layer (e.g., shared memory).
  * There is typically only one NodeContext per process.
+ *
+ * Dispatch is event-driven: the spin thread blocks on an eventfd and is woken
+ * by `publish()` only when it is actually asleep, so an idle bus costs no CPU
+ * and a busy bus costs no syscalls. The spin thread only routes messages; the
+ * callbacks themselves run on a multi-threaded core::Executor, where each
+ * subscriber's callback group decides what may run in parallel. The latency target for intra-process
+ * publish-to-callback on an otherwise idle core is p50 < 20 us and
+ * p99 < 100 us.
+ *
+ * The publish path never touches a string or a global lock. Topic names are
+ * interned into Topic objects when an endpoint is registered; a publish reads
+ * the topic's subscriber snapshot inside an RCU read section and offers the
+ * message to each subscriber's own bounded queue (see QoS). A subscriber
+ * whose queue was idle is put on one of several ready-queue shards, chosen by
+ * topic, for the spin thread to schedule a dispatch of it on the executor.
+ * Only registration and unregistration lock the registry, copy the affected
+ * subscriber list and wait out a grace period. Messages on one topic are
+ * dispatched in publication order; there is no ordering across topics.
+ *
+ * Alternatively the context runs on event loops the application owns and
+ * starts no thread at all: the eventfd is a descriptor on the first loop,
+ * and each subscriber's callbacks run on one of the loops, chosen by its
+ * callback group, so a group's callbacks never overlap.
  */
 class NodeContext {
 public:
-    NodeContext();
+    /**
+     * @brief Creates the context and starts its dispatch machinery.
+     * @param num_threads The number of executor threads running subscriber
+     *                    callbacks. Zero means one per hardware thread.
+     */
+    explicit NodeContext(size_t num_threads = 0);
+
+    /**
+     * @brief Creates a context that schedules and runs callbacks on `loops` instead of threads of its own.
+     * @param loops At least one; they must be running (or be run) for anything to be delivered.
+     */
+    explicit NodeContext(std::vector<std::shared_ptr<core::EventLoop>> loops);
     ~NodeContext();
 
     // Prevent copying
@@ -38,7 +114,7 @@ public:
     NodeContext& operator=(const NodeContext&) = delete;
 
     /**
-     * @brief Registers a new publisher with the context.
+     * @brief Registers a new publisher with the context and binds it to its interned topic.
      * @param impl The publisher implementation to register.
      * @return Status indicating success or failure.
      */
@@ -50,26 +126,140 @@ public:
      * @return Status indicating success or failure.
      */
     core::Status register_subscriber(std::shared_ptr<SubscriberImpl> impl);
-    
-    // ... (methods for unregistering would also be here)
+
+    /**
+     * @brief Removes a publisher. Its topic keeps its ID.
+     */
+    void unregister_publisher(PublisherImpl* impl);
+
+    /**
+     * @brief Removes a subscriber. No delivery to it is queued once this returns.
+     */
+    void unregister_subscriber(SubscriberImpl* impl);
+
+    /**
+     * @brief Queues a message for delivery to every subscriber of a topic.
+     *
+     * This is the intra-process path: the message is never copied or serialized.
+     * Each subscriber is handed the same immutable pointer, so the cost of a
+     * publish is independent of the message size and only grows by one
+     * reference count per subscriber.
+     *
+     * @param topic The interned topic, as bound to the publisher at registration.
+     * @param msg The type-erased, immutable message.
+     * @param info The publisher's metadata for the message (ID, sequence, publish time).
+     * @param max_blocking_time How long the publisher may wait in total for room
+     *                          in full KeepAll subscriber queues. Zero never waits.
+     * @return Status indicating success, or Timeout if the message had to be
+     *         dropped for a KeepAll subscriber after waiting.
+     */
+    core::Status publish(const Topic& topic, std::shared_ptr<const void> msg, const MessageInfo& info,
+                         std::chrono::nanoseconds max_blocking_time);
 
 private:
+    /**
+     * @struct PendingShard
+     * @brief One of the queues of subscribers that need a dispatch scheduled.
+     *
+     * Publishers fill it and the spin thread drains it. Topics are spread over
+     * the shards by ID, so publishers on different topics rarely share a lock.
+     */
+    struct alignas(64) PendingShard {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<SubscriberImpl>> ready;
+    };
+
+    static constexpr size_t kPendingShards = 16;
+
+    /**
+     * @brief Finds or creates the interned topic for a name.
+     * @note Must be called with `registry_mutex_` held.
+     */
+    Topic* find_or_create_topic(const std::string& topic_name);
+
+    /**
+     * @brief Checks that a new endpoint agrees on the message type already used on a topic.
+     * @note Must be called with `registry_mutex_` held.
+     */
+    core::Status check_topic_type(const Topic& topic, uint64_t type_hash, const std::string& type_name) const;
+
+    /**
+     * @brief Installs a new subscriber snapshot and frees the old one after a grace period.
+     * @note Must be called with `registry_mutex_` held.
+     */
+    void replace_subscribers(Topic& topic, std::unique_ptr<SubscriberList> list);
+
+    /**
+     * @brief Forgets the topic's type once it has no endpoints left.
+     * @note Must be called with `registry_mutex_` held.
+     */
+    void release_type_if_unused(Topic& topic);
+
     /**
      * @brief The main loop for the background thread.
      *
-     * This function runs continuously, polling the transport layer for new
-     * messages and dispatching them to the appropriate subscriber callbacks.
+     * This function drains the delivery queues, dispatches each message to its
+     * subscriber callback and then sleeps on `wakeup_fd_` until the next
+     * publish (or shutdown) signals it.
      */
     void spin();
 
-    std::mutex pub_sub_mutex_; // Mutex to protect access to the registries
+    /**
+     * @brief Hands every pending subscriber to `post_dispatch()`. Returns false if none was pending.
+     */
+    bool schedule_pending();
+
+    /**
+     * @brief The wakeup descriptor's handler when the context runs on event loops.
+     */
+    void on_wakeup();
+
+    /**
+     * @brief Schedules a subscriber's dispatch on the executor, in its callback group, or on its event loop.
+     */
+    void post_dispatch(std::shared_ptr<SubscriberImpl> subscriber);
+
+    /**
+     * @brief Runs one batch of a subscriber's queue on `loop`, and posts itself again while more is queued.
+     */
+    static void dispatch_on(core::EventLoop* loop, std::shared_ptr<SubscriberImpl> subscriber);
+
+    /**
+     * @brief Checks every pending shard for subscribers waiting to be scheduled.
+     */
+    bool has_pending();
+
+    /**
+     * @brief Wakes the spin thread if, and only if, it is blocked waiting for work.
+     */
+    void notify();
+
+    /**
+     * @brief Unconditionally signals the eventfd (used for shutdown).
+     */
+    void signal_wakeup();
+
+    std::mutex registry_mutex_; // Serializes registration; never taken by publish()
+
+    // Interned topics. The Topic objects never move or die before the context.
+    std::unordered_map<std::string, std::unique_ptr<Topic>> topics_;
+    std::vector<Topic*> topics_by_id_;
+
+    core::RcuDomain rcu_; // Protects readers of Topic::subscribers
+
+    PendingShard pending_[kPendingShards]; // Subscribers waiting to be scheduled by the spin thread
+    std::deque<std::shared_ptr<SubscriberImpl>> scheduling_batch_; // Only touched by schedule_pending()
+
+    int wakeup_fd_;                 // eventfd the spin thread blocks on when idle
+    std::atomic<bool> sleeping_;    // True while the spin thread is (about to be) blocked
+    std::atomic<bool> running_;     // Atomic flag to control the spin thread
+    std::thread spin_thread_;       // The background thread for message dispatching; none on event loops
 
-    // Registries for all publishers and subscribers in this process
-    std::map<std::string, std::vector<std::shared_ptr<PublisherImpl>>> publishers_;
-    std::map<std::string, std::vector<std::shared_ptr<SubscriberImpl>>> subscribers_;
+    std::vector<std::shared_ptr<core::EventLoop>> loops_; // Empty unless the context runs on event loops
 
-    std::atomic<bool> running_; // Atomic flag to control the spin thread
-    std::thread spin_thread_;   // The background thread for message dispatching
+    // Declared last so it is destroyed first: queued callbacks finish while
+    // the rest of the context is still intact. Null on event loops.
+    std::unique_ptr<core::Executor> executor_;
 };
 
 } // namespace msg
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <ignlink/core/status.h>
+#include <ignlink/msg/loaned.h>
+
 #include <string>
 #include <memory>
+#include <mutex>
 
 namespace ignlink {
 namespace msg {
@@ -9,6 +13,23 @@ namespace msg {
 // Forward declare the implementation details.
 class PublisherImpl;
 
+namespace detail {
+/**
+ * @brief (Internal) Hands a type-erased message to a publisher's implementation.
+ *
+ * A plain function, so that the header-only Publisher<T> never needs the
+ * definition of PublisherImpl.
+ *
+ * @return The status of PublisherImpl::publish().
+ */
+core::Status publish_erased(PublisherImpl& impl, std::shared_ptr<const void> msg);
+
+/**
+ * @brief (Internal) Removes a publisher from its context.
+ */
+void unregister_publisher(PublisherImpl& impl);
+} // namespace detail
+
 /**
  * @class Publisher
  * @brief A handle for publishing messages of a specific type to a topic.
@@ -25,14 +46,60 @@ public:
     /**
      * @brief Publishes a message to the topic.
      *
-     * This method sends a copy of the message to all subscribers listening on this
-     * publisher's topic. The actual sending mechanism (e.g., shared memory) is
-     * handled by the underlying transport layer.
+     * Every publish overload returns the same status: Ok once the message is
+     * queued for every subscriber, or Timeout if this is a KeepAll publisher
+     * and a KeepAll subscriber's queue stayed full for `max_blocking_time`, in
+     * which case that subscriber misses the message (see QoS).
+     *
+     * @param msg The message to be published. It is copied exactly once into an
+     *            immutable shared message; all in-process subscribers then share
+     *            that single copy.
+     * @return Status indicating success or failure.
+     */
+    core::Status publish(const T& msg);
+
+    /**
+     * @brief Publishes a message by transferring ownership of it to the bus.
+     *
+     * This is the zero-copy path: the message is moved into an immutable
+     * `std::shared_ptr<const T>` that every in-process subscriber shares, no
+     * matter how many there are. Prefer this for large payloads such as camera
+     * frames and point clouds.
+     *
+     * @param msg The message to be published. Null is an InvalidArgument.
+     * @return Status indicating success or failure.
+     */
+    core::Status publish(std::unique_ptr<T> msg);
+
+    /**
+     * @brief Publishes a message that is already held in a shared, immutable pointer.
+     *
+     * No copy is made; subscribers receive the same pointer. The caller must not
+     * modify the message afterwards (it is `const` for exactly that reason).
+     *
+     * @param msg The message to be published. Null is an InvalidArgument.
+     * @return Status indicating success or failure.
+     */
+    core::Status publish(std::shared_ptr<const T> msg);
+
+    /**
+     * @brief Borrows a preallocated message to be filled in place.
+     *
+     * Together with `publish(Loaned<T>&&)` this lets a producer (e.g. a camera
+     * driver) write its data exactly once, straight into the memory that the
+     * subscribers will read. Once every subscriber has dropped the message it
+     * returns to this publisher's pool for the next loan.
      *
-     * @param msg The message to be published. It is passed by const reference
-     *            for efficiency.
+     * @return A writable message. Its previous contents are unspecified.
      */
-    void publish(const T& msg);
+    Loaned<T> loan();
+
+    /**
+     * @brief Publishes a loaned message in place, without copying it.
+     * @param msg The message obtained from `loan()`. It is left empty.
+     * @return Status indicating success or failure.
+     */
+    core::Status publish(Loaned<T>&& msg);
 
     /**
      * @brief Gets the name of the topic this publisher is associated with.
@@ -40,6 +107,11 @@ public:
      */
     const std::string& get_topic_name() const;
 
+    /**
+     * @brief Unregisters the publisher from its topic.
+     */
+    ~Publisher();
+
 private:
     // This class is not meant to be constructed directly by the user, only by a Node.
     // The `friend` declaration allows the Node class to access our private constructor.
@@ -53,9 +125,69 @@ private:
      */
     Publisher(const std::string& topic_name, std::shared_ptr<PublisherImpl> impl);
 
+    // Messages preallocated per publisher for loan().
+    static constexpr size_t kLoanPoolSize = 8;
+
     std::string topic_name_;
     std::shared_ptr<PublisherImpl> pimpl_;
+
+    std::once_flag loan_pool_once_;           // The pool is only built on the first loan
+    std::unique_ptr<LoanPool<T>> loan_pool_;
 };
 
+template <typename T>
+Publisher<T>::Publisher(const std::string& topic_name, std::shared_ptr<PublisherImpl> impl)
+    : topic_name_(topic_name), pimpl_(std::move(impl)) {}
+
+template <typename T>
+Publisher<T>::~Publisher() {
+    if (pimpl_) {
+        detail::unregister_publisher(*pimpl_);
+    }
+}
+
+template <typename T>
+core::Status Publisher<T>::publish(const T& msg) {
+    // The one unavoidable copy: the caller keeps ownership of `msg`, so we copy
+    // it once into a shared, immutable message that every subscriber shares.
+    return publish(std::shared_ptr<const T>(std::make_shared<T>(msg)));
+}
+
+template <typename T>
+core::Status Publisher<T>::publish(std::unique_ptr<T> msg) {
+    // Ownership moves to the bus; the payload itself is never touched.
+    return publish(std::shared_ptr<const T>(std::move(msg)));
+}
+
+template <typename T>
+core::Status Publisher<T>::publish(std::shared_ptr<const T> msg) {
+    if (!pimpl_) {
+        return core::Status(core::Status::Code::Unavailable, "Publisher is not registered.");
+    }
+    if (!msg) {
+        return core::Status(core::Status::Code::InvalidArgument, "Cannot publish a null message.");
+    }
+    // Type erasure is a pointer conversion; the message is shared, not copied.
+    return detail::publish_erased(*pimpl_, std::move(msg));
+}
+
+template <typename T>
+Loaned<T> Publisher<T>::loan() {
+    std::call_once(loan_pool_once_, [this] { loan_pool_ = std::make_unique<LoanPool<T>>(kLoanPoolSize); });
+    return loan_pool_->loan();
+}
+
+template <typename T>
+core::Status Publisher<T>::publish(Loaned<T>&& msg) {
+    // The loan becomes the shared message itself; it finds its way back to the
+    // pool once the last subscriber lets go of it.
+    return publish(std::move(msg).share());
+}
+
+template <typename T>
+const std::string& Publisher<T>::get_topic_name() const {
+    return topic_name_;
+}
+
 } // namespace msg
 } // namespace ignlink
\ No newline at end of file
@@ -2,44 +2,82 @@
 
 #include <ignlink/core/status.h>
 #include <ignlink/core/types.h> // For Tensor, etc.
+#include <ignlink/msg/message_traits.h>
+#include <ignlink/msg/qos.h>
+
+#include <atomic>
+#include <cstdint>
 
 #include <string>
 #include <memory>
-#include <any>
 
 namespace ignlink {
 namespace msg {
 
 // Forward declare to avoid circular includes
 class NodeContext;
+struct Topic;
 
 /**
  * @class PublisherImpl
  * @brief (Internal) The concrete implementation of a publisher.
  *
- * This class holds the state for a publisher and contains the logic to serialize
- * a message and hand it off to the transport layer via the NodeContext.
+ * This class holds the state for a publisher and contains the logic to hand a
+ * message off to the NodeContext. Messages travel through the context as
+ * type-erased `std::shared_ptr<const void>`, so in-process delivery never copies
+ * the payload; the typed Publisher<T> handle is responsible for the type.
+ *
+ * Registration binds the publisher to its interned Topic, so publishing never
+ * looks the topic name up again.
  */
 class PublisherImpl {
 public:
     PublisherImpl(const std::string& topic_name,
-                  const std::string& type_name,
-                  std::weak_ptr<NodeContext> context);
+                  const MessageType& type,
+                  const QoS& qos,
+                  std::shared_ptr<NodeContext> context);
 
     /**
      * @brief The core publish method called by the public Publisher handle.
-     * @param msg The message to publish, passed as a std::any to be type-erased.
+     * @param msg The message to publish. It must point to an object of the type
+     *            identified by `get_type_hash()`; ownership is shared with subscribers.
      * @return Status indicating success or failure.
      */
-    core::Status publish(const std::any& msg);
+    core::Status publish(std::shared_ptr<const void> msg);
 
     const std::string& get_topic_name() const { return topic_name_; }
-    const std::string& get_type_name() const { return type_name_; }
+    const std::string& get_type_name() const { return type_.name; }
+    uint64_t get_type_hash() const { return type_.hash; }
+    const QoS& get_qos() const { return qos_; }
+    Topic* get_topic() const { return topic_; }
+
+    /**
+     * @brief Gets the ID that identifies this publisher in MessageInfo. Unique within the process.
+     */
+    uint64_t get_id() const { return id_; }
+
+    /**
+     * @brief Binds the publisher to its interned topic. Called by the NodeContext at registration.
+     */
+    void bind(Topic* topic) { topic_ = topic; }
+
+    /**
+     * @brief Removes the publisher from the context. Called when the public handle goes away.
+     */
+    void unregister();
 
 private:
     std::string topic_name_;
-    std::string type_name_;
-    std::weak_ptr<NodeContext> context_; // Use a weak_ptr to avoid circular ownership
+    MessageType type_;
+    QoS qos_;
+    Topic* topic_ = nullptr; // Owned by the context, which outlives us
+    const uint64_t id_;
+    std::atomic<uint64_t> sequence_{0}; // Last sequence number handed out
+
+    // A strong reference: the context holds none back to its publishers, so
+    // there is no cycle, and publishing skips the weak_ptr lock (an atomic
+    // on a counter that every publisher in the process would share).
+    std::shared_ptr<NodeContext> context_;
 };
 
 } // namespace msg
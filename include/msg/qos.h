@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace ignlink {
+namespace msg {
+
+/**
+ * @struct QoS
+ * @brief Quality-of-service settings for a publisher or subscriber.
+ *
+ * Every subscriber owns a queue of `depth` preallocated slots between the
+ * publishers and its callback, so a slow subscriber only ever affects itself:
+ *
+ * - KeepLast: when the queue is full, a message is dropped according to
+ *   `drop_policy` (the oldest queued one, or the one arriving). Publishers
+ *   never wait. This is the default, and right for sensor data and anything
+ *   where the latest value matters most.
+ * - KeepAll: no message is dropped while the subscriber keeps up within
+ *   `max_blocking_time`. When its queue is full, a KeepAll publisher blocks
+ *   until there is room (backpressure); after `max_blocking_time` it gives
+ *   up and the message is dropped for that subscriber. A KeepLast publisher
+ *   never blocks, not even for a KeepAll subscriber: its message is dropped
+ *   instead. So reliable delivery takes KeepAll on both ends, and a control
+ *   loop publishing KeepLast cannot be stalled by a KeepAll logger.
+ *
+ * Drops are counted per subscriber (Subscriber::dropped_messages()), and
+ * show up as gaps in MessageInfo::sequence.
+ *
+ * On a publisher only `history` and `max_blocking_time` matter.
+ *
+ * @example
+ *   auto cmd_pub = node.create_publisher<Command>("/cmd", QoS::keep_all(64));
+ *   auto log_sub = node.create_subscriber<Command>("/cmd", log_command, nullptr, QoS::keep_all(1024));
+ *   auto ui_sub = node.create_subscriber<Image>("/camera", show, nullptr, QoS::keep_last(1));
+ */
+struct QoS {
+    enum class History {
+        KeepLast, // Bounded queue, drops when full
+        KeepAll   // Bounded queue, publishers wait when full
+    };
+
+    enum class DropPolicy {
+        DropOldest, // Make room by discarding the oldest queued message
+        DropNewest  // Discard the arriving message
+    };
+
+    History history = History::KeepLast;
+    size_t depth = 16; // Queue slots per subscriber; at least 1
+    DropPolicy drop_policy = DropPolicy::DropOldest;
+    std::chrono::nanoseconds max_blocking_time = std::chrono::milliseconds(100);
+
+    static QoS keep_last(size_t depth, DropPolicy policy = DropPolicy::DropOldest) {
+        QoS qos;
+        qos.depth = depth;
+        qos.drop_policy = policy;
+        return qos;
+    }
+
+    static QoS keep_all(size_t depth, std::chrono::nanoseconds max_blocking_time = std::chrono::milliseconds(100)) {
+        QoS qos;
+        qos.history = History::KeepAll;
+        qos.depth = depth;
+        qos.max_blocking_time = max_blocking_time;
+        return qos;
+    }
+};
+
+} // namespace msg
+} // namespace ignlink
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <memory>
-#include <functional>
 
 namespace ignlink {
 namespace msg {
@@ -10,6 +10,18 @@ namespace msg {
 // Forward declare the implementation details.
 class SubscriberImpl;
 
+namespace detail {
+/**
+ * @brief (Internal) Removes a subscriber from its context.
+ */
+void unregister_subscriber(SubscriberImpl& impl);
+
+/**
+ * @brief (Internal) Reads a subscriber's drop counter.
+ */
+uint64_t subscriber_dropped_messages(const SubscriberImpl& impl);
+} // namespace detail
+
 /**
  * @class Subscriber
  * @brief A handle for receiving messages of a specific type from a topic.
@@ -29,6 +41,24 @@ public:
      */
     const std::string& get_topic_name() const;
 
+    /**
+     * @brief Gets the number of messages dropped because this subscriber's queue was full.
+     *
+     * See QoS for when that happens. A steadily growing count means the
+     * callback cannot keep up with the publishers.
+     */
+    uint64_t dropped_messages() const;
+
+    /**
+     * @brief Unregisters the subscriber. No callback starts after this returns,
+     *        though one that is already running finishes.
+     */
+    ~Subscriber();
+
+    // Prevent copying: the handle owns the registration.
+    Subscriber(const Subscriber&) = delete;
+    Subscriber& operator=(const Subscriber&) = delete;
+
 private:
     // This class is not meant to be constructed directly by the user, only by a Node.
     friend class Node;
@@ -36,17 +66,35 @@ private:
     /**
      * @brief Private constructor.
      * @param topic_name The name of the topic.
-     * @param callback The user's callback function.
-     * @param impl A shared pointer to the underlying implementation object.
+     * @param impl A shared pointer to the underlying implementation object, which
+     *             owns the (type-erased) user callback.
      */
-    Subscriber(const std::string& topic_name,
-               std::function<void(const T&)> callback,
-               std::shared_ptr<SubscriberImpl> impl);
-    
+    Subscriber(const std::string& topic_name, std::shared_ptr<SubscriberImpl> impl);
+
     std::string topic_name_;
-    std::function<void(const T&)> callback_;
     std::shared_ptr<SubscriberImpl> pimpl_;
 };
 
+template <typename T>
+Subscriber<T>::Subscriber(const std::string& topic_name, std::shared_ptr<SubscriberImpl> impl)
+    : topic_name_(topic_name), pimpl_(std::move(impl)) {}
+
+template <typename T>
+Subscriber<T>::~Subscriber() {
+    if (pimpl_) {
+        detail::unregister_subscriber(*pimpl_);
+    }
+}
+
+template <typename T>
+const std::string& Subscriber<T>::get_topic_name() const {
+    return topic_name_;
+}
+
+template <typename T>
+uint64_t Subscriber<T>::dropped_messages() const {
+    return detail::subscriber_dropped_messages(*pimpl_);
+}
+
 } // namespace msg
 } // namespace ignlink
\ No newline at end of file
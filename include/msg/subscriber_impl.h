@@ -1,9 +1,19 @@
 #pragma once
 
+#include <ignlink/core/executor.h>
+#include <ignlink/msg/message_info.h>
+#include <ignlink/msg/message_traits.h>
+#include <ignlink/msg/qos.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <functional>
-#include <any>
+#include <vector>
 
 namespace ignlink {
 namespace msg {
@@ -15,29 +25,114 @@ class NodeContext;
  * @brief (Internal) The concrete implementation of a subscriber.
  *
  * This class holds the state for a subscriber, including its type-erased
- * callback. It is invoked by the NodeContext's spin thread when a new message arrives.
+ * callback and its message queue. Publishers offer messages to the queue;
+ * when it goes from idle to non-empty, the NodeContext's spin thread
+ * schedules a `dispatch()` on the executor, which runs the callback for the
+ * queued messages. Messages are handed over as `std::shared_ptr<const void>`;
+ * the typed callback installed by Node::create_subscriber casts it back
+ * without copying.
+ *
+ * The queue is a ring of `QoS::depth` slots allocated up front, so queueing
+ * never allocates and a stalled subscriber holds at most `depth` messages.
  */
 class SubscriberImpl {
 public:
+    using Callback = std::function<void(const std::shared_ptr<const void>&, const MessageInfo&)>;
+
+    /**
+     * @brief The outcome of offering a message to the queue.
+     */
+    enum class Offer {
+        Queued,       // Queued; a dispatch is already scheduled
+        NeedDispatch, // Queued; the caller must schedule a dispatch
+        Dropped,      // Not queued
+        Full          // KeepAll queue full; the caller may wait with offer_blocking()
+    };
+
     SubscriberImpl(const std::string& topic_name,
-                   const std::string& type_name,
-                   std::function<void(const std::any&)> callback,
+                   const MessageType& type,
+                   Callback callback,
+                   std::shared_ptr<core::CallbackGroup> callback_group,
+                   const QoS& qos,
                    std::weak_ptr<NodeContext> context);
-    
+
+    /**
+     * @brief Queues a message without blocking. Called by publishers.
+     * @param msg The message. It is shared with every other subscriber of the
+     *            topic and must not be modified.
+     * @param info The message's metadata from the publisher.
+     * @param may_block Whether the publisher is willing to wait for room. If
+     *                  not, a full KeepAll queue drops the message.
+     */
+    Offer offer(const std::shared_ptr<const void>& msg, const MessageInfo& info, bool may_block);
+
     /**
-     * @brief The core method to invoke the user's callback with a received message.
-     * @param msg The received message, passed as a type-erased std::any.
+     * @brief Queues a message, waiting until `deadline` for room in a full queue.
+     *
+     * Returns Dropped if there is still no room by then, or if the subscriber
+     * is unregistered meanwhile.
      */
-    void invoke_callback(const std::any& msg);
+    Offer offer_blocking(const std::shared_ptr<const void>& msg, const MessageInfo& info,
+                         std::chrono::steady_clock::time_point deadline);
 
+    /**
+     * @brief Runs the callback for queued messages. Called on the executor.
+     *
+     * Handles a bounded batch, so that one busy subscriber cannot hold on to
+     * an executor thread indefinitely.
+     *
+     * @return True if messages remain and the caller must schedule another dispatch.
+     */
+    bool dispatch();
+
+    /**
+     * @brief Gets the number of messages dropped because the queue was full.
+     */
+    uint64_t dropped_messages() const { return dropped_.load(std::memory_order_relaxed); }
+
+    const QoS& get_qos() const { return qos_; }
     const std::string& get_topic_name() const { return topic_name_; }
-    const std::string& get_type_name() const { return type_name_; }
+    const std::string& get_type_name() const { return type_.name; }
+    uint64_t get_type_hash() const { return type_.hash; }
+    const std::shared_ptr<core::CallbackGroup>& get_callback_group() const { return callback_group_; }
+
+    /**
+     * @brief Removes the subscriber from the context. Called when the public handle goes away.
+     *
+     * Messages that were already queued are dropped rather than delivered;
+     * a callback that is running right now finishes normally. Publishers
+     * waiting for room in the queue give up.
+     */
+    void unregister();
 
 private:
+    struct Slot {
+        std::shared_ptr<const void> msg;
+        MessageInfo info;
+    };
+
+    // Appends to the queue. Must be called with mutex_ held and room in the queue.
+    Offer push_locked(const std::shared_ptr<const void>& msg, const MessageInfo& info);
+
+    void invoke_callback(const std::shared_ptr<const void>& msg, const MessageInfo& info);
+
     std::string topic_name_;
-    std::string type_name_;
-    std::function<void(const std::any&)> callback_; // Type-erased callback
+    MessageType type_;
+    Callback callback_; // Type-erased callback
+    std::shared_ptr<core::CallbackGroup> callback_group_; // Decides what may run alongside callback_
+    QoS qos_;
     std::weak_ptr<NodeContext> context_;
+    std::atomic<bool> active_{true}; // Cleared by unregister()
+
+    std::mutex mutex_;                // Guards the queue and the dispatch count
+    std::condition_variable not_full_; // Signalled when a KeepAll queue gets room
+    std::vector<Slot> slots_;         // Ring of qos_.depth preallocated slots
+    size_t head_ = 0;                 // Oldest queued message
+    size_t size_ = 0;
+    size_t dispatchers_ = 0;          // Dispatches scheduled or running
+    size_t max_dispatchers_ = 1;      // 1 keeps a MutuallyExclusive subscriber in order
+    size_t waiting_publishers_ = 0;
+    std::atomic<uint64_t> dropped_{0};
 };
 
 } // namespace msg
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <ignlink/core/status.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+/**
+ * @struct TopicOptions
+ * @brief Describes a topic to a transport when creating a writer or reader.
+ */
+struct TopicOptions {
+    std::string topic_name;            // e.g. "/camera/image_raw"
+    std::string type_name;             // Human-readable type, for diagnostics
+    uint64_t type_hash = 0;            // Identity of the message type; must match on both ends
+    size_t max_message_size = 64 * 1024; // Largest serialized message the topic will carry
+    size_t depth = 16;                 // Messages buffered before the oldest is overwritten
+};
+
+/**
+ * @class TransportWriter
+ * @brief (Abstract) The sending end of one topic on one transport.
+ *
+ * A writer never blocks on its readers: when a reader falls behind, it is the
+ * reader that loses messages (and notices), not the writer that waits.
+ */
+class TransportWriter {
+public:
+    virtual ~TransportWriter() = default;
+
+    /**
+     * @brief Sends one serialized message.
+     * @param data Pointer to the message bytes.
+     * @param size Number of bytes; must not exceed the topic's max_message_size.
+     * @return Status indicating success or failure.
+     */
+    virtual core::Status write(const void* data, size_t size) = 0;
+
+    /**
+     * @brief Tells whether `loan()` is implemented at all, so callers can pick
+     *        their path once instead of probing on every message.
+     */
+    virtual bool supports_loans() const { return false; }
+
+    /**
+     * @brief Borrows the transport's own memory for the next message.
+     *
+     * This is the zero-copy path: the producer builds the message directly in
+     * the buffer the readers will see, then calls `commit()`. Only one loan may
+     * be outstanding per writer, and `write()` is unavailable while it is.
+     *
+     * @param size The maximum number of bytes that will be written.
+     * @param buffer Receives a pointer to at least `size` writable bytes.
+     * @return Status indicating success or failure. Transports that cannot
+     *         lend memory return Unavailable; callers then fall back to `write()`.
+     */
+    virtual core::Status loan(size_t size, void** buffer) {
+        (void)size;
+        (void)buffer;
+        return core::Status(core::Status::Code::Unavailable, "This transport does not support loans.");
+    }
+
+    /**
+     * @brief Publishes the message built in the buffer returned by `loan()`.
+     * @param size The number of bytes actually written.
+     */
+    virtual core::Status commit(size_t size) {
+        (void)size;
+        return core::Status(core::Status::Code::Unavailable, "This transport does not support loans.");
+    }
+
+    /**
+     * @brief Abandons an outstanding loan without publishing anything.
+     */
+    virtual void discard() {}
+};
+
+/**
+ * @class TransportReader
+ * @brief (Abstract) The receiving end of one topic on one transport.
+ *
+ * Readers are polled rather than pushing from a thread of their own, so the
+ * caller decides which thread (or event loop) does the receiving.
+ */
+class TransportReader {
+public:
+    /**
+     * @brief Receives one message. The bytes are only valid during the call.
+     */
+    using MessageCallback = std::function<void(const void* data, size_t size)>;
+
+    /**
+     * @brief Receives one message as a shared, read-only buffer that may be kept.
+     *
+     * Transports that support it (IPC) point straight into their own memory
+     * and hold that memory back from the writer until the last copy of the
+     * pointer is dropped, so views should be released promptly.
+     */
+    using SharedMessageCallback = std::function<void(std::shared_ptr<const void> data, size_t size)>;
+
+    virtual ~TransportReader() = default;
+
+    /**
+     * @brief Delivers every message that is available right now, without blocking.
+     * @param callback Invoked once per message, in publication order.
+     * @return The number of messages delivered.
+     */
+    virtual size_t poll(const MessageCallback& callback) = 0;
+
+    /**
+     * @brief Like `poll()`, but hands out buffers that outlive the callback.
+     *
+     * The default implementation copies each message into a new buffer;
+     * transports that can lend out their own memory override it.
+     */
+    virtual size_t poll_shared(const SharedMessageCallback& callback) {
+        return poll([&callback](const void* data, size_t size) {
+            std::shared_ptr<uint8_t> copy(new uint8_t[size], std::default_delete<uint8_t[]>());
+            std::memcpy(copy.get(), data, size);
+            callback(std::move(copy), size);
+        });
+    }
+
+    /**
+     * @brief Blocks until a message may be available or the timeout expires.
+     * @return True if poll() is likely to deliver something.
+     */
+    virtual bool wait(std::chrono::nanoseconds timeout) = 0;
+
+    /**
+     * @brief Gets the number of messages this reader missed, e.g. because it
+     *        fell behind the writer or packets were dropped.
+     */
+    virtual uint64_t lost_messages() const = 0;
+};
+
+/**
+ * @class BaseTransport
+ * @brief (Abstract) A way of moving serialized messages between processes.
+ *
+ * This is the extension point for the messaging system: shared memory between
+ * processes on one device (IpcTransport), UDP multicast between devices, and
+ * so on. A transport only moves bytes; typing and serialization happen above it.
+ */
+class BaseTransport {
+public:
+    virtual ~BaseTransport() = default;
+
+    /**
+     * @brief Gets a short identifier for the transport, e.g. "ipc".
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * @brief Creates the sending end of a topic.
+     * @param options The topic description.
+     * @param writer Receives the new writer on success.
+     * @return Status indicating success or failure. A type mismatch with an
+     *         existing endpoint is reported as InvalidArgument.
+     */
+    virtual core::Status create_writer(const TopicOptions& options,
+                                       std::unique_ptr<TransportWriter>* writer) = 0;
+
+    /**
+     * @brief Creates a receiving end of a topic.
+     * @param options The topic description.
+     * @param reader Receives the new reader on success.
+     * @return Status indicating success or failure. A type mismatch with an
+     *         existing endpoint is reported as InvalidArgument.
+     */
+    virtual core::Status create_reader(const TopicOptions& options,
+                                       std::unique_ptr<TransportReader>* reader) = 0;
+};
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <ignlink/msg/transport/base_transport.h>
+
+#include <string>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+/**
+ * @class IpcTransport
+ * @brief Shared-memory transport between processes on the same device.
+ *
+ * Each topic lives in its own POSIX shared-memory segment holding a ring of
+ * fixed-size slots. There is a single writer per topic and any number of
+ * readers. Every slot carries a sequence number that the writer bumps before
+ * and after filling it (a seqlock), so readers never block the writer: a
+ * reader that falls a whole ring behind, or that catches a slot while it is
+ * being rewritten, detects the overrun, counts the lost messages and skips
+ * ahead.
+ *
+ * Waiting readers spin briefly on the ring's write sequence and only then
+ * sleep on a futex in the shared segment. The writer only makes the wake-up
+ * syscall when some reader is actually asleep.
+ *
+ * Zero-copy: a writer can `loan()` the next slot and build its message there,
+ * and `poll_shared()` hands readers views that point straight into the slots.
+ * A view pins its slot; the writer refuses (with Unavailable, never by
+ * blocking) to reuse a pinned slot until the view is released. Each reader
+ * can pin a handful of slots at once and falls back to copying beyond that.
+ *
+ * Crash tolerance:
+ * - A writer that dies mid-write leaves one slot marked "being written" and
+ *   never advances the write sequence past it, so readers simply never see
+ *   it. A new writer for the topic takes over once the old writer's PID is
+ *   gone.
+ * - A reader registers its PID, its pins and whether it is asleep in a table
+ *   in the segment. Pins held by a dead reader are cleared by the writer the
+ *   next time they get in its way. A reader that dies asleep costs one
+ *   wake-up syscall: the first wake-up that finds nobody to wake takes dead
+ *   readers out of the sleeper count. Readers beyond the table's 64 entries
+ *   are never counted: they nap on the futex and look again every
+ *   millisecond.
+ */
+class IpcTransport : public BaseTransport {
+public:
+    /**
+     * @brief Creates the transport.
+     * @param domain A prefix for the shared-memory segment names. Processes only
+     *               see each other's topics when they use the same domain.
+     */
+    explicit IpcTransport(const std::string& domain = "ignlink");
+
+    const char* name() const override { return "ipc"; }
+
+    core::Status create_writer(const TopicOptions& options,
+                               std::unique_ptr<TransportWriter>* writer) override;
+
+    core::Status create_reader(const TopicOptions& options,
+                               std::unique_ptr<TransportReader>* reader) override;
+
+    /**
+     * @brief Gets the shared-memory object name used for a topic (e.g. "/ignlink.camera.image_raw").
+     */
+    std::string segment_name(const std::string& topic_name) const;
+
+    /**
+     * @brief Removes a topic's shared-memory segment.
+     *
+     * Segments deliberately outlive the processes that use them, so that a
+     * restarted node can pick up where it left off. Use this to clean up,
+     * e.g. after changing a topic's message size. Processes that still have the
+     * segment mapped keep working on their (now anonymous) copy.
+     */
+    core::Status unlink(const std::string& topic_name) const;
+
+private:
+    std::string domain_;
+};
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
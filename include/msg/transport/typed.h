@@ -0,0 +1,249 @@
+#pragma once
+
+#include <ignlink/msg/message_traits.h>
+#include <ignlink/msg/transport/base_transport.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+/**
+ * @brief Fills in the type fields of topic options from MessageTraits<T>.
+ *
+ * The transports compare `type_hash` when an endpoint attaches to a topic, so
+ * two processes that disagree on the message type are rejected right there,
+ * with InvalidArgument, rather than misreading each other's bytes.
+ */
+template <typename T>
+TopicOptions typed_topic_options(TopicOptions options) {
+    options.type_name = MessageTraits<T>::type_name();
+    options.type_hash = MessageTraits<T>::type_hash;
+    return options;
+}
+
+/**
+ * @class TypedWriter
+ * @brief The sending end of a topic for messages of type T, serialized with MessageTraits<T>.
+ *
+ * Where the transport can lend out its memory (IPC), messages are serialized
+ * straight into it; otherwise into a scratch buffer that is reused between
+ * messages. Trivially copyable messages are sent as-is, without serializing.
+ *
+ * @tparam T The message type.
+ */
+template <typename T>
+class TypedWriter {
+public:
+    /**
+     * @brief Creates the writer on a transport.
+     * @param transport The transport to write to.
+     * @param options The topic description; its type fields are filled in from T.
+     * @param writer Receives the new writer on success.
+     * @return Status indicating success or failure.
+     */
+    static core::Status create(BaseTransport& transport, const TopicOptions& options,
+                               std::unique_ptr<TypedWriter>* writer) {
+        std::unique_ptr<TransportWriter> raw;
+        core::Status status = transport.create_writer(typed_topic_options<T>(options), &raw);
+        if (status.ok()) {
+            writer->reset(new TypedWriter(std::move(raw)));
+        }
+        return status;
+    }
+
+    /**
+     * @brief Serializes and sends one message.
+     */
+    core::Status write(const T& msg) {
+        if constexpr (MessageTraits<T>::is_trivial) {
+            return writer_->write(&msg, sizeof(T));
+        } else {
+            const size_t size = MessageTraits<T>::serialized_size(msg);
+            if (writer_->supports_loans()) {
+                void* buffer = nullptr;
+                core::Status status = writer_->loan(size, &buffer);
+                if (!status.ok()) {
+                    return status;
+                }
+                return writer_->commit(MessageTraits<T>::serialize(msg, buffer));
+            }
+            scratch_.resize(size);
+            MessageTraits<T>::serialize(msg, scratch_.data());
+            return writer_->write(scratch_.data(), size);
+        }
+    }
+
+    /**
+     * @brief Lends out a tensor whose storage is the transport's own memory.
+     *
+     * On the IPC transport this is the zero-copy path for tensors: the producer
+     * fills the returned view and calls `commit()`, and readers receive views of
+     * the very same shared-memory bytes. Only available for T = core::Tensor.
+     * The view must not be touched after `commit()`: the slot then belongs to
+     * the readers, and later to the next message.
+     *
+     * @return Unavailable if the transport cannot lend memory; use `write()` then.
+     */
+    template <typename U = T, typename = std::enable_if_t<std::is_same_v<U, core::Tensor>>>
+    core::Status loan(core::DType dtype, const int64_t* shape, size_t rank, core::Tensor* tensor) {
+        if (!writer_->supports_loans()) {
+            return core::Status(core::Status::Code::Unavailable, "This transport does not support loans.");
+        }
+        if (rank > core::Tensor::kMaxRank) {
+            return core::Status(core::Status::Code::InvalidArgument, "Tensor rank exceeds the maximum.");
+        }
+        size_t bytes = core::dtype_size(dtype);
+        for (size_t i = 0; i < rank; ++i) {
+            bytes *= static_cast<size_t>(shape[i]);
+        }
+        void* buffer = nullptr;
+        core::Status status = writer_->loan(detail::tensor_header_size(rank) + bytes, &buffer);
+        if (!status.ok()) {
+            return status;
+        }
+        loan_ = static_cast<uint8_t*>(buffer);
+        *tensor = core::Tensor::wrap(loan_ + detail::tensor_header_size(rank), dtype, shape, rank, nullptr);
+        return core::Status::OK();
+    }
+
+    /**
+     * @brief Publishes the tensor obtained from `loan()`.
+     *
+     * Only its header (shape, timestamp) is written here; the elements are
+     * already in place.
+     */
+    template <typename U = T, typename = std::enable_if_t<std::is_same_v<U, core::Tensor>>>
+    core::Status commit(const core::Tensor& tensor) {
+        if (!loan_ || tensor.data() != loan_ + detail::tensor_header_size(tensor.rank())) {
+            return core::Status(core::Status::Code::InvalidArgument, "The tensor was not loaned from this writer.");
+        }
+        const size_t header_size = detail::tensor_header_size(tensor.rank());
+        std::memset(loan_, 0, header_size);
+        loan_[0] = static_cast<uint8_t>(tensor.dtype());
+        loan_[1] = static_cast<uint8_t>(tensor.rank());
+        std::memcpy(loan_ + 8, &tensor.timestamp, sizeof(int64_t));
+        std::memcpy(loan_ + 16, tensor.shape(), tensor.rank() * sizeof(int64_t));
+        loan_ = nullptr;
+        return writer_->commit(header_size + tensor.nbytes());
+    }
+
+    /**
+     * @brief Gets the untyped writer underneath, e.g. to send pre-serialized bytes.
+     */
+    TransportWriter& raw() { return *writer_; }
+
+private:
+    explicit TypedWriter(std::unique_ptr<TransportWriter> writer) : writer_(std::move(writer)) {}
+
+    std::unique_ptr<TransportWriter> writer_;
+    std::vector<uint8_t> scratch_; // Serialization buffer for transports without loans
+    uint8_t* loan_ = nullptr;      // Outstanding tensor loan, if any
+};
+
+/**
+ * @class TypedReader
+ * @brief The receiving end of a topic for messages of type T.
+ *
+ * Malformed messages (wrong size, truncated) are skipped and counted; they can
+ * only come from a peer that bypassed the type check.
+ *
+ * @tparam T The message type. It must be default-constructible.
+ */
+template <typename T>
+class TypedReader {
+public:
+    /**
+     * @brief Creates the reader on a transport.
+     * @param transport The transport to read from.
+     * @param options The topic description; its type fields are filled in from T.
+     * @param reader Receives the new reader on success.
+     * @return Status indicating success or failure.
+     */
+    static core::Status create(BaseTransport& transport, const TopicOptions& options,
+                               std::unique_ptr<TypedReader>* reader) {
+        std::unique_ptr<TransportReader> raw;
+        core::Status status = transport.create_reader(typed_topic_options<T>(options), &raw);
+        if (status.ok()) {
+            reader->reset(new TypedReader(std::move(raw)));
+        }
+        return status;
+    }
+
+    /**
+     * @brief Delivers every available message, decoded into one reused object.
+     *
+     * The reference is only valid during the callback. Reusing the object keeps
+     * the capacity of its strings and vectors, so steady-state decoding does
+     * not allocate.
+     */
+    size_t poll(const std::function<void(const T&)>& callback) {
+        return reader_->poll([this, &callback](const void* data, size_t size) {
+            if (MessageTraits<T>::deserialize(data, size, &scratch_) &&
+                (!MessageTraits<T>::is_trivial || size == sizeof(T))) {
+                callback(scratch_);
+            } else {
+                ++malformed_;
+            }
+        });
+    }
+
+    /**
+     * @brief Delivers every available message as a shared pointer that may be kept.
+     *
+     * Tensors become views into the transport's buffer rather than copies, and
+     * a trivially copyable message is the buffer itself. On IPC that buffer is
+     * shared memory held back from the writer, so drop the pointers promptly.
+     */
+    size_t poll_shared(const std::function<void(std::shared_ptr<const T>)>& callback) {
+        return reader_->poll_shared([this, &callback](std::shared_ptr<const void> data, size_t size) {
+            if constexpr (MessageTraits<T>::is_trivial) {
+                if (size == sizeof(T) && reinterpret_cast<uintptr_t>(data.get()) % alignof(T) == 0) {
+                    // Share ownership with the buffer, point at its bytes.
+                    const auto* msg = static_cast<const T*>(data.get());
+                    callback(std::shared_ptr<const T>(std::move(data), msg));
+                    return;
+                }
+            }
+            auto msg = std::make_shared<T>();
+            if (MessageTraits<T>::deserialize_shared(data, size, msg.get()) &&
+                (!MessageTraits<T>::is_trivial || size == sizeof(T))) {
+                callback(std::move(msg));
+            } else {
+                ++malformed_;
+            }
+        });
+    }
+
+    bool wait(std::chrono::nanoseconds timeout) { return reader_->wait(timeout); }
+
+    uint64_t lost_messages() const { return reader_->lost_messages(); }
+
+    /**
+     * @brief Gets the number of messages that could not be decoded.
+     */
+    uint64_t malformed_messages() const { return malformed_; }
+
+    /**
+     * @brief Gets the untyped reader underneath.
+     */
+    TransportReader& raw() { return *reader_; }
+
+private:
+    explicit TypedReader(std::unique_ptr<TransportReader> reader) : reader_(std::move(reader)) {}
+
+    std::unique_ptr<TransportReader> reader_;
+    T scratch_{};
+    uint64_t malformed_ = 0;
+};
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
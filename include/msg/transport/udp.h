@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ignlink/msg/transport/base_transport.h>
+
+#include <cstdint>
+#include <string>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+/**
+ * @struct UdpOptions
+ * @brief Network settings for UdpTransport.
+ */
+struct UdpOptions {
+    std::string group = "239.255.76.67";   // Multicast group shared by all topics
+    std::string interface_address = "0.0.0.0"; // Local interface to send and join on (0.0.0.0 = default)
+    uint16_t base_port = 7400;             // Topics are spread over [base_port, base_port + port_range)
+    uint16_t port_range = 1000;
+    int ttl = 1;                           // 1 keeps traffic on the robot's own network segment
+    bool loopback = true;                  // Deliver to readers on this host, too
+    size_t max_datagram_size = 1472;       // 1500-byte Ethernet MTU minus IP and UDP headers
+    size_t batch_size = 64;                // Datagrams per sendmmsg/recvmmsg call
+    int socket_buffer_size = 8 * 1024 * 1024;
+    size_t max_partial_messages = 32;      // Messages reassembled concurrently per reader
+};
+
+/**
+ * @class UdpTransport
+ * @brief UDP multicast transport for spanning several machines on the robot's network.
+ *
+ * Every topic maps to a port on a common multicast group, so the kernel only
+ * delivers a reader the traffic for ports it listens on. Each datagram starts
+ * with a small header naming the topic, type, writer and message sequence
+ * number; colliding topics on the same port are told apart by it.
+ *
+ * Messages larger than a datagram are split into fragments. The writer sends
+ * them with `sendmmsg`, gathering each fragment straight from the caller's
+ * buffer (no staging copy), and readers drain the socket with `recvmmsg` into
+ * a fixed set of preallocated buffers. Single-datagram messages are delivered
+ * straight from the receive buffer; larger ones are reassembled into buffers
+ * that are recycled between messages, so steady-state traffic does not
+ * allocate.
+ *
+ * Sequence numbers let readers count lost messages. A message with any
+ * fragment missing is dropped and counted as lost; there are no retransmits.
+ * All header fields are little-endian on the wire.
+ */
+class UdpTransport : public BaseTransport {
+public:
+    explicit UdpTransport(const UdpOptions& options = UdpOptions());
+
+    const char* name() const override { return "udp"; }
+
+    core::Status create_writer(const TopicOptions& options,
+                               std::unique_ptr<TransportWriter>* writer) override;
+
+    core::Status create_reader(const TopicOptions& options,
+                               std::unique_ptr<TransportReader>* reader) override;
+
+    /**
+     * @brief Gets the UDP port a topic is carried on.
+     */
+    uint16_t topic_port(const std::string& topic_name) const;
+
+private:
+    UdpOptions options_;
+};
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
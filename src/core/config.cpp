@@ -0,0 +1,333 @@
+#include <ignlink/core/config.h>
+#include <ignlink/core/logger.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace core {
+
+namespace {
+
+constexpr int kSettleMs = 50; // Quiet time after the last change before reloading
+
+using Leaves = std::map<std::string, YAML::Node>;
+
+// Flattens maps to dotted keys and sequences to numbered ones. A null leaf unsets its key.
+void flatten(const YAML::Node& node, const std::string& prefix, Leaves* leaves) {
+    switch (node.Type()) {
+    case YAML::NodeType::Map:
+        for (const auto& entry : node) {
+            const std::string key = entry.first.as<std::string>();
+            flatten(entry.second, prefix.empty() ? key : prefix + "." + key, leaves);
+        }
+        break;
+    case YAML::NodeType::Sequence:
+        for (size_t i = 0; i < node.size(); ++i) {
+            flatten(node[i], prefix.empty() ? std::to_string(i) : prefix + "." + std::to_string(i), leaves);
+        }
+        break;
+    case YAML::NodeType::Scalar:
+        (*leaves)[prefix] = node;
+        break;
+    default:
+        leaves->erase(prefix);
+        break;
+    }
+}
+
+Status parse_file(const std::string& path, Leaves* leaves) {
+    std::ifstream file(path);
+    if (!file) {
+        return Status(Status::Code::NotFound, "Could not read config file " + path + ": " + std::strerror(errno));
+    }
+    try {
+        flatten(YAML::Load(file), "", leaves);
+    } catch (const YAML::Exception& e) {
+        return Status(Status::Code::InvalidArgument, "Could not parse config file " + path + ": " + e.what());
+    }
+    return Status::OK();
+}
+
+// Every type the scalar can be read as, converted once here rather than on each read.
+detail::ConfigValue convert(const YAML::Node& node) {
+    detail::ConfigValue value;
+    value.as_string = node.Scalar();
+    value.types = detail::ConfigValue::kString;
+    if (YAML::convert<bool>::decode(node, value.as_bool)) {
+        value.types |= detail::ConfigValue::kBool;
+    }
+    if (YAML::convert<int64_t>::decode(node, value.as_int)) {
+        value.as_double = static_cast<double>(value.as_int);
+        value.types |= detail::ConfigValue::kInt | detail::ConfigValue::kDouble;
+    } else if (YAML::convert<double>::decode(node, value.as_double)) {
+        value.types |= detail::ConfigValue::kDouble;
+    }
+    return value;
+}
+
+std::string directory_of(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+std::string file_name_of(const std::string& path) {
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+struct Config::Impl {
+    std::mutex mutex; // Serializes loads and guards everything below
+    std::vector<std::string> files;
+    std::unordered_map<std::string, uint32_t> slots;
+    ReloadCallback callback;
+    Stats stats;
+
+    // Watching: inotify on the files' directories, by watch descriptor.
+    int inotify_fd = -1;
+    int stop_fd = -1; // eventfd that wakes the watcher
+    std::unordered_map<int, std::string> directories;
+    std::thread watcher;
+
+    uint32_t slot(const std::string& key) {
+        return slots.emplace(key, static_cast<uint32_t>(slots.size())).first->second;
+    }
+
+    // Parses `paths` and publishes the result. Must be called with `mutex` held.
+    Status load(detail::ConfigState& state, const std::vector<std::string>& paths) {
+        Leaves leaves;
+        for (const auto& path : paths) {
+            const Status status = parse_file(path, &leaves);
+            if (!status.ok()) {
+                ++stats.errors;
+                return status;
+            }
+        }
+        auto snapshot = std::make_unique<detail::ConfigSnapshot>();
+        std::vector<std::pair<uint32_t, detail::ConfigValue>> values;
+        values.reserve(leaves.size());
+        for (const auto& leaf : leaves) {
+            values.emplace_back(slot(leaf.first), convert(leaf.second));
+        }
+        snapshot->values.resize(slots.size());
+        for (auto& value : values) {
+            snapshot->values[value.first] = std::move(value.second);
+        }
+        snapshot->version = ++stats.version;
+
+        const detail::ConfigSnapshot* old = state.current.exchange(snapshot.release(), std::memory_order_acq_rel);
+        // Readers that loaded `old` before the exchange may still be using it.
+        state.rcu.synchronize();
+        delete old;
+        return Status::OK();
+    }
+
+    Status watch_directory_of(const std::string& path) {
+        const std::string directory = directory_of(path);
+        for (const auto& entry : directories) {
+            if (entry.second == directory) {
+                return Status::OK();
+            }
+        }
+        // Renames too: editors and deployment tools replace the file rather than write to it.
+        const int wd = ::inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            return Status(Status::Code::Error, "Could not watch " + directory + ": " + std::strerror(errno));
+        }
+        directories[wd] = directory;
+        return Status::OK();
+    }
+
+    // True if the events read from inotify touch one of the files.
+    bool touches_files(const char* buffer, ssize_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool touched = false;
+        for (ssize_t offset = 0; offset < size;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            auto it = directories.find(event->wd);
+            if (it == directories.end() || event->len == 0) {
+                continue;
+            }
+            for (const auto& file : files) {
+                if (directory_of(file) == it->second && file_name_of(file) == event->name) {
+                    touched = true;
+                }
+            }
+        }
+        return touched;
+    }
+};
+
+Config::Config() : state_(std::make_shared<detail::ConfigState>()), impl_(std::make_unique<Impl>()) {
+    impl_->stop_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+}
+
+Config::~Config() {
+    stop_watching();
+    if (impl_->stop_fd >= 0) {
+        ::close(impl_->stop_fd);
+    }
+}
+
+Status Config::add_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    std::vector<std::string> files = impl_->files;
+    files.push_back(path);
+    const Status status = impl_->load(*state_, files);
+    if (!status.ok()) {
+        Logger::error("{}", status.message());
+        return status;
+    }
+    impl_->files = std::move(files);
+    if (impl_->inotify_fd >= 0) {
+        return impl_->watch_directory_of(path);
+    }
+    return Status::OK();
+}
+
+Status Config::reload() {
+    ReloadCallback callback;
+    uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        const Status status = impl_->load(*state_, impl_->files);
+        if (!status.ok()) {
+            Logger::error("Config reload failed, keeping version {}: {}", impl_->stats.version, status.message());
+            return status;
+        }
+        ++impl_->stats.reloads;
+        version = impl_->stats.version;
+        callback = impl_->callback;
+    }
+    Logger::info("Config reloaded, version {}", version);
+    if (callback) {
+        callback(version);
+    }
+    return Status::OK();
+}
+
+Status Config::watch() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->watcher.joinable()) {
+        return Status(Status::Code::AlreadyExists, "The config is already being watched");
+    }
+    if (impl_->stop_fd < 0) {
+        return Status(Status::Code::Error, "Could not create an eventfd");
+    }
+    impl_->inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (impl_->inotify_fd < 0) {
+        return Status(Status::Code::Error, std::string("Could not start inotify: ") + std::strerror(errno));
+    }
+    for (const auto& file : impl_->files) {
+        const Status status = impl_->watch_directory_of(file);
+        if (!status.ok()) {
+            ::close(impl_->inotify_fd);
+            impl_->inotify_fd = -1;
+            impl_->directories.clear();
+            return status;
+        }
+    }
+    uint64_t count;
+    while (::read(impl_->stop_fd, &count, sizeof(count)) == sizeof(count)) {
+    }
+
+    impl_->watcher = std::thread([this] {
+        alignas(inotify_event) char buffer[4096];
+        pollfd fds[2] = {{impl_->inotify_fd, POLLIN, 0}, {impl_->stop_fd, POLLIN, 0}};
+        bool changed = false;
+        while (true) {
+            // Once something changed, wait for the writes to settle before reloading.
+            const int ready = ::poll(fds, 2, changed ? kSettleMs : -1);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                Logger::error("Config watcher poll failed: {}", std::strerror(errno));
+                return;
+            }
+            if (fds[1].revents) {
+                return;
+            }
+            if (ready == 0) {
+                changed = false;
+                reload();
+                continue;
+            }
+            ssize_t n;
+            while ((n = ::read(impl_->inotify_fd, buffer, sizeof(buffer))) > 0) {
+                changed = impl_->touches_files(buffer, n) || changed;
+            }
+        }
+    });
+    return Status::OK();
+}
+
+void Config::stop_watching() {
+    std::thread watcher;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!impl_->watcher.joinable()) {
+            return;
+        }
+        watcher = std::move(impl_->watcher);
+    }
+    const uint64_t one = 1;
+    (void)!::write(impl_->stop_fd, &one, sizeof(one));
+    watcher.join();
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    ::close(impl_->inotify_fd);
+    impl_->inotify_fd = -1;
+    impl_->directories.clear();
+}
+
+void Config::on_reload(ReloadCallback callback) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->callback = std::move(callback);
+}
+
+bool Config::has(const std::string& key) const {
+    uint32_t slot;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->slots.find(key);
+        if (it == impl_->slots.end()) {
+            return false;
+        }
+        slot = it->second;
+    }
+    auto guard = state_->rcu.read();
+    const detail::ConfigSnapshot* snapshot = state_->current.load(std::memory_order_acquire);
+    return snapshot && slot < snapshot->values.size() && snapshot->values[slot].types != 0;
+}
+
+Config::Stats Config::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->stats;
+}
+
+uint32_t Config::slot(const std::string& key) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->slot(key);
+}
+
+} // namespace core
+} // namespace ignlink
@@ -0,0 +1,515 @@
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace core {
+
+namespace {
+
+static_assert(EventLoop::kReadable == EPOLLIN && EventLoop::kWritable == EPOLLOUT, "EventLoop event flags");
+static_assert(EventLoop::kError == EPOLLERR && EventLoop::kHangup == EPOLLHUP, "EventLoop event flags");
+
+constexpr int kMaxEvents = 64;
+constexpr int64_t kTickNs = 1000000; // Timer wheel slot width
+constexpr size_t kSlots = 1024;      // Slots around the wheel
+constexpr int64_t kNever = std::numeric_limits<int64_t>::max();
+
+// epoll keys of the loop's own descriptors. Registered ones are (generation << 32) | fd.
+constexpr uint64_t kWakeupKey = ~uint64_t(0);
+constexpr uint64_t kTimerKey = ~uint64_t(0) - 1;
+
+Status errno_status(const std::string& what) {
+    return Status(Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+// The timerfd's clock; MonotonicClock may be TSC-based, and the wheel must agree with the kernel.
+int64_t now_ns() {
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+template <typename Callback>
+void run_guarded(const std::string& loop_name, Callback&& callback) {
+    try {
+        callback();
+    } catch (const std::exception& e) {
+        Logger::error("Event loop {}: a handler threw: {}", loop_name, e.what());
+    } catch (...) {
+        Logger::error("Event loop {}: a handler threw", loop_name);
+    }
+}
+
+} // namespace
+
+struct EventLoop::Impl {
+    struct Handler {
+        int fd = -1;
+        uint32_t generation = 0; // Tells a re-registered fd from its stale events
+        FdCallback callback;
+        std::atomic<bool> active{true};
+    };
+
+    struct Timer {
+        TimerId id = 0;
+        int64_t deadline_ns = 0;
+        int64_t period_ns = 0; // 0 for one-shot
+        int64_t tick = 0;      // Wheel position: deadline_ns / kTickNs, or the cursor if that has passed
+        std::function<void()> callback;
+        std::atomic<bool> active{true};
+        Timer* prev = nullptr; // In the slot's list
+        Timer* next = nullptr;
+    };
+
+    explicit Impl(std::string loop_name) : name(std::move(loop_name)) {}
+
+    void insert(Timer* timer);
+    void unlink(Timer* timer);
+    void expire(int64_t now, std::vector<std::shared_ptr<Timer>>* due);
+    size_t next_occupied(size_t from) const;
+    int64_t next_deadline() const;
+    void arm();
+    TimerId add_timer(int64_t delay_ns, int64_t period_ns, std::function<void()> callback);
+    void wake();
+    void wait_for_dispatch();
+
+    const std::string name;
+    int epoll_fd = -1;
+    int wakeup_fd = -1; // eventfd for post() and stop()
+    int timer_fd = -1;  // Armed for the earliest timer
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_requested{false};
+    std::atomic<std::thread::id> loop_thread{};
+    std::thread thread; // When start() runs the loop
+
+    std::mutex mutex;          // Guards the handlers, the timers and the task queue
+    std::mutex dispatch_mutex; // Held by the loop thread while it runs a batch of callbacks
+
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+    uint32_t next_generation = 1;
+
+    std::unordered_map<TimerId, std::shared_ptr<Timer>> timers;
+    TimerId next_timer_id = 1;
+    Timer* slots[kSlots] = {};
+    uint64_t occupied[kSlots / 64] = {}; // One bit per non-empty slot
+    int64_t cursor_tick = 0;             // Slots before it have been expired
+    int64_t armed_ns = kNever;
+
+    std::vector<std::function<void()>> tasks;
+    std::atomic<bool> wakeup_pending{false};
+
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> fd_events{0};
+    std::atomic<uint64_t> timer_runs{0};
+    std::atomic<uint64_t> timer_overruns{0};
+    std::atomic<uint64_t> tasks_run{0};
+};
+
+void EventLoop::Impl::insert(Timer* timer) {
+    timer->tick = std::max(timer->deadline_ns / kTickNs, cursor_tick);
+    const size_t slot = static_cast<size_t>(timer->tick) % kSlots;
+    timer->prev = nullptr;
+    timer->next = slots[slot];
+    if (timer->next) {
+        timer->next->prev = timer;
+    }
+    slots[slot] = timer;
+    occupied[slot / 64] |= uint64_t(1) << (slot % 64);
+}
+
+void EventLoop::Impl::unlink(Timer* timer) {
+    const size_t slot = static_cast<size_t>(timer->tick) % kSlots;
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        slots[slot] = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+    timer->prev = timer->next = nullptr;
+    if (!slots[slot]) {
+        occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+    }
+}
+
+void EventLoop::Impl::expire(int64_t now, std::vector<std::shared_ptr<Timer>>* due) {
+    // Walk the slots from the cursor to now, once around at most. Timers a
+    // turn or more ahead share the slots and are skipped by their deadline.
+    const int64_t now_tick = now / kTickNs;
+    const int64_t last = std::min<int64_t>(now_tick, cursor_tick + static_cast<int64_t>(kSlots) - 1);
+    const size_t first_due = due->size();
+    for (int64_t tick = cursor_tick; tick <= last; ++tick) {
+        for (Timer* timer = slots[static_cast<size_t>(tick) % kSlots]; timer;) {
+            Timer* next = timer->next;
+            if (timer->deadline_ns <= now) {
+                unlink(timer);
+                due->push_back(timers.at(timer->id));
+            }
+            timer = next;
+        }
+    }
+    cursor_tick = std::max(cursor_tick, now_tick);
+
+    // Periodic timers go back on the wheel before they run, so they can cancel themselves.
+    for (size_t i = first_due; i < due->size(); ++i) {
+        Timer* timer = (*due)[i].get();
+        if (timer->period_ns == 0) {
+            timers.erase(timer->id);
+            continue;
+        }
+        timer->deadline_ns += timer->period_ns;
+        if (timer->deadline_ns <= now) {
+            const int64_t missed = (now - timer->deadline_ns) / timer->period_ns + 1;
+            timer->deadline_ns += missed * timer->period_ns;
+            timer_overruns.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+        }
+        insert(timer);
+    }
+}
+
+size_t EventLoop::Impl::next_occupied(size_t from) const {
+    // `from` and the result count slots from the cursor's.
+    const size_t base = static_cast<size_t>(cursor_tick) % kSlots;
+    for (size_t k = from; k < kSlots;) {
+        const size_t slot = (base + k) % kSlots;
+        const uint64_t bits = occupied[slot / 64] >> (slot % 64);
+        if (bits) {
+            const size_t found = k + static_cast<size_t>(__builtin_ctzll(bits));
+            return std::min(found, kSlots);
+        }
+        k += 64 - slot % 64;
+    }
+    return kSlots;
+}
+
+int64_t EventLoop::Impl::next_deadline() const {
+    if (timers.empty()) {
+        return kNever;
+    }
+    for (size_t k = next_occupied(0); k < kSlots; k = next_occupied(k + 1)) {
+        const int64_t tick = cursor_tick + static_cast<int64_t>(k);
+        int64_t earliest = kNever;
+        for (const Timer* timer = slots[static_cast<size_t>(tick) % kSlots]; timer; timer = timer->next) {
+            if (timer->tick == tick) {
+                earliest = std::min(earliest, timer->deadline_ns);
+            }
+        }
+        if (earliest != kNever) {
+            return earliest;
+        }
+    }
+    // Everything is a turn or more away: look again a turn from now.
+    return (cursor_tick + static_cast<int64_t>(kSlots)) * kTickNs;
+}
+
+void EventLoop::Impl::arm() {
+    const int64_t next = next_deadline();
+    if (next == armed_ns) {
+        return;
+    }
+    armed_ns = next;
+    itimerspec spec{};
+    if (next != kNever) {
+        const int64_t at = std::max<int64_t>(next, 1); // All zeros would disarm it
+        spec.it_value.tv_sec = static_cast<time_t>(at / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(at % 1000000000);
+    }
+    if (::timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) != 0) {
+        Logger::error("Event loop {}: could not arm its timer: {}", name, std::strerror(errno));
+    }
+}
+
+EventLoop::TimerId EventLoop::Impl::add_timer(int64_t delay_ns, int64_t period_ns, std::function<void()> callback) {
+    auto timer = std::make_shared<Timer>();
+    timer->deadline_ns = now_ns() + std::max<int64_t>(delay_ns, 0);
+    timer->period_ns = period_ns;
+    timer->callback = std::move(callback);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (timers.empty()) {
+        cursor_tick = std::max(cursor_tick, now_ns() / kTickNs); // Nothing to expire in between
+    }
+    timer->id = next_timer_id++;
+    insert(timer.get());
+    timers.emplace(timer->id, timer);
+    if (timer->deadline_ns < armed_ns) {
+        arm();
+    }
+    return timer->id;
+}
+
+void EventLoop::Impl::wake() {
+    const uint64_t one = 1;
+    ssize_t n;
+    do {
+        n = ::write(wakeup_fd, &one, sizeof(one));
+    } while (n < 0 && errno == EINTR);
+}
+
+void EventLoop::Impl::wait_for_dispatch() {
+    // A callback already picked up by the loop may be running: let it finish.
+    if (running.load() && loop_thread.load() != std::this_thread::get_id()) {
+        std::lock_guard<std::mutex> lock(dispatch_mutex);
+    }
+}
+
+EventLoop::EventLoop(std::string name) : impl_(std::make_unique<Impl>(std::move(name))) {
+    impl_->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    impl_->wakeup_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    impl_->timer_fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (impl_->epoll_fd < 0 || impl_->wakeup_fd < 0 || impl_->timer_fd < 0) {
+        const std::string error = std::strerror(errno);
+        for (int fd : {impl_->epoll_fd, impl_->wakeup_fd, impl_->timer_fd}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        throw std::runtime_error("EventLoop: could not create its descriptors: " + error);
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeupKey;
+    ::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, impl_->wakeup_fd, &event);
+    event.data.u64 = kTimerKey;
+    ::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, impl_->timer_fd, &event);
+    impl_->cursor_tick = now_ns() / kTickNs;
+}
+
+EventLoop::~EventLoop() {
+    stop();
+    if (impl_->thread.joinable()) {
+        impl_->thread.join();
+    }
+    ::close(impl_->timer_fd);
+    ::close(impl_->wakeup_fd);
+    ::close(impl_->epoll_fd);
+}
+
+Status EventLoop::add_fd(int fd, uint32_t events, FdCallback callback) {
+    if (fd < 0 || !callback) {
+        return Status(Status::Code::InvalidArgument, "add_fd needs a descriptor and a callback");
+    }
+    auto handler = std::make_shared<Impl::Handler>();
+    handler->fd = fd;
+    handler->callback = std::move(callback);
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (impl_->handlers.count(fd)) {
+        return Status(Status::Code::AlreadyExists, "fd " + std::to_string(fd) + " is already on event loop " + impl_->name);
+    }
+    handler->generation = impl_->next_generation++;
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = (uint64_t(handler->generation) << 32) | static_cast<uint32_t>(fd);
+    if (::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return errno_status("Could not add fd " + std::to_string(fd) + " to event loop " + impl_->name);
+    }
+    impl_->handlers.emplace(fd, std::move(handler));
+    return Status::OK();
+}
+
+Status EventLoop::modify_fd(int fd, uint32_t events) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->handlers.find(fd);
+    if (it == impl_->handlers.end()) {
+        return Status(Status::Code::NotFound, "fd " + std::to_string(fd) + " is not on event loop " + impl_->name);
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = (uint64_t(it->second->generation) << 32) | static_cast<uint32_t>(fd);
+    if (::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+        return errno_status("Could not modify fd " + std::to_string(fd) + " on event loop " + impl_->name);
+    }
+    return Status::OK();
+}
+
+void EventLoop::remove_fd(int fd) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->handlers.find(fd);
+        if (it == impl_->handlers.end()) {
+            return;
+        }
+        it->second->active.store(false);
+        ::epoll_ctl(impl_->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        impl_->handlers.erase(it);
+    }
+    impl_->wait_for_dispatch();
+}
+
+EventLoop::TimerId EventLoop::call_after(std::chrono::nanoseconds delay, std::function<void()> callback) {
+    return impl_->add_timer(delay.count(), 0, std::move(callback));
+}
+
+EventLoop::TimerId EventLoop::call_every(std::chrono::nanoseconds period, std::function<void()> callback) {
+    if (period.count() <= 0) {
+        throw std::invalid_argument("EventLoop::call_every needs a positive period");
+    }
+    return impl_->add_timer(period.count(), period.count(), std::move(callback));
+}
+
+bool EventLoop::cancel_timer(TimerId id) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->timers.find(id);
+        if (it == impl_->timers.end()) {
+            return false;
+        }
+        it->second->active.store(false);
+        impl_->unlink(it->second.get());
+        impl_->timers.erase(it);
+        // The timerfd may still go off for it; that wakeup finds nothing due.
+    }
+    impl_->wait_for_dispatch();
+    return true;
+}
+
+void EventLoop::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->tasks.push_back(std::move(task));
+    }
+    // One eventfd write per batch of posts, however many there are.
+    if (!impl_->wakeup_pending.exchange(true)) {
+        impl_->wake();
+    }
+}
+
+void EventLoop::run() {
+    Impl& impl = *impl_;
+    if (impl.running.exchange(true)) {
+        Logger::error("Event loop {} is already running", impl.name);
+        return;
+    }
+    impl.loop_thread.store(std::this_thread::get_id());
+
+    epoll_event events[kMaxEvents];
+    std::vector<std::pair<std::shared_ptr<Impl::Handler>, uint32_t>> ready;
+    std::vector<std::shared_ptr<Impl::Timer>> due;
+    std::vector<std::function<void()>> tasks;
+    ready.reserve(kMaxEvents);
+    while (!impl.stop_requested.load()) {
+        const int n = ::epoll_wait(impl.epoll_fd, events, kMaxEvents, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Logger::error("Event loop {}: epoll_wait failed: {}", impl.name, std::strerror(errno));
+            break;
+        }
+        impl.wakeups.fetch_add(1, std::memory_order_relaxed);
+
+        // 1. Collect the whole batch under one lock.
+        {
+            std::lock_guard<std::mutex> lock(impl.mutex);
+            for (int i = 0; i < n; ++i) {
+                const uint64_t key = events[i].data.u64;
+                uint64_t count;
+                if (key == kWakeupKey) {
+                    (void)!::read(impl.wakeup_fd, &count, sizeof(count));
+                    impl.wakeup_pending.store(false);
+                    tasks.swap(impl.tasks);
+                } else if (key == kTimerKey) {
+                    (void)!::read(impl.timer_fd, &count, sizeof(count));
+                    impl.armed_ns = kNever;
+                    impl.expire(now_ns(), &due);
+                } else {
+                    auto it = impl.handlers.find(static_cast<int>(key & 0xffffffffu));
+                    if (it != impl.handlers.end() && it->second->generation == static_cast<uint32_t>(key >> 32)) {
+                        ready.emplace_back(it->second, static_cast<uint32_t>(events[i].events));
+                    }
+                }
+            }
+        }
+
+        // 2. Run it: descriptors, then timers, then posted tasks.
+        {
+            std::lock_guard<std::mutex> dispatch(impl.dispatch_mutex);
+            for (const auto& entry : ready) {
+                if (entry.first->active.load()) {
+                    run_guarded(impl.name, [&] { entry.first->callback(entry.second); });
+                }
+            }
+            for (const auto& timer : due) {
+                if (timer->active.load()) {
+                    run_guarded(impl.name, [&] { timer->callback(); });
+                }
+            }
+            for (auto& task : tasks) {
+                run_guarded(impl.name, task);
+            }
+        }
+        impl.fd_events.fetch_add(ready.size(), std::memory_order_relaxed);
+        impl.timer_runs.fetch_add(due.size(), std::memory_order_relaxed);
+        impl.tasks_run.fetch_add(tasks.size(), std::memory_order_relaxed);
+        ready.clear();
+        due.clear();
+        tasks.clear();
+
+        // 3. Arm the timerfd for whatever is next, including timers the batch added.
+        std::lock_guard<std::mutex> lock(impl.mutex);
+        impl.arm();
+    }
+    impl.stop_requested.store(false);
+    impl.loop_thread.store(std::thread::id());
+    impl.running.store(false);
+}
+
+Status EventLoop::start() {
+    if (impl_->thread.joinable() || impl_->running.load()) {
+        return Status(Status::Code::AlreadyExists, "Event loop " + impl_->name + " is already running");
+    }
+    impl_->thread = std::thread([this] { run(); });
+    return Status::OK();
+}
+
+void EventLoop::stop() {
+    if (!impl_->running.load() && !impl_->thread.joinable()) {
+        return;
+    }
+    impl_->stop_requested.store(true);
+    impl_->wake();
+    if (impl_->thread.joinable() && impl_->thread.get_id() != std::this_thread::get_id()) {
+        impl_->thread.join();
+    }
+}
+
+bool EventLoop::in_loop_thread() const {
+    return impl_->loop_thread.load() == std::this_thread::get_id();
+}
+
+const std::string& EventLoop::name() const {
+    return impl_->name;
+}
+
+EventLoop::Stats EventLoop::stats() const {
+    Stats stats;
+    stats.wakeups = impl_->wakeups.load(std::memory_order_relaxed);
+    stats.fd_events = impl_->fd_events.load(std::memory_order_relaxed);
+    stats.timer_runs = impl_->timer_runs.load(std::memory_order_relaxed);
+    stats.timer_overruns = impl_->timer_overruns.load(std::memory_order_relaxed);
+    stats.tasks = impl_->tasks_run.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace core
+} // namespace ignlink
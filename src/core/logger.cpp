@@ -3,86 +3,425 @@
 // This is where we include the heavy third-party library.
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace ignlink {
 namespace core {
 
-// Initialize the static logger pointer to null.
-std::shared_ptr<spdlog::logger> Logger::s_logger_;
-
-void Logger::init(const std::string& logger_name, Level level) {
-    // Create a color-coded console sink.
-    auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
-    
-    // Set a standard pattern for the log messages.
-    // [Timestamp] [Logger Name] [Log Level] Message
-    console_sink->set_pattern("%^[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v%$");
-
-    s_logger_ = std::make_shared<spdlog::logger>(logger_name, console_sink);
-
-    // Map our internal log level enum to spdlog's enum.
-    spdlog::level::level_enum spdlog_level = spdlog::level::info;
-    switch (level) {
-        case Level::Trace:    spdlog_level = spdlog::level::trace;    break;
-        case Level::Debug:    spdlog_level = spdlog::level::debug;    break;
-        case Level::Info:     spdlog_level = spdlog::level::info;     break;
-        case Level::Warn:     spdlog_level = spdlog::level::warn;     break;
-        case Level::Error:    spdlog_level = spdlog::level::err;      break;
-        case Level::Critical: spdlog_level = spdlog::level::critical; break;
-    }
-    s_logger_->set_level(spdlog_level);
-    s_logger_->flush_on(spdlog::level::trace); // Auto-flush for all levels.
-}
+namespace {
+
+constexpr size_t kRingCapacity = 256 * 1024; // Per logging thread
+constexpr uint8_t kPaddingLevel = 0xff;      // Marks the unused tail of the ring before a wrap
+constexpr auto kDrainInterval = std::chrono::milliseconds(20);
+
+/**
+ * @brief A single-producer, single-consumer byte ring owned by one logging thread.
+ *
+ * Positions only ever grow; the offset into the buffer is the position modulo
+ * the capacity. Records never straddle the end: the producer pads to the end
+ * and starts again at offset zero.
+ */
+struct ThreadRing {
+    alignas(64) std::atomic<size_t> head{0}; // Written by the producer
+    size_t cached_tail = 0;                  // Producer's last view of `tail`
+    size_t reserved_head = 0;                // Producer: head after the record being written
+
+    alignas(64) std::atomic<size_t> tail{0}; // Written by the consumer
+
+    alignas(64) std::atomic<bool> retired{false}; // The owning thread has exited
+    std::unique_ptr<uint64_t[]> storage{new uint64_t[kRingCapacity / sizeof(uint64_t)]};
+
+    uint8_t* at(size_t position) { return reinterpret_cast<uint8_t*>(storage.get()) + position % kRingCapacity; }
+};
+
+/**
+ * @brief The spdlog logger plus the background thread that feeds it.
+ */
+class Backend {
+public:
+    Backend() {
+        configure("IGNLINK", Logger::Mode::Async);
+        thread_ = std::thread(&Backend::run, this);
+    }
 
-// The template definitions must be in the header, but if they just call another
-// function, we can put that function's implementation here.
-// To keep it simple, we will define the templates directly in the cpp file,
-// which requires explicit instantiation. A more common way is to put the
-// template implementation in a separate `-inl.h` file.
+    void configure(const std::string& name, Logger::Mode mode) {
+        // Create a color-coded console sink.
+        auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
 
-// A helper function to ensure the logger is initialized.
-static void ensure_initialized() {
-    if (!Logger::s_logger_) {
-        // Default initialization if the user forgets to call init().
-        Logger::init("IGNLINK");
+        // Set a standard pattern for the log messages.
+        // [Timestamp] [Logger Name] [Log Level] Message
+        console_sink->set_pattern("%^[%Y-%m-%d %H:%M:%S.%e] [%n] [%l] %v%$");
+
+        auto logger = std::make_shared<spdlog::logger>(name, console_sink);
+        logger->set_level(spdlog::level::trace); // Filtering happens before records are queued.
+        // Errors are drained and flushed on the logging thread (see
+        // Logger::end_record); everything else is flushed once per batch by
+        // the writer thread.
+        logger->flush_on(spdlog::level::err);
+
+        // Write out what was queued under the old configuration first.
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain_locked();
+        logger_ = std::move(logger);
+        mode_.store(mode);
+    }
+
+    bool async() const { return mode_.load(std::memory_order_relaxed) == Logger::Mode::Async; }
+
+    ThreadRing* register_ring() {
+        auto ring = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(ring);
+        return ring.get();
     }
+
+    void note_dropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Asks the writer to drain soon, e.g. because a ring is filling up.
+     */
+    void wake() {
+        if (!wake_requested_.exchange(true, std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain_locked();
+    }
+
+    /**
+     * @brief Formats and writes one record synchronously (Sync mode).
+     */
+    void write_now(const uint8_t* record) {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        fmt::memory_buffer buffer;
+        write_record(record, buffer);
+        logger_->flush();
+    }
+
+    /**
+     * @brief The record buffer for threads whose ThreadRingHandle has been
+     *        destroyed. Held locked from here until write_orphan().
+     */
+    uint8_t* lock_orphan_scratch(size_t size) {
+        orphan_mutex_.lock();
+        orphan_scratch_.resize(size);
+        return orphan_scratch_.data();
+    }
+
+    void write_orphan(const uint8_t* record) {
+        write_now(record);
+        orphan_mutex_.unlock();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        flush();
+        // Anything logged from here on (static destructors) is written directly.
+        mode_.store(Logger::Mode::Sync);
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (!stopping_) {
+            wake_cv_.wait_for(lock, kDrainInterval, [this] {
+                return stopping_ || wake_requested_.load(std::memory_order_relaxed);
+            });
+            wake_requested_.store(false, std::memory_order_relaxed);
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    // Must be called with drain_mutex_ held; it is the rings' only consumer.
+    void drain_locked() {
+        if (!logger_) {
+            return;
+        }
+        std::vector<std::shared_ptr<ThreadRing>> rings;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings = rings_;
+        }
+
+        bool wrote = false;
+        fmt::memory_buffer buffer;
+        for (const auto& ring : rings) {
+            // Read `retired` first: once it is set, nothing more will be written.
+            const bool retired = ring->retired.load(std::memory_order_acquire);
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            const size_t head = ring->head.load(std::memory_order_acquire);
+            while (tail != head) {
+                const uint8_t* record = ring->at(tail);
+                const auto* header = reinterpret_cast<const detail::LogRecordHeader*>(record);
+                if (header->level != kPaddingLevel) {
+                    write_record(record, buffer);
+                    wrote = true;
+                }
+                tail += header->size;
+            }
+            ring->tail.store(tail, std::memory_order_release);
+            if (retired) {
+                std::lock_guard<std::mutex> lock(rings_mutex_);
+                rings_.erase(std::remove(rings_.begin(), rings_.end(), ring), rings_.end());
+            }
+        }
+
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reported_dropped_) {
+            logger_->warn("{} log records dropped: the log writer could not keep up.", dropped - reported_dropped_);
+            reported_dropped_ = dropped;
+            wrote = true;
+        }
+        if (wrote) {
+            logger_->flush(); // One flush per batch, not per record.
+        }
+    }
+
+    void write_record(const uint8_t* record, fmt::memory_buffer& buffer) {
+        const auto* header = reinterpret_cast<const detail::LogRecordHeader*>(record);
+        const uint8_t* in = record + sizeof(detail::LogRecordHeader);
+
+        fmt::dynamic_format_arg_store<fmt::format_context> args;
+        for (uint8_t i = 0; i < header->num_args; ++i) {
+            const auto kind = static_cast<detail::LogArgKind>(*in++);
+            switch (kind) {
+                case detail::LogArgKind::Int: {
+                    int64_t value;
+                    std::memcpy(&value, in, 8);
+                    args.push_back(value);
+                    in += 8;
+                    break;
+                }
+                case detail::LogArgKind::UInt: {
+                    uint64_t value;
+                    std::memcpy(&value, in, 8);
+                    args.push_back(value);
+                    in += 8;
+                    break;
+                }
+                case detail::LogArgKind::Double: {
+                    double value;
+                    std::memcpy(&value, in, 8);
+                    args.push_back(value);
+                    in += 8;
+                    break;
+                }
+                case detail::LogArgKind::Pointer: {
+                    uint64_t value;
+                    std::memcpy(&value, in, 8);
+                    args.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                    in += 8;
+                    break;
+                }
+                case detail::LogArgKind::Bool:
+                    args.push_back(*in++ != 0);
+                    break;
+                case detail::LogArgKind::Char:
+                    args.push_back(static_cast<char>(*in++));
+                    break;
+                case detail::LogArgKind::String: {
+                    uint32_t length;
+                    std::memcpy(&length, in, sizeof(length));
+                    in += sizeof(length);
+                    args.push_back(fmt::string_view(reinterpret_cast<const char*>(in), length));
+                    in += length;
+                    break;
+                }
+            }
+        }
+
+        buffer.clear();
+        try {
+            fmt::vformat_to(std::back_inserter(buffer), header->format, args);
+        } catch (const fmt::format_error& e) {
+            buffer.clear();
+            fmt::format_to(std::back_inserter(buffer), "[bad log format '{}': {}]", header->format, e.what());
+        }
+
+        static const spdlog::level::level_enum kLevels[] = {
+            spdlog::level::trace, spdlog::level::debug, spdlog::level::info,
+            spdlog::level::warn,  spdlog::level::err,   spdlog::level::critical};
+        const auto time = spdlog::log_clock::time_point(
+            std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(header->timestamp_ns)));
+        logger_->log(time, spdlog::source_loc{}, kLevels[header->level],
+                     spdlog::string_view_t(buffer.data(), buffer.size()));
+    }
+
+    std::shared_ptr<spdlog::logger> logger_; // Guarded by drain_mutex_
+    std::atomic<Logger::Mode> mode_{Logger::Mode::Async};
+
+    std::mutex drain_mutex_; // Serializes consumers and configuration
+    std::mutex rings_mutex_; // Guards rings_
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_ = 0;
+
+    std::mutex orphan_mutex_; // Guards orphan_scratch_
+    std::vector<uint8_t> orphan_scratch_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> wake_requested_{false};
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+// Intentionally leaked so that logging keeps working during static
+// destruction; ShutdownOnExit writes out the last records.
+Backend* g_backend = nullptr;
+
+Backend& backend() {
+    static Backend* instance = g_backend = new Backend();
+    return *instance;
 }
 
-template <typename... Args>
-void Logger::trace(const std::string& fmt, Args&&... args) {
-    ensure_initialized();
-    s_logger_->trace(fmt, std::forward<Args>(args)...);
+struct ShutdownOnExit {
+    ~ShutdownOnExit() {
+        if (g_backend) {
+            g_backend->shutdown();
+        }
+    }
+} g_shutdown_on_exit;
+
+// Set once the calling thread's ThreadRingHandle is destroyed. Trivially
+// destructible, so it stays readable afterwards: the main thread's
+// thread_locals go before static destructors, which may still log.
+thread_local bool t_handle_gone = false;
+
+/**
+ * @brief The calling thread's ring; retired (and later freed by the writer) when the thread exits.
+ */
+struct ThreadRingHandle {
+    ThreadRing* ring = nullptr;
+    std::vector<uint8_t> sync_scratch; // Record buffer for Sync mode
+
+    ~ThreadRingHandle() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+        t_handle_gone = true;
+    }
+};
+
+thread_local ThreadRingHandle t_handle;
+
+} // namespace
+
+std::atomic<int> Logger::s_level_{static_cast<int>(Logger::Level::Info)};
+
+void Logger::init(const std::string& logger_name, Level level, Mode mode) {
+    backend().configure(logger_name, mode);
+    set_level(level);
 }
 
-template <typename... Args>
-void Logger::info(const std::string& fmt, Args&&... args) {
-    ensure_initialized();
-    s_logger_->info(fmt, std::forward<Args>(args)...);
+void Logger::set_level(Level level) {
+    s_level_.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
-template <typename... Args>
-void Logger::warn(const std::string& fmt, Args&&... args) {
-    ensure_initialized();
-    s_logger_->warn(fmt, std::forward<Args>(args)...);
+void Logger::flush() {
+    backend().flush();
 }
 
-template <typename... Args>
-void Logger::error(const std::string& fmt, Args&&... args) {
-    ensure_initialized();
-    s_logger_->error(fmt, std::forward<Args>(args)...);
+uint64_t Logger::dropped_records() {
+    return backend().dropped();
 }
 
-// --- Explicit Template Instantiations ---
-// This is necessary because the template definitions are in a .cpp file.
-// We need to tell the compiler which types we will use them with.
-// For a generic logger, this can be complex. For simplicity, we'll
-// instantiate for common types. A better approach might be to move the
-// template bodies to an inline header file (`logger-inl.h`).
-// Let's assume for now we only need basic string logging for simplicity.
+uint8_t* Logger::begin_record(size_t size, bool urgent) {
+    Backend& writer = backend(); // Initializes the default logger on first use
+    if (t_handle_gone) {
+        return writer.lock_orphan_scratch(size);
+    }
+    ThreadRingHandle& handle = t_handle;
+
+    if (!writer.async()) {
+        handle.sync_scratch.resize(size);
+        return handle.sync_scratch.data();
+    }
 
-template void Logger::info<const char*&>(const std::string&, const char*&);
-template void Logger::warn<const char*&>(const std::string&, const char*&);
-// ... and so on for other types you need.
+    if (!handle.ring) {
+        handle.ring = writer.register_ring();
+    }
+    ThreadRing& ring = *handle.ring;
+    if (size > kRingCapacity / 4) {
+        writer.note_dropped(); // Too large to ever queue.
+        return nullptr;
+    }
+
+    // Records never wrap: if this one does not fit before the end of the
+    // buffer, the rest of the buffer becomes padding.
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+    const size_t offset = head % kRingCapacity;
+    const size_t padding = offset + size > kRingCapacity ? kRingCapacity - offset : 0;
+    const size_t needed = padding + size;
+    if (head + needed - ring.cached_tail > kRingCapacity) {
+        if (urgent) {
+            writer.flush(); // Empties this ring, among others, before we look again
+        }
+        ring.cached_tail = ring.tail.load(std::memory_order_acquire);
+        if (head + needed - ring.cached_tail > kRingCapacity) {
+            writer.note_dropped();
+            writer.wake();
+            return nullptr;
+        }
+    }
+    if (padding) {
+        auto* pad = reinterpret_cast<detail::LogRecordHeader*>(ring.at(head));
+        pad->size = static_cast<uint32_t>(padding);
+        pad->level = kPaddingLevel;
+    }
+    ring.reserved_head = head + needed;
+    return ring.at(head + padding);
+}
+
+void Logger::end_record(uint8_t* record) {
+    if (t_handle_gone) {
+        backend().write_orphan(record);
+        return;
+    }
+    ThreadRingHandle& handle = t_handle;
+    if (!handle.ring || record == handle.sync_scratch.data()) {
+        backend().write_now(record);
+        return;
+    }
+    ThreadRing& ring = *handle.ring;
+    ring.head.store(ring.reserved_head, std::memory_order_release);
+    if (reinterpret_cast<const detail::LogRecordHeader*>(record)->level >= static_cast<uint8_t>(Level::Error)) {
+        // Write it out now, behind whatever this thread queued before it.
+        backend().flush();
+        return;
+    }
+    // Get the writer going early rather than dropping once the ring is full.
+    if (ring.reserved_head - ring.cached_tail > kRingCapacity / 2) {
+        ring.cached_tail = ring.tail.load(std::memory_order_acquire);
+        if (ring.reserved_head - ring.cached_tail > kRingCapacity / 2) {
+            backend().wake();
+        }
+    }
+}
 
 } // namespace core
-} // namespace ignlink
\ No newline at end of file
+} // namespace ignlink
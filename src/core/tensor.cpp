@@ -0,0 +1,375 @@
+#include <ignlink/core/tensor.h>
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ignlink {
+namespace core {
+
+size_t dtype_size(DType dtype) {
+    switch (dtype) {
+        case DType::UInt8:   return 1;
+        case DType::Int8:    return 1;
+        case DType::UInt16:  return 2;
+        case DType::Int16:   return 2;
+        case DType::Int32:   return 4;
+        case DType::Int64:   return 8;
+        case DType::Float16: return 2;
+        case DType::Float32: return 4;
+        case DType::Float64: return 8;
+        case DType::Bool:    return 1;
+    }
+    return 1;
+}
+
+const char* dtype_name(DType dtype) {
+    switch (dtype) {
+        case DType::UInt8:   return "uint8";
+        case DType::Int8:    return "int8";
+        case DType::UInt16:  return "uint16";
+        case DType::Int16:   return "int16";
+        case DType::Int32:   return "int32";
+        case DType::Int64:   return "int64";
+        case DType::Float16: return "float16";
+        case DType::Float32: return "float32";
+        case DType::Float64: return "float64";
+        case DType::Bool:    return "bool";
+    }
+    return "unknown";
+}
+
+// =============================================================================
+// == BUFFER POOL ==============================================================
+// =============================================================================
+
+namespace {
+
+// Size classes are powers of two from 64 B (class 6) up to 2^40 B.
+constexpr uint32_t kMinClass = 6;
+constexpr uint32_t kMaxClass = 40;
+
+// Buffers kept per size class. Small buffers are cheap to hoard; big ones
+// (whole 4K frames) are capped harder so an idle pool doesn't pin gigabytes.
+constexpr size_t kMaxCachedSmall = 64;
+constexpr size_t kMaxCachedLarge = 8;
+constexpr size_t kLargeThreshold = size_t(1) << 20;
+
+struct SizeClass {
+    std::mutex mutex;
+    std::vector<detail::BufferHeader*> free;
+};
+
+struct PoolState {
+    std::array<SizeClass, kMaxClass + 1> classes;
+    std::atomic<size_t> cached_bytes{0};
+};
+
+PoolState& pool_state() {
+    // Intentionally leaked: buffers may be released by other static
+    // destructors after this function's caller has gone.
+    static PoolState* state = new PoolState();
+    return *state;
+}
+
+uint32_t size_class_for(size_t bytes) {
+    uint32_t cls = kMinClass;
+    while (cls < kMaxClass && (size_t(1) << cls) < bytes) {
+        ++cls;
+    }
+    return cls;
+}
+
+} // namespace
+
+detail::PooledBuffer BufferPool::acquire(size_t bytes) {
+    const uint32_t cls = size_class_for(bytes);
+    const size_t capacity = size_t(1) << cls;
+    if (capacity < bytes) {
+        throw std::bad_alloc();
+    }
+
+    PoolState& state = pool_state();
+    detail::BufferHeader* header = nullptr;
+    {
+        SizeClass& size_class = state.classes[cls];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.free.empty()) {
+            header = size_class.free.back();
+            size_class.free.pop_back();
+        }
+    }
+    if (header) {
+        state.cached_bytes.fetch_sub(capacity, std::memory_order_relaxed);
+    } else {
+        void* memory = std::aligned_alloc(Tensor::kAlignment, detail::PooledBuffer::kHeaderSize + capacity);
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+        header = new (memory) detail::BufferHeader();
+        header->size_class = cls;
+        header->capacity = capacity;
+    }
+    header->refs.store(1, std::memory_order_relaxed);
+    return detail::PooledBuffer(header);
+}
+
+void BufferPool::recycle(detail::BufferHeader* header) {
+    PoolState& state = pool_state();
+    const size_t limit = header->capacity >= kLargeThreshold ? kMaxCachedLarge : kMaxCachedSmall;
+    {
+        SizeClass& size_class = state.classes[header->size_class];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (size_class.free.size() < limit) {
+            size_class.free.push_back(header);
+            state.cached_bytes.fetch_add(header->capacity, std::memory_order_relaxed);
+            return;
+        }
+    }
+    header->~BufferHeader();
+    std::free(header);
+}
+
+void BufferPool::trim() {
+    PoolState& state = pool_state();
+    for (auto& size_class : state.classes) {
+        std::vector<detail::BufferHeader*> victims;
+        {
+            std::lock_guard<std::mutex> lock(size_class.mutex);
+            victims.swap(size_class.free);
+        }
+        for (auto* header : victims) {
+            state.cached_bytes.fetch_sub(header->capacity, std::memory_order_relaxed);
+            header->~BufferHeader();
+            std::free(header);
+        }
+    }
+}
+
+size_t BufferPool::cached_bytes() {
+    return pool_state().cached_bytes.load(std::memory_order_relaxed);
+}
+
+// =============================================================================
+// == TENSOR ===================================================================
+// =============================================================================
+
+namespace {
+
+// Element count of @p shape; throws if the shape is invalid or the count (or
+// any stride) does not fit.
+size_t checked_numel(const int64_t* shape, size_t rank) {
+    if (rank > Tensor::kMaxRank) {
+        throw std::invalid_argument("Tensor rank " + std::to_string(rank) + " exceeds the maximum of " +
+                                    std::to_string(Tensor::kMaxRank) + ".");
+    }
+    // Zero-sized dimensions are skipped so that the strides of the others
+    // are checked too.
+    int64_t span = 1;
+    bool empty = false;
+    for (size_t i = 0; i < rank; ++i) {
+        if (shape[i] < 0) {
+            throw std::invalid_argument("Tensor dimensions must be non-negative.");
+        }
+        if (shape[i] == 0) {
+            empty = true;
+        } else if (__builtin_mul_overflow(span, shape[i], &span)) {
+            throw std::invalid_argument("Tensor element count overflows.");
+        }
+    }
+    return empty ? 0 : static_cast<size_t>(span);
+}
+
+} // namespace
+
+Tensor::Tensor(DType dtype, std::initializer_list<int64_t> shape)
+    : Tensor(dtype, shape.begin(), shape.size()) {}
+
+Tensor::Tensor(DType dtype, const int64_t* shape, size_t rank) {
+    resize(dtype, shape, rank);
+}
+
+Tensor Tensor::wrap(const void* data, DType dtype, const int64_t* shape, size_t rank,
+                    std::shared_ptr<const void> owner, const int64_t* strides) {
+    Tensor tensor;
+    tensor.dtype_ = dtype;
+    tensor.set_shape(shape, rank);
+    if (strides) {
+        std::memcpy(tensor.strides_, strides, rank * sizeof(int64_t));
+    }
+    // Wrapped memory is treated as read-only by convention (it is usually a
+    // shared slot that other subscribers read too); the pointer is stored
+    // non-const only so that producers can wrap their own scratch buffers.
+    tensor.data_ = const_cast<uint8_t*>(static_cast<const uint8_t*>(data));
+    tensor.owner_ = std::move(owner);
+    return tensor;
+}
+
+void Tensor::resize(DType dtype, std::initializer_list<int64_t> shape) {
+    resize(dtype, shape.begin(), shape.size());
+}
+
+void Tensor::resize(DType dtype, const int64_t* shape, size_t rank) {
+    size_t bytes = 0;
+    if (__builtin_mul_overflow(checked_numel(shape, rank), dtype_size(dtype), &bytes)) {
+        throw std::invalid_argument("Tensor size overflows size_t.");
+    }
+
+    // Keep the current storage if nobody else can see it and it is big enough.
+    // Otherwise get the new buffer first, so a failure leaves *this untouched.
+    if (owner_ || !buffer_.unique() || buffer_.capacity() < bytes) {
+        buffer_ = BufferPool::acquire(bytes);
+        owner_.reset();
+    }
+    data_ = buffer_.data();
+    dtype_ = dtype;
+    set_shape(shape, rank);
+}
+
+void Tensor::set_shape(const int64_t* shape, size_t rank) {
+    checked_numel(shape, rank); // Validate everything before touching a member
+    rank_ = static_cast<uint8_t>(rank);
+    int64_t stride = 1;
+    for (size_t i = rank; i-- > 0;) {
+        shape_[i] = shape[i];
+        strides_[i] = stride;
+        stride *= shape[i];
+    }
+}
+
+size_t Tensor::numel() const {
+    if (rank_ == 0) {
+        return data_ ? 1 : 0; // A scalar holds one element, an empty tensor none.
+    }
+    size_t count = 1;
+    for (size_t i = 0; i < rank_; ++i) {
+        count *= static_cast<size_t>(shape_[i]);
+    }
+    return count;
+}
+
+bool Tensor::is_contiguous() const {
+    int64_t expected = 1;
+    for (size_t i = rank_; i-- > 0;) {
+        if (shape_[i] != 1 && strides_[i] != expected) {
+            return false;
+        }
+        expected *= shape_[i];
+    }
+    return true;
+}
+
+Tensor Tensor::slice(size_t dim, int64_t start, int64_t stop, int64_t step) const {
+    if (dim >= rank_ || step <= 0 || start < 0 || start > stop || stop > shape_[dim]) {
+        throw std::out_of_range("Invalid slice of dimension " + std::to_string(dim) + ".");
+    }
+    Tensor view = *this;
+    view.data_ += start * strides_[dim] * static_cast<int64_t>(dtype_size(dtype_));
+    view.shape_[dim] = (stop - start + step - 1) / step;
+    view.strides_[dim] = strides_[dim] * step;
+    return view;
+}
+
+Tensor Tensor::select(size_t dim, int64_t index) const {
+    if (dim >= rank_ || index < 0 || index >= shape_[dim]) {
+        throw std::out_of_range("Invalid index into dimension " + std::to_string(dim) + ".");
+    }
+    Tensor view = *this;
+    view.data_ += index * strides_[dim] * static_cast<int64_t>(dtype_size(dtype_));
+    for (size_t i = dim; i + 1 < rank_; ++i) {
+        view.shape_[i] = shape_[i + 1];
+        view.strides_[i] = strides_[i + 1];
+    }
+    --view.rank_;
+    return view;
+}
+
+Tensor Tensor::reshape(std::initializer_list<int64_t> shape) const {
+    return reshape(shape.begin(), shape.size());
+}
+
+Tensor Tensor::reshape(const int64_t* shape, size_t rank) const {
+    if (!is_contiguous()) {
+        throw std::invalid_argument("Only contiguous tensors can be reshaped; call contiguous() first.");
+    }
+    if (rank > kMaxRank) {
+        throw std::invalid_argument("Tensor rank exceeds the maximum.");
+    }
+
+    int64_t resolved[kMaxRank];
+    int64_t known = 1;
+    int inferred = -1;
+    for (size_t i = 0; i < rank; ++i) {
+        resolved[i] = shape[i];
+        if (shape[i] == -1) {
+            if (inferred >= 0) {
+                throw std::invalid_argument("Only one dimension may be inferred.");
+            }
+            inferred = static_cast<int>(i);
+        } else {
+            known *= shape[i];
+        }
+    }
+    const int64_t total = static_cast<int64_t>(numel());
+    if (inferred >= 0) {
+        if (known == 0 || total % known != 0) {
+            throw std::invalid_argument("Cannot infer dimension for reshape.");
+        }
+        resolved[inferred] = total / known;
+        known = total;
+    }
+    if (known != total) {
+        throw std::invalid_argument("Reshape must preserve the number of elements.");
+    }
+
+    Tensor view = *this;
+    view.set_shape(resolved, rank);
+    return view;
+}
+
+Tensor Tensor::clone() const {
+    Tensor copy(dtype_, shape_, rank_);
+    copy.timestamp = timestamp;
+    const size_t element = dtype_size(dtype_);
+    if (is_contiguous()) {
+        std::memcpy(copy.data_, data_, nbytes());
+        return copy;
+    }
+
+    // Strided source: walk it with an odometer over all dimensions but the
+    // last, copying the innermost row element by element.
+    const size_t count = numel();
+    if (count == 0) {
+        return copy;
+    }
+    int64_t index[kMaxRank] = {};
+    uint8_t* out = copy.data_;
+    const int64_t inner = rank_ ? shape_[rank_ - 1] : 1;
+    const int64_t inner_stride = rank_ ? strides_[rank_ - 1] : 1;
+    for (size_t done = 0; done < count; done += static_cast<size_t>(inner)) {
+        int64_t offset = 0;
+        for (size_t d = 0; d + 1 < rank_; ++d) {
+            offset += index[d] * strides_[d];
+        }
+        const uint8_t* row = data_ + offset * static_cast<int64_t>(element);
+        for (int64_t j = 0; j < inner; ++j) {
+            std::memcpy(out, row + j * inner_stride * static_cast<int64_t>(element), element);
+            out += element;
+        }
+        for (size_t d = rank_ - 1; d-- > 0;) {
+            if (++index[d] < shape_[d]) {
+                break;
+            }
+            index[d] = 0;
+        }
+    }
+    return copy;
+}
+
+} // namespace core
+} // namespace ignlink
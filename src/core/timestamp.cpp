@@ -0,0 +1,111 @@
+#include <ignlink/core/timestamp.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#if IGNLINK_HAS_TSC
+#include <cpuid.h>
+#endif
+
+namespace ignlink {
+namespace core {
+
+namespace detail {
+
+ClockCalibration g_clock_calibration;
+
+} // namespace detail
+
+namespace {
+
+constexpr int64_t kCalibrationWindowNs = 10 * 1000 * 1000;
+
+#if IGNLINK_HAS_TSC
+
+/**
+ * @brief Whether the TSC ticks at a constant rate in every power state and
+ *        the kernel considers it synchronized across CPUs.
+ */
+bool tsc_is_reliable() {
+    const char* forced = std::getenv("IGNLINK_CLOCK");
+    if (forced && std::strcmp(forced, "monotonic") == 0) {
+        return false;
+    }
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        return false; // No invariant TSC
+    }
+    // The kernel only selects the TSC as its clocksource after checking that
+    // it is synchronized and stable; trust its verdict rather than re-testing.
+    std::ifstream in("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string source;
+    return static_cast<bool>(in >> source) && source == "tsc";
+}
+
+/**
+ * @brief Reads the TSC and CLOCK_MONOTONIC as close to simultaneously as possible.
+ *
+ * Of a few attempts, keeps the one where the two TSC reads bracketing the
+ * clock_gettime call are closest together (least likely to be interrupted).
+ */
+void sample(uint64_t* tsc, int64_t* ns) {
+    uint64_t best_gap = ~uint64_t(0);
+    for (int i = 0; i < 5; ++i) {
+        const uint64_t before = __rdtsc();
+        const int64_t now = detail::clock_monotonic_ns();
+        const uint64_t after = __rdtsc();
+        if (after - before < best_gap) {
+            best_gap = after - before;
+            *tsc = before + (after - before) / 2;
+            *ns = now;
+        }
+    }
+}
+
+#endif
+
+std::once_flag g_calibrate_once;
+
+void do_calibrate() {
+    auto& c = detail::g_clock_calibration;
+#if IGNLINK_HAS_TSC
+    if (tsc_is_reliable()) {
+        uint64_t tsc0, tsc1;
+        int64_t ns0, ns1;
+        sample(&tsc0, &ns0);
+        // Busy-wait rather than sleep: the window must be measured, not scheduled.
+        while (detail::clock_monotonic_ns() - ns0 < kCalibrationWindowNs) {
+        }
+        sample(&tsc1, &ns1);
+        if (tsc1 > tsc0 && ns1 > ns0) {
+            c.tsc_base = tsc1;
+            c.ns_base = ns1;
+            c.ns_per_tick = static_cast<uint64_t>((static_cast<detail::uint128_t>(ns1 - ns0) << 32) / (tsc1 - tsc0));
+            c.state.store(detail::ClockCalibration::Tsc, std::memory_order_release);
+            return;
+        }
+    }
+#endif
+    c.state.store(detail::ClockCalibration::Fallback, std::memory_order_release);
+}
+
+} // namespace
+
+void MonotonicClock::calibrate() {
+    std::call_once(g_calibrate_once, do_calibrate);
+}
+
+bool MonotonicClock::uses_tsc() {
+    calibrate();
+    return detail::g_clock_calibration.state.load(std::memory_order_acquire) == detail::ClockCalibration::Tsc;
+}
+
+const char* MonotonicClock::source_name() {
+    return uses_tsc() ? "tsc" : "clock_monotonic";
+}
+
+} // namespace core
+} // namespace ignlink
@@ -0,0 +1,169 @@
+#include <ignlink/data/log_player.h>
+#include <ignlink/core/logger.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ignlink {
+namespace data {
+
+struct LogPlayer::Impl {
+    explicit Impl(const LogPlayerOptions& opts) : options(opts) {}
+
+    LogPlayerOptions options;
+    LogReader reader;
+    bool opened = false;
+    std::vector<PublishFn> publishers; // By reader channel ID
+    std::vector<std::string> topics;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> playing{false};
+
+    std::atomic<uint64_t> messages_published{0};
+    std::atomic<uint64_t> bytes_published{0};
+    std::atomic<uint64_t> decode_errors{0};
+
+    void run();
+};
+
+void LogPlayer::Impl::run() {
+    reader.set_topics(topics);
+    reader.seek(options.start_time_ns);
+
+    const auto wall_start = std::chrono::steady_clock::now();
+    int64_t log_start_ns = 0;
+    bool first = true;
+    LogMessage message;
+    while (reader.next(&message)) {
+        if (options.end_time_ns != 0 && message.log_time_ns > options.end_time_ns) {
+            break;
+        }
+        if (first) {
+            log_start_ns = message.log_time_ns;
+            first = false;
+        }
+        if (options.rate > 0) {
+            const auto offset = std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(message.log_time_ns - log_start_ns) / options.rate));
+            std::unique_lock<std::mutex> lock(mutex);
+            if (cv.wait_until(lock, wall_start + offset, [this] { return stopping.load(); })) {
+                break;
+            }
+        } else if (stopping.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        const PublishFn& publish = publishers[message.channel->id];
+        if (publish(message)) {
+            messages_published.fetch_add(1, std::memory_order_relaxed);
+            bytes_published.fetch_add(message.size, std::memory_order_relaxed);
+        } else if (decode_errors.fetch_add(1, std::memory_order_relaxed) == 0) {
+            core::Logger::error("Could not decode a recorded message on '{}'.", message.channel->topic);
+        }
+    }
+
+    core::Logger::info("Replay finished: {} messages published.", messages_published.load());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        playing.store(false);
+    }
+    cv.notify_all();
+}
+
+LogPlayer::LogPlayer(msg::Node& node, const LogPlayerOptions& options)
+    : node_(node), pimpl_(std::make_unique<Impl>(options)) {}
+
+LogPlayer::~LogPlayer() {
+    stop();
+}
+
+core::Status LogPlayer::open(const std::string& path) {
+    if (pimpl_->playing.load()) {
+        return core::Status(core::Status::Code::Error, "Cannot open a log while replaying.");
+    }
+    auto status = pimpl_->reader.open(path);
+    pimpl_->opened = status.ok();
+    pimpl_->publishers.assign(pimpl_->reader.channels().size(), nullptr);
+    pimpl_->topics.clear();
+    return status;
+}
+
+core::Status LogPlayer::add_topic(const std::string& topic_name, const msg::MessageType& type, PublishFn publish) {
+    if (!pimpl_->opened) {
+        return core::Status(core::Status::Code::Error, "Open a log before adding topics to replay.");
+    }
+    if (pimpl_->playing.load()) {
+        return core::Status(core::Status::Code::Error, "Cannot add topics while replaying.");
+    }
+    bool found = false;
+    for (const auto& channel : pimpl_->reader.channels()) {
+        if (channel.topic != topic_name) {
+            continue;
+        }
+        if (channel.type.hash != type.hash) {
+            return core::Status(core::Status::Code::Error, "Topic '" + topic_name + "' was recorded as '" +
+                                                               channel.type.name + "', not '" + type.name + "'.");
+        }
+        pimpl_->publishers[channel.id] = publish;
+        found = true;
+    }
+    if (!found) {
+        return core::Status(core::Status::Code::Error, "Topic '" + topic_name + "' is not in the log.");
+    }
+    pimpl_->topics.push_back(topic_name);
+    return core::Status::OK();
+}
+
+core::Status LogPlayer::start() {
+    if (pimpl_->playing.load()) {
+        return core::Status::OK();
+    }
+    if (pimpl_->topics.empty()) {
+        return core::Status(core::Status::Code::Error, "No topics to replay.");
+    }
+    if (pimpl_->thread.joinable()) {
+        pimpl_->thread.join(); // A previous replay that ended on its own
+    }
+    pimpl_->stopping.store(false);
+    pimpl_->playing.store(true);
+    pimpl_->thread = std::thread([this] { pimpl_->run(); });
+    return core::Status::OK();
+}
+
+void LogPlayer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->stopping.store(true);
+    }
+    pimpl_->cv.notify_all();
+    if (pimpl_->thread.joinable()) {
+        pimpl_->thread.join();
+    }
+}
+
+void LogPlayer::wait() {
+    std::unique_lock<std::mutex> lock(pimpl_->mutex);
+    pimpl_->cv.wait(lock, [this] { return !pimpl_->playing.load(); });
+}
+
+bool LogPlayer::playing() const {
+    return pimpl_->playing.load();
+}
+
+LogPlayer::Stats LogPlayer::stats() const {
+    Stats stats;
+    stats.messages_published = pimpl_->messages_published.load(std::memory_order_relaxed);
+    stats.bytes_published = pimpl_->bytes_published.load(std::memory_order_relaxed);
+    stats.decode_errors = pimpl_->decode_errors.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,453 @@
+#include <ignlink/data/log_reader.h>
+#include <ignlink/data/log_format.h>
+#include <ignlink/core/logger.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace data {
+
+using namespace log_format;
+
+namespace {
+
+struct Segment {
+    std::string path;
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    std::shared_ptr<const void> mapping; // Unmaps when the last LogMessage::share() is gone
+    SegmentHeader header{};
+    std::vector<BlockIndexEntry> blocks;
+    std::vector<int64_t> max_time_through; // Running maximum of the blocks' max_time_ns, for seeking
+    std::vector<std::pair<std::string, msg::MessageType>> recorded_channels; // By recorded channel ID
+    std::vector<const LogChannel*> channels; // Recorded channel ID -> reader channel
+    uint64_t wanted_mask = ~uint64_t(0);
+    int64_t min_time_ns = std::numeric_limits<int64_t>::max();
+    int64_t max_time_ns = std::numeric_limits<int64_t>::min();
+    uint64_t messages = 0;
+};
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+void add_recorded_channel(Segment& segment, uint16_t id, const ChannelPayload& payload, const uint8_t* names) {
+    if (segment.recorded_channels.size() <= id) {
+        segment.recorded_channels.resize(id + 1);
+    }
+    auto& channel = segment.recorded_channels[id];
+    channel.first.assign(reinterpret_cast<const char*>(names), payload.topic_length);
+    channel.second.hash = payload.type_hash;
+    channel.second.name.assign(reinterpret_cast<const char*>(names) + payload.topic_length, payload.type_name_length);
+}
+
+// Reads the index written at close. False if there is none or it is damaged.
+bool load_index(Segment& segment) {
+    const SegmentHeader& header = segment.header;
+    if (header.index_offset == 0 || header.index_offset + header.index_size > segment.size ||
+        header.index_size < sizeof(IndexHeader)) {
+        return false;
+    }
+    const uint8_t* p = segment.base + header.index_offset;
+    const uint8_t* end = p + header.index_size;
+    IndexHeader index;
+    std::memcpy(&index, p, sizeof(index));
+    p += sizeof(index);
+    if (index.magic != kIndexMagic ||
+        static_cast<size_t>(end - p) < static_cast<size_t>(index.block_count) * sizeof(BlockIndexEntry)) {
+        return false;
+    }
+    segment.blocks.resize(index.block_count);
+    std::memcpy(segment.blocks.data(), p, index.block_count * sizeof(BlockIndexEntry));
+    p += index.block_count * sizeof(BlockIndexEntry);
+
+    for (uint32_t i = 0; i < index.channel_count; ++i) {
+        ChannelIndexEntry entry;
+        if (static_cast<size_t>(end - p) < sizeof(entry)) {
+            return false;
+        }
+        std::memcpy(&entry, p, sizeof(entry));
+        const size_t size = sizeof(entry) + entry.payload.topic_length + entry.payload.type_name_length;
+        if (static_cast<size_t>(end - p) < size) {
+            return false;
+        }
+        add_recorded_channel(segment, entry.channel, entry.payload, p + sizeof(entry));
+        p += std::min<size_t>(pad8(size), end - p);
+    }
+    for (const auto& block : segment.blocks) {
+        if (block.offset + sizeof(BlockHeader) > segment.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rebuilds the index of a segment that was not closed cleanly from its
+// block headers, up to the last complete block.
+void scan_blocks(Segment& segment) {
+    segment.blocks.clear();
+    segment.recorded_channels.clear();
+    size_t offset = kLogAlignment;
+    while (offset + sizeof(BlockHeader) <= segment.size) {
+        BlockHeader block;
+        std::memcpy(&block, segment.base + offset, sizeof(block));
+        if (block.magic != kBlockMagic || offset + sizeof(BlockHeader) + block.payload_bytes > segment.size) {
+            break;
+        }
+        BlockIndexEntry entry{};
+        entry.offset = offset;
+        entry.min_time_ns = std::numeric_limits<int64_t>::max();
+        entry.max_time_ns = std::numeric_limits<int64_t>::min();
+        entry.record_count = block.record_count;
+
+        const uint8_t* p = segment.base + offset + sizeof(BlockHeader);
+        const uint8_t* end = p + block.payload_bytes;
+        while (p + sizeof(RecordHeader) <= end) {
+            RecordHeader record;
+            std::memcpy(&record, p, sizeof(record));
+            if (record.size < sizeof(RecordHeader) || p + record.size > end) {
+                break;
+            }
+            if (record.kind == static_cast<uint8_t>(RecordKind::Channel) &&
+                record.size >= sizeof(RecordHeader) + sizeof(ChannelPayload)) {
+                ChannelPayload payload;
+                std::memcpy(&payload, p + sizeof(RecordHeader), sizeof(payload));
+                if (sizeof(RecordHeader) + sizeof(payload) + payload.topic_length + payload.type_name_length <=
+                    record.size) {
+                    add_recorded_channel(segment, record.channel, payload, p + sizeof(RecordHeader) + sizeof(payload));
+                }
+            } else if (record.kind == static_cast<uint8_t>(RecordKind::Message)) {
+                entry.min_time_ns = std::min(entry.min_time_ns, record.log_time_ns);
+                entry.max_time_ns = std::max(entry.max_time_ns, record.log_time_ns);
+                entry.channel_mask |= channel_bit(record.channel);
+                ++entry.message_count;
+            }
+            p += pad8(record.size);
+        }
+        if (entry.message_count == 0) {
+            entry.min_time_ns = entry.max_time_ns = block.first_time_ns;
+        }
+        segment.blocks.push_back(entry);
+        offset += align_up(sizeof(BlockHeader) + block.payload_bytes);
+    }
+}
+
+core::Status map_segment(const std::string& path, Segment& segment) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno_status("Could not open log segment '" + path + "'");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        auto status = errno_status("Could not stat log segment '" + path + "'");
+        ::close(fd);
+        return status;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size < kLogAlignment) {
+        ::close(fd);
+        return core::Status(core::Status::Code::Error, "'" + path + "' is not a log segment.");
+    }
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        auto status = errno_status("Could not map log segment '" + path + "'");
+        ::close(fd);
+        return status;
+    }
+    ::close(fd); // The mapping keeps the file open.
+    // Replay reads front to back; let the kernel read ahead aggressively.
+    ::madvise(base, size, MADV_SEQUENTIAL);
+
+    segment.path = path;
+    segment.base = static_cast<const uint8_t*>(base);
+    segment.size = size;
+    segment.mapping = std::shared_ptr<const void>(base, [size](const void* p) { ::munmap(const_cast<void*>(p), size); });
+    std::memcpy(&segment.header, segment.base, sizeof(SegmentHeader));
+    if (std::memcmp(segment.header.magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0) {
+        return core::Status(core::Status::Code::Error, "'" + path + "' is not a log segment.");
+    }
+    if (segment.header.version != kVersion) {
+        return core::Status(core::Status::Code::Error, "Log segment '" + path + "' has unsupported version " +
+                                                           std::to_string(segment.header.version) + ".");
+    }
+
+    if (!load_index(segment)) {
+        core::Logger::warn("Log segment '{}' has no index (not closed cleanly?); scanning it.", path);
+        scan_blocks(segment);
+    }
+    int64_t max_through = std::numeric_limits<int64_t>::min();
+    for (const auto& block : segment.blocks) {
+        max_through = std::max(max_through, block.max_time_ns);
+        segment.max_time_through.push_back(max_through);
+        if (block.message_count > 0) {
+            segment.min_time_ns = std::min(segment.min_time_ns, block.min_time_ns);
+            segment.max_time_ns = std::max(segment.max_time_ns, block.max_time_ns);
+            segment.messages += block.message_count;
+        }
+    }
+    return core::Status::OK();
+}
+
+} // namespace
+
+struct LogReader::Impl {
+    std::vector<std::unique_ptr<Segment>> segments; // Ordered by start time
+    std::vector<int64_t> max_time_through;          // Running maximum of the segments' max_time_ns
+    std::vector<LogChannel> channels;
+    std::vector<bool> wanted;                       // By reader channel ID; empty = all
+
+    // Read position
+    size_t segment = 0;
+    size_t block = 0;
+    const uint8_t* pos = nullptr; // Next record in the current block; nullptr = none
+    const uint8_t* end = nullptr;
+    int64_t min_time_ns = std::numeric_limits<int64_t>::min();
+
+    bool enter_block();
+    void update_masks();
+};
+
+bool LogReader::Impl::enter_block() {
+    for (; segment < segments.size(); ++segment, block = 0) {
+        Segment& seg = *segments[segment];
+        for (; block < seg.blocks.size(); ++block) {
+            const BlockIndexEntry& entry = seg.blocks[block];
+            if (entry.message_count == 0 || (entry.channel_mask & seg.wanted_mask) == 0 ||
+                entry.max_time_ns < min_time_ns) {
+                continue; // Never touches the block's pages.
+            }
+            BlockHeader header;
+            std::memcpy(&header, seg.base + entry.offset, sizeof(header));
+            if (header.magic != kBlockMagic || entry.offset + sizeof(BlockHeader) + header.payload_bytes > seg.size) {
+                core::Logger::warn("Skipping a damaged block in log segment '{}'.", seg.path);
+                continue;
+            }
+            pos = seg.base + entry.offset + sizeof(BlockHeader);
+            end = pos + header.payload_bytes;
+            return true;
+        }
+    }
+    pos = end = nullptr;
+    return false;
+}
+
+void LogReader::Impl::update_masks() {
+    for (auto& seg : segments) {
+        seg->wanted_mask = 0;
+        for (size_t id = 0; id < seg->channels.size(); ++id) {
+            const LogChannel* channel = seg->channels[id];
+            if (channel && (wanted.empty() || wanted[channel->id])) {
+                seg->wanted_mask |= channel_bit(static_cast<uint16_t>(id));
+            }
+        }
+    }
+}
+
+LogReader::LogReader() : pimpl_(std::make_unique<Impl>()) {}
+
+LogReader::~LogReader() = default;
+
+core::Status LogReader::open(const std::string& path) {
+    close();
+
+    std::vector<std::string> files;
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return errno_status("Could not open log '" + path + "'");
+    }
+    if (S_ISDIR(st.st_mode)) {
+        if (DIR* dir = ::opendir(path.c_str())) {
+            while (dirent* entry = ::readdir(dir)) {
+                const std::string name = entry->d_name;
+                if (name.size() > 6 && name.compare(name.size() - 6, 6, ".iglog") == 0) {
+                    files.push_back(path + "/" + name);
+                }
+            }
+            ::closedir(dir);
+        }
+        if (files.empty()) {
+            return core::Status(core::Status::Code::Error, "No log segments in '" + path + "'.");
+        }
+    } else {
+        files.push_back(path);
+    }
+
+    for (const auto& file : files) {
+        auto segment = std::make_unique<Segment>();
+        auto status = map_segment(file, *segment);
+        if (!status.ok()) {
+            close();
+            return status;
+        }
+        pimpl_->segments.push_back(std::move(segment));
+    }
+    std::sort(pimpl_->segments.begin(), pimpl_->segments.end(), [](const auto& a, const auto& b) {
+        if (a->header.start_time_ns != b->header.start_time_ns) {
+            return a->header.start_time_ns < b->header.start_time_ns;
+        }
+        return a->header.segment_index < b->header.segment_index;
+    });
+
+    // Give every (topic, type) one reader-wide channel, whatever ID it had in each segment.
+    auto& channels = pimpl_->channels;
+    std::vector<std::vector<int>> reader_ids(pimpl_->segments.size());
+    int64_t max_through = std::numeric_limits<int64_t>::min();
+    for (size_t s = 0; s < pimpl_->segments.size(); ++s) {
+        const Segment& seg = *pimpl_->segments[s];
+        reader_ids[s].assign(seg.recorded_channels.size(), -1);
+        for (size_t id = 0; id < seg.recorded_channels.size(); ++id) {
+            const auto& recorded = seg.recorded_channels[id];
+            if (recorded.first.empty()) {
+                continue;
+            }
+            auto it = std::find_if(channels.begin(), channels.end(), [&](const LogChannel& c) {
+                return c.topic == recorded.first && c.type.hash == recorded.second.hash;
+            });
+            if (it == channels.end()) {
+                LogChannel channel;
+                channel.id = static_cast<uint16_t>(channels.size());
+                channel.topic = recorded.first;
+                channel.type = recorded.second;
+                channels.push_back(std::move(channel));
+                it = channels.end() - 1;
+            }
+            reader_ids[s][id] = it->id;
+        }
+        max_through = std::max(max_through, seg.max_time_ns);
+        pimpl_->max_time_through.push_back(max_through);
+    }
+    for (size_t s = 0; s < pimpl_->segments.size(); ++s) {
+        auto& seg = *pimpl_->segments[s];
+        seg.channels.assign(reader_ids[s].size(), nullptr);
+        for (size_t id = 0; id < reader_ids[s].size(); ++id) {
+            if (reader_ids[s][id] >= 0) {
+                seg.channels[id] = &channels[reader_ids[s][id]];
+            }
+        }
+    }
+    pimpl_->update_masks();
+    core::Logger::info("Opened log '{}': {} segments, {} topics, {} messages.", path, pimpl_->segments.size(),
+                       channels.size(), message_count());
+    return core::Status::OK();
+}
+
+void LogReader::close() {
+    pimpl_ = std::make_unique<Impl>();
+}
+
+const std::vector<LogChannel>& LogReader::channels() const {
+    return pimpl_->channels;
+}
+
+const LogChannel* LogReader::find_channel(const std::string& topic) const {
+    for (const auto& channel : pimpl_->channels) {
+        if (channel.topic == topic) {
+            return &channel;
+        }
+    }
+    return nullptr;
+}
+
+int64_t LogReader::start_time_ns() const {
+    int64_t start = std::numeric_limits<int64_t>::max();
+    for (const auto& seg : pimpl_->segments) {
+        start = std::min(start, seg->min_time_ns);
+    }
+    return start == std::numeric_limits<int64_t>::max() ? 0 : start;
+}
+
+int64_t LogReader::end_time_ns() const {
+    return pimpl_->max_time_through.empty() ? 0 : std::max<int64_t>(0, pimpl_->max_time_through.back());
+}
+
+uint64_t LogReader::message_count() const {
+    uint64_t count = 0;
+    for (const auto& seg : pimpl_->segments) {
+        count += seg->messages;
+    }
+    return count;
+}
+
+void LogReader::set_topics(const std::vector<std::string>& topics) {
+    pimpl_->wanted.clear();
+    if (!topics.empty()) {
+        pimpl_->wanted.assign(pimpl_->channels.size(), false);
+        for (const auto& topic : topics) {
+            bool found = false;
+            for (const auto& channel : pimpl_->channels) {
+                if (channel.topic == topic) {
+                    pimpl_->wanted[channel.id] = true;
+                    found = true;
+                }
+            }
+            if (!found) {
+                core::Logger::warn("Topic '{}' is not in the log.", topic);
+            }
+        }
+    }
+    pimpl_->update_masks();
+}
+
+void LogReader::seek(int64_t time_ns) {
+    auto& impl = *pimpl_;
+    impl.min_time_ns = time_ns;
+    impl.pos = impl.end = nullptr;
+    impl.block = 0;
+    // The first segment, then the first block in it, that reaches `time_ns`.
+    impl.segment = static_cast<size_t>(
+        std::lower_bound(impl.max_time_through.begin(), impl.max_time_through.end(), time_ns) -
+        impl.max_time_through.begin());
+    if (impl.segment < impl.segments.size()) {
+        const auto& through = impl.segments[impl.segment]->max_time_through;
+        impl.block = static_cast<size_t>(std::lower_bound(through.begin(), through.end(), time_ns) - through.begin());
+    }
+}
+
+bool LogReader::next(LogMessage* out) {
+    auto& impl = *pimpl_;
+    for (;;) {
+        if (!impl.pos && !impl.enter_block()) {
+            return false;
+        }
+        const Segment& seg = *impl.segments[impl.segment];
+        while (impl.pos + sizeof(RecordHeader) <= impl.end) {
+            const uint8_t* record = impl.pos;
+            RecordHeader header;
+            std::memcpy(&header, record, sizeof(header));
+            if (header.size < sizeof(RecordHeader) || record + header.size > impl.end) {
+                break; // Damaged; the rest of the block is unusable.
+            }
+            impl.pos += pad8(header.size);
+            if (header.kind != static_cast<uint8_t>(RecordKind::Message) || header.channel >= seg.channels.size() ||
+                header.log_time_ns < impl.min_time_ns) {
+                continue;
+            }
+            const LogChannel* channel = seg.channels[header.channel];
+            if (!channel || (!impl.wanted.empty() && !impl.wanted[channel->id])) {
+                continue;
+            }
+            out->channel = channel;
+            out->sequence = header.sequence;
+            out->log_time_ns = header.log_time_ns;
+            out->publish_time_ns = header.publish_time_ns;
+            out->data = record + sizeof(RecordHeader);
+            out->size = header.size - sizeof(RecordHeader);
+            out->segment_ = &seg.mapping;
+            return true;
+        }
+        impl.pos = impl.end = nullptr;
+        ++impl.block;
+    }
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,648 @@
+#include <ignlink/data/log_recorder.h>
+#include <ignlink/data/log_format.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace data {
+
+using namespace log_format;
+
+namespace {
+
+struct FreeDeleter {
+    void operator()(uint8_t* p) const { std::free(p); }
+};
+using AlignedBuffer = std::unique_ptr<uint8_t[], FreeDeleter>;
+
+AlignedBuffer allocate_aligned(size_t size) {
+    void* p = nullptr;
+    if (posix_memalign(&p, kLogAlignment, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return AlignedBuffer(static_cast<uint8_t*>(p));
+}
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+int64_t wall_clock_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+struct LogRecorder::Impl {
+    struct Channel {
+        std::string topic;
+        msg::MessageType type;
+        detail::ChannelCodec codec;
+    };
+
+    struct Entry {
+        uint16_t channel;
+        uint32_t size; // Serialized payload size
+        std::shared_ptr<const void> msg;
+        uint64_t sequence;
+        int64_t log_time_ns;
+        int64_t publish_time_ns;
+    };
+
+    explicit Impl(const LogRecorderOptions& opts) : options(opts) {
+        options.block_size = align_up(std::max(options.block_size, 2 * kLogAlignment));
+    }
+
+    LogRecorderOptions options;
+
+    // --- Channels (append-only; IDs are indices) ---
+    mutable std::mutex channels_mutex;
+    std::vector<Channel> channels;
+
+    // --- Queue between the recording threads and the I/O thread ---
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::vector<Entry> queue;
+    size_t queue_bytes = 0;       // Payload bytes in `queue`, to wake the writer once a block's worth is in
+    bool writer_waiting = false;
+    bool stopping = false;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> queued_bytes{0}; // Everything not yet serialized, including what the writer holds
+
+    std::mutex subscriptions_mutex;
+    std::vector<std::shared_ptr<void>> subscriptions;
+
+    std::thread io_thread;
+
+    // --- Counters ---
+    std::atomic<uint64_t> messages_written{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> messages_dropped{0};
+    std::atomic<uint64_t> bytes_dropped{0};
+    std::atomic<uint64_t> write_errors{0};
+    std::atomic<uint64_t> segments{0};
+
+    // --- I/O thread state ---
+    int fd = -1;
+    uint32_t next_segment_index = 0;
+    uint32_t segment_index = 0;
+    uint64_t segment_offset = 0;  // Where the next block goes
+    uint64_t segment_messages = 0;
+    int64_t segment_start_ns = 0;
+    int64_t segment_start_wall_ns = 0;
+    size_t segment_channels = 0;  // Channels whose Channel record this segment already has
+    mutable std::mutex path_mutex;
+    std::string segment_path;
+
+    AlignedBuffer block;
+    size_t block_capacity = 0;
+    size_t block_used = 0;        // Including the BlockHeader
+    uint32_t block_records = 0;
+    uint64_t block_messages = 0;
+    uint64_t block_message_bytes = 0;
+    int64_t block_first_ns = 0;
+    int64_t block_last_ns = 0;
+    int64_t block_min_ns = 0;
+    int64_t block_max_ns = 0;
+    uint64_t block_channel_mask = 0;
+    std::vector<BlockIndexEntry> segment_blocks; // The seek index, written at close
+    std::chrono::steady_clock::time_point last_write;
+
+    core::Status open_segment();
+    void close_segment();
+    bool write_aligned(const void* data, size_t size, uint64_t offset);
+    void reset_block();
+    void flush_block();
+    void ensure_capacity(size_t record_size);
+    uint8_t* append_record(RecordKind kind, uint16_t channel, size_t payload_size);
+    void write_channel_records();
+    void write_index();
+    void write_entry(const Entry& entry, const detail::ChannelCodec& codec);
+    bool rotation_due() const;
+    void run();
+};
+
+core::Status LogRecorder::Impl::open_segment() {
+    int flags = O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC;
+#ifdef O_DIRECT
+    if (options.direct_io) {
+        flags |= O_DIRECT;
+    }
+#endif
+    std::string path;
+    for (;;) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%06u.iglog", next_segment_index);
+        path = options.directory + "/" + options.prefix + name;
+        fd = ::open(path.c_str(), flags, 0644);
+#ifdef O_DIRECT
+        if (fd < 0 && errno == EINVAL && (flags & O_DIRECT)) {
+            // The filesystem does not support direct I/O (e.g. tmpfs).
+            core::Logger::warn("Direct I/O is not supported for '{}'; using buffered writes.", path);
+            flags &= ~O_DIRECT;
+            options.direct_io = false;
+            continue;
+        }
+#endif
+        if (fd < 0 && errno == EEXIST) {
+            ++next_segment_index; // Never overwrite an earlier recording.
+            continue;
+        }
+        break;
+    }
+    if (fd < 0) {
+        return errno_status("Could not create log segment '" + path + "'");
+    }
+    segment_index = next_segment_index++;
+
+#ifdef __linux__
+    if (options.max_segment_bytes > 0) {
+        // Reserve the space up front so the filesystem can lay the segment out
+        // contiguously. Best effort; KEEP_SIZE leaves the file size alone.
+        ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(options.max_segment_bytes));
+    }
+#endif
+
+    segment_start_ns = core::MonotonicClock::now_ns();
+    segment_start_wall_ns = wall_clock_ns();
+    segment_messages = 0;
+    segment_channels = 0;
+    segment_blocks.clear();
+    segment_offset = kLogAlignment;
+    segments.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(path_mutex);
+        segment_path = path;
+    }
+
+    // Provisional header; completed by close_segment().
+    AlignedBuffer header_block = allocate_aligned(kLogAlignment);
+    std::memset(header_block.get(), 0, kLogAlignment);
+    SegmentHeader header{};
+    std::memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.segment_index = segment_index;
+    header.start_time_ns = segment_start_ns;
+    header.start_wall_ns = segment_start_wall_ns;
+    std::memcpy(header_block.get(), &header, sizeof(header));
+    if (!write_aligned(header_block.get(), kLogAlignment, 0)) {
+        return errno_status("Could not write log segment header '" + path + "'");
+    }
+
+    core::Logger::info("Recording to '{}'.", path);
+    return core::Status::OK();
+}
+
+void LogRecorder::Impl::close_segment() {
+    if (fd < 0) {
+        return;
+    }
+    flush_block();
+    const uint64_t data_bytes = segment_offset;
+    write_index();
+
+    AlignedBuffer header_block = allocate_aligned(kLogAlignment);
+    std::memset(header_block.get(), 0, kLogAlignment);
+    SegmentHeader header{};
+    std::memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.segment_index = segment_index;
+    header.start_time_ns = segment_start_ns;
+    header.start_wall_ns = segment_start_wall_ns;
+    header.end_time_ns = core::MonotonicClock::now_ns();
+    header.message_count = segment_messages;
+    header.data_bytes = data_bytes;
+    if (segment_offset > data_bytes) {
+        header.index_offset = data_bytes;
+        header.index_size = segment_offset - data_bytes;
+    }
+    std::memcpy(header_block.get(), &header, sizeof(header));
+    write_aligned(header_block.get(), kLogAlignment, 0);
+
+    // Give back the preallocated space the segment did not use, and the index padding.
+    if (::ftruncate(fd, static_cast<off_t>(segment_offset)) != 0) {
+        core::Logger::warn("Could not trim log segment '{}': {}", segment_path, std::strerror(errno));
+    }
+    if (options.sync_on_rotate && ::fsync(fd) != 0) {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+        core::Logger::error("Could not sync log segment '{}': {}", segment_path, std::strerror(errno));
+    }
+    ::close(fd);
+    fd = -1;
+    core::Logger::info("Closed log segment '{}' ({} messages, {} bytes).", segment_path, segment_messages,
+                       segment_offset);
+}
+
+void LogRecorder::Impl::write_index() {
+    std::vector<Channel> segment_channel_list;
+    {
+        std::lock_guard<std::mutex> lock(channels_mutex);
+        segment_channel_list.assign(channels.begin(), channels.begin() + segment_channels);
+    }
+
+    size_t size = sizeof(IndexHeader) + segment_blocks.size() * sizeof(BlockIndexEntry);
+    for (const auto& channel : segment_channel_list) {
+        size += pad8(sizeof(ChannelIndexEntry) + channel.topic.size() + channel.type.name.size());
+    }
+    AlignedBuffer index = allocate_aligned(align_up(size));
+    std::memset(index.get(), 0, align_up(size));
+
+    IndexHeader header{};
+    header.magic = kIndexMagic;
+    header.block_count = static_cast<uint32_t>(segment_blocks.size());
+    header.channel_count = static_cast<uint32_t>(segment_channel_list.size());
+    uint8_t* out = index.get();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, segment_blocks.data(), segment_blocks.size() * sizeof(BlockIndexEntry));
+    out += segment_blocks.size() * sizeof(BlockIndexEntry);
+    for (size_t i = 0; i < segment_channel_list.size(); ++i) {
+        const Channel& channel = segment_channel_list[i];
+        ChannelIndexEntry entry{};
+        entry.channel = static_cast<uint16_t>(i);
+        entry.payload.type_hash = channel.type.hash;
+        entry.payload.topic_length = static_cast<uint16_t>(channel.topic.size());
+        entry.payload.type_name_length = static_cast<uint16_t>(channel.type.name.size());
+        std::memcpy(out, &entry, sizeof(entry));
+        std::memcpy(out + sizeof(entry), channel.topic.data(), channel.topic.size());
+        std::memcpy(out + sizeof(entry) + channel.topic.size(), channel.type.name.data(), channel.type.name.size());
+        out += pad8(sizeof(entry) + channel.topic.size() + channel.type.name.size());
+    }
+
+    // Written with the padding so that direct I/O stays aligned; the file is
+    // trimmed back to `size` afterwards.
+    if (write_aligned(index.get(), align_up(size), segment_offset)) {
+        segment_offset += size;
+    } else {
+        write_errors.fetch_add(1, std::memory_order_relaxed);
+        core::Logger::error("Could not write the index of log segment '{}': {}", segment_path, std::strerror(errno));
+    }
+}
+
+bool LogRecorder::Impl::write_aligned(const void* data, size_t size, uint64_t offset) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+void LogRecorder::Impl::reset_block() {
+    block_used = sizeof(BlockHeader);
+    block_records = 0;
+    block_messages = 0;
+    block_message_bytes = 0;
+    block_first_ns = 0;
+    block_last_ns = 0;
+    block_min_ns = 0;
+    block_max_ns = 0;
+    block_channel_mask = 0;
+}
+
+void LogRecorder::Impl::flush_block() {
+    if (block_records == 0) {
+        return;
+    }
+    BlockHeader header{};
+    header.magic = kBlockMagic;
+    header.payload_bytes = static_cast<uint32_t>(block_used - sizeof(BlockHeader));
+    header.record_count = block_records;
+    header.first_time_ns = block_first_ns;
+    header.last_time_ns = block_last_ns;
+    std::memcpy(block.get(), &header, sizeof(header));
+
+    const size_t size = align_up(block_used);
+    std::memset(block.get() + block_used, 0, size - block_used);
+    if (fd >= 0 && write_aligned(block.get(), size, segment_offset)) {
+        BlockIndexEntry entry{};
+        entry.offset = segment_offset;
+        entry.min_time_ns = block_min_ns;
+        entry.max_time_ns = block_max_ns;
+        entry.message_count = static_cast<uint32_t>(block_messages);
+        entry.record_count = block_records;
+        entry.channel_mask = block_channel_mask;
+        segment_blocks.push_back(entry);
+        segment_offset += size;
+        segment_messages += block_messages;
+        messages_written.fetch_add(block_messages, std::memory_order_relaxed);
+        bytes_written.fetch_add(size, std::memory_order_relaxed);
+    } else {
+        // A failed write loses this block only; the next one is tried again.
+        if (write_errors.fetch_add(1, std::memory_order_relaxed) == 0) {
+            core::Logger::error("Could not write to log segment '{}': {}", segment_path, std::strerror(errno));
+        }
+        messages_dropped.fetch_add(block_messages, std::memory_order_relaxed);
+        bytes_dropped.fetch_add(block_message_bytes, std::memory_order_relaxed);
+    }
+    last_write = std::chrono::steady_clock::now();
+    reset_block();
+}
+
+void LogRecorder::Impl::ensure_capacity(size_t record_size) {
+    if (block_used + record_size <= block_capacity) {
+        return;
+    }
+    flush_block();
+    // A message bigger than a block gets a block of its own size; the next
+    // ordinary one goes back to the configured size.
+    const size_t capacity = std::max(options.block_size, align_up(sizeof(BlockHeader) + record_size));
+    if (capacity != block_capacity) {
+        block_capacity = capacity;
+        block = allocate_aligned(block_capacity);
+    }
+}
+
+uint8_t* LogRecorder::Impl::append_record(RecordKind kind, uint16_t channel, size_t payload_size) {
+    const size_t record_size = pad8(sizeof(RecordHeader) + payload_size);
+    ensure_capacity(record_size);
+    uint8_t* record = block.get() + block_used;
+    RecordHeader header{};
+    header.size = static_cast<uint32_t>(sizeof(RecordHeader) + payload_size);
+    header.kind = static_cast<uint8_t>(kind);
+    header.channel = channel;
+    std::memcpy(record, &header, sizeof(header));
+    std::memset(record + header.size, 0, record_size - header.size);
+    block_used += record_size;
+    ++block_records;
+    return record;
+}
+
+void LogRecorder::Impl::write_channel_records() {
+    std::lock_guard<std::mutex> lock(channels_mutex);
+    for (; segment_channels < channels.size(); ++segment_channels) {
+        const Channel& channel = channels[segment_channels];
+        ChannelPayload payload{};
+        payload.type_hash = channel.type.hash;
+        payload.topic_length = static_cast<uint16_t>(channel.topic.size());
+        payload.type_name_length = static_cast<uint16_t>(channel.type.name.size());
+        uint8_t* record = append_record(RecordKind::Channel, static_cast<uint16_t>(segment_channels),
+                                        sizeof(payload) + payload.topic_length + payload.type_name_length);
+        uint8_t* out = record + sizeof(RecordHeader);
+        std::memcpy(out, &payload, sizeof(payload));
+        std::memcpy(out + sizeof(payload), channel.topic.data(), payload.topic_length);
+        std::memcpy(out + sizeof(payload) + payload.topic_length, channel.type.name.data(), payload.type_name_length);
+    }
+}
+
+void LogRecorder::Impl::write_entry(const Entry& entry, const detail::ChannelCodec& codec) {
+    uint8_t* record = append_record(RecordKind::Message, entry.channel, entry.size);
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(record);
+    header->sequence = entry.sequence;
+    header->log_time_ns = entry.log_time_ns;
+    header->publish_time_ns = entry.publish_time_ns;
+    codec.serialize(entry.msg.get(), record + sizeof(RecordHeader));
+
+    if (block_messages == 0) {
+        block_first_ns = entry.log_time_ns;
+        block_min_ns = entry.log_time_ns;
+        block_max_ns = entry.log_time_ns;
+    }
+    block_last_ns = entry.log_time_ns;
+    block_min_ns = std::min(block_min_ns, entry.log_time_ns);
+    block_max_ns = std::max(block_max_ns, entry.log_time_ns);
+    block_channel_mask |= channel_bit(entry.channel);
+    ++block_messages;
+    block_message_bytes += entry.size;
+}
+
+bool LogRecorder::Impl::rotation_due() const {
+    if (options.max_segment_bytes > 0 && segment_offset + block_used >= options.max_segment_bytes) {
+        return true;
+    }
+    const auto max_age = std::chrono::duration_cast<std::chrono::nanoseconds>(options.max_segment_duration).count();
+    return max_age > 0 && core::MonotonicClock::now_ns() - segment_start_ns >= max_age;
+}
+
+void LogRecorder::Impl::run() {
+    std::vector<Entry> batch;
+    std::vector<detail::ChannelCodec> codecs;
+    for (;;) {
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if (queue.empty() && !stopping) {
+                writer_waiting = true;
+                queue_cv.wait_for(lock, options.flush_interval,
+                                  [this] { return stopping || queue_bytes >= options.block_size; });
+                writer_waiting = false;
+            }
+            batch.swap(queue);
+            queue_bytes = 0;
+            stop = stopping;
+        }
+
+        // Channels only grow, and a channel is added before its first message is
+        // queued, so this copy covers every entry of the batch.
+        {
+            std::lock_guard<std::mutex> lock(channels_mutex);
+            for (size_t i = codecs.size(); i < channels.size(); ++i) {
+                codecs.push_back(channels[i].codec);
+            }
+        }
+
+        for (Entry& entry : batch) {
+            if (fd >= 0 && rotation_due()) {
+                close_segment();
+                if (!open_segment().ok()) {
+                    core::Logger::error("Could not open the next log segment; recording is paused.");
+                }
+            }
+            if (fd < 0) {
+                messages_dropped.fetch_add(1, std::memory_order_relaxed);
+                bytes_dropped.fetch_add(entry.size, std::memory_order_relaxed);
+            } else {
+                write_channel_records();
+                write_entry(entry, codecs[entry.channel]);
+            }
+            queued_bytes.fetch_sub(entry.size, std::memory_order_relaxed);
+            entry.msg.reset();
+        }
+        batch.clear();
+
+        if (fd >= 0) {
+            if (stop || std::chrono::steady_clock::now() - last_write >= options.flush_interval) {
+                flush_block();
+            }
+            if (!stop && rotation_due()) {
+                close_segment();
+                open_segment();
+            }
+        }
+        if (stop) {
+            close_segment();
+            return;
+        }
+    }
+}
+
+LogRecorder::LogRecorder(const LogRecorderOptions& options) : pimpl_(std::make_unique<Impl>(options)) {}
+
+LogRecorder::~LogRecorder() {
+    stop();
+}
+
+core::Status LogRecorder::start() {
+    if (pimpl_->running.load()) {
+        return core::Status::OK();
+    }
+    struct stat st;
+    if (::stat(pimpl_->options.directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return core::Status(core::Status::Code::Error,
+                            "Log directory '" + pimpl_->options.directory + "' does not exist.");
+    }
+
+    pimpl_->block_capacity = pimpl_->options.block_size;
+    pimpl_->block = allocate_aligned(pimpl_->block_capacity);
+    pimpl_->reset_block();
+    auto status = pimpl_->open_segment();
+    if (!status.ok()) {
+        if (pimpl_->fd >= 0) {
+            ::close(pimpl_->fd);
+            pimpl_->fd = -1;
+        }
+        return status;
+    }
+    pimpl_->last_write = std::chrono::steady_clock::now();
+    pimpl_->stopping = false;
+    pimpl_->running.store(true);
+    pimpl_->io_thread = std::thread([this] { pimpl_->run(); });
+    return core::Status::OK();
+}
+
+void LogRecorder::stop() {
+    // Unsubscribe first, so no callback writes into a recorder that is going away.
+    std::vector<std::shared_ptr<void>> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->subscriptions_mutex);
+        subscriptions.swap(pimpl_->subscriptions);
+    }
+    subscriptions.clear();
+
+    if (!pimpl_->running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->queue_mutex);
+        pimpl_->stopping = true;
+    }
+    pimpl_->queue_cv.notify_one();
+    if (pimpl_->io_thread.joinable()) {
+        pimpl_->io_thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->path_mutex);
+        pimpl_->segment_path.clear();
+    }
+}
+
+bool LogRecorder::write(uint16_t channel, std::shared_ptr<const void> msg, const msg::MessageInfo& info,
+                        int64_t log_time_ns) {
+    if (!msg) {
+        return false;
+    }
+    detail::ChannelCodec codec;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->channels_mutex);
+        if (channel >= pimpl_->channels.size()) {
+            return false;
+        }
+        codec = pimpl_->channels[channel].codec;
+    }
+    const size_t size = codec.serialized_size(msg.get());
+
+    // Reserve room in the backlog; a recorder that cannot keep up drops rather than waits.
+    const uint64_t queued = pimpl_->queued_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (!pimpl_->running.load(std::memory_order_acquire) || queued + size > pimpl_->options.max_queued_bytes) {
+        pimpl_->queued_bytes.fetch_sub(size, std::memory_order_relaxed);
+        if (pimpl_->running.load(std::memory_order_relaxed)) {
+            pimpl_->messages_dropped.fetch_add(1, std::memory_order_relaxed);
+            pimpl_->bytes_dropped.fetch_add(size, std::memory_order_relaxed);
+        }
+        return false;
+    }
+
+    Impl::Entry entry{channel, static_cast<uint32_t>(size), std::move(msg), info.sequence,
+                      log_time_ns != 0 ? log_time_ns : core::MonotonicClock::now_ns(), info.publish_time_ns};
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->queue_mutex);
+        if (pimpl_->stopping) {
+            pimpl_->queued_bytes.fetch_sub(size, std::memory_order_relaxed);
+            return false;
+        }
+        pimpl_->queue.push_back(std::move(entry));
+        pimpl_->queue_bytes += size;
+        wake = pimpl_->writer_waiting && pimpl_->queue_bytes >= pimpl_->options.block_size;
+    }
+    if (wake) {
+        pimpl_->queue_cv.notify_one();
+    }
+    return true;
+}
+
+LogRecorder::Stats LogRecorder::stats() const {
+    Stats stats;
+    stats.messages_written = pimpl_->messages_written.load(std::memory_order_relaxed);
+    stats.bytes_written = pimpl_->bytes_written.load(std::memory_order_relaxed);
+    stats.messages_dropped = pimpl_->messages_dropped.load(std::memory_order_relaxed);
+    stats.bytes_dropped = pimpl_->bytes_dropped.load(std::memory_order_relaxed);
+    stats.write_errors = pimpl_->write_errors.load(std::memory_order_relaxed);
+    stats.segments = pimpl_->segments.load(std::memory_order_relaxed);
+    stats.queued_bytes = pimpl_->queued_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string LogRecorder::current_segment_path() const {
+    std::lock_guard<std::mutex> lock(pimpl_->path_mutex);
+    return pimpl_->segment_path;
+}
+
+uint16_t LogRecorder::add_channel(const std::string& topic_name, const msg::MessageType& type,
+                                  const detail::ChannelCodec& codec) {
+    std::lock_guard<std::mutex> lock(pimpl_->channels_mutex);
+    for (size_t i = 0; i < pimpl_->channels.size(); ++i) {
+        if (pimpl_->channels[i].topic == topic_name && pimpl_->channels[i].type.hash == type.hash) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    if (pimpl_->channels.size() >= UINT16_MAX) {
+        core::Logger::error("Too many channels to record '{}'.", topic_name);
+        return UINT16_MAX;
+    }
+    pimpl_->channels.push_back(Impl::Channel{topic_name, type, codec});
+    return static_cast<uint16_t>(pimpl_->channels.size() - 1);
+}
+
+void LogRecorder::keep_subscription(std::shared_ptr<void> subscription) {
+    std::lock_guard<std::mutex> lock(pimpl_->subscriptions_mutex);
+    pimpl_->subscriptions.push_back(std::move(subscription));
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,203 @@
+#include <ignlink/data/trigger.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ignlink {
+namespace data {
+
+namespace detail {
+
+struct TriggerCounters {
+    std::atomic<uint64_t> triggers_fired{0};
+    std::atomic<uint64_t> captures{0};
+    std::atomic<uint64_t> messages_captured{0};
+    std::atomic<uint64_t> messages_rejected{0};
+    std::atomic<uint64_t> messages_buffered{0};
+    std::atomic<uint64_t> bytes_buffered{0};
+};
+
+/**
+ * @brief The recent messages of one buffered topic, oldest first.
+ *
+ * A fixed array of slots used as a ring, like a subscriber's queue. The
+ * window state lives here too, under the same lock, so that a snapshot and
+ * the messages that arrive during it are recorded exactly once.
+ */
+struct TriggerRing {
+    struct Slot {
+        std::shared_ptr<const void> msg;
+        msg::MessageInfo info;
+        int64_t time_ns = 0; // Receive time, the time the message is recorded under
+        size_t bytes = 0;
+    };
+
+    std::string topic_name;
+    uint16_t channel = 0;
+    ChannelCodec codec{};
+    LogRecorder* recorder = nullptr;
+    TriggerCounters* counters = nullptr;
+    int64_t pre_trigger_ns = 0;
+    size_t max_bytes = 0;
+
+    std::mutex mutex;
+    std::vector<Slot> slots;
+    size_t head = 0;
+    size_t size = 0;
+    size_t bytes = 0;
+    int64_t capture_until_ns = 0;   // Messages received up to here are forwarded as they arrive
+    int64_t captured_through_ns = 0; // Newest message already handed to the recorder
+
+    void pop_front_locked(std::vector<std::shared_ptr<const void>>& released) {
+        Slot& slot = slots[head];
+        bytes -= slot.bytes;
+        counters->messages_buffered.fetch_sub(1, std::memory_order_relaxed);
+        counters->bytes_buffered.fetch_sub(slot.bytes, std::memory_order_relaxed);
+        released.push_back(std::move(slot.msg));
+        head = (head + 1) % slots.size();
+        --size;
+    }
+
+    void record_locked(const Slot& slot) {
+        if (recorder->write(channel, slot.msg, slot.info, slot.time_ns)) {
+            counters->messages_captured.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            counters->messages_rejected.fetch_add(1, std::memory_order_relaxed);
+        }
+        captured_through_ns = slot.time_ns;
+    }
+};
+
+} // namespace detail
+
+struct TriggerCapture::Impl {
+    explicit Impl(const TriggerCaptureOptions& opts) : options(opts) {}
+
+    TriggerCaptureOptions options;
+    detail::TriggerCounters counters;
+    std::atomic<int64_t> capture_until_ns{0};
+
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<detail::TriggerRing>> rings;
+
+    std::mutex subscriptions_mutex;
+    std::vector<std::shared_ptr<void>> subscriptions;
+};
+
+TriggerCapture::TriggerCapture(LogRecorder& recorder, const TriggerCaptureOptions& options)
+    : recorder_(recorder), pimpl_(std::make_unique<Impl>(options)) {}
+
+TriggerCapture::~TriggerCapture() {
+    // Unsubscribe before the rings go away.
+    std::vector<std::shared_ptr<void>> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->subscriptions_mutex);
+        subscriptions.swap(pimpl_->subscriptions);
+    }
+}
+
+detail::TriggerRing* TriggerCapture::add_ring(const std::string& topic_name, uint16_t channel,
+                                             const detail::ChannelCodec& codec) {
+    auto ring = std::make_unique<detail::TriggerRing>();
+    ring->topic_name = topic_name;
+    ring->channel = channel;
+    ring->codec = codec;
+    ring->recorder = &recorder_;
+    ring->counters = &pimpl_->counters;
+    ring->pre_trigger_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(pimpl_->options.pre_trigger).count();
+    ring->max_bytes = pimpl_->options.max_bytes_per_topic;
+    ring->slots.resize(std::max<size_t>(1, pimpl_->options.max_messages_per_topic));
+    // A topic added while a window is open joins it.
+    ring->capture_until_ns = pimpl_->capture_until_ns.load();
+
+    std::lock_guard<std::mutex> lock(pimpl_->rings_mutex);
+    pimpl_->rings.push_back(std::move(ring));
+    return pimpl_->rings.back().get();
+}
+
+void TriggerCapture::push(detail::TriggerRing& ring, std::shared_ptr<const void> msg, const msg::MessageInfo& info) {
+    detail::TriggerRing::Slot slot;
+    slot.time_ns = info.receive_time_ns != 0 ? info.receive_time_ns : core::MonotonicClock::now_ns();
+    slot.bytes = ring.codec.serialized_size(msg.get());
+    slot.msg = std::move(msg);
+    slot.info = info;
+
+    std::vector<std::shared_ptr<const void>> released; // Evicted messages are freed outside the lock
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    if (slot.time_ns <= ring.capture_until_ns) {
+        ring.record_locked(slot);
+    }
+    const int64_t oldest_ns = slot.time_ns - ring.pre_trigger_ns;
+    while (ring.size > 0 && (ring.size == ring.slots.size() || ring.bytes + slot.bytes > ring.max_bytes ||
+                             ring.slots[ring.head].time_ns < oldest_ns)) {
+        ring.pop_front_locked(released);
+    }
+    ring.bytes += slot.bytes;
+    ring.counters->messages_buffered.fetch_add(1, std::memory_order_relaxed);
+    ring.counters->bytes_buffered.fetch_add(slot.bytes, std::memory_order_relaxed);
+    ring.slots[(ring.head + ring.size) % ring.slots.size()] = std::move(slot);
+    ++ring.size;
+}
+
+void TriggerCapture::fire(const std::string& name) {
+    const int64_t now_ns = core::MonotonicClock::now_ns();
+    const int64_t pre_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(pimpl_->options.pre_trigger).count();
+    const int64_t until_ns =
+        now_ns + std::chrono::duration_cast<std::chrono::nanoseconds>(pimpl_->options.post_trigger).count();
+
+    pimpl_->counters.triggers_fired.fetch_add(1, std::memory_order_relaxed);
+    int64_t previous = pimpl_->capture_until_ns.load();
+    while (previous < until_ns && !pimpl_->capture_until_ns.compare_exchange_weak(previous, until_ns)) {
+    }
+    if (previous < now_ns) {
+        pimpl_->counters.captures.fetch_add(1, std::memory_order_relaxed);
+        core::Logger::info("Trigger '{}' fired; capturing from {} ms before to {} ms after.", name,
+                           pimpl_->options.pre_trigger.count(), pimpl_->options.post_trigger.count());
+    } else {
+        core::Logger::debug("Trigger '{}' fired; extending the open capture.", name);
+    }
+
+    // Snapshot every ring against the same instant. Each ring hands over its
+    // part of the window and starts forwarding new arrivals under one lock, so
+    // nothing falls between the two and nothing is recorded twice.
+    std::lock_guard<std::mutex> rings_lock(pimpl_->rings_mutex);
+    for (auto& ring : pimpl_->rings) {
+        std::lock_guard<std::mutex> lock(ring->mutex);
+        const int64_t from_ns = now_ns - pre_ns;
+        for (size_t i = 0; i < ring->size; ++i) {
+            const auto& slot = ring->slots[(ring->head + i) % ring->slots.size()];
+            if (slot.time_ns >= from_ns && slot.time_ns > ring->captured_through_ns) {
+                ring->record_locked(slot);
+            }
+        }
+        ring->capture_until_ns = std::max(ring->capture_until_ns, until_ns);
+    }
+}
+
+bool TriggerCapture::capturing() const {
+    return core::MonotonicClock::now_ns() <= pimpl_->capture_until_ns.load(std::memory_order_relaxed);
+}
+
+TriggerCapture::Stats TriggerCapture::stats() const {
+    const auto& counters = pimpl_->counters;
+    Stats stats;
+    stats.triggers_fired = counters.triggers_fired.load(std::memory_order_relaxed);
+    stats.captures = counters.captures.load(std::memory_order_relaxed);
+    stats.messages_captured = counters.messages_captured.load(std::memory_order_relaxed);
+    stats.messages_rejected = counters.messages_rejected.load(std::memory_order_relaxed);
+    stats.messages_buffered = counters.messages_buffered.load(std::memory_order_relaxed);
+    stats.bytes_buffered = counters.bytes_buffered.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TriggerCapture::keep_subscription(std::shared_ptr<void> subscription) {
+    std::lock_guard<std::mutex> lock(pimpl_->subscriptions_mutex);
+    pimpl_->subscriptions.push_back(std::move(subscription));
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,577 @@
+#include <ignlink/data/uploader.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// The build may decide (the CMake builds do, from what they can link);
+// otherwise zstd is used when its header is visible.
+#ifndef IGNLINK_HAS_ZSTD
+#if __has_include(<zstd.h>)
+#define IGNLINK_HAS_ZSTD 1
+#else
+#define IGNLINK_HAS_ZSTD 0
+#endif
+#endif
+#if IGNLINK_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ignlink {
+namespace data {
+
+namespace {
+
+// UploadChunk::raw_size is 32 bits.
+constexpr size_t kMaxChunkSize = std::numeric_limits<uint32_t>::max();
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+std::string base_name(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+int64_t thread_cpu_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Returns 0, or the error code (EIO if the file ended early).
+int read_fully(int fd, void* out, size_t size, uint64_t offset) {
+    auto* p = static_cast<uint8_t*>(out);
+    while (size > 0) {
+        const ssize_t n = ::pread(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return errno;
+        }
+        if (n == 0) {
+            return EIO;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return 0;
+}
+
+bool write_fully(int fd, const void* data, size_t size, uint64_t offset) {
+    auto* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+#if IGNLINK_HAS_ZSTD
+// One compression context per worker thread, reused for every chunk.
+ZSTD_CCtx* thread_compression_context() {
+    struct Context {
+        ZSTD_CCtx* ctx = ZSTD_createCCtx();
+        ~Context() { ZSTD_freeCCtx(ctx); }
+    };
+    thread_local Context context;
+    return context.ctx;
+}
+#endif
+
+// Fills `chunk.data` from `raw`, compressed if that helps.
+void encode_chunk(UploadChunk& chunk, std::vector<uint8_t>& raw, Compression compression, int level) {
+#if IGNLINK_HAS_ZSTD
+    if (compression == Compression::Zstd) {
+        chunk.data.resize(ZSTD_compressBound(raw.size()));
+        const size_t n = ZSTD_compressCCtx(thread_compression_context(), chunk.data.data(), chunk.data.size(),
+                                           raw.data(), raw.size(), level);
+        if (!ZSTD_isError(n) && n < raw.size()) {
+            chunk.data.resize(n);
+            chunk.compression = Compression::Zstd;
+            return;
+        }
+        // Incompressible (or an error): send it as it is.
+    }
+#else
+    (void)compression;
+    (void)level;
+#endif
+    chunk.compression = Compression::None;
+    chunk.data.swap(raw);
+}
+
+// --- Progress file: "<file>.upload" ---
+
+struct Progress {
+    uint64_t size = 0;
+    uint64_t chunk_size = 0;
+    uint64_t acked = 0;
+};
+
+std::string progress_path(const std::string& path) {
+    return path + ".upload";
+}
+
+// Gets the chunks acknowledged in an earlier run, if it uploaded the same file the same way.
+uint64_t load_progress(const std::string& path, uint64_t size, uint64_t chunk_size) {
+    FILE* f = std::fopen(progress_path(path).c_str(), "r");
+    if (!f) {
+        return 0;
+    }
+    unsigned long long file_size = 0, file_chunk_size = 0, acked = 0;
+    const int fields = std::fscanf(f, "ignlink-upload 1 size %llu chunk_size %llu acked %llu", &file_size,
+                                   &file_chunk_size, &acked);
+    std::fclose(f);
+    if (fields != 3 || file_size != size || file_chunk_size != chunk_size) {
+        return 0; // The file or the chunking changed; start over.
+    }
+    return acked;
+}
+
+bool save_progress(const std::string& path, const Progress& progress) {
+    const std::string final_path = progress_path(path);
+    const std::string tmp_path = final_path + ".tmp";
+    char text[160];
+    const int length = std::snprintf(text, sizeof(text), "ignlink-upload 1 size %llu chunk_size %llu acked %llu\n",
+                                     static_cast<unsigned long long>(progress.size),
+                                     static_cast<unsigned long long>(progress.chunk_size),
+                                     static_cast<unsigned long long>(progress.acked));
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    // Written, synced and renamed, so a crash leaves the old or the new progress, never a torn one.
+    const bool ok = write_fully(fd, text, static_cast<size_t>(length), 0) && ::fsync(fd) == 0;
+    ::close(fd);
+    return ok && ::rename(tmp_path.c_str(), final_path.c_str()) == 0;
+}
+
+struct FileHandle {
+    int fd = -1;
+    ~FileHandle() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+// A chunk being read and compressed by a worker.
+struct PendingChunk {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool ready = false;
+    int error = 0; // From reading the file, captured on the worker that read it
+    UploadChunk chunk;
+};
+
+} // namespace
+
+// --- FileSink ---
+
+FileSink::FileSink(std::string directory) : directory_(std::move(directory)) {}
+
+core::Status FileSink::begin(const std::string& object, uint64_t size, uint64_t /*chunk_count*/) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    object_ = object;
+    const std::string path = directory_ + "/" + object + ".part";
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return errno_status("Could not open '" + path + "'");
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        return errno_status("Could not size '" + path + "'");
+    }
+    return core::Status::OK();
+}
+
+core::Status FileSink::put(const UploadChunk& chunk) {
+    if (fd_ < 0 || chunk.object != object_) {
+        return core::Status(core::Status::Code::Error, "Chunk for '" + chunk.object + "' outside begin()/finish().");
+    }
+    const void* raw = chunk.data.data();
+    std::vector<uint8_t> decompressed;
+    if (chunk.compression == Compression::Zstd) {
+#if IGNLINK_HAS_ZSTD
+        decompressed.resize(chunk.raw_size);
+        const size_t n = ZSTD_decompress(decompressed.data(), decompressed.size(), chunk.data.data(), chunk.data.size());
+        if (ZSTD_isError(n) || n != chunk.raw_size) {
+            return core::Status(core::Status::Code::Error, "Corrupt chunk " + std::to_string(chunk.index) + " of '" +
+                                                               chunk.object + "'.");
+        }
+        raw = decompressed.data();
+#else
+        return core::Status(core::Status::Code::Error, "This build cannot decompress zstd chunks.");
+#endif
+    } else if (chunk.data.size() != chunk.raw_size) {
+        return core::Status(core::Status::Code::Error, "Chunk size mismatch for '" + chunk.object + "'.");
+    }
+    if (!write_fully(fd_, raw, chunk.raw_size, chunk.offset)) {
+        return errno_status("Could not write chunk of '" + chunk.object + "'");
+    }
+    return core::Status::OK();
+}
+
+core::Status FileSink::finish(const std::string& object) {
+    if (fd_ < 0 || object != object_) {
+        return core::Status(core::Status::Code::Error, "finish() for '" + object + "' without begin().");
+    }
+    const bool synced = ::fsync(fd_) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    if (!synced) {
+        return errno_status("Could not sync '" + object + "'");
+    }
+    const std::string path = directory_ + "/" + object;
+    if (::rename((path + ".part").c_str(), path.c_str()) != 0) {
+        return errno_status("Could not complete '" + path + "'");
+    }
+    return core::Status::OK();
+}
+
+// --- TokenBucket ---
+
+TokenBucket::TokenBucket(uint64_t rate, uint64_t burst)
+    : rate_(rate), burst_(static_cast<double>(std::max<uint64_t>(burst, 1))), tokens_(burst_),
+      last_(std::chrono::steady_clock::now()) {}
+
+void TokenBucket::refill_locked(std::chrono::steady_clock::time_point now) {
+    const double elapsed = std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+    tokens_ = std::min(burst_, tokens_ + elapsed * static_cast<double>(rate_));
+}
+
+std::chrono::nanoseconds TokenBucket::take(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (rate_ == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    refill_locked(std::chrono::steady_clock::now());
+    tokens_ -= static_cast<double>(bytes);
+    if (tokens_ >= 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(-tokens_ / static_cast<double>(rate_) * 1e9));
+}
+
+void TokenBucket::set_rate(uint64_t rate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill_locked(std::chrono::steady_clock::now());
+    rate_ = rate;
+    if (rate_ == 0) {
+        tokens_ = burst_;
+    }
+}
+
+uint64_t TokenBucket::rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_;
+}
+
+// --- Uploader ---
+
+struct Uploader::Impl {
+    Impl(std::shared_ptr<UploadSink> s, const UploaderOptions& opts)
+        : sink(std::move(s)), options(opts), bucket(opts.bandwidth_limit, opts.burst_bytes) {
+        options.chunk_size = std::max<size_t>(options.chunk_size, 4096);
+        if (options.chunk_size > kMaxChunkSize) {
+            core::Logger::warn("Upload chunk size {} is too large; using {}.", options.chunk_size, kMaxChunkSize);
+            options.chunk_size = kMaxChunkSize;
+        }
+        options.max_chunks_ahead = std::max<size_t>(options.max_chunks_ahead, 1);
+        if (!compression_available(options.compression)) {
+            core::Logger::warn("Upload compression is not available in this build; sending uncompressed.");
+            options.compression = Compression::None;
+        }
+    }
+
+    std::shared_ptr<UploadSink> sink;
+    UploaderOptions options;
+    TokenBucket bucket;
+    std::unique_ptr<core::ThreadPool> pool;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable cv;      // Wakes the upload thread: new file, stop
+    std::condition_variable idle_cv; // Wakes wait_idle()
+    std::deque<std::string> files;   // The front one is being uploaded
+    bool stopping = false;
+    bool running = false;
+
+    std::atomic<uint64_t> files_uploaded{0};
+    std::atomic<uint64_t> chunks_uploaded{0};
+    std::atomic<uint64_t> chunks_resumed{0};
+    std::atomic<uint64_t> raw_bytes{0};
+    std::atomic<uint64_t> sent_bytes{0};
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> compress_cpu_ns{0};
+
+    bool sleep_for(std::chrono::nanoseconds duration);
+    template <typename Fn>
+    bool with_retry(const char* what, const std::string& object, Fn&& fn);
+    std::shared_ptr<PendingChunk> schedule(const std::shared_ptr<FileHandle>& file, const std::string& object,
+                                           uint64_t index, uint64_t chunk_count, uint64_t size);
+    bool upload_file(const std::string& path);
+    void run();
+};
+
+// Sleeps unless stopped first. Returns false if stopped.
+bool Uploader::Impl::sleep_for(std::chrono::nanoseconds duration) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !cv.wait_for(lock, duration, [this] { return stopping; });
+}
+
+template <typename Fn>
+bool Uploader::Impl::with_retry(const char* what, const std::string& object, Fn&& fn) {
+    std::chrono::nanoseconds delay = options.retry_delay;
+    for (;;) {
+        const core::Status status = fn();
+        if (status.ok()) {
+            return true;
+        }
+        retries.fetch_add(1, std::memory_order_relaxed);
+        core::Logger::warn("Upload {} for '{}' failed ({}); retrying in {} ms.", what, object, status.message(),
+                           std::chrono::duration_cast<std::chrono::milliseconds>(delay).count());
+        if (!sleep_for(delay)) {
+            return false;
+        }
+        delay = std::min<std::chrono::nanoseconds>(delay * 2, options.max_retry_delay);
+    }
+}
+
+std::shared_ptr<PendingChunk> Uploader::Impl::schedule(const std::shared_ptr<FileHandle>& file,
+                                                       const std::string& object, uint64_t index,
+                                                       uint64_t chunk_count, uint64_t size) {
+    auto pending = std::make_shared<PendingChunk>();
+    pending->chunk.object = object;
+    pending->chunk.index = index;
+    pending->chunk.chunk_count = chunk_count;
+    pending->chunk.offset = index * options.chunk_size;
+    pending->chunk.raw_size = static_cast<uint32_t>(std::min<uint64_t>(options.chunk_size, size - pending->chunk.offset));
+
+    const Compression compression = options.compression;
+    const int level = options.compression_level;
+    pool->submit([this, file, pending, compression, level] {
+        const int64_t cpu_start = thread_cpu_ns();
+        std::vector<uint8_t> raw(pending->chunk.raw_size);
+        const int error = read_fully(file->fd, raw.data(), raw.size(), pending->chunk.offset);
+        if (error == 0) {
+            encode_chunk(pending->chunk, raw, compression, level);
+        }
+        compress_cpu_ns.fetch_add(static_cast<uint64_t>(thread_cpu_ns() - cpu_start), std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            pending->error = error;
+            pending->ready = true;
+        }
+        pending->cv.notify_one();
+    });
+    return pending;
+}
+
+// Uploads one file. Returns false if stopped before it was complete.
+bool Uploader::Impl::upload_file(const std::string& path) {
+    const std::string object = base_name(path);
+    auto file = std::make_shared<FileHandle>();
+    file->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (file->fd < 0 || ::fstat(file->fd, &st) != 0) {
+        core::Logger::error("Cannot upload '{}': {}", path, std::strerror(errno));
+        return true; // Nothing to retry; move on.
+    }
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    const uint64_t chunk_count = (size + options.chunk_size - 1) / options.chunk_size;
+
+    Progress progress;
+    progress.size = size;
+    progress.chunk_size = options.chunk_size;
+    progress.acked = std::min(load_progress(path, size, options.chunk_size), chunk_count);
+    if (progress.acked > 0) {
+        chunks_resumed.fetch_add(progress.acked, std::memory_order_relaxed);
+        core::Logger::info("Resuming upload of '{}' at chunk {} of {}.", object, progress.acked, chunk_count);
+    }
+
+    if (!with_retry("start", object, [&] { return sink->begin(object, size, chunk_count); })) {
+        return false;
+    }
+
+    std::deque<std::shared_ptr<PendingChunk>> window; // Chunks being prepared, in order
+    uint64_t next_to_schedule = progress.acked;
+    while (progress.acked < chunk_count) {
+        while (window.size() < options.max_chunks_ahead && next_to_schedule < chunk_count) {
+            window.push_back(schedule(file, object, next_to_schedule++, chunk_count, size));
+        }
+        std::shared_ptr<PendingChunk> pending = window.front();
+        {
+            std::unique_lock<std::mutex> lock(pending->mutex);
+            pending->cv.wait(lock, [&] { return pending->ready; });
+        }
+        if (pending->error != 0) {
+            core::Logger::error("Cannot read '{}' for upload: {}", path, std::strerror(pending->error));
+            return true; // Keeps its progress file; a later enqueue resumes it.
+        }
+
+        const UploadChunk& chunk = pending->chunk;
+        if (!sleep_for(bucket.take(chunk.data.size()))) {
+            return false;
+        }
+        if (!with_retry("chunk", object, [&] { return sink->put(chunk); })) {
+            return false;
+        }
+        window.pop_front();
+        progress.acked = chunk.index + 1;
+        if (!save_progress(path, progress)) {
+            core::Logger::warn("Cannot save upload progress for '{}': {}", path, std::strerror(errno));
+        }
+        chunks_uploaded.fetch_add(1, std::memory_order_relaxed);
+        raw_bytes.fetch_add(chunk.raw_size, std::memory_order_relaxed);
+        sent_bytes.fetch_add(chunk.data.size(), std::memory_order_relaxed);
+    }
+
+    if (!with_retry("finish", object, [&] { return sink->finish(object); })) {
+        return false;
+    }
+    std::remove(progress_path(path).c_str());
+    if (options.delete_after_upload && std::remove(path.c_str()) != 0) {
+        core::Logger::warn("Cannot remove uploaded file '{}': {}", path, std::strerror(errno));
+    }
+    files_uploaded.fetch_add(1, std::memory_order_relaxed);
+    core::Logger::info("Uploaded '{}' ({} bytes in {} chunks).", object, size, chunk_count);
+    return true;
+}
+
+void Uploader::Impl::run() {
+    for (;;) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !files.empty(); });
+            if (stopping) {
+                return;
+            }
+            path = files.front();
+        }
+        if (!upload_file(path)) {
+            return; // Stopped; the file stays queued and resumes on the next start().
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            files.pop_front();
+        }
+        idle_cv.notify_all();
+    }
+}
+
+Uploader::Uploader(std::shared_ptr<UploadSink> sink, const UploaderOptions& options)
+    : pimpl_(std::make_unique<Impl>(std::move(sink), options)) {}
+
+Uploader::~Uploader() {
+    stop();
+}
+
+core::Status Uploader::start() {
+    if (!pimpl_->sink) {
+        return core::Status(core::Status::Code::Error, "Uploader has no sink.");
+    }
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        if (pimpl_->running) {
+            return core::Status::OK();
+        }
+        pimpl_->running = true;
+        pimpl_->stopping = false;
+    }
+    pimpl_->pool = std::make_unique<core::ThreadPool>(std::max<size_t>(1, pimpl_->options.worker_threads));
+    pimpl_->thread = std::thread([this] { pimpl_->run(); });
+    return core::Status::OK();
+}
+
+void Uploader::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        if (!pimpl_->running) {
+            return;
+        }
+        pimpl_->stopping = true;
+    }
+    pimpl_->cv.notify_all();
+    if (pimpl_->thread.joinable()) {
+        pimpl_->thread.join();
+    }
+    pimpl_->pool.reset(); // Lets chunks already being prepared finish.
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->running = false;
+    }
+    pimpl_->idle_cv.notify_all();
+}
+
+void Uploader::enqueue(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->files.push_back(path);
+    }
+    pimpl_->cv.notify_all();
+}
+
+bool Uploader::wait_idle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->idle_cv.wait_for(lock, timeout, [this] { return pimpl_->files.empty(); });
+}
+
+void Uploader::set_bandwidth_limit(uint64_t bytes_per_second) {
+    pimpl_->bucket.set_rate(bytes_per_second);
+}
+
+Uploader::Stats Uploader::stats() const {
+    Stats stats;
+    stats.files_uploaded = pimpl_->files_uploaded.load(std::memory_order_relaxed);
+    stats.chunks_uploaded = pimpl_->chunks_uploaded.load(std::memory_order_relaxed);
+    stats.chunks_resumed = pimpl_->chunks_resumed.load(std::memory_order_relaxed);
+    stats.raw_bytes = pimpl_->raw_bytes.load(std::memory_order_relaxed);
+    stats.sent_bytes = pimpl_->sent_bytes.load(std::memory_order_relaxed);
+    stats.retries = pimpl_->retries.load(std::memory_order_relaxed);
+    stats.compress_cpu_ns = pimpl_->compress_cpu_ns.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    stats.files_pending = pimpl_->files.size();
+    return stats;
+}
+
+bool Uploader::compression_available(Compression compression) {
+    switch (compression) {
+    case Compression::None:
+        return true;
+    case Compression::Zstd:
+        return IGNLINK_HAS_ZSTD != 0;
+    }
+    return false;
+}
+
+} // namespace data
+} // namespace ignlink
@@ -0,0 +1,144 @@
+#include <ignlink/fleet/client.h>
+#include <ignlink/core/logger.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace ignlink {
+namespace fleet {
+
+namespace {
+
+struct Outgoing {
+    uint64_t sequence;
+    std::string channel;
+    std::vector<uint8_t> payload;
+};
+
+} // namespace
+
+struct Client::Impl {
+    Impl(std::shared_ptr<ClientTransport> t, const ClientOptions& opts) : transport(std::move(t)), options(opts) {}
+
+    std::shared_ptr<ClientTransport> transport;
+    ClientOptions options;
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    bool running = false;
+    bool sending = false; // The sender holds a payload outside the queue
+    std::deque<Outgoing> queue;
+    uint64_t next_sequence = 0;
+    Stats stats;
+
+    void run();
+};
+
+void Client::Impl::run() {
+    auto delay = options.retry_delay;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return !running || !queue.empty(); });
+        if (!running) {
+            return;
+        }
+        // Sent from a copy so that `send()` may drop queued payloads meanwhile.
+        Outgoing outgoing = queue.front();
+        sending = true;
+        lock.unlock();
+        const auto status = transport->send(options.device_id, outgoing.channel, outgoing.payload);
+        lock.lock();
+        sending = false;
+
+        if (!status.ok()) {
+            ++stats.send_errors;
+            core::Logger::warn("Could not send to the fleet backend, retrying in {} ms: {}", delay.count(),
+                               status.message());
+            cv.wait_for(lock, delay, [this] { return !running; });
+            delay = std::min(delay * 2, options.max_retry_delay);
+            continue;
+        }
+        delay = options.retry_delay;
+        ++stats.messages_sent;
+        stats.bytes_sent += outgoing.payload.size();
+        // Unless it was dropped while being sent, the payload is still at the front.
+        if (!queue.empty() && queue.front().sequence == outgoing.sequence) {
+            stats.queued_bytes -= queue.front().payload.size();
+            queue.pop_front();
+        }
+        cv.notify_all();
+    }
+}
+
+Client::Client(std::shared_ptr<ClientTransport> transport, const ClientOptions& options)
+    : pimpl_(std::make_unique<Impl>(std::move(transport), options)) {}
+
+Client::~Client() {
+    stop();
+}
+
+core::Status Client::start() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    if (pimpl_->running) {
+        return core::Status::OK();
+    }
+    if (!pimpl_->transport) {
+        return core::Status(core::Status::Code::InvalidArgument, "The fleet client has no transport.");
+    }
+    pimpl_->running = true;
+    pimpl_->thread = std::thread([this] { pimpl_->run(); });
+    return core::Status::OK();
+}
+
+void Client::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->running = false;
+    }
+    pimpl_->cv.notify_all();
+    if (pimpl_->thread.joinable()) {
+        pimpl_->thread.join();
+    }
+}
+
+bool Client::send(const std::string& channel, std::vector<uint8_t> payload) {
+    if (payload.size() > pimpl_->options.max_queued_bytes) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        auto& stats = pimpl_->stats;
+        while (!pimpl_->queue.empty() && stats.queued_bytes + payload.size() > pimpl_->options.max_queued_bytes) {
+            if (stats.messages_dropped++ == 0) {
+                core::Logger::warn("Fleet client queue full: dropping the oldest payloads.");
+            }
+            stats.queued_bytes -= pimpl_->queue.front().payload.size();
+            pimpl_->queue.pop_front();
+        }
+        stats.queued_bytes += payload.size();
+        pimpl_->queue.push_back(Outgoing{pimpl_->next_sequence++, channel, std::move(payload)});
+    }
+    pimpl_->cv.notify_all();
+    return true;
+}
+
+bool Client::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->cv.wait_for(lock, timeout, [this] { return pimpl_->queue.empty() && !pimpl_->sending; });
+}
+
+const std::string& Client::device_id() const {
+    return pimpl_->options.device_id;
+}
+
+Client::Stats Client::stats() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->stats;
+}
+
+} // namespace fleet
+} // namespace ignlink
@@ -0,0 +1,1400 @@
+#include <ignlink/fleet/ota_handler.h>
+#include <ignlink/fleet/ota_format.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// As for zstd in the uploader: the build may decide, otherwise the header does.
+#ifndef IGNLINK_HAS_OPENSSL
+#if __has_include(<openssl/evp.h>)
+#define IGNLINK_HAS_OPENSSL 1
+#else
+#define IGNLINK_HAS_OPENSSL 0
+#endif
+#endif
+#if IGNLINK_HAS_OPENSSL
+#include <openssl/evp.h>
+#endif
+
+namespace ignlink {
+namespace fleet {
+
+using namespace ota_format;
+
+namespace {
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+core::Status error(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what);
+}
+
+bool read_fully(int fd, void* out, size_t size, uint64_t offset) {
+    auto* p = static_cast<uint8_t*>(out);
+    while (size > 0) {
+        const ssize_t n = ::pread(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool write_fully(int fd, const void* data, size_t size, uint64_t offset) {
+    auto* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+struct FileHandle {
+    int fd = -1;
+    ~FileHandle() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+// The size of an image file, or of a block device.
+bool image_size(int fd, uint64_t* size) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        return false;
+    }
+    if (S_ISBLK(st.st_mode)) {
+        return ::ioctl(fd, BLKGETSIZE64, size) == 0;
+    }
+    *size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+// Replaces a small file so that a crash leaves the old or the new content, never a torn one.
+bool replace_file(const std::string& path, const std::string& content) {
+    const std::string tmp_path = path + ".tmp";
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = write_fully(fd, content.data(), content.size(), 0) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        return false;
+    }
+    // The rename itself is only durable once the directory is synced.
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        ::fsync(dir_fd);
+        ::close(dir_fd);
+    }
+    return true;
+}
+
+// --- SHA-256 ---
+
+#if IGNLINK_HAS_OPENSSL
+
+class Sha256 {
+public:
+    Sha256() : ctx_(EVP_MD_CTX_new()) { EVP_DigestInit_ex(ctx_, EVP_sha256(), nullptr); }
+    ~Sha256() { EVP_MD_CTX_free(ctx_); }
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    void update(const void* data, size_t size) { EVP_DigestUpdate(ctx_, data, size); }
+    void finish(uint8_t* out) { EVP_DigestFinal_ex(ctx_, out, nullptr); }
+
+private:
+    EVP_MD_CTX* ctx_;
+};
+
+#else
+
+// A portable implementation, for builds without OpenSSL (which uses the CPU's SHA extensions).
+class Sha256 {
+public:
+    Sha256() = default;
+
+    void update(const void* data, size_t size) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        total_ += size;
+        if (used_ > 0) {
+            const size_t n = std::min(size, sizeof(block_) - used_);
+            std::memcpy(block_ + used_, p, n);
+            used_ += n;
+            p += n;
+            size -= n;
+            if (used_ < sizeof(block_)) {
+                return;
+            }
+            transform(block_);
+            used_ = 0;
+        }
+        for (; size >= sizeof(block_); p += sizeof(block_), size -= sizeof(block_)) {
+            transform(p);
+        }
+        std::memcpy(block_, p, size);
+        used_ = size;
+    }
+
+    void finish(uint8_t* out) {
+        const uint64_t bits = total_ * 8;
+        const uint8_t pad = 0x80;
+        update(&pad, 1);
+        const uint8_t zero = 0;
+        while (used_ != 56) {
+            update(&zero, 1);
+        }
+        uint8_t length[8];
+        for (int i = 0; i < 8; ++i) {
+            length[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+        }
+        update(length, 8);
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                out[4 * i + j] = static_cast<uint8_t>(state_[i] >> (24 - 8 * j));
+            }
+        }
+    }
+
+private:
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void transform(const uint8_t* block) {
+        static constexpr uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = static_cast<uint32_t>(block[4 * i]) << 24 | static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+                   static_cast<uint32_t>(block[4 * i + 2]) << 8 | static_cast<uint32_t>(block[4 * i + 3]);
+        }
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+        state_[4] += e;
+        state_[5] += f;
+        state_[6] += g;
+        state_[7] += h;
+    }
+
+    uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    uint8_t block_[64];
+    size_t used_ = 0;
+    uint64_t total_ = 0;
+};
+
+#endif
+
+void sha256(const void* data, size_t size, uint8_t* out) {
+    Sha256 hash;
+    hash.update(data, size);
+    hash.finish(out);
+}
+
+// The root of an image: SHA-256(le64 size, le64 chunk_size, chunk hashes).
+void image_root(uint64_t size, uint64_t chunk_size, const std::vector<uint8_t>& chunk_hashes, uint8_t* out) {
+    Sha256 hash;
+    hash.update(&size, sizeof(size));
+    hash.update(&chunk_size, sizeof(chunk_size));
+    hash.update(chunk_hashes.data(), chunk_hashes.size());
+    hash.finish(out);
+}
+
+std::string to_hex(const uint8_t* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(size * 2, '0');
+    for (size_t i = 0; i < size; ++i) {
+        hex[2 * i] = digits[data[i] >> 4];
+        hex[2 * i + 1] = digits[data[i] & 15];
+    }
+    return hex;
+}
+
+bool from_hex(const std::string& hex, uint8_t* out, size_t size) {
+    if (hex.size() != size * 2) {
+        return false;
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+    };
+    for (size_t i = 0; i < size; ++i) {
+        const int high = nibble(hex[2 * i]), low = nibble(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
+
+// --- Pipeline buffers ---
+
+// Counts the bytes held by pipeline buffers, and their peak.
+struct BufferBudget {
+    std::atomic<uint64_t> current{0};
+    std::atomic<uint64_t> peak{0};
+
+    void add(uint64_t bytes) {
+        const uint64_t now = current.fetch_add(bytes) + bytes;
+        uint64_t seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+    }
+
+    void remove(uint64_t bytes) { current.fetch_sub(bytes); }
+};
+
+// At most `limit` buffers of `size` bytes, allocated on demand; `acquire()` waits for one.
+class BufferPool {
+public:
+    BufferPool(size_t size, size_t limit, BufferBudget& budget) : size_(size), limit_(limit), budget_(budget) {}
+
+    ~BufferPool() { budget_.remove(static_cast<uint64_t>(allocated_) * size_); }
+
+    std::unique_ptr<uint8_t[]> acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !free_.empty() || allocated_ < limit_; });
+        if (!free_.empty()) {
+            auto buffer = std::move(free_.back());
+            free_.pop_back();
+            return buffer;
+        }
+        ++allocated_;
+        budget_.add(size_);
+        return std::unique_ptr<uint8_t[]>(new uint8_t[size_]);
+    }
+
+    void release(std::unique_ptr<uint8_t[]> buffer) {
+        // Notified under the lock: the last release may let `wait_all()` return and the pool be destroyed.
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(std::move(buffer));
+        cv_.notify_all();
+    }
+
+    // Waits until every buffer is back, but the `held` ones the caller has.
+    void wait_all(size_t held = 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this, held] { return free_.size() + held == allocated_; });
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    const size_t size_;
+    const size_t limit_;
+    BufferBudget& budget_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<uint8_t[]>> free_;
+    size_t allocated_ = 0;
+};
+
+// Hashes every chunk of an image in parallel.
+core::Status hash_image(int fd, uint64_t size, uint32_t chunk_size, core::ThreadPool& pool, BufferPool& buffers,
+                        std::vector<uint8_t>* hashes) {
+    const uint64_t chunks = chunk_count(size, chunk_size);
+    hashes->assign(chunks * kHashSize, 0);
+    for (uint64_t i = 0; i < chunks; ++i) {
+        const size_t length = static_cast<size_t>(std::min<uint64_t>(chunk_size, size - i * chunk_size));
+        auto buffer = buffers.acquire();
+        if (!read_fully(fd, buffer.get(), length, i * chunk_size)) {
+            buffers.release(std::move(buffer));
+            buffers.wait_all();
+            return errno_status("Cannot read the installed image");
+        }
+        uint8_t* out = hashes->data() + i * kHashSize;
+        auto shared = std::make_shared<std::unique_ptr<uint8_t[]>>(std::move(buffer));
+        pool.submit([&buffers, shared, length, out] {
+            sha256(shared->get(), length, out);
+            buffers.release(std::move(*shared));
+        });
+    }
+    buffers.wait_all();
+    return core::Status::OK();
+}
+
+/**
+ * @brief Downloads a package on its own thread, a few buffers ahead of the reader.
+ */
+class PackageStream {
+public:
+    PackageStream(OtaSource& source, std::string package, uint64_t offset, uint64_t size,
+                  const OtaHandlerOptions& options, BufferBudget& budget, std::atomic<uint64_t>& downloaded,
+                  std::atomic<uint64_t>& retries)
+        : source_(source), package_(std::move(package)), options_(options), budget_(budget),
+          downloaded_(downloaded), retries_(retries), next_(offset), size_(size), consumed_(offset) {
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~PackageStream() {
+        stop();
+        thread_.join();
+        budget_.remove(static_cast<uint64_t>(allocated_) * options_.read_size);
+    }
+
+    PackageStream(const PackageStream&) = delete;
+    PackageStream& operator=(const PackageStream&) = delete;
+
+    // Reads exactly `size` bytes.
+    core::Status read(void* out, size_t size) {
+        auto* p = static_cast<uint8_t*>(out);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (size > 0) {
+            cv_.wait(lock, [this] { return !filled_.empty() || !status_.ok() || stopping_; });
+            if (filled_.empty()) {
+                return stopping_ ? error("OTA update cancelled; its progress is kept.") : status_;
+            }
+            Chunk& chunk = filled_.front();
+            const size_t n = std::min(size, chunk.size - chunk.position);
+            std::memcpy(p, chunk.data.get() + chunk.position, n);
+            chunk.position += n;
+            consumed_ += n;
+            p += n;
+            size -= n;
+            if (chunk.position == chunk.size) {
+                free_.push_back(std::move(chunk.data));
+                filled_.pop_front();
+                cv_.notify_all();
+            }
+        }
+        return core::Status::OK();
+    }
+
+    // The package offset of the next byte `read()` returns.
+    uint64_t offset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return consumed_;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+        size_t position = 0;
+    };
+
+    void run() {
+        const size_t read_size = options_.read_size;
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t failures = 0;
+        auto delay = options_.retry_delay;
+        while (next_ < size_) {
+            cv_.wait(lock, [this] { return stopping_ || !free_.empty() || allocated_ < options_.download_buffers; });
+            if (stopping_) {
+                return;
+            }
+            std::unique_ptr<uint8_t[]> buffer;
+            if (!free_.empty()) {
+                buffer = std::move(free_.back());
+                free_.pop_back();
+            } else {
+                buffer.reset(new uint8_t[read_size]);
+                ++allocated_;
+                budget_.add(read_size);
+            }
+            const uint64_t offset = next_;
+            const size_t wanted = static_cast<size_t>(std::min<uint64_t>(read_size, size_ - offset));
+            lock.unlock();
+            size_t got = 0;
+            auto status = source_.read(package_, offset, buffer.get(), wanted, &got);
+            if (status.ok() && got == 0) {
+                status = error("The update server returned no data at offset " + std::to_string(offset) + ".");
+            }
+            lock.lock();
+
+            if (!status.ok()) {
+                free_.push_back(std::move(buffer));
+                if (++failures > options_.max_retries) {
+                    status_ = status;
+                    cv_.notify_all();
+                    return;
+                }
+                retries_.fetch_add(1);
+                core::Logger::warn("OTA download failed, retrying in {} ms: {}", delay.count(), status.message());
+                cv_.wait_for(lock, delay, [this] { return stopping_; });
+                delay = std::min(delay * 2, options_.max_retry_delay);
+                continue;
+            }
+            failures = 0;
+            delay = options_.retry_delay;
+            next_ += got;
+            downloaded_.fetch_add(got);
+            filled_.push_back(Chunk{std::move(buffer), got, 0});
+            cv_.notify_all();
+        }
+    }
+
+    OtaSource& source_;
+    const std::string package_;
+    const OtaHandlerOptions& options_;
+    BufferBudget& budget_;
+    std::atomic<uint64_t>& downloaded_;
+    std::atomic<uint64_t>& retries_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Chunk> filled_;
+    std::vector<std::unique_ptr<uint8_t[]>> free_;
+    size_t allocated_ = 0;
+    uint64_t next_;     // Next offset to download
+    const uint64_t size_;
+    uint64_t consumed_; // Next offset to read
+    bool stopping_ = false;
+    core::Status status_;
+};
+
+/**
+ * @brief Collects target bytes into chunks, and hashes, checks and writes
+ *        each full chunk on the thread pool.
+ */
+class ChunkWriter {
+public:
+    ChunkWriter(int fd, uint64_t target_size, uint32_t chunk_size, const std::vector<uint8_t>& hashes,
+                core::ThreadPool& pool, BufferPool& buffers, std::atomic<uint64_t>& verified_bytes,
+                std::atomic<uint64_t>& verified_chunks, uint64_t offset)
+        : fd_(fd), target_size_(target_size), chunk_size_(chunk_size), hashes_(hashes), pool_(pool),
+          buffers_(buffers), verified_bytes_(verified_bytes), verified_chunks_(verified_chunks), offset_(offset) {}
+
+    ~ChunkWriter() {
+        if (buffer_) {
+            buffers_.release(std::move(buffer_));
+        }
+        buffers_.wait_all();
+    }
+
+    // Gets room for the next target bytes, in the current chunk.
+    uint8_t* space(size_t* size) {
+        if (!buffer_) {
+            buffer_ = buffers_.acquire();
+            fill_ = 0;
+            length_ = static_cast<size_t>(std::min<uint64_t>(chunk_size_, target_size_ - offset_));
+        }
+        *size = length_ - fill_;
+        return buffer_.get() + fill_;
+    }
+
+    void commit(size_t size) {
+        fill_ += size;
+        if (fill_ < length_) {
+            return;
+        }
+        const uint64_t index = offset_ / chunk_size_;
+        const uint64_t offset = offset_;
+        const size_t length = length_;
+        offset_ += length_;
+        auto shared = std::make_shared<std::unique_ptr<uint8_t[]>>(std::move(buffer_));
+        pool_.submit([this, shared, index, offset, length] {
+            uint8_t hash[kHashSize];
+            sha256(shared->get(), length, hash);
+            core::Status status;
+            if (std::memcmp(hash, hashes_.data() + index * kHashSize, kHashSize) != 0) {
+                status = error("Chunk " + std::to_string(index) + " of the update does not match its hash.");
+            } else if (!write_fully(fd_, shared->get(), length, offset)) {
+                status = errno_status("Cannot write the staging slot");
+            } else {
+                verified_bytes_.fetch_add(length);
+                verified_chunks_.fetch_add(1);
+            }
+            if (!status.ok()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (status_.ok()) {
+                    status_ = status;
+                }
+            }
+            buffers_.release(std::move(*shared));
+        });
+    }
+
+    // True between chunks, where progress can be saved.
+    bool at_chunk_boundary() const { return !buffer_; }
+
+    uint64_t offset() const { return offset_; }
+
+    // Waits for the chunks in flight; gets the first failure, if any.
+    core::Status drain() {
+        buffers_.wait_all(buffer_ ? 1 : 0);
+        std::lock_guard<std::mutex> lock(mutex_);
+        return status_;
+    }
+
+    core::Status status() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return status_;
+    }
+
+private:
+    const int fd_;
+    const uint64_t target_size_;
+    const uint32_t chunk_size_;
+    const std::vector<uint8_t>& hashes_;
+    core::ThreadPool& pool_;
+    BufferPool& buffers_;
+    std::atomic<uint64_t>& verified_bytes_;
+    std::atomic<uint64_t>& verified_chunks_;
+
+    std::unique_ptr<uint8_t[]> buffer_; // The chunk being filled
+    size_t fill_ = 0;
+    size_t length_ = 0;
+    uint64_t offset_;                   // Of the chunk being filled
+
+    std::mutex mutex_;
+    core::Status status_;
+};
+
+// --- State files ---
+
+struct SlotState {
+    int active = 0;
+    bool pending = false;           // Switched, not confirmed yet
+    bool staged = false;            // The inactive slot holds a verified update
+    std::string staged_root = "-";
+    std::string version[2] = {"-", "-"};
+};
+
+bool parse_state(const std::string& path, SlotState* state) {
+    std::ifstream in(path);
+    std::string magic;
+    int format = 0;
+    if (!(in >> magic >> format) || magic != "ignlink-ota-slots" || format != 1) {
+        return false;
+    }
+    std::string key, active;
+    int pending = 0, staged = 0;
+    if (!(in >> key >> active) || key != "active" || (active != "a" && active != "b") ||
+        !(in >> key >> pending) || key != "pending" || !(in >> key >> staged >> state->staged_root) ||
+        key != "staged" || !(in >> key >> state->version[0]) || key != "version_a" ||
+        !(in >> key >> state->version[1]) || key != "version_b") {
+        return false;
+    }
+    state->active = active == "a" ? 0 : 1;
+    state->pending = pending != 0;
+    state->staged = staged != 0;
+    return true;
+}
+
+bool save_state(const std::string& path, const SlotState& state) {
+    std::ostringstream out;
+    out << "ignlink-ota-slots 1\n"
+        << "active " << (state.active == 0 ? "a" : "b") << "\n"
+        << "pending " << (state.pending ? 1 : 0) << "\n"
+        << "staged " << (state.staged ? 1 : 0) << " " << state.staged_root << "\n"
+        << "version_a " << state.version[0] << "\n"
+        << "version_b " << state.version[1] << "\n";
+    return replace_file(path, out.str());
+}
+
+// Where an interrupted apply() stopped: saved at a chunk boundary, after syncing the staged data.
+struct Checkpoint {
+    uint64_t package_offset = 0;
+    uint64_t target_offset = 0;
+    uint32_t op_kind = 0;           // The op in progress; 0 = between ops
+    uint64_t op_source = 0;
+    uint64_t op_remaining = 0;
+};
+
+bool load_checkpoint(const std::string& path, const std::string& root, Checkpoint* checkpoint) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (!f) {
+        return false;
+    }
+    char file_root[2 * kHashSize + 1] = {};
+    unsigned long long package_offset = 0, target_offset = 0, op_source = 0, op_remaining = 0;
+    unsigned op_kind = 0;
+    const int fields = std::fscanf(f,
+                                   "ignlink-ota-progress 1 root %64s package_offset %llu target_offset %llu "
+                                   "op %u %llu %llu",
+                                   file_root, &package_offset, &target_offset, &op_kind, &op_source, &op_remaining);
+    std::fclose(f);
+    if (fields != 6 || root != file_root) {
+        return false; // Another update; start over.
+    }
+    checkpoint->package_offset = package_offset;
+    checkpoint->target_offset = target_offset;
+    checkpoint->op_kind = op_kind;
+    checkpoint->op_source = op_source;
+    checkpoint->op_remaining = op_remaining;
+    return true;
+}
+
+bool save_checkpoint(const std::string& path, const std::string& root, const Checkpoint& checkpoint) {
+    char text[256];
+    const int length = std::snprintf(text, sizeof(text),
+                                     "ignlink-ota-progress 1 root %s package_offset %llu target_offset %llu "
+                                     "op %u %llu %llu\n",
+                                     root.c_str(), static_cast<unsigned long long>(checkpoint.package_offset),
+                                     static_cast<unsigned long long>(checkpoint.target_offset), checkpoint.op_kind,
+                                     static_cast<unsigned long long>(checkpoint.op_source),
+                                     static_cast<unsigned long long>(checkpoint.op_remaining));
+    return replace_file(path, std::string(text, static_cast<size_t>(length)));
+}
+
+} // namespace
+
+// --- FileOtaSource ---
+
+FileOtaSource::FileOtaSource(std::string directory) : directory_(std::move(directory)) {}
+
+core::Status FileOtaSource::size(const std::string& package, uint64_t* size) {
+    struct stat st;
+    if (::stat((directory_ + "/" + package).c_str(), &st) != 0) {
+        return core::Status(core::Status::Code::NotFound, "Update package '" + package + "': " + std::strerror(errno));
+    }
+    *size = static_cast<uint64_t>(st.st_size);
+    return core::Status::OK();
+}
+
+core::Status FileOtaSource::read(const std::string& package, uint64_t offset, uint8_t* buffer, size_t capacity,
+                                 size_t* bytes) {
+    FileHandle file;
+    file.fd = ::open((directory_ + "/" + package).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file.fd < 0) {
+        return errno_status("Cannot open update package '" + package + "'");
+    }
+    ssize_t n;
+    do {
+        n = ::pread(file.fd, buffer, capacity, static_cast<off_t>(offset));
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return errno_status("Cannot read update package '" + package + "'");
+    }
+    *bytes = static_cast<size_t>(n);
+    return core::Status::OK();
+}
+
+// --- OtaHandler ---
+
+struct OtaHandler::Impl {
+    Impl(std::shared_ptr<OtaSource> s, const OtaHandlerOptions& opts) : source(std::move(s)), options(opts) {}
+
+    std::shared_ptr<OtaSource> source;
+    OtaHandlerOptions options;
+
+    mutable std::mutex mutex; // Guards the slot state and `stream`
+    SlotState state;
+    bool loaded = false;
+    PackageStream* stream = nullptr; // While apply() downloads
+    std::atomic<bool> cancelled{false};
+
+    std::atomic<uint64_t> package_bytes{0};
+    std::atomic<uint64_t> package_size{0};
+    std::atomic<uint64_t> target_bytes{0};
+    std::atomic<uint64_t> target_size{0};
+
+    std::atomic<uint64_t> downloaded_bytes{0};
+    std::atomic<uint64_t> resumed_bytes{0};
+    std::atomic<uint64_t> copied_bytes{0};
+    std::atomic<uint64_t> inserted_bytes{0};
+    std::atomic<uint64_t> chunks_verified{0};
+    std::atomic<uint64_t> retries{0};
+    BufferBudget budget;
+
+    std::string checkpoint_path() const { return options.state_path + ".progress"; }
+    const std::string& path(int slot) const { return slot == 0 ? options.slot_a : options.slot_b; }
+
+    core::Status save_state_locked() {
+        if (!save_state(options.state_path, state)) {
+            return errno_status("Cannot save the OTA slot state '" + options.state_path + "'");
+        }
+        return core::Status::OK();
+    }
+
+    core::Status run(const OtaUpdate& update, const uint8_t* expected_root, int staging);
+    // Makes a stream reachable by cancel() while it exists.
+    struct StreamRegistration {
+        StreamRegistration(Impl& i, PackageStream* s) : impl(i) { impl.set_stream(s); }
+        ~StreamRegistration() { impl.set_stream(nullptr); }
+        Impl& impl;
+    };
+
+    void set_stream(PackageStream* s) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stream = s;
+        if (stream && cancelled.load()) {
+            stream->stop();
+        }
+    }
+};
+
+core::Status OtaHandler::Impl::run(const OtaUpdate& update, const uint8_t* expected_root, int staging) {
+    const std::string root_hex = to_hex(expected_root, kHashSize);
+    uint64_t size = 0;
+    auto status = source->size(update.package, &size);
+    if (!status.ok()) {
+        return status;
+    }
+    if (size < sizeof(PackageHeader)) {
+        return error("Update package '" + update.package + "' is too small.");
+    }
+    package_size.store(size);
+
+    // The header and hash table are always read from the start: they are small.
+    std::unique_ptr<PackageStream> stream(
+        new PackageStream(*source, update.package, 0, size, options, budget, downloaded_bytes, retries));
+    std::unique_ptr<StreamRegistration> registration(new StreamRegistration(*this, stream.get()));
+    PackageHeader header;
+    status = stream->read(&header, sizeof(header));
+    if (!status.ok()) {
+        return status;
+    }
+    if (std::memcmp(header.magic, kPackageMagic, sizeof(kPackageMagic)) != 0 || header.version != kVersion ||
+        header.chunk_size == 0 || header.chunk_size > 64 * 1024 * 1024 || header.target_size == 0) {
+        return error("'" + update.package + "' is not a supported update package.");
+    }
+    if (std::memcmp(header.target_root, expected_root, kHashSize) != 0) {
+        return error("Update package '" + update.package + "' does not produce the expected image.");
+    }
+    const uint64_t chunks = chunk_count(header.target_size, header.chunk_size);
+    const uint64_t table_end = sizeof(header) + chunks * kHashSize;
+    if (table_end > size) {
+        return error("Update package '" + update.package + "' is truncated.");
+    }
+    std::vector<uint8_t> hashes(chunks * kHashSize);
+    status = stream->read(hashes.data(), hashes.size());
+    if (!status.ok()) {
+        return status;
+    }
+    uint8_t root[kHashSize];
+    image_root(header.target_size, header.chunk_size, hashes, root);
+    if (std::memcmp(root, expected_root, kHashSize) != 0) {
+        return error("The hash table of update package '" + update.package + "' is corrupt.");
+    }
+    target_size.store(header.target_size);
+
+    FileHandle installed;
+    if (header.source_size > 0) {
+        installed.fd = ::open(path(1 - staging).c_str(), O_RDONLY | O_CLOEXEC);
+        uint64_t installed_size = 0;
+        if (installed.fd < 0 || !image_size(installed.fd, &installed_size)) {
+            return errno_status("Cannot open the installed image '" + path(1 - staging) + "'");
+        }
+        if (installed_size < header.source_size) {
+            return error("The installed image is not the source of update '" + update.package + "'.");
+        }
+    }
+
+    core::ThreadPool pool(std::max<size_t>(1, options.hash_threads));
+    BufferPool chunk_buffers(header.chunk_size, std::max<size_t>(1, options.max_chunks_in_flight) + 1, budget);
+    Checkpoint checkpoint;
+    const bool resumed = load_checkpoint(checkpoint_path(), root_hex, &checkpoint) &&
+                         checkpoint.target_offset % header.chunk_size == 0 &&
+                         checkpoint.target_offset <= header.target_size && checkpoint.package_offset >= table_end &&
+                         checkpoint.package_offset <= size;
+    if (resumed) {
+        core::Logger::info("Resuming OTA update '{}' at {} of {} bytes.", update.version, checkpoint.target_offset,
+                           header.target_size);
+        resumed_bytes.store(checkpoint.package_offset - table_end);
+        registration.reset();
+        stream.reset(new PackageStream(*source, update.package, checkpoint.package_offset, size, options, budget,
+                                       downloaded_bytes, retries));
+        registration.reset(new StreamRegistration(*this, stream.get()));
+    } else {
+        checkpoint = Checkpoint();
+        checkpoint.package_offset = table_end;
+        if (header.source_size > 0) {
+            // Copy ops trust the installed image: check it is the one the package was made from.
+            std::vector<uint8_t> source_hashes;
+            status = hash_image(installed.fd, header.source_size, header.chunk_size, pool, chunk_buffers,
+                                &source_hashes);
+            if (!status.ok()) {
+                return status;
+            }
+            image_root(header.source_size, header.chunk_size, source_hashes, root);
+            if (std::memcmp(root, header.source_root, kHashSize) != 0) {
+                return error("The installed image is not the source of update '" + update.package + "'.");
+            }
+        }
+    }
+    package_bytes.store(checkpoint.package_offset);
+    target_bytes.store(checkpoint.target_offset);
+
+    FileHandle staged;
+    staged.fd = ::open(path(staging).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    uint64_t staging_size = 0;
+    struct stat st;
+    if (staged.fd < 0 || !image_size(staged.fd, &staging_size) || ::fstat(staged.fd, &st) != 0) {
+        return errno_status("Cannot open the staging slot '" + path(staging) + "'");
+    }
+    if (S_ISREG(st.st_mode)) {
+        if (::ftruncate(staged.fd, static_cast<off_t>(header.target_size)) != 0) {
+            return errno_status("Cannot size the staging slot '" + path(staging) + "'");
+        }
+    } else if (staging_size < header.target_size) {
+        return error("The update does not fit in the staging slot '" + path(staging) + "'.");
+    }
+
+    // The pipeline: ops from the download, through chunk buffers, to the pool that hashes and writes them.
+    std::atomic<uint64_t> verified{checkpoint.target_offset};
+    ChunkWriter writer(staged.fd, header.target_size, header.chunk_size, hashes, pool, chunk_buffers, verified,
+                       chunks_verified, checkpoint.target_offset);
+    OpHeader op{checkpoint.op_kind, 0, checkpoint.op_source, checkpoint.op_remaining};
+    if (op.kind != static_cast<uint32_t>(OpKind::Copy) && op.kind != static_cast<uint32_t>(OpKind::Insert)) {
+        op.length = 0;
+    }
+    uint64_t produced = checkpoint.target_offset; // Including the chunk being filled
+    uint64_t last_checkpoint = produced;
+
+    while (true) {
+        target_bytes.store(verified.load());
+        if (writer.at_chunk_boundary() && produced - last_checkpoint >= options.checkpoint_bytes) {
+            // Progress is only saved once everything before it is verified and on disk.
+            status = writer.drain();
+            if (!status.ok()) {
+                return status;
+            }
+            if (::fdatasync(staged.fd) != 0) {
+                return errno_status("Cannot sync the staging slot");
+            }
+            checkpoint.package_offset = stream->offset();
+            checkpoint.target_offset = produced;
+            checkpoint.op_kind = op.length > 0 ? op.kind : 0;
+            checkpoint.op_source = op.source_offset;
+            checkpoint.op_remaining = op.length;
+            if (!save_checkpoint(checkpoint_path(), root_hex, checkpoint)) {
+                core::Logger::warn("Cannot save OTA progress: {}", std::strerror(errno));
+            }
+            last_checkpoint = produced;
+        }
+
+        if (op.length == 0) {
+            status = stream->read(&op, sizeof(op));
+            if (!status.ok()) {
+                return status;
+            }
+            package_bytes.store(stream->offset());
+            const auto kind = static_cast<OpKind>(op.kind);
+            if (kind == OpKind::End) {
+                break;
+            }
+            if ((kind != OpKind::Copy && kind != OpKind::Insert) || op.length > header.target_size - produced ||
+                (kind == OpKind::Copy && (op.source_offset > header.source_size ||
+                                          op.length > header.source_size - op.source_offset))) {
+                return error("Update package '" + update.package + "' has an invalid op.");
+            }
+            continue;
+        }
+
+        size_t room = 0;
+        uint8_t* out = writer.space(&room);
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(room, op.length));
+        if (static_cast<OpKind>(op.kind) == OpKind::Copy) {
+            if (!read_fully(installed.fd, out, n, op.source_offset)) {
+                return errno_status("Cannot read the installed image");
+            }
+            op.source_offset += n;
+            copied_bytes.fetch_add(n);
+        } else {
+            status = stream->read(out, n);
+            if (!status.ok()) {
+                return status;
+            }
+            package_bytes.store(stream->offset());
+            inserted_bytes.fetch_add(n);
+        }
+        op.length -= n;
+        produced += n;
+        writer.commit(n);
+
+        // Stop at the first bad chunk instead of downloading the rest.
+        if (writer.at_chunk_boundary()) {
+            status = writer.status();
+            if (!status.ok()) {
+                return status;
+            }
+        }
+    }
+
+    status = writer.drain();
+    if (!status.ok()) {
+        return status;
+    }
+    if (produced != header.target_size || verified.load() != header.target_size) {
+        return error("Update package '" + update.package + "' ends before the image does.");
+    }
+    if (::fsync(staged.fd) != 0) {
+        return errno_status("Cannot sync the staging slot");
+    }
+    target_bytes.store(verified.load());
+    return core::Status::OK();
+}
+
+OtaHandler::OtaHandler(std::shared_ptr<OtaSource> source, const OtaHandlerOptions& options)
+    : pimpl_(std::make_unique<Impl>(std::move(source), options)) {}
+
+OtaHandler::~OtaHandler() = default;
+
+core::Status OtaHandler::load() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    if (pimpl_->options.slot_a.empty() || pimpl_->options.slot_b.empty() || pimpl_->options.state_path.empty()) {
+        return core::Status(core::Status::Code::InvalidArgument, "OTA slots and state path must be set.");
+    }
+    struct stat st;
+    if (::stat(pimpl_->options.state_path.c_str(), &st) != 0 && errno == ENOENT) {
+        pimpl_->state = SlotState();
+        auto status = pimpl_->save_state_locked();
+        pimpl_->loaded = status.ok();
+        return status;
+    }
+    if (!parse_state(pimpl_->options.state_path, &pimpl_->state)) {
+        return error("Cannot read the OTA slot state '" + pimpl_->options.state_path + "'.");
+    }
+    pimpl_->loaded = true;
+    return core::Status::OK();
+}
+
+core::Status OtaHandler::apply(const OtaUpdate& update) {
+    uint8_t expected_root[kHashSize];
+    if (!from_hex(update.target_root, expected_root, kHashSize)) {
+        return core::Status(core::Status::Code::InvalidArgument, "The update's target root is not a SHA-256 hash.");
+    }
+    if (update.version.empty() ||
+        std::any_of(update.version.begin(), update.version.end(),
+                    [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; })) {
+        return core::Status(core::Status::Code::InvalidArgument, "Invalid update version '" + update.version + "'.");
+    }
+
+    int staging = 0;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        if (!pimpl_->loaded) {
+            return error("Load the OTA slot state before applying an update.");
+        }
+        if (pimpl_->state.pending) {
+            return error("Confirm or roll back the current slot before the next update.");
+        }
+        staging = 1 - pimpl_->state.active;
+        if (pimpl_->state.staged && pimpl_->state.staged_root == update.target_root) {
+            return core::Status::OK(); // Already staged
+        }
+        if (pimpl_->state.staged) {
+            // The staging slot is about to be overwritten.
+            pimpl_->state.staged = false;
+            pimpl_->state.staged_root = "-";
+            auto status = pimpl_->save_state_locked();
+            if (!status.ok()) {
+                return status;
+            }
+        }
+    }
+
+    pimpl_->cancelled.store(false);
+    pimpl_->downloaded_bytes.store(0);
+    pimpl_->resumed_bytes.store(0);
+    pimpl_->copied_bytes.store(0);
+    pimpl_->inserted_bytes.store(0);
+    pimpl_->chunks_verified.store(0);
+    pimpl_->retries.store(0);
+    pimpl_->budget.peak.store(0);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto status = pimpl_->run(update, expected_root, staging);
+    if (!status.ok()) {
+        core::Logger::error("OTA update '{}' failed: {}", update.version, status.message());
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->state.staged = true;
+    pimpl_->state.staged_root = to_hex(expected_root, kHashSize);
+    pimpl_->state.version[staging] = update.version;
+    status = pimpl_->save_state_locked();
+    if (!status.ok()) {
+        return status;
+    }
+    std::remove(pimpl_->checkpoint_path().c_str());
+    core::Logger::info("OTA update '{}' staged in slot {} ({} bytes downloaded, {} ms).", update.version,
+                       staging == 0 ? "A" : "B", pimpl_->downloaded_bytes.load(),
+                       std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                           .count());
+    return core::Status::OK();
+}
+
+void OtaHandler::cancel() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->cancelled.store(true);
+    if (pimpl_->stream) {
+        pimpl_->stream->stop();
+    }
+}
+
+core::Status OtaHandler::switch_slot() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    if (!pimpl_->state.staged) {
+        return error("No verified update is staged.");
+    }
+    SlotState previous = pimpl_->state;
+    pimpl_->state.active = 1 - pimpl_->state.active;
+    pimpl_->state.pending = true;
+    pimpl_->state.staged = false;
+    pimpl_->state.staged_root = "-";
+    auto status = pimpl_->save_state_locked();
+    if (!status.ok()) {
+        pimpl_->state = previous;
+        return status;
+    }
+    core::Logger::info("OTA: slot {} is now active, pending confirmation.", pimpl_->state.active == 0 ? "A" : "B");
+    return core::Status::OK();
+}
+
+core::Status OtaHandler::confirm() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    if (!pimpl_->state.pending) {
+        return core::Status::OK();
+    }
+    pimpl_->state.pending = false;
+    auto status = pimpl_->save_state_locked();
+    if (!status.ok()) {
+        pimpl_->state.pending = true;
+    }
+    return status;
+}
+
+core::Status OtaHandler::rollback() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    if (!pimpl_->state.pending) {
+        return error("The active slot is confirmed; there is nothing to roll back.");
+    }
+    SlotState previous = pimpl_->state;
+    pimpl_->state.active = 1 - pimpl_->state.active;
+    pimpl_->state.pending = false;
+    auto status = pimpl_->save_state_locked();
+    if (!status.ok()) {
+        pimpl_->state = previous;
+        return status;
+    }
+    core::Logger::warn("OTA: rolled back to slot {}.", pimpl_->state.active == 0 ? "A" : "B");
+    return core::Status::OK();
+}
+
+OtaHandler::Slot OtaHandler::active_slot() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->state.active == 0 ? Slot::A : Slot::B;
+}
+
+const std::string& OtaHandler::slot_path(Slot slot) const {
+    return pimpl_->path(static_cast<int>(slot));
+}
+
+std::string OtaHandler::slot_version(Slot slot) const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    const std::string& version = pimpl_->state.version[static_cast<int>(slot)];
+    return version == "-" ? std::string() : version;
+}
+
+bool OtaHandler::staged() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->state.staged;
+}
+
+bool OtaHandler::pending() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->state.pending;
+}
+
+OtaHandler::Progress OtaHandler::progress() const {
+    Progress progress;
+    progress.package_bytes = pimpl_->package_bytes.load();
+    progress.package_size = pimpl_->package_size.load();
+    progress.target_bytes = pimpl_->target_bytes.load();
+    progress.target_size = pimpl_->target_size.load();
+    return progress;
+}
+
+OtaHandler::Stats OtaHandler::stats() const {
+    Stats stats;
+    stats.downloaded_bytes = pimpl_->downloaded_bytes.load();
+    stats.resumed_bytes = pimpl_->resumed_bytes.load();
+    stats.copied_bytes = pimpl_->copied_bytes.load();
+    stats.inserted_bytes = pimpl_->inserted_bytes.load();
+    stats.chunks_verified = pimpl_->chunks_verified.load();
+    stats.retries = pimpl_->retries.load();
+    stats.peak_buffer_bytes = pimpl_->budget.peak.load();
+    return stats;
+}
+
+// --- Package creation ---
+
+namespace {
+
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    ~MappedFile() {
+        if (data) {
+            ::munmap(const_cast<uint8_t*>(data), size);
+        }
+    }
+
+    core::Status open(const std::string& path) {
+        FileHandle file;
+        file.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (file.fd < 0 || ::fstat(file.fd, &st) != 0) {
+            return errno_status("Cannot open '" + path + "'");
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            return core::Status::OK();
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+        if (p == MAP_FAILED) {
+            return errno_status("Cannot map '" + path + "'");
+        }
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        data = static_cast<const uint8_t*>(p);
+        return core::Status::OK();
+    }
+};
+
+std::vector<uint8_t> chunk_hashes(const MappedFile& file, uint32_t chunk_size) {
+    const uint64_t chunks = chunk_count(file.size, chunk_size);
+    std::vector<uint8_t> hashes(chunks * kHashSize);
+    for (uint64_t i = 0; i < chunks; ++i) {
+        const size_t length = static_cast<size_t>(std::min<uint64_t>(chunk_size, file.size - i * chunk_size));
+        sha256(file.data + i * chunk_size, length, hashes.data() + i * kHashSize);
+    }
+    return hashes;
+}
+
+// Writes ops, merging a Copy that continues the previous one.
+class OpWriter {
+public:
+    explicit OpWriter(FILE* out) : out_(out) {}
+
+    void copy(uint64_t source_offset, uint64_t length) {
+        if (pending_.length > 0 && pending_.source_offset + pending_.length == source_offset) {
+            pending_.length += length;
+            return;
+        }
+        flush();
+        pending_ = OpHeader{static_cast<uint32_t>(OpKind::Copy), 0, source_offset, length};
+    }
+
+    void insert(const uint8_t* data, uint64_t length) {
+        if (length == 0) {
+            return;
+        }
+        flush();
+        const OpHeader op{static_cast<uint32_t>(OpKind::Insert), 0, 0, length};
+        ok_ = ok_ && std::fwrite(&op, sizeof(op), 1, out_) == 1 &&
+              std::fwrite(data, 1, static_cast<size_t>(length), out_) == length;
+    }
+
+    bool end() {
+        flush();
+        const OpHeader op{static_cast<uint32_t>(OpKind::End), 0, 0, 0};
+        ok_ = ok_ && std::fwrite(&op, sizeof(op), 1, out_) == 1;
+        return ok_;
+    }
+
+private:
+    void flush() {
+        if (pending_.length > 0) {
+            ok_ = ok_ && std::fwrite(&pending_, sizeof(pending_), 1, out_) == 1;
+            pending_.length = 0;
+        }
+    }
+
+    FILE* out_;
+    OpHeader pending_{0, 0, 0, 0};
+    bool ok_ = true;
+};
+
+constexpr uint64_t kRollingBase = 0x100000001b3ULL;
+
+} // namespace
+
+core::Status create_ota_package(const std::string& source_path, const std::string& target_path,
+                                const std::string& package_path, const OtaPackageOptions& options,
+                                std::string* target_root) {
+    if (options.chunk_size == 0 || options.block_size < 16) {
+        return core::Status(core::Status::Code::InvalidArgument, "Invalid OTA package options.");
+    }
+    MappedFile source, target;
+    auto status = target.open(target_path);
+    if (!status.ok()) {
+        return status;
+    }
+    if (target.size == 0) {
+        return core::Status(core::Status::Code::InvalidArgument, "The target image is empty.");
+    }
+    if (!source_path.empty()) {
+        status = source.open(source_path);
+        if (!status.ok()) {
+            return status;
+        }
+    }
+
+    PackageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kPackageMagic, sizeof(kPackageMagic));
+    header.version = kVersion;
+    header.chunk_size = options.chunk_size;
+    header.source_size = source.size;
+    header.target_size = target.size;
+    const std::vector<uint8_t> target_hashes = chunk_hashes(target, options.chunk_size);
+    image_root(target.size, options.chunk_size, target_hashes, header.target_root);
+    if (source.size > 0) {
+        image_root(source.size, options.chunk_size, chunk_hashes(source, options.chunk_size), header.source_root);
+    }
+
+    FILE* out = std::fopen(package_path.c_str(), "wb");
+    if (!out) {
+        return errno_status("Cannot create '" + package_path + "'");
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1 &&
+              std::fwrite(target_hashes.data(), 1, target_hashes.size(), out) == target_hashes.size();
+    OpWriter ops(out);
+
+    const size_t block = options.block_size;
+    if (source.size < block || target.size < block) {
+        ops.insert(target.data, target.size);
+    } else {
+        // Index the source's aligned blocks by rolling hash, behind a bit filter
+        // that rejects most target positions before the hash map is consulted.
+        uint64_t top = 1; // kRollingBase^(block - 1)
+        for (size_t i = 1; i < block; ++i) {
+            top *= kRollingBase;
+        }
+        auto hash_block = [&](const uint8_t* p) {
+            uint64_t h = 0;
+            for (size_t i = 0; i < block; ++i) {
+                h = h * kRollingBase + p[i];
+            }
+            return h;
+        };
+        const size_t filter_bits = size_t(1) << 24;
+        std::vector<uint64_t> filter(filter_bits / 64, 0);
+        auto filter_slot = [&](uint64_t h) { return static_cast<size_t>(h >> 40) & (filter_bits - 1); };
+        std::unordered_map<uint64_t, uint64_t> index;
+        index.reserve(source.size / block);
+        for (uint64_t offset = 0; offset + block <= source.size; offset += block) {
+            const uint64_t h = hash_block(source.data + offset);
+            if (index.emplace(h, offset).second) {
+                filter[filter_slot(h) / 64] |= uint64_t(1) << (filter_slot(h) % 64);
+            }
+        }
+
+        size_t position = 0, insert_start = 0;
+        uint64_t h = hash_block(target.data);
+        while (position + block <= target.size) {
+            const size_t slot = filter_slot(h);
+            if (filter[slot / 64] & (uint64_t(1) << (slot % 64))) {
+                auto it = index.find(h);
+                if (it != index.end() && std::memcmp(target.data + position, source.data + it->second, block) == 0) {
+                    size_t length = block;
+                    while (position + length < target.size && it->second + length < source.size &&
+                           target.data[position + length] == source.data[it->second + length]) {
+                        ++length;
+                    }
+                    ops.insert(target.data + insert_start, position - insert_start);
+                    ops.copy(it->second, length);
+                    position += length;
+                    insert_start = position;
+                    if (position + block <= target.size) {
+                        h = hash_block(target.data + position);
+                    }
+                    continue;
+                }
+            }
+            if (position + block < target.size) {
+                h = (h - target.data[position] * top) * kRollingBase + target.data[position + block];
+            }
+            ++position;
+        }
+        ops.insert(target.data + insert_start, target.size - insert_start);
+    }
+    ok = ops.end() && ok;
+    ok = ok && std::fflush(out) == 0 && ::fsync(::fileno(out)) == 0;
+    if (std::fclose(out) != 0 || !ok) {
+        return errno_status("Cannot write '" + package_path + "'");
+    }
+    if (target_root) {
+        *target_root = to_hex(header.target_root, kHashSize);
+    }
+    return core::Status::OK();
+}
+
+} // namespace fleet
+} // namespace ignlink
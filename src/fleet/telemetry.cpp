@@ -0,0 +1,593 @@
+#include <ignlink/fleet/telemetry.h>
+#include <ignlink/fleet/client.h>
+#include <ignlink/core/logger.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+
+namespace ignlink {
+namespace fleet {
+
+namespace {
+
+std::atomic<uint64_t> g_next_registry_uid{1};
+
+constexpr uint8_t kBatchVersion = 1;
+
+/**
+ * @brief The slots a thread owns, in every registry it has recorded into.
+ *
+ * Marks them dead when the thread exits; the next `collect()` then folds
+ * their totals into the registry and frees them.
+ */
+struct ThreadSlotsHolder {
+    std::vector<std::pair<uint64_t, std::shared_ptr<detail::ThreadSlots>>> slots; // By registry UID
+
+    ~ThreadSlotsHolder() {
+        for (auto& entry : slots) {
+            entry.second->alive.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadSlotsHolder t_slots_holder;
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& data, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        const uint8_t byte = *data++;
+        result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void add_histogram(MetricsRegistry::HistogramSnapshot& total, const detail::HistogramSlots& slots) {
+    if (total.buckets.empty()) {
+        total.buckets.assign(detail::kHistogramBuckets, 0);
+    }
+    total.count += slots.count.load(std::memory_order_relaxed);
+    total.sum += slots.sum.load(std::memory_order_relaxed);
+    for (size_t b = 0; b < detail::kHistogramBuckets; ++b) {
+        total.buckets[b] += slots.buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+// --- MetricsRegistry ---
+
+uint64_t MetricsRegistry::HistogramSnapshot::percentile(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    const double clamped = std::min(std::max(p, 0.0), 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        seen += buckets[b];
+        if (seen >= rank) {
+            return detail::histogram_bucket_lower_bound(b);
+        }
+    }
+    return detail::histogram_bucket_lower_bound(buckets.size() - 1);
+}
+
+MetricsRegistry::MetricsRegistry()
+    : uid_(g_next_registry_uid.fetch_add(1)), gauges_(std::make_unique<detail::GaugeSlot[]>(detail::kMaxGauges)) {}
+
+MetricsRegistry::~MetricsRegistry() = default;
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+int MetricsRegistry::register_metric(const std::string& name, Kind kind, uint32_t limit) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_name_.find(name);
+    if (it != by_name_.end()) {
+        const MetricInfo& info = metrics_[it->second];
+        if (info.kind != kind) {
+            core::Logger::error("Metric '{}' is already registered as another kind.", name);
+            return -1;
+        }
+        return static_cast<int>(info.id);
+    }
+    uint32_t& count = counts_[static_cast<size_t>(kind)];
+    if (count == limit) {
+        core::Logger::error("Cannot register metric '{}': the registry is full ({} of its kind).", name, limit);
+        return -1;
+    }
+    by_name_.emplace(name, metrics_.size());
+    metrics_.push_back(MetricInfo{count, kind, name});
+    return static_cast<int>(count++);
+}
+
+Counter MetricsRegistry::counter(const std::string& name) {
+    const int id = register_metric(name, Kind::Counter, detail::kMaxCounters);
+    return id < 0 ? Counter() : Counter(this, static_cast<uint32_t>(id));
+}
+
+Gauge MetricsRegistry::gauge(const std::string& name) {
+    const int id = register_metric(name, Kind::Gauge, detail::kMaxGauges);
+    return id < 0 ? Gauge() : Gauge(&gauges_[static_cast<size_t>(id)]);
+}
+
+Histogram MetricsRegistry::histogram(const std::string& name) {
+    const int id = register_metric(name, Kind::Histogram, detail::kMaxHistograms);
+    return id < 0 ? Histogram() : Histogram(this, static_cast<uint32_t>(id));
+}
+
+std::vector<MetricsRegistry::MetricInfo> MetricsRegistry::metrics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metrics_;
+}
+
+detail::ThreadSlots& MetricsRegistry::register_thread() {
+    // The thread may have alternated with another registry since it last came here.
+    for (const auto& entry : t_slots_holder.slots) {
+        if (entry.first == uid_) {
+            return *entry.second;
+        }
+    }
+    auto slots = std::make_shared<detail::ThreadSlots>();
+    t_slots_holder.slots.emplace_back(uid_, slots);
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(slots);
+    return *slots;
+}
+
+detail::HistogramSlots& MetricsRegistry::add_histogram_slots(detail::ThreadSlots& slots, uint32_t id) {
+    auto* histogram = new detail::HistogramSlots();
+    slots.histograms[id].store(histogram, std::memory_order_release);
+    return *histogram;
+}
+
+MetricsRegistry::Snapshot MetricsRegistry::collect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot;
+    snapshot.time_ns = core::MonotonicClock::now_ns();
+    const uint32_t counters = counts_[static_cast<size_t>(Kind::Counter)];
+    const uint32_t gauges = counts_[static_cast<size_t>(Kind::Gauge)];
+    const uint32_t histograms = counts_[static_cast<size_t>(Kind::Histogram)];
+    retired_counters_.resize(counters, 0);
+    retired_histograms_.resize(histograms);
+
+    // Dead threads wrote their last values before clearing `alive`; fold them
+    // into the retired totals once and for all.
+    auto dead = std::partition(threads_.begin(), threads_.end(), [](const std::shared_ptr<detail::ThreadSlots>& slots) {
+        return slots->alive.load(std::memory_order_acquire);
+    });
+    for (auto it = dead; it != threads_.end(); ++it) {
+        const detail::ThreadSlots& slots = **it;
+        for (uint32_t i = 0; i < counters; ++i) {
+            retired_counters_[i] += slots.counters[i].load(std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < histograms; ++i) {
+            if (const auto* histogram = slots.histograms[i].load(std::memory_order_acquire)) {
+                add_histogram(retired_histograms_[i], *histogram);
+            }
+        }
+    }
+    threads_.erase(dead, threads_.end());
+
+    snapshot.counters = retired_counters_;
+    snapshot.histograms = retired_histograms_;
+    for (const auto& slots : threads_) {
+        for (uint32_t i = 0; i < counters; ++i) {
+            snapshot.counters[i] += slots->counters[i].load(std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < histograms; ++i) {
+            if (const auto* histogram = slots->histograms[i].load(std::memory_order_acquire)) {
+                add_histogram(snapshot.histograms[i], *histogram);
+            }
+        }
+    }
+    snapshot.gauges.resize(gauges);
+    for (uint32_t i = 0; i < gauges; ++i) {
+        snapshot.gauges[i] = gauges_[i].value.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+// --- Batch format ---
+//
+// All integers are LEB128 varints unless noted.
+//
+//   batch:      u8 version, sequence, record count, record...
+//   record:     time delta (ns since the previous record in the batch; the
+//               first record has the absolute MonotonicClock time),
+//               definition count, definition...,
+//               counter count, counter..., gauge count, gauge...,
+//               histogram count, histogram...
+//   definition: u8 kind, ID, name length, name bytes
+//   counter:    ID gap, increase
+//   gauge:      ID gap, zigzag value
+//   histogram:  ID gap, count increase, sum increase, bucket count,
+//               (bucket gap, bucket increase)...
+//
+// An ID (or bucket) gap is the distance from the previous ID in the list
+// plus one, so consecutive IDs cost one byte of zero. Counters and
+// histograms carry increases since the previous record, gauges their value.
+
+bool TelemetryDecoder::apply_record(State& state, const uint8_t*& data, const uint8_t* end) {
+    uint64_t value = 0;
+    if (!get_varint(data, end, &value)) {
+        return false;
+    }
+
+    uint64_t count = 0;
+    if (!get_varint(data, end, &count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t id = 0, length = 0;
+        if (data >= end) {
+            return false;
+        }
+        const uint8_t kind = *data++;
+        if (kind < 1 || kind > 3 || !get_varint(data, end, &id) || !get_varint(data, end, &length) ||
+            length > static_cast<uint64_t>(end - data)) {
+            return false;
+        }
+        state.ids[kind][std::string(reinterpret_cast<const char*>(data), length)] = static_cast<uint32_t>(id);
+        data += length;
+    }
+
+    auto read_ids = [&](uint64_t limit, auto&& read_value) {
+        uint64_t entries = 0;
+        if (!get_varint(data, end, &entries)) {
+            return false;
+        }
+        uint64_t next = 0;
+        for (uint64_t i = 0; i < entries; ++i) {
+            uint64_t gap = 0;
+            if (!get_varint(data, end, &gap) || next + gap >= limit) {
+                return false;
+            }
+            next += gap;
+            if (!read_value(next)) {
+                return false;
+            }
+            ++next;
+        }
+        return true;
+    };
+
+    const bool ok =
+        read_ids(detail::kMaxCounters,
+                 [&](uint64_t id) {
+                     if (!get_varint(data, end, &value)) {
+                         return false;
+                     }
+                     if (state.counters.size() <= id) {
+                         state.counters.resize(id + 1, 0);
+                     }
+                     state.counters[id] += value;
+                     return true;
+                 }) &&
+        read_ids(detail::kMaxGauges,
+                 [&](uint64_t id) {
+                     if (!get_varint(data, end, &value)) {
+                         return false;
+                     }
+                     if (state.gauges.size() <= id) {
+                         state.gauges.resize(id + 1, 0);
+                     }
+                     state.gauges[id] = unzigzag(value);
+                     return true;
+                 }) &&
+        read_ids(detail::kMaxHistograms, [&](uint64_t id) {
+            if (state.histograms.size() <= id) {
+                state.histograms.resize(id + 1);
+            }
+            auto& histogram = state.histograms[id];
+            if (histogram.buckets.empty()) {
+                histogram.buckets.assign(detail::kHistogramBuckets, 0);
+            }
+            uint64_t count_delta = 0, sum_delta = 0, buckets = 0;
+            if (!get_varint(data, end, &count_delta) || !get_varint(data, end, &sum_delta) ||
+                !get_varint(data, end, &buckets)) {
+                return false;
+            }
+            histogram.count += count_delta;
+            histogram.sum += sum_delta;
+            uint64_t next = 0;
+            for (uint64_t b = 0; b < buckets; ++b) {
+                uint64_t gap = 0;
+                if (!get_varint(data, end, &gap) || next + gap >= detail::kHistogramBuckets ||
+                    !get_varint(data, end, &value)) {
+                    return false;
+                }
+                next += gap;
+                histogram.buckets[next++] += value;
+            }
+            return true;
+        });
+    if (ok) {
+        ++state.records;
+    }
+    return ok;
+}
+
+bool TelemetryDecoder::apply(const uint8_t* data, size_t size) {
+    const uint8_t* end = data + size;
+    uint64_t sequence = 0, records = 0;
+    if (size == 0 || *data++ != kBatchVersion || !get_varint(data, end, &sequence) ||
+        !get_varint(data, end, &records)) {
+        return false;
+    }
+    // Decoded into a copy, so that a malformed batch changes nothing.
+    State state = state_;
+    for (uint64_t i = 0; i < records; ++i) {
+        if (!apply_record(state, data, end)) {
+            return false;
+        }
+    }
+    if (data != end) {
+        return false;
+    }
+    state_ = std::move(state);
+    return true;
+}
+
+const uint32_t* TelemetryDecoder::find(MetricsRegistry::Kind kind, const std::string& name) const {
+    const auto& ids = state_.ids[static_cast<size_t>(kind)];
+    auto it = ids.find(name);
+    return it == ids.end() ? nullptr : &it->second;
+}
+
+uint64_t TelemetryDecoder::counter(const std::string& name) const {
+    const uint32_t* id = find(MetricsRegistry::Kind::Counter, name);
+    return id && *id < state_.counters.size() ? state_.counters[*id] : 0;
+}
+
+int64_t TelemetryDecoder::gauge(const std::string& name) const {
+    const uint32_t* id = find(MetricsRegistry::Kind::Gauge, name);
+    return id && *id < state_.gauges.size() ? state_.gauges[*id] : 0;
+}
+
+MetricsRegistry::HistogramSnapshot TelemetryDecoder::histogram(const std::string& name) const {
+    const uint32_t* id = find(MetricsRegistry::Kind::Histogram, name);
+    return id && *id < state_.histograms.size() ? state_.histograms[*id] : MetricsRegistry::HistogramSnapshot();
+}
+
+// --- TelemetryCollector ---
+
+struct TelemetryCollector::Impl {
+    Impl(MetricsRegistry& r, BatchSink s, const TelemetryOptions& opts)
+        : registry(r), sink(std::move(s)), options(opts) {}
+
+    MetricsRegistry& registry;
+    BatchSink sink;
+    TelemetryOptions options;
+
+    std::thread thread;
+    std::mutex thread_mutex;
+    std::condition_variable cv;
+    bool running = false;
+
+    // Encoder state, under `mutex`.
+    std::mutex mutex;
+    MetricsRegistry::Snapshot previous;
+    size_t definitions_sent = 0; // Prefix of registry.metrics() the backend knows
+    bool resend_definitions = false;
+    std::vector<uint8_t> records;
+    uint64_t record_count = 0;
+    int64_t last_record_ns = 0;
+    int64_t batch_start_ns = 0;
+    uint64_t sequence = 0;
+    Stats stats;
+
+    void collect_locked();
+    void flush_locked();
+    void run();
+};
+
+void TelemetryCollector::Impl::collect_locked() {
+    MetricsRegistry::Snapshot snapshot = registry.collect();
+    const auto metrics = registry.metrics();
+
+    if (record_count == 0) {
+        batch_start_ns = snapshot.time_ns;
+        put_varint(records, static_cast<uint64_t>(snapshot.time_ns));
+    } else {
+        put_varint(records, static_cast<uint64_t>(std::max<int64_t>(0, snapshot.time_ns - last_record_ns)));
+    }
+    last_record_ns = snapshot.time_ns;
+
+    const size_t first_definition = resend_definitions ? 0 : definitions_sent;
+    resend_definitions = false;
+    put_varint(records, metrics.size() - std::min(first_definition, metrics.size()));
+    for (size_t i = first_definition; i < metrics.size(); ++i) {
+        records.push_back(static_cast<uint8_t>(metrics[i].kind));
+        put_varint(records, metrics[i].id);
+        put_varint(records, metrics[i].name.size());
+        records.insert(records.end(), metrics[i].name.begin(), metrics[i].name.end());
+    }
+    definitions_sent = metrics.size();
+
+    // Entries are written to a scratch list first, as their count precedes them.
+    std::vector<uint8_t> entries;
+    auto put_list = [&](size_t size, auto&& changed, auto&& put_value) {
+        entries.clear();
+        uint64_t count = 0, next = 0;
+        for (size_t id = 0; id < size; ++id) {
+            if (!changed(id)) {
+                continue;
+            }
+            put_varint(entries, id - next);
+            put_value(id);
+            next = id + 1;
+            ++count;
+        }
+        put_varint(records, count);
+        records.insert(records.end(), entries.begin(), entries.end());
+    };
+
+    auto previous_counter = [&](size_t id) { return id < previous.counters.size() ? previous.counters[id] : 0; };
+    put_list(
+        snapshot.counters.size(), [&](size_t id) { return snapshot.counters[id] != previous_counter(id); },
+        [&](size_t id) { put_varint(entries, snapshot.counters[id] - previous_counter(id)); });
+
+    put_list(
+        snapshot.gauges.size(),
+        [&](size_t id) { return id >= previous.gauges.size() || snapshot.gauges[id] != previous.gauges[id]; },
+        [&](size_t id) { put_varint(entries, zigzag(snapshot.gauges[id])); });
+
+    const MetricsRegistry::HistogramSnapshot empty;
+    auto previous_histogram = [&](size_t id) -> const MetricsRegistry::HistogramSnapshot& {
+        return id < previous.histograms.size() ? previous.histograms[id] : empty;
+    };
+    put_list(
+        snapshot.histograms.size(),
+        [&](size_t id) { return snapshot.histograms[id].count != previous_histogram(id).count; },
+        [&](size_t id) {
+            const auto& now = snapshot.histograms[id];
+            const auto& before = previous_histogram(id);
+            put_varint(entries, now.count - before.count);
+            put_varint(entries, now.sum - before.sum);
+            auto bucket_delta = [&](size_t b) { return now.buckets[b] - (before.buckets.empty() ? 0 : before.buckets[b]); };
+            uint64_t changed = 0;
+            for (size_t b = 0; b < now.buckets.size(); ++b) {
+                changed += bucket_delta(b) != 0;
+            }
+            put_varint(entries, changed);
+            uint64_t next = 0;
+            for (size_t b = 0; b < now.buckets.size(); ++b) {
+                if (const uint64_t delta = bucket_delta(b)) {
+                    put_varint(entries, b - next);
+                    put_varint(entries, delta);
+                    next = b + 1;
+                }
+            }
+        });
+
+    previous = std::move(snapshot);
+    ++record_count;
+    ++stats.records;
+
+    const auto batch_age = std::chrono::nanoseconds(last_record_ns - batch_start_ns);
+    if (records.size() >= options.max_batch_bytes || batch_age >= options.batch_interval) {
+        flush_locked();
+    }
+}
+
+void TelemetryCollector::Impl::flush_locked() {
+    if (record_count == 0) {
+        return;
+    }
+    // No reserve() up front: GCC 12 misreads the push_backs after one as freeing
+    // a non-heap pointer (-Wfree-nonheap-object). The insert below allocates once.
+    std::vector<uint8_t> batch{kBatchVersion};
+    put_varint(batch, sequence++);
+    put_varint(batch, record_count);
+    batch.insert(batch.end(), records.begin(), records.end());
+    records.clear();
+    record_count = 0;
+
+    ++stats.batches;
+    stats.bytes += batch.size();
+    if (options.definitions_every != 0 && sequence % options.definitions_every == 0) {
+        resend_definitions = true; // In case a batch with definitions was lost
+    }
+    sink(std::move(batch));
+}
+
+void TelemetryCollector::Impl::run() {
+    auto next = std::chrono::steady_clock::now() + options.collect_interval;
+    std::unique_lock<std::mutex> lock(thread_mutex);
+    while (!cv.wait_until(lock, next, [this] { return !running; })) {
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> encoder_lock(mutex);
+            collect_locked();
+        }
+        lock.lock();
+        next += options.collect_interval;
+        // After a long stall, skip the missed intervals instead of collecting in a burst.
+        next = std::max(next, std::chrono::steady_clock::now());
+    }
+}
+
+TelemetryCollector::TelemetryCollector(MetricsRegistry& registry, BatchSink sink, const TelemetryOptions& options)
+    : pimpl_(std::make_unique<Impl>(registry, std::move(sink), options)) {}
+
+TelemetryCollector::TelemetryCollector(MetricsRegistry& registry, Client& client, const TelemetryOptions& options)
+    : TelemetryCollector(
+          registry, [&client](std::vector<uint8_t> batch) { client.send_telemetry(std::move(batch)); }, options) {}
+
+TelemetryCollector::~TelemetryCollector() {
+    stop();
+}
+
+core::Status TelemetryCollector::start() {
+    std::lock_guard<std::mutex> lock(pimpl_->thread_mutex);
+    if (pimpl_->running) {
+        return core::Status::OK();
+    }
+    if (pimpl_->options.collect_interval.count() <= 0) {
+        return core::Status(core::Status::Code::InvalidArgument, "The telemetry collect interval must be positive.");
+    }
+    pimpl_->running = true;
+    pimpl_->thread = std::thread([this] { pimpl_->run(); });
+    return core::Status::OK();
+}
+
+void TelemetryCollector::stop() {
+    bool was_running = false;
+    {
+        std::lock_guard<std::mutex> lock(pimpl_->thread_mutex);
+        was_running = pimpl_->running;
+        pimpl_->running = false;
+    }
+    pimpl_->cv.notify_all();
+    if (pimpl_->thread.joinable()) {
+        pimpl_->thread.join();
+    }
+    if (was_running) {
+        std::lock_guard<std::mutex> lock(pimpl_->mutex);
+        pimpl_->collect_locked();
+        pimpl_->flush_locked();
+    }
+}
+
+void TelemetryCollector::collect() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->collect_locked();
+}
+
+void TelemetryCollector::flush() {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    pimpl_->flush_locked();
+}
+
+TelemetryCollector::Stats TelemetryCollector::stats() const {
+    std::lock_guard<std::mutex> lock(pimpl_->mutex);
+    return pimpl_->stats;
+}
+
+} // namespace fleet
+} // namespace ignlink
@@ -0,0 +1,551 @@
+#include "serial_imu.h"
+
+#include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace ignlink {
+namespace hal {
+
+namespace {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The IMU packets are decoded in place as little-endian");
+
+constexpr uint8_t kHeader0 = 0xa5;
+constexpr uint8_t kHeader1 = 0x5a;
+constexpr size_t kBodyOffset = 2;  // The checksummed bytes
+constexpr size_t kBodySize = 32;
+constexpr size_t kChecksumOffset = kBodyOffset + kBodySize;
+constexpr size_t kReadBufferSize = 64 * 1024;
+constexpr int64_t kClockWindowNs = 1000000000;
+
+static_assert(kChecksumOffset + sizeof(uint16_t) == kImuPacketSize, "IMU packet layout");
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+bool baud_constant(uint32_t baud_rate, speed_t* speed) {
+    static const struct {
+        uint32_t rate;
+        speed_t constant;
+    } kRates[] = {
+        {9600, B9600},       {19200, B19200},     {38400, B38400},     {57600, B57600},
+        {115200, B115200},   {230400, B230400},   {460800, B460800},   {500000, B500000},
+        {576000, B576000},   {921600, B921600},   {1000000, B1000000}, {1152000, B1152000},
+        {1500000, B1500000}, {2000000, B2000000}, {2500000, B2500000}, {3000000, B3000000},
+        {3500000, B3500000}, {4000000, B4000000},
+    };
+    for (const auto& rate : kRates) {
+        if (rate.rate == baud_rate) {
+            *speed = rate.constant;
+            return true;
+        }
+    }
+    return false;
+}
+
+// The 16-bit sum of a packet's 32 body bytes.
+uint16_t body_sum(const uint8_t* body) {
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sums = _mm_add_epi64(_mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(body)), zero),
+                                       _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(body + 16)), zero));
+    return static_cast<uint16_t>(_mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4));
+#elif defined(__aarch64__)
+    return static_cast<uint16_t>(vaddlvq_u8(vld1q_u8(body)) + vaddlvq_u8(vld1q_u8(body + 16)));
+#else
+    uint32_t sum = 0;
+    for (size_t i = 0; i < kBodySize; ++i) {
+        sum += body[i];
+    }
+    return static_cast<uint16_t>(sum);
+#endif
+}
+
+// How many of the `count` packet-sized slots at `data` hold a valid packet, before the first that does not.
+size_t valid_run(const uint8_t* data, size_t count) {
+    for (size_t i = 0; i < count; ++i, data += kImuPacketSize) {
+        uint16_t checksum;
+        std::memcpy(&checksum, data + kChecksumOffset, sizeof(checksum));
+        if (data[0] != kHeader0 || data[1] != kHeader1 || body_sum(data + kBodyOffset) != checksum) {
+            return i;
+        }
+    }
+    return count;
+}
+
+// The next possible header at or after `from`; a trailing 0xa5 counts, as its 0x5a may be in the next read.
+const uint8_t* find_header(const uint8_t* from, const uint8_t* end) {
+    while (from < end) {
+        const auto* found = static_cast<const uint8_t*>(std::memchr(from, kHeader0, static_cast<size_t>(end - from)));
+        if (!found || found + 1 == end || found[1] == kHeader1) {
+            return found ? found : end;
+        }
+        from = found + 1;
+    }
+    return end;
+}
+
+} // namespace
+
+size_t encode_imu_packet(const ImuSample& sample, uint8_t* out) {
+    const uint16_t counter = static_cast<uint16_t>(sample.sequence);
+    const uint32_t device_us = static_cast<uint32_t>(sample.device_time_ns / 1000);
+    const int16_t temperature = static_cast<int16_t>(std::lround(sample.temperature * 100.0f));
+    out[0] = kHeader0;
+    out[1] = kHeader1;
+    std::memcpy(out + 2, &counter, sizeof(counter));
+    std::memcpy(out + 4, &device_us, sizeof(device_us));
+    std::memcpy(out + 8, sample.accel, sizeof(sample.accel));
+    std::memcpy(out + 20, sample.gyro, sizeof(sample.gyro));
+    std::memcpy(out + 32, &temperature, sizeof(temperature));
+    const uint16_t checksum = body_sum(out + kBodyOffset);
+    std::memcpy(out + kChecksumOffset, &checksum, sizeof(checksum));
+    return kImuPacketSize;
+}
+
+SerialImu::SerialImu() : stop_fd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), pool_(4) {}
+
+SerialImu::~SerialImu() {
+    close();
+    if (stop_fd_ >= 0) {
+        ::close(stop_fd_);
+    }
+}
+
+core::Status SerialImu::open(const ImuConfig& config) {
+    if (fd_ >= 0) {
+        return core::Status(core::Status::Code::AlreadyExists, "The IMU is already open");
+    }
+    if (stop_fd_ < 0) {
+        return errno_status("Could not create an eventfd");
+    }
+    if (config.batch_size == 0 || config.batch_size > ImuBatch::kCapacity) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            "The batch size must be between 1 and " + std::to_string(ImuBatch::kCapacity));
+    }
+    speed_t speed = 0;
+    if (config.baud_rate != 0 && !baud_constant(config.baud_rate, &speed)) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            "Unsupported baud rate " + std::to_string(config.baud_rate));
+    }
+
+    const int fd = ::open(config.device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return errno_status("Could not open " + config.device);
+    }
+    termios tty;
+    if (::tcgetattr(fd, &tty) != 0) {
+        const auto status = errno_status(config.device + " is not a serial port");
+        ::close(fd);
+        return status;
+    }
+    saved_termios_ = tty;
+    ::cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    if (config.baud_rate != 0) {
+        ::cfsetispeed(&tty, speed);
+        ::cfsetospeed(&tty, speed);
+    }
+    if (::tcsetattr(fd, TCSANOW, &tty) != 0) {
+        const auto status = errno_status("Could not configure " + config.device);
+        ::close(fd);
+        return status;
+    }
+    ::tcflush(fd, TCIFLUSH); // Whatever queued up before we were listening is stale
+    fd_ = fd;
+    config_ = config;
+
+    buffer_.assign(kReadBufferSize, 0);
+    buffered_ = 0;
+    samples_.clear();
+    samples_.reserve(kReadBufferSize / kImuPacketSize);
+    batch_ = msg::Loaned<ImuBatch>();
+    have_sample_ = false;
+    sequence_ = 0;
+    device_time_ns_ = 0;
+    sample_period_ns_ = 0;
+    have_offset_ = false;
+    last_timestamp_ns_ = 0;
+    samples_delivered_ = 0;
+    batches_ = 0;
+    reads_ = 0;
+    lost_ = 0;
+    checksum_errors_ = 0;
+    skipped_bytes_ = 0;
+    core::Logger::info("Opened IMU {} at {} baud, {} samples per batch", config_.device, config_.baud_rate,
+                       config_.batch_size);
+    return core::Status::OK();
+}
+
+core::Status SerialImu::start(BatchCallback callback) {
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The IMU is not open");
+    }
+    if (read_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The IMU is already reading");
+    }
+    uint64_t count;
+    while (::read(stop_fd_, &count, sizeof(count)) == sizeof(count)) {
+    }
+    callback_ = std::move(callback);
+    read_thread_ = std::thread(&SerialImu::read_loop, this);
+    return core::Status::OK();
+}
+
+core::Status SerialImu::start(BatchCallback callback, core::EventLoop& loop) {
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The IMU is not open");
+    }
+    if (read_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The IMU is already reading");
+    }
+    callback_ = std::move(callback);
+    loop_stopping_ = false;
+    port_paused_ = false;
+    loop_ = &loop;
+    const core::Status status =
+        loop.add_fd(fd_, core::EventLoop::kReadable, [this](uint32_t events) { on_readable(events); });
+    if (!status.ok()) {
+        loop_ = nullptr;
+    }
+    return status;
+}
+
+void SerialImu::stop() {
+    if (loop_) {
+        loop_->remove_fd(fd_);
+        core::EventLoop::TimerId timer;
+        {
+            // A timer callback running now finishes its pass first; any later one sees the flag.
+            std::lock_guard<std::mutex> lock(loop_mutex_);
+            loop_stopping_ = true;
+            timer = std::exchange(timer_, 0);
+        }
+        if (timer) {
+            loop_->cancel_timer(timer);
+        }
+        loop_ = nullptr;
+        batch_ = msg::Loaned<ImuBatch>();
+        return;
+    }
+    if (!read_thread_.joinable()) {
+        return;
+    }
+    const uint64_t one = 1;
+    (void)!::write(stop_fd_, &one, sizeof(one));
+    read_thread_.join();
+    batch_ = msg::Loaned<ImuBatch>(); // A partial batch is dropped with the stream
+}
+
+void SerialImu::close() {
+    stop();
+    if (fd_ >= 0) {
+        ::tcsetattr(fd_, TCSANOW, &saved_termios_);
+        ::close(fd_);
+        fd_ = -1;
+    }
+    callback_ = nullptr;
+}
+
+Imu::Stats SerialImu::stats() const {
+    Stats stats;
+    stats.samples = samples_delivered_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.reads = reads_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    stats.checksum_errors = checksum_errors_.load(std::memory_order_relaxed);
+    stats.skipped_bytes = skipped_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SerialImu::read_loop() {
+    const int64_t max_latency_ns = static_cast<int64_t>(config_.max_latency_us) * 1000;
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (true) {
+        // Wake for data, or when a partial batch is due.
+        timespec timeout{};
+        const timespec* wait = nullptr;
+        if (batch_) {
+            const int64_t left = std::max<int64_t>(batch_started_ns_ + max_latency_ns - core::MonotonicClock::now_ns(), 0);
+            timeout = {static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+            wait = &timeout;
+        }
+        if (::ppoll(fds, 2, wait, nullptr) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            core::Logger::error("IMU {} poll failed: {}", config_.device, std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            // Let the rest of the batch arrive, and take it in one read.
+            const int64_t delay = read_delay_ns(core::MonotonicClock::now_ns());
+            if (delay > 0) {
+                const timespec sleep = {static_cast<time_t>(delay / 1000000000), static_cast<long>(delay % 1000000000)};
+                if (::ppoll(&fds[1], 1, &sleep, nullptr) > 0) {
+                    return;
+                }
+            }
+            if (!read_available()) {
+                return;
+            }
+        } else if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            core::Logger::error("IMU {} went away", config_.device);
+            return;
+        }
+        if (batch_ && core::MonotonicClock::now_ns() - batch_started_ns_ >= max_latency_ns) {
+            deliver();
+        }
+    }
+}
+
+void SerialImu::on_readable(uint32_t events) {
+    std::lock_guard<std::mutex> lock(loop_mutex_);
+    if (loop_stopping_) {
+        return;
+    }
+    if (!(events & core::EventLoop::kReadable)) {
+        core::Logger::error("IMU {} went away", config_.device);
+        loop_->modify_fd(fd_, 0);
+        port_paused_ = true;
+        return;
+    }
+    // Let the rest of the batch arrive: pause the port and come back to read it in one go.
+    const int64_t delay = read_delay_ns(core::MonotonicClock::now_ns());
+    if (delay > 0) {
+        loop_->modify_fd(fd_, 0);
+        port_paused_ = true;
+        if (timer_) {
+            loop_->cancel_timer(timer_);
+        }
+        timer_ = loop_->call_after(std::chrono::nanoseconds(delay), [this] { loop_pass(true, true); });
+        return;
+    }
+    loop_pass(true, false);
+}
+
+void SerialImu::loop_pass(bool read, bool from_timer) {
+    std::unique_lock<std::mutex> lock(loop_mutex_, std::defer_lock);
+    if (from_timer) {
+        lock.lock();
+        if (loop_stopping_) {
+            return;
+        }
+        timer_ = 0; // This one has run
+    }
+    if (read) {
+        if (!read_available()) {
+            loop_->modify_fd(fd_, 0);
+            port_paused_ = true;
+            return;
+        }
+        if (port_paused_) {
+            loop_->modify_fd(fd_, core::EventLoop::kReadable);
+            port_paused_ = false;
+        }
+    }
+    const int64_t max_latency_ns = static_cast<int64_t>(config_.max_latency_us) * 1000;
+    const int64_t now = core::MonotonicClock::now_ns();
+    if (batch_ && now - batch_started_ns_ >= max_latency_ns) {
+        deliver();
+    }
+    // A timer left over from an earlier batch only fires early, and re-arms it here.
+    if (batch_ && !timer_) {
+        timer_ = loop_->call_after(std::chrono::nanoseconds(batch_started_ns_ + max_latency_ns - now),
+                                   [this] { loop_pass(false, true); });
+    } else if (!batch_ && timer_) {
+        loop_->cancel_timer(timer_);
+        timer_ = 0;
+    }
+}
+
+int64_t SerialImu::read_delay_ns(int64_t now) const {
+    if (sample_period_ns_ <= 0) {
+        return 0; // Rate not known yet
+    }
+    int waiting = 0;
+    ::ioctl(fd_, FIONREAD, &waiting);
+    const size_t pending = batch_ ? batch_->count : 0;
+    const size_t have = pending + (buffered_ + static_cast<size_t>(std::max(waiting, 0))) / kImuPacketSize;
+    if (have >= config_.batch_size) {
+        return 0;
+    }
+    const int64_t max_latency_ns = static_cast<int64_t>(config_.max_latency_us) * 1000;
+    const int64_t deadline = batch_ ? batch_started_ns_ + max_latency_ns : now + max_latency_ns;
+    return std::min(static_cast<int64_t>(config_.batch_size - have) * sample_period_ns_, deadline - now);
+}
+
+bool SerialImu::read_available() {
+    while (true) {
+        const size_t room = buffer_.size() - buffered_;
+        const ssize_t n = ::read(fd_, buffer_.data() + buffered_, room);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                return true;
+            }
+            core::Logger::error("Could not read from IMU {}: {}", config_.device, std::strerror(errno));
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        const int64_t read_ns = core::MonotonicClock::now_ns();
+        reads_.fetch_add(1, std::memory_order_relaxed);
+        buffered_ += static_cast<size_t>(n);
+
+        samples_.clear();
+        const size_t consumed = parse(buffer_.data(), buffered_);
+        buffered_ -= consumed;
+        std::memmove(buffer_.data(), buffer_.data() + consumed, buffered_);
+        if (!samples_.empty()) {
+            // The read came after the last packet in it arrived, so it bounds the clock offset.
+            update_clock(read_ns, samples_.back().device_time_ns);
+        }
+        for (ImuSample& sample : samples_) {
+            // Never backwards, even while the offset is still settling.
+            sample.timestamp_ns = std::max(sample.device_time_ns + offset_ns_, last_timestamp_ns_);
+            last_timestamp_ns_ = sample.timestamp_ns;
+            if (!batch_) {
+                batch_ = pool_.loan();
+                batch_->count = 0;
+                batch_started_ns_ = read_ns;
+            }
+            batch_->samples[batch_->count++] = sample;
+            if (batch_->count == config_.batch_size) {
+                deliver();
+            }
+        }
+        if (static_cast<size_t>(n) < room) {
+            return true; // Drained
+        }
+    }
+}
+
+size_t SerialImu::parse(const uint8_t* data, size_t size) {
+    const uint8_t* p = data;
+    const uint8_t* const end = data + size;
+    while (static_cast<size_t>(end - p) >= kImuPacketSize) {
+        // Validate every back-to-back packet first, then decode the run.
+        const size_t run = valid_run(p, static_cast<size_t>(end - p) / kImuPacketSize);
+        for (size_t i = 0; i < run; ++i, p += kImuPacketSize) {
+            decode(p);
+        }
+        if (static_cast<size_t>(end - p) < kImuPacketSize) {
+            break;
+        }
+        // Out of step: skip to the next header.
+        if (p[0] == kHeader0 && p[1] == kHeader1) {
+            checksum_errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        const uint8_t* next = find_header(p + 1, end);
+        skipped_bytes_.fetch_add(static_cast<uint64_t>(next - p), std::memory_order_relaxed);
+        p = next;
+    }
+    return static_cast<size_t>(p - data);
+}
+
+void SerialImu::decode(const uint8_t* packet) {
+    uint16_t counter;
+    uint32_t device_us;
+    int16_t temperature;
+    std::memcpy(&counter, packet + 2, sizeof(counter));
+    std::memcpy(&device_us, packet + 4, sizeof(device_us));
+    std::memcpy(&temperature, packet + 32, sizeof(temperature));
+
+    if (!have_sample_) {
+        have_sample_ = true;
+        device_time_ns_ = static_cast<int64_t>(device_us) * 1000;
+        sequence_ = counter;
+    } else {
+        const uint32_t elapsed_us = device_us - last_device_us_; // Unwraps the 32-bit microsecond clock
+        const uint16_t step = static_cast<uint16_t>(counter - last_counter_);
+        if (elapsed_us > 0x80000000u) {
+            // The device clock went back: the IMU restarted. Start the mapping to host time over.
+            device_time_ns_ = static_cast<int64_t>(device_us) * 1000;
+            have_offset_ = false;
+        } else {
+            device_time_ns_ += static_cast<int64_t>(elapsed_us) * 1000;
+            if (step > 0) {
+                const int64_t period = static_cast<int64_t>(elapsed_us) * 1000 / step;
+                sample_period_ns_ = sample_period_ns_ ? (sample_period_ns_ * 7 + period) / 8 : period;
+            }
+        }
+        if (step > 1) {
+            lost_.fetch_add(step - 1u, std::memory_order_relaxed);
+        }
+        sequence_ += step;
+    }
+    last_counter_ = counter;
+    last_device_us_ = device_us;
+
+    ImuSample sample;
+    sample.device_time_ns = device_time_ns_;
+    std::memcpy(sample.accel, packet + 8, sizeof(sample.accel));
+    std::memcpy(sample.gyro, packet + 20, sizeof(sample.gyro));
+    sample.temperature = static_cast<float>(temperature) / 100.0f;
+    sample.sequence = sequence_;
+    samples_.push_back(sample);
+}
+
+void SerialImu::update_clock(int64_t read_ns, int64_t device_ns) {
+    const int64_t offset = read_ns - device_ns;
+    if (!have_offset_) {
+        have_offset_ = true;
+        window_min_ns_ = offset;
+        previous_window_min_ns_ = std::numeric_limits<int64_t>::max();
+        window_start_ns_ = read_ns;
+    } else if (read_ns - window_start_ns_ >= kClockWindowNs) {
+        previous_window_min_ns_ = window_min_ns_;
+        window_min_ns_ = offset;
+        window_start_ns_ = read_ns;
+    } else {
+        window_min_ns_ = std::min(window_min_ns_, offset);
+    }
+    offset_ns_ = std::min(window_min_ns_, previous_window_min_ns_);
+}
+
+void SerialImu::deliver() {
+    if (!batch_) {
+        return;
+    }
+    batch_->lost = lost_.load(std::memory_order_relaxed);
+    batch_->checksum_errors = checksum_errors_.load(std::memory_order_relaxed);
+    samples_delivered_.fetch_add(batch_->count, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    callback_(std::move(batch_).share());
+}
+
+std::unique_ptr<Imu> create_serial_imu() {
+    return std::make_unique<SerialImu>();
+}
+
+} // namespace hal
+} // namespace ignlink
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/hal/imu.h>
+#include <ignlink/msg/loaned.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <termios.h>
+
+namespace ignlink {
+namespace hal {
+
+/**
+ * @class SerialImu
+ * @brief An IMU streaming fixed-size binary packets over a serial port (see create_serial_imu()).
+ *
+ * The read thread paces itself by the IMU's sample rate, measured from the
+ * packets' device times: once data is waiting, it sleeps until the rest of
+ * a batch should have arrived (FIONREAD tells how much already has), then
+ * takes it all in one non-blocking read. Parsing works on the whole read:
+ * each run of back-to-back packets is validated in one pass, with vector
+ * checksums, before any is decoded, and after a bad byte the next header is
+ * found with memchr() rather than byte by byte.
+ *
+ * Sample times come from the device clock, mapped onto CLOCK_MONOTONIC by
+ * the smallest read-time-minus-device-time seen over the last one to two
+ * seconds: a read is never earlier than the packets in it, so the smallest
+ * difference is the one least delayed by the UART, the kernel and the
+ * scheduler, and the window lets the mapping follow drift between the clocks.
+ *
+ * On an event loop the same pacing holds without the thread: while the rest
+ * of a batch is on its way the port is paused on the loop, and a timer reads
+ * it when it should be there, or delivers a partial batch when it is due.
+ */
+class SerialImu : public Imu {
+public:
+    SerialImu();
+    ~SerialImu() override;
+
+    // Prevent copying
+    SerialImu(const SerialImu&) = delete;
+    SerialImu& operator=(const SerialImu&) = delete;
+
+    core::Status open(const ImuConfig& config) override;
+    core::Status start(BatchCallback callback) override;
+    core::Status start(BatchCallback callback, core::EventLoop& loop) override;
+    void stop() override;
+    void close() override;
+    const ImuConfig& config() const override { return config_; }
+    Stats stats() const override;
+
+private:
+    void read_loop();
+    void on_readable(uint32_t events);          // The port's handler on the event loop
+    void loop_pass(bool read, bool from_timer); // read_loop()'s body on the event loop
+    int64_t read_delay_ns(int64_t now) const;
+    bool read_available(); // False if the port failed
+    size_t parse(const uint8_t* data, size_t size); // Decodes into samples_; returns the bytes consumed
+    void decode(const uint8_t* packet);
+    void update_clock(int64_t read_ns, int64_t device_ns);
+    void deliver();
+
+    ImuConfig config_;
+    int fd_ = -1;
+    int stop_fd_ = -1; // eventfd that wakes the read thread
+    termios saved_termios_{};
+    BatchCallback callback_;
+    std::thread read_thread_;
+
+    // Event loop mode. The handlers hold `loop_mutex_` so that stop() can cancel the timer they arm.
+    core::EventLoop* loop_ = nullptr;
+    std::mutex loop_mutex_;
+    bool loop_stopping_ = false;
+    bool port_paused_ = false;
+    core::EventLoop::TimerId timer_ = 0; // The pending read or partial-batch deadline
+
+    std::vector<uint8_t> buffer_; // Read, not yet parsed: at most a partial packet between reads
+    size_t buffered_ = 0;
+    std::vector<ImuSample> samples_; // Decoded from the current read, not yet stamped
+
+    msg::LoanPool<ImuBatch> pool_;
+    msg::Loaned<ImuBatch> batch_; // Being filled
+    int64_t batch_started_ns_ = 0;
+
+    // Device counter and clock, unwrapped.
+    bool have_sample_ = false;
+    uint16_t last_counter_ = 0;
+    uint32_t last_device_us_ = 0;
+    uint32_t sequence_ = 0;
+    int64_t device_time_ns_ = 0;
+    int64_t sample_period_ns_ = 0; // Smoothed; 0 until two samples are in
+
+    // Device to monotonic time: offset = min(read time - device time) over the current and last window.
+    bool have_offset_ = false;
+    int64_t offset_ns_ = 0;
+    int64_t window_min_ns_ = 0;
+    int64_t previous_window_min_ns_ = 0;
+    int64_t window_start_ns_ = 0;
+    int64_t last_timestamp_ns_ = 0;
+
+    std::atomic<uint64_t> samples_delivered_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> reads_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> checksum_errors_{0};
+    std::atomic<uint64_t> skipped_bytes_{0};
+};
+
+} // namespace hal
+} // namespace ignlink
@@ -0,0 +1,391 @@
+#include "socket_can.h"
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace hal {
+
+namespace {
+
+static_assert(offsetof(CanFrame, id) == offsetof(canfd_frame, can_id), "CanFrame layout");
+static_assert(offsetof(CanFrame, len) == offsetof(canfd_frame, len), "CanFrame layout");
+static_assert(offsetof(CanFrame, flags) == offsetof(canfd_frame, flags), "CanFrame layout");
+static_assert(offsetof(CanFrame, data) == offsetof(canfd_frame, data), "CanFrame layout");
+static_assert(offsetof(CanFrame, data) == offsetof(can_frame, data), "CanFrame layout");
+static_assert(offsetof(CanFrame, timestamp_ns) == CANFD_MTU, "CanFrame layout");
+
+// Room for SCM_TIMESTAMPING and SO_RXQ_OVFL, per message.
+constexpr size_t kControlSize = CMSG_SPACE(sizeof(timespec) * 3) + CMSG_SPACE(sizeof(uint32_t));
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+int64_t timespec_ns(const timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// How far CLOCK_REALTIME (the kernel's software stamps) is ahead of CLOCK_MONOTONIC.
+int64_t realtime_offset_ns(int64_t* monotonic_now) {
+    timespec before;
+    timespec realtime;
+    timespec after;
+    ::clock_gettime(CLOCK_MONOTONIC, &before);
+    ::clock_gettime(CLOCK_REALTIME, &realtime);
+    ::clock_gettime(CLOCK_MONOTONIC, &after);
+    *monotonic_now = timespec_ns(after);
+    return timespec_ns(realtime) - (timespec_ns(before) + timespec_ns(after)) / 2;
+}
+
+} // namespace
+
+SocketCanBus::SocketCanBus() : stop_fd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), pool_(4) {}
+
+SocketCanBus::~SocketCanBus() {
+    close();
+    if (stop_fd_ >= 0) {
+        ::close(stop_fd_);
+    }
+}
+
+core::Status SocketCanBus::open(const CanBusConfig& config) {
+    if (fd_ >= 0) {
+        return core::Status(core::Status::Code::AlreadyExists, "The CAN bus is already open");
+    }
+    if (stop_fd_ < 0) {
+        return errno_status("Could not create an eventfd");
+    }
+    if (config.batch_size == 0) {
+        return core::Status(core::Status::Code::InvalidArgument, "The batch size must be at least 1");
+    }
+
+    int fd = config.socket_fd;
+    if (fd >= 0) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    } else {
+        const unsigned int index = ::if_nametoindex(config.interface.c_str());
+        if (index == 0) {
+            return errno_status("No CAN interface " + config.interface);
+        }
+        fd = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+        if (fd < 0) {
+            return errno_status("Could not create a CAN socket");
+        }
+        sockaddr_can address{};
+        address.can_family = AF_CAN;
+        address.can_ifindex = static_cast<int>(index);
+        if (config.fd_frames) {
+            const int on = 1;
+            if (::setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &on, sizeof(on)) != 0) {
+                const auto status = errno_status(config.interface + " does not support CAN FD");
+                ::close(fd);
+                return status;
+            }
+        }
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            const auto status = errno_status("Could not bind to " + config.interface);
+            ::close(fd);
+            return status;
+        }
+    }
+    fd_ = fd;
+    config_ = config;
+
+    if (!config.filters.empty()) {
+        const auto status = set_filters(config.filters);
+        if (!status.ok()) {
+            close();
+            return status;
+        }
+    }
+    if (config.receive_buffer_bytes > 0 &&
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &config.receive_buffer_bytes, sizeof(int)) != 0) {
+        core::Logger::warn("Could not set the receive buffer of {}: {}", config.interface, std::strerror(errno));
+    }
+    const int on = 1;
+    ::setsockopt(fd_, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on));
+    const int software = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    const int hardware = software | SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (!(config.hardware_timestamps && ::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &hardware, sizeof(int)) == 0) &&
+        ::setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &software, sizeof(int)) != 0) {
+        core::Logger::warn("No receive timestamps on {}; frames are stamped when read", config.interface);
+    }
+
+    const size_t n = config.batch_size;
+    messages_.assign(n, mmsghdr{});
+    iovecs_.assign(n, iovec{});
+    control_.assign(n * kControlSize, 0);
+    frames_ = 0;
+    batches_ = 0;
+    dropped_ = 0;
+    sent_ = 0;
+    send_errors_ = 0;
+    core::Logger::info("Opened CAN bus {}{} ({} filters)", config_.socket_fd >= 0 ? "socket " : "",
+                       config_.socket_fd >= 0 ? std::to_string(config_.socket_fd) : config_.interface,
+                       config_.filters.size());
+    return core::Status::OK();
+}
+
+core::Status SocketCanBus::set_filters(const std::vector<CanFilter>& filters) {
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The CAN bus is not open");
+    }
+    std::vector<can_filter> kernel_filters;
+    kernel_filters.reserve(std::max<size_t>(filters.size(), 1));
+    for (const auto& filter : filters) {
+        kernel_filters.push_back({filter.id, filter.mask});
+    }
+    if (kernel_filters.empty()) {
+        kernel_filters.push_back({0, 0}); // Every frame
+    }
+    if (::setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FILTER, kernel_filters.data(),
+                     static_cast<socklen_t>(kernel_filters.size() * sizeof(can_filter))) != 0) {
+        return errno_status("Could not set the CAN filters");
+    }
+    config_.filters = filters;
+    return core::Status::OK();
+}
+
+core::Status SocketCanBus::start(BatchCallback callback) {
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The CAN bus is not open");
+    }
+    if (receive_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The CAN bus is already receiving");
+    }
+    uint64_t count;
+    while (::read(stop_fd_, &count, sizeof(count)) == sizeof(count)) {
+    }
+    callback_ = std::move(callback);
+    receive_thread_ = std::thread(&SocketCanBus::receive_loop, this);
+    return core::Status::OK();
+}
+
+core::Status SocketCanBus::start(BatchCallback callback, core::EventLoop& loop) {
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The CAN bus is not open");
+    }
+    if (receive_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The CAN bus is already receiving");
+    }
+    callback_ = std::move(callback);
+    // The same pass as receive_loop(), one per readiness report.
+    const core::Status status = loop.add_fd(fd_, core::EventLoop::kReadable, [this, &loop](uint32_t events) {
+        if (events & (core::EventLoop::kError | core::EventLoop::kHangup)) {
+            core::Logger::error("CAN bus {} went down", config_.interface);
+            loop.modify_fd(fd_, 0);
+            return;
+        }
+        while (receive_batch()) {
+        }
+    });
+    if (!status.ok()) {
+        return status;
+    }
+    loop_ = &loop;
+    return core::Status::OK();
+}
+
+void SocketCanBus::stop() {
+    if (loop_) {
+        loop_->remove_fd(fd_);
+        loop_ = nullptr;
+        return;
+    }
+    if (!receive_thread_.joinable()) {
+        return;
+    }
+    const uint64_t one = 1;
+    (void)!::write(stop_fd_, &one, sizeof(one));
+    receive_thread_.join();
+}
+
+void SocketCanBus::close() {
+    stop();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    callback_ = nullptr;
+}
+
+core::Status SocketCanBus::send(const CanFrame* frames, size_t count, size_t* sent) {
+    if (sent) {
+        *sent = 0;
+    }
+    if (fd_ < 0) {
+        return core::Status(core::Status::Code::Unavailable, "The CAN bus is not open");
+    }
+    constexpr size_t kMaxBatch = 64;
+    mmsghdr messages[kMaxBatch];
+    iovec iovecs[kMaxBatch];
+    size_t done = 0;
+    while (done < count) {
+        const size_t n = std::min(count - done, kMaxBatch);
+        for (size_t i = 0; i < n; ++i) {
+            const CanFrame& frame = frames[done + i];
+            const bool fd = (frame.flags & CanFrame::kFd) || frame.len > CAN_MAX_DLEN;
+            iovecs[i] = {const_cast<CanFrame*>(&frame), fd ? CANFD_MTU : CAN_MTU};
+            messages[i] = mmsghdr{};
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int result = ::sendmmsg(fd_, messages, static_cast<unsigned int>(n), MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+            const auto status = (errno == EAGAIN || errno == ENOBUFS)
+                                    ? core::Status(core::Status::Code::Unavailable, "The CAN transmit queue is full")
+                                    : errno_status("Could not send on " + config_.interface);
+            if (sent) {
+                *sent = done;
+            }
+            return status;
+        }
+        done += static_cast<size_t>(result);
+        sent_.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+    }
+    if (sent) {
+        *sent = done;
+    }
+    return core::Status::OK();
+}
+
+CanBus::Stats SocketCanBus::stats() const {
+    Stats stats;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.sent = sent_.load(std::memory_order_relaxed);
+    stats.send_errors = send_errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SocketCanBus::receive_loop() {
+    pollfd fds[2] = {{fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            core::Logger::error("CAN bus {} poll failed: {}", config_.interface, std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            core::Logger::error("CAN bus {} went down", config_.interface);
+            return;
+        }
+        // Drain the socket: a full batch means more may be waiting.
+        while (receive_batch()) {
+        }
+    }
+}
+
+bool SocketCanBus::receive_batch() {
+    auto batch = pool_.loan();
+    auto& frames = batch->frames;
+    const size_t capacity = config_.batch_size;
+    frames.resize(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        // Straight into the batch: CanFrame starts with a struct canfd_frame.
+        iovecs_[i] = {&frames[i], CANFD_MTU};
+        msghdr& header = messages_[i].msg_hdr;
+        header = msghdr{};
+        header.msg_iov = &iovecs_[i];
+        header.msg_iovlen = 1;
+        header.msg_control = &control_[i * kControlSize];
+        header.msg_controllen = kControlSize;
+    }
+    const int received = ::recvmmsg(fd_, messages_.data(), static_cast<unsigned int>(capacity), MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+        if (received < 0 && errno != EAGAIN && errno != EINTR) {
+            core::Logger::warn("Could not receive from CAN bus {}: {}", config_.interface, std::strerror(errno));
+        }
+        return false;
+    }
+
+    // Measured once a second rather than per batch, so that its jitter does
+    // not reorder the stamps of consecutive batches; that follows clock steps.
+    const int64_t now = core::MonotonicClock::now_ns();
+    if (now - offset_measured_ns_ > 1000000000) {
+        realtime_offset_ns_ = realtime_offset_ns(&offset_measured_ns_);
+    }
+    const int64_t offset = realtime_offset_ns_;
+    size_t kept = 0;
+    for (size_t i = 0; i < static_cast<size_t>(received); ++i) {
+        CanFrame& frame = frames[i];
+        const unsigned int size = messages_[i].msg_len;
+        if (size == CANFD_MTU) {
+            frame.flags |= CanFrame::kFd;
+        } else if (size == CAN_MTU) {
+            frame.flags = 0;
+            frame.len = std::min<uint8_t>(frame.len, CAN_MAX_DLEN);
+        } else {
+            continue; // Not a CAN frame
+        }
+        frame.timestamp_ns = 0;
+        frame.hw_timestamp_ns = 0;
+        msghdr& header = messages_[i].msg_hdr;
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET) {
+                continue;
+            }
+            if (cmsg->cmsg_type == SO_TIMESTAMPING) {
+                timespec stamps[3];
+                std::memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                if (stamps[0].tv_sec || stamps[0].tv_nsec) {
+                    frame.timestamp_ns = timespec_ns(stamps[0]) - offset;
+                }
+                frame.hw_timestamp_ns = timespec_ns(stamps[2]);
+            } else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+                uint32_t drops;
+                std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                dropped_.store(drops, std::memory_order_relaxed);
+            }
+        }
+        if (frame.timestamp_ns == 0) {
+            frame.timestamp_ns = now;
+        }
+        if (kept != i) {
+            frames[kept] = frame;
+        }
+        ++kept;
+    }
+    frames.resize(kept);
+    batch->dropped = dropped_.load(std::memory_order_relaxed);
+    frames_.fetch_add(kept, std::memory_order_relaxed);
+    if (kept > 0) {
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        callback_(std::move(batch).share());
+    }
+    return static_cast<size_t>(received) == capacity;
+}
+
+std::unique_ptr<CanBus> create_socket_can_bus() {
+    return std::make_unique<SocketCanBus>();
+}
+
+} // namespace hal
+} // namespace ignlink
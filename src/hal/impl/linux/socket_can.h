@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ignlink/hal/can_bus.h>
+#include <ignlink/msg/loaned.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace ignlink {
+namespace hal {
+
+/**
+ * @class SocketCanBus
+ * @brief A CAN bus on a SocketCAN raw socket, received in batches with recvmmsg().
+ *
+ * Filters go to the kernel (CAN_RAW_FILTER). Receive times come from
+ * SO_TIMESTAMPING: the kernel's software stamp, moved to the CLOCK_MONOTONIC
+ * time line, and the controller's raw stamp where the driver provides one.
+ * SO_RXQ_OVFL reports frames dropped because the socket's queue was full.
+ *
+ * Batches come from a LoanPool, and recvmmsg() writes the frames straight
+ * into them, so the receive path neither allocates nor copies once the pool
+ * has warmed up.
+ */
+class SocketCanBus : public CanBus {
+public:
+    SocketCanBus();
+    ~SocketCanBus() override;
+
+    // Prevent copying
+    SocketCanBus(const SocketCanBus&) = delete;
+    SocketCanBus& operator=(const SocketCanBus&) = delete;
+
+    core::Status open(const CanBusConfig& config) override;
+    core::Status start(BatchCallback callback) override;
+    core::Status start(BatchCallback callback, core::EventLoop& loop) override;
+    void stop() override;
+    void close() override;
+    core::Status set_filters(const std::vector<CanFilter>& filters) override;
+    using CanBus::send;
+    core::Status send(const CanFrame* frames, size_t count, size_t* sent) override;
+    const CanBusConfig& config() const override { return config_; }
+    Stats stats() const override;
+
+private:
+    void receive_loop();
+    bool receive_batch(); // False once the socket is drained
+
+    CanBusConfig config_;
+    int fd_ = -1;
+    int stop_fd_ = -1; // eventfd that wakes the receive thread
+    BatchCallback callback_;
+    std::thread receive_thread_;
+    core::EventLoop* loop_ = nullptr; // Set instead of the thread when receiving on an event loop
+
+    msg::LoanPool<CanFrameBatch> pool_;
+    // recvmmsg() arguments, built once for `batch_size` frames.
+    std::vector<mmsghdr> messages_;
+    std::vector<iovec> iovecs_;
+    std::vector<char> control_;
+    int64_t realtime_offset_ns_ = 0; // Kernel stamps are CLOCK_REALTIME
+    int64_t offset_measured_ns_ = 0;
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> send_errors_{0};
+};
+
+} // namespace hal
+} // namespace ignlink
@@ -0,0 +1,914 @@
+#include "v4l2_camera.h"
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace ignlink {
+namespace hal {
+
+namespace {
+
+constexpr char kFilePrefix[] = "file:";
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+uint32_t fourcc(PixelFormat format) {
+    switch (format) {
+    case PixelFormat::YUYV: return V4L2_PIX_FMT_YUYV;
+    case PixelFormat::UYVY: return V4L2_PIX_FMT_UYVY;
+    case PixelFormat::NV12: return V4L2_PIX_FMT_NV12;
+    case PixelFormat::MJPEG: return V4L2_PIX_FMT_MJPEG;
+    case PixelFormat::RGB24: return V4L2_PIX_FMT_RGB24;
+    case PixelFormat::BGR24: return V4L2_PIX_FMT_BGR24;
+    case PixelFormat::GREY: return V4L2_PIX_FMT_GREY;
+    }
+    return 0;
+}
+
+std::string fourcc_name(uint32_t code) {
+    const char name[] = {static_cast<char>(code & 0xff), static_cast<char>((code >> 8) & 0xff),
+                         static_cast<char>((code >> 16) & 0xff), static_cast<char>((code >> 24) & 0xff), '\0'};
+    return name;
+}
+
+// Bytes per row and per image of a tightly packed frame, as a driver would lay it out.
+void packed_layout(uint32_t pixelformat, uint32_t width, uint32_t height, uint32_t* bytesperline,
+                   uint32_t* sizeimage) {
+    switch (pixelformat) {
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+        *bytesperline = width * 2;
+        *sizeimage = *bytesperline * height;
+        break;
+    case V4L2_PIX_FMT_RGB24:
+    case V4L2_PIX_FMT_BGR24:
+        *bytesperline = width * 3;
+        *sizeimage = *bytesperline * height;
+        break;
+    case V4L2_PIX_FMT_NV12:
+        *bytesperline = width;
+        *sizeimage = width * height * 3 / 2;
+        break;
+    case V4L2_PIX_FMT_MJPEG:
+        *bytesperline = 0;
+        *sizeimage = width * height; // An upper bound, as drivers report it
+        break;
+    default: // GREY
+        *bytesperline = width;
+        *sizeimage = width * height;
+        break;
+    }
+}
+
+int64_t timeval_ns(const timeval& tv) {
+    return static_cast<int64_t>(tv.tv_sec) * 1000000000 + static_cast<int64_t>(tv.tv_usec) * 1000;
+}
+
+} // namespace
+
+// --- LinuxV4L2Device ---
+
+core::Status LinuxV4L2Device::open(const std::string& path, std::unique_ptr<V4L2Device>* device) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return errno_status("Could not open " + path);
+    }
+    device->reset(new LinuxV4L2Device(fd));
+    return core::Status::OK();
+}
+
+LinuxV4L2Device::~LinuxV4L2Device() {
+    ::close(fd_);
+}
+
+int LinuxV4L2Device::ioctl(unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ::ioctl(fd_, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+void* LinuxV4L2Device::mmap(size_t length, off_t offset) {
+    return ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+}
+
+int LinuxV4L2Device::munmap(void* address, size_t length) {
+    return ::munmap(address, length);
+}
+
+// --- FileV4L2Device ---
+
+core::Status FileV4L2Device::open(const std::string& path, std::unique_ptr<V4L2Device>* device) {
+    const int file_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_fd < 0) {
+        return errno_status("Could not open " + path);
+    }
+    const off_t size = ::lseek(file_fd, 0, SEEK_END);
+    if (size <= 0) {
+        ::close(file_fd);
+        return core::Status(core::Status::Code::InvalidArgument, "No frames in " + path);
+    }
+    const int event_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE);
+    if (event_fd < 0) {
+        const auto status = errno_status("Could not create an eventfd");
+        ::close(file_fd);
+        return status;
+    }
+    device->reset(new FileV4L2Device(file_fd, event_fd, static_cast<uint64_t>(size)));
+    return core::Status::OK();
+}
+
+FileV4L2Device::FileV4L2Device(int file_fd, int event_fd, uint64_t file_size)
+    : file_fd_(file_fd), event_fd_(event_fd), file_size_(file_size), pixelformat_(V4L2_PIX_FMT_YUYV) {
+    packed_layout(pixelformat_, width_, height_, &bytesperline_, &sizeimage_);
+}
+
+FileV4L2Device::~FileV4L2Device() {
+    stream_off();
+    free_buffers();
+    ::close(event_fd_);
+    ::close(file_fd_);
+}
+
+int FileV4L2Device::ioctl(unsigned long request, void* arg) {
+    switch (request) {
+    case VIDIOC_QUERYCAP: {
+        auto* cap = static_cast<v4l2_capability*>(arg);
+        std::memset(cap, 0, sizeof(*cap));
+        std::strncpy(reinterpret_cast<char*>(cap->driver), "ignlink-file", sizeof(cap->driver) - 1);
+        std::strncpy(reinterpret_cast<char*>(cap->card), "File playback", sizeof(cap->card) - 1);
+        cap->device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+        cap->capabilities = cap->device_caps | V4L2_CAP_DEVICE_CAPS;
+        return 0;
+    }
+    case VIDIOC_S_FMT:
+        return set_format(arg);
+    case VIDIOC_G_FMT: {
+        auto* fmt = static_cast<v4l2_format*>(arg);
+        if (fmt->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        fmt->fmt.pix.width = width_;
+        fmt->fmt.pix.height = height_;
+        fmt->fmt.pix.pixelformat = pixelformat_;
+        fmt->fmt.pix.field = V4L2_FIELD_NONE;
+        fmt->fmt.pix.bytesperline = bytesperline_;
+        fmt->fmt.pix.sizeimage = sizeimage_;
+        return 0;
+    }
+    case VIDIOC_S_PARM:
+    case VIDIOC_G_PARM: {
+        auto* parm = static_cast<v4l2_streamparm*>(arg);
+        if (parm->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& tpf = parm->parm.capture.timeperframe;
+        if (request == VIDIOC_S_PARM) {
+            fps_ = tpf.numerator ? tpf.denominator / tpf.numerator : 0;
+        }
+        parm->parm.capture.capability = V4L2_CAP_TIMEPERFRAME;
+        tpf.numerator = fps_ ? 1 : 0;
+        tpf.denominator = fps_;
+        return 0;
+    }
+    case VIDIOC_REQBUFS: {
+        auto* req = static_cast<v4l2_requestbuffers*>(arg);
+        if (req->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || req->memory != V4L2_MEMORY_MMAP) {
+            break;
+        }
+        const int result = request_buffers(req->count);
+        if (result == 0) {
+            req->count = static_cast<uint32_t>(buffers_.size());
+        }
+        return result;
+    }
+    case VIDIOC_QUERYBUF:
+    case VIDIOC_QBUF:
+    case VIDIOC_DQBUF: {
+        auto* buf = static_cast<v4l2_buffer*>(arg);
+        if (buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || buf->memory != V4L2_MEMORY_MMAP) {
+            break;
+        }
+        if (request == VIDIOC_DQBUF) {
+            uint64_t count;
+            if (::read(event_fd_, &count, sizeof(count)) != sizeof(count)) {
+                return -1; // EAGAIN: nothing filled yet
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (request == VIDIOC_DQBUF) {
+            if (done_.empty()) { // Taken back by STREAMOFF
+                errno = EAGAIN;
+                return -1;
+            }
+            buf->index = done_.front();
+            done_.pop_front();
+        }
+        if (buf->index >= buffers_.size()) {
+            break;
+        }
+        Buffer& buffer = buffers_[buf->index];
+        if (request == VIDIOC_QBUF) {
+            if (buffer.queued) {
+                break;
+            }
+            buffer.queued = true;
+            queued_.push_back(buf->index);
+            queued_cv_.notify_one();
+            return 0;
+        }
+        buf->length = static_cast<uint32_t>(buffer_length_);
+        buf->m.offset = static_cast<uint32_t>(buf->index * buffer_length_);
+        buf->field = V4L2_FIELD_NONE;
+        buf->flags = V4L2_BUF_FLAG_MAPPED | V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC | V4L2_BUF_FLAG_TSTAMP_SRC_SOE;
+        if (request == VIDIOC_DQBUF) {
+            buf->bytesused = buffer.bytesused;
+            buf->sequence = buffer.sequence;
+            buf->timestamp.tv_sec = static_cast<time_t>(buffer.timestamp_ns / 1000000000);
+            buf->timestamp.tv_usec = static_cast<suseconds_t>(buffer.timestamp_ns % 1000000000 / 1000);
+        } else if (buffer.queued) {
+            buf->flags |= V4L2_BUF_FLAG_QUEUED;
+        }
+        return 0;
+    }
+    case VIDIOC_EXPBUF: {
+        auto* exp = static_cast<v4l2_exportbuffer*>(arg);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (exp->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || exp->index >= buffers_.size() || exp->plane != 0) {
+            break;
+        }
+        exp->fd = ::fcntl(buffers_[exp->index].fd, F_DUPFD_CLOEXEC, 0);
+        return exp->fd < 0 ? -1 : 0;
+    }
+    case VIDIOC_STREAMON:
+        return stream_on();
+    case VIDIOC_STREAMOFF:
+        stream_off();
+        return 0;
+    default:
+        errno = ENOTTY;
+        return -1;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+int FileV4L2Device::set_format(void* arg) {
+    auto* fmt = static_cast<v4l2_format*>(arg);
+    if (fmt->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        errno = EINVAL;
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (streaming_ || !buffers_.empty()) {
+        errno = EBUSY;
+        return -1;
+    }
+    auto& pix = fmt->fmt.pix;
+    switch (pix.pixelformat) {
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_RGB24:
+    case V4L2_PIX_FMT_BGR24:
+    case V4L2_PIX_FMT_GREY:
+        pixelformat_ = pix.pixelformat;
+        break;
+    default: // Like drivers, fall back to a supported format rather than fail
+        pixelformat_ = V4L2_PIX_FMT_YUYV;
+        break;
+    }
+    width_ = std::clamp<uint32_t>(pix.width & ~1u, 2, 8192);
+    height_ = std::clamp<uint32_t>(pix.height & ~1u, 2, 8192);
+    packed_layout(pixelformat_, width_, height_, &bytesperline_, &sizeimage_);
+    pix.width = width_;
+    pix.height = height_;
+    pix.pixelformat = pixelformat_;
+    pix.field = V4L2_FIELD_NONE;
+    pix.bytesperline = bytesperline_;
+    pix.sizeimage = sizeimage_;
+    return 0;
+}
+
+int FileV4L2Device::request_buffers(uint32_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (streaming_) {
+        errno = EBUSY;
+        return -1;
+    }
+    free_buffers();
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    buffer_length_ = (sizeimage_ + page - 1) / page * page;
+    for (uint32_t i = 0; i < std::min<uint32_t>(count, VIDEO_MAX_FRAME); ++i) {
+        Buffer buffer;
+        buffer.fd = ::memfd_create("ignlink-v4l2", MFD_CLOEXEC);
+        if (buffer.fd < 0 || ::ftruncate(buffer.fd, static_cast<off_t>(buffer_length_)) != 0) {
+            const int error = errno;
+            if (buffer.fd >= 0) {
+                ::close(buffer.fd);
+            }
+            free_buffers();
+            errno = error;
+            return -1;
+        }
+        void* data = ::mmap(nullptr, buffer_length_, PROT_READ | PROT_WRITE, MAP_SHARED, buffer.fd, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            ::close(buffer.fd);
+            free_buffers();
+            errno = error;
+            return -1;
+        }
+        buffer.data = static_cast<uint8_t*>(data);
+        buffers_.push_back(buffer);
+    }
+    return 0;
+}
+
+void FileV4L2Device::free_buffers() {
+    for (const auto& buffer : buffers_) {
+        ::munmap(buffer.data, buffer_length_);
+        ::close(buffer.fd);
+    }
+    buffers_.clear();
+    queued_.clear();
+    done_.clear();
+}
+
+void* FileV4L2Device::mmap(size_t length, off_t offset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t index = buffer_length_ ? static_cast<size_t>(offset) / buffer_length_ : buffers_.size();
+    if (index >= buffers_.size() || length > buffer_length_) {
+        errno = EINVAL;
+        return MAP_FAILED;
+    }
+    return ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, buffers_[index].fd, 0);
+}
+
+int FileV4L2Device::munmap(void* address, size_t length) {
+    return ::munmap(address, length);
+}
+
+int FileV4L2Device::stream_on() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffers_.empty()) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!streaming_) {
+        streaming_ = true;
+        sequence_ = 0;
+        producer_ = std::thread(&FileV4L2Device::produce, this);
+    }
+    return 0;
+}
+
+void FileV4L2Device::stream_off() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        streaming_ = false;
+        queued_cv_.notify_all();
+    }
+    if (producer_.joinable()) {
+        producer_.join();
+    }
+    // Like a driver, give every buffer back to the application.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_) {
+        buffer.queued = false;
+    }
+    queued_.clear();
+    done_.clear();
+    uint64_t count;
+    while (::read(event_fd_, &count, sizeof(count)) == sizeof(count)) {
+    }
+}
+
+void FileV4L2Device::produce() {
+    using Clock = std::chrono::steady_clock;
+    auto next = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (streaming_) {
+        if (fps_ > 0) {
+            const auto period = std::chrono::nanoseconds(1000000000 / fps_);
+            next += period;
+            if (next < Clock::now() - period) {
+                next = Clock::now(); // Fell behind; do not burst to catch up
+            }
+            if (queued_cv_.wait_until(lock, next, [this] { return !streaming_; })) {
+                break;
+            }
+            if (queued_.empty()) {
+                ++sequence_; // No buffer to capture into: the frame is dropped
+                continue;
+            }
+        } else {
+            queued_cv_.wait(lock, [this] { return !streaming_ || !queued_.empty(); });
+            if (!streaming_) {
+                break;
+            }
+        }
+
+        const uint32_t index = queued_.front();
+        queued_.pop_front();
+        Buffer& buffer = buffers_[index];
+        const uint32_t size = sizeimage_;
+        const uint64_t offset = file_offset_;
+        file_offset_ = offset + 2 * uint64_t(size) <= file_size_ ? offset + size : 0;
+        timespec now;
+        ::clock_gettime(CLOCK_MONOTONIC, &now);
+        buffer.timestamp_ns = static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+
+        // The buffer is neither queued nor done, so it is ours to fill unlocked ("DMA").
+        lock.unlock();
+        size_t filled = 0;
+        while (filled < size) {
+            const ssize_t n = ::pread(file_fd_, buffer.data + filled, size - filled, static_cast<off_t>(offset + filled));
+            if (n <= 0) {
+                break;
+            }
+            filled += static_cast<size_t>(n);
+        }
+        std::memset(buffer.data + filled, 0, size - filled);
+        lock.lock();
+
+        buffer.bytesused = size;
+        buffer.sequence = sequence_++;
+        buffer.queued = false;
+        done_.push_back(index);
+        const uint64_t one = 1;
+        (void)!::write(event_fd_, &one, sizeof(one));
+    }
+}
+
+// --- V4L2Camera ---
+
+// The device and its buffers, shared with every frame in flight so that a
+// frame outlives `stop()`, `close()` and the camera itself.
+struct V4L2Camera::Buffers {
+    struct Mapping {
+        void* data = nullptr;
+        size_t length = 0;
+        int dmabuf_fd = -1;
+        bool held = false; // Dequeued, and not yet released by every subscriber
+    };
+
+    ~Buffers() {
+        for (const auto& mapping : mappings) {
+            if (mapping.data) {
+                device->munmap(mapping.data, mapping.length);
+            }
+            if (mapping.dmabuf_fd >= 0) {
+                ::close(mapping.dmabuf_fd);
+            }
+        }
+    }
+
+    // Called when the last reference to a dequeued buffer goes away.
+    void release(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        mappings[index].held = false;
+        --held;
+        if (streaming) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = index;
+            if (device->ioctl(VIDIOC_QBUF, &buf) != 0) {
+                core::Logger::warn("Could not re-queue camera buffer {}: {}", index, std::strerror(errno));
+            }
+            if (loop && paused) {
+                loop->modify_fd(device->poll_fd(), core::EventLoop::kReadable);
+                paused = false;
+            }
+        }
+        returned.notify_one();
+    }
+
+    std::unique_ptr<V4L2Device> device;
+    std::vector<Mapping> mappings;
+
+    std::mutex mutex;
+    std::condition_variable returned;
+    uint32_t held = 0;
+    bool streaming = false;
+    bool stopping = false;
+    core::EventLoop* loop = nullptr; // Streaming on an event loop
+    bool paused = false;             // The device is paused on `loop` until a buffer comes back
+};
+
+V4L2Camera::V4L2Camera() : stop_fd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {}
+
+V4L2Camera::~V4L2Camera() {
+    close();
+    if (stop_fd_ >= 0) {
+        ::close(stop_fd_);
+    }
+}
+
+core::Status V4L2Camera::open(const CameraConfig& config) {
+    if (buffers_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The camera is already open");
+    }
+    if (stop_fd_ < 0) {
+        return errno_status("Could not create an eventfd");
+    }
+    auto buffers = std::make_shared<Buffers>();
+    const bool simulated = config.device.compare(0, sizeof(kFilePrefix) - 1, kFilePrefix) == 0;
+    const auto opened = simulated ? FileV4L2Device::open(config.device.substr(sizeof(kFilePrefix) - 1), &buffers->device)
+                                  : LinuxV4L2Device::open(config.device, &buffers->device);
+    if (!opened.ok()) {
+        return opened;
+    }
+    V4L2Device& device = *buffers->device;
+
+    v4l2_capability cap{};
+    if (device.ioctl(VIDIOC_QUERYCAP, &cap) != 0) {
+        return errno_status(config.device + " is not a V4L2 device");
+    }
+    const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE)) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            config.device + ((caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
+                                                 ? " is multi-planar, which is not supported"
+                                                 : " is not a capture device"));
+    }
+    if (!(caps & V4L2_CAP_STREAMING)) {
+        return core::Status(core::Status::Code::InvalidArgument, config.device + " does not support streaming I/O");
+    }
+
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = config.width;
+    fmt.fmt.pix.height = config.height;
+    fmt.fmt.pix.pixelformat = fourcc(config.format);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (device.ioctl(VIDIOC_S_FMT, &fmt) != 0) {
+        return errno_status("Could not set the format of " + config.device);
+    }
+    if (fmt.fmt.pix.pixelformat != fourcc(config.format)) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            config.device + " does not capture " + fourcc_name(fourcc(config.format)));
+    }
+    CameraConfig actual = config;
+    actual.width = fmt.fmt.pix.width;
+    actual.height = fmt.fmt.pix.height;
+    uint32_t bytesperline = 0;
+    uint32_t sizeimage = 0;
+    packed_layout(fmt.fmt.pix.pixelformat, actual.width, actual.height, &bytesperline, &sizeimage);
+    stride_ = std::max(fmt.fmt.pix.bytesperline, bytesperline);
+
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = config.fps;
+    const auto& tpf = parm.parm.capture.timeperframe;
+    if (config.fps > 0 &&
+        (device.ioctl(VIDIOC_S_PARM, &parm) != 0 || !(parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME))) {
+        core::Logger::warn("{} does not support setting the frame rate; using its default", config.device);
+        parm.parm.capture.timeperframe.numerator = 0;
+    } else if (config.fps == 0 && device.ioctl(VIDIOC_G_PARM, &parm) != 0) {
+        parm.parm.capture.timeperframe.numerator = 0;
+    }
+    actual.fps = tpf.numerator > 0 ? tpf.denominator / tpf.numerator : 0;
+
+    v4l2_requestbuffers req{};
+    req.count = std::max<uint32_t>(config.buffer_count, 1);
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (device.ioctl(VIDIOC_REQBUFS, &req) != 0 || req.count == 0) {
+        return errno_status("Could not allocate buffers on " + config.device);
+    }
+    actual.buffer_count = req.count;
+    buffers->mappings.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (device.ioctl(VIDIOC_QUERYBUF, &buf) != 0) {
+            return errno_status("Could not query buffer " + std::to_string(i) + " of " + config.device);
+        }
+        void* data = device.mmap(buf.length, static_cast<off_t>(buf.m.offset));
+        if (data == MAP_FAILED) {
+            return errno_status("Could not map buffer " + std::to_string(i) + " of " + config.device);
+        }
+        buffers->mappings[i].data = data;
+        buffers->mappings[i].length = buf.length;
+
+        if (actual.export_dmabuf) {
+            v4l2_exportbuffer exp{};
+            exp.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            exp.index = i;
+            exp.flags = O_RDONLY | O_CLOEXEC;
+            if (device.ioctl(VIDIOC_EXPBUF, &exp) == 0) {
+                buffers->mappings[i].dmabuf_fd = exp.fd;
+            } else {
+                // Frames still flow through the mappings; only the DMABUF handles are missing.
+                core::Logger::warn("{} cannot export DMABUFs: {}", config.device, std::strerror(errno));
+                actual.export_dmabuf = false;
+            }
+        }
+    }
+
+    config_ = actual;
+    buffers_ = std::move(buffers);
+    frames_ = 0;
+    dropped_ = 0;
+    starved_ = 0;
+    core::Logger::info("Opened camera {}: {}x{} {}, {} fps, {} buffers{}", config_.device, config_.width,
+                       config_.height, fourcc_name(fourcc(config_.format)), config_.fps, config_.buffer_count,
+                       config_.export_dmabuf ? " (DMABUF)" : "");
+    return core::Status::OK();
+}
+
+core::Status V4L2Camera::start(FrameCallback callback) {
+    if (!buffers_) {
+        return core::Status(core::Status::Code::Unavailable, "The camera is not open");
+    }
+    if (capture_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The camera is already streaming");
+    }
+    const core::Status status = start_streaming();
+    if (!status.ok()) {
+        return status;
+    }
+    uint64_t count;
+    while (::read(stop_fd_, &count, sizeof(count)) == sizeof(count)) {
+    }
+    callback_ = std::move(callback);
+    have_sequence_ = false;
+    capture_thread_ = std::thread(&V4L2Camera::capture_loop, this);
+    return core::Status::OK();
+}
+
+core::Status V4L2Camera::start(FrameCallback callback, core::EventLoop& loop) {
+    if (!buffers_) {
+        return core::Status(core::Status::Code::Unavailable, "The camera is not open");
+    }
+    if (capture_thread_.joinable() || loop_) {
+        return core::Status(core::Status::Code::AlreadyExists, "The camera is already streaming");
+    }
+    core::Status status = start_streaming();
+    if (!status.ok()) {
+        return status;
+    }
+    callback_ = std::move(callback);
+    have_sequence_ = false;
+    {
+        // Registered paused if every buffer is still held from an earlier run.
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        buffers_->loop = &loop;
+        buffers_->paused = buffers_->held == buffers_->mappings.size();
+        status = loop.add_fd(buffers_->device->poll_fd(), buffers_->paused ? 0 : core::EventLoop::kReadable,
+                             [this](uint32_t events) { on_readable(events); });
+        if (!status.ok()) {
+            buffers_->loop = nullptr;
+            int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buffers_->device->ioctl(VIDIOC_STREAMOFF, &type);
+            buffers_->streaming = false;
+            return status;
+        }
+    }
+    loop_ = &loop;
+    return core::Status::OK();
+}
+
+core::Status V4L2Camera::start_streaming() {
+    {
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        // Buffers still held from an earlier run are queued when they come back.
+        for (uint32_t i = 0; i < buffers_->mappings.size(); ++i) {
+            if (buffers_->mappings[i].held) {
+                continue;
+            }
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (buffers_->device->ioctl(VIDIOC_QBUF, &buf) != 0) {
+                return errno_status("Could not queue buffer " + std::to_string(i));
+            }
+        }
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (buffers_->device->ioctl(VIDIOC_STREAMON, &type) != 0) {
+            const auto status = errno_status("Could not start streaming from " + config_.device);
+            buffers_->device->ioctl(VIDIOC_STREAMOFF, &type);
+            return status;
+        }
+        buffers_->streaming = true;
+        buffers_->stopping = false;
+    }
+    return core::Status::OK();
+}
+
+void V4L2Camera::stop() {
+    if (loop_) {
+        loop_->remove_fd(buffers_->device->poll_fd());
+        loop_ = nullptr;
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        buffers_->loop = nullptr;
+        int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffers_->device->ioctl(VIDIOC_STREAMOFF, &type);
+        buffers_->streaming = false;
+        return;
+    }
+    if (!capture_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        buffers_->stopping = true;
+        buffers_->returned.notify_all();
+    }
+    const uint64_t one = 1;
+    (void)!::write(stop_fd_, &one, sizeof(one));
+    capture_thread_.join();
+
+    // After STREAMOFF the driver has given back every buffer; those still
+    // held by subscribers are simply not re-queued when released.
+    std::lock_guard<std::mutex> lock(buffers_->mutex);
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffers_->device->ioctl(VIDIOC_STREAMOFF, &type);
+    buffers_->streaming = false;
+}
+
+void V4L2Camera::close() {
+    stop();
+    buffers_.reset();
+    callback_ = nullptr;
+}
+
+Camera::Stats V4L2Camera::stats() const {
+    Stats stats;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.starved = starved_.load(std::memory_order_relaxed);
+    if (buffers_) {
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        stats.buffers_held = buffers_->held;
+    }
+    return stats;
+}
+
+void V4L2Camera::capture_loop() {
+    pollfd fds[2] = {{buffers_->device->poll_fd(), POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (true) {
+        {
+            // With every buffer held by subscribers the driver has nothing to
+            // fill (and some report that as a poll error): wait for one back.
+            std::unique_lock<std::mutex> lock(buffers_->mutex);
+            buffers_->returned.wait(lock, [this] {
+                return buffers_->stopping || buffers_->held < buffers_->mappings.size();
+            });
+            if (buffers_->stopping) {
+                return;
+            }
+        }
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            core::Logger::error("Camera {} poll failed: {}", config_.device, std::strerror(errno));
+            return;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP)) {
+            core::Logger::error("Camera {} stopped delivering frames", config_.device);
+            return;
+        }
+        if (fds[0].revents & POLLIN) {
+            dequeue();
+        }
+    }
+}
+
+void V4L2Camera::on_readable(uint32_t events) {
+    if (!(events & core::EventLoop::kReadable)) {
+        core::Logger::error("Camera {} stopped delivering frames", config_.device);
+        std::lock_guard<std::mutex> lock(buffers_->mutex);
+        buffers_->loop->modify_fd(buffers_->device->poll_fd(), 0);
+        buffers_->loop = nullptr; // Not resumed by releases; stop() removes it
+        return;
+    }
+    dequeue();
+    // The driver has nothing to fill until a subscriber lets a buffer go.
+    std::lock_guard<std::mutex> lock(buffers_->mutex);
+    if (buffers_->loop && buffers_->held == buffers_->mappings.size()) {
+        buffers_->loop->modify_fd(buffers_->device->poll_fd(), 0);
+        buffers_->paused = true;
+    }
+}
+
+void V4L2Camera::dequeue() {
+    V4L2Device& device = *buffers_->device;
+    // Drain everything that is ready, so a late wakeup does not leave frames to age.
+    while (true) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (device.ioctl(VIDIOC_DQBUF, &buf) != 0) {
+            if (errno != EAGAIN) {
+                core::Logger::warn("Could not dequeue a frame from {}: {}", config_.device, std::strerror(errno));
+            }
+            return;
+        }
+        const uint32_t index = buf.index;
+        const Buffers::Mapping& mapping = buffers_->mappings[index];
+        {
+            std::lock_guard<std::mutex> lock(buffers_->mutex);
+            buffers_->mappings[index].held = true;
+            if (++buffers_->held == buffers_->mappings.size()) {
+                starved_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (have_sequence_ && buf.sequence > next_sequence_) {
+            dropped_.fetch_add(buf.sequence - next_sequence_, std::memory_order_relaxed);
+        }
+        next_sequence_ = uint64_t(buf.sequence) + 1;
+        have_sequence_ = true;
+
+        // Re-queued when the last view of the buffer goes, whichever thread drops it.
+        std::shared_ptr<const void> owner(mapping.data,
+                                          [buffers = buffers_, index](const void*) { buffers->release(index); });
+        if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const bool monotonic =
+            (buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC && buf.timestamp.tv_sec > 0;
+        auto frame = std::make_shared<CameraFrame>();
+        frame->format = config_.format;
+        frame->width = config_.width;
+        frame->height = config_.height;
+        frame->stride = stride_;
+        frame->sequence = buf.sequence;
+        frame->timestamp_ns = monotonic ? timeval_ns(buf.timestamp) : core::MonotonicClock::now_ns();
+        frame->dmabuf_fd = mapping.dmabuf_fd;
+        frame->buffer_index = index;
+
+        const int64_t h = config_.height;
+        const int64_t w = config_.width;
+        const int64_t stride = stride_;
+        switch (config_.format) {
+        case PixelFormat::YUYV:
+        case PixelFormat::UYVY:
+        case PixelFormat::RGB24:
+        case PixelFormat::BGR24: {
+            const int64_t channels = (config_.format == PixelFormat::RGB24 || config_.format == PixelFormat::BGR24) ? 3 : 2;
+            const int64_t shape[] = {h, w, channels};
+            const int64_t strides[] = {stride, channels, 1};
+            frame->image = core::Tensor::wrap(mapping.data, core::DType::UInt8, shape, 3, std::move(owner), strides);
+            break;
+        }
+        case PixelFormat::NV12:
+        case PixelFormat::GREY: {
+            const int64_t shape[] = {config_.format == PixelFormat::NV12 ? h * 3 / 2 : h, w};
+            const int64_t strides[] = {stride, 1};
+            frame->image = core::Tensor::wrap(mapping.data, core::DType::UInt8, shape, 2, std::move(owner), strides);
+            break;
+        }
+        case PixelFormat::MJPEG: {
+            const int64_t shape[] = {static_cast<int64_t>(buf.bytesused)};
+            frame->image = core::Tensor::wrap(mapping.data, core::DType::UInt8, shape, 1, std::move(owner));
+            break;
+        }
+        }
+        frame->image.timestamp = frame->timestamp_ns;
+
+        frames_.fetch_add(1, std::memory_order_relaxed);
+        callback_(std::move(frame));
+    }
+}
+
+std::unique_ptr<Camera> create_v4l2_camera() {
+    return std::make_unique<V4L2Camera>();
+}
+
+} // namespace hal
+} // namespace ignlink
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <ignlink/hal/camera.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace ignlink {
+namespace hal {
+
+/**
+ * @class V4L2Device
+ * @brief The system calls V4L2Camera makes on a capture device.
+ *
+ * The real device forwards them to the kernel; FileV4L2Device implements the
+ * subset the camera uses in user space, so the capture path can be exercised
+ * where no camera (nor the vivid driver) is available. `ioctl()` and
+ * `mmap()` follow the system calls' conventions (-1 / MAP_FAILED and errno).
+ * All of them may be called from any thread.
+ */
+class V4L2Device {
+public:
+    virtual ~V4L2Device() = default;
+
+    virtual int ioctl(unsigned long request, void* arg) = 0;
+    virtual void* mmap(size_t length, off_t offset) = 0;
+    virtual int munmap(void* address, size_t length) = 0;
+
+    /**
+     * @brief A descriptor that polls readable while a buffer can be dequeued.
+     */
+    virtual int poll_fd() const = 0;
+};
+
+/**
+ * @class LinuxV4L2Device
+ * @brief A V4L2 device node, opened non-blocking.
+ */
+class LinuxV4L2Device : public V4L2Device {
+public:
+    static core::Status open(const std::string& path, std::unique_ptr<V4L2Device>* device);
+    ~LinuxV4L2Device() override;
+
+    int ioctl(unsigned long request, void* arg) override;
+    void* mmap(size_t length, off_t offset) override;
+    int munmap(void* address, size_t length) override;
+    int poll_fd() const override { return fd_; }
+
+private:
+    explicit LinuxV4L2Device(int fd) : fd_(fd) {}
+
+    int fd_;
+};
+
+/**
+ * @class FileV4L2Device
+ * @brief A simulated single-planar capture device playing back raw frames from a file.
+ *
+ * The file holds frames back to back, each `sizeimage` bytes of the format
+ * set with VIDIOC_S_FMT; playback loops at the end. Like a driver, it fills
+ * queued buffers at the rate set with VIDIOC_S_PARM (by default, as fast as
+ * buffers come back), stamps them with CLOCK_MONOTONIC, and drops frames
+ * (advancing the sequence) when no buffer is queued. Buffers are memfds, so
+ * VIDIOC_EXPBUF hands out real file descriptors.
+ */
+class FileV4L2Device : public V4L2Device {
+public:
+    static core::Status open(const std::string& path, std::unique_ptr<V4L2Device>* device);
+    ~FileV4L2Device() override;
+
+    int ioctl(unsigned long request, void* arg) override;
+    void* mmap(size_t length, off_t offset) override;
+    int munmap(void* address, size_t length) override;
+    int poll_fd() const override { return event_fd_; }
+
+private:
+    struct Buffer {
+        int fd = -1;
+        uint8_t* data = nullptr; // The device's own mapping, which it fills
+        uint32_t bytesused = 0;
+        uint32_t sequence = 0;
+        int64_t timestamp_ns = 0;
+        bool queued = false;
+    };
+
+    FileV4L2Device(int file_fd, int event_fd, uint64_t file_size);
+
+    int set_format(void* arg);
+    int request_buffers(uint32_t count);
+    int stream_on();
+    void stream_off();
+    void produce();
+    void free_buffers();
+
+    const int file_fd_;
+    const int event_fd_; // Counts filled buffers (EFD_SEMAPHORE)
+    const uint64_t file_size_;
+
+    std::mutex mutex_;
+    std::condition_variable queued_cv_;
+    uint32_t width_ = 640;
+    uint32_t height_ = 480;
+    uint32_t pixelformat_ = 0;
+    uint32_t bytesperline_ = 0;
+    uint32_t sizeimage_ = 0;
+    uint32_t fps_ = 0;
+    size_t buffer_length_ = 0; // sizeimage_ rounded up to the page size
+    std::vector<Buffer> buffers_;
+    std::deque<uint32_t> queued_; // In the order they will be filled
+    std::deque<uint32_t> done_;
+    uint32_t sequence_ = 0;
+    uint64_t file_offset_ = 0;
+    bool streaming_ = false;
+    std::thread producer_;
+};
+
+/**
+ * @class V4L2Camera
+ * @brief Zero-copy capture from a V4L2 device with memory-mapped driver buffers.
+ *
+ * `open()` requests `buffer_count` MMAP buffers (VIDIOC_REQBUFS), maps them
+ * and, if asked, exports each as a DMABUF (VIDIOC_EXPBUF). The capture
+ * thread dequeues filled buffers and hands them out as CameraFrames whose
+ * image wraps the mapping; the last reference to it re-queues the buffer
+ * (VIDIOC_QBUF), from whichever thread drops it. The mappings live as long
+ * as any frame does, even past `close()`.
+ *
+ * On an event loop the device's descriptor is paused while subscribers hold
+ * every buffer, and resumed by the release that hands one back.
+ *
+ * Only the single-planar capture API is supported (V4L2_BUF_TYPE_VIDEO_CAPTURE).
+ */
+class V4L2Camera : public Camera {
+public:
+    V4L2Camera();
+    ~V4L2Camera() override;
+
+    // Prevent copying
+    V4L2Camera(const V4L2Camera&) = delete;
+    V4L2Camera& operator=(const V4L2Camera&) = delete;
+
+    core::Status open(const CameraConfig& config) override;
+    core::Status start(FrameCallback callback) override;
+    core::Status start(FrameCallback callback, core::EventLoop& loop) override;
+    void stop() override;
+    void close() override;
+    const CameraConfig& config() const override { return config_; }
+    Stats stats() const override;
+
+private:
+    struct Buffers;
+
+    core::Status start_streaming();
+    void capture_loop();
+    void dequeue();
+    void on_readable(uint32_t events); // The device's handler on the event loop
+
+    CameraConfig config_;
+    uint32_t stride_ = 0;
+    std::shared_ptr<Buffers> buffers_; // Shared with every frame in flight
+    FrameCallback callback_;
+    int stop_fd_ = -1;                 // eventfd that wakes the capture thread
+    std::thread capture_thread_;
+    core::EventLoop* loop_ = nullptr;  // Set instead of the thread when streaming on an event loop
+
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> starved_{0};
+    uint64_t next_sequence_ = 0;
+    bool have_sequence_ = false;
+};
+
+} // namespace hal
+} // namespace ignlink
@@ -7,15 +7,28 @@ namespace msg {
 // The static pointer to the singleton instance.
 static std::shared_ptr<NodeContext> g_context = nullptr;
 static std::mutex g_context_mutex;
+static std::vector<std::shared_ptr<core::EventLoop>> g_loops; // Empty: the context runs its own threads
 
 std::shared_ptr<NodeContext> ContextManager::get_instance() {
     std::lock_guard<std::mutex> lock(g_context_mutex);
     if (!g_context) {
         // If it's the first time being called, create the NodeContext.
-        g_context = std::make_shared<NodeContext>();
+        g_context = g_loops.empty() ? std::make_shared<NodeContext>() : std::make_shared<NodeContext>(g_loops);
     }
     return g_context;
 }
 
+core::Status ContextManager::use_event_loops(std::vector<std::shared_ptr<core::EventLoop>> loops) {
+    if (loops.empty()) {
+        return core::Status(core::Status::Code::InvalidArgument, "No event loops given.");
+    }
+    std::lock_guard<std::mutex> lock(g_context_mutex);
+    if (g_context) {
+        return core::Status(core::Status::Code::AlreadyExists, "The bus is already running.");
+    }
+    g_loops = std::move(loops);
+    return core::Status::OK();
+}
+
 } // namespace msg
 } // namespace ignlink
\ No newline at end of file
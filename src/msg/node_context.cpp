@@ -1,59 +1,380 @@
 #include "node_context.h" // Internal header
+#include "publisher_impl.h"
+#include "subscriber_impl.h"
 #include <ignlink/core/logger.h>
-#include <chrono>
+#include <ignlink/core/timestamp.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 namespace ignlink {
 namespace msg {
 
-NodeContext::NodeContext() : running_(true) {
+NodeContext::NodeContext(size_t num_threads)
+    : wakeup_fd_(::eventfd(0, EFD_CLOEXEC)), sleeping_(false), running_(true),
+      executor_(std::make_unique<core::Executor>(num_threads)) {
+    if (wakeup_fd_ < 0) {
+        // Without a wakeup primitive the context cannot dispatch anything.
+        throw std::runtime_error(std::string("NodeContext: eventfd failed: ") + std::strerror(errno));
+    }
+
+    // Calibrate the message timestamp clock now rather than on the first publish.
+    core::MonotonicClock::calibrate();
+
     // Start the background thread when the context is created.
     // The `spin` function will be the entry point for this thread.
     spin_thread_ = std::thread(&NodeContext::spin, this);
     core::Logger::info("NodeContext started spin thread.");
 }
 
+NodeContext::NodeContext(std::vector<std::shared_ptr<core::EventLoop>> loops)
+    : wakeup_fd_(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)), sleeping_(true), running_(true), loops_(std::move(loops)) {
+    if (loops_.empty()) {
+        throw std::invalid_argument("NodeContext: no event loops given");
+    }
+    if (wakeup_fd_ < 0) {
+        throw std::runtime_error(std::string("NodeContext: eventfd failed: ") + std::strerror(errno));
+    }
+    core::MonotonicClock::calibrate();
+
+    // `sleeping_` starts out true: the loop only looks at the queues when the eventfd says so.
+    const core::Status status =
+        loops_[0]->add_fd(wakeup_fd_, core::EventLoop::kReadable, [this](uint32_t) { on_wakeup(); });
+    if (!status.ok()) {
+        ::close(wakeup_fd_);
+        throw std::runtime_error("NodeContext: " + status.message());
+    }
+    core::Logger::info("NodeContext running on {} event loop(s).", loops_.size());
+}
+
 NodeContext::~NodeContext() {
-    // Signal the spin thread to stop and wait for it to finish.
+    // Signal the spin thread to stop, kick it out of its blocking wait and
+    // wait for it to finish. This returns as soon as any in-flight callback does.
     running_.store(false);
+    if (!loops_.empty()) {
+        // Dispatches already posted to the loops hold their subscribers, not the context.
+        loops_[0]->remove_fd(wakeup_fd_);
+    }
+    signal_wakeup();
     if (spin_thread_.joinable()) {
         spin_thread_.join();
     }
+    ::close(wakeup_fd_);
+
+    // Nobody can publish through a context that is being destroyed, so the
+    // current snapshots can go without a grace period.
+    for (auto& entry : topics_) {
+        delete entry.second->subscribers.load();
+    }
     core::Logger::info("NodeContext stopped spin thread.");
 }
 
+Topic* NodeContext::find_or_create_topic(const std::string& topic_name) {
+    auto it = topics_.find(topic_name);
+    if (it != topics_.end()) {
+        return it->second.get();
+    }
+    auto topic = std::make_unique<Topic>();
+    topic->id = static_cast<TopicId>(topics_by_id_.size());
+    topic->name = topic_name;
+    topic->subscribers.store(new SubscriberList());
+    Topic* raw = topic.get();
+    topics_by_id_.push_back(raw);
+    topics_.emplace(topic_name, std::move(topic));
+    return raw;
+}
+
+core::Status NodeContext::check_topic_type(const Topic& topic, uint64_t type_hash,
+                                           const std::string& type_name) const {
+    // Every endpoint on a topic must agree on the message type. The messages
+    // are passed around type-erased, so this is the only place a mismatch can
+    // be caught safely. The comparison is on the stable type hash from
+    // MessageTraits, the same one the transports check across processes.
+    if (topic.type_hash != 0 && topic.type_hash != type_hash) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            "Topic '" + topic.name + "' already carries type '" + topic.type_name +
+                                "', not '" + type_name + "'.");
+    }
+    return core::Status::OK();
+}
+
+void NodeContext::replace_subscribers(Topic& topic, std::unique_ptr<SubscriberList> list) {
+    const SubscriberList* old = topic.subscribers.exchange(list.release(), std::memory_order_acq_rel);
+    // Publishers that loaded `old` before the exchange may still be walking
+    // it; wait until they are all out of their read sections.
+    rcu_.synchronize();
+    delete old;
+}
+
+void NodeContext::release_type_if_unused(Topic& topic) {
+    if (topic.publisher_count == 0 && topic.subscribers.load()->subscribers.empty()) {
+        topic.type_hash = 0;
+        topic.type_name.clear();
+    }
+}
+
 core::Status NodeContext::register_publisher(std::shared_ptr<PublisherImpl> impl) {
-    std::lock_guard<std::mutex> lock(pub_sub_mutex_);
-    // In a real implementation, you would check for name collisions etc.
-    // For now, we just add it to our map.
-    // publishers_[impl->get_topic_name()].push_back(impl);
-    core::Logger::info("Registered publisher for topic '{}'", "some_topic"); // Placeholder
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    Topic* topic = find_or_create_topic(impl->get_topic_name());
+    core::Status status = check_topic_type(*topic, impl->get_type_hash(), impl->get_type_name());
+    if (!status.ok()) {
+        return status;
+    }
+    topic->type_hash = impl->get_type_hash();
+    topic->type_name = impl->get_type_name();
+    ++topic->publisher_count;
+    impl->bind(topic);
+    core::Logger::info("Registered publisher for topic '{}'", impl->get_topic_name());
     return core::Status::OK();
 }
 
 core::Status NodeContext::register_subscriber(std::shared_ptr<SubscriberImpl> impl) {
-    std::lock_guard<std::mutex> lock(pub_sub_mutex_);
-    // subscribers_[impl->get_topic_name()].push_back(impl);
-    core::Logger::info("Registered subscriber for topic '{}'", "some_topic"); // Placeholder
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    Topic* topic = find_or_create_topic(impl->get_topic_name());
+    core::Status status = check_topic_type(*topic, impl->get_type_hash(), impl->get_type_name());
+    if (!status.ok()) {
+        return status;
+    }
+    topic->type_hash = impl->get_type_hash();
+    topic->type_name = impl->get_type_name();
+
+    // Copy-on-write: publishers keep reading the old snapshot until the swap.
+    auto list = std::make_unique<SubscriberList>(*topic->subscribers.load());
+    list->subscribers.push_back(std::move(impl));
+    replace_subscribers(*topic, std::move(list));
+    core::Logger::info("Registered subscriber for topic '{}'", topic->name);
     return core::Status::OK();
 }
 
+void NodeContext::unregister_publisher(PublisherImpl* impl) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    Topic* topic = impl->get_topic();
+    if (!topic || topic->publisher_count == 0) {
+        return;
+    }
+    --topic->publisher_count;
+    release_type_if_unused(*topic);
+}
+
+void NodeContext::unregister_subscriber(SubscriberImpl* impl) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    auto it = topics_.find(impl->get_topic_name());
+    if (it == topics_.end()) {
+        return;
+    }
+    Topic& topic = *it->second;
+    auto list = std::make_unique<SubscriberList>();
+    for (const auto& subscriber : topic.subscribers.load()->subscribers) {
+        if (subscriber.get() != impl) {
+            list->subscribers.push_back(subscriber);
+        }
+    }
+    replace_subscribers(topic, std::move(list));
+    release_type_if_unused(topic);
+}
+
+core::Status NodeContext::publish(const Topic& topic, std::shared_ptr<const void> msg, const MessageInfo& info,
+                                  std::chrono::nanoseconds max_blocking_time) {
+    if (!msg) {
+        return core::Status(core::Status::Code::InvalidArgument, "Cannot publish a null message.");
+    }
+
+    PendingShard& shard = pending_[topic.id % kPendingShards];
+    std::unique_lock<std::mutex> shard_lock(shard.mutex, std::defer_lock);
+    std::vector<std::shared_ptr<SubscriberImpl>> full; // Only allocates when a KeepAll queue is full
+    const bool may_block = max_blocking_time > std::chrono::nanoseconds::zero();
+    {
+        // The snapshot cannot be freed while we are inside the read section,
+        // and it never changes, so no lock is needed to walk it.
+        auto guard = rcu_.read();
+        const SubscriberList* list = topic.subscribers.load(std::memory_order_acquire);
+
+        // Offer the message to every subscriber's queue. They all share `msg`;
+        // only the reference count changes, the payload itself is never copied.
+        for (const auto& subscriber : list->subscribers) {
+            switch (subscriber->offer(msg, info, may_block)) {
+                case SubscriberImpl::Offer::NeedDispatch:
+                    if (!shard_lock.owns_lock()) {
+                        shard_lock.lock();
+                    }
+                    shard.ready.push_back(subscriber);
+                    break;
+                case SubscriberImpl::Offer::Full:
+                    full.push_back(subscriber);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Wait for room outside the read section (registration must not wait on
+    // us) and without the shard lock (the spin thread must keep going).
+    core::Status status;
+    if (!full.empty()) {
+        if (shard_lock.owns_lock()) {
+            shard_lock.unlock();
+            notify();
+        }
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(max_blocking_time);
+        for (const auto& subscriber : full) {
+            switch (subscriber->offer_blocking(msg, info, deadline)) {
+                case SubscriberImpl::Offer::NeedDispatch:
+                    if (!shard_lock.owns_lock()) {
+                        shard_lock.lock();
+                    }
+                    shard.ready.push_back(subscriber);
+                    break;
+                case SubscriberImpl::Offer::Dropped:
+                    status = core::Status(core::Status::Code::Timeout,
+                                          "A subscriber of '" + topic.name + "' stayed full; message dropped for it.");
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    if (shard_lock.owns_lock()) {
+        shard_lock.unlock();
+        notify();
+    }
+    return status;
+}
+
+void NodeContext::post_dispatch(std::shared_ptr<SubscriberImpl> subscriber) {
+    const auto& group = subscriber->get_callback_group();
+    if (!executor_) {
+        // One loop per group keeps a MutuallyExclusive group exclusive; a
+        // Reentrant group's subscribers are spread over the loops instead.
+        const void* key = group->type() == core::CallbackGroup::Type::Reentrant
+                              ? static_cast<const void*>(subscriber.get())
+                              : static_cast<const void*>(group.get());
+        // Heap pointers are aligned, so mix the bits before taking the modulus.
+        uint64_t hash = reinterpret_cast<uintptr_t>(key);
+        hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        core::EventLoop* loop = loops_[hash % loops_.size()].get();
+        loop->post([loop, subscriber] { dispatch_on(loop, subscriber); });
+        return;
+    }
+    executor_->post([this, subscriber] {
+        if (subscriber->dispatch()) {
+            post_dispatch(subscriber); // More queued than one batch
+        }
+    }, group);
+}
+
+void NodeContext::dispatch_on(core::EventLoop* loop, std::shared_ptr<SubscriberImpl> subscriber) {
+    if (subscriber->dispatch()) {
+        // More queued than one batch: go to the back, behind the loop's other work.
+        loop->post([loop, subscriber] { dispatch_on(loop, subscriber); });
+    }
+}
+
+bool NodeContext::has_pending() {
+    for (auto& shard : pending_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.ready.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NodeContext::notify() {
+    // Only the publisher that finds the spin thread asleep pays for the
+    // syscall; while the thread is busy draining, publishing is syscall-free.
+    if (sleeping_.exchange(false)) {
+        signal_wakeup();
+    }
+}
+
+void NodeContext::signal_wakeup() {
+    const uint64_t one = 1;
+    ssize_t n;
+    do {
+        n = ::write(wakeup_fd_, &one, sizeof(one));
+    } while (n < 0 && errno == EINTR);
+    // EAGAIN means the counter is saturated, i.e. a wakeup is already pending.
+}
+
+bool NodeContext::schedule_pending() {
+    auto& batch = scheduling_batch_;
+    bool dispatched = false;
+    for (auto& shard : pending_) {
+        // 1. Grab every subscriber that has become ready in this shard
+        //    since the last pass. We swap the queue out so publishers are
+        //    never blocked by dispatching.
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.ready.empty()) {
+                continue;
+            }
+            batch.swap(shard.ready);
+        }
+
+        // 2. Schedule a dispatch of each on the executor. The subscriber's
+        //    callback group keeps its own callbacks in order; different
+        //    subscribers run in parallel.
+        for (auto& subscriber : batch) {
+            post_dispatch(std::move(subscriber));
+        }
+        batch.clear();
+        dispatched = true;
+    }
+    return dispatched;
+}
+
 void NodeContext::spin() {
     while (running_.load()) {
         // This is the core loop of the messaging system.
-        // In a real implementation, this is where you would:
-        
-        // 1. Poll the transport layer for new incoming messages.
-        //    auto new_message = transport_->read(timeout);
-        
-        // 2. If a message is received:
-        //    - Deserialize it to find its topic name and data.
-        //    - Look up the subscribers for that topic in the `subscribers_` map.
-        //    - For each subscriber, add its callback to a thread pool to be executed.
-        
-        // For now, we'll just sleep to simulate work and prevent a tight loop.
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (schedule_pending()) {
+            continue; // More may have arrived while we were dispatching.
+        }
+
+        // 3. Nothing to do: announce that we are going to sleep, then re-check
+        //    the queues. A publisher that enqueued before seeing `sleeping_` is
+        //    caught by the re-check; one that enqueued after will signal us.
+        sleeping_.store(true);
+        if (has_pending() || !running_.load()) {
+            sleeping_.store(false);
+            continue;
+        }
+
+        // 4. Block until a publisher (or the destructor) signals the eventfd.
+        //    Reading resets the counter, coalescing any number of signals.
+        uint64_t count;
+        ssize_t n;
+        do {
+            n = ::read(wakeup_fd_, &count, sizeof(count));
+        } while (n < 0 && errno == EINTR);
+        sleeping_.store(false);
+    }
+}
+
+void NodeContext::on_wakeup() {
+    // The spin loop above, minus the blocking read: the event loop does the
+    // waiting, and this returns to it instead of sleeping.
+    uint64_t count;
+    while (::read(wakeup_fd_, &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+    sleeping_.store(false);
+    for (;;) {
+        while (schedule_pending()) {
+        }
+        sleeping_.store(true);
+        if (!has_pending()) {
+            return;
+        }
+        sleeping_.store(false);
     }
 }
 
 } // namespace msg
-} // namespace ignlink
\ No newline at end of file
+} // namespace ignlink
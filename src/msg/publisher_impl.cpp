@@ -1,33 +1,63 @@
 #include "publisher_impl.h"
 #include "node_context.h" // Now we can include the full definition
 #include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
 
 namespace ignlink {
 namespace msg {
 
+namespace {
+
+uint64_t next_publisher_id() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
 PublisherImpl::PublisherImpl(const std::string& topic_name,
-                             const std::string& type_name,
-                             std::weak_ptr<NodeContext> context)
-    : topic_name_(topic_name), type_name_(type_name), context_(context) {}
-
-core::Status PublisherImpl::publish(const std::any& msg) {
-    // Check if the context (the engine room) is still alive.
-    if (context_.expired()) {
-        core::Logger::warn("Attempted to publish on topic '{}' but NodeContext is gone.", topic_name_);
-        return core::Status(core::Status::Code::Unavailable, "NodeContext has been destroyed.");
+                             const MessageType& type,
+                             const QoS& qos,
+                             std::shared_ptr<NodeContext> context)
+    : topic_name_(topic_name), type_(type), qos_(qos), id_(next_publisher_id()), context_(std::move(context)) {}
+
+core::Status PublisherImpl::publish(std::shared_ptr<const void> msg) {
+    if (!topic_) {
+        return core::Status(core::Status::Code::Unavailable, "Publisher is not registered.");
     }
-    
-    // In a real implementation, this is where you would:
-    // 1. Lock the context_ shared_ptr.
-    // 2. Serialize the message (the `std::any`) into a byte buffer.
-    // 3. Get the transport layer from the context.
-    // 4. Call `transport->write(buffer)`.
-    
+
     core::Logger::trace("Publishing message on topic '{}'", topic_name_);
-    
-    // For now, our job is just to log that we were called.
-    return core::Status::OK();
+
+    MessageInfo info;
+    info.publisher_id = id_;
+    info.sequence = sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+    info.publish_time_ns = core::MonotonicClock::now_ns();
+
+    // Hand the shared message to the context. Only the pointer travels from here
+    // on; every in-process subscriber will see this exact object.
+    // Only a KeepAll publisher waits for full KeepAll subscriber queues.
+    const auto max_blocking_time =
+        qos_.history == QoS::History::KeepAll ? qos_.max_blocking_time : std::chrono::nanoseconds::zero();
+    return context_->publish(*topic_, std::move(msg), info, max_blocking_time);
 }
 
+void PublisherImpl::unregister() {
+    if (topic_) {
+        context_->unregister_publisher(this);
+    }
+}
+
+namespace detail {
+
+core::Status publish_erased(PublisherImpl& impl, std::shared_ptr<const void> msg) {
+    return impl.publish(std::move(msg));
+}
+
+void unregister_publisher(PublisherImpl& impl) {
+    impl.unregister();
+}
+
+} // namespace detail
+
 } // namespace msg
 } // namespace ignlink
\ No newline at end of file
@@ -1,21 +1,164 @@
 #include "subscriber_impl.h"
+#include "node_context.h"
 #include <ignlink/core/logger.h>
+#include <ignlink/core/timestamp.h>
+
+#include <algorithm>
 
 namespace ignlink {
 namespace msg {
 
+namespace {
+
+// Messages one dispatch delivers before handing its executor thread back.
+constexpr size_t kDispatchBatch = 32;
+
+} // namespace
+
 SubscriberImpl::SubscriberImpl(const std::string& topic_name,
-                               const std::string& type_name,
-                               std::function<void(const std::any&)> callback,
+                               const MessageType& type,
+                               Callback callback,
+                               std::shared_ptr<core::CallbackGroup> callback_group,
+                               const QoS& qos,
                                std::weak_ptr<NodeContext> context)
-    : topic_name_(topic_name), type_name_(type_name), callback_(callback), context_(context) {}
+    : topic_name_(topic_name), type_(type), callback_(std::move(callback)),
+      callback_group_(std::move(callback_group)), qos_(qos), context_(context) {
+    if (!callback_group_) {
+        // By default every subscriber is its own mutually exclusive group: its
+        // callbacks never overlap, but they run in parallel with everyone else's.
+        callback_group_ = std::make_shared<core::CallbackGroup>(core::CallbackGroup::Type::MutuallyExclusive);
+    }
+    qos_.depth = std::max<size_t>(1, qos_.depth);
+    slots_.resize(qos_.depth);
+    if (callback_group_->type() == core::CallbackGroup::Type::Reentrant) {
+        // Let as many dispatches run in parallel as there can be messages.
+        max_dispatchers_ = qos_.depth;
+    }
+}
+
+SubscriberImpl::Offer SubscriberImpl::push_locked(const std::shared_ptr<const void>& msg, const MessageInfo& info) {
+    Slot& slot = slots_[(head_ + size_) % slots_.size()];
+    slot.msg = msg;
+    slot.info = info;
+    ++size_;
+    if (dispatchers_ < max_dispatchers_ && dispatchers_ < size_) {
+        ++dispatchers_;
+        return Offer::NeedDispatch;
+    }
+    return Offer::Queued;
+}
+
+SubscriberImpl::Offer SubscriberImpl::offer(const std::shared_ptr<const void>& msg, const MessageInfo& info,
+                                            bool may_block) {
+    std::shared_ptr<const void> evicted; // Released outside the lock
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_.load(std::memory_order_relaxed)) {
+        return Offer::Dropped;
+    }
+    if (size_ == slots_.size()) {
+        if (qos_.history == QoS::History::KeepAll) {
+            if (may_block) {
+                return Offer::Full;
+            }
+        } else if (qos_.drop_policy == QoS::DropPolicy::DropOldest) {
+            evicted = std::move(slots_[head_].msg);
+            head_ = (head_ + 1) % slots_.size();
+            --size_;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return push_locked(msg, info);
+        }
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return Offer::Dropped;
+    }
+    return push_locked(msg, info);
+}
+
+SubscriberImpl::Offer SubscriberImpl::offer_blocking(const std::shared_ptr<const void>& msg, const MessageInfo& info,
+                                                     std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++waiting_publishers_;
+    const bool room = not_full_.wait_until(lock, deadline, [this] {
+        return size_ < slots_.size() || !active_.load(std::memory_order_relaxed);
+    });
+    --waiting_publishers_;
+    if (!active_.load(std::memory_order_relaxed)) {
+        return Offer::Dropped;
+    }
+    if (!room) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return Offer::Dropped;
+    }
+    return push_locked(msg, info);
+}
 
-void SubscriberImpl::invoke_callback(const std::any& msg) {
-    if (callback_) {
+bool SubscriberImpl::dispatch() {
+    for (size_t i = 0; i < kDispatchBatch; ++i) {
+        Slot slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (size_ == 0) {
+                --dispatchers_;
+                return false;
+            }
+            slot = std::move(slots_[head_]);
+            head_ = (head_ + 1) % slots_.size();
+            --size_;
+            if (waiting_publishers_ > 0) {
+                not_full_.notify_all();
+            }
+        }
+        invoke_callback(slot.msg, slot.info);
+    }
+
+    // Batch used up. Keep this dispatch's place if there is more to do.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ == 0) {
+        --dispatchers_;
+        return false;
+    }
+    return true;
+}
+
+void SubscriberImpl::invoke_callback(const std::shared_ptr<const void>& msg, const MessageInfo& info) {
+    if (callback_ && active_.load(std::memory_order_acquire)) {
         core::Logger::trace("Invoking callback for topic '{}'", topic_name_);
-        callback_(msg);
+        MessageInfo received = info;
+        received.receive_time_ns = core::MonotonicClock::now_ns();
+        callback_(msg, received);
     }
 }
 
+void SubscriberImpl::unregister() {
+    if (!active_.exchange(false)) {
+        return;
+    }
+    if (auto context = context_.lock()) {
+        context->unregister_subscriber(this);
+    }
+
+    // Drop whatever is still queued and release publishers waiting for room.
+    std::vector<Slot> released(slots_.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released.swap(slots_);
+        slots_.resize(released.size());
+        head_ = 0;
+        size_ = 0;
+        not_full_.notify_all();
+    }
+}
+
+namespace detail {
+
+void unregister_subscriber(SubscriberImpl& impl) {
+    impl.unregister();
+}
+
+uint64_t subscriber_dropped_messages(const SubscriberImpl& impl) {
+    return impl.dropped_messages();
+}
+
+} // namespace detail
+
 } // namespace msg
-} // namespace ignlink
\ No newline at end of file
+} // namespace ignlink
@@ -0,0 +1,783 @@
+#include <ignlink/msg/transport/ipc.h>
+#include <ignlink/core/logger.h>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Shared-memory layout
+// -----------------------------------------------------------------------------
+// [SegmentHeader][ReaderEntry x kMaxReaders][slot 0][slot 1]...[slot N-1]
+// Each slot is a SlotHeader followed by `slot_capacity` payload bytes, padded
+// to a whole number of cache lines. Message sequence numbers start at 1 and
+// message `seq` always lives in slot `(seq - 1) % slot_count`.
+
+constexpr uint32_t kMagic = 0x4B4C4749; // "IGLK"
+constexpr uint32_t kVersion = 3;
+constexpr size_t kCacheLine = 64;
+
+// Readers that can hold zero-copy views at the same time, and how many views
+// each of them may hold.
+constexpr uint32_t kMaxReaders = 64;
+constexpr uint32_t kPinsPerReader = 7;
+
+// How long a reader busy-waits for new data before falling back to a futex.
+constexpr auto kSpinDuration = std::chrono::microseconds(20);
+
+// How long a reader with no entry in the reader table sleeps between checks.
+constexpr auto kUntrackedNap = std::chrono::milliseconds(1);
+
+// How long an opener waits for the creator to finish initializing a segment.
+constexpr auto kInitTimeout = std::chrono::seconds(1);
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "IPC needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "IPC needs lock-free 32-bit atomics");
+
+struct alignas(kCacheLine) SegmentHeader {
+    std::atomic<uint32_t> magic;       // Set last by the creator, once the rest is valid
+    uint32_t version;
+    uint64_t type_hash;
+    uint64_t slot_count;
+    uint64_t slot_capacity;            // Payload bytes per slot
+    uint64_t slot_stride;              // Bytes per slot, header included
+    char type_name[128];
+
+    // Written by the single writer, read by everyone. Kept on their own cache
+    // lines so readers polling `write_seq` don't false-share with the futex.
+    alignas(kCacheLine) std::atomic<uint64_t> write_seq; // Last committed sequence (0 = none yet)
+    alignas(kCacheLine) std::atomic<int32_t> writer_pid; // 0 when no writer is attached
+    alignas(kCacheLine) std::atomic<uint32_t> futex_word; // Bumped on every commit
+    std::atomic<uint32_t> sleepers;                      // Readers blocked in FUTEX_WAIT (see ReaderEntry::sleeper)
+    alignas(kCacheLine) std::atomic<uint32_t> reader_hwm; // Reader entries ever used; bounds the pin scan
+};
+
+/**
+ * One registered reader: who it is, whether it is asleep on the futex, and
+ * which messages it currently pins. A pinned sequence number keeps the writer
+ * from reusing that message's slot.
+ *
+ * `sleeper` holds the reader's PID while it counts towards
+ * SegmentHeader::sleepers. Whoever clears it (the reader on waking, or
+ * whoever finds its process dead) takes the reader out of the count, so
+ * each sleep is uncounted exactly once.
+ */
+struct alignas(kCacheLine) ReaderEntry {
+    std::atomic<int32_t> pid;                    // 0 when the entry is free
+    std::atomic<int32_t> sleeper;                // PID of the reader while asleep, else 0
+    std::atomic<uint64_t> pinned[kPinsPerReader]; // 0 when the pin is unused
+};
+static_assert(sizeof(ReaderEntry) == kCacheLine, "ReaderEntry should fill exactly one cache line");
+
+struct alignas(kCacheLine) SlotHeader {
+    // (seq << 1) once message `seq` is complete, (seq << 1) | 1 while it is
+    // being written. A reader that sees the same even value before and after
+    // copying knows the copy is intact.
+    std::atomic<uint64_t> state;
+    uint64_t size;
+};
+
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const timespec* timeout) {
+    // Deliberately not FUTEX_PRIVATE_FLAG: the word is shared between processes.
+    return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+bool process_alive(int32_t pid) {
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+/**
+ * @brief Takes a reader that died asleep out of the sleeper count.
+ */
+void reap_sleeper(SegmentHeader* hdr, ReaderEntry* entry) {
+    int32_t sleeper = entry->sleeper.load();
+    if (sleeper != 0 && !process_alive(sleeper) && entry->sleeper.compare_exchange_strong(sleeper, 0)) {
+        hdr->sleepers.fetch_sub(1);
+    }
+}
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+/**
+ * @class Segment
+ * @brief A mapped shared-memory segment for one topic.
+ */
+class Segment {
+public:
+    ~Segment() {
+        if (base_ != MAP_FAILED) {
+            ::munmap(base_, size_);
+        }
+    }
+
+    /**
+     * @brief Opens a topic's segment, creating and initializing it if needed.
+     */
+    static core::Status open(const std::string& name, const TopicOptions& options,
+                             std::unique_ptr<Segment>* out) {
+        if (options.depth == 0 || options.max_message_size == 0) {
+            return core::Status(core::Status::Code::InvalidArgument, "Topic depth and max_message_size must be non-zero.");
+        }
+
+        std::unique_ptr<Segment> segment(new Segment());
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        const bool creator = fd >= 0;
+        if (!creator) {
+            if (errno != EEXIST) {
+                return errno_status("shm_open(" + name + ")");
+            }
+            fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+            if (fd < 0) {
+                return errno_status("shm_open(" + name + ")");
+            }
+        }
+
+        core::Status status = creator ? segment->initialize(fd, options) : segment->attach(fd, name);
+        ::close(fd);
+        if (!status.ok()) {
+            if (creator) {
+                ::shm_unlink(name.c_str()); // Don't leave a half-built segment behind.
+            }
+            return status;
+        }
+
+        // Both ends must agree on what travels over the topic.
+        const SegmentHeader* hdr = segment->header();
+        if (options.type_hash != 0 && hdr->type_hash != 0 && options.type_hash != hdr->type_hash) {
+            return core::Status(core::Status::Code::InvalidArgument,
+                                "Type mismatch on topic '" + options.topic_name + "': segment carries '" +
+                                    std::string(hdr->type_name) + "', requested '" + options.type_name + "'.");
+        }
+
+        *out = std::move(segment);
+        return core::Status::OK();
+    }
+
+    SegmentHeader* header() const { return static_cast<SegmentHeader*>(base_); }
+
+    ReaderEntry* reader_entry(uint32_t index) const {
+        return reinterpret_cast<ReaderEntry*>(static_cast<uint8_t*>(base_) + sizeof(SegmentHeader)) + index;
+    }
+
+    SlotHeader* slot(uint64_t seq) const {
+        const SegmentHeader* hdr = header();
+        uint8_t* first = static_cast<uint8_t*>(base_) + kSlotsOffset;
+        return reinterpret_cast<SlotHeader*>(first + ((seq - 1) % hdr->slot_count) * hdr->slot_stride);
+    }
+
+    static uint8_t* payload(SlotHeader* slot) {
+        return reinterpret_cast<uint8_t*>(slot) + sizeof(SlotHeader);
+    }
+
+private:
+    static constexpr size_t kSlotsOffset = sizeof(SegmentHeader) + sizeof(ReaderEntry) * kMaxReaders;
+
+    Segment() = default;
+
+    core::Status initialize(int fd, const TopicOptions& options) {
+        const size_t stride = round_up(sizeof(SlotHeader) + options.max_message_size, kCacheLine);
+        size_ = kSlotsOffset + stride * options.depth;
+        if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            return errno_status("ftruncate");
+        }
+        base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base_ == MAP_FAILED) {
+            return errno_status("mmap");
+        }
+
+        // ftruncate zero-fills, so every atomic already reads as 0.
+        SegmentHeader* hdr = header();
+        hdr->version = kVersion;
+        hdr->type_hash = options.type_hash;
+        hdr->slot_count = options.depth;
+        hdr->slot_capacity = options.max_message_size;
+        hdr->slot_stride = stride;
+        std::strncpy(hdr->type_name, options.type_name.c_str(), sizeof(hdr->type_name) - 1);
+        hdr->magic.store(kMagic, std::memory_order_release);
+        return core::Status::OK();
+    }
+
+    core::Status attach(int fd, const std::string& name) {
+        // The creator may still be between shm_open and ftruncate/initialize.
+        const auto deadline = std::chrono::steady_clock::now() + kInitTimeout;
+        struct stat st {};
+        while (true) {
+            if (::fstat(fd, &st) != 0) {
+                return errno_status("fstat");
+            }
+            if (static_cast<size_t>(st.st_size) >= sizeof(SegmentHeader)) {
+                break;
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                return core::Status(core::Status::Code::Timeout, "Segment '" + name + "' was never initialized.");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        size_ = static_cast<size_t>(st.st_size);
+        base_ = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base_ == MAP_FAILED) {
+            return errno_status("mmap");
+        }
+
+        SegmentHeader* hdr = header();
+        while (hdr->magic.load(std::memory_order_acquire) != kMagic) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return core::Status(core::Status::Code::Timeout, "Segment '" + name + "' was never initialized.");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (hdr->version != kVersion) {
+            return core::Status(core::Status::Code::InvalidArgument, "Segment '" + name + "' has an incompatible layout version.");
+        }
+        if (size_ < kSlotsOffset + hdr->slot_stride * hdr->slot_count) {
+            return core::Status(core::Status::Code::InvalidArgument, "Segment '" + name + "' is truncated.");
+        }
+        return core::Status::OK();
+    }
+
+    void* base_ = MAP_FAILED;
+    size_t size_ = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+class IpcWriter : public TransportWriter {
+public:
+    explicit IpcWriter(std::unique_ptr<Segment> segment)
+        : segment_(std::move(segment)), pid_(static_cast<int32_t>(::getpid())) {}
+
+    ~IpcWriter() override {
+        // Detach so that another process may become the writer. A writer that
+        // was refused must not release the claim of the one that holds it.
+        if (attached_) {
+            int32_t expected = pid_;
+            segment_->header()->writer_pid.compare_exchange_strong(expected, 0);
+        }
+    }
+
+    /**
+     * @brief Claims the single-writer role for this process.
+     */
+    core::Status attach(const std::string& topic_name) {
+        SegmentHeader* hdr = segment_->header();
+        int32_t current = hdr->writer_pid.load();
+        while (true) {
+            if (current == pid_ || process_alive(current)) {
+                return core::Status(core::Status::Code::AlreadyExists,
+                                    "Topic '" + topic_name + "' already has a writer (pid " + std::to_string(current) + ").");
+            }
+            // Either nobody is writing, or the previous writer died. Any slot it
+            // left half-written is never published and is simply rewritten.
+            if (hdr->writer_pid.compare_exchange_weak(current, pid_)) {
+                attached_ = true;
+                return core::Status::OK();
+            }
+        }
+    }
+
+    core::Status write(const void* data, size_t size) override {
+        if (loan_seq_ != 0) {
+            return core::Status(core::Status::Code::InvalidArgument, "Cannot write while a loan is outstanding.");
+        }
+        SlotHeader* slot = nullptr;
+        const uint64_t seq = segment_->header()->write_seq.load(std::memory_order_relaxed) + 1;
+        core::Status status = claim(seq, size, &slot);
+        if (!status.ok()) {
+            return status;
+        }
+        std::memcpy(Segment::payload(slot), data, size);
+        finish(seq, slot, size);
+        return core::Status::OK();
+    }
+
+    bool supports_loans() const override { return true; }
+
+    core::Status loan(size_t size, void** buffer) override {
+        if (loan_seq_ != 0) {
+            return core::Status(core::Status::Code::InvalidArgument, "A loan is already outstanding.");
+        }
+        SlotHeader* slot = nullptr;
+        const uint64_t seq = segment_->header()->write_seq.load(std::memory_order_relaxed) + 1;
+        core::Status status = claim(seq, size, &slot);
+        if (!status.ok()) {
+            return status;
+        }
+        loan_seq_ = seq;
+        *buffer = Segment::payload(slot);
+        return core::Status::OK();
+    }
+
+    core::Status commit(size_t size) override {
+        if (loan_seq_ == 0) {
+            return core::Status(core::Status::Code::InvalidArgument, "No loan is outstanding.");
+        }
+        if (size > segment_->header()->slot_capacity) {
+            discard();
+            return core::Status(core::Status::Code::InvalidArgument, "Committed size exceeds the slot size.");
+        }
+        const uint64_t seq = loan_seq_;
+        loan_seq_ = 0;
+        finish(seq, segment_->slot(seq), size);
+        return core::Status::OK();
+    }
+
+    void discard() override {
+        // The slot stays marked "being written" for a sequence that was never
+        // published; the next write simply claims it again.
+        loan_seq_ = 0;
+    }
+
+private:
+    /**
+     * @brief Takes ownership of the slot for message `seq`, unless a reader still pins its old message.
+     */
+    core::Status claim(uint64_t seq, size_t size, SlotHeader** out) {
+        SegmentHeader* hdr = segment_->header();
+        if (size > hdr->slot_capacity) {
+            return core::Status(core::Status::Code::InvalidArgument,
+                                "Message of " + std::to_string(size) + " bytes exceeds the slot size of " +
+                                    std::to_string(hdr->slot_capacity) + " bytes.");
+        }
+
+        SlotHeader* slot = segment_->slot(seq);
+        const uint64_t previous_state = slot->state.load(std::memory_order_relaxed);
+
+        // Seqlock write, part 1: mark the slot busy. This store and the pin scan
+        // below pair with the reader's pin-then-check in `IpcReader::pin`, so
+        // either we see the pin or the reader sees the slot going away.
+        slot->state.store((seq << 1) | 1);
+        if (seq > hdr->slot_count && is_pinned(seq - hdr->slot_count)) {
+            slot->state.store(previous_state, std::memory_order_release);
+            return core::Status(core::Status::Code::Unavailable,
+                                "The oldest message is still loaned to a reader; try again shortly.");
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        *out = slot;
+        return core::Status::OK();
+    }
+
+    /**
+     * @brief Seqlock write, part 2: mark the slot complete and publish it.
+     */
+    void finish(uint64_t seq, SlotHeader* slot, size_t size) {
+        SegmentHeader* hdr = segment_->header();
+        slot->size = size;
+        slot->state.store(seq << 1, std::memory_order_release);
+
+        // The seq_cst bump of the futex word orders the commit before the
+        // sleeper check (see IpcReader::wait).
+        hdr->write_seq.store(seq, std::memory_order_release);
+        hdr->futex_word.fetch_add(1);
+        if (hdr->sleepers.load() > 0 && futex(&hdr->futex_word, FUTEX_WAKE, INT_MAX, nullptr) == 0) {
+            // Nobody was actually asleep: either a reader is about to be, or
+            // one died asleep and would cost a syscall on every commit.
+            reap_sleepers();
+        }
+    }
+
+    void reap_sleepers() {
+        SegmentHeader* hdr = segment_->header();
+        const uint32_t used = std::min(hdr->reader_hwm.load(), kMaxReaders);
+        for (uint32_t r = 0; r < used; ++r) {
+            reap_sleeper(hdr, segment_->reader_entry(r));
+        }
+    }
+
+    /**
+     * @brief Checks whether any live reader pins message `seq`, clearing pins left by dead readers.
+     */
+    bool is_pinned(uint64_t seq) {
+        const uint32_t used = std::min(segment_->header()->reader_hwm.load(), kMaxReaders);
+        for (uint32_t r = 0; r < used; ++r) {
+            ReaderEntry* entry = segment_->reader_entry(r);
+            for (uint32_t p = 0; p < kPinsPerReader; ++p) {
+                if (entry->pinned[p].load() != seq) {
+                    continue;
+                }
+                if (process_alive(entry->pid.load())) {
+                    return true;
+                }
+                // The reader died holding the view. Its pin can go.
+                uint64_t expected = seq;
+                entry->pinned[p].compare_exchange_strong(expected, 0);
+            }
+        }
+        return false;
+    }
+
+    std::unique_ptr<Segment> segment_;
+    const int32_t pid_;
+    bool attached_ = false; // Set once attach() has claimed the writer role
+    uint64_t loan_seq_ = 0; // Sequence of the outstanding loan, 0 if none
+};
+
+// -----------------------------------------------------------------------------
+// Reader
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief State shared between a reader and the zero-copy views it hands out.
+ *
+ * Views may outlive the IpcReader, so the mapping and the reader's entry in the
+ * segment stay alive until the last view is gone.
+ */
+struct ReaderState {
+    std::shared_ptr<Segment> segment;
+    ReaderEntry* entry = nullptr;                         // Null if the reader table was full
+    std::atomic<uint32_t> free_pins{(1u << kPinsPerReader) - 1}; // Bit per unused pin
+
+    ~ReaderState() {
+        if (entry) {
+            for (auto& pin : entry->pinned) {
+                pin.store(0);
+            }
+            entry->pid.store(0);
+        }
+    }
+};
+
+class IpcReader : public TransportReader {
+public:
+    explicit IpcReader(std::unique_ptr<Segment> segment)
+        : state_(std::make_shared<ReaderState>()),
+          buffer_(segment->header()->slot_capacity),
+          // Start at the live edge: a new subscriber sees new messages only.
+          next_seq_(segment->header()->write_seq.load(std::memory_order_acquire) + 1) {
+        state_->segment = std::move(segment);
+        state_->entry = register_reader(*state_->segment);
+    }
+
+    size_t poll(const MessageCallback& callback) override {
+        return consume([&](uint64_t seq, SlotHeader* slot) {
+            // Copy out under the seqlock, then hand the copy over.
+            const size_t size = static_cast<size_t>(slot->size);
+            if (size > buffer_.size()) {
+                return false;
+            }
+            std::memcpy(buffer_.data(), Segment::payload(slot), size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->state.load(std::memory_order_relaxed) != (seq << 1)) {
+                return false;
+            }
+            callback(buffer_.data(), size);
+            return true;
+        });
+    }
+
+    size_t poll_shared(const SharedMessageCallback& callback) override {
+        return consume([&](uint64_t seq, SlotHeader* slot) {
+            int pin = acquire_pin(seq, slot);
+            if (pin == kNoPin) {
+                return false; // Overwritten before we could pin it.
+            }
+            if (pin == kNoFreePin) {
+                // Every pin is in use: fall back to a private copy.
+                const size_t size = static_cast<size_t>(slot->size);
+                if (size > buffer_.size()) {
+                    return false;
+                }
+                std::shared_ptr<uint8_t> copy(new uint8_t[size], std::default_delete<uint8_t[]>());
+                std::memcpy(copy.get(), Segment::payload(slot), size);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot->state.load(std::memory_order_relaxed) != (seq << 1)) {
+                    return false;
+                }
+                callback(std::move(copy), size);
+                return true;
+            }
+
+            // Pinned: the slot is ours until the view is released.
+            std::shared_ptr<ReaderState> state = state_;
+            std::shared_ptr<const void> view(Segment::payload(slot), [state, pin](const void*) {
+                state->entry->pinned[pin].store(0, std::memory_order_release);
+                state->free_pins.fetch_or(1u << pin);
+            });
+            callback(std::move(view), static_cast<size_t>(slot->size));
+            return true;
+        });
+    }
+
+    bool wait(std::chrono::nanoseconds timeout) override {
+        SegmentHeader* hdr = state_->segment->header();
+        const uint64_t seen = next_seq_ - 1;
+        auto has_data = [&] { return hdr->write_seq.load(std::memory_order_acquire) > seen; };
+
+        // 1. Spin briefly: under load the next message is usually microseconds
+        //    away, and catching it here costs no syscall at all.
+        const auto start = std::chrono::steady_clock::now();
+        const auto spin_until = start + std::min<std::chrono::nanoseconds>(timeout, kSpinDuration);
+        for (uint32_t i = 0;; ++i) {
+            if (has_data()) {
+                return true;
+            }
+            if ((i & 63) == 0 && std::chrono::steady_clock::now() >= spin_until) {
+                break;
+            }
+            cpu_relax();
+        }
+
+        // 2. Sleep on the futex. Registering as a sleeper before re-checking
+        //    pairs with the writer's commit-then-check-sleepers order, so a
+        //    commit can't slip in between unnoticed. The entry records the
+        //    sleep, so that if this process dies asleep the writer can take it
+        //    back out of the count.
+        auto remaining = timeout - (std::chrono::steady_clock::now() - start);
+        if (remaining <= std::chrono::nanoseconds::zero()) {
+            return has_data();
+        }
+        ReaderEntry* entry = state_->entry;
+        if (!entry) {
+            return nap(remaining, has_data);
+        }
+        const int32_t pid = entry->pid.load(std::memory_order_relaxed);
+        hdr->sleepers.fetch_add(1);
+        entry->sleeper.store(pid);
+        const uint32_t word = hdr->futex_word.load();
+        if (!has_data()) {
+            const timespec ts = to_timespec(remaining);
+            futex(&hdr->futex_word, FUTEX_WAIT, word, &ts);
+        }
+        int32_t sleeper = pid;
+        if (entry->sleeper.compare_exchange_strong(sleeper, 0)) {
+            hdr->sleepers.fetch_sub(1);
+        }
+        return has_data();
+    }
+
+    uint64_t lost_messages() const override {
+        return lost_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kNoPin = -1;     // The message was overwritten
+    static constexpr int kNoFreePin = -2; // The message is intact but we have no pin to spare
+
+    static timespec to_timespec(std::chrono::nanoseconds duration) {
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(duration.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(duration.count() % 1000000000);
+        return ts;
+    }
+
+    /**
+     * @brief Waits without counting as a sleeper, for a reader the table had no
+     *        entry for: a count that nobody could correct if this process died.
+     *        Commits still wake it; it also looks again every kUntrackedNap.
+     */
+    template <typename HasData>
+    bool nap(std::chrono::nanoseconds remaining, const HasData& has_data) {
+        SegmentHeader* hdr = state_->segment->header();
+        const auto until = std::chrono::steady_clock::now() + remaining;
+        while (!has_data() && remaining > std::chrono::nanoseconds::zero()) {
+            const uint32_t word = hdr->futex_word.load();
+            if (has_data()) {
+                break;
+            }
+            const timespec ts = to_timespec(std::min<std::chrono::nanoseconds>(remaining, kUntrackedNap));
+            futex(&hdr->futex_word, FUTEX_WAIT, word, &ts);
+            remaining = until - std::chrono::steady_clock::now();
+        }
+        return has_data();
+    }
+
+    /**
+     * @brief Claims a free (or abandoned) entry in the segment's reader table.
+     */
+    static ReaderEntry* register_reader(Segment& segment) {
+        const int32_t pid = static_cast<int32_t>(::getpid());
+        for (uint32_t r = 0; r < kMaxReaders; ++r) {
+            ReaderEntry* entry = segment.reader_entry(r);
+            int32_t current = entry->pid.load();
+            if (current != 0 && process_alive(current)) {
+                continue;
+            }
+            if (entry->pid.compare_exchange_strong(current, pid)) {
+                // Drop whatever a dead predecessor left behind.
+                reap_sleeper(segment.header(), entry);
+                for (auto& pin : entry->pinned) {
+                    pin.store(0);
+                }
+                uint32_t hwm = segment.header()->reader_hwm.load();
+                while (hwm < r + 1 && !segment.header()->reader_hwm.compare_exchange_weak(hwm, r + 1)) {
+                }
+                return entry;
+            }
+        }
+        core::Logger::warn("IPC reader table is full; this reader will copy instead of pinning.");
+        return nullptr;
+    }
+
+    /**
+     * @brief Walks the ring from `next_seq_` to the head, handing each intact slot to `deliver`.
+     *
+     * `deliver` returns false if the slot turned out to be overwritten, in
+     * which case the message is counted as lost.
+     */
+    template <typename Deliver>
+    size_t consume(Deliver&& deliver) {
+        SegmentHeader* hdr = state_->segment->header();
+        const uint64_t slot_count = hdr->slot_count;
+        size_t delivered = 0;
+
+        uint64_t head = hdr->write_seq.load(std::memory_order_acquire);
+        while (next_seq_ <= head) {
+            // Fell a whole ring behind: everything older than the ring is gone.
+            if (head - next_seq_ >= slot_count) {
+                const uint64_t oldest = head - slot_count + 1;
+                lost_.fetch_add(oldest - next_seq_, std::memory_order_relaxed);
+                next_seq_ = oldest;
+            }
+
+            const uint64_t seq = next_seq_++;
+            SlotHeader* slot = state_->segment->slot(seq);
+            if (slot->state.load(std::memory_order_acquire) == (seq << 1) && deliver(seq, slot)) {
+                ++delivered;
+                continue;
+            }
+
+            // The writer lapped us while we were looking. Count it and move on.
+            lost_.fetch_add(1, std::memory_order_relaxed);
+            head = hdr->write_seq.load(std::memory_order_acquire);
+        }
+        return delivered;
+    }
+
+    /**
+     * @brief Pins message `seq` so the writer leaves its slot alone.
+     * @return The pin index, kNoPin if the message is gone, or kNoFreePin.
+     */
+    int acquire_pin(uint64_t seq, SlotHeader* slot) {
+        if (!state_->entry) {
+            return kNoFreePin;
+        }
+        uint32_t free_pins = state_->free_pins.load();
+        int pin;
+        do {
+            if (free_pins == 0) {
+                return kNoFreePin;
+            }
+            pin = __builtin_ctz(free_pins);
+        } while (!state_->free_pins.compare_exchange_weak(free_pins, free_pins & ~(1u << pin)));
+
+        // Publish the pin, then make sure the message is still there. Pairs
+        // with the writer's mark-busy-then-scan in `IpcWriter::claim`.
+        state_->entry->pinned[pin].store(seq);
+        if (slot->state.load() != (seq << 1)) {
+            state_->entry->pinned[pin].store(0);
+            state_->free_pins.fetch_or(1u << pin);
+            return kNoPin;
+        }
+        return pin;
+    }
+
+    std::shared_ptr<ReaderState> state_;
+    std::vector<uint8_t> buffer_;  // Reused for every copied message; no per-message allocation
+    uint64_t next_seq_;
+    std::atomic<uint64_t> lost_{0};
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// IpcTransport
+// -----------------------------------------------------------------------------
+
+IpcTransport::IpcTransport(const std::string& domain) : domain_(domain) {}
+
+std::string IpcTransport::segment_name(const std::string& topic_name) const {
+    // POSIX shm names are a single path component: "/camera/image" becomes
+    // "/<domain>.camera.image".
+    std::string name = "/" + domain_;
+    for (char c : topic_name) {
+        if (c == '/') {
+            if (name.back() != '.') {
+                name += '.';
+            }
+        } else {
+            name += c;
+        }
+    }
+    return name;
+}
+
+core::Status IpcTransport::create_writer(const TopicOptions& options,
+                                         std::unique_ptr<TransportWriter>* writer) {
+    std::unique_ptr<Segment> segment;
+    core::Status status = Segment::open(segment_name(options.topic_name), options, &segment);
+    if (!status.ok()) {
+        return status;
+    }
+    if (segment->header()->slot_capacity < options.max_message_size) {
+        return core::Status(core::Status::Code::InvalidArgument,
+                            "Existing segment for topic '" + options.topic_name + "' has slots of " +
+                                std::to_string(segment->header()->slot_capacity) + " bytes, smaller than the requested " +
+                                std::to_string(options.max_message_size) + ".");
+    }
+
+    auto ipc_writer = std::make_unique<IpcWriter>(std::move(segment));
+    status = ipc_writer->attach(options.topic_name);
+    if (!status.ok()) {
+        return status;
+    }
+    core::Logger::info("IPC writer attached to '{}'", segment_name(options.topic_name));
+    *writer = std::move(ipc_writer);
+    return core::Status::OK();
+}
+
+core::Status IpcTransport::create_reader(const TopicOptions& options,
+                                         std::unique_ptr<TransportReader>* reader) {
+    std::unique_ptr<Segment> segment;
+    core::Status status = Segment::open(segment_name(options.topic_name), options, &segment);
+    if (!status.ok()) {
+        return status;
+    }
+    core::Logger::info("IPC reader attached to '{}'", segment_name(options.topic_name));
+    *reader = std::make_unique<IpcReader>(std::move(segment));
+    return core::Status::OK();
+}
+
+core::Status IpcTransport::unlink(const std::string& topic_name) const {
+    if (::shm_unlink(segment_name(topic_name).c_str()) != 0 && errno != ENOENT) {
+        return errno_status("shm_unlink");
+    }
+    return core::Status::OK();
+}
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
@@ -0,0 +1,512 @@
+#include <ignlink/msg/transport/udp.h>
+#include <ignlink/core/logger.h>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace ignlink {
+namespace msg {
+namespace transport {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4B4C4755; // "UGLK"
+constexpr uint16_t kVersion = 1;
+
+/**
+ * Prefix of every datagram. Fields are little-endian on the wire.
+ */
+struct __attribute__((packed)) WireHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t fragment_count;  // Datagrams making up the message
+    uint64_t topic_hash;
+    uint64_t type_hash;
+    uint64_t writer_id;       // Random per writer; separates sequences of concurrent writers
+    uint64_t sequence;        // Per-writer message sequence, starting at 1
+    uint32_t message_size;    // Total bytes of the reassembled message
+    uint32_t fragment_offset; // Where this fragment's bytes go in the message
+    uint16_t fragment_index;
+};
+
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+core::Status errno_status(const std::string& what) {
+    return core::Status(core::Status::Code::Error, what + ": " + std::strerror(errno));
+}
+
+core::Status parse_address(const std::string& text, in_addr* out) {
+    if (::inet_pton(AF_INET, text.c_str(), out) != 1) {
+        return core::Status(core::Status::Code::InvalidArgument, "Invalid IPv4 address '" + text + "'.");
+    }
+    return core::Status::OK();
+}
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+class UdpWriter : public TransportWriter {
+public:
+    UdpWriter(int fd, const TopicOptions& topic, const UdpOptions& options)
+        : fd_(fd),
+          topic_hash_(fnv1a(topic.topic_name)),
+          type_hash_(topic.type_hash),
+          max_message_size_(topic.max_message_size),
+          fragment_size_(options.max_datagram_size - sizeof(WireHeader)),
+          batch_size_(options.batch_size) {
+        std::random_device random;
+        writer_id_ = (static_cast<uint64_t>(random()) << 32) ^ random() ^ static_cast<uint64_t>(::getpid());
+    }
+
+    ~UdpWriter() override { ::close(fd_); }
+
+    core::Status write(const void* data, size_t size) override {
+        if (size > max_message_size_) {
+            return core::Status(core::Status::Code::InvalidArgument,
+                                "Message of " + std::to_string(size) + " bytes exceeds the topic maximum of " +
+                                    std::to_string(max_message_size_) + " bytes.");
+        }
+        const size_t count = std::max<size_t>(1, (size + fragment_size_ - 1) / fragment_size_);
+        if (count > UINT16_MAX) {
+            return core::Status(core::Status::Code::InvalidArgument, "Message needs too many fragments.");
+        }
+
+        // Grow the scratch arrays only when a bigger message than ever before
+        // comes along; steady-state publishing reuses them.
+        if (headers_.size() < count) {
+            headers_.resize(count);
+            iovecs_.resize(count * 2);
+            msgs_.resize(count);
+        }
+
+        const uint64_t sequence = ++sequence_;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t offset = i * fragment_size_;
+            const size_t length = std::min(fragment_size_, size - std::min(size, offset));
+
+            WireHeader& header = headers_[i];
+            header.magic = htole32(kMagic);
+            header.version = htole16(kVersion);
+            header.fragment_count = htole16(static_cast<uint16_t>(count));
+            header.topic_hash = htole64(topic_hash_);
+            header.type_hash = htole64(type_hash_);
+            header.writer_id = htole64(writer_id_);
+            header.sequence = htole64(sequence);
+            header.message_size = htole32(static_cast<uint32_t>(size));
+            header.fragment_offset = htole32(static_cast<uint32_t>(offset));
+            header.fragment_index = htole16(static_cast<uint16_t>(i));
+
+            // Gather the header and a slice of the caller's buffer; the payload
+            // is never copied in user space.
+            iovecs_[2 * i] = {&header, sizeof(WireHeader)};
+            iovecs_[2 * i + 1] = {const_cast<uint8_t*>(bytes) + offset, length};
+            std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[2 * i];
+            msgs_[i].msg_hdr.msg_iovlen = 2;
+        }
+
+        size_t sent = 0;
+        while (sent < count) {
+            const unsigned int batch = static_cast<unsigned int>(std::min(batch_size_, count - sent));
+            int n = ::sendmmsg(fd_, &msgs_[sent], batch, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno_status("sendmmsg");
+            }
+            sent += static_cast<size_t>(n);
+        }
+        return core::Status::OK();
+    }
+
+private:
+    int fd_;
+    uint64_t topic_hash_;
+    uint64_t type_hash_;
+    size_t max_message_size_;
+    size_t fragment_size_;
+    size_t batch_size_;
+    uint64_t writer_id_;
+    uint64_t sequence_ = 0;
+
+    std::vector<WireHeader> headers_;
+    std::vector<iovec> iovecs_;
+    std::vector<mmsghdr> msgs_;
+};
+
+// -----------------------------------------------------------------------------
+// Reader
+// -----------------------------------------------------------------------------
+
+class UdpReader : public TransportReader {
+public:
+    UdpReader(int fd, const TopicOptions& topic, const UdpOptions& options)
+        : fd_(fd),
+          topic_name_(topic.topic_name),
+          topic_hash_(fnv1a(topic.topic_name)),
+          type_hash_(topic.type_hash),
+          max_message_size_(topic.max_message_size),
+          datagram_size_(options.max_datagram_size),
+          batch_size_(options.batch_size),
+          storage_(options.batch_size * options.max_datagram_size),
+          iovecs_(options.batch_size),
+          msgs_(options.batch_size),
+          partials_(options.max_partial_messages) {
+        // The receive buffers are carved out of one allocation, once.
+        for (size_t i = 0; i < batch_size_; ++i) {
+            iovecs_[i] = {storage_.data() + i * datagram_size_, datagram_size_};
+            std::memset(&msgs_[i], 0, sizeof(mmsghdr));
+            msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    ~UdpReader() override { ::close(fd_); }
+
+    size_t poll(const MessageCallback& callback) override {
+        size_t delivered = 0;
+        while (true) {
+            int n = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned int>(batch_size_), MSG_DONTWAIT, nullptr);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    core::Logger::warn("recvmmsg on topic '{}' failed: {}", topic_name_, std::strerror(errno));
+                }
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                const uint8_t* datagram = static_cast<const uint8_t*>(iovecs_[i].iov_base);
+                if (handle(datagram, msgs_[i].msg_len, callback)) {
+                    ++delivered;
+                }
+            }
+            if (static_cast<size_t>(n) < batch_size_) {
+                break; // Socket drained.
+            }
+        }
+        return delivered;
+    }
+
+    bool wait(std::chrono::nanoseconds timeout) override {
+        pollfd pfd{fd_, POLLIN, 0};
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+        int n;
+        do {
+            n = ::ppoll(&pfd, 1, &ts, nullptr);
+        } while (n < 0 && errno == EINTR);
+        return n > 0;
+    }
+
+    uint64_t lost_messages() const override { return lost_; }
+
+private:
+    /**
+     * A message being put back together from its fragments. The buffers are
+     * kept when the slot is reused, so reassembly stops allocating once it has
+     * seen the largest message.
+     */
+    struct Partial {
+        bool active = false;
+        uint64_t writer_id = 0;
+        uint64_t sequence = 0;
+        uint32_t size = 0;
+        uint16_t received = 0;
+        uint16_t count = 0;
+        uint64_t started = 0;          // For evicting the oldest when all slots are busy
+        std::vector<uint8_t> data;
+        std::vector<bool> have;        // Per-fragment, to ignore duplicates
+    };
+
+    /**
+     * @brief Processes one datagram. Returns true if it completed a message that was delivered.
+     */
+    bool handle(const uint8_t* datagram, size_t length, const MessageCallback& callback) {
+        if (length < sizeof(WireHeader)) {
+            return false;
+        }
+        WireHeader header;
+        std::memcpy(&header, datagram, sizeof(header));
+        if (le32toh(header.magic) != kMagic || le16toh(header.version) != kVersion ||
+            le64toh(header.topic_hash) != topic_hash_) {
+            return false; // Not ours (another topic sharing the port, or garbage).
+        }
+        const uint64_t type_hash = le64toh(header.type_hash);
+        if (type_hash_ != 0 && type_hash != 0 && type_hash != type_hash_) {
+            if (!warned_type_mismatch_) {
+                core::Logger::error("Type mismatch on UDP topic '{}': dropping messages from a writer with a different type.", topic_name_);
+                warned_type_mismatch_ = true;
+            }
+            return false;
+        }
+
+        const uint64_t writer_id = le64toh(header.writer_id);
+        const uint64_t sequence = le64toh(header.sequence);
+        const uint32_t size = le32toh(header.message_size);
+        const uint32_t offset = le32toh(header.fragment_offset);
+        const uint16_t count = le16toh(header.fragment_count);
+        const uint16_t index = le16toh(header.fragment_index);
+        const uint8_t* payload = datagram + sizeof(WireHeader);
+        const size_t payload_size = length - sizeof(WireHeader);
+
+        if (size > max_message_size_ || count == 0 || index >= count ||
+            static_cast<size_t>(offset) + payload_size > size) {
+            return false;
+        }
+
+        // Fast path: the whole message is in this datagram. Deliver it straight
+        // out of the receive buffer.
+        if (count == 1) {
+            if (!accept(writer_id, sequence)) {
+                return false;
+            }
+            callback(payload, payload_size);
+            return true;
+        }
+
+        Partial* partial = find_partial(writer_id, sequence, size, count);
+        if (!partial) {
+            return false;
+        }
+        // The bounds above were checked against this datagram's header; a
+        // fragment that disagrees with the message it claims to belong to
+        // (corrupt, or a colliding writer ID) must not write into it.
+        if (partial->size != size || partial->count != count) {
+            ++rejected_;
+            if (!warned_inconsistent_) {
+                core::Logger::error("Inconsistent fragment on UDP topic '{}': dropping it.", topic_name_);
+                warned_inconsistent_ = true;
+            }
+            return false;
+        }
+        if (partial->have[index]) {
+            return false;
+        }
+        std::memcpy(partial->data.data() + offset, payload, payload_size);
+        partial->have[index] = true;
+        if (++partial->received < partial->count) {
+            return false;
+        }
+
+        partial->active = false;
+        if (!accept(writer_id, sequence)) {
+            return false;
+        }
+        callback(partial->data.data(), partial->size);
+        return true;
+    }
+
+    /**
+     * @brief Finds (or starts) the reassembly of a fragmented message.
+     */
+    Partial* find_partial(uint64_t writer_id, uint64_t sequence, uint32_t size, uint16_t count) {
+        auto last = last_sequence_.find(writer_id);
+        if (last != last_sequence_.end() && sequence <= last->second) {
+            return nullptr; // Stale fragment of a message we already gave up on.
+        }
+
+        Partial* victim = nullptr;
+        for (auto& partial : partials_) {
+            if (partial.active && partial.writer_id == writer_id && partial.sequence == sequence) {
+                return &partial;
+            }
+            if (!victim || (victim->active && (!partial.active || partial.started < victim->started))) {
+                victim = &partial;
+            }
+        }
+        if (!victim) {
+            return nullptr;
+        }
+
+        // Reuse the free (or oldest) slot. An evicted message is counted as
+        // lost later, when the sequence gap it leaves is noticed.
+        victim->active = true;
+        victim->writer_id = writer_id;
+        victim->sequence = sequence;
+        victim->size = size;
+        victim->count = count;
+        victim->received = 0;
+        victim->started = ++partial_clock_;
+        victim->data.resize(size);
+        victim->have.assign(count, false);
+        return victim;
+    }
+
+    /**
+     * @brief Decides whether a completed message is new, updating loss accounting.
+     */
+    bool accept(uint64_t writer_id, uint64_t sequence) {
+        auto inserted = last_sequence_.emplace(writer_id, sequence);
+        if (inserted.second) {
+            return true; // First message from this writer: nothing to compare against.
+        }
+        uint64_t& last = inserted.first->second;
+        if (sequence <= last) {
+            return false; // Late or duplicate; its slot in the sequence is already accounted for.
+        }
+        lost_ += sequence - last - 1;
+        last = sequence;
+
+        // Anything older from this writer that is still being reassembled was
+        // just counted as lost; free its slot.
+        for (auto& partial : partials_) {
+            if (partial.active && partial.writer_id == writer_id && partial.sequence < sequence) {
+                partial.active = false;
+            }
+        }
+        return true;
+    }
+
+    int fd_;
+    std::string topic_name_;
+    uint64_t topic_hash_;
+    uint64_t type_hash_;
+    size_t max_message_size_;
+    size_t datagram_size_;
+    size_t batch_size_;
+
+    std::vector<uint8_t> storage_;  // batch_size_ receive buffers of datagram_size_ bytes
+    std::vector<iovec> iovecs_;
+    std::vector<mmsghdr> msgs_;
+
+    std::vector<Partial> partials_;
+    uint64_t partial_clock_ = 0;
+    std::unordered_map<uint64_t, uint64_t> last_sequence_; // writer_id -> last accepted sequence
+    uint64_t lost_ = 0;
+    uint64_t rejected_ = 0; // Fragments inconsistent with their message
+    bool warned_type_mismatch_ = false;
+    bool warned_inconsistent_ = false;
+};
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// UdpTransport
+// -----------------------------------------------------------------------------
+
+UdpTransport::UdpTransport(const UdpOptions& options) : options_(options) {}
+
+uint16_t UdpTransport::topic_port(const std::string& topic_name) const {
+    const uint16_t range = std::max<uint16_t>(1, options_.port_range);
+    return static_cast<uint16_t>(options_.base_port + fnv1a(topic_name) % range);
+}
+
+core::Status UdpTransport::create_writer(const TopicOptions& options,
+                                         std::unique_ptr<TransportWriter>* writer) {
+    if (options_.max_datagram_size <= sizeof(WireHeader)) {
+        return core::Status(core::Status::Code::InvalidArgument, "max_datagram_size is too small for the header.");
+    }
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(topic_port(options.topic_name));
+    in_addr interface_addr{};
+    core::Status status = parse_address(options_.group, &destination.sin_addr);
+    if (status.ok()) {
+        status = parse_address(options_.interface_address, &interface_addr);
+    }
+    if (!status.ok()) {
+        return status;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return errno_status("socket");
+    }
+    const unsigned char ttl = static_cast<unsigned char>(options_.ttl);
+    const unsigned char loop = options_.loopback ? 1 : 0;
+    if (::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0 ||
+        ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0 ||
+        ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interface_addr, sizeof(interface_addr)) != 0) {
+        status = errno_status("setsockopt(IP_MULTICAST_*)");
+        ::close(fd);
+        return status;
+    }
+    // Best effort: the kernel caps this at net.core.wmem_max.
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &options_.socket_buffer_size, sizeof(options_.socket_buffer_size));
+
+    // Connecting fixes the destination, so sendmmsg needs no per-datagram address.
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&destination), sizeof(destination)) != 0) {
+        status = errno_status("connect");
+        ::close(fd);
+        return status;
+    }
+
+    *writer = std::make_unique<UdpWriter>(fd, options, options_);
+    return core::Status::OK();
+}
+
+core::Status UdpTransport::create_reader(const TopicOptions& options,
+                                         std::unique_ptr<TransportReader>* reader) {
+    ip_mreq membership{};
+    core::Status status = parse_address(options_.group, &membership.imr_multiaddr);
+    if (status.ok()) {
+        status = parse_address(options_.interface_address, &membership.imr_interface);
+    }
+    if (!status.ok()) {
+        return status;
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return errno_status("socket");
+    }
+    const int one = 1;
+    const int zero = 0;
+    // Several readers (in this or other processes) may listen on the same port;
+    // each gets its own copy of every multicast datagram.
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0) {
+        status = errno_status("setsockopt(SO_REUSEADDR)");
+        ::close(fd);
+        return status;
+    }
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &options_.socket_buffer_size, sizeof(options_.socket_buffer_size));
+    // Only deliver groups this socket joined, not every group on the port.
+    ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_ALL, &zero, sizeof(zero));
+
+    // Binding to the group address (rather than INADDR_ANY) keeps unicast
+    // traffic to the same port out of this socket.
+    sockaddr_in local{};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(topic_port(options.topic_name));
+    local.sin_addr = membership.imr_multiaddr;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+        status = errno_status("bind");
+        ::close(fd);
+        return status;
+    }
+    if (::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+        status = errno_status("setsockopt(IP_ADD_MEMBERSHIP)");
+        ::close(fd);
+        return status;
+    }
+
+    *reader = std::make_unique<UdpReader>(fd, options, options_);
+    return core::Status::OK();
+}
+
+} // namespace transport
+} // namespace msg
+} // namespace ignlink
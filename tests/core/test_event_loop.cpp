@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/event_loop.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool wait_until(const std::function<bool()>& done, std::chrono::milliseconds timeout = 2000ms) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+void signal(int fd) {
+    const uint64_t one = 1;
+    ASSERT_EQ(::write(fd, &one, sizeof(one)), static_cast<ssize_t>(sizeof(one)));
+}
+
+void drain(int fd) {
+    uint64_t count;
+    (void)!::read(fd, &count, sizeof(count));
+}
+
+} // namespace
+
+TEST(EventLoopTest, DispatchesEveryReadyDescriptorInOneWakeup) {
+    core::EventLoop loop("test");
+    constexpr int kFds = 16;
+    std::vector<int> fds;
+    std::atomic<int> handled{0};
+    for (int i = 0; i < kFds; ++i) {
+        const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        fds.push_back(fd);
+        ASSERT_TRUE(loop.add_fd(fd, core::EventLoop::kReadable, [fd, &handled](uint32_t events) {
+                            EXPECT_TRUE(events & core::EventLoop::kReadable);
+                            drain(fd);
+                            handled.fetch_add(1);
+                        })
+                        .ok());
+    }
+    EXPECT_EQ(loop.add_fd(fds[0], core::EventLoop::kReadable, [](uint32_t) {}).code(),
+              core::Status::Code::AlreadyExists);
+
+    // Everything is ready before the loop starts, so it all comes back from one epoll_wait().
+    for (int fd : fds) {
+        signal(fd);
+    }
+    ASSERT_TRUE(loop.start().ok());
+    ASSERT_TRUE(wait_until([&] { return handled.load() == kFds; }));
+    EXPECT_EQ(loop.stats().wakeups, 1u);
+    EXPECT_EQ(loop.stats().fd_events, uint64_t(kFds));
+
+    // Paused, then resumed.
+    ASSERT_TRUE(loop.modify_fd(fds[0], 0).ok());
+    signal(fds[0]);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(handled.load(), kFds);
+    ASSERT_TRUE(loop.modify_fd(fds[0], core::EventLoop::kReadable).ok());
+    ASSERT_TRUE(wait_until([&] { return handled.load() == kFds + 1; }));
+
+    loop.stop();
+    for (int fd : fds) {
+        loop.remove_fd(fd);
+        ::close(fd);
+    }
+}
+
+TEST(EventLoopTest, PeriodicTimersKeepAFixedRate) {
+    core::EventLoop loop("test");
+    ASSERT_TRUE(loop.start().ok());
+
+    std::mutex mutex;
+    std::vector<std::chrono::steady_clock::time_point> fired;
+    const auto start = std::chrono::steady_clock::now();
+    const auto id = loop.call_every(2ms, [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(std::chrono::steady_clock::now());
+        std::this_thread::sleep_for(500us); // Run time must not push later runs back
+    });
+    std::this_thread::sleep_for(205ms);
+    EXPECT_TRUE(loop.cancel_timer(id));
+    EXPECT_FALSE(loop.cancel_timer(id));
+    std::lock_guard<std::mutex> lock(mutex);
+    // 100 periods; the last run lands no later than its schedule plus scheduling slack.
+    EXPECT_GE(fired.size(), 95u);
+    EXPECT_LE(fired.size(), 102u);
+    ASSERT_FALSE(fired.empty());
+    EXPECT_GE(fired.front() - start, 2ms);
+    const auto expected_last = start + 2ms * static_cast<int>(fired.size() + loop.stats().timer_overruns);
+    EXPECT_LT(fired.back() - expected_last, 5ms);
+}
+
+TEST(EventLoopTest, OneShotTimersRunInDeadlineOrderAcrossTheWheel) {
+    core::EventLoop loop("test");
+    ASSERT_TRUE(loop.start().ok());
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&](int value) {
+        return [&, value] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+    };
+    // 1.1 s is beyond one turn of the wheel; 30 ms and 30.5 ms share a slot.
+    loop.call_after(1100ms, record(4));
+    loop.call_after(30500us, record(3));
+    loop.call_after(30ms, record(2));
+    loop.call_after(0ms, record(1));
+    const auto cancelled = loop.call_after(10ms, record(99));
+    EXPECT_TRUE(loop.cancel_timer(cancelled));
+
+    ASSERT_TRUE(wait_until([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order.size() == 3;
+    }));
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(wait_until([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return order.size() == 4;
+    }));
+    EXPECT_GT(std::chrono::steady_clock::now() - start, 900ms);
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(EventLoopTest, PostedTasksRunInOrderOnTheLoopThread) {
+    core::EventLoop loop("test");
+    ASSERT_TRUE(loop.start().ok());
+    std::promise<std::thread::id> loop_thread;
+    loop.post([&] { loop_thread.set_value(std::this_thread::get_id()); });
+    const auto id = loop_thread.get_future().get();
+    EXPECT_NE(id, std::this_thread::get_id());
+    EXPECT_FALSE(loop.in_loop_thread());
+
+    // Posted while the loop is busy, so they pile up.
+    std::promise<void> release;
+    auto released = release.get_future();
+    loop.post([&] { released.wait(); });
+    std::this_thread::sleep_for(10ms);
+    const uint64_t wakeups = loop.stats().wakeups;
+
+    std::vector<int> order;
+    std::promise<void> done;
+    for (int i = 0; i < 1000; ++i) {
+        loop.post([&, i] {
+            EXPECT_TRUE(loop.in_loop_thread());
+            order.push_back(i);
+            if (i == 999) {
+                done.set_value();
+            }
+        });
+    }
+    release.set_value();
+    done.get_future().get();
+    ASSERT_EQ(order.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(order[i], i);
+    }
+    // A thousand posts, one eventfd write and one more wakeup.
+    EXPECT_EQ(loop.stats().wakeups - wakeups, 1u);
+}
+
+TEST(EventLoopTest, RemovedHandlersAreNotRunningWhenRemoveReturns) {
+    core::EventLoop loop("test");
+    const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::atomic<bool> inside{false};
+    std::atomic<int> calls{0};
+    ASSERT_TRUE(loop.add_fd(fd, core::EventLoop::kReadable, [&](uint32_t) {
+                        inside = true;
+                        std::this_thread::sleep_for(50ms);
+                        drain(fd);
+                        calls.fetch_add(1);
+                        inside = false;
+                    })
+                    .ok());
+    ASSERT_TRUE(loop.start().ok());
+    signal(fd);
+    ASSERT_TRUE(wait_until([&] { return inside.load(); }));
+    loop.remove_fd(fd);
+    EXPECT_FALSE(inside.load());
+    signal(fd);
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(calls.load(), 1);
+    ::close(fd);
+}
+
+TEST(EventLoopTest, HandlersMayChangeTheLoopAndThrowWithoutStoppingIt) {
+    core::EventLoop loop("test");
+    const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::atomic<int> timer_runs{0};
+    core::EventLoop::TimerId timer = 0;
+    ASSERT_TRUE(loop.add_fd(fd, core::EventLoop::kReadable, [&](uint32_t) {
+                        drain(fd);
+                        loop.remove_fd(fd); // From inside its own handler
+                        timer = loop.call_every(1ms, [&] {
+                            if (timer_runs.fetch_add(1) == 4) {
+                                loop.cancel_timer(timer); // From inside its own callback
+                            }
+                        });
+                        throw std::runtime_error("handler failure");
+                    })
+                    .ok());
+    ASSERT_TRUE(loop.start().ok());
+    signal(fd);
+    ASSERT_TRUE(wait_until([&] { return timer_runs.load() == 5; }));
+    std::this_thread::sleep_for(20ms);
+    EXPECT_EQ(timer_runs.load(), 5);
+
+    // Stopping and running again, this time on the calling thread.
+    loop.stop();
+    std::thread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        loop.post([&] { loop.stop(); });
+    });
+    loop.run();
+    stopper.join();
+    ::close(fd);
+}
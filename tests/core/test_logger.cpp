@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/logger.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+// Points stdout, where the logger's console sink writes, at a temporary file.
+class StdoutCapture {
+public:
+    StdoutCapture() {
+        char pattern[] = "/tmp/ignlink_logger_XXXXXX";
+        fd_ = ::mkstemp(pattern);
+        path_ = pattern;
+        std::fflush(stdout);
+        saved_ = ::dup(STDOUT_FILENO);
+        ::dup2(fd_, STDOUT_FILENO);
+    }
+
+    ~StdoutCapture() {
+        std::fflush(stdout);
+        ::dup2(saved_, STDOUT_FILENO);
+        ::close(saved_);
+        ::close(fd_);
+        std::remove(path_.c_str());
+    }
+
+    // What has reached the file so far; does not flush anything itself.
+    std::string contents() const {
+        std::string text;
+        char buffer[4096];
+        ssize_t n;
+        for (off_t offset = 0; (n = ::pread(fd_, buffer, sizeof(buffer), offset)) > 0; offset += n) {
+            text.append(buffer, static_cast<size_t>(n));
+        }
+        return text;
+    }
+
+private:
+    int fd_ = -1;
+    int saved_ = -1;
+    std::string path_;
+};
+
+// Logs from its destructor, which runs after the main thread's thread_locals are gone.
+struct LogsOnDestruction {
+    ~LogsOnDestruction() {
+        core::Logger::flush(); // Lets the writer free the retired ring first
+        for (int i = 0; i < 3; ++i) {
+            core::Logger::info("logged from a static destructor {}", i);
+        }
+        core::Logger::error("and an error");
+        std::fflush(stdout);
+    }
+};
+
+class LoggerTest : public ::testing::Test {
+protected:
+    void SetUp() override { core::Logger::init("test", core::Logger::Level::Info, core::Logger::Mode::Async); }
+    void TearDown() override { core::Logger::flush(); }
+};
+
+} // namespace
+
+TEST_F(LoggerTest, FlushWritesQueuedRecords) {
+    StdoutCapture capture;
+    core::Logger::info("queued {} {} {} {} '{}'", 42, -7, 2.5, true, std::string("text"));
+    core::Logger::debug("below the level");
+    core::Logger::flush();
+    const std::string text = capture.contents();
+    EXPECT_NE(text.find("queued 42 -7 2.5 true 'text'"), std::string::npos) << text;
+    EXPECT_EQ(text.find("below the level"), std::string::npos);
+}
+
+TEST_F(LoggerTest, ErrorsAreWrittenBeforeTheCallReturns) {
+    StdoutCapture capture;
+    for (int i = 0; i < 100; ++i) {
+        core::Logger::info("step {}.", i);
+        core::Logger::error("failure {}.", i);
+        // No flush: the error, and the info record queued before it, must already be out.
+        const std::string text = capture.contents();
+        const size_t step = text.find("step " + std::to_string(i) + ".");
+        const size_t failure = text.find("failure " + std::to_string(i) + ".");
+        ASSERT_NE(failure, std::string::npos) << "error " << i << " was still queued";
+        ASSERT_NE(step, std::string::npos);
+        EXPECT_LT(step, failure);
+    }
+}
+
+TEST_F(LoggerTest, ErrorsAreNotDroppedWhenTheRingIsFull) {
+    StdoutCapture capture;
+    const std::string filler(4000, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        core::Logger::info("{}", filler); // Far more than one ring holds
+    }
+    core::Logger::error("still here");
+    EXPECT_NE(capture.contents().find("still here"), std::string::npos);
+}
+
+TEST_F(LoggerTest, SyncModeWritesOnTheCallingThread) {
+    core::Logger::init("test", core::Logger::Level::Info, core::Logger::Mode::Sync);
+    StdoutCapture capture;
+    core::Logger::info("immediately {}", 1);
+    EXPECT_NE(capture.contents().find("immediately 1"), std::string::npos);
+}
+
+TEST_F(LoggerTest, StaticDestructorsCanStillLog) {
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            ::dup2(STDERR_FILENO, STDOUT_FILENO); // The death test matches what reaches stderr
+            core::Logger::info("before exit");    // Gives this thread a ring
+            static LogsOnDestruction logs_on_destruction;
+            std::exit(0); // Destroys this thread's thread_locals, then the statics
+        },
+        ::testing::ExitedWithCode(0),
+        "before exit.*\n.*logged from a static destructor 0.*\n.*logged from a static destructor 1.*\n.*"
+        "logged from a static destructor 2.*\n.*and an error");
+}
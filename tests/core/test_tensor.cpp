@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/tensor.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <stdexcept>
+
+using namespace ignlink;
+using core::DType;
+using core::Tensor;
+
+namespace {
+
+// Counts every heap allocation in the process, to show where there are none.
+std::atomic<uint64_t> g_allocations{0};
+
+void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+}
+
+void* allocate_or_throw(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    if (void* p = allocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// Every form is replaced, so that each new pairs with a matching delete.
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+
+// A 4x6 int32 tensor holding 0..23 in row-major order.
+Tensor iota_4x6() {
+    Tensor tensor(DType::Int32, {4, 6});
+    for (int32_t i = 0; i < 24; ++i) {
+        tensor.data_as<int32_t>()[i] = i;
+    }
+    return tensor;
+}
+
+int32_t at(const Tensor& tensor, int64_t row, int64_t column) {
+    return tensor.data_as<int32_t>()[row * tensor.strides()[0] + column * tensor.strides()[1]];
+}
+
+} // namespace
+
+TEST(TensorTest, StorageIsContiguousAndAligned) {
+    for (DType dtype : {DType::UInt8, DType::Int16, DType::Float32, DType::Float64}) {
+        for (int64_t width : {1, 3, 17, 640}) {
+            Tensor tensor(dtype, {2, width, 3});
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(tensor.data()) % Tensor::kAlignment, 0u);
+            EXPECT_TRUE(tensor.is_contiguous());
+            EXPECT_EQ(tensor.numel(), size_t(2 * width * 3));
+            EXPECT_EQ(tensor.nbytes(), tensor.numel() * core::dtype_size(dtype));
+            EXPECT_EQ(tensor.strides()[0], width * 3);
+            EXPECT_EQ(tensor.strides()[1], 3);
+            EXPECT_EQ(tensor.strides()[2], 1);
+        }
+    }
+    EXPECT_EQ(Tensor().numel(), 0u);
+    EXPECT_EQ(Tensor(DType::Float32, {0, 5}).numel(), 0u);
+}
+
+TEST(TensorTest, ViewsShareStorageAndFollowStrides) {
+    const Tensor tensor = iota_4x6();
+
+    // Rows 1 and 3, columns 1, 3 and 5.
+    const Tensor view = tensor.slice(0, 1, 4, 2).slice(1, 1, 6, 2);
+    ASSERT_EQ(view.rank(), 2u);
+    EXPECT_EQ(view.dim(0), 2);
+    EXPECT_EQ(view.dim(1), 3);
+    EXPECT_EQ(view.strides()[0], 12);
+    EXPECT_EQ(view.strides()[1], 2);
+    EXPECT_FALSE(view.is_contiguous());
+    EXPECT_EQ(view.data_as<int32_t>(), tensor.data_as<int32_t>() + 7);
+    EXPECT_EQ(at(view, 0, 0), 7);
+    EXPECT_EQ(at(view, 1, 2), 23);
+
+    const Tensor column = view.select(1, 1);
+    ASSERT_EQ(column.rank(), 1u);
+    EXPECT_EQ(column.dim(0), 2);
+    EXPECT_EQ(column.strides()[0], 12);
+    EXPECT_EQ(column.data_as<int32_t>()[0], 9);
+    EXPECT_EQ(column.data_as<int32_t>()[12], 21);
+
+    const Tensor row = tensor.select(0, 2);
+    ASSERT_EQ(row.rank(), 1u);
+    EXPECT_TRUE(row.is_contiguous());
+    EXPECT_EQ(row.data_as<int32_t>()[5], 17);
+
+    // A slice of whole rows is a contiguous block, which reshape accepts.
+    const Tensor middle = tensor.slice(0, 1, 3).reshape({3, -1});
+    EXPECT_EQ(middle.dim(0), 3);
+    EXPECT_EQ(middle.dim(1), 4);
+    EXPECT_EQ(middle.data_as<int32_t>(), tensor.data_as<int32_t>() + 6);
+    EXPECT_EQ(middle.data_as<int32_t>()[11], 17);
+
+    const Tensor flat = tensor.reshape({-1});
+    ASSERT_EQ(flat.rank(), 1u);
+    EXPECT_EQ(flat.dim(0), 24);
+    EXPECT_EQ(flat.data(), tensor.data());
+}
+
+TEST(TensorTest, CloneCopiesStridedViewsIntoContiguousStorage) {
+    Tensor tensor = iota_4x6();
+    tensor.timestamp = 42;
+    const Tensor view = tensor.slice(0, 1, 4, 2).slice(1, 1, 6, 2);
+
+    const Tensor copy = view.clone();
+    EXPECT_TRUE(copy.is_contiguous());
+    EXPECT_NE(copy.data(), view.data());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(copy.data()) % Tensor::kAlignment, 0u);
+    EXPECT_EQ(copy.timestamp, 42);
+    ASSERT_EQ(copy.rank(), 2u);
+    EXPECT_EQ(copy.dim(0), 2);
+    EXPECT_EQ(copy.dim(1), 3);
+    const int32_t expected[] = {7, 9, 11, 19, 21, 23};
+    for (size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(copy.data_as<int32_t>()[i], expected[i]) << "at " << i;
+    }
+
+    // The copy does not follow later writes to the source.
+    tensor.data_as<int32_t>()[7] = -1;
+    EXPECT_EQ(copy.data_as<int32_t>()[0], 7);
+
+    const Tensor contiguous = view.contiguous();
+    EXPECT_TRUE(contiguous.is_contiguous());
+    EXPECT_EQ(tensor.contiguous().data(), tensor.data()); // Already contiguous: no copy
+
+    const Tensor column = view.select(1, 2).clone();
+    ASSERT_EQ(column.rank(), 1u);
+    EXPECT_EQ(column.data_as<int32_t>()[0], 11);
+    EXPECT_EQ(column.data_as<int32_t>()[1], 23);
+}
+
+TEST(TensorTest, RejectsInvalidViews) {
+    const Tensor tensor = iota_4x6();
+
+    EXPECT_THROW(tensor.slice(2, 0, 1), std::out_of_range);  // No such dimension
+    EXPECT_THROW(tensor.slice(0, 0, 4, 0), std::out_of_range); // Zero step
+    EXPECT_THROW(tensor.slice(0, -1, 2), std::out_of_range);
+    EXPECT_THROW(tensor.slice(0, 3, 2), std::out_of_range);
+    EXPECT_THROW(tensor.slice(1, 0, 7), std::out_of_range);
+    EXPECT_NO_THROW(tensor.slice(0, 4, 4)); // Empty, but valid
+
+    EXPECT_THROW(tensor.select(2, 0), std::out_of_range);
+    EXPECT_THROW(tensor.select(0, 4), std::out_of_range);
+    EXPECT_THROW(tensor.select(1, -1), std::out_of_range);
+
+    EXPECT_THROW(tensor.reshape({5, 5}), std::invalid_argument);
+    EXPECT_THROW(tensor.reshape({-1, -1}), std::invalid_argument);
+    EXPECT_THROW(tensor.reshape({5, -1}), std::invalid_argument);
+    EXPECT_THROW(tensor.reshape({0, -1}), std::invalid_argument);
+    EXPECT_THROW(tensor.reshape({1, 1, 1, 1, 1, 1, 1, 1, 24}), std::invalid_argument);
+    EXPECT_THROW(tensor.slice(1, 0, 6, 2).reshape({12}), std::invalid_argument); // Not contiguous
+}
+
+TEST(TensorTest, RejectsInvalidShapesWithoutChangingTheTensor) {
+    Tensor tensor(DType::Int16, {2, 3});
+    void* const data = tensor.data();
+
+    const int64_t too_many[Tensor::kMaxRank + 1] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+    EXPECT_THROW(tensor.resize(DType::Float64, too_many, Tensor::kMaxRank + 1), std::invalid_argument);
+    EXPECT_THROW(tensor.resize(DType::Float64, {4, -1}), std::invalid_argument);
+    // The element count overflows, and so does the byte count.
+    EXPECT_THROW(tensor.resize(DType::Float64, {int64_t(1) << 40, int64_t(1) << 40}), std::invalid_argument);
+    EXPECT_THROW(tensor.resize(DType::Float64, {int64_t(1) << 61}), std::invalid_argument);
+    // Empty, but the strides of the other dimensions would overflow.
+    EXPECT_THROW(tensor.resize(DType::UInt8, {0, int64_t(1) << 62, 4}), std::invalid_argument);
+
+    EXPECT_EQ(tensor.dtype(), DType::Int16);
+    ASSERT_EQ(tensor.rank(), 2u);
+    EXPECT_EQ(tensor.dim(0), 2);
+    EXPECT_EQ(tensor.dim(1), 3);
+    EXPECT_EQ(tensor.strides()[0], 3);
+    EXPECT_EQ(tensor.data(), data);
+
+    EXPECT_THROW(Tensor(DType::UInt8, {int64_t(1) << 32, int64_t(1) << 32}), std::invalid_argument);
+}
+
+TEST(TensorTest, ResizeReusesUnsharedStorage) {
+    Tensor tensor(DType::UInt8, {256});
+    void* const data = tensor.data();
+
+    tensor.resize(DType::Float32, {8, 8});
+    EXPECT_EQ(tensor.data(), data);
+    EXPECT_EQ(tensor.dtype(), DType::Float32);
+    EXPECT_TRUE(tensor.is_contiguous());
+
+    // A reader still holds the storage, so the producer must get new storage.
+    const Tensor published = tensor;
+    tensor.resize(DType::Float32, {8, 8});
+    EXPECT_NE(tensor.data(), data);
+    EXPECT_EQ(published.data(), data);
+}
+
+TEST(TensorTest, PoolReuseAllocatesNothingInSteadyState) {
+    core::BufferPool::trim();
+    std::set<const void*> buffers;
+    for (int warmup = 0; warmup < 8; ++warmup) {
+        Tensor frame(DType::UInt8, {480, 640, 3});
+        const Tensor copy = frame.slice(0, 0, 480, 2).clone();
+        buffers.insert(frame.data());
+        buffers.insert(copy.data());
+    }
+    EXPECT_GT(core::BufferPool::cached_bytes(), 0u);
+
+    const uint64_t before = g_allocations.load();
+    for (int i = 0; i < 1000; ++i) {
+        Tensor frame(DType::UInt8, {480, 640, 3});
+        frame.data_as<uint8_t>()[0] = static_cast<uint8_t>(i);
+        const Tensor view = frame.slice(0, 0, 480, 2).select(2, 0);
+        const Tensor copy = frame.slice(0, 0, 480, 2).clone();
+        ASSERT_EQ(copy.data_as<uint8_t>()[0], static_cast<uint8_t>(i));
+        ASSERT_TRUE(buffers.count(frame.data()));
+        ASSERT_TRUE(buffers.count(copy.data()));
+    }
+    EXPECT_EQ(g_allocations.load(), before);
+}
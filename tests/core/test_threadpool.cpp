@@ -0,0 +1,308 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/executor.h>
+#include <ignlink/core/threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Counts completed tasks and lets the test wait for a given total, with a
+// deadline so that a lost wakeup fails the test instead of hanging it.
+class Counter {
+public:
+    void add() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++count_;
+        cv_.notify_all();
+    }
+
+    bool wait_for(size_t target, std::chrono::milliseconds timeout = 5000ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [&] { return count_ >= target; });
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t count_ = 0;
+};
+
+// A gate tasks can block on until the test opens it.
+class Gate {
+public:
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+    bool wait(std::chrono::milliseconds timeout = 5000ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [&] { return open_; });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// Some arithmetic the optimizer cannot drop.
+uint64_t spin(uint64_t iterations) {
+    uint64_t x = 88172645463325252ull;
+    for (uint64_t i = 0; i < iterations; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+} // namespace
+
+TEST(ThreadPoolTest, RunsEveryTaskWhenSubmittedOneAtATimeToAnIdlePool) {
+    // Each round lets every worker fall asleep before the next submit, which is
+    // exactly the window a lost wakeup would hide in.
+    core::ThreadPool pool(4);
+    Counter done;
+    for (size_t round = 1; round <= 2000; ++round) {
+        pool.submit([&] { done.add(); });
+        ASSERT_TRUE(done.wait_for(round)) << "task " << round << " never ran";
+    }
+}
+
+TEST(ThreadPoolTest, RunsEveryTaskFromConcurrentProducers) {
+    constexpr size_t kProducers = 4;
+    constexpr size_t kTasksPerProducer = 20000;
+    Counter done;
+    {
+        core::ThreadPool pool(4);
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < kProducers; ++p) {
+            producers.emplace_back([&, p] {
+                for (size_t i = 0; i < kTasksPerProducer; ++i) {
+                    pool.submit([&] { done.add(); });
+                    if (i % 1000 == p) {
+                        std::this_thread::sleep_for(100us); // Let the workers drain and doze off
+                    }
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        EXPECT_TRUE(done.wait_for(kProducers * kTasksPerProducer));
+    }
+    EXPECT_EQ(done.count(), kProducers * kTasksPerProducer);
+}
+
+TEST(ThreadPoolTest, RunsQueuedTasksBeforeJoining) {
+    std::atomic<size_t> done{0};
+    {
+        core::ThreadPool pool(2);
+        for (int i = 0; i < 1000; ++i) {
+            pool.submit([&] { done.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(done.load(), 1000u);
+}
+
+TEST(ThreadPoolTest, IdleWorkersStealFromABlockedWorker) {
+    // A task fills its own worker's deque and then blocks until every child has
+    // run. Only stealing can get the children out from under it.
+    constexpr size_t kChildren = 1000;
+    core::ThreadPool pool(4);
+    Counter children;
+    Gate parent_done;
+    std::atomic<bool> all_ran{false};
+    std::vector<std::thread::id> ran_on(kChildren);
+    std::thread::id parent_thread;
+    pool.submit([&] {
+        parent_thread = std::this_thread::get_id();
+        for (size_t i = 0; i < kChildren; ++i) {
+            pool.submit([&, i] {
+                ran_on[i] = std::this_thread::get_id();
+                children.add();
+            });
+        }
+        all_ran = children.wait_for(kChildren);
+        parent_done.open();
+    });
+    ASSERT_TRUE(parent_done.wait());
+    ASSERT_TRUE(all_ran.load());
+    for (size_t i = 0; i < kChildren; ++i) {
+        EXPECT_NE(ran_on[i], parent_thread) << "child " << i;
+    }
+}
+
+TEST(ThreadPoolTest, ThrowingTasksDoNotTakeWorkersDown) {
+    core::ThreadPool pool(2);
+    Counter done;
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([] { throw std::runtime_error("task failed"); });
+        pool.submit([&] { done.add(); });
+    }
+    EXPECT_TRUE(done.wait_for(100));
+}
+
+TEST(ExecutorTest, MutuallyExclusiveGroupsNeverOverlap) {
+    constexpr size_t kGroups = 4;
+    constexpr size_t kPosters = 4;
+    constexpr size_t kPostsPerGroup = 5000;
+    core::Executor executor(4);
+
+    struct Tracked {
+        std::shared_ptr<core::CallbackGroup> group =
+            std::make_shared<core::CallbackGroup>(core::CallbackGroup::Type::MutuallyExclusive);
+        std::atomic<int> in_flight{0};
+        std::atomic<size_t> overlaps{0};
+        std::vector<size_t> last_seen = std::vector<size_t>(kPosters, 0); // Only touched while serialized
+        size_t reordered = 0;
+    };
+    std::vector<Tracked> groups(kGroups);
+    Counter done;
+
+    std::vector<std::thread> posters;
+    for (size_t p = 0; p < kPosters; ++p) {
+        posters.emplace_back([&, p] {
+            for (size_t i = 1; i <= kPostsPerGroup / kPosters; ++i) {
+                for (Tracked& tracked : groups) {
+                    executor.post(
+                        [&tracked, &done, p, i] {
+                            if (tracked.in_flight.fetch_add(1) != 0) {
+                                tracked.overlaps.fetch_add(1);
+                            }
+                            // Posts from one thread must run in the order they were made.
+                            tracked.reordered += tracked.last_seen[p] + 1 != i;
+                            tracked.last_seen[p] = i;
+                            if (i % 64 == 0) {
+                                std::this_thread::yield(); // Widen the window for a second drain
+                            }
+                            tracked.in_flight.fetch_sub(1);
+                            done.add();
+                        },
+                        tracked.group);
+                }
+            }
+        });
+    }
+    for (auto& poster : posters) {
+        poster.join();
+    }
+    ASSERT_TRUE(done.wait_for(kGroups * kPostsPerGroup, 20000ms));
+    for (size_t g = 0; g < kGroups; ++g) {
+        EXPECT_EQ(groups[g].overlaps.load(), 0u) << "group " << g;
+        EXPECT_EQ(groups[g].reordered, 0u) << "group " << g;
+    }
+}
+
+TEST(ExecutorTest, ReentrantCallbacksRunConcurrently) {
+    // Two callbacks that each wait for the other to start: they can only both
+    // finish if they run at the same time.
+    core::Executor executor(2);
+    auto group = std::make_shared<core::CallbackGroup>(core::CallbackGroup::Type::Reentrant);
+    std::atomic<int> started{0};
+    Counter met;
+    for (int i = 0; i < 2; ++i) {
+        executor.post(
+            [&] {
+                started.fetch_add(1);
+                const auto deadline = std::chrono::steady_clock::now() + 5s;
+                while (started.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::yield();
+                }
+                if (started.load() == 2) {
+                    met.add();
+                }
+            },
+            group);
+    }
+    EXPECT_TRUE(met.wait_for(2));
+}
+
+TEST(ExecutorTest, ABusyGroupDoesNotStarveOthers) {
+    // A group with a deep backlog yields its worker every batch, so a callback
+    // posted to another group afterwards runs within a batch or two, even with
+    // no other worker around to steal it.
+    core::Executor executor(1);
+    auto busy = std::make_shared<core::CallbackGroup>(core::CallbackGroup::Type::MutuallyExclusive);
+    auto other = std::make_shared<core::CallbackGroup>(core::CallbackGroup::Type::MutuallyExclusive);
+    Gate holding, hold;
+    std::atomic<size_t> busy_done{0};
+    std::atomic<size_t> busy_done_when_other_ran{0};
+    Counter other_done;
+
+    executor.post(
+        [&] {
+            holding.open();
+            hold.wait(); // Keep the only worker busy while we queue up
+        },
+        busy);
+    ASSERT_TRUE(holding.wait());
+    for (int i = 0; i < 10000; ++i) {
+        executor.post([&] { busy_done.fetch_add(1); }, busy);
+    }
+    executor.post(
+        [&] {
+            busy_done_when_other_ran = busy_done.load();
+            other_done.add();
+        },
+        other);
+    hold.open();
+    ASSERT_TRUE(other_done.wait_for(1));
+    EXPECT_LE(busy_done_when_other_ran.load(), 64u);
+}
+
+TEST(ThreadPoolTest, ScalingBenchmark) {
+    // Throughput over worker counts, for tasks heavy enough to be worth a
+    // thread (~10 us) and for tasks that are nearly pure scheduling overhead.
+    const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts{1, 2, 4};
+    if (hardware > 4) {
+        thread_counts.push_back(hardware);
+    }
+
+    struct Load {
+        const char* name;
+        uint64_t iterations;
+        size_t tasks;
+    };
+    const Load loads[] = {{"10us", 10000, 4000}, {"empty", 0, 200000}};
+    std::printf("thread pool scaling on %zu hardware threads\n", hardware);
+    for (const Load& load : loads) {
+        for (size_t threads : thread_counts) {
+            std::atomic<uint64_t> sink{0};
+            const auto start = std::chrono::steady_clock::now();
+            {
+                core::ThreadPool pool(threads);
+                for (size_t i = 0; i < load.tasks; ++i) {
+                    pool.submit([&] { sink.fetch_add(spin(load.iterations), std::memory_order_relaxed); });
+                }
+            } // Joining runs everything still queued
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            const double tasks_per_second = static_cast<double>(load.tasks) / seconds;
+            std::printf("  %-5s tasks, %2zu threads: %10.0f tasks/s\n", load.name, threads, tasks_per_second);
+            RecordProperty(std::string("tasks_per_second_") + load.name + "_" + std::to_string(threads),
+                           std::to_string(tasks_per_second));
+        }
+    }
+}
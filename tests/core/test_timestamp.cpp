@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/timestamp.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+using core::MonotonicClock;
+
+namespace {
+
+// Timing bounds are meaningless under sanitizers and on shared CI runners.
+bool timing_is_meaningful() {
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    return false;
+#else
+    return std::getenv("CI") == nullptr;
+#endif
+}
+
+} // namespace
+
+TEST(MonotonicClockTest, ReadingsNeverGoBackwards) {
+    MonotonicClock::calibrate();
+    std::printf("time source: %s\n", MonotonicClock::source_name());
+    RecordProperty("source", MonotonicClock::source_name());
+
+    constexpr int kThreads = 4;
+    constexpr int kReads = 1000000;
+    std::atomic<int> backwards{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            int64_t previous = MonotonicClock::now_ns();
+            for (int i = 0; i < kReads; ++i) {
+                const int64_t now = MonotonicClock::now_ns();
+                backwards.fetch_add(now < previous, std::memory_order_relaxed);
+                previous = now;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(backwards.load(), 0);
+}
+
+TEST(MonotonicClockTest, ReadingsAreOnTheClockMonotonicTimeLine) {
+    MonotonicClock::calibrate();
+    // The calibration error is a few microseconds; allow far more.
+    constexpr int64_t kToleranceNs = 200 * 1000;
+    for (int i = 0; i < 100; ++i) {
+        const int64_t before = core::detail::clock_monotonic_ns();
+        const int64_t now = MonotonicClock::now_ns();
+        const int64_t after = core::detail::clock_monotonic_ns();
+        ASSERT_GE(now, before - kToleranceNs);
+        ASSERT_LE(now, after + kToleranceNs);
+    }
+}
+
+TEST(MonotonicClockTest, MeasuresIntervalsInNanoseconds) {
+    MonotonicClock::calibrate();
+    const int64_t clock_start = MonotonicClock::now_ns();
+    const int64_t reference_start = core::detail::clock_monotonic_ns();
+    std::this_thread::sleep_for(50ms);
+    const int64_t clock_elapsed = MonotonicClock::now_ns() - clock_start;
+    const int64_t reference_elapsed = core::detail::clock_monotonic_ns() - reference_start;
+
+    EXPECT_GE(clock_elapsed, 50 * 1000 * 1000);
+    if (timing_is_meaningful()) {
+        // A wrong tick rate shows up in proportion to the interval.
+        const int64_t error = std::abs(clock_elapsed - reference_elapsed);
+        EXPECT_LT(error, reference_elapsed / 1000 + 20 * 1000) << "clock " << clock_elapsed << " ns, reference "
+                                                                << reference_elapsed << " ns";
+    }
+}
+
+TEST(MonotonicClockTest, FallbackCanBeForced) {
+    // In a fresh process: this one is already calibrated.
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            ::setenv("IGNLINK_CLOCK", "monotonic", 1);
+            const int64_t before = core::detail::clock_monotonic_ns();
+            const int64_t now = MonotonicClock::now_ns();
+            const bool fallback = !MonotonicClock::uses_tsc() &&
+                                  std::strcmp(MonotonicClock::source_name(), "clock_monotonic") == 0;
+            std::exit(fallback && now >= before ? 0 : 1);
+        },
+        ::testing::ExitedWithCode(0), "");
+}
@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/timestamp.h>
+#include <ignlink/data/log_player.h>
+#include <ignlink/data/log_recorder.h>
+#include <ignlink/msg/node.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Payload = std::vector<uint8_t>;
+
+constexpr uint64_t kMessages = 31;
+constexpr int64_t kPeriodNs = 10000000; // Message i is logged at start + 10 i ms: 300 ms in all
+
+// Timing bounds are meaningless under sanitizers and on shared CI runners.
+bool timing_is_meaningful() {
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    return false;
+#else
+    return std::getenv("CI") == nullptr;
+#endif
+}
+
+// What a subscriber saw of a replay: the values in order, and when each arrived.
+class Received {
+public:
+    void add(const Payload& payload) {
+        uint64_t i = 0;
+        std::memcpy(&i, payload.data(), std::min(sizeof(i), payload.size()));
+        std::lock_guard<std::mutex> lock(mutex_);
+        values_.push_back(i);
+        times_ns_.push_back(core::MonotonicClock::now_ns());
+    }
+
+    std::vector<uint64_t> values() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return values_;
+    }
+
+    std::vector<int64_t> times_ns() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return times_ns_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<uint64_t> values_;
+    std::vector<int64_t> times_ns_;
+};
+
+class LogPlayerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_log_player_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+        // Topics of our own, so that one test's replay never reaches another's subscribers.
+        prefix_ = "/test_player_" + std::to_string(++counter_);
+
+        data::LogRecorderOptions options;
+        options.directory = dir_;
+        options.sync_on_rotate = false;
+        data::LogRecorder recorder(options);
+        ASSERT_TRUE(recorder.start().ok());
+        const uint16_t a = recorder.add_channel<Payload>(topic("a"));
+        const uint16_t b = recorder.add_channel<Payload>(topic("b"));
+        start_ns_ = core::MonotonicClock::now_ns();
+        for (uint64_t i = 0; i < kMessages; ++i) {
+            auto payload = std::make_shared<Payload>(64, 0);
+            std::memcpy(payload->data(), &i, sizeof(i));
+            msg::MessageInfo info;
+            info.sequence = i;
+            const int64_t time_ns = start_ns_ + static_cast<int64_t>(i) * kPeriodNs;
+            ASSERT_TRUE(recorder.write(a, payload, info, time_ns));
+            ASSERT_TRUE(recorder.write(b, payload, info, time_ns));
+        }
+        recorder.stop();
+    }
+
+    void TearDown() override {
+        if (DIR* d = opendir(dir_.c_str())) {
+            while (dirent* e = readdir(d)) {
+                const std::string name = e->d_name;
+                if (name != "." && name != "..") {
+                    std::remove((dir_ + "/" + name).c_str());
+                }
+            }
+            closedir(d);
+        }
+        rmdir(dir_.c_str());
+    }
+
+    std::string topic(const std::string& name) const { return prefix_ + "/" + name; }
+
+    std::shared_ptr<msg::Subscriber<Payload>> subscribe(const std::string& name, Received& received) {
+        return node_.create_subscriber<Payload>(
+            topic(name), [&received](const Payload& payload) { received.add(payload); }, nullptr,
+            msg::QoS::keep_all(1024));
+    }
+
+    // Replays /a at `rate` and returns what its subscriber received.
+    std::vector<int64_t> replay_times(double rate, Received& received) {
+        auto sub = subscribe("a", received);
+        data::LogPlayerOptions options;
+        options.rate = rate;
+        data::LogPlayer player(node_, options);
+        EXPECT_TRUE(player.open(dir_).ok());
+        EXPECT_TRUE(player.add_topic<Payload>(topic("a"), msg::QoS::keep_all(1024)).ok());
+        EXPECT_TRUE(player.start().ok());
+        player.wait();
+        std::this_thread::sleep_for(50ms); // Let the last deliveries land
+        return received.times_ns();
+    }
+
+    static int counter_;
+
+    std::string dir_;
+    std::string prefix_;
+    int64_t start_ns_ = 0;
+    msg::Node node_{"test_log_player"};
+};
+
+int LogPlayerTest::counter_ = 0;
+
+std::vector<uint64_t> range(uint64_t from, uint64_t to) {
+    std::vector<uint64_t> values;
+    for (uint64_t i = from; i < to; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+} // namespace
+
+TEST_F(LogPlayerTest, ReplaysOnlyTheAddedTopicsInOrder) {
+    Received a, b;
+    auto sub_a = subscribe("a", a);
+    auto sub_b = subscribe("b", b);
+
+    data::LogPlayerOptions options;
+    options.rate = 0; // As fast as possible
+    data::LogPlayer player(node_, options);
+    ASSERT_TRUE(player.open(dir_).ok());
+    ASSERT_TRUE(player.add_topic<Payload>(topic("a"), msg::QoS::keep_all(1024)).ok());
+    ASSERT_TRUE(player.start().ok());
+    player.wait();
+    EXPECT_FALSE(player.playing());
+    std::this_thread::sleep_for(50ms);
+
+    EXPECT_EQ(a.values(), range(0, kMessages));
+    EXPECT_TRUE(b.values().empty());
+    const auto stats = player.stats();
+    EXPECT_EQ(stats.messages_published, kMessages);
+    EXPECT_EQ(stats.decode_errors, 0u);
+    EXPECT_GT(stats.bytes_published, kMessages * 64);
+}
+
+TEST_F(LogPlayerTest, ReplaysBetweenStartAndEndTimes) {
+    Received a;
+    auto sub = subscribe("a", a);
+    data::LogPlayerOptions options;
+    options.rate = 0;
+    options.start_time_ns = start_ns_ + 10 * kPeriodNs;
+    options.end_time_ns = start_ns_ + 20 * kPeriodNs;
+    data::LogPlayer player(node_, options);
+    ASSERT_TRUE(player.open(dir_).ok());
+    ASSERT_TRUE(player.add_topic<Payload>(topic("a"), msg::QoS::keep_all(1024)).ok());
+    ASSERT_TRUE(player.start().ok());
+    player.wait();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(a.values(), range(10, 21));
+}
+
+TEST_F(LogPlayerTest, KeepsTheRecordedTiming) {
+    for (double rate : {1.0, 2.0}) {
+        Received received;
+        const auto times = replay_times(rate, received);
+        ASSERT_EQ(times.size(), kMessages) << rate;
+        double worst_ms = 0;
+        for (size_t i = 0; i < times.size(); ++i) {
+            const double expected_ms = static_cast<double>(i) * kPeriodNs / rate / 1e6;
+            const double actual_ms = static_cast<double>(times[i] - times[0]) / 1e6;
+            worst_ms = std::max(worst_ms, std::abs(actual_ms - expected_ms));
+        }
+        std::printf("replay at %.0fx: %.1f ms for %.0f ms of log, worst deviation %.2f ms\n", rate,
+                    static_cast<double>(times.back() - times.front()) / 1e6,
+                    static_cast<double>((kMessages - 1) * kPeriodNs) / 1e6, worst_ms);
+        if (timing_is_meaningful()) {
+            EXPECT_LT(worst_ms, 5.0) << rate;
+        }
+    }
+}
+
+TEST_F(LogPlayerTest, StopsEarly) {
+    Received a;
+    auto sub = subscribe("a", a);
+    data::LogPlayer player(node_); // Original timing: 300 ms
+    ASSERT_TRUE(player.open(dir_).ok());
+    ASSERT_TRUE(player.add_topic<Payload>(topic("a")).ok());
+    ASSERT_TRUE(player.start().ok());
+    std::this_thread::sleep_for(100ms);
+    const auto start = std::chrono::steady_clock::now();
+    player.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 50ms);
+    EXPECT_FALSE(player.playing());
+    EXPECT_LT(player.stats().messages_published, kMessages);
+}
+
+TEST_F(LogPlayerTest, RejectsTopicsItCannotReplay) {
+    data::LogPlayer player(node_);
+    EXPECT_FALSE(player.add_topic<Payload>(topic("a")).ok()) << "No log open yet";
+    ASSERT_TRUE(player.open(dir_).ok());
+    EXPECT_FALSE(player.start().ok()) << "No topics added";
+    EXPECT_FALSE(player.add_topic<Payload>(topic("missing")).ok());
+    EXPECT_FALSE(player.add_topic<uint64_t>(topic("b")).ok()) << "Recorded as a different type";
+}
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/timestamp.h>
+#include <ignlink/data/log_format.h>
+#include <ignlink/data/log_reader.h>
+#include <ignlink/data/log_recorder.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace ignlink::data::log_format;
+
+namespace {
+
+using Payload = std::vector<uint8_t>;
+
+constexpr uint64_t kMessages = 3000;
+constexpr int64_t kPeriodNs = 1000000; // Message i is logged at start + i ms
+
+// Every third message goes to /b, the rest to /a.
+const char* topic_of(uint64_t i) {
+    return i % 3 == 0 ? "/b" : "/a";
+}
+
+class LogReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_log_reader_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+        record();
+    }
+
+    void TearDown() override {
+        for (const auto& file : segment_files()) {
+            std::remove(file.c_str());
+        }
+        rmdir(dir_.c_str());
+    }
+
+    std::vector<std::string> segment_files() const {
+        std::vector<std::string> files;
+        if (DIR* d = opendir(dir_.c_str())) {
+            while (dirent* e = readdir(d)) {
+                std::string name = e->d_name;
+                if (name.size() > 6 && name.compare(name.size() - 6, 6, ".iglog") == 0) {
+                    files.push_back(dir_ + "/" + name);
+                }
+            }
+            closedir(d);
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    // Small blocks and segments, so that seeking and filtering have several
+    // of each to choose from.
+    void record() {
+        data::LogRecorderOptions options;
+        options.directory = dir_;
+        options.sync_on_rotate = false;
+        options.block_size = 4096;
+        options.max_segment_bytes = 256 * 1024;
+        data::LogRecorder recorder(options);
+        ASSERT_TRUE(recorder.start().ok());
+        const uint16_t a = recorder.add_channel<Payload>("/a");
+        const uint16_t b = recorder.add_channel<Payload>("/b");
+
+        start_ns_ = core::MonotonicClock::now_ns();
+        for (uint64_t i = 0; i < kMessages; ++i) {
+            auto payload = std::make_shared<Payload>(500, static_cast<uint8_t>(i));
+            std::memcpy(payload->data(), &i, sizeof(i));
+            msg::MessageInfo info;
+            info.sequence = i;
+            ASSERT_TRUE(recorder.write(i % 3 == 0 ? b : a, payload, info, time_of(i)));
+        }
+        recorder.stop();
+        ASSERT_GE(segment_files().size(), 4u);
+    }
+
+    int64_t time_of(uint64_t i) const { return start_ns_ + static_cast<int64_t>(i) * kPeriodNs; }
+
+    // Reads every remaining message, checking that each one decodes to what was written.
+    static std::vector<uint64_t> read_all(data::LogReader& reader) {
+        std::vector<uint64_t> values;
+        data::LogMessage message;
+        while (reader.next(&message)) {
+            Payload payload;
+            EXPECT_TRUE(message.decode(&payload));
+            uint64_t i = 0;
+            if (payload.size() == 500) {
+                std::memcpy(&i, payload.data(), sizeof(i));
+            }
+            EXPECT_EQ(message.channel->topic, topic_of(i));
+            EXPECT_EQ(message.sequence, i);
+            values.push_back(i);
+        }
+        return values;
+    }
+
+    // Rewrites every segment as if recording had stopped without closing it:
+    // no index, no end time, and the last one cut off in the middle of a block.
+    void make_unclean() {
+        const auto files = segment_files();
+        for (size_t f = 0; f < files.size(); ++f) {
+            const int fd = ::open(files[f].c_str(), O_RDWR);
+            ASSERT_GE(fd, 0);
+            SegmentHeader header;
+            ASSERT_EQ(::pread(fd, &header, sizeof(header), 0), static_cast<ssize_t>(sizeof(header)));
+            const off_t data_end = static_cast<off_t>(header.data_bytes);
+            header.end_time_ns = 0;
+            header.message_count = 0;
+            header.data_bytes = 0;
+            header.index_offset = 0;
+            header.index_size = 0;
+            ASSERT_EQ(::pwrite(fd, &header, sizeof(header), 0), static_cast<ssize_t>(sizeof(header)));
+            ASSERT_EQ(::ftruncate(fd, data_end), 0);
+            if (f + 1 == files.size()) {
+                // A block whose header made it to disk but whose records did not.
+                BlockHeader torn{};
+                torn.magic = kBlockMagic;
+                torn.payload_bytes = 3000;
+                torn.record_count = 5;
+                ASSERT_EQ(::pwrite(fd, &torn, sizeof(torn), data_end), static_cast<ssize_t>(sizeof(torn)));
+            }
+            ::close(fd);
+        }
+    }
+
+    std::string dir_;
+    int64_t start_ns_ = 0;
+};
+
+std::vector<uint64_t> range(uint64_t from, uint64_t to) {
+    std::vector<uint64_t> values;
+    for (uint64_t i = from; i < to; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+std::vector<uint64_t> only_b(uint64_t from, uint64_t to) {
+    std::vector<uint64_t> values;
+    for (uint64_t i = from; i < to; ++i) {
+        if (i % 3 == 0) {
+            values.push_back(i);
+        }
+    }
+    return values;
+}
+
+} // namespace
+
+TEST_F(LogReaderTest, ReadsAnIndexedRecordingInOrder) {
+    data::LogReader reader;
+    ASSERT_TRUE(reader.open(dir_).ok());
+    ASSERT_EQ(reader.channels().size(), 2u);
+    ASSERT_NE(reader.find_channel("/a"), nullptr);
+    ASSERT_NE(reader.find_channel("/b"), nullptr);
+    EXPECT_EQ(reader.find_channel("/c"), nullptr);
+    EXPECT_EQ(reader.message_count(), kMessages);
+    EXPECT_EQ(reader.start_time_ns(), time_of(0));
+    EXPECT_EQ(reader.end_time_ns(), time_of(kMessages - 1));
+    EXPECT_EQ(read_all(reader), range(0, kMessages));
+}
+
+TEST_F(LogReaderTest, ReadsASingleSegment) {
+    const auto files = segment_files();
+    data::LogReader reader;
+    ASSERT_TRUE(reader.open(files[1]).ok());
+    const auto values = read_all(reader);
+    ASSERT_FALSE(values.empty());
+    EXPECT_EQ(values, range(values.front(), values.front() + values.size()));
+    EXPECT_EQ(reader.message_count(), values.size());
+    EXPECT_EQ(reader.channels().size(), 2u) << "Every segment declares every channel";
+}
+
+TEST_F(LogReaderTest, SeeksToTheFirstMessageAtOrAfterATime) {
+    data::LogReader reader;
+    ASSERT_TRUE(reader.open(dir_).ok());
+    for (uint64_t target : {uint64_t{0}, uint64_t{1}, uint64_t{777}, uint64_t{1500}, kMessages - 1}) {
+        reader.seek(time_of(target));
+        EXPECT_EQ(read_all(reader), range(target, kMessages)) << target;
+    }
+    // Between two messages, and backwards after reading to the end.
+    reader.seek(time_of(2000) - kPeriodNs / 2);
+    EXPECT_EQ(read_all(reader), range(2000, kMessages));
+    reader.seek(time_of(0) - 1000);
+    EXPECT_EQ(read_all(reader).size(), kMessages);
+    reader.seek(time_of(kMessages));
+    EXPECT_TRUE(read_all(reader).empty());
+}
+
+TEST_F(LogReaderTest, FiltersTopics) {
+    data::LogReader reader;
+    ASSERT_TRUE(reader.open(dir_).ok());
+    reader.set_topics({"/b"});
+    reader.seek(time_of(0));
+    EXPECT_EQ(read_all(reader), only_b(0, kMessages));
+
+    reader.seek(time_of(1001));
+    EXPECT_EQ(read_all(reader), only_b(1001, kMessages));
+
+    reader.set_topics({});
+    reader.seek(time_of(2990));
+    EXPECT_EQ(read_all(reader), range(2990, kMessages));
+}
+
+TEST_F(LogReaderTest, RebuildsTheIndexOfSegmentsThatWereNotClosedCleanly) {
+    make_unclean();
+    data::LogReader reader;
+    ASSERT_TRUE(reader.open(dir_).ok());
+    EXPECT_EQ(reader.channels().size(), 2u);
+    EXPECT_EQ(reader.message_count(), kMessages);
+    EXPECT_EQ(reader.start_time_ns(), time_of(0));
+    EXPECT_EQ(reader.end_time_ns(), time_of(kMessages - 1));
+    EXPECT_EQ(read_all(reader), range(0, kMessages));
+
+    reader.seek(time_of(1234));
+    EXPECT_EQ(read_all(reader), range(1234, kMessages));
+    reader.set_topics({"/b"});
+    reader.seek(time_of(10));
+    EXPECT_EQ(read_all(reader), only_b(10, kMessages));
+}
+
+TEST_F(LogReaderTest, RejectsFilesThatAreNotSegments) {
+    const std::string path = dir_ + "/bogus.iglog";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const std::vector<char> junk(kLogAlignment, 'x');
+    std::fwrite(junk.data(), 1, junk.size(), file);
+    std::fclose(file);
+
+    data::LogReader reader;
+    EXPECT_FALSE(reader.open(path).ok());
+    EXPECT_FALSE(reader.open(dir_ + "/missing.iglog").ok());
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/data/log_reader.h>
+#include <ignlink/data/log_recorder.h>
+#include <ignlink/data/trigger.h>
+#include <ignlink/msg/node.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Windows are wide compared to delivery on the bus, which takes microseconds;
+// the steps below keep well clear of every window edge.
+constexpr auto kPreTrigger = 300ms;
+constexpr auto kPostTrigger = 300ms;
+constexpr auto kDelivery = 30ms;
+
+class TriggerCaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_trigger_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+
+        data::LogRecorderOptions options;
+        options.directory = dir_;
+        options.sync_on_rotate = false;
+        recorder_ = std::make_unique<data::LogRecorder>(options);
+        ASSERT_TRUE(recorder_->start().ok());
+        topic_ = "/test_trigger/" + std::to_string(++topic_counter_);
+    }
+
+    void TearDown() override {
+        capture_.reset();
+        recorder_.reset();
+        if (DIR* d = opendir(dir_.c_str())) {
+            while (dirent* e = readdir(d)) {
+                const std::string name = e->d_name;
+                if (name != "." && name != "..") {
+                    std::remove((dir_ + "/" + name).c_str());
+                }
+            }
+            closedir(d);
+        }
+        rmdir(dir_.c_str());
+    }
+
+    // Starts buffering the test topic.
+    void capture(const data::TriggerCaptureOptions& options) {
+        capture_ = std::make_unique<data::TriggerCapture>(*recorder_, options);
+        ASSERT_TRUE(capture_->buffer<uint64_t>(node_, topic_).ok());
+        publisher_ = node_.create_publisher<uint64_t>(topic_);
+        ASSERT_NE(publisher_, nullptr);
+    }
+
+    void publish(uint64_t value) {
+        ASSERT_TRUE(publisher_->publish(value).ok());
+        std::this_thread::sleep_for(kDelivery);
+    }
+
+    // Stops the recorder and reads back the values it captured, in log order.
+    std::vector<uint64_t> recorded() {
+        recorder_->stop();
+        data::LogReader reader;
+        EXPECT_TRUE(reader.open(dir_).ok());
+        std::vector<uint64_t> values;
+        data::LogMessage message;
+        while (reader.next(&message)) {
+            uint64_t value = 0;
+            EXPECT_TRUE(message.decode(&value));
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    static data::TriggerCaptureOptions window() {
+        data::TriggerCaptureOptions options;
+        options.pre_trigger = kPreTrigger;
+        options.post_trigger = kPostTrigger;
+        return options;
+    }
+
+    static int topic_counter_;
+
+    std::string dir_;
+    msg::Node node_{"test_trigger"};
+    std::unique_ptr<data::LogRecorder> recorder_;
+    std::unique_ptr<data::TriggerCapture> capture_;
+    std::shared_ptr<msg::Publisher<uint64_t>> publisher_;
+    std::string topic_;
+};
+
+int TriggerCaptureTest::topic_counter_ = 0;
+
+} // namespace
+
+TEST_F(TriggerCaptureTest, RecordsNothingUntilATriggerFires) {
+    capture(window());
+    publish(1);
+    publish(2);
+    EXPECT_FALSE(capture_->capturing());
+    EXPECT_EQ(capture_->stats().messages_buffered, 2u);
+    EXPECT_TRUE(recorded().empty());
+}
+
+TEST_F(TriggerCaptureTest, RecordsOnlyThePreTriggerWindow) {
+    capture(window());
+    publish(1);
+    publish(2);
+    std::this_thread::sleep_for(kPreTrigger + 200ms); // 1 and 2 age out of the window
+    publish(3);
+    publish(4);
+    capture_->fire("test");
+
+    const auto stats = capture_->stats();
+    EXPECT_EQ(stats.triggers_fired, 1u);
+    EXPECT_EQ(stats.captures, 1u);
+    EXPECT_EQ(stats.messages_captured, 2u);
+    EXPECT_EQ(recorded(), (std::vector<uint64_t>{3, 4}));
+}
+
+TEST_F(TriggerCaptureTest, RingEvictsTheOldestMessagesFirst) {
+    auto options = window();
+    options.max_messages_per_topic = 3;
+    capture(options);
+    for (uint64_t i = 1; i <= 6; ++i) {
+        publish(i);
+    }
+    EXPECT_EQ(capture_->stats().messages_buffered, 3u);
+    capture_->fire("test");
+    EXPECT_EQ(recorded(), (std::vector<uint64_t>{4, 5, 6}));
+}
+
+TEST_F(TriggerCaptureTest, RecordsArrivalsUntilThePostTriggerWindowCloses) {
+    capture(window());
+    capture_->fire("test");
+    EXPECT_TRUE(capture_->capturing());
+    publish(1);
+    publish(2);
+    std::this_thread::sleep_for(kPostTrigger);
+    EXPECT_FALSE(capture_->capturing());
+    publish(3);
+    EXPECT_EQ(recorded(), (std::vector<uint64_t>{1, 2}));
+}
+
+TEST_F(TriggerCaptureTest, OverlappingTriggersExtendOneWindowWithoutDuplicates) {
+    capture(window());
+    publish(1);
+    capture_->fire("first"); // Window: [t0 - 300 ms, t0 + 300 ms]
+    std::this_thread::sleep_for(250ms);
+    publish(2);
+    capture_->fire("second"); // Extends it to about t0 + 580 ms; 1 and 2 are already recorded
+    std::this_thread::sleep_for(150ms);
+    publish(3);               // About t0 + 430 ms: past the first window, inside the second
+    std::this_thread::sleep_for(kPostTrigger);
+    publish(4);
+
+    const auto stats = capture_->stats();
+    EXPECT_EQ(stats.triggers_fired, 2u);
+    EXPECT_EQ(stats.captures, 1u);
+    EXPECT_EQ(stats.messages_captured, 3u);
+    EXPECT_EQ(recorded(), (std::vector<uint64_t>{1, 2, 3}));
+}
+
+TEST_F(TriggerCaptureTest, PredicateFiresACapture) {
+    capture(window());
+    const std::string trigger_topic = topic_ + "/trigger";
+    ASSERT_TRUE(capture_
+                    ->add_trigger<uint64_t>(node_, trigger_topic, "value_42",
+                                            [](const uint64_t& value, const msg::MessageInfo&) { return value == 42; })
+                    .ok());
+    auto trigger = node_.create_publisher<uint64_t>(trigger_topic);
+    ASSERT_NE(trigger, nullptr);
+
+    publish(1);
+    ASSERT_TRUE(trigger->publish(uint64_t{7}).ok());
+    std::this_thread::sleep_for(kDelivery);
+    EXPECT_EQ(capture_->stats().triggers_fired, 0u);
+
+    ASSERT_TRUE(trigger->publish(uint64_t{42}).ok());
+    std::this_thread::sleep_for(kDelivery);
+    EXPECT_EQ(capture_->stats().triggers_fired, 1u);
+    publish(2);
+    EXPECT_EQ(recorded(), (std::vector<uint64_t>{1, 2}));
+}
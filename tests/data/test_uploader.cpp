@@ -0,0 +1,432 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/data/uploader.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t kChunk = 4096; // The smallest chunk size the uploader accepts
+
+// Timing bounds are meaningless under sanitizers and on shared CI runners.
+bool timing_is_meaningful() {
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    return false;
+#else
+    return std::getenv("CI") == nullptr;
+#endif
+}
+
+std::vector<uint8_t> read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool exists(const std::string& path) {
+    return ::access(path.c_str(), F_OK) == 0;
+}
+
+// Chunks of zeros, which compress, alternating with chunks of noise, which do not.
+std::vector<uint8_t> make_source(size_t size) {
+    std::vector<uint8_t> bytes(size, 0);
+    std::mt19937 rng(7);
+    for (size_t i = 0; i < size; ++i) {
+        if ((i / kChunk) % 2 == 1) {
+            bytes[i] = static_cast<uint8_t>(rng());
+        }
+    }
+    return bytes;
+}
+
+/**
+ * @brief A FileSink that records what reaches it and fails on request.
+ */
+class RecordingSink : public data::UploadSink {
+public:
+    explicit RecordingSink(const std::string& directory) : sink_(directory) {}
+
+    core::Status begin(const std::string& object, uint64_t size, uint64_t chunk_count) override {
+        std::function<void()> hook;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            hook = on_begin_;
+        }
+        if (hook) {
+            hook();
+        }
+        return sink_.begin(object, size, chunk_count);
+    }
+
+    core::Status put(const data::UploadChunk& chunk) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            put_times_.push_back(std::chrono::steady_clock::now());
+            if (failures_left_ > 0 || chunk.index >= fail_from_) {
+                failures_left_ -= failures_left_ > 0;
+                return core::Status(core::Status::Code::Unavailable, "link down");
+            }
+            indices_.push_back(chunk.index);
+            compressions_.push_back(chunk.compression);
+        }
+        return sink_.put(chunk);
+    }
+
+    core::Status finish(const std::string& object) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (fail_finish_) {
+                return core::Status(core::Status::Code::Unavailable, "link down");
+            }
+        }
+        return sink_.finish(object);
+    }
+
+    void fail_next_puts(int count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failures_left_ = count;
+    }
+
+    void fail_from(uint64_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fail_from_ = index;
+    }
+
+    void fail_finish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        fail_finish_ = true;
+    }
+
+    void on_begin(std::function<void()> hook) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        on_begin_ = std::move(hook);
+    }
+
+    // The indices of the chunks accepted, in order.
+    std::vector<uint64_t> indices() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return indices_;
+    }
+
+    std::vector<data::Compression> compressions() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return compressions_;
+    }
+
+    // When each put() arrived, failed or not.
+    std::vector<std::chrono::steady_clock::time_point> put_times() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return put_times_;
+    }
+
+private:
+    data::FileSink sink_;
+    std::mutex mutex_;
+    std::function<void()> on_begin_;
+    int failures_left_ = 0;
+    uint64_t fail_from_ = UINT64_MAX;
+    bool fail_finish_ = false;
+    std::vector<uint64_t> indices_;
+    std::vector<data::Compression> compressions_;
+    std::vector<std::chrono::steady_clock::time_point> put_times_;
+};
+
+std::vector<uint64_t> range(uint64_t from, uint64_t to) {
+    std::vector<uint64_t> values;
+    for (uint64_t i = from; i < to; ++i) {
+        values.push_back(i);
+    }
+    return values;
+}
+
+class UploaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_uploader_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+        out_ = dir_ + "/out";
+        ASSERT_EQ(::mkdir(out_.c_str(), 0755), 0);
+        source_ = dir_ + "/log_000001.iglog";
+        uploaded_ = out_ + "/log_000001.iglog";
+    }
+
+    void TearDown() override {
+        for (const auto& d : {out_, dir_}) {
+            if (DIR* handle = opendir(d.c_str())) {
+                while (dirent* e = readdir(handle)) {
+                    const std::string name = e->d_name;
+                    if (name != "." && name != ".." && name != "out") {
+                        std::remove((d + "/" + name).c_str());
+                    }
+                }
+                closedir(handle);
+            }
+            rmdir(d.c_str());
+        }
+    }
+
+    data::UploaderOptions options() const {
+        data::UploaderOptions options;
+        options.chunk_size = kChunk;
+        options.max_chunks_ahead = 3;
+        options.retry_delay = 5ms;
+        options.max_retry_delay = 20ms;
+        return options;
+    }
+
+    std::string progress() const { return source_ + ".upload"; }
+
+    // Waits for the uploader to have retried at least once, i.e. to be stuck where the sink fails.
+    static bool wait_for_retry(data::Uploader& uploader) {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (uploader.stats().retries == 0) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return true;
+    }
+
+    std::string dir_;
+    std::string out_;
+    std::string source_;
+    std::string uploaded_;
+};
+
+} // namespace
+
+TEST(TokenBucketTest, AllowsTheBurstThenPacesToTheRate) {
+    data::TokenBucket bucket(10000000, 100000); // 10 MB/s, 100 kB at once
+    EXPECT_EQ(bucket.take(100000).count(), 0);
+    const double debt_ms = std::chrono::duration<double, std::milli>(bucket.take(50000)).count();
+    EXPECT_GT(debt_ms, 4.0);
+    EXPECT_LT(debt_ms, 5.1);
+
+    // A sender that waits out each debt averages the rate, whatever its chunk size.
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i) {
+        std::this_thread::sleep_for(bucket.take(50000)); // 1 MB in all: 100 ms
+    }
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed_ms, 100.0);
+    if (timing_is_meaningful()) {
+        EXPECT_LT(elapsed_ms, 150.0);
+    }
+}
+
+TEST(TokenBucketTest, ZeroRateIsUnlimited) {
+    data::TokenBucket bucket(0, 1000);
+    EXPECT_EQ(bucket.take(1u << 30).count(), 0);
+    bucket.set_rate(1000);
+    EXPECT_EQ(bucket.rate(), 1000u);
+    EXPECT_EQ(bucket.take(1000).count(), 0) << "The bucket starts full";
+    EXPECT_GT(bucket.take(1000).count(), 0);
+    bucket.set_rate(0);
+    EXPECT_EQ(bucket.take(1u << 30).count(), 0) << "Debt is forgiven when the limit is lifted";
+}
+
+TEST_F(UploaderTest, ReassemblesTheFileInTheSink) {
+    const auto source = make_source(10 * kChunk + 1000);
+    write_file(source_, source);
+    auto sink = std::make_shared<RecordingSink>(out_);
+    data::Uploader uploader(sink, options());
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s));
+
+    EXPECT_EQ(read_file(uploaded_), source);
+    EXPECT_FALSE(exists(uploaded_ + ".part"));
+    EXPECT_FALSE(exists(progress())) << "Removed once the upload is complete";
+    EXPECT_TRUE(exists(source_));
+    EXPECT_EQ(sink->indices(), range(0, 11));
+
+    const auto stats = uploader.stats();
+    EXPECT_EQ(stats.files_uploaded, 1u);
+    EXPECT_EQ(stats.chunks_uploaded, 11u);
+    EXPECT_EQ(stats.raw_bytes, source.size());
+    EXPECT_EQ(stats.retries, 0u);
+
+    // Both builds reassemble the same bytes; only what travels differs.
+    const auto compressions = sink->compressions();
+    if (data::Uploader::compression_available(data::Compression::Zstd)) {
+        EXPECT_EQ(compressions[0], data::Compression::Zstd) << "Zeros compress";
+        EXPECT_EQ(compressions[1], data::Compression::None) << "Noise is sent as it is";
+        EXPECT_LT(stats.sent_bytes, stats.raw_bytes);
+    } else {
+        EXPECT_EQ(compressions, std::vector<data::Compression>(11, data::Compression::None));
+        EXPECT_EQ(stats.sent_bytes, stats.raw_bytes);
+    }
+}
+
+TEST_F(UploaderTest, DeletesTheFileAfterUploadOnRequest) {
+    const auto source = make_source(3 * kChunk);
+    write_file(source_, source);
+    auto opts = options();
+    opts.compression = data::Compression::None;
+    opts.delete_after_upload = true;
+    data::Uploader uploader(std::make_shared<data::FileSink>(out_), opts);
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s));
+    EXPECT_EQ(read_file(uploaded_), source);
+    EXPECT_FALSE(exists(source_));
+}
+
+TEST_F(UploaderTest, ResumesFromTheFirstUnacknowledgedChunk) {
+    const auto source = make_source(10 * kChunk + 1000);
+    write_file(source_, source);
+    {
+        // The link goes down after five chunks, and the uploader is stopped there.
+        auto sink = std::make_shared<RecordingSink>(out_);
+        sink->fail_from(5);
+        data::Uploader uploader(sink, options());
+        ASSERT_TRUE(uploader.start().ok());
+        uploader.enqueue(source_);
+        ASSERT_TRUE(wait_for_retry(uploader));
+        uploader.stop();
+        EXPECT_EQ(sink->indices(), range(0, 5));
+        EXPECT_NE(read_file(progress()).size(), 0u);
+    }
+
+    auto sink = std::make_shared<RecordingSink>(out_);
+    data::Uploader uploader(sink, options());
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s));
+    EXPECT_EQ(sink->indices(), range(5, 11));
+    EXPECT_EQ(uploader.stats().chunks_resumed, 5u);
+    EXPECT_EQ(uploader.stats().chunks_uploaded, 6u);
+    EXPECT_EQ(read_file(uploaded_), source);
+    EXPECT_FALSE(exists(progress()));
+}
+
+TEST_F(UploaderTest, StartsOverWhenTheFileOrTheChunkingChanged) {
+    const auto source = make_source(10 * kChunk + 1000);
+    write_file(source_, source);
+    const unsigned long long size = source.size();
+    const std::string stale[] = {
+        "ignlink-upload 1 size " + std::to_string(size + 1) + " chunk_size 4096 acked 5\n", // Another file
+        "ignlink-upload 1 size " + std::to_string(size) + " chunk_size 8192 acked 5\n",     // Other chunks
+        "garbage\n",
+    };
+    for (const auto& text : stale) {
+        write_file(progress(), std::vector<uint8_t>(text.begin(), text.end()));
+        auto sink = std::make_shared<RecordingSink>(out_);
+        data::Uploader uploader(sink, options());
+        ASSERT_TRUE(uploader.start().ok());
+        uploader.enqueue(source_);
+        ASSERT_TRUE(uploader.wait_idle(5s));
+        EXPECT_EQ(sink->indices(), range(0, 11)) << text;
+        EXPECT_EQ(uploader.stats().chunks_resumed, 0u) << text;
+        EXPECT_EQ(read_file(uploaded_), source);
+    }
+}
+
+TEST_F(UploaderTest, RetriesWithExponentialBackoff) {
+    const auto source = make_source(2 * kChunk);
+    write_file(source_, source);
+    auto sink = std::make_shared<RecordingSink>(out_);
+    sink->fail_next_puts(4);
+    auto opts = options();
+    opts.retry_delay = 10ms;
+    opts.max_retry_delay = 40ms;
+    data::Uploader uploader(sink, opts);
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s));
+    EXPECT_EQ(read_file(uploaded_), source);
+    EXPECT_EQ(uploader.stats().retries, 4u);
+
+    // Four failures of chunk 0, its success, then chunk 1.
+    const auto times = sink->put_times();
+    ASSERT_EQ(times.size(), 6u);
+    const double expected_ms[] = {10, 20, 40, 40}; // Doubling, capped at max_retry_delay
+    for (size_t i = 0; i < 4; ++i) {
+        const double gap_ms = std::chrono::duration<double, std::milli>(times[i + 1] - times[i]).count();
+        EXPECT_GE(gap_ms, expected_ms[i] - 0.5) << i;
+        if (timing_is_meaningful()) {
+            EXPECT_LT(gap_ms, expected_ms[i] + 15) << i;
+        }
+    }
+}
+
+TEST_F(UploaderTest, PacesTheUploadToTheBandwidthLimit) {
+    const auto source = make_source(50 * kChunk); // 200 kB
+    write_file(source_, source);
+    auto opts = options();
+    opts.compression = data::Compression::None;
+    opts.bandwidth_limit = 1000000; // 1 MB/s
+    opts.burst_bytes = kChunk;
+    data::Uploader uploader(std::make_shared<data::FileSink>(out_), opts);
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(read_file(uploaded_), source);
+    EXPECT_GE(seconds, static_cast<double>(source.size() - kChunk) / 1e6);
+    if (timing_is_meaningful()) {
+        EXPECT_LT(seconds, static_cast<double>(source.size()) / 1e6 + 0.1);
+    }
+}
+
+TEST_F(UploaderTest, GivesUpOnAFileThatCannotBeRead) {
+    const auto source = make_source(10 * kChunk);
+    write_file(source_, source);
+    auto sink = std::make_shared<RecordingSink>(out_);
+    // The file shrinks once the upload has started.
+    sink->on_begin([this] { ASSERT_EQ(::truncate(source_.c_str(), 4 * kChunk), 0); });
+    data::Uploader uploader(sink, options());
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(uploader.wait_idle(5s)) << "Moves on rather than retrying forever";
+    EXPECT_EQ(sink->indices(), range(0, 4));
+    EXPECT_EQ(uploader.stats().files_uploaded, 0u);
+    EXPECT_FALSE(exists(uploaded_));
+    EXPECT_TRUE(exists(progress())) << "Kept, so that a later enqueue can resume";
+}
+
+TEST_F(UploaderTest, ClampsChunksToWhatAChunkCanDescribe) {
+    write_file(source_, make_source(kChunk));
+    auto sink = std::make_shared<RecordingSink>(out_);
+    sink->fail_finish(); // Stops it right after the progress is saved
+    auto opts = options();
+    opts.chunk_size = size_t(1) << 33; // UploadChunk::raw_size is 32 bits
+    data::Uploader uploader(sink, opts);
+    ASSERT_TRUE(uploader.start().ok());
+    uploader.enqueue(source_);
+    ASSERT_TRUE(wait_for_retry(uploader));
+    uploader.stop();
+
+    const auto text = read_file(progress());
+    unsigned long long size = 0, chunk_size = 0, acked = 0;
+    ASSERT_EQ(std::sscanf(std::string(text.begin(), text.end()).c_str(),
+                          "ignlink-upload 1 size %llu chunk_size %llu acked %llu", &size, &chunk_size, &acked),
+              3);
+    EXPECT_EQ(chunk_size, 0xffffffffull);
+    EXPECT_EQ(acked, 1u);
+}
@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/fleet/ota_handler.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return Bytes(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const Bytes& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+Bytes random_bytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    Bytes data(size);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+// A new version of `image`: a few patched regions, an insertion that shifts
+// everything after it, and a new tail.
+Bytes next_version(const Bytes& image) {
+    Bytes next = image;
+    std::mt19937 rng(7);
+    for (size_t region = 0; region < 8; ++region) {
+        const size_t at = rng() % (next.size() - 10000);
+        for (size_t i = 0; i < 5000; ++i) {
+            next[at + i] = static_cast<uint8_t>(rng());
+        }
+    }
+    const Bytes inserted = random_bytes(12345, 8);
+    next.insert(next.begin() + static_cast<std::ptrdiff_t>(next.size() / 3), inserted.begin(), inserted.end());
+    const Bytes tail = random_bytes(100000, 9);
+    next.insert(next.end(), tail.begin(), tail.end());
+    return next;
+}
+
+// The update server stand-in, with failures and a hook on every read.
+class TestSource : public fleet::FileOtaSource {
+public:
+    using FileOtaSource::FileOtaSource;
+
+    core::Status read(const std::string& package, uint64_t offset, uint8_t* buffer, size_t capacity,
+                      size_t* bytes) override {
+        if (on_read) {
+            on_read(offset);
+        }
+        if (fail_every > 0 && ++reads % fail_every == 0) {
+            return core::Status(core::Status::Code::Unavailable, "Injected failure");
+        }
+        return FileOtaSource::read(package, offset, buffer, capacity, bytes);
+    }
+
+    size_t fail_every = 0;
+    size_t reads = 0;
+    std::function<void(uint64_t)> on_read;
+};
+
+class OtaHandlerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_ota_XXXXXX";
+        ASSERT_NE(mkdtemp(pattern), nullptr);
+        dir_ = pattern;
+        options_.slot_a = dir_ + "/slot_a.img";
+        options_.slot_b = dir_ + "/slot_b.img";
+        options_.state_path = dir_ + "/slots";
+        options_.checkpoint_bytes = 1024 * 1024;
+        options_.retry_delay = std::chrono::milliseconds(1);
+        options_.max_retry_delay = std::chrono::milliseconds(4);
+        source_ = std::make_shared<TestSource>(dir_);
+
+        installed_ = random_bytes(16 * 1024 * 1024, 1);
+        write_file(options_.slot_a, installed_);
+        target_ = next_version(installed_);
+        write_file(dir_ + "/target.img", target_);
+    }
+
+    void TearDown() override {
+        for (const char* name : {"/slot_a.img", "/slot_b.img", "/slots", "/slots.progress", "/target.img",
+                                 "/update.pkg", "/full.pkg"}) {
+            std::remove((dir_ + name).c_str());
+        }
+        rmdir(dir_.c_str());
+    }
+
+    fleet::OtaUpdate make_package(const std::string& name, bool delta, uint32_t chunk_size = 256 * 1024) {
+        fleet::OtaPackageOptions package_options;
+        package_options.chunk_size = chunk_size;
+        fleet::OtaUpdate update;
+        update.package = name;
+        update.version = "2.0.0";
+        EXPECT_TRUE(fleet::create_ota_package(delta ? options_.slot_a : "", dir_ + "/target.img", dir_ + "/" + name,
+                                              package_options, &update.target_root)
+                        .ok());
+        return update;
+    }
+
+    std::string dir_;
+    fleet::OtaHandlerOptions options_;
+    std::shared_ptr<TestSource> source_;
+    Bytes installed_;
+    Bytes target_;
+};
+
+} // namespace
+
+TEST_F(OtaHandlerTest, AppliesADeltaIntoTheInactiveSlot) {
+    const auto update = make_package("update.pkg", true);
+    const size_t package_size = read_file(dir_ + "/update.pkg").size();
+    EXPECT_LT(package_size, target_.size() / 20) << "a delta only carries what changed";
+
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    EXPECT_EQ(ota.active_slot(), fleet::OtaHandler::Slot::A);
+    const auto status = ota.apply(update);
+    ASSERT_TRUE(status.ok()) << status.message();
+
+    EXPECT_TRUE(ota.staged());
+    EXPECT_EQ(read_file(options_.slot_b), target_);
+    EXPECT_EQ(read_file(options_.slot_a), installed_) << "the active slot is never written";
+    const auto stats = ota.stats();
+    EXPECT_EQ(stats.downloaded_bytes, package_size);
+    EXPECT_EQ(stats.copied_bytes + stats.inserted_bytes, target_.size());
+    EXPECT_GT(stats.copied_bytes, target_.size() * 9 / 10);
+    // Bounded by the options, not by the image: 4 x 256 KiB download + 5 x 256 KiB chunks.
+    EXPECT_LE(stats.peak_buffer_bytes, 9u * 256 * 1024);
+    std::printf("[ ota        ] %zu KiB package for a %zu KiB image, peak buffers %llu KiB\n", package_size / 1024,
+                target_.size() / 1024, static_cast<unsigned long long>(stats.peak_buffer_bytes / 1024));
+
+    ASSERT_TRUE(ota.switch_slot().ok());
+    EXPECT_EQ(ota.active_slot(), fleet::OtaHandler::Slot::B);
+    EXPECT_TRUE(ota.pending());
+    EXPECT_EQ(ota.slot_version(fleet::OtaHandler::Slot::B), "2.0.0");
+    ASSERT_TRUE(ota.confirm().ok());
+
+    // The state survives a restart.
+    fleet::OtaHandler restarted(source_, options_);
+    ASSERT_TRUE(restarted.load().ok());
+    EXPECT_EQ(restarted.active_slot(), fleet::OtaHandler::Slot::B);
+    EXPECT_FALSE(restarted.pending());
+}
+
+TEST_F(OtaHandlerTest, AppliesAFullImage) {
+    const auto update = make_package("full.pkg", false);
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    ASSERT_TRUE(ota.apply(update).ok());
+    EXPECT_EQ(read_file(options_.slot_b), target_);
+    EXPECT_EQ(ota.stats().copied_bytes, 0u);
+}
+
+TEST_F(OtaHandlerTest, ResumesAnInterruptedDownload) {
+    const auto update = make_package("full.pkg", false);
+    const size_t package_size = read_file(dir_ + "/full.pkg").size();
+
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    source_->on_read = [&](uint64_t offset) {
+        if (offset > package_size / 2) {
+            ota.cancel();
+        }
+    };
+    EXPECT_FALSE(ota.apply(update).ok());
+    EXPECT_FALSE(ota.staged());
+    const uint64_t first_run = ota.stats().downloaded_bytes;
+
+    // A new handler, as after a reboot.
+    source_->on_read = nullptr;
+    fleet::OtaHandler resumed(source_, options_);
+    ASSERT_TRUE(resumed.load().ok());
+    const auto status = resumed.apply(update);
+    ASSERT_TRUE(status.ok()) << status.message();
+    EXPECT_EQ(read_file(options_.slot_b), target_);
+
+    const auto stats = resumed.stats();
+    EXPECT_GT(stats.resumed_bytes, package_size / 4);
+    // Only the header, the hash table and what followed the last checkpoint are downloaded again.
+    EXPECT_LT(first_run + stats.downloaded_bytes, package_size + options_.checkpoint_bytes + 2 * 1024 * 1024);
+}
+
+TEST_F(OtaHandlerTest, RetriesTransientFailures) {
+    const auto update = make_package("update.pkg", true);
+    source_->fail_every = 3;
+    options_.read_size = 16 * 1024;
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    ASSERT_TRUE(ota.apply(update).ok());
+    EXPECT_GT(ota.stats().retries, 0u);
+    EXPECT_EQ(read_file(options_.slot_b), target_);
+}
+
+TEST_F(OtaHandlerTest, RejectsACorruptPackage) {
+    auto update = make_package("full.pkg", false);
+    Bytes package = read_file(dir_ + "/full.pkg");
+    package[package.size() / 2] ^= 0x40; // In the inline data
+    write_file(dir_ + "/full.pkg", package);
+
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    EXPECT_FALSE(ota.apply(update).ok());
+    EXPECT_FALSE(ota.staged());
+    EXPECT_FALSE(ota.switch_slot().ok());
+    EXPECT_EQ(ota.active_slot(), fleet::OtaHandler::Slot::A);
+
+    // A package for another image is refused before anything is written.
+    update.target_root = std::string(64, '0');
+    EXPECT_FALSE(ota.apply(update).ok());
+}
+
+TEST_F(OtaHandlerTest, RefusesADeltaForAnotherInstalledVersion) {
+    const auto update = make_package("update.pkg", true);
+    installed_[12345] ^= 1;
+    write_file(options_.slot_a, installed_);
+
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    EXPECT_FALSE(ota.apply(update).ok());
+    EXPECT_FALSE(ota.staged());
+}
+
+TEST_F(OtaHandlerTest, RollsBackAnUnconfirmedSwitch) {
+    const auto update = make_package("update.pkg", true);
+    fleet::OtaHandler ota(source_, options_);
+    ASSERT_TRUE(ota.load().ok());
+    ASSERT_TRUE(ota.apply(update).ok());
+    ASSERT_TRUE(ota.switch_slot().ok());
+    EXPECT_FALSE(ota.apply(update).ok()) << "no update while on probation";
+    ASSERT_TRUE(ota.rollback().ok());
+    EXPECT_EQ(ota.active_slot(), fleet::OtaHandler::Slot::A);
+    EXPECT_FALSE(ota.pending());
+    EXPECT_FALSE(ota.rollback().ok());
+}
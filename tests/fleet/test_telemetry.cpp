@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/fleet/client.h>
+#include <ignlink/fleet/telemetry.h>
+#include <ignlink/core/timestamp.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace ignlink;
+
+namespace {
+
+// Counts the allocations of the calling thread, to check the recording path makes none.
+thread_local uint64_t t_allocations = 0;
+
+void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    ++t_allocations;
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+}
+
+void* allocate_or_throw(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    if (void* p = allocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// Every form is replaced, so that each new pairs with a matching delete.
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int kThreads = 8;
+
+template <typename Fn>
+void run_threads(int threads, Fn fn) {
+    std::vector<std::thread> workers;
+    std::atomic<int> ready{0};
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            // Start together, to maximise contention.
+            ready.fetch_add(1);
+            while (ready.load() < threads) {
+            }
+            fn(t);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+class RecordingTransport : public fleet::ClientTransport {
+public:
+    core::Status send(const std::string&, const std::string& channel, const std::vector<uint8_t>& payload) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (channel == "telemetry") {
+            batches.push_back(payload);
+        }
+        return core::Status::OK();
+    }
+
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> batches;
+};
+
+} // namespace
+
+TEST(TelemetryTest, HistogramBucketsAreMonotonicAndTight) {
+    size_t previous = 0;
+    for (uint64_t v = 1; v < (uint64_t(1) << 40); v = v * 17 / 16 + 1) {
+        const size_t bucket = fleet::detail::histogram_bucket(v);
+        ASSERT_GE(bucket, previous);
+        ASSERT_LT(bucket, fleet::detail::kHistogramBuckets);
+        const uint64_t lower = fleet::detail::histogram_bucket_lower_bound(bucket);
+        ASSERT_LE(lower, v);
+        ASSERT_LE(v - lower, v / 8) << "more than 12.5% error at " << v;
+        previous = bucket;
+    }
+    EXPECT_EQ(fleet::detail::histogram_bucket(~uint64_t(0)), fleet::detail::kHistogramBuckets - 1);
+}
+
+TEST(TelemetryTest, CountersAreExactUnderContention) {
+    fleet::MetricsRegistry registry;
+    const auto hits = registry.counter("hits");
+    const auto bytes = registry.counter("bytes");
+    constexpr uint64_t kIterations = 1000000;
+
+    // Collect continuously while the threads count, as the collector thread would.
+    std::atomic<bool> done{false};
+    uint64_t last_seen = 0;
+    bool monotonic = true;
+    std::thread collector([&] {
+        while (!done.load()) {
+            const uint64_t seen = registry.collect().counters[0];
+            monotonic = monotonic && seen >= last_seen;
+            last_seen = seen;
+        }
+    });
+    run_threads(kThreads, [&](int) {
+        for (uint64_t i = 0; i < kIterations; ++i) {
+            hits.increment();
+            bytes.increment(3);
+        }
+    });
+    done.store(true);
+    collector.join();
+
+    // The threads have exited; their totals must survive them.
+    const auto snapshot = registry.collect();
+    EXPECT_TRUE(monotonic);
+    EXPECT_EQ(snapshot.counters[0], kThreads * kIterations);
+    EXPECT_EQ(snapshot.counters[1], 3 * kThreads * kIterations);
+}
+
+TEST(TelemetryTest, HistogramsAreExactUnderContention) {
+    fleet::MetricsRegistry registry;
+    const auto latency = registry.histogram("latency_ns");
+    constexpr uint64_t kIterations = 200000;
+
+    run_threads(kThreads, [&](int) {
+        for (uint64_t i = 0; i < kIterations; ++i) {
+            latency.record(i % 1000);
+        }
+    });
+
+    const auto histogram = registry.collect().histograms[0];
+    EXPECT_EQ(histogram.count, kThreads * kIterations);
+    EXPECT_EQ(histogram.sum, kThreads * (kIterations / 1000) * (999 * 1000 / 2));
+    const uint64_t median = histogram.percentile(50);
+    EXPECT_GE(median, 440u);
+    EXPECT_LE(median, 500u);
+}
+
+TEST(TelemetryTest, GaugesKeepTheLastValue) {
+    fleet::MetricsRegistry registry;
+    const auto depth = registry.gauge("queue_depth");
+    depth.set(10);
+    depth.add(-3);
+    EXPECT_EQ(registry.collect().gauges[0], 7);
+    registry.gauge("queue_depth").set(1);
+    EXPECT_EQ(registry.collect().gauges[0], 1) << "the same name gives the same gauge";
+    EXPECT_EQ(registry.metrics().size(), 1u);
+}
+
+TEST(TelemetryTest, RecordingIsFastAndDoesNotAllocate) {
+    fleet::MetricsRegistry registry;
+    const auto counter = registry.counter("ops");
+    const auto histogram = registry.histogram("ops_ns");
+    constexpr uint64_t kIterations = 5000000;
+
+    std::atomic<int64_t> slowest_ns_per_op{0};
+    std::atomic<uint64_t> allocations{0};
+    run_threads(kThreads, [&](int) {
+        counter.increment(); // First use of the registry and of the histogram
+        histogram.record(0);
+        const uint64_t allocations_before = t_allocations;
+        const int64_t start = core::MonotonicClock::now_ns();
+        for (uint64_t i = 0; i < kIterations; ++i) {
+            counter.increment();
+            histogram.record(i & 0xffff);
+        }
+        const int64_t ns_per_op = (core::MonotonicClock::now_ns() - start) / static_cast<int64_t>(kIterations);
+        allocations.fetch_add(t_allocations - allocations_before);
+        int64_t slowest = slowest_ns_per_op.load();
+        while (ns_per_op > slowest && !slowest_ns_per_op.compare_exchange_weak(slowest, ns_per_op)) {
+        }
+    });
+
+    std::printf("[ telemetry  ] %lld ns per increment + record, %d threads\n",
+                static_cast<long long>(slowest_ns_per_op.load()), kThreads);
+    EXPECT_EQ(allocations.load(), 0u);
+    // A handful of nanoseconds on an idle core; generous for shared CI machines.
+    EXPECT_LT(slowest_ns_per_op.load(), 200);
+    EXPECT_EQ(registry.collect().counters[0], kThreads * (kIterations + 1));
+}
+
+TEST(TelemetryTest, BatchesDecodeToTheSameTotals) {
+    fleet::MetricsRegistry registry;
+    const auto sent = registry.counter("msg.sent");
+    registry.counter("msg.idle"); // Never incremented: never sent
+    const auto depth = registry.gauge("msg.depth");
+    const auto latency = registry.histogram("msg.latency_ns");
+
+    auto transport = std::make_shared<RecordingTransport>();
+    fleet::ClientOptions client_options;
+    client_options.device_id = "test-device";
+    fleet::Client client(transport, client_options);
+    ASSERT_TRUE(client.start().ok());
+
+    fleet::TelemetryOptions options;
+    options.definitions_every = 3;
+    fleet::TelemetryCollector collector(registry, client, options);
+
+    for (int round = 0; round < 20; ++round) {
+        run_threads(4, [&](int t) {
+            for (int i = 0; i < 1000; ++i) {
+                sent.increment();
+                latency.record(static_cast<uint64_t>(t * 1000 + i));
+            }
+        });
+        depth.set(-round);
+        collector.collect();
+        if (round % 4 == 3) {
+            collector.flush();
+        }
+    }
+    // Registered late: its definition goes in a later record.
+    const auto late = registry.counter("msg.late");
+    late.increment(42);
+    collector.collect();
+    collector.flush();
+    ASSERT_TRUE(client.flush(std::chrono::seconds(5)));
+    client.stop();
+
+    fleet::TelemetryDecoder decoder;
+    size_t bytes = 0;
+    for (const auto& batch : transport->batches) {
+        ASSERT_TRUE(decoder.apply(batch));
+        bytes += batch.size();
+    }
+    EXPECT_EQ(transport->batches.size(), 6u);
+    EXPECT_EQ(decoder.records(), 21u);
+    EXPECT_EQ(decoder.counter("msg.sent"), 20u * 4 * 1000);
+    EXPECT_EQ(decoder.counter("msg.idle"), 0u);
+    EXPECT_EQ(decoder.counter("msg.late"), 42u);
+    EXPECT_EQ(decoder.gauge("msg.depth"), -19);
+    const auto histogram = decoder.histogram("msg.latency_ns");
+    const auto local = registry.collect().histograms[0];
+    EXPECT_EQ(histogram.count, local.count);
+    EXPECT_EQ(histogram.sum, local.sum);
+    EXPECT_EQ(histogram.buckets, local.buckets);
+
+    // Deltas of a steady load stay small: far below a full dump per record.
+    std::printf("[ telemetry  ] %zu bytes for %llu records\n", bytes,
+                static_cast<unsigned long long>(decoder.records()));
+    EXPECT_LT(bytes, 21u * 400);
+
+    // A truncated batch is rejected without changing the totals.
+    auto truncated = transport->batches.front();
+    truncated.resize(truncated.size() / 2);
+    EXPECT_FALSE(decoder.apply(truncated));
+    EXPECT_EQ(decoder.counter("msg.sent"), 20u * 4 * 1000);
+}
+
+TEST(TelemetryTest, CollectorThreadShipsPeriodically) {
+    fleet::MetricsRegistry registry;
+    const auto ticks = registry.counter("ticks");
+    std::mutex mutex;
+    std::vector<std::vector<uint8_t>> batches;
+
+    fleet::TelemetryOptions options;
+    options.collect_interval = std::chrono::milliseconds(5);
+    options.batch_interval = std::chrono::milliseconds(20);
+    fleet::TelemetryCollector collector(
+        registry,
+        [&](std::vector<uint8_t> batch) {
+            std::lock_guard<std::mutex> lock(mutex);
+            batches.push_back(std::move(batch));
+        },
+        options);
+    ASSERT_TRUE(collector.start().ok());
+    for (int i = 0; i < 100; ++i) {
+        ticks.increment();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    collector.stop();
+
+    fleet::TelemetryDecoder decoder;
+    for (const auto& batch : batches) {
+        ASSERT_TRUE(decoder.apply(batch));
+    }
+    EXPECT_GE(batches.size(), 2u);
+    EXPECT_EQ(decoder.counter("ticks"), 100u);
+    EXPECT_EQ(collector.stats().batches, batches.size());
+}
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/timestamp.h>
+#include <ignlink/hal/imu.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+// Collects batches from the read thread.
+class Batches {
+public:
+    void push(std::shared_ptr<const hal::ImuBatch> batch) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples_ += batch->count;
+        batches_.push_back(std::move(batch));
+        cv_.notify_all();
+    }
+
+    bool wait_for_samples(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [&] { return samples_ >= count; });
+    }
+
+    std::vector<hal::ImuSample> samples() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<hal::ImuSample> all;
+        for (const auto& batch : batches_) {
+            all.insert(all.end(), batch->begin(), batch->end());
+        }
+        return all;
+    }
+
+    std::vector<std::shared_ptr<const hal::ImuBatch>> batches() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batches_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<const hal::ImuBatch>> batches_;
+    size_t samples_ = 0;
+};
+
+hal::ImuSample make_sample(uint32_t sequence, int64_t device_time_ns) {
+    hal::ImuSample sample;
+    sample.sequence = sequence;
+    sample.device_time_ns = device_time_ns;
+    sample.accel[0] = 0.01f * static_cast<float>(sequence);
+    sample.accel[2] = 9.81f;
+    sample.gyro[1] = -0.5f * static_cast<float>(sequence % 7);
+    sample.temperature = 31.25f;
+    return sample;
+}
+
+std::vector<uint8_t> encode(const hal::ImuSample& sample) {
+    std::vector<uint8_t> packet(hal::kImuPacketSize);
+    hal::encode_imu_packet(sample, packet.data());
+    return packet;
+}
+
+// The IMU reads the slave side of a pseudo-terminal; the test plays the
+// sensor on the master side.
+class SerialImuTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        master_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+        ASSERT_GE(master_, 0);
+        ASSERT_EQ(::grantpt(master_), 0);
+        ASSERT_EQ(::unlockpt(master_), 0);
+        config_.device = ::ptsname(master_);
+    }
+
+    void TearDown() override { ::close(master_); }
+
+    void write_all(const std::vector<uint8_t>& bytes) {
+        size_t done = 0;
+        while (done < bytes.size()) {
+            const ssize_t n = ::write(master_, bytes.data() + done, bytes.size() - done);
+            ASSERT_GT(n, 0);
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    void start(hal::Imu& imu, Batches& batches) {
+        ASSERT_TRUE(imu.open(config_).ok());
+        ASSERT_TRUE(imu.start([&](std::shared_ptr<const hal::ImuBatch> batch) { batches.push(std::move(batch)); })
+                        .ok());
+    }
+
+    int master_ = -1;
+    hal::ImuConfig config_;
+};
+
+} // namespace
+
+TEST_F(SerialImuTest, DeliversFullBatchesOfDecodedSamples) {
+    auto imu = hal::create_serial_imu();
+    Batches batches;
+    config_.batch_size = 32;
+    start(*imu, batches);
+
+    constexpr uint32_t kSamples = 256;
+    std::vector<uint8_t> stream;
+    for (uint32_t i = 0; i < kSamples; ++i) {
+        const auto packet = encode(make_sample(65500 + i, 1000000 + int64_t(i) * 1000000)); // Counter wraps
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    write_all(stream);
+    ASSERT_TRUE(batches.wait_for_samples(kSamples));
+    imu->stop();
+
+    for (const auto& batch : batches.batches()) {
+        EXPECT_EQ(batch->count, 32u);
+    }
+    const auto samples = batches.samples();
+    ASSERT_EQ(samples.size(), kSamples);
+    for (uint32_t i = 0; i < kSamples; ++i) {
+        const auto& sample = samples[i];
+        EXPECT_EQ(sample.sequence, 65500 + i);
+        EXPECT_EQ(sample.device_time_ns, 1000000 + int64_t(i) * 1000000);
+        EXPECT_FLOAT_EQ(sample.accel[0], 0.01f * static_cast<float>(65500 + i));
+        EXPECT_FLOAT_EQ(sample.accel[2], 9.81f);
+        EXPECT_FLOAT_EQ(sample.gyro[1], -0.5f * static_cast<float>((65500 + i) % 7));
+        EXPECT_FLOAT_EQ(sample.temperature, 31.25f);
+        if (i > 0) {
+            EXPECT_GE(sample.timestamp_ns, samples[i - 1].timestamp_ns);
+        }
+    }
+    const auto stats = imu->stats();
+    EXPECT_EQ(stats.samples, kSamples);
+    EXPECT_EQ(stats.batches, kSamples / 32);
+    EXPECT_EQ(stats.lost, 0u);
+    EXPECT_EQ(stats.checksum_errors, 0u);
+    EXPECT_EQ(stats.skipped_bytes, 0u);
+}
+
+TEST_F(SerialImuTest, ResynchronizesAfterNoiseAndCorruptPackets) {
+    auto imu = hal::create_serial_imu();
+    Batches batches;
+    config_.batch_size = 8;
+    start(*imu, batches);
+
+    std::vector<uint8_t> stream = {0x00, 0xa5, 0x13, 0x5a, 0xa5}; // Noise, with a header byte in it
+    auto append = [&](const std::vector<uint8_t>& bytes) { stream.insert(stream.end(), bytes.begin(), bytes.end()); };
+    uint32_t sequence = 0;
+    std::vector<uint32_t> expected;
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 3; ++i, ++sequence) {
+            append(encode(make_sample(sequence, int64_t(sequence) * 1000000)));
+            expected.push_back(sequence);
+        }
+        auto corrupt = encode(make_sample(sequence++, 0));
+        corrupt[10] ^= 0x40; // Bad checksum
+        append(corrupt);
+        auto truncated = encode(make_sample(sequence++, 0));
+        truncated.resize(20); // Cut off by a line glitch
+        append(truncated);
+    }
+    for (int i = 0; i < 4; ++i, ++sequence) {
+        append(encode(make_sample(sequence, int64_t(sequence) * 1000000)));
+        expected.push_back(sequence);
+    }
+    write_all(stream);
+    ASSERT_TRUE(batches.wait_for_samples(expected.size()));
+    imu->stop();
+
+    const auto samples = batches.samples();
+    ASSERT_EQ(samples.size(), expected.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        EXPECT_EQ(samples[i].sequence, expected[i]);
+        EXPECT_FLOAT_EQ(samples[i].accel[0], 0.01f * static_cast<float>(expected[i]));
+    }
+    const auto stats = imu->stats();
+    EXPECT_GE(stats.checksum_errors, 4u);
+    EXPECT_GE(stats.skipped_bytes, 5u + 4 * (hal::kImuPacketSize + 20));
+    EXPECT_EQ(stats.lost, 8u); // The corrupt and truncated packets leave gaps in the counter
+}
+
+TEST_F(SerialImuTest, DeliversAPartialBatchWithinTheLatencyBound) {
+    auto imu = hal::create_serial_imu();
+    Batches batches;
+    config_.batch_size = 64;
+    config_.max_latency_us = 20000;
+    start(*imu, batches);
+
+    std::vector<uint8_t> stream;
+    for (uint32_t i = 0; i < 5; ++i) {
+        const auto packet = encode(make_sample(i, int64_t(i) * 1000000));
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    const auto before = std::chrono::steady_clock::now();
+    write_all(stream);
+    ASSERT_TRUE(batches.wait_for_samples(5));
+    EXPECT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(15));
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(500));
+    imu->stop();
+    ASSERT_EQ(batches.batches().size(), 1u);
+    EXPECT_EQ(batches.batches()[0]->count, 5u);
+}
+
+// A 2 kHz sensor whose bytes trickle in a few packets at a time, as from a UART.
+TEST_F(SerialImuTest, ReadsABatchAtATimeAndStampsOnTheMonotonicClock) {
+    auto imu = hal::create_serial_imu();
+    Batches batches;
+    config_.batch_size = 32;
+    start(*imu, batches);
+
+    constexpr int kSamples = 1000;
+    constexpr int kChunk = 4;
+    const int64_t epoch = core::MonotonicClock::now_ns() - 10000000;
+    for (int i = 0; i < kSamples; i += kChunk) {
+        const int64_t device_time = core::MonotonicClock::now_ns() - epoch; // The sensor's clock started 10 ms ago
+        std::vector<uint8_t> chunk;
+        for (int j = 0; j < kChunk; ++j) {
+            const auto packet = encode(make_sample(uint32_t(i + j), device_time - (kChunk - 1 - j) * 500000));
+            chunk.insert(chunk.end(), packet.begin(), packet.end());
+        }
+        write_all(chunk);
+        std::this_thread::sleep_for(std::chrono::microseconds(kChunk * 500));
+    }
+    ASSERT_TRUE(batches.wait_for_samples(kSamples));
+    imu->stop();
+
+    const auto stats = imu->stats();
+    EXPECT_EQ(stats.samples, size_t(kSamples));
+    EXPECT_EQ(stats.lost, 0u);
+    // Paced by the sample rate, not woken for every chunk.
+    EXPECT_LT(stats.reads, uint64_t(kSamples / kChunk / 2));
+
+    // Once the clock mapping has settled, times sit just after the sensor's.
+    const auto samples = batches.samples();
+    for (size_t i = 100; i < samples.size(); ++i) {
+        const int64_t sent_ns = epoch + samples[i].device_time_ns;
+        EXPECT_GE(samples[i].timestamp_ns, sent_ns - 1000000) << i;
+        EXPECT_LE(samples[i].timestamp_ns, sent_ns + 10000000) << i;
+    }
+}
+
+// The same pacing as on the read thread, from an event loop's timers.
+TEST_F(SerialImuTest, PacesReadsOnAnEventLoop) {
+    core::EventLoop loop("imu");
+    ASSERT_TRUE(loop.start().ok());
+    auto imu = hal::create_serial_imu();
+    Batches batches;
+    config_.batch_size = 32;
+    config_.max_latency_us = 20000;
+    ASSERT_TRUE(imu->open(config_).ok());
+    ASSERT_TRUE(imu->start([&](std::shared_ptr<const hal::ImuBatch> batch) {
+                       EXPECT_TRUE(loop.in_loop_thread());
+                       batches.push(std::move(batch));
+                   }, loop)
+                    .ok());
+
+    constexpr int kSamples = 1000;
+    constexpr int kChunk = 4;
+    for (int i = 0; i < kSamples; i += kChunk) {
+        std::vector<uint8_t> chunk;
+        for (int j = 0; j < kChunk; ++j) {
+            const auto packet = encode(make_sample(uint32_t(i + j), int64_t(i + j) * 500000));
+            chunk.insert(chunk.end(), packet.begin(), packet.end());
+        }
+        write_all(chunk);
+        std::this_thread::sleep_for(std::chrono::microseconds(kChunk * 500));
+    }
+    // The last 8 samples only make a partial batch, out within the latency bound.
+    ASSERT_TRUE(batches.wait_for_samples(kSamples));
+    imu->stop();
+
+    const auto stats = imu->stats();
+    EXPECT_EQ(stats.samples, size_t(kSamples));
+    EXPECT_EQ(stats.batches, size_t(kSamples / 32 + 1));
+    EXPECT_LT(stats.reads, uint64_t(kSamples / kChunk / 2));
+    const auto samples = batches.samples();
+    for (int i = 0; i < kSamples; ++i) {
+        EXPECT_EQ(samples[i].sequence, uint32_t(i));
+    }
+}
@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/timestamp.h>
+#include <ignlink/hal/can_bus.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <linux/can.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+// Collects batches from the receive thread.
+class Batches {
+public:
+    void push(std::shared_ptr<const hal::CanFrameBatch> batch) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_ += batch->frames.size();
+        batches_.push_back(std::move(batch));
+        cv_.notify_all();
+    }
+
+    bool wait_for_frames(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [&] { return frames_ >= count; });
+    }
+
+    std::vector<hal::CanFrame> frames() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<hal::CanFrame> all;
+        for (const auto& batch : batches_) {
+            all.insert(all.end(), batch->frames.begin(), batch->frames.end());
+        }
+        return all;
+    }
+
+    size_t batch_count() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batches_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<const hal::CanFrameBatch>> batches_;
+    size_t frames_ = 0;
+};
+
+hal::CanFrame make_frame(uint32_t id, uint8_t len, uint8_t fill, bool fd = false) {
+    hal::CanFrame frame;
+    frame.id = id;
+    frame.len = len;
+    frame.flags = fd ? hal::CanFrame::kFd | hal::CanFrame::kBitRateSwitch : 0;
+    std::memset(frame.data, fill, len);
+    return frame;
+}
+
+// Where there is no CAN interface, the bus runs on a connected UDP socket
+// pair carrying one SocketCAN frame per datagram: the receive path (batching,
+// timestamps, drop counting) and the send path are the same. Only the
+// kernel filters need a real (v)can interface.
+class SocketCanTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        int fds[2];
+        for (int& fd : fds) {
+            fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            ASSERT_GE(fd, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            ASSERT_EQ(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        }
+        for (int i = 0; i < 2; ++i) {
+            sockaddr_in peer{};
+            socklen_t length = sizeof(peer);
+            ASSERT_EQ(::getsockname(fds[1 - i], reinterpret_cast<sockaddr*>(&peer), &length), 0);
+            ASSERT_EQ(::connect(fds[i], reinterpret_cast<sockaddr*>(&peer), length), 0);
+        }
+        config_.interface = "udp-loopback";
+        config_.socket_fd = fds[0];
+        config_.fd_frames = true;
+        peer_ = fds[1];
+    }
+
+    void TearDown() override { ::close(peer_); }
+
+    void send_raw(const hal::CanFrame& frame) {
+        const bool fd = frame.flags & hal::CanFrame::kFd;
+        ASSERT_EQ(::send(peer_, &frame, fd ? CANFD_MTU : CAN_MTU, 0), fd ? CANFD_MTU : CAN_MTU);
+    }
+
+    hal::CanBusConfig config_;
+    int peer_ = -1;
+};
+
+} // namespace
+
+TEST_F(SocketCanTest, ReceivesBacklogsInBatches) {
+    auto bus = hal::create_socket_can_bus();
+    config_.batch_size = 32;
+    ASSERT_TRUE(bus->open(config_).ok());
+
+    constexpr size_t kFrames = 100;
+    const int64_t before = core::MonotonicClock::now_ns();
+    for (size_t i = 0; i < kFrames; ++i) {
+        send_raw(i % 10 == 9 ? make_frame(0x18daf100 | hal::CanFrame::kExtended, 64, uint8_t(i), true)
+                             : make_frame(0x100 + uint32_t(i), uint8_t(i % 9), uint8_t(i)));
+    }
+    Batches batches;
+    ASSERT_TRUE(bus->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { batches.push(std::move(batch)); })
+                    .ok());
+    ASSERT_TRUE(batches.wait_for_frames(kFrames));
+    bus->stop();
+
+    // A backlog comes out in full batches, one system call each.
+    EXPECT_EQ(batches.batch_count(), (kFrames + 31) / 32);
+    const auto frames = batches.frames();
+    ASSERT_EQ(frames.size(), kFrames);
+    for (size_t i = 0; i < kFrames; ++i) {
+        const auto& frame = frames[i];
+        if (i % 10 == 9) {
+            EXPECT_EQ(frame.identifier(), 0x18daf100u);
+            EXPECT_TRUE(frame.id & hal::CanFrame::kExtended);
+            EXPECT_TRUE(frame.flags & hal::CanFrame::kFd);
+            EXPECT_EQ(frame.len, 64);
+            EXPECT_EQ(frame.data[63], uint8_t(i));
+        } else {
+            EXPECT_EQ(frame.id, 0x100 + i);
+            EXPECT_EQ(frame.flags, 0);
+            EXPECT_EQ(frame.len, i % 9);
+        }
+        // Stamped by the kernel on arrival, on the monotonic time line.
+        EXPECT_GE(frame.timestamp_ns, before - 1000000);
+        EXPECT_LE(frame.timestamp_ns, core::MonotonicClock::now_ns());
+        if (i > 0) {
+            EXPECT_GE(frame.timestamp_ns, frames[i - 1].timestamp_ns);
+        }
+    }
+    EXPECT_EQ(bus->stats().frames, kFrames);
+    EXPECT_EQ(bus->stats().dropped, 0u);
+}
+
+TEST_F(SocketCanTest, DeliversSingleFramesWithoutWaitingForABatch) {
+    auto bus = hal::create_socket_can_bus();
+    ASSERT_TRUE(bus->open(config_).ok());
+    Batches batches;
+    ASSERT_TRUE(bus->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { batches.push(std::move(batch)); })
+                    .ok());
+    for (uint32_t i = 0; i < 3; ++i) {
+        send_raw(make_frame(0x200 + i, 8, 0xaa));
+        ASSERT_TRUE(batches.wait_for_frames(i + 1));
+    }
+    bus->stop();
+    EXPECT_EQ(batches.batch_count(), 3u);
+}
+
+TEST_F(SocketCanTest, CountsFramesTheKernelDropped) {
+    auto bus = hal::create_socket_can_bus();
+    config_.receive_buffer_bytes = 4096;
+    ASSERT_TRUE(bus->open(config_).ok());
+    for (uint32_t i = 0; i < 2000; ++i) {
+        const auto frame = make_frame(0x300, 8, 0);
+        ::send(peer_, &frame, CAN_MTU, MSG_DONTWAIT);
+    }
+    Batches batches;
+    ASSERT_TRUE(bus->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { batches.push(std::move(batch)); })
+                    .ok());
+    ASSERT_TRUE(batches.wait_for_frames(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // The kernel reports drops with the next frame it queues.
+    const size_t received = batches.frames().size();
+    send_raw(make_frame(0x301, 8, 0));
+    ASSERT_TRUE(batches.wait_for_frames(received + 1));
+    bus->stop();
+    const auto stats = bus->stats();
+    EXPECT_GT(stats.dropped, 0u);
+    EXPECT_EQ(stats.frames + stats.dropped, 2001u);
+    EXPECT_EQ(batches.frames().size(), stats.frames);
+}
+
+TEST_F(SocketCanTest, SendsClassicAndFdFramesInOneCall) {
+    auto bus = hal::create_socket_can_bus();
+    ASSERT_TRUE(bus->open(config_).ok());
+    const std::vector<hal::CanFrame> frames = {make_frame(0x10, 8, 1), make_frame(0x11, 64, 2, true),
+                                               make_frame(0x12, 0, 0)};
+    size_t sent = 0;
+    ASSERT_TRUE(bus->send(frames.data(), frames.size(), &sent).ok());
+    EXPECT_EQ(sent, 3u);
+    EXPECT_EQ(bus->stats().sent, 3u);
+
+    uint8_t buffer[128];
+    EXPECT_EQ(::recv(peer_, buffer, sizeof(buffer), 0), CAN_MTU);
+    EXPECT_EQ(::recv(peer_, buffer, sizeof(buffer), 0), CANFD_MTU);
+    canfd_frame fd_frame;
+    std::memcpy(&fd_frame, buffer, sizeof(fd_frame));
+    EXPECT_EQ(fd_frame.can_id, 0x11u);
+    EXPECT_EQ(fd_frame.len, 64);
+    EXPECT_EQ(fd_frame.data[63], 2);
+    EXPECT_EQ(::recv(peer_, buffer, sizeof(buffer), 0), CAN_MTU);
+}
+
+TEST_F(SocketCanTest, ReceivesOnAnEventLoop) {
+    core::EventLoop loop("can");
+    ASSERT_TRUE(loop.start().ok());
+    auto bus = hal::create_socket_can_bus();
+    config_.batch_size = 32;
+    ASSERT_TRUE(bus->open(config_).ok());
+    Batches batches;
+    ASSERT_TRUE(bus->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) {
+                       EXPECT_TRUE(loop.in_loop_thread());
+                       batches.push(std::move(batch));
+                   }, loop)
+                    .ok());
+    EXPECT_EQ(bus->start([](std::shared_ptr<const hal::CanFrameBatch>) {}).code(),
+              core::Status::Code::AlreadyExists);
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        send_raw(make_frame(0x200 + i, 8, 0xaa));
+        ASSERT_TRUE(batches.wait_for_frames(i + 1));
+    }
+    bus->stop();
+    // Stopped: frames stay in the socket until the next start.
+    send_raw(make_frame(0x210, 8, 0xbb));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(batches.frames().size(), 3u);
+    ASSERT_TRUE(bus->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { batches.push(std::move(batch)); },
+                           loop)
+                    .ok());
+    ASSERT_TRUE(batches.wait_for_frames(4));
+    bus->close();
+    EXPECT_EQ(batches.frames()[3].id, 0x210u);
+}
+
+// Needs a virtual CAN interface:
+//   sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+TEST(SocketCanVcanTest, KernelFiltersDropUnsubscribedFrames) {
+    if (::if_nametoindex("vcan0") == 0) {
+        GTEST_SKIP() << "no vcan0 interface";
+    }
+    hal::CanBusConfig config;
+    config.interface = "vcan0";
+    config.filters = {{0x100, 0x7f0 | hal::CanFrame::kExtended}}; // Standard IDs 0x100-0x10f
+    auto receiver = hal::create_socket_can_bus();
+    auto sender = hal::create_socket_can_bus();
+    ASSERT_TRUE(receiver->open(config).ok());
+    config.filters.clear();
+    ASSERT_TRUE(sender->open(config).ok());
+
+    Batches batches;
+    ASSERT_TRUE(
+        receiver->start([&](std::shared_ptr<const hal::CanFrameBatch> batch) { batches.push(std::move(batch)); }).ok());
+    std::vector<hal::CanFrame> frames;
+    for (uint32_t id : {0x100u, 0x200u, 0x10fu, 0x110u, 0x105u | hal::CanFrame::kExtended}) {
+        frames.push_back(make_frame(id, 8, uint8_t(id)));
+    }
+    ASSERT_TRUE(sender->send(frames.data(), frames.size()).ok());
+    ASSERT_TRUE(batches.wait_for_frames(2));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto received = batches.frames();
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0].id, 0x100u);
+    EXPECT_EQ(received[1].id, 0x10fu);
+
+    // Subscriptions changed: now only 0x200.
+    ASSERT_TRUE(receiver->set_filters({{0x200, 0x7ff | hal::CanFrame::kExtended}}).ok());
+    ASSERT_TRUE(sender->send(frames.data(), frames.size()).ok());
+    ASSERT_TRUE(batches.wait_for_frames(3));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    received = batches.frames();
+    ASSERT_EQ(received.size(), 3u);
+    EXPECT_EQ(received[2].id, 0x200u);
+}
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/event_loop.h>
+#include <ignlink/core/timestamp.h>
+#include <ignlink/hal/camera.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ignlink;
+
+namespace {
+
+constexpr uint32_t kWidth = 64;
+constexpr uint32_t kHeight = 48;
+constexpr size_t kFrameBytes = kWidth * kHeight * 2; // YUYV
+constexpr size_t kFrames = 8;
+
+// Collects frames from the capture thread.
+class Frames {
+public:
+    void push(std::shared_ptr<const hal::CameraFrame> frame) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_.push_back(std::move(frame));
+        cv_.notify_all();
+    }
+
+    bool wait_for(size_t count, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000)) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, timeout, [&] { return frames_.size() >= count; });
+    }
+
+    std::vector<std::shared_ptr<const hal::CameraFrame>> take() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::move(frames_);
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return frames_.size();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::shared_ptr<const hal::CameraFrame>> frames_;
+};
+
+class V4L2CameraTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char pattern[] = "/tmp/ignlink_camera_XXXXXX";
+        const int fd = mkstemp(pattern);
+        ASSERT_GE(fd, 0);
+        ::close(fd);
+        path_ = pattern;
+        // Every byte of frame k is k, so a frame's content tells where in the file it came from.
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        for (size_t k = 0; k < kFrames; ++k) {
+            const std::string frame(kFrameBytes, static_cast<char>(k));
+            out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        }
+
+        config_.device = "file:" + path_;
+        config_.width = kWidth;
+        config_.height = kHeight;
+        config_.format = hal::PixelFormat::YUYV;
+        config_.fps = 200;
+        config_.buffer_count = 4;
+    }
+
+    void TearDown() override { std::remove(path_.c_str()); }
+
+    std::string path_;
+    hal::CameraConfig config_;
+};
+
+} // namespace
+
+TEST_F(V4L2CameraTest, DeliversFramesInOrderWithDriverTimestamps) {
+    auto camera = hal::create_v4l2_camera();
+    ASSERT_TRUE(camera->open(config_).ok());
+    EXPECT_EQ(camera->config().width, kWidth);
+    EXPECT_EQ(camera->config().buffer_count, 4u);
+    EXPECT_TRUE(camera->config().export_dmabuf);
+
+    Frames frames;
+    const int64_t started = core::MonotonicClock::now_ns();
+    ASSERT_TRUE(camera->start([&](std::shared_ptr<const hal::CameraFrame> frame) {
+        // Keep the metadata only, so the buffer goes straight back to the driver.
+        auto copy = std::make_shared<hal::CameraFrame>();
+        copy->sequence = frame->sequence;
+        copy->timestamp_ns = frame->timestamp_ns;
+        copy->buffer_index = static_cast<const uint8_t*>(frame->image.data())[0]; // The frame's file position
+        ASSERT_EQ(frame->image.rank(), 3u);
+        EXPECT_EQ(frame->image.dim(0), kHeight);
+        EXPECT_EQ(frame->image.dim(1), kWidth);
+        EXPECT_EQ(frame->image.dim(2), 2);
+        EXPECT_EQ(frame->image.timestamp, frame->timestamp_ns);
+        EXPECT_GE(frame->dmabuf_fd, 0);
+        frames.push(std::move(copy));
+    }).ok());
+    ASSERT_TRUE(frames.wait_for(20));
+    camera->stop();
+
+    const auto received = frames.take();
+    for (size_t i = 1; i < received.size(); ++i) {
+        EXPECT_EQ(received[i]->sequence, received[i - 1]->sequence + 1);
+        EXPECT_GT(received[i]->timestamp_ns, received[i - 1]->timestamp_ns);
+        EXPECT_EQ(received[i]->buffer_index, (received[i - 1]->buffer_index + 1) % kFrames) << "played back in a loop";
+    }
+    EXPECT_GE(received.front()->timestamp_ns, started);
+    EXPECT_LE(received.back()->timestamp_ns, core::MonotonicClock::now_ns());
+    EXPECT_EQ(camera->stats().dropped, 0u);
+    EXPECT_EQ(camera->stats().buffers_held, 0u);
+}
+
+TEST_F(V4L2CameraTest, FramesAreViewsOfTheDriverBuffers) {
+    auto camera = hal::create_v4l2_camera();
+    ASSERT_TRUE(camera->open(config_).ok());
+
+    std::set<const void*> addresses;
+    Frames frames;
+    ASSERT_TRUE(camera->start([&](std::shared_ptr<const hal::CameraFrame> frame) {
+        addresses.insert(frame->image.data()); // Only touched on the capture thread until stop()
+        frames.push(std::make_shared<hal::CameraFrame>());
+    }).ok());
+    ASSERT_TRUE(frames.wait_for(20));
+    camera->stop();
+
+    // However many frames, they all live in the same few mapped buffers.
+    EXPECT_LE(addresses.size(), 4u);
+    EXPECT_EQ(camera->stats().buffers_held, 0u);
+}
+
+TEST_F(V4L2CameraTest, HeldBuffersAreNotRequeued) {
+    auto camera = hal::create_v4l2_camera();
+    ASSERT_TRUE(camera->open(config_).ok());
+
+    std::atomic<bool> keep{true};
+    Frames frames;
+    ASSERT_TRUE(camera->start([&](std::shared_ptr<const hal::CameraFrame> frame) {
+        frames.push(keep ? std::move(frame) : std::make_shared<hal::CameraFrame>());
+    }).ok());
+    ASSERT_TRUE(frames.wait_for(4));
+    // Every buffer is held: nothing more arrives, and what is held stays intact.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(frames.size(), 4u);
+    auto held = frames.take();
+    EXPECT_EQ(camera->stats().buffers_held, 4u);
+    EXPECT_EQ(camera->stats().starved, 1u);
+    for (const auto& frame : held) {
+        const auto* data = static_cast<const uint8_t*>(frame->image.data());
+        EXPECT_EQ(data[0], data[kFrameBytes - 1]);
+    }
+
+    // A tensor view keeps its buffer away from the driver after its frame is gone.
+    core::Tensor image = held[0]->image;
+    const uint8_t first = static_cast<const uint8_t*>(image.data())[0];
+    keep = false;
+    held.clear();
+    ASSERT_TRUE(frames.wait_for(10));
+    camera->stop();
+    EXPECT_EQ(camera->stats().buffers_held, 1u);
+    EXPECT_GT(camera->stats().dropped, 0u) << "the driver dropped frames while it had no buffer";
+    EXPECT_EQ(static_cast<const uint8_t*>(image.data())[kFrameBytes - 1], first);
+
+    // Frames outlive the camera.
+    camera.reset();
+    EXPECT_EQ(static_cast<const uint8_t*>(image.data())[0], first);
+}
+
+TEST_F(V4L2CameraTest, RestartsWithFramesStillHeld) {
+    auto camera = hal::create_v4l2_camera();
+    ASSERT_TRUE(camera->open(config_).ok());
+
+    std::atomic<bool> keep{true};
+    Frames frames;
+    const auto push = [&](std::shared_ptr<const hal::CameraFrame> frame) {
+        frames.push(keep ? std::move(frame) : std::make_shared<hal::CameraFrame>());
+    };
+    ASSERT_TRUE(camera->start(push).ok());
+    ASSERT_TRUE(frames.wait_for(2));
+    camera->stop();
+    auto held = frames.take();
+    ASSERT_FALSE(held.empty());
+    EXPECT_EQ(camera->stats().buffers_held, held.size());
+
+    keep = false;
+    ASSERT_TRUE(camera->start(push).ok());
+    held.clear(); // Released while streaming again: re-queued
+    ASSERT_TRUE(frames.wait_for(12));
+    camera->stop();
+    EXPECT_EQ(camera->stats().buffers_held, 0u);
+}
+
+TEST_F(V4L2CameraTest, PausesOnAnEventLoopWhileEveryBufferIsHeld) {
+    core::EventLoop loop("camera");
+    ASSERT_TRUE(loop.start().ok());
+    auto camera = hal::create_v4l2_camera();
+    ASSERT_TRUE(camera->open(config_).ok());
+
+    std::atomic<bool> keep{true};
+    Frames frames;
+    ASSERT_TRUE(camera->start([&](std::shared_ptr<const hal::CameraFrame> frame) {
+        EXPECT_TRUE(loop.in_loop_thread());
+        frames.push(keep ? std::move(frame) : std::make_shared<hal::CameraFrame>());
+    }, loop).ok());
+    ASSERT_TRUE(frames.wait_for(4));
+    // Paused: the loop sleeps rather than polling a device with no buffer to fill.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const uint64_t wakeups = loop.stats().wakeups;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(loop.stats().wakeups, wakeups);
+    EXPECT_EQ(frames.size(), 4u);
+
+    // Releasing a frame resumes it.
+    keep = false;
+    frames.take();
+    ASSERT_TRUE(frames.wait_for(10));
+    camera->stop();
+    EXPECT_EQ(camera->stats().buffers_held, 0u);
+}
+
+TEST_F(V4L2CameraTest, RejectsMissingDevices) {
+    auto camera = hal::create_v4l2_camera();
+    config_.device = "/dev/ignlink-no-such-camera";
+    EXPECT_FALSE(camera->open(config_).ok());
+    config_.device = "file:/nonexistent/frames.raw";
+    EXPECT_FALSE(camera->open(config_).ok());
+    EXPECT_FALSE(camera->start([](std::shared_ptr<const hal::CameraFrame>) {}).ok());
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/msg/loaned.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <set>
+#include <vector>
+
+using namespace ignlink;
+
+namespace {
+
+// Counts every heap allocation in the process, to show where there are none.
+std::atomic<uint64_t> g_allocations{0};
+
+struct Frame {
+    std::vector<uint8_t> pixels = std::vector<uint8_t>(1024);
+    uint64_t sequence = 0;
+};
+
+void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc wants a size that is a multiple of the alignment.
+    const size_t rounded = (size + alignment - 1) / alignment * alignment;
+    return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+}
+
+void* allocate_or_throw(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    if (void* p = allocate(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+// Every form is replaced, so that each new pairs with a matching delete.
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return allocate_or_throw(size, size_t(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocate(size, size_t(align));
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+TEST(LoanPoolTest, SharingALoanAllocatesNothing) {
+    msg::LoanPool<Frame> pool(4);
+    for (int warmup = 0; warmup < 8; ++warmup) {
+        auto shared = pool.loan();
+        std::shared_ptr<const Frame> msg = std::move(shared).share();
+    }
+
+    const uint64_t before = g_allocations.load();
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto loaned = pool.loan();
+        loaned->sequence = i;
+        std::shared_ptr<const Frame> msg = std::move(loaned).share();
+        std::shared_ptr<const Frame> copy = msg; // A second subscriber
+        ASSERT_EQ(copy->sequence, i);
+    }
+    EXPECT_EQ(g_allocations.load(), before);
+}
+
+TEST(LoanPoolTest, RecyclesMessagesWithTheirContents) {
+    msg::LoanPool<Frame> pool(1);
+    const Frame* first = nullptr;
+    {
+        auto loaned = pool.loan();
+        loaned->sequence = 42;
+        first = loaned.get();
+        auto msg = std::move(loaned).share();
+        EXPECT_FALSE(loaned);
+    }
+    auto again = pool.loan();
+    EXPECT_EQ(again.get(), first);
+    EXPECT_EQ(again->sequence, 42u);
+}
+
+TEST(LoanPoolTest, KeepsAtMostItsCapacityAfterABurst) {
+    constexpr size_t kCapacity = 4;
+    msg::LoanPool<Frame> pool(kCapacity);
+    std::vector<std::shared_ptr<const Frame>> in_flight;
+    std::set<const Frame*> addresses;
+    for (int i = 0; i < 32; ++i) {
+        auto msg = pool.loan();
+        addresses.insert(msg.get());
+        in_flight.push_back(std::move(msg).share());
+    }
+    EXPECT_EQ(addresses.size(), 32u) << "A loan never fails; extra messages are lent when all are in flight";
+    in_flight.clear();
+
+    // Only `capacity` came back to the pool; loans beyond that allocate again.
+    std::vector<msg::Loaned<Frame>> loans;
+    loans.reserve(2 * kCapacity);
+    uint64_t before = g_allocations.load();
+    for (size_t i = 0; i < kCapacity; ++i) {
+        loans.push_back(pool.loan());
+    }
+    EXPECT_EQ(g_allocations.load(), before);
+    before = g_allocations.load();
+    loans.push_back(pool.loan());
+    EXPECT_GT(g_allocations.load(), before);
+}
+
+TEST(LoanPoolTest, WeakPointersHoldTheSlotUntilTheyAreGone) {
+    msg::LoanPool<Frame> pool(1);
+    std::weak_ptr<const Frame> weak;
+    const Frame* first = nullptr;
+    {
+        auto loaned = pool.loan();
+        first = loaned.get();
+        auto msg = std::move(loaned).share();
+        weak = msg;
+    }
+    EXPECT_TRUE(weak.expired());
+
+    // The slot still holds the weak pointer's control block, so it is not lent out again.
+    auto other = pool.loan();
+    EXPECT_NE(other.get(), first);
+    weak.reset();
+    auto again = pool.loan();
+    EXPECT_EQ(again.get(), first);
+}
+
+TEST(LoanPoolTest, MessagesOutliveTheirPool) {
+    std::shared_ptr<const Frame> msg;
+    msg::Loaned<Frame> unpublished;
+    {
+        msg::LoanPool<Frame> pool(2);
+        auto loaned = pool.loan();
+        loaned->sequence = 7;
+        msg = std::move(loaned).share();
+        unpublished = pool.loan();
+    }
+    EXPECT_EQ(msg->sequence, 7u);
+    msg.reset();       // Returns to a pool state nobody else references
+    unpublished = {};  // Likewise, without ever being shared
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/msg/message_traits.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace ignlink;
+
+namespace {
+
+struct Detection {
+    std::string label;
+    float score = 0;
+    std::vector<int32_t> box;
+    IGNLINK_MESSAGE_FIELDS(label, score, box)
+};
+
+template <typename T>
+std::vector<uint8_t> serialize(const T& msg) {
+    std::vector<uint8_t> bytes(msg::MessageTraits<T>::serialized_size(msg));
+    EXPECT_EQ(msg::MessageTraits<T>::serialize(msg, bytes.data()), bytes.size());
+    return bytes;
+}
+
+} // namespace
+
+TEST(MessageTraitsTest, RoundTripsNestedMessages) {
+    std::vector<Detection> detections(2);
+    detections[0] = {"person", 0.9f, {1, 2, 3, 4}};
+    detections[1] = {"dog", 0.5f, {}};
+    const auto bytes = serialize(detections);
+
+    std::vector<Detection> decoded;
+    ASSERT_TRUE(msg::MessageTraits<std::vector<Detection>>::deserialize(bytes.data(), bytes.size(), &decoded));
+    ASSERT_EQ(decoded.size(), 2u);
+    EXPECT_EQ(decoded[0].label, "person");
+    EXPECT_EQ(decoded[0].box, (std::vector<int32_t>{1, 2, 3, 4}));
+    EXPECT_EQ(decoded[1].label, "dog");
+    EXPECT_FLOAT_EQ(decoded[1].score, 0.5f);
+
+    // Every truncation is rejected, never read past.
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        EXPECT_FALSE(msg::MessageTraits<std::vector<Detection>>::deserialize(bytes.data(), size, &decoded)) << size;
+    }
+}
+
+TEST(MessageTraitsTest, RejectsLengthsBeyondTheInputBeforeAllocating) {
+    // A 4-byte message claiming 4 billion strings.
+    const uint32_t length = 0xFFFFFFFFu;
+    std::vector<std::string> strings;
+    EXPECT_FALSE(msg::MessageTraits<std::vector<std::string>>::deserialize(&length, sizeof(length), &strings));
+
+    std::vector<Detection> detections;
+    EXPECT_FALSE(msg::MessageTraits<std::vector<Detection>>::deserialize(&length, sizeof(length), &detections));
+}
+
+TEST(MessageTraitsTest, RejectsTensorShapesWhoseSizeOverflows) {
+    core::Tensor tensor(core::DType::UInt8, {2, 2});
+    auto bytes = serialize(tensor);
+
+    // Rewrite the shape to [2^32, 2^32]: 2^64 bytes, which wraps to 0 in a size_t.
+    const int64_t huge = int64_t(1) << 32;
+    std::memcpy(bytes.data() + 16, &huge, sizeof(huge));
+    std::memcpy(bytes.data() + 24, &huge, sizeof(huge));
+    core::Tensor decoded;
+    EXPECT_FALSE(msg::MessageTraits<core::Tensor>::deserialize(bytes.data(), bytes.size(), &decoded));
+}
@@ -0,0 +1,474 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/core/timestamp.h>
+#include <ignlink/msg/transport/ipc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ignlink;
+using namespace ignlink::msg::transport;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Timing bounds are loose enough for a loaded machine, but not for sanitizers.
+bool timing_is_meaningful() {
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+    return false;
+#else
+    return std::getenv("CI") == nullptr;
+#endif
+}
+
+struct Sample {
+    uint64_t sequence;
+    int64_t sent_ns;
+};
+
+class IpcTest : public ::testing::Test {
+protected:
+    void SetUp() override { transport_ = std::make_unique<IpcTransport>("ignlink_test_" + std::to_string(::getpid())); }
+
+    void TearDown() override {
+        for (const auto& topic : topics_) {
+            transport_->unlink(topic);
+        }
+    }
+
+    TopicOptions topic(const std::string& name, size_t max_size, size_t depth) {
+        topics_.push_back(name);
+        TopicOptions options;
+        options.topic_name = name;
+        options.type_name = "test/Bytes";
+        options.type_hash = 42;
+        options.max_message_size = max_size;
+        options.depth = depth;
+        return options;
+    }
+
+    std::unique_ptr<IpcTransport> transport_;
+    std::vector<std::string> topics_;
+};
+
+/**
+ * @brief A forked process that runs `body`, tells the parent when it is
+ *        ready, and then waits to be killed.
+ */
+class Child {
+public:
+    template <typename Body>
+    explicit Child(Body body) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            return;
+        }
+        std::fflush(stdout);
+        pid_ = ::fork();
+        if (pid_ == 0) {
+            ::close(fds[0]);
+            body();
+            const char ready = 1;
+            if (::write(fds[1], &ready, 1) != 1) {
+                ::_exit(1);
+            }
+            while (true) {
+                ::pause();
+            }
+        }
+        ::close(fds[1]);
+        char ready = 0;
+        ready_ = pid_ > 0 && ::read(fds[0], &ready, 1) == 1;
+        ::close(fds[0]);
+    }
+
+    ~Child() { kill(); }
+
+    bool ready() const { return ready_; }
+
+    // Dies without running any destructors, as in a crash.
+    void kill() {
+        if (pid_ > 0) {
+            ::kill(pid_, SIGKILL);
+            ::waitpid(pid_, nullptr, 0);
+            pid_ = -1;
+        }
+    }
+
+private:
+    pid_t pid_ = -1;
+    bool ready_ = false;
+};
+
+uint64_t read_sequence(TransportReader& reader) {
+    uint64_t sequence = 0;
+    reader.poll([&](const void* data, size_t) { std::memcpy(&sequence, data, sizeof(sequence)); });
+    return sequence;
+}
+
+} // namespace
+
+TEST_F(IpcTest, OnlyTheAttachedWriterReleasesTheWriterRole) {
+    const TopicOptions options = topic("/ipc_test/claim", 64, 4);
+    std::unique_ptr<TransportWriter> first;
+    ASSERT_TRUE(transport_->create_writer(options, &first).ok());
+    {
+        std::unique_ptr<TransportWriter> refused;
+        EXPECT_EQ(transport_->create_writer(options, &refused).code(), core::Status::Code::AlreadyExists);
+        EXPECT_EQ(refused, nullptr);
+    }
+    // The refused writer is gone; the first one's claim must have survived it.
+    std::unique_ptr<TransportWriter> third;
+    EXPECT_EQ(transport_->create_writer(options, &third).code(), core::Status::Code::AlreadyExists);
+
+    first.reset();
+    std::unique_ptr<TransportWriter> fourth;
+    EXPECT_TRUE(transport_->create_writer(options, &fourth).ok());
+}
+
+TEST_F(IpcTest, TakesOverFromAWriterThatDiedMidWrite) {
+    const TopicOptions options = topic("/ipc_test/takeover", 64, 4);
+    std::unique_ptr<TransportReader> reader;
+    ASSERT_TRUE(transport_->create_reader(options, &reader).ok());
+
+    Child child([&] {
+        std::unique_ptr<TransportWriter> writer;
+        if (!transport_->create_writer(options, &writer).ok()) {
+            ::_exit(1);
+        }
+        const uint64_t first = 1;
+        writer->write(&first, sizeof(first));
+        void* buffer = nullptr;
+        if (!writer->loan(sizeof(uint64_t), &buffer).ok()) {
+            ::_exit(1);
+        }
+        std::memset(buffer, 0xff, sizeof(uint64_t)); // Dies before committing this
+        writer.release();                             // Keeps the claim, as a crash would
+    });
+    ASSERT_TRUE(child.ready());
+
+    std::unique_ptr<TransportWriter> writer;
+    EXPECT_EQ(transport_->create_writer(options, &writer).code(), core::Status::Code::AlreadyExists);
+    child.kill();
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok()) << "The dead writer's claim must lapse";
+
+    const uint64_t second = 2;
+    ASSERT_TRUE(writer->write(&second, sizeof(second)).ok());
+    std::vector<uint64_t> received;
+    reader->poll([&](const void* data, size_t) {
+        uint64_t sequence;
+        std::memcpy(&sequence, data, sizeof(sequence));
+        received.push_back(sequence);
+    });
+    EXPECT_EQ(received, (std::vector<uint64_t>{1, 2})) << "The half-written slot is never seen";
+    EXPECT_EQ(reader->lost_messages(), 0u);
+}
+
+TEST_F(IpcTest, ClearsPinsLeftByADeadReader) {
+    const TopicOptions options = topic("/ipc_test/dead_pins", 64, 4);
+    std::unique_ptr<TransportWriter> writer;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+
+    // The child pins message 1 and dies holding the view.
+    Child child([&] {
+        std::unique_ptr<TransportReader> reader;
+        if (!transport_->create_reader(options, &reader).ok()) {
+            ::_exit(1);
+        }
+        const uint64_t first = 1;
+        writer->write(&first, sizeof(first)); // Through the parent's writer, inherited across fork
+        auto* held = new std::shared_ptr<const void>();
+        reader->poll_shared([&](std::shared_ptr<const void> view, size_t) { *held = std::move(view); });
+        if (!*held) {
+            ::_exit(1);
+        }
+    });
+    ASSERT_TRUE(child.ready());
+
+    for (uint64_t i = 2; i <= 4; ++i) {
+        ASSERT_TRUE(writer->write(&i, sizeof(i)).ok());
+    }
+    const uint64_t fifth = 5; // Goes where message 1 is
+    EXPECT_EQ(writer->write(&fifth, sizeof(fifth)).code(), core::Status::Code::Unavailable)
+        << "A live reader's pin holds the slot";
+    child.kill();
+    EXPECT_TRUE(writer->write(&fifth, sizeof(fifth)).ok()) << "A dead reader's pin is cleared";
+}
+
+TEST_F(IpcTest, LoansNeverOverwriteASlotAReaderStillHolds) {
+    constexpr size_t kSize = 64;
+    const TopicOptions options = topic("/ipc_test/loan_pin", kSize, 4);
+    std::unique_ptr<TransportWriter> writer;
+    std::unique_ptr<TransportReader> reader;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+    ASSERT_TRUE(transport_->create_reader(options, &reader).ok());
+    ASSERT_TRUE(writer->supports_loans());
+
+    // Each message fills its slot with its sequence number.
+    auto publish = [&](uint8_t sequence) {
+        void* buffer = nullptr;
+        core::Status status = writer->loan(kSize, &buffer);
+        if (!status.ok()) {
+            EXPECT_EQ(buffer, nullptr);
+            return status;
+        }
+        std::memset(buffer, sequence, kSize);
+        return writer->commit(kSize);
+    };
+    auto holds = [&](const std::shared_ptr<const void>& view, uint8_t sequence) {
+        const auto* bytes = static_cast<const uint8_t*>(view.get());
+        return std::all_of(bytes, bytes + kSize, [&](uint8_t byte) { return byte == sequence; });
+    };
+
+    ASSERT_TRUE(publish(1).ok());
+    std::shared_ptr<const void> held;
+    reader->poll_shared([&](std::shared_ptr<const void> view, size_t size) {
+        EXPECT_EQ(size, kSize);
+        held = std::move(view);
+    });
+    ASSERT_TRUE(held);
+    ASSERT_TRUE(holds(held, 1));
+
+    for (uint8_t i = 2; i <= 4; ++i) {
+        ASSERT_TRUE(publish(i).ok());
+    }
+    // Message 5 would go where message 1 is.
+    EXPECT_EQ(publish(5).code(), core::Status::Code::Unavailable);
+    const std::vector<uint8_t> fifth(kSize, 5);
+    EXPECT_EQ(writer->write(fifth.data(), kSize).code(), core::Status::Code::Unavailable);
+    EXPECT_TRUE(holds(held, 1)) << "The held view was overwritten";
+
+    held.reset();
+    ASSERT_TRUE(publish(5).ok()) << "Releasing the view releases the slot";
+    std::vector<uint8_t> received;
+    reader->poll_shared([&](std::shared_ptr<const void> view, size_t) {
+        received.push_back(*static_cast<const uint8_t*>(view.get()));
+        EXPECT_TRUE(holds(view, received.back()));
+    });
+    EXPECT_EQ(received, (std::vector<uint8_t>{2, 3, 4, 5}));
+    EXPECT_EQ(reader->lost_messages(), 0u);
+}
+
+TEST_F(IpcTest, RejectsMismatchedTypes) {
+    TopicOptions options = topic("/ipc_test/types", 64, 4);
+    std::unique_ptr<TransportWriter> writer;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+
+    TopicOptions other = options;
+    other.type_name = "test/Other";
+    other.type_hash = 43;
+    std::unique_ptr<TransportReader> reader;
+    EXPECT_EQ(transport_->create_reader(other, &reader).code(), core::Status::Code::InvalidArgument);
+    EXPECT_EQ(reader, nullptr);
+    writer.reset();
+    EXPECT_EQ(transport_->create_writer(other, &writer).code(), core::Status::Code::InvalidArgument);
+
+    other.type_hash = 0; // Unknown type: accepted, as with any other transport
+    EXPECT_TRUE(transport_->create_reader(other, &reader).ok());
+    EXPECT_TRUE(transport_->create_reader(options, &reader).ok());
+}
+
+TEST_F(IpcTest, AReaderThatDiedAsleepStopsCostingWakeups) {
+    constexpr int kWrites = 100000;
+    const TopicOptions options = topic("/ipc_test/dead_sleeper", 64, 64);
+    std::unique_ptr<TransportWriter> writer;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+    auto time_writes = [&] {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < kWrites; ++i) {
+            writer->write(&i, sizeof(i));
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / kWrites;
+    };
+    const double before_ns = time_writes();
+
+    {
+        Child child([&] {
+            std::unique_ptr<TransportReader> reader;
+            if (!transport_->create_reader(options, &reader).ok()) {
+                ::_exit(1);
+            }
+            // Fall asleep on the futex, then let the parent kill us there.
+            std::thread([sleeper = reader.release()] { sleeper->wait(60s); }).detach();
+            std::this_thread::sleep_for(100ms);
+        });
+        ASSERT_TRUE(child.ready());
+    }
+
+    // A live reader asleep at the same time must still be woken once the dead one is gone.
+    std::unique_ptr<TransportReader> reader;
+    ASSERT_TRUE(transport_->create_reader(options, &reader).ok());
+    const uint64_t value = 1;
+    ASSERT_TRUE(writer->write(&value, sizeof(value)).ok()); // Wakes nobody and reaps the dead sleeper
+    reader->poll([](const void*, size_t) {});
+    std::thread wake([&] {
+        std::this_thread::sleep_for(50ms);
+        writer->write(&value, sizeof(value));
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reader->wait(10s));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+    wake.join();
+
+    const double after_ns = time_writes();
+    std::printf("ipc write: %.0f ns before a reader died asleep, %.0f ns after\n", before_ns, after_ns);
+    if (timing_is_meaningful()) {
+        // A wake-up syscall on every commit would cost several times the commit itself.
+        EXPECT_LT(after_ns, before_ns * 2 + 100);
+    }
+}
+
+TEST_F(IpcTest, ReadersBeyondTheTableAreStillWoken) {
+    const TopicOptions options = topic("/ipc_test/untracked", 64, 4);
+    std::unique_ptr<TransportWriter> writer;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+    std::vector<std::unique_ptr<TransportReader>> readers(65); // One more than the table holds
+    for (auto& reader : readers) {
+        ASSERT_TRUE(transport_->create_reader(options, &reader).ok());
+    }
+    const uint64_t value = 7;
+    std::thread wake([&] {
+        std::this_thread::sleep_for(50ms);
+        writer->write(&value, sizeof(value));
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(readers.back()->wait(10s));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+    wake.join();
+    EXPECT_EQ(read_sequence(*readers.back()), value);
+}
+
+TEST_F(IpcTest, StreamsAcrossProcessesInOrder) {
+    constexpr uint64_t kMessages = 200000;
+    constexpr size_t kSize = 1024;
+    const TopicOptions options = topic("/ipc_test/stream", kSize, 4096);
+    std::unique_ptr<TransportWriter> writer;
+    std::unique_ptr<TransportReader> reader;
+    ASSERT_TRUE(transport_->create_writer(options, &writer).ok());
+    ASSERT_TRUE(transport_->create_reader(options, &reader).ok());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::fflush(stdout);
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        std::vector<uint8_t> payload(kSize, 0x5a);
+        for (uint64_t i = 1; i <= kMessages; ++i) {
+            std::memcpy(payload.data(), &i, sizeof(i));
+            if (!writer->write(payload.data(), payload.size()).ok()) {
+                ::_exit(1);
+            }
+        }
+        ::_exit(0);
+    }
+
+    // The writer never waits for us: whatever we fall behind on shows up as
+    // lost, never as a reordered or torn message.
+    uint64_t received = 0;
+    uint64_t last = 0;
+    uint64_t bad = 0;
+    while (last < kMessages && std::chrono::steady_clock::now() - start < 20s) {
+        reader->wait(10ms);
+        reader->poll([&](const void* data, size_t size) {
+            uint64_t sequence;
+            std::memcpy(&sequence, data, sizeof(sequence));
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            bad += size != kSize || sequence <= last || bytes[kSize - 1] != 0x5a;
+            last = sequence;
+            ++received;
+        });
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    EXPECT_EQ(bad, 0u);
+    EXPECT_EQ(last, kMessages);
+    EXPECT_EQ(received + reader->lost_messages(), kMessages);
+    EXPECT_GT(received, 0u);
+    std::printf("ipc stream: %.0f msgs/s, %.1f MB/s of %zu-byte messages, %llu of %llu received\n",
+                static_cast<double>(kMessages) / seconds, static_cast<double>(kMessages * kSize) / seconds / 1e6,
+                kSize, static_cast<unsigned long long>(received), static_cast<unsigned long long>(kMessages));
+    RecordProperty("msgs_per_second", std::to_string(static_cast<double>(kMessages) / seconds));
+}
+
+TEST_F(IpcTest, RoundTripLatencyAcrossProcesses) {
+    constexpr int kRounds = 2000;
+    const TopicOptions ping_options = topic("/ipc_test/ping", sizeof(Sample), 16);
+    const TopicOptions pong_options = topic("/ipc_test/pong", sizeof(Sample), 16);
+    std::unique_ptr<TransportWriter> ping_writer, pong_writer;
+    std::unique_ptr<TransportReader> ping_reader, pong_reader;
+    ASSERT_TRUE(transport_->create_writer(ping_options, &ping_writer).ok());
+    ASSERT_TRUE(transport_->create_reader(ping_options, &ping_reader).ok());
+    ASSERT_TRUE(transport_->create_writer(pong_options, &pong_writer).ok());
+    ASSERT_TRUE(transport_->create_reader(pong_options, &pong_reader).ok());
+
+    // The child echoes every ping until it sees sequence 0.
+    std::fflush(stdout);
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        bool done = false;
+        const auto deadline = std::chrono::steady_clock::now() + 30s;
+        while (!done && std::chrono::steady_clock::now() < deadline) {
+            ping_reader->wait(100ms);
+            ping_reader->poll([&](const void* data, size_t size) {
+                Sample sample;
+                std::memcpy(&sample, data, sizeof(sample));
+                done = sample.sequence == 0;
+                pong_writer->write(data, size);
+            });
+        }
+        ::_exit(done ? 0 : 1);
+    }
+
+    std::vector<int64_t> one_way_ns;
+    one_way_ns.reserve(kRounds);
+    for (uint64_t round = 1; round <= kRounds; ++round) {
+        const Sample ping{round, core::MonotonicClock::now_ns()};
+        ASSERT_TRUE(ping_writer->write(&ping, sizeof(ping)).ok());
+        bool answered = false;
+        const auto deadline = std::chrono::steady_clock::now() + 2s;
+        while (!answered && std::chrono::steady_clock::now() < deadline) {
+            pong_reader->wait(100ms);
+            pong_reader->poll([&](const void* data, size_t) {
+                Sample pong;
+                std::memcpy(&pong, data, sizeof(pong));
+                if (pong.sequence == round) {
+                    answered = true;
+                    one_way_ns.push_back((core::MonotonicClock::now_ns() - pong.sent_ns) / 2);
+                }
+            });
+        }
+        ASSERT_TRUE(answered) << "no pong for round " << round;
+    }
+    const Sample stop{0, 0};
+    ping_writer->write(&stop, sizeof(stop));
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::sort(one_way_ns.begin(), one_way_ns.end());
+    const double p50_us = static_cast<double>(one_way_ns[one_way_ns.size() / 2]) / 1e3;
+    const double p99_us = static_cast<double>(one_way_ns[one_way_ns.size() * 99 / 100]) / 1e3;
+    std::printf("ipc one-way latency (round trip / 2): p50 %.1f us, p99 %.1f us\n", p50_us, p99_us);
+    RecordProperty("p50_us", std::to_string(p50_us));
+    RecordProperty("p99_us", std::to_string(p99_us));
+    if (timing_is_meaningful()) {
+        // Readers spin briefly before sleeping on the futex, so a ping usually
+        // lands without a wakeup; on one busy core it takes a context switch.
+        EXPECT_LT(p50_us, 200.0);
+        EXPECT_LT(p99_us, 2000.0);
+    }
+}
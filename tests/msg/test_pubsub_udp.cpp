@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <ignlink/msg/transport/udp.h>
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ignlink;
+using namespace ignlink::msg::transport;
+using namespace std::chrono_literals;
+
+namespace {
+
+// The transport's wire header, restated here to forge datagrams.
+struct __attribute__((packed)) WireHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t fragment_count;
+    uint64_t topic_hash;
+    uint64_t type_hash;
+    uint64_t writer_id;
+    uint64_t sequence;
+    uint32_t message_size;
+    uint32_t fragment_offset;
+    uint16_t fragment_index;
+};
+
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+class UdpTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // A port of our own, so that concurrent test runs do not hear each other.
+        options_.base_port = static_cast<uint16_t>(20000 + ::getpid() % 20000);
+        options_.port_range = 1;
+    }
+
+    TopicOptions topic(const std::string& name, size_t max_size) {
+        TopicOptions options;
+        options.topic_name = name;
+        options.type_name = "test/Bytes";
+        options.type_hash = 42;
+        options.max_message_size = max_size;
+        return options;
+    }
+
+    UdpOptions options_;
+};
+
+struct StreamResult {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t lost = 0;
+    uint64_t bad = 0;
+    double seconds = 0;
+};
+
+// Streams `count` messages of `size` bytes from a writer thread, keeping at
+// most `window` of them in flight so that the socket buffers, not the
+// reader's speed, decide what is lost.
+StreamResult stream(UdpTransport& transport, const TopicOptions& options, size_t size, uint64_t count,
+                    uint64_t window) {
+    StreamResult run;
+    std::unique_ptr<TransportWriter> writer;
+    std::unique_ptr<TransportReader> reader;
+    if (!transport.create_reader(options, &reader).ok() || !transport.create_writer(options, &writer).ok()) {
+        ADD_FAILURE() << "Could not create the UDP endpoints";
+        return run;
+    }
+
+    std::atomic<uint64_t> done{0}; // Received or lost
+    std::atomic<bool> failed{false};
+    const auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        std::vector<uint8_t> payload(size, 0xa5);
+        for (uint64_t i = 1; i <= count; ++i) {
+            while (i > done.load() + window && std::chrono::steady_clock::now() - start < 20s) {
+                std::this_thread::yield();
+            }
+            std::memcpy(payload.data(), &i, sizeof(i));
+            if (!writer->write(payload.data(), payload.size()).ok()) {
+                failed = true;
+            }
+        }
+    });
+
+    uint64_t last = 0;
+    while (last < count && std::chrono::steady_clock::now() - start < 20s) {
+        reader->wait(1ms);
+        reader->poll([&](const void* data, size_t length) {
+            uint64_t sequence;
+            std::memcpy(&sequence, data, sizeof(sequence));
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            run.bad += length != size || sequence <= last || bytes[size - 1] != 0xa5;
+            last = sequence;
+            ++run.received;
+        });
+        done = run.received + reader->lost_messages();
+    }
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.lost = reader->lost_messages();
+    run.sent = count;
+    done = count; // Release the producer if we gave up early
+    producer.join();
+    EXPECT_FALSE(failed.load());
+    return run;
+}
+
+} // namespace
+
+TEST_F(UdpTest, LoopbackThroughputUpToOneMegabyte) {
+    struct Case {
+        size_t size;
+        uint64_t count;
+        uint64_t window;
+    };
+    const Case cases[] = {{64, 50000, 256}, {16 * 1024, 5000, 32}, {1024 * 1024, 200, 1}};
+    UdpTransport transport(options_);
+    for (const Case& c : cases) {
+        const TopicOptions options = topic("/udp_test/size_" + std::to_string(c.size), c.size);
+        const StreamResult run = stream(transport, options, c.size, c.count, c.window);
+        const double msgs_per_second = static_cast<double>(run.received) / run.seconds;
+        std::printf("udp loopback %8zu B: %9.0f msgs/s, %8.1f MB/s, %llu lost of %llu\n", c.size, msgs_per_second,
+                    msgs_per_second * static_cast<double>(c.size) / 1e6, static_cast<unsigned long long>(run.lost),
+                    static_cast<unsigned long long>(run.sent));
+        RecordProperty("msgs_per_second_" + std::to_string(c.size), std::to_string(msgs_per_second));
+        EXPECT_EQ(run.bad, 0u) << c.size << "-byte messages arrived reordered or corrupt";
+        // Lost messages are noticed through the sequence gaps they leave.
+        EXPECT_EQ(run.received + run.lost, run.sent) << c.size;
+        EXPECT_GE(run.received, run.sent / 2) << c.size;
+    }
+}
+
+TEST_F(UdpTest, FragmentsInconsistentWithTheirMessageAreDropped) {
+    const std::string name = "/udp_test/forged";
+    UdpTransport transport(options_);
+    std::unique_ptr<TransportReader> reader;
+    ASSERT_TRUE(transport.create_reader(topic(name, 1024 * 1024), &reader).ok());
+
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_in destination{};
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(transport.topic_port(name));
+    ASSERT_EQ(::inet_pton(AF_INET, options_.group.c_str(), &destination.sin_addr), 1);
+
+    constexpr uint32_t kSize = 3000;
+    constexpr uint32_t kFragment = 1000;
+    auto send = [&](uint32_t size, uint16_t count, uint16_t index, uint32_t offset, uint8_t fill) {
+        std::vector<uint8_t> datagram(sizeof(WireHeader) + kFragment, fill);
+        WireHeader header{};
+        header.magic = htole32(0x4B4C4755);
+        header.version = htole16(1);
+        header.fragment_count = htole16(count);
+        header.topic_hash = htole64(fnv1a(name));
+        header.writer_id = htole64(7);
+        header.sequence = htole64(1);
+        header.message_size = htole32(size);
+        header.fragment_offset = htole32(offset);
+        header.fragment_index = htole16(index);
+        std::memcpy(datagram.data(), &header, sizeof(header));
+        ASSERT_EQ(::sendto(fd, datagram.data(), datagram.size(), 0, reinterpret_cast<sockaddr*>(&destination),
+                           sizeof(destination)),
+                  static_cast<ssize_t>(datagram.size()));
+    };
+
+    std::vector<std::vector<uint8_t>> delivered;
+    auto drain = [&] {
+        const auto deadline = std::chrono::steady_clock::now() + 200ms;
+        while (std::chrono::steady_clock::now() < deadline) {
+            reader->wait(10ms);
+            reader->poll([&](const void* data, size_t size) {
+                const auto* bytes = static_cast<const uint8_t*>(data);
+                delivered.emplace_back(bytes, bytes + size);
+            });
+        }
+    };
+
+    send(kSize, 3, 0, 0, 1);
+    // Same writer and sequence, but claiming a far bigger message: within its
+    // own header's bounds, far outside the 3000 bytes being reassembled.
+    send(1000000, 1000, 999, 999000, 0xee);
+    send(kSize, 3, 1, 1000, 2);
+    send(kSize, 3, 2, 2000, 3);
+    drain();
+    ::close(fd);
+
+    ASSERT_EQ(delivered.size(), 1u);
+    ASSERT_EQ(delivered[0].size(), kSize);
+    for (uint32_t i = 0; i < kSize; ++i) {
+        ASSERT_EQ(delivered[0][i], i / kFragment + 1) << "byte " << i;
+    }
+}
@@ -0,0 +1,68 @@
+"""Smoke test of the Python bindings: a NumPy array published as a Tensor
+reaches a subscriber as a view of the same memory, not a copy.
+
+Build the module first (see bindings/python/CMakeLists.txt or setup.py), then
+
+    PYTHONPATH=<directory holding the module> python3 -m unittest -v test_bindings
+"""
+
+import unittest
+
+try:
+    import numpy as np
+    import ignlink
+
+    MISSING = None
+except ImportError as error:
+    MISSING = str(error)
+
+
+def data_address(array):
+    return array.__array_interface__["data"][0]
+
+
+@unittest.skipIf(MISSING, f"needs numpy and the ignlink module: {MISSING}")
+class TensorPubSubTest(unittest.TestCase):
+    def setUp(self):
+        self.node = ignlink.Node("test_python_bindings")
+
+    def round_trip(self, topic, message):
+        sub = self.node.create_subscriber(topic, ignlink.Tensor)
+        pub = self.node.create_publisher(topic, ignlink.Tensor)
+        pub.publish(message)
+        received = sub.take(timeout=2.0)
+        sub.close()
+        self.assertEqual(len(received), 1)
+        return received[0]
+
+    def check_view(self, sent, tensor):
+        view = np.asarray(tensor)
+        self.assertEqual(view.shape, sent.shape)
+        self.assertEqual(view.dtype, sent.dtype)
+        self.assertTrue(np.array_equal(view, sent))
+        self.assertEqual(data_address(view), data_address(sent), "the subscriber got a copy")
+        self.assertTrue(np.shares_memory(view, sent))
+        self.assertFalse(view.flags.writeable, "received tensors are shared, so views are read-only")
+
+    def test_tensor_is_received_without_a_copy(self):
+        sent = np.arange(4 * 3 * 2, dtype=np.float32).reshape(4, 3, 2)
+        timestamp = ignlink.now_ns()
+        tensor = self.round_trip("/test_python/tensor", ignlink.Tensor(sent, timestamp=timestamp))
+        self.assertEqual(tensor.timestamp, timestamp)
+        self.assertEqual(tensor.shape, (4, 3, 2))
+        self.check_view(sent, tensor)
+
+    def test_array_is_published_as_a_tensor_without_a_copy(self):
+        sent = np.arange(1000, dtype=np.int64)
+        self.check_view(sent, self.round_trip("/test_python/array", sent))
+
+    def test_strided_view_keeps_its_strides(self):
+        base = np.arange(64, dtype=np.uint8).reshape(8, 8)
+        sent = base[::2, 1::3]
+        tensor = self.round_trip("/test_python/strided", sent)
+        self.assertFalse(tensor.is_contiguous())
+        self.check_view(sent, tensor)
+
+
+if __name__ == "__main__":
+    unittest.main()